@@ -0,0 +1,1185 @@
+/**
+ * \file include/vctool/agent.h
+ *
+ * \brief Framed connection to an agent.
+ *
+ * Messages to and from the agent are framed with an AGENT_FRAME_HEADER_SIZE
+ * byte big-endian header, followed by the payload:
+ *
+ *      offset  size    field
+ *      0       4       message type
+ *      4       4       payload size
+ *
+ * A follower sends AGENT_MSG_SUBSCRIBE once, with the big-endian height of
+ * the first block it wants.  The agent then sends an AGENT_MSG_BLOCK for each
+ * canonized block from that height on, as soon as it is canonized:
+ *
+ *      offset  size    field
+ *      0       8       block height
+ *      8       16      block id
+ *      24      ...     the block
+ *
+ * Independent requests can be spread over several connections with an agent
+ * pool.  Each pool connection carries one request at a time, and a request
+ * is answered with a single frame.  Requests go to the idle connection with
+ * the lowest recent latency, so a slow connection is only used when the
+ * faster ones are busy, and a connection which stays much slower than the
+ * fastest is closed and opened again.
+ *
+ * The full key agreement combines the client's private encryption key with
+ * the agent's public encryption key, made fresh by a nonce from each side:
+ *
+ *      message             offset  size    field
+ *      AGENT_MSG_KEY_AGREE 0       16      client entity id
+ *                          16      32      client nonce
+ *      AGENT_MSG_KEY_AGREED
+ *                          0       32      agent nonce
+ *                          32      8       session lifetime, in seconds
+ *                          40      ...     session ticket
+ *
+ * The session key is the suite's short-term secret of both keys and both
+ * nonces.  A saved session cache holds each session key sealed under a
+ * random seal key, kept in a separate file readable only by the owner, so a
+ * later process resumes a session with a key derivation round and a MAC,
+ * without the client's private key:
+ *
+ *      offset  size    field
+ *      0       8       AGENT_SESSION_CACHE_MAGIC
+ *      8       ...     salt, the size of a stream cipher key
+ *      ...     ...     stream cipher IV and encrypted sessions
+ *      ...     ...     suite MAC of everything before it
+ *
+ * A session key agreed with the agent can be cached, so that later
+ * connections skip the key agreement round trip.  The client resumes a
+ * session by sending AGENT_MSG_RESUME, and the agent answers with
+ * AGENT_MSG_RESUMED, proving that it still holds the session key, or with an
+ * empty AGENT_MSG_RESUME_REJECTED, after which the client runs the full key
+ * agreement on the same connection:
+ *
+ *      message             offset  size    field
+ *      AGENT_MSG_RESUME    0       32      client nonce
+ *                          32      ...     session ticket
+ *      AGENT_MSG_RESUMED   0       32      agent nonce
+ *                          32      ...     suite MAC of both nonces, keyed
+ *                                          with the session key
+ *
+ * A client may send another AGENT_MSG_RESUME after a rejection, before
+ * falling back to the key agreement.  Connections opened at once, such as a
+ * pool reconnecting after an agent restart, share a single key agreement when
+ * their resumer has a single-flight group: one connection agrees on the
+ * session, and the others resume it.
+ *
+ * Agent traffic can be captured with an agent recorder, and served back by an
+ * agent replay with its original timing, so that the client can be
+ * benchmarked without a live agent.  A recording starts with
+ * AGENT_RECORD_MAGIC, followed by one record per frame:
+ *
+ *      offset  size    field
+ *      0       8       exchange id
+ *      8       8       nanoseconds since recording started
+ *      16      4       AGENT_RECORD_REQUEST or AGENT_RECORD_RESPONSE
+ *      20      4       message type
+ *      24      4       payload size
+ *      28      ...     payload
+ *
+ * An exchange is one request and every frame received in answer to it; for
+ * a subscription, that is every block which followed.
+ *
+ * Transactions are submitted with AGENT_MSG_SUBMIT, whose payload is the
+ * transaction certificate, over a pool.  The agent answers
+ * AGENT_MSG_SUBMIT_ACCEPTED, or AGENT_MSG_SUBMIT_BUSY if it is overloaded
+ * and the transaction should be submitted again later.  An agent limiter
+ * sets how many submissions are in flight at once: the window grows by one
+ * request per round trip while latency stays near the lowest seen, and
+ * shrinks when the agent is busy or latency climbs, at most once per round
+ * trip.
+ *
+ * The status of transactions is queried in batches.  AGENT_MSG_TXN_STATUS
+ * carries up to AGENT_TXN_STATUS_BATCH 16 byte transaction ids, and is
+ * answered with AGENT_MSG_TXN_STATUS_RESULT, holding a big-endian 4 byte
+ * AGENT_TXN_* state for each id, in request order.  Up to
+ * AGENT_TXN_STATUS_PIPELINE batches are sent before their results are read,
+ * so a connection is not idle for a round trip between batches.
+ *
+ * \copyright 2020 Velo Payments.  See License.txt for license terms.
+ */
+
+#ifndef  VCTOOL_AGENT_HEADER_GUARD
+# define VCTOOL_AGENT_HEADER_GUARD
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <vctool/file.h>
+#include <vccrypt/suite.h>
+#include <vctool/singleflight.h>
+#include <vctool/status_codes.h>
+#include <vpr/disposable.h>
+
+/* make this header C++ friendly. */
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* the size of a frame header. */
+#define AGENT_FRAME_HEADER_SIZE                         8
+
+/* the largest payload accepted from a peer. */
+#define AGENT_MAX_PAYLOAD_SIZE                          (64U * 1024U * 1024U)
+
+/* message types. */
+#define AGENT_MSG_SUBSCRIBE                             0x00000001U
+#define AGENT_MSG_BLOCK                                 0x00000002U
+#define AGENT_MSG_RESUME                                0x00000003U
+#define AGENT_MSG_RESUMED                               0x00000004U
+#define AGENT_MSG_RESUME_REJECTED                       0x00000005U
+#define AGENT_MSG_SUBMIT                                0x00000006U
+#define AGENT_MSG_SUBMIT_ACCEPTED                       0x00000007U
+#define AGENT_MSG_SUBMIT_BUSY                           0x00000008U
+#define AGENT_MSG_TXN_STATUS                            0x00000009U
+#define AGENT_MSG_TXN_STATUS_RESULT                     0x0000000AU
+#define AGENT_MSG_KEY_AGREE                             0x0000000BU
+#define AGENT_MSG_KEY_AGREED                            0x0000000CU
+
+/* the largest number of transaction ids in a status batch. */
+#define AGENT_TXN_STATUS_BATCH                          1024
+
+/* the number of status batches in flight on a connection. */
+#define AGENT_TXN_STATUS_PIPELINE                       8
+
+/* transaction states. */
+#define AGENT_TXN_UNKNOWN                               0x00000000U
+#define AGENT_TXN_PENDING                               0x00000001U
+#define AGENT_TXN_CANONIZED                             0x00000002U
+
+/* the size of a subscribe payload. */
+#define AGENT_SUBSCRIBE_SIZE                            8
+
+/* the size of a block payload before the block itself. */
+#define AGENT_BLOCK_HEADER_SIZE                         24
+
+/* the weight of a new latency sample is 1 / 2^AGENT_POOL_EWMA_SHIFT. */
+#define AGENT_POOL_EWMA_SHIFT                           3
+
+/* a connection slower than the fastest by this factor is replaced. */
+#define AGENT_POOL_SLOW_FACTOR                          4
+
+/* the number of requests a connection carries before it is judged slow. */
+#define AGENT_POOL_MIN_SAMPLES                          16
+
+/* limiter windows are kept in 1 / AGENT_LIMIT_SCALE requests. */
+#define AGENT_LIMIT_SCALE                               1024
+
+/* latency above this multiple of the baseline is a congestion signal. */
+#define AGENT_LIMIT_TOLERANCE                           2
+
+/* the number of samples over which the baseline latency is taken. */
+#define AGENT_LIMIT_BASELINE_SAMPLES                    256
+
+/* the size of a session resumption or key agreement nonce. */
+#define AGENT_SESSION_NONCE_SIZE                        32
+
+/* the size of an entity id sent in a key agreement. */
+#define AGENT_ENTITY_ID_SIZE                            16
+
+/* the largest session key and ticket which can be cached. */
+#define AGENT_SESSION_KEY_MAX                           64
+#define AGENT_SESSION_TICKET_MAX                        256
+
+/* the longest agent address which can be cached, including its nul. */
+#define AGENT_SESSION_ADDRESS_MAX                       128
+
+/* the number of sessions a cache holds. */
+#define AGENT_SESSION_CACHE_ENTRIES                     64
+
+/* the magic at the start of a recording. */
+#define AGENT_RECORD_MAGIC                              "VCAREC01"
+#define AGENT_RECORD_MAGIC_SIZE                         8
+
+/* the size of a record before its payload. */
+#define AGENT_RECORD_HEADER_SIZE                        28
+
+/* record directions. */
+#define AGENT_RECORD_REQUEST                            0x00000001U
+#define AGENT_RECORD_RESPONSE                           0x00000002U
+
+/* the magic at the start of a saved session cache. */
+#define AGENT_SESSION_CACHE_MAGIC                       "VCSESS03"
+#define AGENT_SESSION_CACHE_MAGIC_SIZE                  8
+
+/* the seal key of a saved session cache, kept at its path plus a suffix. */
+#define AGENT_SESSION_SEAL_KEY_SIZE                     32
+#define AGENT_SESSION_SEAL_KEY_SUFFIX                   ".key"
+
+/* the seal key is random, so the key derivation needs no stretching. */
+#define AGENT_SESSION_SEAL_ROUNDS                       1
+
+/**
+ * \brief Captures agent traffic to a recording.
+ *
+ * Any number of threads may record at once.
+ */
+typedef struct agent_recorder
+{
+    /** \brief agent_recorder is disposable. */
+    disposable_t hdr;
+
+    /** \brief the file abstraction layer. */
+    file* f;
+
+    /** \brief the recording. */
+    int fd;
+
+    /** \brief when recording started, in monotonic nanoseconds. */
+    uint64_t start;
+
+    /** \brief the id of the next exchange. */
+    uint64_t next_exchange;
+
+    /** \brief keeps records whole. */
+    pthread_mutex_t lock;
+} agent_recorder;
+
+/**
+ * \brief A frame received from a peer.
+ */
+typedef struct agent_frame
+{
+    /** \brief agent_frame is disposable. */
+    disposable_t hdr;
+
+    /** \brief the message type. */
+    uint32_t type;
+
+    /** \brief the payload size. */
+    uint32_t size;
+
+    /** \brief the payload, reused between frames. */
+    uint8_t* payload;
+
+    /** \brief the allocated size of payload. */
+    size_t capacity;
+} agent_frame;
+
+/**
+ * \brief Function run on each new pool connection before its first request,
+ * for instance to authenticate it.
+ *
+ * \param context       The user context.
+ * \param f             The file abstraction layer.
+ * \param sock          The new connection.
+ *
+ * \returns a status code indicating success or failure.
+ */
+typedef int (*agent_handshake_fn)(void* context, file* f, int sock);
+
+/**
+ * \brief Function receiving the response to a pool request.
+ *
+ * \param context       The user context.
+ * \param response      The response, which is only valid during this call.
+ *
+ * \returns a status code, which is returned by agent_pool_request.
+ */
+typedef int (*agent_response_fn)(void* context, const agent_frame* response);
+
+/**
+ * \brief Function receiving the states of a batch of transactions.
+ *
+ * \param context       The user context.
+ * \param txn_ids       The transaction ids in this batch.
+ * \param states        The AGENT_TXN_* state of each transaction.
+ * \param count         The number of transactions in this batch.
+ *
+ * \returns a status code; anything but success stops the query, and is
+ *          returned by agent_txn_status.
+ */
+typedef int (*agent_txn_status_fn)(
+    void* context, const uint8_t* txn_ids, const uint32_t* states,
+    size_t count);
+
+/**
+ * \brief A connection in an agent pool.
+ */
+typedef struct agent_pool_connection
+{
+    /** \brief the socket, or -1 if the connection must be reopened. */
+    int sock;
+
+    /** \brief whether a request is using this connection. */
+    bool busy;
+
+    /** \brief the recent request latency, in nanoseconds. */
+    uint64_t latency;
+
+    /** \brief the number of requests since the connection was opened. */
+    uint64_t samples;
+
+    /** \brief the number of requests completed over this slot. */
+    uint64_t requests;
+
+    /** \brief the number of times this slot was reopened. */
+    uint64_t reconnects;
+
+    /** \brief the response buffer, reused between requests. */
+    agent_frame response;
+
+    /** \brief the request buffer, reused between requests. */
+    uint8_t* request;
+
+    /** \brief the allocated size of request. */
+    size_t request_capacity;
+} agent_pool_connection;
+
+/**
+ * \brief A pool of connections to an agent.
+ */
+typedef struct agent_pool
+{
+    /** \brief agent_pool is disposable. */
+    disposable_t hdr;
+
+    /** \brief the file abstraction layer. */
+    file* f;
+
+    /** \brief the agent address. */
+    char* address;
+
+    /** \brief the new connection handshake, or NULL. */
+    agent_handshake_fn handshake;
+
+    /** \brief the user context passed to handshake. */
+    void* handshake_context;
+
+    /** \brief the number of connections. */
+    size_t count;
+
+    /** \brief the connections. */
+    agent_pool_connection* connections;
+
+    /** \brief protects the connection states. */
+    pthread_mutex_t lock;
+
+    /** \brief signaled when a connection becomes idle. */
+    pthread_cond_t idle;
+
+    /** \brief captures requests and responses if not NULL; may be set
+     * after the pool is opened. */
+    agent_recorder* recorder;
+} agent_pool;
+
+/**
+ * \brief Adaptive limit on the number of requests in flight.
+ *
+ * Any number of threads may use a limiter at once.
+ */
+typedef struct agent_limiter
+{
+    /** \brief agent_limiter is disposable. */
+    disposable_t hdr;
+
+    /** \brief protects the limiter state. */
+    pthread_mutex_t lock;
+
+    /** \brief signaled when a request completes or the window grows. */
+    pthread_cond_t ready;
+
+    /** \brief the window, in 1 / AGENT_LIMIT_SCALE requests. */
+    uint64_t window;
+
+    /** \brief the smallest window, scaled. */
+    uint64_t min_window;
+
+    /** \brief the largest window, scaled. */
+    uint64_t max_window;
+
+    /** \brief incremented each time the window shrinks. */
+    uint64_t epoch;
+
+    /** \brief the number of requests in flight. */
+    size_t in_flight;
+
+    /** \brief the number of requests waiting for the window. */
+    size_t queued;
+
+    /** \brief the lowest recent latency, in nanoseconds, or 0. */
+    uint64_t baseline;
+
+    /** \brief the lowest latency in the current baseline period. */
+    uint64_t period_min;
+
+    /** \brief the number of samples in the current baseline period. */
+    uint64_t period_samples;
+
+    /** \brief the number of requests the agent accepted. */
+    uint64_t completed;
+
+    /** \brief the number of requests the agent was too busy for. */
+    uint64_t busy;
+
+    /** \brief the number of requests which failed otherwise. */
+    uint64_t failed;
+
+    /** \brief the total time requests waited for the window, in ns. */
+    uint64_t queue_time_total;
+
+    /** \brief the longest time a request waited for the window, in ns. */
+    uint64_t queue_time_max;
+} agent_limiter;
+
+/**
+ * \brief A request admitted by a limiter.
+ */
+typedef struct agent_limiter_ticket
+{
+    /** \brief when the request was admitted, in monotonic nanoseconds. */
+    uint64_t start;
+
+    /** \brief the limiter epoch when the request was admitted. */
+    uint64_t epoch;
+} agent_limiter_ticket;
+
+/**
+ * \brief A snapshot of a limiter.
+ */
+typedef struct agent_limiter_metrics
+{
+    /** \brief the current window, in whole requests. */
+    size_t window;
+
+    /** \brief the number of requests in flight. */
+    size_t in_flight;
+
+    /** \brief the number of requests waiting for the window. */
+    size_t queued;
+
+    /** \brief the baseline latency, in nanoseconds. */
+    uint64_t baseline;
+
+    /** \brief the number of requests the agent accepted. */
+    uint64_t completed;
+
+    /** \brief the number of requests the agent was too busy for. */
+    uint64_t busy;
+
+    /** \brief the number of requests which failed otherwise. */
+    uint64_t failed;
+
+    /** \brief the mean time requests waited for the window, in ns. */
+    uint64_t queue_time_mean;
+
+    /** \brief the longest time a request waited for the window, in ns. */
+    uint64_t queue_time_max;
+} agent_limiter_metrics;
+
+/**
+ * \brief A response in a recorded exchange.
+ */
+typedef struct agent_replay_response
+{
+    /** \brief the time from the request to this response, in nanoseconds. */
+    uint64_t delay;
+
+    /** \brief the message type. */
+    uint32_t type;
+
+    /** \brief the payload size. */
+    uint32_t size;
+
+    /** \brief the payload, in the recording. */
+    const uint8_t* payload;
+} agent_replay_response;
+
+/**
+ * \brief A recorded exchange.
+ */
+typedef struct agent_replay_exchange
+{
+    /** \brief the request type. */
+    uint32_t type;
+
+    /** \brief the request payload size. */
+    uint32_t size;
+
+    /** \brief the request payload, in the recording. */
+    const uint8_t* payload;
+
+    /** \brief the responses, in the order they were received. */
+    agent_replay_response* responses;
+
+    /** \brief the number of responses. */
+    size_t response_count;
+
+    /** \brief the first exchange with the same request. */
+    struct agent_replay_exchange* group;
+
+    /** \brief the number of exchanges with the same request. */
+    size_t group_size;
+
+    /** \brief the number of times this group has been replayed; only used
+     * in the first exchange of a group. */
+    uint64_t cursor;
+} agent_replay_exchange;
+
+/**
+ * \brief Recorded agent traffic, indexed for replay.
+ *
+ * Any number of connections may be served from a replay at once.
+ */
+typedef struct agent_replay
+{
+    /** \brief agent_replay is disposable. */
+    disposable_t hdr;
+
+    /** \brief the file abstraction layer. */
+    file* f;
+
+    /** \brief the mapped recording. */
+    uint8_t* data;
+
+    /** \brief the size of the recording. */
+    size_t size;
+
+    /** \brief recorded latency is scaled by this percentage. */
+    unsigned latency_percent;
+
+    /** \brief the exchanges, sorted by request. */
+    agent_replay_exchange* exchanges;
+
+    /** \brief the number of exchanges. */
+    size_t exchange_count;
+
+    /** \brief the responses of every exchange. */
+    agent_replay_response* responses;
+} agent_replay;
+
+/**
+ * \brief A session agreed with an agent.
+ */
+typedef struct agent_session
+{
+    /** \brief when the session expires, in seconds since the epoch. */
+    uint64_t expires;
+
+    /** \brief the size of the session key. */
+    size_t key_size;
+
+    /** \brief the session key. */
+    uint8_t key[AGENT_SESSION_KEY_MAX];
+
+    /** \brief the client nonce of the key agreement. */
+    uint8_t client_nonce[AGENT_SESSION_NONCE_SIZE];
+
+    /** \brief the agent nonce of the key agreement. */
+    uint8_t agent_nonce[AGENT_SESSION_NONCE_SIZE];
+
+    /** \brief the size of the session ticket. */
+    size_t ticket_size;
+
+    /** \brief the opaque ticket the agent issued for this session. */
+    uint8_t ticket[AGENT_SESSION_TICKET_MAX];
+} agent_session;
+
+/**
+ * \brief A cached session and the agent it was agreed with.
+ */
+typedef struct agent_session_entry
+{
+    /** \brief the agent address, or empty if the entry is unused. */
+    char address[AGENT_SESSION_ADDRESS_MAX];
+
+    /** \brief the session. */
+    agent_session session;
+} agent_session_entry;
+
+/**
+ * \brief Cache of sessions agreed with agents.
+ *
+ * The entries and the seal key live in memory which is locked, so that
+ * session keys are never swapped out, and excluded from core dumps.  The
+ * memory is wiped when the cache is disposed.  Any number of threads may use
+ * a cache at once.
+ */
+typedef struct agent_session_cache
+{
+    /** \brief agent_session_cache is disposable. */
+    disposable_t hdr;
+
+    /** \brief the file abstraction layer. */
+    file* f;
+
+    /** \brief the crypto suite which seals saved sessions. */
+    vccrypt_suite_options_t* suite;
+
+    /** \brief the path the cache is saved to, or NULL. */
+    char* path;
+
+    /** \brief true if seal_key holds the seal key of path. */
+    bool sealed;
+
+    /** \brief the locked seal key. */
+    uint8_t* seal_key;
+
+    /** \brief the locked entries. */
+    agent_session_entry* entries;
+
+    /** \brief the size of the locked mapping. */
+    size_t mapped_size;
+
+    /** \brief protects the entries. */
+    pthread_mutex_t lock;
+} agent_session_cache;
+
+/**
+ * \brief Function running the full key agreement with an agent.
+ *
+ * \param context       The user context.
+ * \param f             The file abstraction layer.
+ * \param sock          The connection.
+ * \param session       The session to fill in with the agreed key, its
+ *                      ticket, and its expiry.
+ *
+ * \returns a status code indicating success or failure.
+ */
+typedef int (*agent_key_agreement_fn)(
+    void* context, file* f, int sock, agent_session* session);
+
+/**
+ * \brief The keys of a full key agreement.
+ *
+ * A pointer to this is the context of agent_key_agree and
+ * agent_session_derive_key.  The caller owns the keys, and must keep them
+ * until the agreement is no longer used.
+ */
+typedef struct agent_key_agreement
+{
+    /** \brief the crypto suite providing the nonces and the key agreement. */
+    vccrypt_suite_options_t* suite;
+
+    /** \brief the client's entity id. */
+    uint8_t client_id[AGENT_ENTITY_ID_SIZE];
+
+    /** \brief the client's private encryption key. */
+    const vccrypt_buffer_t* client_private_key;
+
+    /** \brief the agent's public encryption key. */
+    const vccrypt_buffer_t* agent_public_key;
+} agent_key_agreement;
+
+/**
+ * \brief Handshake state which resumes cached sessions.
+ *
+ * A pointer to this is the context of agent_session_handshake.
+ */
+typedef struct agent_session_resumer
+{
+    /** \brief the session cache. */
+    agent_session_cache* cache;
+
+    /** \brief the agent address the sessions are cached under. */
+    const char* address;
+
+    /** \brief the crypto suite providing the nonces and the MAC. */
+    vccrypt_suite_options_t* suite;
+
+    /** \brief the full key agreement. */
+    agent_key_agreement_fn key_agreement;
+
+    /** \brief the user context passed to key_agreement. */
+    void* key_agreement_context;
+
+    /** \brief coalesces concurrent key agreements with the same address,
+     * or NULL; its result size is sizeof(agent_session). */
+    singleflight* flights;
+
+    /** \brief the number of full key agreements run. */
+    uint64_t full_handshakes;
+
+    /** \brief the number of sessions resumed. */
+    uint64_t resumptions;
+} agent_session_resumer;
+
+/**
+ * \brief Connect to an agent.
+ *
+ * An address containing a slash is the path of a unix domain socket;
+ * otherwise it is host:port.  Nagle's algorithm is disabled on TCP
+ * connections, since each frame is written with a single write.
+ *
+ * \param sock          Pointer to receive the connected socket.
+ * \param address       The agent address.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - VCTOOL_ERROR_AGENT_BAD_ADDRESS if the address could not be resolved.
+ *      - VCTOOL_ERROR_AGENT_CONNECT if the connection failed.
+ */
+int agent_connect(int* sock, const char* address);
+
+/**
+ * \brief Initialize an empty frame.
+ *
+ * \param frame         The frame to initialize.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ */
+int agent_frame_init(agent_frame* frame);
+
+/**
+ * \brief Read the next frame from a peer.
+ *
+ * \param f             The file abstraction layer to use.
+ * \param sock          The socket to read from.
+ * \param frame         The frame receiving the message.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - VCTOOL_ERROR_AGENT_DISCONNECTED if the peer closed the connection
+ *        between frames.
+ *      - VCTOOL_ERROR_AGENT_BAD_FRAME if the frame was truncated or too
+ *        large.
+ *      - VCTOOL_ERROR_GENERAL_OUT_OF_MEMORY if an allocation failed.
+ *      - a non-zero error code returned by the file layer.
+ */
+int agent_frame_read(file* f, int sock, agent_frame* frame);
+
+/**
+ * \brief Write a frame to a peer.
+ *
+ * \param f             The file abstraction layer to use.
+ * \param sock          The socket to write to.
+ * \param type          The message type.
+ * \param payload       The payload.
+ * \param size          The size of the payload.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - VCTOOL_ERROR_AGENT_BAD_FRAME if the payload is too large.
+ *      - VCTOOL_ERROR_GENERAL_OUT_OF_MEMORY if an allocation failed.
+ *      - a non-zero error code returned by the file layer.
+ */
+int agent_frame_write(
+    file* f, int sock, uint32_t type, const void* payload, size_t size);
+
+/**
+ * \brief Follow canonized blocks, appending each to a segment.
+ *
+ * Subscribes from the given height, then appends each block received to the
+ * segment and, if out is not negative, copies its frame to out as soon as it
+ * has been appended.  Blocks must arrive in order, starting at the subscribed
+ * height, so the segment never skips or repeats a height.
+ *
+ * \param f             The file abstraction layer to use.
+ * \param sock          The socket connected to the agent.
+ * \param segment       The path of the segment.
+ * \param height        The height of the first block wanted; updated to the
+ *                      height after the last block appended.
+ * \param out           Descriptor receiving block frames, or -1.
+ * \param recorder      Captures the subscription and its blocks, or NULL.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_ERROR_AGENT_DISCONNECTED when the agent closes the
+ *        connection.
+ *      - VCTOOL_ERROR_AGENT_UNEXPECTED_MESSAGE if the agent sent something
+ *        other than a block.
+ *      - VCTOOL_ERROR_AGENT_BAD_FRAME if a frame was malformed.
+ *      - VCTOOL_ERROR_AGENT_BLOCK_OUT_OF_ORDER if a block was not the next
+ *        one.
+ *      - a non-zero error code on failure.
+ */
+int agent_follow(
+    file* f, int sock, const char* segment, uint64_t* height, int out,
+    agent_recorder* recorder);
+
+/**
+ * \brief Open a pool of connections to an agent.
+ *
+ * \param pool          The pool to initialize.
+ * \param f             The file abstraction layer to use.
+ * \param address       The agent address, as for agent_connect.
+ * \param count         The number of connections.
+ * \param handshake     Function run on each new connection, or NULL.
+ * \param context       The user context passed to handshake.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - VCTOOL_ERROR_GENERAL_OUT_OF_MEMORY if an allocation failed.
+ *      - a non-zero error code from agent_connect or the handshake.
+ */
+int agent_pool_init(
+    agent_pool* pool, file* f, const char* address, size_t count,
+    agent_handshake_fn handshake, void* context);
+
+/**
+ * \brief Send a request over a pool and receive its response.
+ *
+ * Any number of threads may make requests at once; each waits for an idle
+ * connection.  A connection which fails is reopened by the next request to
+ * use it, but the failed request is not retried.
+ *
+ * \param pool          The pool.
+ * \param type          The request type.
+ * \param payload       The request payload.
+ * \param size          The size of the request payload.
+ * \param response      Function receiving the response.
+ * \param context       The user context passed to response.
+ *
+ * \returns a status code indicating success or failure.
+ *      - the status code returned by response on success.
+ *      - VCTOOL_ERROR_AGENT_DISCONNECTED if the agent closed the connection.
+ *      - VCTOOL_ERROR_AGENT_BAD_FRAME if the request was too large or the
+ *        response was malformed.
+ *      - a non-zero error code on failure.
+ */
+int agent_pool_request(
+    agent_pool* pool, uint32_t type, const void* payload, size_t size,
+    agent_response_fn response, void* context);
+
+/**
+ * \brief Create a session cache, loading saved sessions if a path is given.
+ *
+ * The seal key is read from path plus AGENT_SESSION_SEAL_KEY_SUFFIX.  A seal
+ * key which is missing, the wrong size, or readable by anyone but the owner
+ * is replaced with a new random key, which no saved cache matches.  A cache
+ * file which is missing, damaged, or sealed under another key leaves the
+ * cache empty, and expired sessions are not loaded.  The bytes read are
+ * wiped once they are parsed.
+ *
+ * \param cache         The cache to initialize.
+ * \param f             The file abstraction layer to use.
+ * \param suite         The crypto suite which seals saved sessions.
+ * \param path          The path the cache is loaded from and saved to, or
+ *                      NULL for a cache which is never saved.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - VCTOOL_ERROR_AGENT_SECURE_MEMORY if the entries could not be locked
+ *        in memory.
+ *      - VCTOOL_ERROR_GENERAL_OUT_OF_MEMORY if an allocation failed.
+ */
+int agent_session_cache_init(
+    agent_session_cache* cache, file* f, vccrypt_suite_options_t* suite,
+    const char* path);
+
+/**
+ * \brief Find an unexpired session for an agent.
+ *
+ * \param cache         The cache.
+ * \param address       The agent address.
+ * \param session       Receives a copy of the session; the caller must wipe
+ *                      it when done.
+ *
+ * \returns true if a session was found.
+ */
+bool agent_session_cache_find(
+    agent_session_cache* cache, const char* address, agent_session* session);
+
+/**
+ * \brief Cache a session for an agent, replacing any older one.
+ *
+ * When the cache is full, the session which expires first is evicted.
+ *
+ * \param cache         The cache.
+ * \param address       The agent address.
+ * \param session       The session.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - VCTOOL_ERROR_AGENT_BAD_SESSION if the address, key, or ticket is
+ *        too large.
+ */
+int agent_session_cache_store(
+    agent_session_cache* cache, const char* address,
+    const agent_session* session);
+
+/**
+ * \brief Wipe the session cached for an agent.
+ *
+ * \param cache         The cache.
+ * \param address       The agent address.
+ */
+void agent_session_cache_forget(
+    agent_session_cache* cache, const char* address);
+
+/**
+ * \brief Save the unexpired sessions to the path of the cache, readable only
+ * by the owner.
+ *
+ * The sessions, keys included, are encrypted and MACed under a key derived
+ * from the seal key and a fresh salt, and the plaintext is wiped as soon as
+ * it is sealed.  The file is written next to the path, synced, and renamed
+ * into place, so a reader never sees a partial cache.
+ *
+ * \param cache         The cache.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - VCTOOL_ERROR_AGENT_NO_SEAL_KEY if the cache has no path, or no seal
+ *        key could be created for it.
+ *      - VCTOOL_ERROR_GENERAL_OUT_OF_MEMORY if an allocation failed.
+ *      - a non-zero error code returned by the file layer or the suite.
+ */
+int agent_session_cache_save(agent_session_cache* cache);
+
+/**
+ * \brief Handshake which resumes a cached session, or runs the full key
+ * agreement and caches the new session.
+ *
+ * This is an agent_handshake_fn, so it can be given to agent_pool_init.  A
+ * session the agent rejects is forgotten, and the full key agreement runs on
+ * the same connection.
+ *
+ * If the resumer has a single-flight group, connections which need a key
+ * agreement with the same address at the same time share one: the first
+ * runs it, and the rest resume the session it agreed.
+ *
+ * \param context       The agent_session_resumer.
+ * \param f             The file abstraction layer.
+ * \param sock          The new connection.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - VCTOOL_ERROR_AGENT_RESUME_FAILED if the agent accepted the ticket
+ *        but could not prove that it holds the session key.
+ *      - VCTOOL_ERROR_AGENT_UNEXPECTED_MESSAGE if the agent answered the
+ *        resumption with something else.
+ *      - a non-zero error code from the key agreement or on failure.
+ */
+int agent_session_handshake(void* context, file* f, int sock);
+
+/**
+ * \brief Run the full key agreement with an agent.
+ *
+ * This is an agent_key_agreement_fn, for an agent_session_resumer.
+ *
+ * \param context       The agent_key_agreement.
+ * \param f             The file abstraction layer.
+ * \param sock          The connection.
+ * \param session       The session to fill in with the agreed key, its
+ *                      nonces, its ticket, and its expiry.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - VCTOOL_ERROR_AGENT_UNEXPECTED_MESSAGE if the agent answered with
+ *        something else.
+ *      - VCTOOL_ERROR_AGENT_BAD_FRAME if the answer is too short.
+ *      - VCTOOL_ERROR_AGENT_BAD_SESSION if the ticket or the key is too large
+ *        to be cached.
+ *      - a non-zero error code on failure.
+ */
+int agent_key_agree(void* context, file* f, int sock, agent_session* session);
+
+/**
+ * \brief Derive the key of a session from its nonces.
+ *
+ * agent_key_agree derives the session key with this once the agent's nonce
+ * arrives; the agent derives the same key with its own keys.
+ *
+ * \param context       The agent_key_agreement.
+ * \param session       The session, whose key is set.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - VCTOOL_ERROR_AGENT_BAD_SESSION if the suite's nonces or keys don't
+ *        fit a session.
+ *      - a non-zero error code on failure.
+ */
+int agent_session_derive_key(void* context, agent_session* session);
+
+/**
+ * \brief Start a recording, replacing any file at path.
+ *
+ * \param recorder      The recorder to initialize.
+ * \param f             The file abstraction layer to use.
+ * \param path          The path of the recording.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - VCTOOL_ERROR_GENERAL_OUT_OF_MEMORY if an allocation failed.
+ *      - a non-zero error code returned by the file layer.
+ */
+int agent_recorder_init(agent_recorder* recorder, file* f, const char* path);
+
+/**
+ * \brief Start a new exchange.
+ *
+ * \param recorder      The recorder.
+ *
+ * \returns the id of the exchange.
+ */
+uint64_t agent_recorder_exchange(agent_recorder* recorder);
+
+/**
+ * \brief Record a frame, stamped with the time since recording started.
+ *
+ * \param recorder      The recorder.
+ * \param exchange      The exchange the frame belongs to.
+ * \param direction     AGENT_RECORD_REQUEST or AGENT_RECORD_RESPONSE.
+ * \param type          The message type.
+ * \param payload       The payload.
+ * \param size          The size of the payload.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - a non-zero error code returned by the file layer.
+ */
+int agent_recorder_write(
+    agent_recorder* recorder, uint64_t exchange, uint32_t direction,
+    uint32_t type, const void* payload, size_t size);
+
+/**
+ * \brief Load a recording for replay.
+ *
+ * An exchange whose request was not recorded, for instance because the
+ * recording was cut short, is dropped.
+ *
+ * \param replay        The replay to initialize.
+ * \param f             The file abstraction layer to use.
+ * \param path          The path of the recording.
+ * \param latency_percent   Recorded latency is scaled by this percentage;
+ *                          100 replays the original timing, and 0 answers
+ *                          at once.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - VCTOOL_ERROR_AGENT_BAD_RECORDING if the recording is malformed.
+ *      - VCTOOL_ERROR_GENERAL_OUT_OF_MEMORY if an allocation failed.
+ *      - a non-zero error code returned by the file layer.
+ */
+int agent_replay_init(
+    agent_replay* replay, file* f, const char* path,
+    unsigned latency_percent);
+
+/**
+ * \brief Find a recorded exchange for a request.
+ *
+ * When the same request was recorded several times, successive calls cycle
+ * through its exchanges in recorded order.
+ *
+ * \param replay        The replay.
+ * \param type          The request type.
+ * \param payload       The request payload.
+ * \param size          The size of the request payload.
+ *
+ * \returns the exchange, or NULL if the request was not recorded.
+ */
+const agent_replay_exchange* agent_replay_find(
+    agent_replay* replay, uint32_t type, const void* payload, size_t size);
+
+/**
+ * \brief Answer requests on a connection from the recording until the client
+ * closes it.
+ *
+ * Each response is sent when its scaled delay after the request has passed.
+ *
+ * \param replay        The replay.
+ * \param sock          The client connection.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS when the client closes the connection.
+ *      - VCTOOL_ERROR_AGENT_NOT_RECORDED if a request was not recorded.
+ *      - VCTOOL_ERROR_AGENT_BAD_FRAME if a request frame was malformed.
+ *      - a non-zero error code on failure.
+ */
+int agent_replay_serve(agent_replay* replay, int sock);
+
+/**
+ * \brief Create a limiter.
+ *
+ * \param limiter       The limiter to initialize.
+ * \param initial       The initial window, in requests.
+ * \param min           The smallest window, at least 1.
+ * \param max           The largest window.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - VCTOOL_ERROR_GENERAL_OUT_OF_MEMORY if the lock could not be created.
+ */
+int agent_limiter_init(
+    agent_limiter* limiter, size_t initial, size_t min, size_t max);
+
+/**
+ * \brief Wait until the window admits another request.
+ *
+ * \param limiter       The limiter.
+ * \param ticket        Receives the ticket to pass to agent_limiter_release.
+ */
+void agent_limiter_acquire(
+    agent_limiter* limiter, agent_limiter_ticket* ticket);
+
+/**
+ * \brief Complete a request, adjusting the window from its outcome.
+ *
+ * \param limiter       The limiter.
+ * \param ticket        The ticket from agent_limiter_acquire.
+ * \param latency       The request latency, in nanoseconds.
+ * \param status        VCTOOL_STATUS_SUCCESS if the agent accepted the
+ *                      request, VCTOOL_ERROR_AGENT_BUSY if it was too busy,
+ *                      or another error code if the request failed.
+ */
+void agent_limiter_release(
+    agent_limiter* limiter, const agent_limiter_ticket* ticket,
+    uint64_t latency, int status);
+
+/**
+ * \brief Take a snapshot of a limiter.
+ *
+ * \param limiter       The limiter.
+ * \param metrics       Receives the snapshot.
+ */
+void agent_limiter_metrics_get(
+    agent_limiter* limiter, agent_limiter_metrics* metrics);
+
+/**
+ * \brief Submit a transaction over a pool, within a limiter's window.
+ *
+ * \param pool          The pool.
+ * \param limiter       The limiter.
+ * \param txn           The transaction certificate.
+ * \param size          The size of the certificate.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS if the agent accepted the transaction.
+ *      - VCTOOL_ERROR_AGENT_BUSY if the agent was too busy, and the
+ *        transaction should be submitted again.
+ *      - VCTOOL_ERROR_AGENT_UNEXPECTED_MESSAGE if the agent answered with
+ *        something else.
+ *      - a non-zero error code from agent_pool_request.
+ */
+int agent_submit(
+    agent_pool* pool, agent_limiter* limiter, const void* txn, size_t size);
+
+/**
+ * \brief Query the states of transactions in pipelined batches.
+ *
+ * Results are passed to the callback one batch at a time, in the order of
+ * the transaction ids, as soon as each batch is answered.
+ *
+ * \param f             The file abstraction layer to use.
+ * \param sock          The socket connected to the agent.
+ * \param txn_ids       Array of count 16 byte transaction ids.
+ * \param count         The number of transactions.
+ * \param result        Function receiving each batch of states.
+ * \param context       The user context passed to result.
+ * \param recorder      Captures each batch and its result, or NULL.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - VCTOOL_ERROR_AGENT_UNEXPECTED_MESSAGE if the agent answered with
+ *        something else.
+ *      - VCTOOL_ERROR_AGENT_BAD_FRAME if a result did not match its batch.
+ *      - the status code returned by result, if not success.
+ *      - a non-zero error code on failure.
+ */
+int agent_txn_status(
+    file* f, int sock, const uint8_t* txn_ids, size_t count,
+    agent_txn_status_fn result, void* context, agent_recorder* recorder);
+
+/* make this header C++ friendly. */
+#ifdef __cplusplus
+}
+#endif
+
+#endif /*VCTOOL_AGENT_HEADER_GUARD*/
@@ -0,0 +1,390 @@
+/**
+ * \file include/vctool/blockstore.h
+ *
+ * \brief Local block store segments.
+ *
+ * Blocks are stored in append-only segment files.  A segment starts with
+ * BLOCKSTORE_SEGMENT_MAGIC and is followed by records.  Each record has a
+ * BLOCKSTORE_RECORD_HEADER_SIZE byte big-endian header, followed by the block:
+ *
+ *      offset  size    field
+ *      0       4       BLOCKSTORE_RECORD_MAGIC
+ *      4       4       block size
+ *      8       8       block height
+ *      16      16      block id
+ *      32      4       CRC-32C of bytes 0-31 and the block
+ *      36      4       reserved, zero
+ *
+ * The checksum lets a segment be scrubbed for corruption at disk bandwidth,
+ * without repeating the cryptographic verification of its blocks.  The
+ * record magic lets a scrub find the next intact record after a damaged one.
+ *
+ * A segment may have a summary, kept in a file next to it with the
+ * BLOCKSTORE_SUMMARY_SUFFIX suffix.  The summary is a hash tree over the
+ * records in segment order: each leaf is the suite hash of a record's checked
+ * header bytes and block, and each interior node is the hash of up to
+ * BLOCKSTORE_SUMMARY_FANOUT child hashes.  Node j of level l covers records
+ * j * FANOUT^l through (j + 1) * FANOUT^l - 1 in every summary, so the
+ * common prefix of two summaries is found by descending only into nodes which
+ * differ.  Past the prefix, records are matched by height rather than by
+ * position, so a block present in only one segment does not make every later
+ * record differ.  The summary file holds, in big-endian order:
+ *
+ *      offset  size    field
+ *      0       8       BLOCKSTORE_SUMMARY_MAGIC
+ *      8       8       size of the segment when the summary was built
+ *      16      8       record count
+ *      24      4       hash size
+ *      28      4       level count
+ *      32      8 * n   the height of each record
+ *      ...             the hashes of each level, from the leaves up
+ *
+ * \copyright 2020 Velo Payments.  See License.txt for license terms.
+ */
+
+#ifndef  VCTOOL_BLOCKSTORE_HEADER_GUARD
+# define VCTOOL_BLOCKSTORE_HEADER_GUARD
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <vccrypt/suite.h>
+#include <vctool/file.h>
+#include <vctool/status_codes.h>
+#include <vpr/disposable.h>
+
+/* make this header C++ friendly. */
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* segment magic. */
+#define BLOCKSTORE_SEGMENT_MAGIC                        "VCBLKSG1"
+#define BLOCKSTORE_SEGMENT_MAGIC_SIZE                   8
+
+/* record magic, "VCBR". */
+#define BLOCKSTORE_RECORD_MAGIC                         0x56434252U
+
+/* the size of a record header. */
+#define BLOCKSTORE_RECORD_HEADER_SIZE                   40
+
+/* the number of header bytes covered by the checksum. */
+#define BLOCKSTORE_RECORD_CHECKED_SIZE                  32
+
+/* the size of a block id. */
+#define BLOCKSTORE_BLOCK_ID_SIZE                        16
+
+/* reported for a bad range with no intact record on that side. */
+#define BLOCKSTORE_NO_HEIGHT                            UINT64_MAX
+
+/* summary file suffix. */
+#define BLOCKSTORE_SUMMARY_SUFFIX                       ".summary"
+
+/* summary magic. */
+#define BLOCKSTORE_SUMMARY_MAGIC                        "VCBSUM01"
+#define BLOCKSTORE_SUMMARY_MAGIC_SIZE                   8
+
+/* the size of a summary header. */
+#define BLOCKSTORE_SUMMARY_HEADER_SIZE                  32
+
+/* the number of children of a summary node. */
+#define BLOCKSTORE_SUMMARY_FANOUT                       16
+
+/* enough levels for 2^64 records. */
+#define BLOCKSTORE_SUMMARY_MAX_LEVELS                   17
+
+/**
+ * \brief A damaged range of a segment.
+ */
+typedef struct blockstore_bad_range
+{
+    /** \brief the offset of the first damaged byte. */
+    uint64_t begin;
+
+    /** \brief the offset just past the last damaged byte. */
+    uint64_t end;
+
+    /** \brief the height of the intact record before this range. */
+    uint64_t height_before;
+
+    /** \brief the height of the intact record after this range. */
+    uint64_t height_after;
+} blockstore_bad_range;
+
+/**
+ * \brief Totals from scrubbing a segment.
+ */
+typedef struct blockstore_scrub_result
+{
+    /** \brief the number of intact records. */
+    uint64_t records;
+
+    /** \brief the number of damaged ranges. */
+    uint64_t bad_ranges;
+
+    /** \brief the number of damaged bytes. */
+    uint64_t bad_bytes;
+} blockstore_scrub_result;
+
+/**
+ * \brief Receive a damaged range found by a scrub.
+ *
+ * \param context       The user context passed to blockstore_segment_scrub.
+ * \param path          The path of the segment.
+ * \param range         The damaged range.
+ */
+typedef void (*blockstore_bad_range_fn)(
+    void* context, const char* path, const blockstore_bad_range* range);
+
+/**
+ * \brief Hash tree summary of a segment.
+ */
+typedef struct blockstore_summary
+{
+    /** \brief blockstore_summary is disposable. */
+    disposable_t hdr;
+
+    /** \brief the file abstraction layer. */
+    file* f;
+
+    /** \brief the crypto suite used to hash records. */
+    vccrypt_suite_options_t* suite;
+
+    /** \brief the path of the segment. */
+    char* segment_path;
+
+    /** \brief the path of the summary file. */
+    char* path;
+
+    /** \brief the summary file contents. */
+    uint8_t* data;
+
+    /** \brief the size of the summary file. */
+    size_t size;
+
+    /** \brief set when data is mapped rather than allocated. */
+    bool mapped;
+
+    /** \brief the number of records. */
+    uint64_t record_count;
+
+    /** \brief the size of a hash. */
+    size_t hash_size;
+
+    /** \brief the number of levels; zero for an empty segment. */
+    uint32_t level_count;
+
+    /** \brief the big-endian height of each record. */
+    const uint8_t* heights;
+
+    /** \brief the hashes of each level. */
+    const uint8_t* levels[BLOCKSTORE_SUMMARY_MAX_LEVELS];
+
+    /** \brief the number of hashes in each level. */
+    uint64_t level_sizes[BLOCKSTORE_SUMMARY_MAX_LEVELS];
+} blockstore_summary;
+
+/**
+ * \brief The first range of heights over which two summaries differ.
+ */
+typedef struct blockstore_divergence
+{
+    /** \brief the first height at which the summaries differ. */
+    uint64_t first_height;
+
+    /** \brief the last height of the range. */
+    uint64_t last_height;
+
+    /** \brief the position of the first differing record in each segment. */
+    uint64_t index;
+
+    /** \brief the number of records of the first segment in the range. */
+    uint64_t count_a;
+
+    /** \brief the number of records of the second segment in the range. */
+    uint64_t count_b;
+
+    /** \brief true if the segments match again after the range, and false
+     * if the range runs to the end of either segment. */
+    bool converged;
+} blockstore_divergence;
+
+/**
+ * \brief Append a block to a segment, creating the segment if necessary.
+ *
+ * A segment has a single writer; concurrent appends may interleave.
+ *
+ * \param f             The file abstraction layer to use.
+ * \param path          The path of the segment.
+ * \param height        The block height.
+ * \param block_id      The BLOCKSTORE_BLOCK_ID_SIZE byte block id.
+ * \param block         The block.
+ * \param size          The size of the block.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - VCTOOL_ERROR_BLOCKSTORE_BAD_SEGMENT if path is not a segment.
+ *      - VCTOOL_ERROR_BLOCKSTORE_RECORD_TOO_LARGE if the block is too large.
+ *      - a non-zero error code returned by the file layer.
+ */
+int blockstore_segment_append(
+    file* f, const char* path, uint64_t height, const uint8_t* block_id,
+    const void* block, size_t size);
+
+/**
+ * \brief Verify the checksum of every record in a segment.
+ *
+ * Each damaged range runs from the start of a record which fails to verify to
+ * the next intact record, or the end of the segment.
+ *
+ * \param f             The file abstraction layer to use.
+ * \param path          The path of the segment.
+ * \param result        Totals for this segment.
+ * \param bad_range     Function receiving each damaged range, or NULL.
+ * \param context       The user context passed to bad_range.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS if every record is intact.
+ *      - VCTOOL_ERROR_BLOCKSTORE_CORRUPT if a damaged range was found.
+ *      - VCTOOL_ERROR_BLOCKSTORE_BAD_SEGMENT if path is not a segment.
+ *      - a non-zero error code returned by the file layer.
+ */
+int blockstore_segment_scrub(
+    file* f, const char* path, blockstore_scrub_result* result,
+    blockstore_bad_range_fn bad_range, void* context);
+
+/**
+ * \brief Find the height of the last record of a segment.
+ *
+ * A final record which was torn by a crash during an append is truncated, so
+ * that appending resumes after the last intact record.  A damaged record
+ * before the final one is not repaired.
+ *
+ * \param f             The file abstraction layer to use.
+ * \param path          The path of the segment.
+ * \param height        Set to the height of the last record, or
+ *                      BLOCKSTORE_NO_HEIGHT if the segment is empty or does
+ *                      not exist.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - VCTOOL_ERROR_BLOCKSTORE_BAD_SEGMENT if path is not a segment.
+ *      - VCTOOL_ERROR_BLOCKSTORE_CORRUPT if a record before the final one is
+ *        damaged.
+ *      - a non-zero error code returned by the file layer.
+ */
+int blockstore_segment_tail(file* f, const char* path, uint64_t* height);
+
+/**
+ * \brief Compute the checksum of a record.
+ *
+ * \param header        The BLOCKSTORE_RECORD_HEADER_SIZE byte record header.
+ * \param block         The block.
+ * \param size          The size of the block.
+ *
+ * \returns the CRC-32C of the checked header bytes and the block.
+ */
+uint32_t blockstore_record_checksum(
+    const uint8_t* header, const void* block, size_t size);
+
+/**
+ * \brief Check whether an intact record starts at the given offset.
+ *
+ * \param base          The mapped segment.
+ * \param size          The size of the segment.
+ * \param offset        The offset of the record, at most size.
+ * \param length        Set to the length of the record, including its header,
+ *                      if it is intact.
+ * \param height        Set to the height of the record if it is intact.
+ *
+ * \returns true if an intact record starts at offset.
+ */
+bool blockstore_record_verify(
+    const uint8_t* base, uint64_t size, uint64_t offset, uint64_t* length,
+    uint64_t* height);
+
+/**
+ * \brief Initialize an empty summary for a segment.
+ *
+ * \param summary       The summary to initialize.
+ * \param f             The file abstraction layer to use.
+ * \param suite         The crypto suite used to hash records.
+ * \param segment_path  The path of the segment.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - VCTOOL_ERROR_GENERAL_OUT_OF_MEMORY if an allocation failed.
+ */
+int blockstore_summary_init(
+    blockstore_summary* summary, file* f, vccrypt_suite_options_t* suite,
+    const char* segment_path);
+
+/**
+ * \brief Map the summary file of a segment, if it is up to date.
+ *
+ * \param summary       The summary.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - VCTOOL_ERROR_BLOCKSTORE_STALE_SUMMARY if the segment has changed
+ *        since the summary was built.
+ *      - VCTOOL_ERROR_BLOCKSTORE_BAD_SUMMARY if the summary is malformed or
+ *        was built with a different hash.
+ *      - a non-zero error code returned by the file layer.
+ */
+int blockstore_summary_load(blockstore_summary* summary);
+
+/**
+ * \brief Build the summary of a segment and write its summary file.
+ *
+ * \param summary       The summary.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - VCTOOL_ERROR_BLOCKSTORE_BAD_SEGMENT if the path is not a segment.
+ *      - VCTOOL_ERROR_BLOCKSTORE_CORRUPT if a record is damaged.
+ *      - VCTOOL_ERROR_GENERAL_OUT_OF_MEMORY if an allocation failed.
+ *      - a non-zero error code on failure.
+ */
+int blockstore_summary_build(blockstore_summary* summary);
+
+/**
+ * \brief Set the level pointers of a summary from its file contents.
+ *
+ * \param summary       The summary, whose data and size are set.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - VCTOOL_ERROR_BLOCKSTORE_BAD_SUMMARY if the contents are malformed
+ *        or were built with a different hash.
+ */
+int blockstore_summary_layout(blockstore_summary* summary);
+
+/**
+ * \brief Find the first range of heights over which two summaries differ.
+ *
+ * The common prefix is found by descending only into nodes which differ.
+ * From the first differing record, records are matched by height until a
+ * height holds the same record in both segments, which ends the range.  A
+ * height held by only one segment is part of the range.  Records are expected
+ * in ascending height order, as a chain is appended.
+ *
+ * \param a             The first summary.
+ * \param b             The second summary, built with the same hash.
+ * \param divergence    Set to the first divergent range if the summaries
+ *                      differ.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS if the summaries are identical.
+ *      - VCTOOL_ERROR_BLOCKSTORE_DIVERGED if they differ.
+ */
+int blockstore_summary_diff(
+    const blockstore_summary* a, const blockstore_summary* b,
+    blockstore_divergence* divergence);
+
+/* make this header C++ friendly. */
+#ifdef __cplusplus
+}
+#endif
+
+#endif /*VCTOOL_BLOCKSTORE_HEADER_GUARD*/
@@ -0,0 +1,270 @@
+/**
+ * \file include/vctool/certcache.h
+ *
+ * \brief Persistent cache of verified certificates.
+ *
+ * The certificate cache records the content hash of each certificate that has
+ * passed attestation, together with the version of the resolver context that
+ * was used to verify it.  Before attesting a certificate, the cache is
+ * consulted; a hit means that the same bytes were already verified against the
+ * same contracts, keys, and revocations, and the signature check is skipped.
+ *
+ * \copyright 2020 Velo Payments.  See License.txt for license terms.
+ */
+
+#ifndef  VCTOOL_CERTCACHE_HEADER_GUARD
+# define VCTOOL_CERTCACHE_HEADER_GUARD
+
+#include <lmdb.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <vccrypt/suite.h>
+#include <vctool/extsort.h>
+#include <vctool/file.h>
+#include <vctool/status_codes.h>
+#include <vpr/disposable.h>
+
+/* make this header C++ friendly. */
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* the default cache file, relative to the user's home directory. */
+#define CERTCACHE_DEFAULT_FILENAME                  ".vctool_certcache.mdb"
+
+/* the maximum size of the cache database. */
+#define CERTCACHE_MAP_SIZE                          (1024UL * 1024UL * 1024UL)
+
+/* the initial resolver version, bumped when resolver semantics change. */
+#define CERTCACHE_RESOLVER_VERSION_BASE             0xcbf29ce484222325UL
+
+/* the default number of entries committed per bulk load transaction. */
+#define CERTCACHE_LOADER_BATCH_SIZE                 65536
+
+/* the memory budget for sorting bulk loaded entries. */
+#define CERTCACHE_LOADER_SORT_BUDGET                (64UL * 1024UL * 1024UL)
+
+/* forward decls */
+typedef struct certcache certcache;
+typedef struct certcache_loader certcache_loader;
+
+/**
+ * \brief Certificate verification cache.
+ */
+struct certcache
+{
+    /** \brief certcache is disposable. */
+    disposable_t hdr;
+
+    /** \brief the crypto suite used to hash certificates. */
+    vccrypt_suite_options_t* suite;
+
+    /** \brief path to the cache database file. */
+    char* path;
+
+    /** \brief set when the cache should not be used. */
+    bool disabled;
+
+    /** \brief set once the database has been opened. */
+    bool opened;
+
+    /** \brief the LMDB environment. */
+    MDB_env* env;
+
+    /** \brief the LMDB database handle. */
+    MDB_dbi dbi;
+
+    /** \brief the bulk loader receiving inserts, or NULL. */
+    certcache_loader* loader;
+};
+
+/**
+ * \brief Bulk loader for the certificate cache.
+ *
+ * While a loader is attached to a cache, inserts are collected and sorted
+ * instead of being written one transaction at a time.  Finishing the load
+ * appends the sorted entries in large transactions without syncing, then
+ * syncs the database once.  Entries collected by a loader are not visible to
+ * lookups until the load is finished.
+ */
+struct certcache_loader
+{
+    /** \brief certcache_loader is disposable. */
+    disposable_t hdr;
+
+    /** \brief the cache being loaded. */
+    certcache* cache;
+
+    /** \brief sorts collected entries by key. */
+    extsort sorter;
+
+    /** \brief the size of a cache key. */
+    size_t key_size;
+
+    /** \brief the number of entries committed per transaction. */
+    size_t batch_size;
+
+    /** \brief scratch space for one sort record: key, then value. */
+    uint8_t* record;
+};
+
+/**
+ * \brief Initialize a certificate cache.
+ *
+ * The database is not opened until it is first used.
+ *
+ * \param cache         The cache to initialize.
+ * \param suite         The crypto suite used to hash certificates.
+ * \param path          Path to the cache database file, or NULL to create a
+ *                      disabled cache.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - a non-zero error code on failure.
+ */
+int certcache_init(
+    certcache* cache, vccrypt_suite_options_t* suite, const char* path);
+
+/**
+ * \brief Open the cache database, if it is not already open.
+ *
+ * If the database can't be opened, the cache is disabled for the remainder of
+ * this run.
+ *
+ * \param cache         The cache to open.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - VCTOOL_ERROR_CERTCACHE_DISABLED if the cache is disabled.
+ *      - VCTOOL_ERROR_CERTCACHE_OPEN if the database could not be opened.
+ */
+int certcache_open(certcache* cache);
+
+/**
+ * \brief Look up a certificate in the cache.
+ *
+ * \param cache         The cache to search.
+ * \param cert          The certificate bytes.
+ * \param size          The size of the certificate.
+ * \param version       The resolver context version.
+ * \param found         Set to true if this certificate was verified under this
+ *                      resolver context version, false otherwise.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - VCTOOL_ERROR_CERTCACHE_DISABLED if the cache is disabled.
+ *      - VCTOOL_ERROR_CERTCACHE_READ if the lookup failed.
+ *      - a non-zero error code on failure.
+ */
+int certcache_lookup(
+    certcache* cache, const void* cert, size_t size, uint64_t version,
+    bool* found);
+
+/**
+ * \brief Record a successfully verified certificate in the cache.
+ *
+ * If a bulk loader is attached to this cache, the certificate is collected by
+ * the loader instead.
+ *
+ * \param cache         The cache to update.
+ * \param cert          The certificate bytes.
+ * \param size          The size of the certificate.
+ * \param version       The resolver context version.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - VCTOOL_ERROR_CERTCACHE_DISABLED if the cache is disabled.
+ *      - VCTOOL_ERROR_CERTCACHE_WRITE if the update failed.
+ *      - a non-zero error code on failure.
+ */
+int certcache_insert(
+    certcache* cache, const void* cert, size_t size, uint64_t version);
+
+/**
+ * \brief Attach a bulk loader to a certificate cache.
+ *
+ * \param loader        The loader to initialize.
+ * \param cache         The cache to load, which must not already have a
+ *                      loader attached.
+ * \param f             The file abstraction layer used for sort runs.
+ * \param temp_dir      The directory in which sort runs are created.
+ * \param batch_size    The number of entries committed per transaction, or 0
+ *                      for CERTCACHE_LOADER_BATCH_SIZE.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - VCTOOL_ERROR_CERTCACHE_DISABLED if the cache is disabled.
+ *      - VCTOOL_ERROR_CERTCACHE_OPEN if the database could not be opened.
+ *      - VCTOOL_ERROR_GENERAL_OUT_OF_MEMORY if an allocation failed.
+ */
+int certcache_loader_init(
+    certcache_loader* loader, certcache* cache, file* f, const char* temp_dir,
+    size_t batch_size);
+
+/**
+ * \brief Collect a successfully verified certificate for a bulk load.
+ *
+ * \param loader        The loader.
+ * \param cert          The certificate bytes.
+ * \param size          The size of the certificate.
+ * \param version       The resolver context version.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - a non-zero error code on failure.
+ */
+int certcache_loader_add(
+    certcache_loader* loader, const void* cert, size_t size, uint64_t version);
+
+/**
+ * \brief Write the collected entries to the cache and detach the loader.
+ *
+ * \param loader        The loader.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - VCTOOL_ERROR_CERTCACHE_WRITE if the database could not be updated.
+ *      - a non-zero error code on failure.
+ */
+int certcache_loader_finish(certcache_loader* loader);
+
+/**
+ * \brief Compute the cache key for a certificate.
+ *
+ * The key is the suite hash of the certificate followed by the big-endian
+ * resolver context version.
+ *
+ * \param cache         The cache for this key.
+ * \param key           Buffer to be initialized with the key.  The caller owns
+ *                      this buffer on success and must dispose it.
+ * \param cert          The certificate bytes.
+ * \param size          The size of the certificate.
+ * \param version       The resolver context version.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - a non-zero error code on failure.
+ */
+int certcache_key_create(
+    certcache* cache, vccrypt_buffer_t* key, const void* cert, size_t size,
+    uint64_t version);
+
+/**
+ * \brief Mix resolver context data into a resolver version.
+ *
+ * Anything that changes the outcome of attestation (contract plugins, key
+ * sources, revocation lists) must be mixed into the resolver version, so that
+ * cached results from a different context are not reused.
+ *
+ * \param version       The version to update.
+ * \param data          The data to mix into the version.
+ * \param size          The size of the data.
+ */
+void certcache_version_mix(uint64_t* version, const void* data, size_t size);
+
+/* make this header C++ friendly. */
+#ifdef __cplusplus
+}
+#endif
+
+#endif /*VCTOOL_CERTCACHE_HEADER_GUARD*/
@@ -9,6 +9,7 @@
 #ifndef  VCTOOL_CERTIFICATE_HEADER_GUARD
 # define VCTOOL_CERTIFICATE_HEADER_GUARD
 
+#include <vccert/parser.h>
 #include <vccrypt/buffer.h>
 #include <vctool/commandline.h>
 
@@ -93,6 +94,103 @@ int certificate_decrypt(
     commandline_opts* opts, vccrypt_buffer_t** cert,
     const vccrypt_buffer_t* encrypted_cert, const vccrypt_buffer_t* password);
 
+/**
+ * \brief Read a private entity keypair certificate, decrypting it if needed.
+ *
+ * With a certificate store, key_filename names a reference list in the store
+ * instead of a file.  The file must be accessible to its owner alone.  If it
+ * is encrypted, the passphrase is read with a prompt on standard error, so
+ * that standard output stays free for results.  The certificate is checked
+ * against the private entity schema before it is returned.  Errors are
+ * reported on standard error.
+ *
+ * \param opts              The command-line options to use.
+ * \param keypair           Pointer to the pointer to receive an allocated
+ *                          vccrypt_buffer_t instance holding the decrypted
+ *                          keypair certificate on function success.
+ * \param key_filename      The keypair certificate file.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - VCTOOL_ERROR_CERTIFICATE_BAD_PERMISSIONS if others than the owner
+ *        may access the file.
+ *      - VCTOOL_ERROR_FILE_IO if the file could not be read.
+ *      - VCTOOL_ERROR_CERTSTORE_BAD_REF if the name in the store does not
+ *        refer to exactly one certificate.
+ *      - VCTOOL_ERROR_CERTSCHEMA_UNKNOWN_TYPE if the certificate is valid but
+ *        is not a private entity keypair.
+ *      - a non-zero error code returned by certschema_validate, or on
+ *        failure.
+ */
+int certificate_keypair_load(
+    commandline_opts* opts, vccrypt_buffer_t** keypair,
+    const char* key_filename);
+
+/**
+ * \brief Write a generated certificate, never replacing an existing one.
+ *
+ * Without a certificate store, the certificate is written to a new file.
+ * With one, it is added to the store, and the reference list named by the
+ * last component of output_filename is created to point at it.  Errors are
+ * reported on standard error.
+ *
+ * \param opts              The command-line options to use.
+ * \param output_filename   The output file, or reference name.
+ * \param cert              The certificate to write.
+ * \param mode              The permissions of the file; a stored object gets
+ *                          the read permissions alone.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - VCTOOL_ERROR_FILE_EXISTS if the output already exists.
+ *      - a non-zero error code on failure.
+ */
+int certificate_output_write(
+    commandline_opts* opts, const char* output_filename,
+    const vccrypt_buffer_t* cert, mode_t mode);
+
+/**
+ * \brief Attest a certificate, consulting the certificate cache first.
+ *
+ * If this certificate was already verified at this height under the current
+ * resolver version, the signature check is skipped.  Otherwise, the
+ * certificate is attested and, on success, recorded in the cache.
+ *
+ * \param opts              The command-line options to use.
+ * \param parser_options    The parser options, including resolvers, to use
+ *                          for attestation.
+ * \param cert              The certificate to attest.
+ * \param height            The block height at which to attest.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - a non-zero error code on failure.
+ */
+int certificate_attest(
+    commandline_opts* opts, vccert_parser_options_t* parser_options,
+    const vccrypt_buffer_t* cert, uint64_t height);
+
+/**
+ * \brief Entity key resolver for certificate parser options.
+ *
+ * The parser options context must be the commandline_opts for this command.
+ * Only the entities trusted on the command line resolve.  Revoked entities
+ * never resolve, so every certificate signed by a revoked entity fails
+ * attestation.
+ *
+ * \param options           The parser options.
+ * \param parser            The parser for the certificate being attested.
+ * \param height            The block height of the certificate.
+ * \param entity_id         The entity id to resolve.
+ * \param pubenckey_buffer  Buffer to receive the public encryption key.
+ * \param pubsignkey_buffer Buffer to receive the public signing key.
+ *
+ * \returns true if the entity keys were resolved, and false otherwise.
+ */
+bool certificate_entity_key_resolver(
+    void* options, void* parser, uint64_t height, const uint8_t* entity_id,
+    vccrypt_buffer_t* pubenckey_buffer, vccrypt_buffer_t* pubsignkey_buffer);
+
 /* make this header C++ friendly. */
 #ifdef __cplusplus
 }
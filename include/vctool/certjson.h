@@ -0,0 +1,244 @@
+/**
+ * \file include/vctool/certjson.h
+ *
+ * \brief Conversion between certificates and JSON.
+ *
+ * A certificate is written as a JSON object with one member per field, in
+ * certificate order, on a single line:
+ *
+ *      {"certificate_version":"00010000","certificate_id":"6f3a1c3e-...",
+ *       "0x0400":"68656c6c6f"}
+ *
+ * A field type is named by its VCCERT_FIELD_TYPE_ name in lower case, or as
+ * 0x followed by four hex digits if it has no name.  A value is a canonical
+ * uuid for a field that holds a uuid, and lower case hex bytes otherwise.  A
+ * field which is repeated in a certificate is repeated in its object.  Many
+ * certificates are written as newline delimited JSON, one object per line.
+ *
+ * Names are looked up in a perfect hash table laid out ahead of time, so that
+ * each name lands on its own slot and a lookup hashes once and compares once.
+ * Reading accepts either form of value for any field, and any whitespace
+ * between tokens; since no name or value needs them, strings with escapes are
+ * rejected.
+ *
+ * \copyright 2020 Velo Payments.  See License.txt for license terms.
+ */
+
+#ifndef  VCTOOL_CERTJSON_HEADER_GUARD
+# define VCTOOL_CERTJSON_HEADER_GUARD
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <vctool/file.h>
+#include <vctool/status_codes.h>
+
+/* make this header C++ friendly. */
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* the number of slots in the field name table. */
+#define CERTJSON_FIELD_SLOTS                            32
+
+/* the seed of the name hash, chosen so that no two names share a slot. */
+#define CERTJSON_NAME_SEED                              0x00000A6EU
+
+/* the size of a field header. */
+#define CERTJSON_FIELD_HEADER_SIZE                      4
+
+/* the largest field value. */
+#define CERTJSON_FIELD_MAX                              0xFFFF
+
+/* the size of the writer buffer. */
+#define CERTJSON_WRITER_BUFFER_SIZE                     (64 * 1024)
+
+/**
+ * \brief A named field type.
+ */
+typedef struct certjson_field
+{
+    /** \brief the name of the field type, or NULL for an empty slot. */
+    const char* name;
+
+    /** \brief the length of the name. */
+    size_t length;
+
+    /** \brief the field type. */
+    uint16_t type;
+
+    /** \brief true if the field holds a uuid. */
+    bool uuid;
+} certjson_field;
+
+/**
+ * \brief The field name table, with each name in the slot given by its hash.
+ */
+extern const certjson_field certjson_fields[CERTJSON_FIELD_SLOTS];
+
+/**
+ * \brief Buffered writer of JSON text.
+ *
+ * The writer owns no memory beyond itself, and needs no disposal; text is
+ * written to the descriptor whenever the buffer fills, and by
+ * certjson_writer_flush.
+ */
+typedef struct certjson_writer
+{
+    /** \brief the file abstraction layer. */
+    file* f;
+
+    /** \brief the descriptor written to. */
+    int fd;
+
+    /** \brief the number of bytes buffered. */
+    size_t used;
+
+    /** \brief the buffer. */
+    uint8_t buffer[CERTJSON_WRITER_BUFFER_SIZE];
+} certjson_writer;
+
+/**
+ * \brief Look up a field type by name.
+ *
+ * \param name          The name, which need not be NUL-terminated.
+ * \param length        The length of the name.
+ *
+ * \returns the field, or NULL if no field type has this name.
+ */
+const certjson_field* certjson_field_by_name(const char* name, size_t length);
+
+/**
+ * \brief Look up the name of a field type.
+ *
+ * \param type          The field type.
+ *
+ * \returns the field, or NULL if the field type has no name.
+ */
+const certjson_field* certjson_field_by_type(uint16_t type);
+
+/**
+ * \brief Initialize a writer.
+ *
+ * \param w             The writer to initialize.
+ * \param f             The file abstraction layer.
+ * \param fd            The descriptor to write to.
+ */
+void certjson_writer_init(certjson_writer* w, file* f, int fd);
+
+/**
+ * \brief Write the buffered text.
+ *
+ * \param w             The writer.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - a non-zero error code returned by the file layer.
+ */
+int certjson_writer_flush(certjson_writer* w);
+
+/**
+ * \brief Make room in a writer's buffer, flushing it if needed.
+ *
+ * \param w             The writer.
+ * \param size          The number of bytes needed, which is at most the
+ *                      size of the buffer.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - a non-zero error code returned by the file layer.
+ */
+int certjson_writer_reserve(certjson_writer* w, size_t size);
+
+/**
+ * \brief Write a certificate as a line of JSON.
+ *
+ * \param w             The writer.
+ * \param cert          The certificate.
+ * \param size          The size of the certificate.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - VCTOOL_ERROR_CERTJSON_BAD_CERTIFICATE if a field runs past the end
+ *        of the certificate, in which case nothing was written.
+ *      - a non-zero error code returned by the file layer.
+ */
+int certjson_write(certjson_writer* w, const uint8_t* cert, size_t size);
+
+/**
+ * \brief Start writing a certificate as a line of JSON.
+ *
+ * A certificate whose fields arrive one at a time, such as from a
+ * certstream, is written with certjson_write_begin, then
+ * certjson_write_field for each field, then certjson_write_end.
+ *
+ * \param w             The writer.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - a non-zero error code returned by the file layer.
+ */
+int certjson_write_begin(certjson_writer* w);
+
+/**
+ * \brief Write a field of a certificate as a JSON member.
+ *
+ * \param w             The writer.
+ * \param first         True for the first field of the certificate.
+ * \param type          The field type.
+ * \param value         The field value.
+ * \param size          The size of the value.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - a non-zero error code returned by the file layer.
+ */
+int certjson_write_field(
+    certjson_writer* w, bool first, uint16_t type, const uint8_t* value,
+    size_t size);
+
+/**
+ * \brief Finish writing a certificate as a line of JSON.
+ *
+ * \param w             The writer.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - a non-zero error code returned by the file layer.
+ */
+int certjson_write_end(certjson_writer* w);
+
+/**
+ * \brief Read a certificate from a JSON object.
+ *
+ * A certificate is never larger than the text of its object.
+ *
+ * \param json          The JSON text, starting with the object or the
+ *                      whitespace before it.
+ * \param size          The size of the text.
+ * \param consumed      Set to the size of the text up to the end of the
+ *                      object.
+ * \param cert          Buffer receiving the certificate.
+ * \param capacity      The size of the buffer.
+ * \param cert_size     Set to the size of the certificate.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - VCTOOL_ERROR_CERTJSON_BAD_JSON if the text is not an object of
+ *        string members.
+ *      - VCTOOL_ERROR_CERTJSON_UNKNOWN_FIELD if a key names no field type.
+ *      - VCTOOL_ERROR_CERTJSON_BAD_VALUE if a value is not a uuid or hex
+ *        bytes, or is too large for a field.
+ *      - VCTOOL_ERROR_CERTJSON_BUFFER_TOO_SMALL if the certificate does not
+ *        fit.
+ */
+int certjson_read(
+    const char* json, size_t size, size_t* consumed, uint8_t* cert,
+    size_t capacity, size_t* cert_size);
+
+/* make this header C++ friendly. */
+#ifdef __cplusplus
+}
+#endif
+
+#endif /*VCTOOL_CERTJSON_HEADER_GUARD*/
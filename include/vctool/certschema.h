@@ -0,0 +1,164 @@
+/**
+ * \file include/vctool/certschema.h
+ *
+ * \brief Validation of certificates against the schema of their type.
+ *
+ * Each certificate type has a schema listing the fields a certificate of
+ * that type may hold, which of them are required, and the size each must
+ * have.  A certificate is valid if it holds every required field, no field
+ * outside its schema, no field twice, and every field at its size.  The sizes
+ * of keys and signatures come from the crypto suite.
+ *
+ * The schemas are built once from a table.  Validating a certificate finds
+ * its type, which is almost always the second field, and then checks every
+ * field in a single pass, noting each rule met in a bit mask.
+ *
+ * \copyright 2020 Velo Payments.  See License.txt for license terms.
+ */
+
+#ifndef  VCTOOL_CERTSCHEMA_HEADER_GUARD
+# define VCTOOL_CERTSCHEMA_HEADER_GUARD
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <vccrypt/suite.h>
+#include <vctool/status_codes.h>
+#include <vctool/uuid.h>
+
+/* make this header C++ friendly. */
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* the most rules in a schema; one bit of a mask each. */
+#define CERTSCHEMA_MAX_RULES                            32
+
+/* the most schemas. */
+#define CERTSCHEMA_MAX_TYPES                            8
+
+/* the size of a field header. */
+#define CERTSCHEMA_FIELD_HEADER_SIZE                    4
+
+/**
+ * \brief The sizes of keys and signatures in the crypto suite.
+ */
+typedef struct certschema_sizes
+{
+    /** \brief the size of a public encryption key. */
+    size_t encryption_public_key;
+
+    /** \brief the size of a private encryption key. */
+    size_t encryption_private_key;
+
+    /** \brief the size of a public signing key. */
+    size_t signing_public_key;
+
+    /** \brief the size of a private signing key. */
+    size_t signing_private_key;
+
+    /** \brief the size of a signature. */
+    size_t signature;
+} certschema_sizes;
+
+/**
+ * \brief A field a certificate may hold.
+ */
+typedef struct certschema_rule
+{
+    /** \brief the field type. */
+    uint16_t type;
+
+    /** \brief true if the field is required. */
+    bool required;
+
+    /** \brief the size of the field. */
+    size_t size;
+} certschema_rule;
+
+/**
+ * \brief The schema of a certificate type.
+ */
+typedef struct certschema_type
+{
+    /** \brief the certificate type. */
+    uint8_t type[UUID_SIZE];
+
+    /** \brief the name of the certificate type. */
+    const char* name;
+
+    /** \brief the rules, one per field type. */
+    certschema_rule rules[CERTSCHEMA_MAX_RULES];
+
+    /** \brief the number of rules. */
+    size_t rule_count;
+
+    /** \brief the mask of required rules. */
+    uint32_t required;
+} certschema_type;
+
+/**
+ * \brief The schemas of the known certificate types.
+ *
+ * A schema set owns no memory, and needs no disposal.
+ */
+typedef struct certschema
+{
+    /** \brief the schemas. */
+    certschema_type types[CERTSCHEMA_MAX_TYPES];
+
+    /** \brief the number of schemas. */
+    size_t type_count;
+} certschema;
+
+/**
+ * \brief Read the sizes of keys and signatures from a crypto suite.
+ *
+ * \param sizes         The sizes to initialize.
+ * \param suite         The crypto suite.
+ */
+void certschema_sizes_init(
+    certschema_sizes* sizes, const vccrypt_suite_options_t* suite);
+
+/**
+ * \brief Build the schemas of the known certificate types.
+ *
+ * \param schema        The schema set to initialize.
+ * \param sizes         The sizes of keys and signatures.
+ */
+void certschema_init(certschema* schema, const certschema_sizes* sizes);
+
+/**
+ * \brief Validate a certificate against the schema of its type.
+ *
+ * \param schema        The schema set.
+ * \param cert          The certificate.
+ * \param size          The size of the certificate.
+ * \param type          Set to the schema of the certificate, or NULL if its
+ *                      type is missing or unknown.
+ * \param field         Set to the field type at fault, on failure.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS if the certificate is valid.
+ *      - VCTOOL_ERROR_CERTSCHEMA_BAD_CERTIFICATE if a field runs past the end
+ *        of the certificate.
+ *      - VCTOOL_ERROR_CERTSCHEMA_MISSING_TYPE if the certificate has no
+ *        certificate type.
+ *      - VCTOOL_ERROR_CERTSCHEMA_UNKNOWN_TYPE if there is no schema for the
+ *        certificate type.
+ *      - VCTOOL_ERROR_CERTSCHEMA_UNEXPECTED_FIELD if a field is not in the
+ *        schema.
+ *      - VCTOOL_ERROR_CERTSCHEMA_DUPLICATE_FIELD if a field appears twice.
+ *      - VCTOOL_ERROR_CERTSCHEMA_BAD_FIELD_SIZE if a field has the wrong size.
+ *      - VCTOOL_ERROR_CERTSCHEMA_MISSING_FIELD if a required field is absent.
+ */
+int certschema_validate(
+    const certschema* schema, const uint8_t* cert, size_t size,
+    const certschema_type** type, uint16_t* field);
+
+/* make this header C++ friendly. */
+#ifdef __cplusplus
+}
+#endif
+
+#endif /*VCTOOL_CERTSCHEMA_HEADER_GUARD*/
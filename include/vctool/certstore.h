@@ -0,0 +1,241 @@
+/**
+ * \file include/vctool/certstore.h
+ *
+ * \brief Content-addressed certificate store.
+ *
+ * Each certificate is stored once, in a file named by the hex suite hash of
+ * its bytes:
+ *
+ *      <root>/objects/<first 2 hex digits>/<remaining hex digits>
+ *
+ * Adding a certificate which is already present writes nothing, so every
+ * keystore, bundle, or block store which holds the same certificate shares
+ * one copy on disk, and one copy in the page cache.
+ *
+ * Names, such as a keypair name or an entity uuid, refer to certificates
+ * through reference lists.  A reference list is the file <root>/refs/<name>,
+ * which holds the raw hashes of its certificates back to back.
+ *
+ * Objects and reference lists are written to a temporary file, synced, and
+ * renamed into place, so readers never see a partial write.
+ *
+ * \copyright 2020 Velo Payments.  See License.txt for license terms.
+ */
+
+#ifndef  VCTOOL_CERTSTORE_HEADER_GUARD
+# define VCTOOL_CERTSTORE_HEADER_GUARD
+
+#include <stdint.h>
+#include <vccrypt/suite.h>
+#include <vctool/file.h>
+#include <vctool/status_codes.h>
+#include <vpr/disposable.h>
+
+/* make this header C++ friendly. */
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* the directory holding certificates, relative to the store root. */
+#define CERTSTORE_OBJECTS_DIR                           "objects"
+
+/* the directory holding reference lists, relative to the store root. */
+#define CERTSTORE_REFS_DIR                              "refs"
+
+/**
+ * \brief Content-addressed certificate store.
+ */
+typedef struct certstore
+{
+    /** \brief certstore is disposable. */
+    disposable_t hdr;
+
+    /** \brief the file abstraction layer. */
+    file* f;
+
+    /** \brief the crypto suite used to hash certificates. */
+    vccrypt_suite_options_t* suite;
+
+    /** \brief the root directory of the store. */
+    char* root;
+
+    /** \brief the size of a certificate hash. */
+    size_t hash_size;
+} certstore;
+
+/**
+ * \brief Initialize a certificate store, creating its directories if needed.
+ *
+ * \param store         The store to initialize.
+ * \param f             The file abstraction layer to use.
+ * \param suite         The crypto suite used to hash certificates.
+ * \param root          The root directory of the store.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - VCTOOL_ERROR_GENERAL_OUT_OF_MEMORY if an allocation failed.
+ *      - a non-zero error code returned by the file layer.
+ */
+int certstore_init(
+    certstore* store, file* f, vccrypt_suite_options_t* suite,
+    const char* root);
+
+/**
+ * \brief Compute the hash of a certificate.
+ *
+ * \param store         The store.
+ * \param hash          Buffer receiving the store->hash_size byte hash.
+ * \param cert          The certificate bytes.
+ * \param size          The size of the certificate.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - a non-zero error code on failure.
+ */
+int certstore_hash(
+    certstore* store, uint8_t* hash, const void* cert, size_t size);
+
+/**
+ * \brief Add a certificate to the store, unless it is already present.
+ *
+ * \param store         The store.
+ * \param hash          Buffer receiving the store->hash_size byte hash under
+ *                      which the certificate is stored.
+ * \param cert          The certificate bytes.
+ * \param size          The size of the certificate.
+ * \param mode          The read permissions of a new object, such as
+ *                      S_IRUSR alone for a private keypair.  Objects are
+ *                      never writable.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - a non-zero error code on failure.
+ */
+int certstore_put(
+    certstore* store, uint8_t* hash, const void* cert, size_t size,
+    mode_t mode);
+
+/**
+ * \brief Read a certificate from the store.
+ *
+ * \param store         The store.
+ * \param cert          Buffer to be initialized with the certificate.  The
+ *                      caller owns this buffer on success and must dispose it.
+ * \param hash          The store->hash_size byte hash of the certificate.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - VCTOOL_ERROR_FILE_NO_ENTRY if the certificate is not in the store.
+ *      - a non-zero error code on failure.
+ */
+int certstore_get(
+    certstore* store, vccrypt_buffer_t* cert, const uint8_t* hash);
+
+/**
+ * \brief Replace the reference list for a name.
+ *
+ * \param store         The store.
+ * \param name          The name, which must be a plain file name.
+ * \param hashes        The store->hash_size byte hashes in the list.
+ * \param count         The number of hashes.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - VCTOOL_ERROR_CERTSTORE_BAD_NAME if the name is not valid.
+ *      - a non-zero error code on failure.
+ */
+int certstore_ref_write(
+    certstore* store, const char* name, const uint8_t* hashes, size_t count);
+
+/**
+ * \brief Read the reference list for a name.
+ *
+ * \param store         The store.
+ * \param hashes        Buffer to be initialized with the hashes in the list,
+ *                      back to back.  The caller owns this buffer on success
+ *                      and must dispose it.
+ * \param name          The name.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - VCTOOL_ERROR_CERTSTORE_BAD_NAME if the name is not valid.
+ *      - VCTOOL_ERROR_CERTSTORE_BAD_REF if the list is malformed.
+ *      - VCTOOL_ERROR_FILE_NO_ENTRY if there is no list for this name.
+ *      - a non-zero error code on failure.
+ */
+int certstore_ref_read(
+    certstore* store, vccrypt_buffer_t* hashes, const char* name);
+
+/**
+ * \brief Build the path of the object holding a certificate.
+ *
+ * \param store         The store.
+ * \param path          Pointer to receive the path, which the caller must
+ *                      free.
+ * \param hash          The store->hash_size byte hash of the certificate.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - VCTOOL_ERROR_GENERAL_OUT_OF_MEMORY if an allocation failed.
+ */
+int certstore_object_path(
+    certstore* store, char** path, const uint8_t* hash);
+
+/**
+ * \brief Build the path of the reference list for a name.
+ *
+ * \param store         The store.
+ * \param path          Pointer to receive the path, which the caller must
+ *                      free.
+ * \param name          The name, which must be a plain file name.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - VCTOOL_ERROR_CERTSTORE_BAD_NAME if the name is not valid.
+ *      - VCTOOL_ERROR_GENERAL_OUT_OF_MEMORY if an allocation failed.
+ */
+int certstore_ref_path(certstore* store, char** path, const char* name);
+
+/**
+ * \brief Read a whole store file.
+ *
+ * \param store         The store.
+ * \param data          Buffer to be initialized with the file contents.  The
+ *                      caller owns this buffer on success and must dispose it.
+ * \param path          The path of the file.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - VCTOOL_ERROR_CERTSTORE_CHANGED if the file was replaced while it
+ *        was being read.
+ *      - a non-zero error code on failure.
+ */
+int certstore_file_read(
+    certstore* store, vccrypt_buffer_t* data, const char* path);
+
+/**
+ * \brief Atomically replace a store file.
+ *
+ * The data is written to a temporary file in the same directory, which is
+ * synced and then renamed over path.
+ *
+ * \param store         The store.
+ * \param path          The path of the file.
+ * \param data          The file contents.
+ * \param size          The size of the file contents.
+ * \param mode          The permissions of the file.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - a non-zero error code on failure.
+ */
+int certstore_file_write(
+    certstore* store, const char* path, const void* data, size_t size,
+    mode_t mode);
+
+/* make this header C++ friendly. */
+#ifdef __cplusplus
+}
+#endif
+
+#endif /*VCTOOL_CERTSTORE_HEADER_GUARD*/
@@ -0,0 +1,163 @@
+/**
+ * \file include/vctool/certstream.h
+ *
+ * \brief Incremental parsing of certificates.
+ *
+ * A certificate stream is fed a certificate in chunks of any size, and calls
+ * back with each field as soon as the whole field has arrived.  A field is a
+ * big-endian 2 byte type and 2 byte size, followed by its value, so no field
+ * is larger than CERTSTREAM_FIELD_MAX bytes; fields which lie wholly within a
+ * chunk are passed straight from the chunk, and only a field split between
+ * chunks is copied into the stream.  A block of any size is parsed with a
+ * stream's fixed buffers.
+ *
+ * A VCCERT_FIELD_TYPE_WRAPPED_TRANSACTION_TUPLE field holds a transaction
+ * certificate.  It is passed at depth 0, like any other field of the block,
+ * and then each field of the transaction is passed at depth 1.
+ *
+ * \copyright 2020 Velo Payments.  See License.txt for license terms.
+ */
+
+#ifndef  VCTOOL_CERTSTREAM_HEADER_GUARD
+# define VCTOOL_CERTSTREAM_HEADER_GUARD
+
+#include <stddef.h>
+#include <stdint.h>
+#include <vctool/file.h>
+#include <vctool/status_codes.h>
+
+/* make this header C++ friendly. */
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* the size of a field header. */
+#define CERTSTREAM_FIELD_HEADER_SIZE                    4
+
+/* the size of the largest field, with its header. */
+#define CERTSTREAM_FIELD_MAX \
+    (CERTSTREAM_FIELD_HEADER_SIZE + 0xFFFF)
+
+/* the size of a chunk read by certstream_read. */
+#define CERTSTREAM_CHUNK_SIZE                           (64 * 1024)
+
+/**
+ * \brief A field of a certificate.
+ */
+typedef struct certstream_field
+{
+    /** \brief 0 for a field of the certificate, 1 for a field of a wrapped
+     * transaction. */
+    unsigned depth;
+
+    /** \brief the field type. */
+    uint16_t type;
+
+    /** \brief the value, valid only until the callback returns. */
+    const uint8_t* value;
+
+    /** \brief the size of the value. */
+    size_t size;
+
+    /** \brief the offset of the value from the start of the stream. */
+    uint64_t offset;
+} certstream_field;
+
+/**
+ * \brief Receive a field of a certificate.
+ *
+ * \param context       The user context passed to certstream_init.
+ * \param field         The field.
+ *
+ * \returns VCTOOL_STATUS_SUCCESS to continue, or any other status code to stop
+ *          the stream, which is then returned to the caller.
+ */
+typedef int (*certstream_field_fn)(
+    void* context, const certstream_field* field);
+
+/**
+ * \brief An incremental certificate parser.
+ *
+ * The stream owns no memory beyond itself, and needs no disposal.  It is too
+ * large for the stack.
+ */
+typedef struct certstream
+{
+    /** \brief the field callback. */
+    certstream_field_fn field_fn;
+
+    /** \brief the user context. */
+    void* context;
+
+    /** \brief the offset of the next field from the start of the stream. */
+    uint64_t offset;
+
+    /** \brief the number of bytes held of a field split between chunks. */
+    size_t pending;
+
+    /** \brief the field split between chunks. */
+    uint8_t buffer[CERTSTREAM_FIELD_MAX];
+
+    /** \brief the chunk read by certstream_read. */
+    uint8_t chunk[CERTSTREAM_CHUNK_SIZE];
+} certstream;
+
+/**
+ * \brief Initialize a certificate stream.
+ *
+ * \param stream        The stream to initialize.
+ * \param field_fn      The callback which receives each field.
+ * \param context       The user context for the callback.
+ */
+void certstream_init(
+    certstream* stream, certstream_field_fn field_fn, void* context);
+
+/**
+ * \brief Feed the next chunk of a certificate to a stream.
+ *
+ * Each field completed by this chunk is passed to the callback before this
+ * function returns.  A stream which returned an error must not be fed again.
+ *
+ * \param stream        The stream.
+ * \param data          The chunk.
+ * \param size          The size of the chunk, which may be zero.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - VCTOOL_ERROR_CERTSTREAM_BAD_TRANSACTION if a field of a wrapped
+ *        transaction runs past the end of the transaction.
+ *      - a non-zero status code returned by the callback.
+ */
+int certstream_feed(certstream* stream, const uint8_t* data, size_t size);
+
+/**
+ * \brief Check that a certificate stream ended between fields.
+ *
+ * \param stream        The stream.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - VCTOOL_ERROR_CERTSTREAM_TRUNCATED if the stream ended inside a field.
+ */
+int certstream_finish(const certstream* stream);
+
+/**
+ * \brief Parse a certificate read from a descriptor until end of file.
+ *
+ * \param stream        The stream.
+ * \param f             The file abstraction layer.
+ * \param fd            The descriptor to read from.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - VCTOOL_ERROR_CERTSTREAM_TRUNCATED if the file ended inside a field.
+ *      - a non-zero error code returned by certstream_feed or the file layer.
+ */
+int certstream_read(certstream* stream, file* f, int fd);
+
+/* make this header C++ friendly. */
+#ifdef __cplusplus
+}
+#endif
+
+#endif /*VCTOOL_CERTSTREAM_HEADER_GUARD*/
@@ -0,0 +1,197 @@
+/**
+ * \file include/vctool/certtemplate.h
+ *
+ * \brief Declarative certificate templates.
+ *
+ * A certificate template describes the fields of a certificate, in order,
+ * with one line per field:
+ *
+ *      # comments and blank lines are ignored.
+ *      certificate_version     uint32  0x00010000
+ *      certificate_type        uuid    6f3a1c3e-4ab1-4c71-9d3a-1f08e1b7b6a1
+ *      artifact_id             uuid    $1
+ *      public_encryption_key   hex     $2
+ *      0x0400                  string  $3
+ *
+ * The first word is a field type, either by name (the VCCERT_FIELD_TYPE_
+ * name in lower case) or as a number.  The second is the kind of the value:
+ * uint8, uint16, uint32 or uint64, written big-endian; uuid, 16 bytes; hex,
+ * bytes written as hex digits; or string, the bytes as written.  The rest of
+ * the line is the value, either a literal or $N for column N of each row.
+ *
+ * A template is compiled once into a layout.  Literal fields, and the
+ * headers of fields filled from rows, are encoded ahead of time into runs of
+ * bytes which are copied as they are; a value filled from a row whose kind
+ * has a fixed size, and which follows no value of variable size, sits at a
+ * fixed offset in every certificate.  Filling a row then computes the exact
+ * size of the certificate from the sizes of its variable values, and writes
+ * it in one pass.
+ *
+ * \copyright 2020 Velo Payments.  See License.txt for license terms.
+ */
+
+#ifndef  VCTOOL_CERTTEMPLATE_HEADER_GUARD
+# define VCTOOL_CERTTEMPLATE_HEADER_GUARD
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <vctool/status_codes.h>
+#include <vpr/disposable.h>
+
+/* make this header C++ friendly. */
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* value kinds. */
+#define CERTTEMPLATE_UINT8                              0x00000001U
+#define CERTTEMPLATE_UINT16                             0x00000002U
+#define CERTTEMPLATE_UINT32                             0x00000003U
+#define CERTTEMPLATE_UINT64                             0x00000004U
+#define CERTTEMPLATE_UUID                               0x00000005U
+#define CERTTEMPLATE_HEX                                0x00000006U
+#define CERTTEMPLATE_STRING                             0x00000007U
+
+/* the kind of the step which ends a template. */
+#define CERTTEMPLATE_END                                0x00000000U
+
+/* the offset of a value which is not at a fixed offset. */
+#define CERTTEMPLATE_VARIABLE                           SIZE_MAX
+
+/* the size of a field header. */
+#define CERTTEMPLATE_FIELD_HEADER_SIZE                  4
+
+/* the largest field value. */
+#define CERTTEMPLATE_FIELD_MAX                          0xFFFF
+
+/**
+ * \brief A step of a compiled template: a run of literal bytes, followed by
+ * a value from a row column.
+ */
+typedef struct certtemplate_step
+{
+    /** \brief the offset of the literal run in the template literals. */
+    size_t literal_offset;
+
+    /** \brief the size of the literal run. */
+    size_t literal_size;
+
+    /** \brief the kind of the value, or CERTTEMPLATE_END. */
+    uint32_t kind;
+
+    /** \brief the zero-based column holding the value. */
+    size_t column;
+
+    /** \brief the size of the value, or zero if its size is variable. */
+    size_t size;
+
+    /** \brief the offset of the value in the certificate, or
+     * CERTTEMPLATE_VARIABLE. */
+    size_t offset;
+} certtemplate_step;
+
+/**
+ * \brief Compiled certificate template.
+ */
+typedef struct certtemplate
+{
+    /** \brief certtemplate is disposable. */
+    disposable_t hdr;
+
+    /** \brief the steps, ending with a CERTTEMPLATE_END step. */
+    certtemplate_step* steps;
+
+    /** \brief the number of steps. */
+    size_t step_count;
+
+    /** \brief the encoded literal runs. */
+    uint8_t* literals;
+
+    /** \brief the size of the literal runs. */
+    size_t literal_size;
+
+    /** \brief the size of a certificate whose variable values are empty. */
+    size_t fixed_size;
+
+    /** \brief the number of values of variable size. */
+    size_t variable_count;
+
+    /** \brief the number of columns a row must have. */
+    size_t column_count;
+
+    /** \brief the largest certificate the template can produce. */
+    size_t max_size;
+} certtemplate;
+
+/**
+ * \brief Compile a certificate template.
+ *
+ * \param tmpl          The template to initialize.
+ * \param text          The template text.
+ * \param size          The size of the template text.
+ * \param line          Set to the line number of an error.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - VCTOOL_ERROR_CERTTEMPLATE_BAD_TEMPLATE if a line is malformed.
+ *      - VCTOOL_ERROR_GENERAL_OUT_OF_MEMORY if an allocation failed.
+ */
+int certtemplate_compile(
+    certtemplate* tmpl, const char* text, size_t size, size_t* line);
+
+/**
+ * \brief Encode a value of a kind as field bytes.
+ *
+ * Integers are decimal, or hex with a 0x prefix.  Uuids are canonical or 32
+ * bare hex digits.
+ *
+ * \param kind          The kind of the value.
+ * \param value         The value, which need not be NUL-terminated.
+ * \param size          The size of the value.
+ * \param out           Buffer receiving the encoded value, large enough for
+ *                      the kind's size, half of size for hex, or size for a
+ *                      string.
+ * \param out_size      Set to the size of the encoded value.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - VCTOOL_ERROR_CERTTEMPLATE_BAD_VALUE if the value does not match its
+ *        kind.
+ */
+int certtemplate_encode(
+    uint32_t kind, const char* value, size_t size, uint8_t* out,
+    size_t* out_size);
+
+/**
+ * \brief Fill a template with a row, writing the certificate.
+ *
+ * \param tmpl          The compiled template.
+ * \param values        The column values of the row, which need not be
+ *                      NUL-terminated.
+ * \param value_sizes   The size of each column value.
+ * \param count         The number of columns.
+ * \param cert          Buffer receiving the certificate.
+ * \param capacity      The size of the buffer; max_size always suffices.
+ * \param cert_size     Set to the size of the certificate.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - VCTOOL_ERROR_CERTTEMPLATE_MISSING_COLUMN if the row has too few
+ *        columns.
+ *      - VCTOOL_ERROR_CERTTEMPLATE_BAD_VALUE if a value does not match its
+ *        kind.
+ *      - VCTOOL_ERROR_CERTTEMPLATE_BUFFER_TOO_SMALL if the certificate does
+ *        not fit; cert_size is set to the size needed.
+ */
+int certtemplate_fill(
+    const certtemplate* tmpl, const char* const* values,
+    const size_t* value_sizes, size_t count, uint8_t* cert, size_t capacity,
+    size_t* cert_size);
+
+/* make this header C++ friendly. */
+#ifdef __cplusplus
+}
+#endif
+
+#endif /*VCTOOL_CERTTEMPLATE_HEADER_GUARD*/
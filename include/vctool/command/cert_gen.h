@@ -0,0 +1,68 @@
+/**
+ * \file include/vctool/command/cert_gen.h
+ *
+ * \brief Cert-gen command structure.
+ *
+ * \copyright 2020 Velo Payments.  See License.txt for license terms.
+ */
+
+#ifndef  VCTOOL_COMMAND_CERT_GEN_HEADER_GUARD
+# define VCTOOL_COMMAND_CERT_GEN_HEADER_GUARD
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <vctool/commandline.h>
+
+/* make this header C++ friendly. */
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct cert_gen_command
+{
+    command hdr;
+    const char* template_file;
+    const char* rows_file;
+    const char* output_dir;
+} cert_gen_command;
+
+/**
+ * \brief Initialize a cert-gen command structure.
+ *
+ * \param cert_gen      The cert-gen command structure to initialize.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - a non-zero error code on failure.
+ */
+int cert_gen_command_init(cert_gen_command* cert_gen);
+
+/**
+ * \brief Process the cert-gen command.
+ *
+ * \param opts          The command-line option structure.
+ * \param argc          The argument count.
+ * \param argv          The argument vector.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - a non-zero error code on failure.
+ */
+int process_cert_gen_command(commandline_opts* opts, int argc, char* argv[]);
+
+/**
+ * \brief Execute the cert-gen command.
+ *
+ * \param opts          The commandline opts for this operation.
+ *
+ * \returns a status code indicating success or failure.
+ *      - a non-zero error code on failure.
+ */
+int cert_gen_command_func(commandline_opts* opts);
+
+/* make this header C++ friendly. */
+#ifdef __cplusplus
+}
+#endif
+
+#endif /*VCTOOL_COMMAND_CERT_GEN_HEADER_GUARD*/
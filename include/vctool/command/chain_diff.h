@@ -0,0 +1,70 @@
+/**
+ * \file include/vctool/command/chain_diff.h
+ *
+ * \brief Chain-diff command structure.
+ *
+ * \copyright 2020 Velo Payments.  See License.txt for license terms.
+ */
+
+#ifndef  VCTOOL_COMMAND_CHAIN_DIFF_HEADER_GUARD
+# define VCTOOL_COMMAND_CHAIN_DIFF_HEADER_GUARD
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <vctool/commandline.h>
+
+/* make this header C++ friendly. */
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct chain_diff_command
+{
+    command hdr;
+    const char* segment_a;
+    const char* segment_b;
+} chain_diff_command;
+
+/**
+ * \brief Initialize a chain-diff command structure.
+ *
+ * \param chain_diff    The chain-diff command structure to initialize.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - a non-zero error code on failure.
+ */
+int chain_diff_command_init(chain_diff_command* chain_diff);
+
+/**
+ * \brief Process the chain-diff command.
+ *
+ * \param opts          The command-line option structure.
+ * \param argc          The argument count.
+ * \param argv          The argument vector.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - a non-zero error code on failure.
+ */
+int process_chain_diff_command(
+    commandline_opts* opts, int argc, char* argv[]);
+
+/**
+ * \brief Execute the chain-diff command.
+ *
+ * \param opts          The commandline opts for this operation.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - VCTOOL_ERROR_BLOCKSTORE_DIVERGED if the segments differ.
+ *      - a non-zero error code on failure.
+ */
+int chain_diff_command_func(commandline_opts* opts);
+
+/* make this header C++ friendly. */
+#ifdef __cplusplus
+}
+#endif
+
+#endif /*VCTOOL_COMMAND_CHAIN_DIFF_HEADER_GUARD*/
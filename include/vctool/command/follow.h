@@ -0,0 +1,69 @@
+/**
+ * \file include/vctool/command/follow.h
+ *
+ * \brief Follow command structure.
+ *
+ * \copyright 2020 Velo Payments.  See License.txt for license terms.
+ */
+
+#ifndef  VCTOOL_COMMAND_FOLLOW_HEADER_GUARD
+# define VCTOOL_COMMAND_FOLLOW_HEADER_GUARD
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <vctool/commandline.h>
+
+/* make this header C++ friendly. */
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct follow_command
+{
+    command hdr;
+    const char* agent_address;
+    const char* segment;
+    const char* output_address;
+} follow_command;
+
+/**
+ * \brief Initialize a follow command structure.
+ *
+ * \param follow        The follow command structure to initialize.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - a non-zero error code on failure.
+ */
+int follow_command_init(follow_command* follow);
+
+/**
+ * \brief Process the follow command.
+ *
+ * \param opts          The command-line option structure.
+ * \param argc          The argument count.
+ * \param argv          The argument vector.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - a non-zero error code on failure.
+ */
+int process_follow_command(commandline_opts* opts, int argc, char* argv[]);
+
+/**
+ * \brief Execute the follow command.
+ *
+ * \param opts          The commandline opts for this operation.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - a non-zero error code on failure.
+ */
+int follow_command_func(commandline_opts* opts);
+
+/* make this header C++ friendly. */
+#ifdef __cplusplus
+}
+#endif
+
+#endif /*VCTOOL_COMMAND_FOLLOW_HEADER_GUARD*/
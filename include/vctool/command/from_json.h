@@ -0,0 +1,67 @@
+/**
+ * \file include/vctool/command/from_json.h
+ *
+ * \brief Cert-gen command structure.
+ *
+ * \copyright 2020 Velo Payments.  See License.txt for license terms.
+ */
+
+#ifndef  VCTOOL_COMMAND_FROM_JSON_HEADER_GUARD
+# define VCTOOL_COMMAND_FROM_JSON_HEADER_GUARD
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <vctool/commandline.h>
+
+/* make this header C++ friendly. */
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct from_json_command
+{
+    command hdr;
+    const char* json_file;
+    const char* output_dir;
+} from_json_command;
+
+/**
+ * \brief Initialize a from-json command structure.
+ *
+ * \param from_json     The from-json command structure to initialize.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - a non-zero error code on failure.
+ */
+int from_json_command_init(from_json_command* from_json);
+
+/**
+ * \brief Process the from-json command.
+ *
+ * \param opts          The command-line option structure.
+ * \param argc          The argument count.
+ * \param argv          The argument vector.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - a non-zero error code on failure.
+ */
+int process_from_json_command(commandline_opts* opts, int argc, char* argv[]);
+
+/**
+ * \brief Execute the from-json command.
+ *
+ * \param opts          The commandline opts for this operation.
+ *
+ * \returns a status code indicating success or failure.
+ *      - a non-zero error code on failure.
+ */
+int from_json_command_func(commandline_opts* opts);
+
+/* make this header C++ friendly. */
+#ifdef __cplusplus
+}
+#endif
+
+#endif /*VCTOOL_COMMAND_FROM_JSON_HEADER_GUARD*/
@@ -0,0 +1,68 @@
+/**
+ * \file include/vctool/command/query_serve.h
+ *
+ * \brief Query-serve command structure.
+ *
+ * \copyright 2020 Velo Payments.  See License.txt for license terms.
+ */
+
+#ifndef  VCTOOL_COMMAND_QUERY_SERVE_HEADER_GUARD
+# define VCTOOL_COMMAND_QUERY_SERVE_HEADER_GUARD
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <vctool/commandline.h>
+
+/* make this header C++ friendly. */
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct query_serve_command
+{
+    command hdr;
+    const char* segment;
+    const char* socket_path;
+} query_serve_command;
+
+/**
+ * \brief Initialize a query-serve command structure.
+ *
+ * \param query_serve   The query-serve command structure to initialize.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - a non-zero error code on failure.
+ */
+int query_serve_command_init(query_serve_command* query_serve);
+
+/**
+ * \brief Process the query-serve command.
+ *
+ * \param opts          The command-line option structure.
+ * \param argc          The argument count.
+ * \param argv          The argument vector.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - a non-zero error code on failure.
+ */
+int process_query_serve_command(
+    commandline_opts* opts, int argc, char* argv[]);
+
+/**
+ * \brief Execute the query-serve command.
+ *
+ * \param opts          The commandline opts for this operation.
+ *
+ * \returns a status code indicating success or failure.
+ *      - a non-zero error code on failure.
+ */
+int query_serve_command_func(commandline_opts* opts);
+
+/* make this header C++ friendly. */
+#ifdef __cplusplus
+}
+#endif
+
+#endif /*VCTOOL_COMMAND_QUERY_SERVE_HEADER_GUARD*/
@@ -0,0 +1,69 @@
+/**
+ * \file include/vctool/command/replay_serve.h
+ *
+ * \brief Replay-serve command structure.
+ *
+ * \copyright 2020 Velo Payments.  See License.txt for license terms.
+ */
+
+#ifndef  VCTOOL_COMMAND_REPLAY_SERVE_HEADER_GUARD
+# define VCTOOL_COMMAND_REPLAY_SERVE_HEADER_GUARD
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <vctool/commandline.h>
+
+/* make this header C++ friendly. */
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct replay_serve_command
+{
+    command hdr;
+    const char* recording;
+    const char* socket_path;
+    unsigned latency_percent;
+} replay_serve_command;
+
+/**
+ * \brief Initialize a replay-serve command structure.
+ *
+ * \param replay_serve  The replay-serve command structure to initialize.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - a non-zero error code on failure.
+ */
+int replay_serve_command_init(replay_serve_command* replay_serve);
+
+/**
+ * \brief Process the replay-serve command.
+ *
+ * \param opts          The command-line option structure.
+ * \param argc          The argument count.
+ * \param argv          The argument vector.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - a non-zero error code on failure.
+ */
+int process_replay_serve_command(
+    commandline_opts* opts, int argc, char* argv[]);
+
+/**
+ * \brief Execute the replay-serve command.
+ *
+ * \param opts          The commandline opts for this operation.
+ *
+ * \returns a status code indicating success or failure.
+ *      - a non-zero error code on failure.
+ */
+int replay_serve_command_func(commandline_opts* opts);
+
+/* make this header C++ friendly. */
+#ifdef __cplusplus
+}
+#endif
+
+#endif /*VCTOOL_COMMAND_REPLAY_SERVE_HEADER_GUARD*/
@@ -0,0 +1,80 @@
+/**
+ * \file include/vctool/command/revoke.h
+ *
+ * \brief Revoke command structure.
+ *
+ * \copyright 2020 Velo Payments.  See License.txt for license terms.
+ */
+
+#ifndef  VCTOOL_COMMAND_REVOKE_HEADER_GUARD
+# define VCTOOL_COMMAND_REVOKE_HEADER_GUARD
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <vctool/commandline.h>
+
+/* make this header C++ friendly. */
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * \brief Revoke subcommands.
+ */
+typedef enum revoke_action
+{
+    REVOKE_ACTION_ADD,
+    REVOKE_ACTION_CHECK,
+} revoke_action;
+
+typedef struct revoke_command
+{
+    command hdr;
+    revoke_action action;
+    const char* list_filename;
+    char** ids;
+    int id_count;
+} revoke_command;
+
+/**
+ * \brief Initialize a revoke command structure.
+ *
+ * \param revoke        The revoke command structure to initialize.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - a non-zero error code on failure.
+ */
+int revoke_command_init(revoke_command* revoke);
+
+/**
+ * \brief Process the revoke command.
+ *
+ * \param opts          The command-line option structure.
+ * \param argc          The argument count.
+ * \param argv          The argument vector.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - a non-zero error code on failure.
+ */
+int process_revoke_command(commandline_opts* opts, int argc, char* argv[]);
+
+/**
+ * \brief Execute the revoke command.
+ *
+ * \param opts          The commandline opts for this operation.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - VCTOOL_ERROR_REVOCATION_REVOKED if a checked id is revoked.
+ *      - a non-zero error code on failure.
+ */
+int revoke_command_func(commandline_opts* opts);
+
+/* make this header C++ friendly. */
+#ifdef __cplusplus
+}
+#endif
+
+#endif /*VCTOOL_COMMAND_REVOKE_HEADER_GUARD*/
@@ -0,0 +1,69 @@
+/**
+ * \file include/vctool/command/scrub.h
+ *
+ * \brief Scrub command structure.
+ *
+ * \copyright 2020 Velo Payments.  See License.txt for license terms.
+ */
+
+#ifndef  VCTOOL_COMMAND_SCRUB_HEADER_GUARD
+# define VCTOOL_COMMAND_SCRUB_HEADER_GUARD
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <vctool/commandline.h>
+
+/* make this header C++ friendly. */
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct scrub_command
+{
+    command hdr;
+    char** segments;
+    int segment_count;
+} scrub_command;
+
+/**
+ * \brief Initialize a scrub command structure.
+ *
+ * \param scrub         The scrub command structure to initialize.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - a non-zero error code on failure.
+ */
+int scrub_command_init(scrub_command* scrub);
+
+/**
+ * \brief Process the scrub command.
+ *
+ * \param opts          The command-line option structure.
+ * \param argc          The argument count.
+ * \param argv          The argument vector.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - a non-zero error code on failure.
+ */
+int process_scrub_command(commandline_opts* opts, int argc, char* argv[]);
+
+/**
+ * \brief Execute the scrub command.
+ *
+ * \param opts          The commandline opts for this operation.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - VCTOOL_ERROR_BLOCKSTORE_CORRUPT if a segment is damaged.
+ *      - a non-zero error code on failure.
+ */
+int scrub_command_func(commandline_opts* opts);
+
+/* make this header C++ friendly. */
+#ifdef __cplusplus
+}
+#endif
+
+#endif /*VCTOOL_COMMAND_SCRUB_HEADER_GUARD*/
@@ -0,0 +1,78 @@
+/**
+ * \file include/vctool/command/submit.h
+ *
+ * \brief Submit command structure.
+ *
+ * \copyright 2020 Velo Payments.  See License.txt for license terms.
+ */
+
+#ifndef  VCTOOL_COMMAND_SUBMIT_HEADER_GUARD
+# define VCTOOL_COMMAND_SUBMIT_HEADER_GUARD
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <vctool/commandline.h>
+
+/* make this header C++ friendly. */
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* the largest number of submissions in flight. */
+#define SUBMIT_COMMAND_MAX_WINDOW                       32
+
+/* the number of times a transaction is resubmitted to a busy agent. */
+#define SUBMIT_COMMAND_RETRIES                          16
+
+/* delays before resubmitting to a busy agent, in milliseconds. */
+#define SUBMIT_COMMAND_RETRY_MIN_MS                     10
+#define SUBMIT_COMMAND_RETRY_MAX_MS                     1000
+
+typedef struct submit_command
+{
+    command hdr;
+    const char* agent_address;
+    char** txn_files;
+    size_t txn_count;
+} submit_command;
+
+/**
+ * \brief Initialize a submit command structure.
+ *
+ * \param submit        The submit command structure to initialize.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - a non-zero error code on failure.
+ */
+int submit_command_init(submit_command* submit);
+
+/**
+ * \brief Process the submit command.
+ *
+ * \param opts          The command-line option structure.
+ * \param argc          The argument count.
+ * \param argv          The argument vector.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - a non-zero error code on failure.
+ */
+int process_submit_command(commandline_opts* opts, int argc, char* argv[]);
+
+/**
+ * \brief Execute the submit command.
+ *
+ * \param opts          The commandline opts for this operation.
+ *
+ * \returns a status code indicating success or failure.
+ *      - a non-zero error code on failure.
+ */
+int submit_command_func(commandline_opts* opts);
+
+/* make this header C++ friendly. */
+#ifdef __cplusplus
+}
+#endif
+
+#endif /*VCTOOL_COMMAND_SUBMIT_HEADER_GUARD*/
@@ -0,0 +1,67 @@
+/**
+ * \file include/vctool/command/to_json.h
+ *
+ * \brief Cert-gen command structure.
+ *
+ * \copyright 2020 Velo Payments.  See License.txt for license terms.
+ */
+
+#ifndef  VCTOOL_COMMAND_TO_JSON_HEADER_GUARD
+# define VCTOOL_COMMAND_TO_JSON_HEADER_GUARD
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <vctool/commandline.h>
+
+/* make this header C++ friendly. */
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct to_json_command
+{
+    command hdr;
+    char** cert_files;
+    size_t cert_count;
+} to_json_command;
+
+/**
+ * \brief Initialize a to-json command structure.
+ *
+ * \param to_json       The to-json command structure to initialize.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - a non-zero error code on failure.
+ */
+int to_json_command_init(to_json_command* to_json);
+
+/**
+ * \brief Process the to-json command.
+ *
+ * \param opts          The command-line option structure.
+ * \param argc          The argument count.
+ * \param argv          The argument vector.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - a non-zero error code on failure.
+ */
+int process_to_json_command(commandline_opts* opts, int argc, char* argv[]);
+
+/**
+ * \brief Execute the to-json command.
+ *
+ * \param opts          The commandline opts for this operation.
+ *
+ * \returns a status code indicating success or failure.
+ *      - a non-zero error code on failure.
+ */
+int to_json_command_func(commandline_opts* opts);
+
+/* make this header C++ friendly. */
+#ifdef __cplusplus
+}
+#endif
+
+#endif /*VCTOOL_COMMAND_TO_JSON_HEADER_GUARD*/
@@ -0,0 +1,68 @@
+/**
+ * \file include/vctool/command/txn_status.h
+ *
+ * \brief Txn-status command structure.
+ *
+ * \copyright 2020 Velo Payments.  See License.txt for license terms.
+ */
+
+#ifndef  VCTOOL_COMMAND_TXN_STATUS_HEADER_GUARD
+# define VCTOOL_COMMAND_TXN_STATUS_HEADER_GUARD
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <vctool/commandline.h>
+
+/* make this header C++ friendly. */
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct txn_status_command
+{
+    command hdr;
+    const char* agent_address;
+    const char* txn_id_file;
+    const char* segment;
+} txn_status_command;
+
+/**
+ * \brief Initialize a txn-status command structure.
+ *
+ * \param txn_status    The txn-status command structure to initialize.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - a non-zero error code on failure.
+ */
+int txn_status_command_init(txn_status_command* txn_status);
+
+/**
+ * \brief Process the txn-status command.
+ *
+ * \param opts          The command-line option structure.
+ * \param argc          The argument count.
+ * \param argv          The argument vector.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - a non-zero error code on failure.
+ */
+int process_txn_status_command(commandline_opts* opts, int argc, char* argv[]);
+
+/**
+ * \brief Execute the txn-status command.
+ *
+ * \param opts          The commandline opts for this operation.
+ *
+ * \returns a status code indicating success or failure.
+ *      - a non-zero error code on failure.
+ */
+int txn_status_command_func(commandline_opts* opts);
+
+/* make this header C++ friendly. */
+#ifdef __cplusplus
+}
+#endif
+
+#endif /*VCTOOL_COMMAND_TXN_STATUS_HEADER_GUARD*/
@@ -0,0 +1,70 @@
+/**
+ * \file include/vctool/command/validate.h
+ *
+ * \brief Validate command structure.
+ *
+ * \copyright 2020 Velo Payments.  See License.txt for license terms.
+ */
+
+#ifndef  VCTOOL_COMMAND_VALIDATE_HEADER_GUARD
+# define VCTOOL_COMMAND_VALIDATE_HEADER_GUARD
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <vctool/commandline.h>
+
+/* make this header C++ friendly. */
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct validate_command
+{
+    command hdr;
+    char** cert_files;
+    int cert_file_count;
+} validate_command;
+
+/**
+ * \brief Initialize a validate command structure.
+ *
+ * \param validate      The validate command structure to initialize.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - a non-zero error code on failure.
+ */
+int validate_command_init(validate_command* validate);
+
+/**
+ * \brief Process the validate command.
+ *
+ * \param opts          The command-line option structure.
+ * \param argc          The argument count.
+ * \param argv          The argument vector.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - a non-zero error code on failure.
+ */
+int process_validate_command(commandline_opts* opts, int argc, char* argv[]);
+
+/**
+ * \brief Execute the validate command.
+ *
+ * \param opts          The commandline opts for this operation.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - VCTOOL_ERROR_CERTSCHEMA_INVALID if a certificate is invalid or
+ *        could not be read.
+ *      - a non-zero error code on failure.
+ */
+int validate_command_func(commandline_opts* opts);
+
+/* make this header C++ friendly. */
+#ifdef __cplusplus
+}
+#endif
+
+#endif /*VCTOOL_COMMAND_VALIDATE_HEADER_GUARD*/
@@ -0,0 +1,72 @@
+/**
+ * \file include/vctool/command/verify.h
+ *
+ * \brief Verify command structure.
+ *
+ * \copyright 2020 Velo Payments.  See License.txt for license terms.
+ */
+
+#ifndef  VCTOOL_COMMAND_VERIFY_HEADER_GUARD
+# define VCTOOL_COMMAND_VERIFY_HEADER_GUARD
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <vctool/commandline.h>
+
+/* make this header C++ friendly. */
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct verify_command
+{
+    command hdr;
+    uint64_t height;
+    char** cert_files;
+    int cert_file_count;
+} verify_command;
+
+/**
+ * \brief Initialize a verify command structure.
+ *
+ * \param verify        The verify command structure to initialize.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - a non-zero error code on failure.
+ */
+int verify_command_init(verify_command* verify);
+
+/**
+ * \brief Process the verify command.
+ *
+ * \param opts          The command-line option structure.
+ * \param argc          The argument count.
+ * \param argv          The argument vector.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - a non-zero error code on failure.
+ */
+int process_verify_command(commandline_opts* opts, int argc, char* argv[]);
+
+/**
+ * \brief Execute the verify command.
+ *
+ * \param opts          The commandline opts for this operation.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - VCTOOL_ERROR_CERTIFICATE_ATTESTATION if a certificate failed
+ *        attestation or could not be read.
+ *      - a non-zero error code on failure.
+ */
+int verify_command_func(commandline_opts* opts);
+
+/* make this header C++ friendly. */
+#ifdef __cplusplus
+}
+#endif
+
+#endif /*VCTOOL_COMMAND_VERIFY_HEADER_GUARD*/
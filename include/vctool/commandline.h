@@ -11,7 +11,11 @@
 
 #include <vccert/builder.h>
 #include <vccrypt/suite.h>
+#include <vctool/agent.h>
+#include <vctool/certcache.h>
+#include <vctool/contract.h>
 #include <vctool/file.h>
+#include <vctool/revocation.h>
 #include <vpr/disposable.h>
 
 /* make this header C++ friendly. */
@@ -21,8 +25,27 @@ extern "C" {
 
 /* forward decls */
 typedef struct commandline_opts commandline_opts;
+typedef struct commandline_entity commandline_entity;
 typedef struct command command;
 
+/**
+ * \brief an entity whose public keys are trusted for attestation.
+ */
+struct commandline_entity
+{
+    /** \brief the next trusted entity, or NULL. */
+    commandline_entity* next;
+
+    /** \brief the entity id. */
+    uint8_t id[16];
+
+    /** \brief the public encryption key of this entity. */
+    vccrypt_buffer_t encryption_pubkey;
+
+    /** \brief the public signing key of this entity. */
+    vccrypt_buffer_t signing_pubkey;
+};
+
 /**
  * \brief commandline options.
  */
@@ -40,6 +63,30 @@ struct commandline_opts
     /** \brief certificate builder options to use with this command. */
     vccert_builder_options_t* builder_opts;
 
+    /** \brief transaction contracts for this command. */
+    contract_registry contracts;
+
+    /** \brief trusted entities, or NULL if none are loaded. */
+    commandline_entity* entities;
+
+    /** \brief cache of verified certificates. */
+    certcache certcache;
+
+    /** \brief revoked entities, or NULL if no revocation list is loaded. */
+    revocation_set* revocations;
+
+    /** \brief version of the resolver context used for attestation. */
+    uint64_t resolver_version;
+
+    /** \brief captures agent traffic, or NULL if it is not recorded. */
+    agent_recorder* agent_recorder;
+
+    /** \brief the path of the submission journal, or NULL if none. */
+    const char* journal_path;
+
+    /** \brief the certificate store for keys, or NULL to use plain files. */
+    const char* store_path;
+
     /** \brief command context with config. */
     command* cmd;
 };
@@ -43,6 +43,86 @@ enum vctool_components
      * \brief certificate Component.
      */
     VCTOOL_COMPONENT_CERTIFICATE = 0x04U,
+
+    /**
+     * \brief contract Component.
+     */
+    VCTOOL_COMPONENT_CONTRACT = 0x05U,
+
+    /**
+     * \brief certcache Component.
+     */
+    VCTOOL_COMPONENT_CERTCACHE = 0x06U,
+
+    /**
+     * \brief uuid Component.
+     */
+    VCTOOL_COMPONENT_UUID = 0x07U,
+
+    /**
+     * \brief revocation Component.
+     */
+    VCTOOL_COMPONENT_REVOCATION = 0x08U,
+
+    /**
+     * \brief mph Component.
+     */
+    VCTOOL_COMPONENT_MPH = 0x09U,
+
+    /**
+     * \brief extsort Component.
+     */
+    VCTOOL_COMPONENT_EXTSORT = 0x0AU,
+
+    /**
+     * \brief blockstore Component.
+     */
+    VCTOOL_COMPONENT_BLOCKSTORE = 0x0BU,
+
+    /**
+     * \brief certstore Component.
+     */
+    VCTOOL_COMPONENT_CERTSTORE = 0x0CU,
+
+    /**
+     * \brief agent Component.
+     */
+    VCTOOL_COMPONENT_AGENT = 0x0DU,
+
+    /**
+     * \brief query Component.
+     */
+    VCTOOL_COMPONENT_QUERY = 0x0EU,
+
+    /**
+     * \brief journal Component.
+     */
+    VCTOOL_COMPONENT_JOURNAL = 0x0FU,
+
+    /**
+     * \brief scheduler Component.
+     */
+    VCTOOL_COMPONENT_SCHEDULER = 0x10U,
+
+    /**
+     * \brief certtemplate Component.
+     */
+    VCTOOL_COMPONENT_CERTTEMPLATE = 0x11U,
+
+    /**
+     * \brief certjson Component.
+     */
+    VCTOOL_COMPONENT_CERTJSON = 0x12U,
+
+    /**
+     * \brief certschema Component.
+     */
+    VCTOOL_COMPONENT_CERTSCHEMA = 0x13U,
+
+    /**
+     * \brief certstream Component.
+     */
+    VCTOOL_COMPONENT_CERTSTREAM = 0x14U,
 };
 
 /* make this header C++ friendly. */
@@ -0,0 +1,215 @@
+/**
+ * \file include/vctool/contract.h
+ *
+ * \brief Registry of transaction contracts.
+ *
+ * The contract registry maps a (transaction type, artifact type) pair to the
+ * contract function which validates transactions of that type.  Contracts are
+ * registered up front, either as built-ins or by site-specific plugins, and
+ * then resolved by the certificate parser during attestation.
+ *
+ * \copyright 2020 Velo Payments.  See License.txt for license terms.
+ */
+
+#ifndef  VCTOOL_CONTRACT_HEADER_GUARD
+# define VCTOOL_CONTRACT_HEADER_GUARD
+
+#include <stdint.h>
+#include <vccert/parser.h>
+#include <vctool/certschema.h>
+#include <vctool/status_codes.h>
+#include <vpr/disposable.h>
+
+/* make this header C++ friendly. */
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* the size of a type uuid. */
+#define CONTRACT_TYPE_SIZE                              16
+
+/* the number of per-thread contract cache slots.  Must be a power of two. */
+#define CONTRACT_THREAD_CACHE_SIZE                      16
+
+/* the symbol exported by a contract plugin. */
+#define CONTRACT_PLUGIN_INIT_SYMBOL             "vctool_contract_plugin_init"
+
+/* forward decls */
+typedef struct contract_registry contract_registry;
+typedef struct contract_registry_entry contract_registry_entry;
+
+/**
+ * \brief Contract plugin init function.
+ *
+ * A site-specific contract plugin is a shared object exporting a function with
+ * this signature under the name CONTRACT_PLUGIN_INIT_SYMBOL.  The function
+ * registers the plugin's contracts with the given registry.
+ *
+ * \param registry      The registry with which contracts are registered.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - a non-zero error code on failure.
+ */
+typedef int (*contract_plugin_init_fn)(contract_registry* registry);
+
+/**
+ * \brief A registered contract.
+ */
+struct contract_registry_entry
+{
+    /** \brief the transaction type for this contract. */
+    uint8_t transaction_type[CONTRACT_TYPE_SIZE];
+
+    /** \brief the artifact type for this contract, or all zeroes for any. */
+    uint8_t artifact_type[CONTRACT_TYPE_SIZE];
+
+    /** \brief the contract function. */
+    vccert_contract_fn_t contract_fn;
+
+    /** \brief user context passed to the contract function. */
+    void* context;
+};
+
+/**
+ * \brief Contract registry.
+ */
+struct contract_registry
+{
+    /** \brief contract_registry is disposable. */
+    disposable_t hdr;
+
+    /** \brief registered contracts, sorted by transaction / artifact type. */
+    contract_registry_entry* entries;
+
+    /** \brief the number of registered contracts. */
+    size_t count;
+
+    /** \brief the number of entries allocated. */
+    size_t reserved;
+
+    /** \brief generation of this registry, used to invalidate caches. */
+    uint64_t generation;
+
+    /** \brief handles of loaded plugins. */
+    void** plugins;
+
+    /** \brief the number of loaded plugins. */
+    size_t plugin_count;
+
+    /** \brief the schemas checked by the built-in contracts. */
+    certschema schema;
+};
+
+/**
+ * \brief Initialize an empty contract registry.
+ *
+ * \param registry      The registry to initialize.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - a non-zero error code on failure.
+ */
+int contract_registry_init(contract_registry* registry);
+
+/**
+ * \brief Register a contract for the given transaction and artifact type.
+ *
+ * \param registry          The registry to which this contract is added.
+ * \param transaction_type  The transaction type uuid.
+ * \param artifact_type     The artifact type uuid, or NULL to register this
+ *                          contract for any artifact type.
+ * \param contract_fn       The contract function.
+ * \param context           User context passed to the contract function.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - VCTOOL_ERROR_CONTRACT_DUPLICATE if a contract is already registered
+ *        for this type pair.
+ *      - VCTOOL_ERROR_GENERAL_OUT_OF_MEMORY if an allocation failed.
+ */
+int contract_registry_register(
+    contract_registry* registry, const uint8_t* transaction_type,
+    const uint8_t* artifact_type, vccert_contract_fn_t contract_fn,
+    void* context);
+
+/**
+ * \brief Register the built-in contracts with a contract registry.
+ *
+ * Each certificate type created by this tool has a built-in contract, for any
+ * artifact type, which holds if the certificate matches the schema of its
+ * type.  The schemas are built here, once, with the key and signature sizes
+ * of the given suite.  Plugins add contracts for other transaction types.
+ *
+ * \param registry      The registry to which contracts are added.
+ * \param suite         The crypto suite for this registry.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - a non-zero error code returned by contract_registry_register.
+ */
+int contract_registry_register_builtins(
+    contract_registry* registry, const vccrypt_suite_options_t* suite);
+
+/**
+ * \brief Find the contract for the given transaction and artifact type.
+ *
+ * An exact match is preferred; otherwise, a contract registered for any
+ * artifact type with this transaction type is returned.  Results are cached
+ * per thread, so repeated lookups for the same type pair do not search the
+ * registry.
+ *
+ * \param registry          The registry to search.
+ * \param entry             Pointer to receive the registry entry on success.
+ * \param transaction_type  The transaction type uuid.
+ * \param artifact_type     The artifact type uuid, or NULL if unknown.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - VCTOOL_ERROR_CONTRACT_NOT_FOUND if no contract matches.
+ */
+int contract_registry_find(
+    const contract_registry* registry, const contract_registry_entry** entry,
+    const uint8_t* transaction_type, const uint8_t* artifact_type);
+
+/**
+ * \brief Load a site-specific contract plugin into this registry.
+ *
+ * \param registry      The registry to which contracts are added.
+ * \param path          Path to the plugin shared object.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - VCTOOL_ERROR_CONTRACT_PLUGIN_LOAD if the plugin could not be loaded.
+ *      - VCTOOL_ERROR_CONTRACT_PLUGIN_SYMBOL if the plugin has no init
+ *        function.
+ *      - a non-zero error code returned by the plugin init function.
+ */
+int contract_registry_load_plugin(
+    contract_registry* registry, const char* path);
+
+/**
+ * \brief Contract resolver for certificate parser options.
+ *
+ * The parser options context must be the commandline_opts for this command.
+ *
+ * \param options           The parser options.
+ * \param parser            The parser for the transaction being attested.
+ * \param type_id           The transaction type uuid.
+ * \param artifact_id       The artifact id.
+ * \param closure           The closure to populate with the contract.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - VCTOOL_ERROR_CONTRACT_NOT_FOUND if no contract matches.
+ */
+int contract_registry_resolve(
+    void* options, void* parser, const uint8_t* type_id,
+    const uint8_t* artifact_id, vccert_contract_closure_t* closure);
+
+/* make this header C++ friendly. */
+#ifdef __cplusplus
+}
+#endif
+
+#endif /*VCTOOL_CONTRACT_HEADER_GUARD*/
@@ -0,0 +1,44 @@
+/**
+ * \file include/vctool/crc32c.h
+ *
+ * \brief CRC-32C (Castagnoli) checksums.
+ *
+ * CRC-32C is used to detect storage corruption cheaply, without repeating
+ * cryptographic verification.  On x86-64 processors with SSE4.2, and on ARM
+ * processors built with the CRC extension, the checksum instruction is used;
+ * elsewhere, a slicing-by-8 table implementation is used.
+ *
+ * \copyright 2020 Velo Payments.  See License.txt for license terms.
+ */
+
+#ifndef  VCTOOL_CRC32C_HEADER_GUARD
+# define VCTOOL_CRC32C_HEADER_GUARD
+
+#include <stddef.h>
+#include <stdint.h>
+
+/* make this header C++ friendly. */
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * \brief Extend a CRC-32C checksum with more data.
+ *
+ * Start with a crc of 0; the checksum of data split across several calls is
+ * the same as the checksum of the whole.
+ *
+ * \param crc           The checksum of the preceding data, or 0.
+ * \param data          The data to checksum.
+ * \param size          The size of the data.
+ *
+ * \returns the checksum of the preceding data followed by this data.
+ */
+uint32_t crc32c(uint32_t crc, const void* data, size_t size);
+
+/* make this header C++ friendly. */
+#ifdef __cplusplus
+}
+#endif
+
+#endif /*VCTOOL_CRC32C_HEADER_GUARD*/
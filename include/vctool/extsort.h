@@ -0,0 +1,302 @@
+/**
+ * \file include/vctool/extsort.h
+ *
+ * \brief External merge sort of fixed size records.
+ *
+ * Records are buffered up to a memory budget.  When the buffer fills, it is
+ * split into one chunk per thread, each chunk is sorted by its own thread, and
+ * the sorted chunks are merged in memory into a single temporary run file,
+ * written through the file abstraction layer.  Finishing the sort merges the
+ * runs with a loser tree, in several passes if there are more runs than the
+ * budget allows to be open at once.  If every record fits in the budget,
+ * nothing is written and the sorted chunks are merged directly from memory.
+ *
+ * \copyright 2020 Velo Payments.  See License.txt for license terms.
+ */
+
+#ifndef  VCTOOL_EXTSORT_HEADER_GUARD
+# define VCTOOL_EXTSORT_HEADER_GUARD
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <vctool/file.h>
+#include <vctool/status_codes.h>
+#include <vpr/disposable.h>
+
+/* make this header C++ friendly. */
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* the smallest read buffer given to each run during a merge. */
+#define EXTSORT_MIN_BLOCK_SIZE                          (64 * 1024)
+
+/* the largest number of runs merged in one pass. */
+#define EXTSORT_MAX_FAN_IN                              128
+
+/* the minimum number of records handed to each sort thread. */
+#define EXTSORT_MIN_RECORDS_PER_THREAD                  16384
+
+/**
+ * \brief Receive the next record in sorted order.
+ *
+ * \param context       The user context passed to extsort_finish.
+ * \param record        The record.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - a non-zero error code to stop the sort.
+ */
+typedef int (*extsort_output_fn)(void* context, const void* record);
+
+/**
+ * \brief External merge sort.
+ */
+typedef struct extsort
+{
+    /** \brief extsort is disposable. */
+    disposable_t hdr;
+
+    /** \brief the file abstraction layer used for runs. */
+    file* f;
+
+    /** \brief the directory in which runs are created. */
+    char* temp_dir;
+
+    /** \brief the size of each record. */
+    size_t record_size;
+
+    /** \brief the number of leading record bytes compared with memcmp. */
+    size_t key_size;
+
+    /** \brief the memory budget in bytes. */
+    size_t memory_budget;
+
+    /** \brief the number of sort threads. */
+    unsigned threads;
+
+    /** \brief buffered records. */
+    uint8_t* buffer;
+
+    /** \brief the number of records which fit in the buffer. */
+    size_t capacity;
+
+    /** \brief the number of buffered records. */
+    size_t count;
+
+    /** \brief the end of each sorted chunk of the buffer. */
+    size_t* chunk_ends;
+
+    /** \brief the number of sorted chunks. */
+    unsigned chunk_count;
+
+    /** \brief paths of the runs which have not been merged yet. */
+    char** runs;
+
+    /** \brief the number of runs. */
+    size_t run_count;
+
+    /** \brief the number of run paths allocated. */
+    size_t run_reserved;
+
+    /** \brief the number of runs created so far, used to name runs. */
+    size_t run_serial;
+} extsort;
+
+/**
+ * \brief A sorted source of records being merged.
+ *
+ * A source with a negative descriptor is a range of memory, which has no more
+ * records once exhausted; otherwise, its buffer is refilled from the run open
+ * on fd.
+ */
+typedef struct extsort_source
+{
+    /** \brief the next record. */
+    const uint8_t* next;
+
+    /** \brief the end of the buffered records. */
+    const uint8_t* end;
+
+    /** \brief the read buffer of a run. */
+    uint8_t* buffer;
+
+    /** \brief the size of the read buffer. */
+    size_t buffer_size;
+
+    /** \brief the run, open for reading, or -1 for memory. */
+    int fd;
+} extsort_source;
+
+/**
+ * \brief Buffered writer for a run.
+ */
+typedef struct extsort_run_writer
+{
+    /** \brief the sorter which owns the run. */
+    extsort* sorter;
+
+    /** \brief the run, open for writing. */
+    int fd;
+
+    /** \brief the write buffer. */
+    uint8_t* buffer;
+
+    /** \brief the size of the write buffer; a multiple of the record size. */
+    size_t buffer_size;
+
+    /** \brief the number of bytes buffered. */
+    size_t used;
+} extsort_run_writer;
+
+/**
+ * \brief Initialize an external merge sort.
+ *
+ * \param sorter        The sorter to initialize.
+ * \param f             The file abstraction layer used for runs.
+ * \param temp_dir      The directory in which runs are created.
+ * \param record_size   The size of each record.
+ * \param key_size      The number of leading record bytes compared with
+ *                      memcmp; at most record_size.
+ * \param memory_budget The memory budget in bytes, which must hold at least
+ *                      one record.
+ * \param threads       The number of sort threads, or 0 to use one per
+ *                      online processor.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - VCTOOL_ERROR_GENERAL_OUT_OF_MEMORY if an allocation failed.
+ */
+int extsort_init(
+    extsort* sorter, file* f, const char* temp_dir, size_t record_size,
+    size_t key_size, size_t memory_budget, unsigned threads);
+
+/**
+ * \brief Add a record to an external merge sort.
+ *
+ * If the buffer is full, the buffered records are first sorted and spilled
+ * to runs.  Records may not be added once the sort is finished.
+ *
+ * \param sorter        The sorter.
+ * \param record        The record_size byte record to copy.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - a non-zero error code if the buffer could not be spilled.
+ */
+int extsort_add(extsort* sorter, const void* record);
+
+/**
+ * \brief Sort the buffered records in parallel chunks.
+ *
+ * The buffer is split into one chunk per thread, and each chunk is sorted by
+ * its own thread.  If spill is true, the sorted chunks are then merged into a
+ * single new run and the buffer is emptied; otherwise, the chunk boundaries
+ * are kept in chunk_ends for an in-memory merge.
+ *
+ * \param sorter        The sorter.
+ * \param spill         True if the sorted chunks are written to runs.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - a non-zero error code if a run could not be written.
+ */
+int extsort_sort_chunks(extsort* sorter, bool spill);
+
+/**
+ * \brief Create a new, empty run and add it to the sorter's runs.
+ *
+ * \param sorter        The sorter.
+ * \param d             Pointer to receive the descriptor of the run, open for
+ *                      writing.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - VCTOOL_ERROR_GENERAL_OUT_OF_MEMORY if an allocation failed.
+ *      - a non-zero error code returned by file_open.
+ */
+int extsort_run_create(extsort* sorter, int* d);
+
+/**
+ * \brief Merge sorted sources with a loser tree.
+ *
+ * \param sorter        The sorter.
+ * \param sources       The sources to merge.
+ * \param count         The number of sources.
+ * \param output        The function which receives each sorted record.
+ * \param context       The user context passed to output.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - VCTOOL_ERROR_EXTSORT_BAD_RUN if a run was truncated.
+ *      - VCTOOL_ERROR_GENERAL_OUT_OF_MEMORY if an allocation failed.
+ *      - a non-zero error code returned by output or the file layer.
+ */
+int extsort_merge(
+    extsort* sorter, extsort_source* sources, size_t count,
+    extsort_output_fn output, void* context);
+
+/**
+ * \brief Refill the buffer of an exhausted source.
+ *
+ * Memory sources have no more records once exhausted.
+ *
+ * \param sorter        The sorter.
+ * \param source        The source to refill.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - VCTOOL_ERROR_EXTSORT_BAD_RUN if the run was truncated.
+ *      - a non-zero error code returned by file_read.
+ */
+int extsort_source_fill(extsort* sorter, extsort_source* source);
+
+/**
+ * \brief Append a record to a run, as an extsort_output_fn.
+ *
+ * \param context       The extsort_run_writer.
+ * \param record        The record.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - a non-zero error code returned by the file layer.
+ */
+int extsort_run_write(void* context, const void* record);
+
+/**
+ * \brief Write the buffered records of a run.
+ *
+ * \param writer        The run writer.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - a non-zero error code returned by file_write_all.
+ */
+int extsort_run_flush(extsort_run_writer* writer);
+
+/**
+ * \brief Finish an external merge sort, passing every record to output in
+ * sorted order.
+ *
+ * Equal keys are not merged; output may skip duplicates if needed.  Runs are
+ * removed as they are merged.
+ *
+ * \param sorter        The sorter.
+ * \param output        The function which receives each sorted record.
+ * \param context       The user context passed to output.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - VCTOOL_ERROR_EXTSORT_BAD_RUN if a run was truncated.
+ *      - VCTOOL_ERROR_GENERAL_OUT_OF_MEMORY if an allocation failed.
+ *      - a non-zero error code returned by output or the file layer.
+ */
+int extsort_finish(extsort* sorter, extsort_output_fn output, void* context);
+
+/* make this header C++ friendly. */
+#ifdef __cplusplus
+}
+#endif
+
+#endif /*VCTOOL_EXTSORT_HEADER_GUARD*/
@@ -57,6 +57,30 @@ struct file
     /** \brief write method. */
     int (*file_write_method)(file*, int, const void*, size_t, size_t*);
 
+    /** \brief mmap method. */
+    int (*file_mmap_method)(file*, void**, int, size_t);
+
+    /** \brief munmap method. */
+    int (*file_munmap_method)(file*, void*, size_t);
+
+    /** \brief rename method. */
+    int (*file_rename_method)(file*, const char*, const char*);
+
+    /** \brief unlink method. */
+    int (*file_unlink_method)(file*, const char*);
+
+    /** \brief mkdir method. */
+    int (*file_mkdir_method)(file*, const char*, mode_t);
+
+    /** \brief sendfile method. */
+    int (*file_sendfile_method)(file*, int, int, off_t, size_t, size_t*);
+
+    /** \brief fsync method. */
+    int (*file_fsync_method)(file*, int);
+
+    /** \brief ftruncate method. */
+    int (*file_ftruncate_method)(file*, int, off_t);
+
     /** \brief context structure. */
     void* context;
 };
@@ -219,6 +243,199 @@ int file_read(file* f, int d, void* buf, size_t max, size_t* rbytes);
  */
 int file_write(file* f, int d, const void* buf, size_t max, size_t* wbytes);
 
+/**
+ * \brief Map a file descriptor into memory, read-only.
+ *
+ * \param f         The file interface.
+ * \param addr      Pointer to receive the address of the mapping.
+ * \param d         The descriptor to map.
+ * \param size      The number of bytes to map, starting at offset 0.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - VCTOOL_ERROR_FILE_ACCESS if the descriptor was not opened for read.
+ *      - VCTOOL_ERROR_FILE_BAD_DESCRIPTOR if the file descriptor is bad.
+ *      - VCTOOL_ERROR_FILE_INVALID_FLAGS if the size is invalid.
+ *      - VCTOOL_ERROR_FILE_NOT_SUPPORTED if this file can't be mapped.
+ *      - VCTOOL_ERROR_FILE_KERNEL_MEMORY if the kernel ran out of memory.
+ *      - VCTOOL_ERROR_FILE_OVERFLOW if the mapping would overflow.
+ *      - VCTOOL_ERROR_FILE_UNKNOWN if an unknown error occurred.
+ */
+int file_mmap(file* f, void** addr, int d, size_t size);
+
+/**
+ * \brief Unmap a region mapped with file_mmap.
+ *
+ * \param f         The file interface.
+ * \param addr      The address of the mapping.
+ * \param size      The size of the mapping.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - VCTOOL_ERROR_FILE_INVALID_FLAGS if the address or size are invalid.
+ *      - VCTOOL_ERROR_FILE_UNKNOWN if an unknown error occurred.
+ */
+int file_munmap(file* f, void* addr, size_t size);
+
+/**
+ * \brief Atomically rename a file, replacing any existing file.
+ *
+ * \param f         The file interface.
+ * \param oldpath   The current path of the file.
+ * \param newpath   The new path of the file.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - VCTOOL_ERROR_FILE_ACCESS if permission was denied.
+ *      - VCTOOL_ERROR_FILE_IS_DIRECTORY if newpath is a directory.
+ *      - VCTOOL_ERROR_FILE_LOOP if too many symlinks were encountered.
+ *      - VCTOOL_ERROR_FILE_NAME_TOO_LONG if a path name is too long.
+ *      - VCTOOL_ERROR_FILE_NO_ENTRY if oldpath does not exist.
+ *      - VCTOOL_ERROR_FILE_KERNEL_MEMORY if the kernel ran out of memory.
+ *      - VCTOOL_ERROR_FILE_NO_SPACE if there is no space left on the device.
+ *      - VCTOOL_ERROR_FILE_NOT_DIRECTORY if a component of a path is not a
+ *        directory.
+ *      - VCTOOL_ERROR_FILE_NOT_SUPPORTED if the paths are on different
+ *        filesystems or the filesystem is read-only.
+ *      - VCTOOL_ERROR_FILE_QUOTA if user quota has been exceeded.
+ *      - VCTOOL_ERROR_FILE_UNKNOWN if an unknown error occurred.
+ */
+int file_rename(file* f, const char* oldpath, const char* newpath);
+
+/**
+ * \brief Remove a file.
+ *
+ * \param f         The file interface.
+ * \param path      The path of the file to remove.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - VCTOOL_ERROR_FILE_ACCESS if permission was denied.
+ *      - VCTOOL_ERROR_FILE_IS_DIRECTORY if path is a directory.
+ *      - VCTOOL_ERROR_FILE_LOOP if too many symlinks were encountered.
+ *      - VCTOOL_ERROR_FILE_NAME_TOO_LONG if the path name is too long.
+ *      - VCTOOL_ERROR_FILE_NO_ENTRY if path does not exist.
+ *      - VCTOOL_ERROR_FILE_KERNEL_MEMORY if the kernel ran out of memory.
+ *      - VCTOOL_ERROR_FILE_NOT_DIRECTORY if a component of the path is not a
+ *        directory.
+ *      - VCTOOL_ERROR_FILE_NOT_SUPPORTED if the filesystem is read-only.
+ *      - VCTOOL_ERROR_FILE_UNKNOWN if an unknown error occurred.
+ */
+int file_unlink(file* f, const char* path);
+
+/**
+ * \brief Create a directory.
+ *
+ * \param f         The file interface.
+ * \param path      The path of the directory to create.
+ * \param mode      The permissions of the new directory.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - VCTOOL_ERROR_FILE_ACCESS if permission was denied.
+ *      - VCTOOL_ERROR_FILE_QUOTA if the user's quota has been exhausted.
+ *      - VCTOOL_ERROR_FILE_EXISTS if path already exists.
+ *      - VCTOOL_ERROR_FILE_LOOP if too many symlinks were encountered.
+ *      - VCTOOL_ERROR_FILE_NAME_TOO_LONG if the path name is too long.
+ *      - VCTOOL_ERROR_FILE_NO_ENTRY if a parent directory does not exist.
+ *      - VCTOOL_ERROR_FILE_KERNEL_MEMORY if the kernel ran out of memory.
+ *      - VCTOOL_ERROR_FILE_NO_SPACE if the device is out of space.
+ *      - VCTOOL_ERROR_FILE_NOT_DIRECTORY if a component of the path is not a
+ *        directory.
+ *      - VCTOOL_ERROR_FILE_NOT_SUPPORTED if the filesystem is read-only.
+ *      - VCTOOL_ERROR_FILE_UNKNOWN if an unknown error occurred.
+ */
+int file_mkdir(file* f, const char* path, mode_t mode);
+
+/**
+ * \brief Copy bytes from a file to a descriptor without passing them through
+ * user space.
+ *
+ * The file offset of the input descriptor is not changed, so several threads
+ * may send from the same descriptor.
+ *
+ * \param f         The file interface.
+ * \param out       The descriptor to which data is written.
+ * \param in        The file descriptor from which data is read.
+ * \param offset    The offset in the input file at which to start.
+ * \param max       The maximum number of bytes to copy.
+ * \param sbytes    Pointer to receive the number of bytes copied.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - VCTOOL_ERROR_FILE_WOULD_BLOCK if the output descriptor is
+ *        non-blocking and full.
+ *      - VCTOOL_ERROR_FILE_BAD_DESCRIPTOR if a file descriptor is bad.
+ *      - VCTOOL_ERROR_FILE_FAULT if the offset is outside of the address
+ *        space.
+ *      - VCTOOL_ERROR_FILE_INVALID_FLAGS if a descriptor does not support
+ *        this operation.
+ *      - VCTOOL_ERROR_FILE_IO if an I/O error occurred.
+ *      - VCTOOL_ERROR_FILE_KERNEL_MEMORY if the kernel ran out of memory.
+ *      - VCTOOL_ERROR_FILE_OVERFLOW if the count is too large.
+ *      - VCTOOL_ERROR_FILE_BROKEN_PIPE if the reader closed the connection.
+ *      - VCTOOL_ERROR_FILE_UNKNOWN if an unknown error occurred.
+ */
+int file_sendfile(
+    file* f, int out, int in, off_t offset, size_t max, size_t* sbytes);
+
+/**
+ * \brief Flush the data written to a file descriptor to stable storage.
+ *
+ * Metadata which is not needed to read the data back, such as the access
+ * time, may not be flushed.
+ *
+ * \param f         The file interface.
+ * \param d         The file descriptor to flush.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - VCTOOL_ERROR_FILE_BAD_DESCRIPTOR if the descriptor is bad.
+ *      - VCTOOL_ERROR_FILE_INVALID_FLAGS if the descriptor does not support
+ *        flushing.
+ *      - VCTOOL_ERROR_FILE_IO if an I/O error occurred.
+ *      - VCTOOL_ERROR_FILE_NO_SPACE if the device is out of space.
+ *      - VCTOOL_ERROR_FILE_QUOTA if the user's quota has been exhausted.
+ *      - VCTOOL_ERROR_FILE_UNKNOWN if an unknown error occurred.
+ */
+int file_fsync(file* f, int d);
+
+/**
+ * \brief Truncate the file open on a descriptor to a length.
+ *
+ * \param f         The file interface.
+ * \param d         The file descriptor, open for writing.
+ * \param length    The new length of the file.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - VCTOOL_ERROR_FILE_BAD_DESCRIPTOR if the descriptor is bad or not
+ *        open for writing.
+ *      - VCTOOL_ERROR_FILE_INVALID_FLAGS if the descriptor does not support
+ *        truncation or the length is invalid.
+ *      - VCTOOL_ERROR_FILE_IO if an I/O error occurred.
+ *      - VCTOOL_ERROR_FILE_UNKNOWN if an unknown error occurred.
+ */
+int file_ftruncate(file* f, int d, off_t length);
+
+/**
+ * \brief Write an entire buffer to a file descriptor.
+ *
+ * Unlike file_write, this retries short writes until the whole buffer has been
+ * written.
+ *
+ * \param f         The file interface.
+ * \param d         The descriptor to which data is written.
+ * \param buf       The buffer to write from.
+ * \param size      The number of bytes to write.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - VCTOOL_ERROR_FILE_IO if the descriptor stopped accepting data.
+ *      - a non-zero error code returned by file_write.
+ */
+int file_write_all(file* f, int d, const void* buf, size_t size);
+
 /* make this header C++ friendly. */
 #ifdef __cplusplus
 }
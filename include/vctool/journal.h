@@ -0,0 +1,268 @@
+/**
+ * \file include/vctool/journal.h
+ *
+ * \brief Crash-safe journal of bulk transaction submissions.
+ *
+ * A submission journal records which transactions have been sent to an agent
+ * and which the agent has acknowledged, so that an interrupted bulk submit can
+ * be restarted: acknowledged transactions are skipped, and transactions which
+ * were sent but never acknowledged are uncertain and are sent again.
+ *
+ * The journal is an append-only file which starts with JOURNAL_MAGIC and is
+ * followed by JOURNAL_RECORD_SIZE byte big-endian records:
+ *
+ *      offset  size    field
+ *      0       4       JOURNAL_SUBMITTED or JOURNAL_ACKNOWLEDGED
+ *      4       16      transaction id
+ *      20      4       CRC-32C of bytes 0-19
+ *
+ * Records are buffered in memory and written by journal_commit.  Commits are
+ * grouped: while one thread writes and flushes the buffer, others append
+ * behind it, and the next commit writes and flushes all of their records
+ * with a single fsync.  A record which was torn by a crash fails its checksum
+ * and is ignored; a torn tail is padded out to a whole record when the
+ * journal is opened, so later records stay aligned.
+ *
+ * Opening a journal reads it once, interning each transaction id in a uuid
+ * dictionary with the state of that transaction, so looking up a transaction
+ * is a hash probe and only the distinct ids are held in memory.
+ *
+ * So that reopening a long journal doesn't replay every record, the state of
+ * each transaction is saved beside the journal, in a checkpoint file named
+ * with JOURNAL_CHECKPOINT_SUFFIX, when opening replayed at least
+ * JOURNAL_CHECKPOINT_RECORDS records and at least as many records as there
+ * are transactions.  Opening then loads the checkpoint and replays only the
+ * records after it.  The checkpoint is big-endian:
+ *
+ *      offset  size    field
+ *      0       8       JOURNAL_CHECKPOINT_MAGIC
+ *      8       8       the journal offset covered by the checkpoint
+ *      16      4       the checksum of the last covered record
+ *      20      8       the number of transactions, n
+ *      28      16n     transaction ids, in id order
+ *      28+16n  n       the state of each transaction
+ *      28+17n  4       CRC-32C of the bytes before it
+ *
+ * A checkpoint which is damaged, or which doesn't match the journal, is
+ * ignored and the whole journal is replayed.
+ *
+ * \copyright 2020 Velo Payments.  See License.txt for license terms.
+ */
+
+#ifndef  VCTOOL_JOURNAL_HEADER_GUARD
+# define VCTOOL_JOURNAL_HEADER_GUARD
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <vctool/file.h>
+#include <vctool/status_codes.h>
+#include <vctool/uuid_dict.h>
+#include <vpr/disposable.h>
+
+/* make this header C++ friendly. */
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* journal magic. */
+#define JOURNAL_MAGIC                                   "VCJRNL01"
+#define JOURNAL_MAGIC_SIZE                              8
+
+/* the size of a journal record. */
+#define JOURNAL_RECORD_SIZE                             24
+
+/* the number of record bytes covered by the checksum. */
+#define JOURNAL_RECORD_CHECKED_SIZE                     20
+
+/* checkpoint magic. */
+#define JOURNAL_CHECKPOINT_MAGIC                        "VCJCKPT1"
+#define JOURNAL_CHECKPOINT_MAGIC_SIZE                   8
+
+/* the size of the checkpoint header. */
+#define JOURNAL_CHECKPOINT_HEADER_SIZE                  28
+
+/* the suffix added to the journal path to name its checkpoint. */
+#define JOURNAL_CHECKPOINT_SUFFIX                       ".ckpt"
+
+/* the number of replayed records which makes opening write a checkpoint. */
+#define JOURNAL_CHECKPOINT_RECORDS                      4096
+
+/* transaction states. */
+#define JOURNAL_UNKNOWN                                 0x00000000U
+#define JOURNAL_SUBMITTED                               0x00000001U
+#define JOURNAL_ACKNOWLEDGED                            0x00000002U
+
+/**
+ * \brief Submission journal.
+ *
+ * Any number of threads may append to and commit a journal at once.
+ */
+typedef struct journal
+{
+    /** \brief journal is disposable. */
+    disposable_t hdr;
+
+    /** \brief the file abstraction layer. */
+    file* f;
+
+    /** \brief the journal, open for appending. */
+    int fd;
+
+    /** \brief transactions in the journal when it was opened. */
+    uuid_dict transactions;
+
+    /** \brief the state of each transaction, by id number. */
+    uint8_t* states;
+
+    /** \brief the number of transactions acknowledged when the journal was
+     * opened. */
+    size_t acknowledged;
+
+    /** \brief the number of transactions submitted but not acknowledged when
+     * the journal was opened. */
+    size_t uncertain;
+
+    /** \brief the number of damaged records skipped when opening, after the
+     * checkpoint. */
+    size_t damaged;
+
+    /** \brief guards the fields below. */
+    pthread_mutex_t lock;
+
+    /** \brief signalled when a commit finishes. */
+    pthread_cond_t committed;
+
+    /** \brief records appended but not yet written. */
+    uint8_t* pending;
+
+    /** \brief the size of the pending records. */
+    size_t pending_size;
+
+    /** \brief the size of the pending buffer. */
+    size_t pending_capacity;
+
+    /** \brief a buffer to swap in while the pending records are written. */
+    uint8_t* spare;
+
+    /** \brief the size of the spare buffer. */
+    size_t spare_capacity;
+
+    /** \brief the sequence number of the last appended record. */
+    uint64_t appended;
+
+    /** \brief the sequence number of the last record on stable storage. */
+    uint64_t durable;
+
+    /** \brief true while a thread is writing and flushing records. */
+    bool committing;
+
+    /** \brief the number of times the journal has been flushed. */
+    uint64_t flushes;
+
+    /** \brief the error which stopped the journal, or success. */
+    int error;
+} journal;
+
+/**
+ * \brief Open a submission journal, creating it if it does not exist.
+ *
+ * \param j             The journal to initialize.
+ * \param f             The file abstraction layer to use.
+ * \param path          The path of the journal.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - VCTOOL_ERROR_JOURNAL_BAD_JOURNAL if path is not a journal.
+ *      - VCTOOL_ERROR_GENERAL_OUT_OF_MEMORY if an allocation failed.
+ *      - a non-zero error code returned by the file layer.
+ */
+int journal_open(journal* j, file* f, const char* path);
+
+/**
+ * \brief Save the state of each transaction in a journal checkpoint.
+ *
+ * The checkpoint is written to a temporary file which is flushed and then
+ * renamed over path.
+ *
+ * \param j             The journal, with the state of each transaction up to
+ *                      offset.
+ * \param path          The path of the checkpoint.
+ * \param offset        The journal offset covered by the checkpoint.
+ * \param checksum      The checksum of the last record before offset.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - VCTOOL_ERROR_GENERAL_OUT_OF_MEMORY if an allocation failed.
+ *      - a non-zero error code returned by the file layer.
+ */
+int journal_checkpoint_save(
+    const journal* j, const char* path, uint64_t offset,
+    const uint8_t* checksum);
+
+/**
+ * \brief Look up the state of a transaction when the journal was opened.
+ *
+ * \param j             The journal to search.
+ * \param txn_id        The transaction id.
+ *
+ * \returns JOURNAL_ACKNOWLEDGED, JOURNAL_SUBMITTED if the transaction was
+ *          sent but its outcome is uncertain, or JOURNAL_UNKNOWN.
+ */
+uint32_t journal_state(const journal* j, const uint8_t* txn_id);
+
+/**
+ * \brief Append a record to the journal.
+ *
+ * The record is not durable until it has been committed.
+ *
+ * \param j             The journal.
+ * \param state         JOURNAL_SUBMITTED or JOURNAL_ACKNOWLEDGED.
+ * \param txn_id        The transaction id.
+ * \param sequence      Set to the sequence number of the record.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - VCTOOL_ERROR_GENERAL_OUT_OF_MEMORY if an allocation failed.
+ *      - the error which stopped an earlier commit.
+ */
+int journal_append(
+    journal* j, uint32_t state, const uint8_t* txn_id, uint64_t* sequence);
+
+/**
+ * \brief Wait until a record and every record before it are on stable
+ * storage.
+ *
+ * \param j             The journal.
+ * \param sequence      The sequence number of the record.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - a non-zero error code returned by the file layer, which stops the
+ *        journal.
+ */
+int journal_commit(journal* j, uint64_t sequence);
+
+/**
+ * \brief Find the transaction id of a transaction certificate.
+ *
+ * \param txn_id        Set to the value of the certificate's
+ *                      VCCERT_FIELD_TYPE_CERTIFICATE_ID field.
+ * \param cert          The transaction certificate.
+ * \param size          The size of the certificate.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - VCTOOL_ERROR_JOURNAL_NO_TRANSACTION_ID if the certificate has no
+ *        transaction id.
+ */
+int journal_transaction_id(
+    uint8_t* txn_id, const uint8_t* cert, size_t size);
+
+/* make this header C++ friendly. */
+#ifdef __cplusplus
+}
+#endif
+
+#endif /*VCTOOL_JOURNAL_HEADER_GUARD*/
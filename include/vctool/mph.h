@@ -0,0 +1,169 @@
+/**
+ * \file include/vctool/mph.h
+ *
+ * \brief Minimal perfect hash over fixed-width keys.
+ *
+ * A minimal perfect hash maps each of n distinct keys to a distinct index in
+ * [0, n), using a few bits per key.  This is a BBHash-style construction: each
+ * level is a bit array, and a key lands on the first level where its hashed
+ * bit did not collide with another key.  A key's index is the rank of that
+ * bit.  The few keys left after the last level are kept in a small sorted
+ * fallback table.
+ *
+ * Looking up a key that was not in the build set returns either
+ * MPH_NOT_FOUND or an arbitrary index, so callers must compare the key stored
+ * at the returned index.
+ *
+ * The serialized form can be used in place, e.g. from a memory mapped file.
+ * All integers are little endian 64-bit words:
+ *
+ *      MPH_MAGIC, key count, level count | fallback count << 32,
+ *      level sizes in words, level bits, rank per MPH_RANK_WORDS words,
+ *      fallback (hash, index) pairs sorted by hash.
+ *
+ * \copyright 2020 Velo Payments.  See License.txt for license terms.
+ */
+
+#ifndef  VCTOOL_MPH_HEADER_GUARD
+# define VCTOOL_MPH_HEADER_GUARD
+
+#include <stdint.h>
+#include <vctool/status_codes.h>
+#include <vctool/uuid.h>
+#include <vpr/disposable.h>
+
+/* make this header C++ friendly. */
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* perfect hash magic, "VCMPH001" as a little endian word. */
+#define MPH_MAGIC                               UINT64_C(0x31303048504d4356)
+
+/* the size of a key. */
+#define MPH_KEY_SIZE                                    UUID_SIZE
+
+/* the maximum number of levels before keys go to the fallback table. */
+#define MPH_MAX_LEVELS                                  32
+
+/* bits per remaining key in each level; larger builds faster but is bigger. */
+#define MPH_GAMMA                                       2
+
+/* the number of bit words covered by each rank entry. */
+#define MPH_RANK_WORDS                                  8
+
+/* the minimum number of keys handed to each build thread. */
+#define MPH_MIN_KEYS_PER_THREAD                         16384
+
+/* returned by mph_lookup when the key is definitely not in the set. */
+#define MPH_NOT_FOUND                                   UINT64_MAX
+
+/**
+ * \brief A minimal perfect hash.
+ */
+typedef struct mph
+{
+    /** \brief mph is disposable. */
+    disposable_t hdr;
+
+    /** \brief the number of keys. */
+    uint64_t key_count;
+
+    /** \brief the number of levels. */
+    uint32_t level_count;
+
+    /** \brief the number of keys in the fallback table. */
+    uint32_t fallback_count;
+
+    /** \brief the bit offset of each level, plus the total bit count. */
+    uint64_t level_offset[MPH_MAX_LEVELS + 1];
+
+    /** \brief the level bit arrays. */
+    const uint64_t* bits;
+
+    /** \brief the rank of each group of MPH_RANK_WORDS bit words. */
+    const uint64_t* ranks;
+
+    /** \brief the fallback table. */
+    const uint64_t* fallback;
+
+    /** \brief the serialized form of this hash. */
+    const void* data;
+
+    /** \brief the size of the serialized form. */
+    size_t size;
+
+    /** \brief the serialized form, if owned by this instance. */
+    void* storage;
+} mph;
+
+/**
+ * \brief Build a minimal perfect hash over a set of distinct keys.
+ *
+ * \param m             The perfect hash to initialize.
+ * \param keys          Array of MPH_KEY_SIZE byte keys.
+ * \param count         The number of keys.
+ * \param threads       The number of build threads, or 0 to use one per
+ *                      online processor.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - VCTOOL_ERROR_MPH_HASH_COLLISION if two keys share a hash; this is
+ *        practically only possible if keys are duplicated.
+ *      - VCTOOL_ERROR_MPH_THREAD if a build thread could not be started.
+ *      - VCTOOL_ERROR_GENERAL_OUT_OF_MEMORY if an allocation failed.
+ */
+int mph_build(mph* m, const uint8_t* keys, size_t count, unsigned threads);
+
+/**
+ * \brief Initialize a perfect hash from its serialized form, in place.
+ *
+ * The buffer must be 8-byte aligned and must outlive this instance.
+ *
+ * \param m             The perfect hash to initialize.
+ * \param data          The serialized form.
+ * \param size          The size of the serialized form.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - VCTOOL_ERROR_MPH_BAD_FORMAT if the serialized form is malformed.
+ */
+int mph_view(mph* m, const void* data, size_t size);
+
+/**
+ * \brief Look up the index of a key.
+ *
+ * \param m             The perfect hash.
+ * \param key           The MPH_KEY_SIZE byte key.
+ *
+ * \returns the index of this key if it was in the build set, and either
+ *          MPH_NOT_FOUND or an arbitrary index otherwise.
+ */
+uint64_t mph_lookup(const mph* m, const uint8_t* key);
+
+/**
+ * \brief Hash a key.
+ *
+ * \param key           The MPH_KEY_SIZE byte key.
+ *
+ * \returns the 64-bit hash of this key.
+ */
+uint64_t mph_key_hash(const uint8_t* key);
+
+/**
+ * \brief Compute the position of a key hash in a level.
+ *
+ * \param hash          The key hash.
+ * \param level         The level.
+ * \param bits          The number of bits in this level.
+ *
+ * \returns the bit position within this level.
+ */
+uint64_t mph_level_position(uint64_t hash, uint32_t level, uint64_t bits);
+
+/* make this header C++ friendly. */
+#ifdef __cplusplus
+}
+#endif
+
+#endif /*VCTOOL_MPH_HEADER_GUARD*/
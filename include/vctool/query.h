@@ -0,0 +1,253 @@
+/**
+ * \file include/vctool/query.h
+ *
+ * \brief Local query server over a block store segment.
+ *
+ * A query index is built once from a segment, and answers lookups by block
+ * height, block id, transaction id, and artifact id with the offset and size
+ * of the matching certificate in the segment.  The server sends those bytes
+ * straight from the segment to the client socket with sendfile, so a
+ * certificate is never copied through user space.  The kernel's page cache
+ * is the only block cache, and concurrent requests for the same block share
+ * its pages.
+ *
+ * Transactions are found by walking the fields of each block: every
+ * VCCERT_FIELD_TYPE_WRAPPED_TRANSACTION_TUPLE field holds a transaction
+ * certificate, whose VCCERT_FIELD_TYPE_CERTIFICATE_ID and
+ * VCCERT_FIELD_TYPE_ARTIFACT_ID fields are indexed.  A field is a big-endian
+ * 2 byte type and 2 byte size, followed by its value.
+ *
+ * Requests and responses are framed as agent frames.  Each request is
+ * answered with zero or more QUERY_RESP_BLOCK or QUERY_RESP_TRANSACTION
+ * frames, whose payload is the certificate, followed by a QUERY_RESP_END
+ * frame holding a big-endian 4 byte status code.  A lookup which matches
+ * nothing is answered with QUERY_RESP_END alone.  Clients may send several
+ * requests before reading the responses, which arrive in request order.
+ *
+ *      request                 payload
+ *      QUERY_REQ_HEIGHT        8 byte block height
+ *      QUERY_REQ_BLOCK         block id
+ *      QUERY_REQ_TRANSACTION   transaction id
+ *      QUERY_REQ_ARTIFACT      artifact id; every transaction on the
+ *                              artifact is returned, in chain order
+ *
+ * \copyright 2020 Velo Payments.  See License.txt for license terms.
+ */
+
+#ifndef  VCTOOL_QUERY_HEADER_GUARD
+# define VCTOOL_QUERY_HEADER_GUARD
+
+#include <stddef.h>
+#include <stdint.h>
+#include <vctool/agent.h>
+#include <vctool/file.h>
+#include <vctool/status_codes.h>
+#include <vctool/uuid_dict.h>
+#include <vpr/disposable.h>
+
+/* make this header C++ friendly. */
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* request types. */
+#define QUERY_REQ_HEIGHT                                0x00000101U
+#define QUERY_REQ_BLOCK                                 0x00000102U
+#define QUERY_REQ_TRANSACTION                           0x00000103U
+#define QUERY_REQ_ARTIFACT                              0x00000104U
+
+/* response types. */
+#define QUERY_RESP_BLOCK                                0x00000201U
+#define QUERY_RESP_TRANSACTION                          0x00000202U
+#define QUERY_RESP_END                                  0x00000203U
+
+/* the size of a QUERY_RESP_END payload. */
+#define QUERY_END_SIZE                                  4
+
+/* the number of pending connections on the server socket. */
+#define QUERY_LISTEN_BACKLOG                            128
+
+/* the memory budget for sorting each lookup table before runs are spilled. */
+#define QUERY_SORT_BUDGET                               (16 * 1024 * 1024)
+
+/**
+ * \brief The location of a certificate in a segment.
+ */
+typedef struct query_entry
+{
+    /** \brief the offset of the certificate in the segment. */
+    uint64_t offset;
+
+    /** \brief the size of the certificate. */
+    uint64_t size;
+} query_entry;
+
+/**
+ * \brief Lookup index over a segment.
+ *
+ * The lookup tables are read-only once built, so any number of threads may
+ * search them and send from the segment at once.
+ */
+typedef struct query_index
+{
+    /** \brief query_index is disposable. */
+    disposable_t hdr;
+
+    /** \brief the file abstraction layer. */
+    file* f;
+
+    /** \brief the segment, open for sendfile. */
+    int fd;
+
+    /** \brief the number of blocks. */
+    size_t block_count;
+
+    /** \brief block heights, in ascending order. */
+    uint64_t* heights;
+
+    /** \brief the block at each height. */
+    query_entry* blocks;
+
+    /** \brief block ids, numbered in the order they were found. */
+    uuid_dict block_ids;
+
+    /** \brief the first block with each block id number. */
+    query_entry* blocks_by_id;
+
+    /** \brief transaction ids, numbered in the order they were found. */
+    uuid_dict transaction_ids;
+
+    /** \brief the first transaction with each transaction id number. */
+    query_entry* transactions;
+
+    /** \brief artifact ids, numbered in the order they were found. */
+    uuid_dict artifact_ids;
+
+    /** \brief where the transactions of each artifact id number start in
+     * artifact_transactions; one more entry than there are artifacts. */
+    size_t* artifact_starts;
+
+    /** \brief transactions grouped by artifact, in chain order. */
+    query_entry* artifact_transactions;
+} query_index;
+
+/**
+ * \brief Build a query index over a segment.
+ *
+ * The index covers the records in the segment when it is built; records
+ * appended later are not found.  Block, transaction, and artifact ids are
+ * interned in uuid dictionaries, whose dense ids number the lookup tables.
+ * Blocks are sorted by height and transactions are grouped by artifact with
+ * external sorts, whose runs are spilled to the directory of the segment when
+ * they exceed QUERY_SORT_BUDGET.
+ *
+ * \param index         The index to initialize.
+ * \param f             The file abstraction layer to use.
+ * \param segment       The path of the segment.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - VCTOOL_ERROR_BLOCKSTORE_BAD_SEGMENT if path is not a segment.
+ *      - VCTOOL_ERROR_BLOCKSTORE_CORRUPT if a record is damaged.
+ *      - VCTOOL_ERROR_QUERY_BAD_BLOCK if a block's fields are malformed.
+ *      - VCTOOL_ERROR_GENERAL_OUT_OF_MEMORY if an allocation failed.
+ *      - a non-zero error code returned by the file layer.
+ */
+int query_index_init(query_index* index, file* f, const char* segment);
+
+/**
+ * \brief Find the block at a height.
+ *
+ * \param index         The index to search.
+ * \param height        The block height.
+ *
+ * \returns the block, or NULL if there is no block at this height.
+ */
+const query_entry* query_index_find_height(
+    const query_index* index, uint64_t height);
+
+/**
+ * \brief Find a block by id.
+ *
+ * \param index         The index to search.
+ * \param block_id      The block id.
+ *
+ * \returns the block, or NULL if it is not in the segment.
+ */
+const query_entry* query_index_find_block(
+    const query_index* index, const uint8_t* block_id);
+
+/**
+ * \brief Find a transaction by id.
+ *
+ * \param index         The index to search.
+ * \param txn_id        The transaction id.
+ *
+ * \returns the transaction, or NULL if it is not in the segment.
+ */
+const query_entry* query_index_find_transaction(
+    const query_index* index, const uint8_t* txn_id);
+
+/**
+ * \brief Find the transactions on an artifact.
+ *
+ * \param index         The index to search.
+ * \param artifact_id   The artifact id.
+ * \param count         Set to the number of transactions found.
+ *
+ * \returns the first of count transactions, in chain order, or NULL if there
+ *          are none.
+ */
+const query_entry* query_index_find_artifact(
+    const query_index* index, const uint8_t* artifact_id, size_t* count);
+
+/**
+ * \brief Open a query server socket.
+ *
+ * A stale socket file left at path is removed first.
+ *
+ * \param sock          Pointer to receive the listening socket.
+ * \param path          The path of the unix domain socket.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - VCTOOL_ERROR_QUERY_LISTEN if the socket could not be opened.
+ */
+int query_listen(int* sock, const char* path);
+
+/**
+ * \brief Answer a single request.
+ *
+ * A malformed request is answered with VCTOOL_ERROR_QUERY_BAD_REQUEST.
+ *
+ * \param index         The index to search.
+ * \param sock          The client connection.
+ * \param request       The request.
+ * \param sent          Set to the number of bytes sent, or NULL.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS if the response was sent.
+ *      - a non-zero error code if the connection failed.
+ */
+int query_answer(
+    query_index* index, int sock, const agent_frame* request, size_t* sent);
+
+/**
+ * \brief Answer requests on a connection until the client closes it.
+ *
+ * \param index         The index to search.
+ * \param sock          The client connection.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS when the client closes the connection.
+ *      - VCTOOL_ERROR_AGENT_BAD_FRAME if a request frame was malformed.
+ *      - a non-zero error code on failure.
+ */
+int query_serve(query_index* index, int sock);
+
+/* make this header C++ friendly. */
+#ifdef __cplusplus
+}
+#endif
+
+#endif /*VCTOOL_QUERY_HEADER_GUARD*/
@@ -0,0 +1,241 @@
+/**
+ * \file include/vctool/revocation.h
+ *
+ * \brief Entity revocation lists.
+ *
+ * A revocation list is a sorted array of fixed-width entity ids, fronted by a
+ * blocked Bloom filter so that the common case, an id which has not been
+ * revoked, is answered by touching a single cache line.  Ids which pass the
+ * filter are located with a minimal perfect hash instead of a binary search.
+ * Lists are memory mapped when loaded, so opening even a very large list is
+ * cheap.
+ *
+ * All integers in the header are big endian:
+ *
+ *      offset  size    field
+ *      0       8       REVOCATION_MAGIC
+ *      8       8       entry count
+ *      16      8       digest of the sorted entries
+ *      24      4       number of Bloom filter blocks, or 0 for none
+ *      28      4       number of Bloom filter hashes
+ *      32      ...     Bloom filter blocks, then sorted entries
+ *
+ * Each Bloom filter block is REVOCATION_BLOOM_BLOCK_WORDS little endian 64-bit
+ * words.  The entries may be followed by an optional perfect hash section: a
+ * little endian 32-bit entry position for each perfect hash slot, padded to a
+ * multiple of 8 bytes, then the serialized perfect hash.  Lists without this
+ * section are searched by binary search.
+ *
+ * \copyright 2020 Velo Payments.  See License.txt for license terms.
+ */
+
+#ifndef  VCTOOL_REVOCATION_HEADER_GUARD
+# define VCTOOL_REVOCATION_HEADER_GUARD
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <vctool/extsort.h>
+#include <vctool/file.h>
+#include <vctool/mph.h>
+#include <vctool/status_codes.h>
+#include <vctool/uuid.h>
+#include <vpr/disposable.h>
+
+/* make this header C++ friendly. */
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* revocation list magic. */
+#define REVOCATION_MAGIC                                "VCREVOK1"
+#define REVOCATION_MAGIC_SIZE                           8
+
+/* the size of the revocation list header. */
+#define REVOCATION_HEADER_SIZE                          32
+
+/* the size of a revocation list entry. */
+#define REVOCATION_ENTRY_SIZE                           UUID_SIZE
+
+/* Bloom filter blocks are one cache line. */
+#define REVOCATION_BLOOM_BLOCK_SIZE                     64
+#define REVOCATION_BLOOM_BLOCK_WORDS                    8
+
+/* Bloom filter sizing; about 1% false positives. */
+#define REVOCATION_BLOOM_BITS_PER_ENTRY                 10
+#define REVOCATION_BLOOM_HASHES                         6
+
+/* the memory budget for sorting entries before runs are spilled to disk. */
+#define REVOCATION_SORT_BUDGET                          (64 * 1024 * 1024)
+
+/**
+ * \brief A loaded revocation list.
+ */
+typedef struct revocation_set
+{
+    /** \brief revocation_set is disposable. */
+    disposable_t hdr;
+
+    /** \brief the file abstraction layer used to map this list. */
+    file* file;
+
+    /** \brief the mapping of this list. */
+    void* map;
+
+    /** \brief the size of the mapping. */
+    size_t map_size;
+
+    /** \brief the number of revoked ids. */
+    uint64_t count;
+
+    /** \brief digest of the sorted entries. */
+    uint64_t digest;
+
+    /** \brief the number of Bloom filter blocks. */
+    uint32_t bloom_blocks;
+
+    /** \brief the number of Bloom filter hashes. */
+    uint32_t bloom_hashes;
+
+    /** \brief the Bloom filter. */
+    const uint8_t* bloom;
+
+    /** \brief the sorted entries. */
+    const uint8_t* entries;
+
+    /** \brief the entry position of each perfect hash slot, or NULL. */
+    const uint8_t* slots;
+
+    /** \brief perfect hash over the entries, valid if slots is set. */
+    mph index;
+} revocation_set;
+
+/**
+ * \brief Builds a revocation list from ids added one at a time.
+ *
+ * Ids are streamed into an external merge sort as they are added, so the ids
+ * need not be held in memory by the caller, and duplicates cost only sort
+ * space.  Finishing the list holds only the distinct ids in memory, since the
+ * Bloom filter and perfect hash are built over them.
+ */
+typedef struct revocation_builder
+{
+    /** \brief revocation_builder is disposable. */
+    disposable_t hdr;
+
+    /** \brief the file abstraction layer used to write this list. */
+    file* file;
+
+    /** \brief the path of the revocation list. */
+    char* path;
+
+    /** \brief sorts the added ids. */
+    extsort sorter;
+} revocation_builder;
+
+/**
+ * \brief Open a revocation list.
+ *
+ * \param set           The revocation set to initialize.
+ * \param f             The file abstraction layer to use.
+ * \param path          The path of the revocation list.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - VCTOOL_ERROR_REVOCATION_BAD_HEADER if the header is invalid.
+ *      - VCTOOL_ERROR_REVOCATION_BAD_SIZE if the file is truncated.
+ *      - a non-zero error code on failure.
+ */
+int revocation_set_open(revocation_set* set, file* f, const char* path);
+
+/**
+ * \brief Check whether an id has been revoked.
+ *
+ * \param set           The revocation set to search.
+ * \param id            The REVOCATION_ENTRY_SIZE byte id to look up.
+ *
+ * \returns true if this id has been revoked, and false otherwise.
+ */
+bool revocation_set_contains(const revocation_set* set, const uint8_t* id);
+
+/**
+ * \brief Initialize a revocation list builder.
+ *
+ * Sort runs which exceed REVOCATION_SORT_BUDGET are spilled to the directory
+ * of the list.
+ *
+ * \param builder       The builder to initialize.
+ * \param f             The file abstraction layer to use.
+ * \param path          The path of the revocation list.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - VCTOOL_ERROR_GENERAL_OUT_OF_MEMORY if an allocation failed.
+ */
+int revocation_builder_init(
+    revocation_builder* builder, file* f, const char* path);
+
+/**
+ * \brief Add an id to a revocation list builder.
+ *
+ * \param builder       The builder.
+ * \param id            The REVOCATION_ENTRY_SIZE byte id to add.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - a non-zero error code if a sort run could not be written.
+ */
+int revocation_builder_add(revocation_builder* builder, const uint8_t* id);
+
+/**
+ * \brief Write the revocation list holding every distinct id added.
+ *
+ * A perfect hash is built over the sorted ids.  The list is written to a
+ * temporary file which is then renamed over the path, so readers never see a
+ * partially written list.  The builder must still be disposed.
+ *
+ * \param builder       The builder.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - a non-zero error code on failure.
+ */
+int revocation_builder_finish(revocation_builder* builder);
+
+/**
+ * \brief Write a revocation list.
+ *
+ * The entries are passed through a revocation_builder, which sorts and
+ * de-duplicates them.  The entries are not modified.
+ *
+ * \param f             The file abstraction layer to use.
+ * \param path          The path of the revocation list.
+ * \param entries       Array of REVOCATION_ENTRY_SIZE byte ids.
+ * \param count         The number of ids in entries.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - a non-zero error code on failure.
+ */
+int revocation_set_write(
+    file* f, const char* path, const uint8_t* entries, size_t count);
+
+/**
+ * \brief Compute the Bloom filter block and bit mask for an id.
+ *
+ * \param mask          Array of REVOCATION_BLOOM_BLOCK_WORDS words to receive
+ *                      the bit mask.
+ * \param id            The REVOCATION_ENTRY_SIZE byte id.
+ * \param blocks        The number of Bloom filter blocks.
+ * \param hashes        The number of Bloom filter hashes.
+ *
+ * \returns the Bloom filter block for this id.
+ */
+uint32_t revocation_bloom_mask(
+    uint64_t* mask, const uint8_t* id, uint32_t blocks, uint32_t hashes);
+
+/* make this header C++ friendly. */
+#ifdef __cplusplus
+}
+#endif
+
+#endif /*VCTOOL_REVOCATION_HEADER_GUARD*/
@@ -0,0 +1,228 @@
+/**
+ * \file include/vctool/scheduler.h
+ *
+ * \brief Fair scheduling of client requests between priority classes.
+ *
+ * A scheduler hands the requests of many clients to a pool of workers.  Each
+ * client has a flow, which queues its requests in order; at most one request
+ * of a flow is handed out at a time, so responses on a connection stay in
+ * request order.
+ *
+ * Every request belongs to a priority class.  Interactive requests are
+ * always handed out before bulk requests, and at most a fixed number of bulk
+ * requests run at once, so that some workers are always left for
+ * interactive requests while bulk jobs run.  A client which pipelines more
+ * than a few requests is running a bulk job, so its requests are demoted to
+ * bulk while its pipeline stays deep.
+ *
+ * Within a class, flows share the workers by deficit round robin.  Each round
+ * gives every waiting flow a quantum of credit; a flow is served while it has
+ * credit, and the cost of each request, such as the number of bytes in its
+ * response, is charged once it is done.  A client that makes expensive
+ * requests therefore gets fewer of them, and a client cannot take more than
+ * its share by opening a deeper pipeline.
+ *
+ * \copyright 2020 Velo Payments.  See License.txt for license terms.
+ */
+
+#ifndef  VCTOOL_SCHEDULER_HEADER_GUARD
+# define VCTOOL_SCHEDULER_HEADER_GUARD
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <vctool/status_codes.h>
+#include <vpr/disposable.h>
+
+/* make this header C++ friendly. */
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* priority classes, from highest to lowest. */
+#define SCHEDULER_INTERACTIVE                           0
+#define SCHEDULER_BULK                                  1
+#define SCHEDULER_CLASSES                               2
+
+/**
+ * \brief A request, embedded in the caller's request structure.
+ */
+typedef struct scheduler_item
+{
+    /** \brief the next request in the flow. */
+    struct scheduler_item* next;
+
+    /** \brief the priority class of the request. */
+    unsigned priority;
+} scheduler_item;
+
+/**
+ * \brief The queued requests of a client.
+ */
+typedef struct scheduler_flow
+{
+    /** \brief the next flow with waiting requests. */
+    struct scheduler_flow* next;
+
+    /** \brief the previous flow with waiting requests. */
+    struct scheduler_flow* prev;
+
+    /** \brief the first waiting request. */
+    scheduler_item* head;
+
+    /** \brief the last waiting request. */
+    scheduler_item* tail;
+
+    /** \brief the number of requests waiting or running. */
+    size_t depth;
+
+    /** \brief the remaining credit, which is negative while in debt. */
+    int64_t deficit;
+
+    /** \brief true while a request of the flow is running. */
+    bool busy;
+} scheduler_flow;
+
+/**
+ * \brief Scheduler.
+ *
+ * Any number of threads may use a scheduler at once.
+ */
+typedef struct scheduler
+{
+    /** \brief scheduler is disposable. */
+    disposable_t hdr;
+
+    /** \brief the credit given to each waiting flow in a round. */
+    int64_t quantum;
+
+    /** \brief the number of requests a flow may have before new ones are
+     * demoted to bulk. */
+    size_t interactive_depth;
+
+    /** \brief the number of requests a flow may have before submitting
+     * blocks. */
+    size_t max_depth;
+
+    /** \brief the number of requests of each class which may run at once. */
+    size_t limit[SCHEDULER_CLASSES];
+
+    /** \brief guards the fields below. */
+    pthread_mutex_t lock;
+
+    /** \brief signalled when a request may be handed out. */
+    pthread_cond_t ready;
+
+    /** \brief signalled when a request is done. */
+    pthread_cond_t done;
+
+    /** \brief the next flow with waiting requests to consider. */
+    scheduler_flow* flows;
+
+    /** \brief the number of requests of each class running. */
+    size_t running[SCHEDULER_CLASSES];
+
+    /** \brief the number of requests of each class handed out. */
+    uint64_t dispatched[SCHEDULER_CLASSES];
+
+    /** \brief true once the scheduler is stopped. */
+    bool stopped;
+} scheduler;
+
+/**
+ * \brief Create a scheduler.
+ *
+ * \param sched         The scheduler to initialize.
+ * \param bulk_limit    The number of bulk requests which may run at once.
+ * \param interactive_depth     The number of requests a flow may have
+ *                      before new ones are demoted to bulk.
+ * \param quantum       The credit given to each waiting flow in a round.
+ * \param max_depth     The number of requests a flow may have before
+ *                      submitting blocks.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - VCTOOL_ERROR_GENERAL_OUT_OF_MEMORY if the lock could not be created.
+ */
+int scheduler_init(
+    scheduler* sched, size_t bulk_limit, size_t interactive_depth,
+    int64_t quantum, size_t max_depth);
+
+/**
+ * \brief Initialize the flow of a new client.
+ *
+ * \param flow          The flow to initialize.
+ */
+void scheduler_flow_init(scheduler_flow* flow);
+
+/**
+ * \brief Queue a request, waiting while the flow is at its maximum depth.
+ *
+ * \param sched         The scheduler.
+ * \param flow          The flow of the client.
+ * \param item          The request, with its priority set; an interactive
+ *                      request is demoted to bulk if the flow is deep.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - VCTOOL_ERROR_SCHEDULER_STOPPED if the scheduler was stopped, in
+ *        which case the request was not queued.
+ */
+int scheduler_submit(
+    scheduler* sched, scheduler_flow* flow, scheduler_item* item);
+
+/**
+ * \brief Wait for the next request to run.
+ *
+ * \param sched         The scheduler.
+ * \param flow          Set to the flow of the request.
+ * \param item          Set to the request, which must be passed to
+ *                      scheduler_done once it has run.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - VCTOOL_ERROR_SCHEDULER_STOPPED if the scheduler was stopped.
+ */
+int scheduler_next(
+    scheduler* sched, scheduler_flow** flow, scheduler_item** item);
+
+/**
+ * \brief Finish a request, charging its cost to its flow.
+ *
+ * \param sched         The scheduler.
+ * \param flow          The flow of the request.
+ * \param item          The request.
+ * \param cost          The cost of the request.
+ */
+void scheduler_done(
+    scheduler* sched, scheduler_flow* flow, scheduler_item* item,
+    int64_t cost);
+
+/**
+ * \brief Wait until a flow has no requests waiting or running, so that it
+ * can be released.
+ *
+ * Once the scheduler is stopped, this only waits for the running request;
+ * requests still waiting are left on the flow for the caller to release.
+ *
+ * \param sched         The scheduler.
+ * \param flow          The flow.
+ */
+void scheduler_drain(scheduler* sched, scheduler_flow* flow);
+
+/**
+ * \brief Stop a scheduler, waking every waiting thread.
+ *
+ * Requests which are still waiting are no longer handed out.
+ *
+ * \param sched         The scheduler.
+ */
+void scheduler_stop(scheduler* sched);
+
+/* make this header C++ friendly. */
+#ifdef __cplusplus
+}
+#endif
+
+#endif /*VCTOOL_SCHEDULER_HEADER_GUARD*/
@@ -0,0 +1,162 @@
+/**
+ * \file include/vctool/singleflight.h
+ *
+ * \brief Coalescing of concurrent identical requests.
+ *
+ * A single-flight group runs at most one computation per key at a time.  A
+ * caller which asks for a key while its computation is in flight waits for
+ * that computation and shares its status and result, instead of starting
+ * another.  Once a computation lands, the next caller for its key starts a
+ * new one; results are not cached.
+ *
+ * Keys are opaque bytes, and should name both the operation and its
+ * arguments, so that different operations can share a group.  Results have a
+ * fixed size, set when the group is created; each caller receives its own
+ * copy, and the group's copy is wiped once every caller has taken it.
+ *
+ * Results may hold secrets, such as session keys, so the group keeps them in
+ * SINGLEFLIGHT_MAX_FLIGHTS slots of memory which is locked out of swap and
+ * left out of core dumps.  A computation waits for a free slot if that many
+ * are already in flight.  A group whose results are empty holds no slots.
+ *
+ * \copyright 2020 Velo Payments.  See License.txt for license terms.
+ */
+
+#ifndef  VCTOOL_SINGLEFLIGHT_HEADER_GUARD
+# define VCTOOL_SINGLEFLIGHT_HEADER_GUARD
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <vctool/status_codes.h>
+#include <vpr/disposable.h>
+
+/* make this header C++ friendly. */
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* the number of computations a group can have in flight at once. */
+#define SINGLEFLIGHT_MAX_FLIGHTS                        64
+
+/**
+ * \brief Function which computes a result.
+ *
+ * \param context       The user context passed to singleflight_do.
+ * \param result        Buffer of the group's result size receiving the
+ *                      result, or NULL if results are empty.
+ *
+ * \returns a status code, which is shared with every caller of the flight.
+ */
+typedef int (*singleflight_fn)(void* context, void* result);
+
+/**
+ * \brief A computation in flight.
+ */
+typedef struct singleflight_call
+{
+    /** \brief the next call in flight. */
+    struct singleflight_call* next;
+
+    /** \brief the key. */
+    uint8_t* key;
+
+    /** \brief the size of the key. */
+    size_t key_size;
+
+    /** \brief the result, once done, in the call's locked slot. */
+    uint8_t* result;
+
+    /** \brief the index of the call's slot. */
+    unsigned slot;
+
+    /** \brief the number of callers which haven't taken the result. */
+    size_t callers;
+
+    /** \brief whether the computation has landed. */
+    bool done;
+
+    /** \brief the status of the computation. */
+    int status;
+} singleflight_call;
+
+/**
+ * \brief Single-flight group.
+ *
+ * Any number of threads may use a group at once.
+ */
+typedef struct singleflight
+{
+    /** \brief singleflight is disposable. */
+    disposable_t hdr;
+
+    /** \brief the size of a result. */
+    size_t result_size;
+
+    /** \brief guards the fields below. */
+    pthread_mutex_t lock;
+
+    /** \brief signalled when a computation lands. */
+    pthread_cond_t landed;
+
+    /** \brief the computations in flight. */
+    singleflight_call* calls;
+
+    /** \brief the locked result slots, or NULL if results are empty. */
+    uint8_t* slots;
+
+    /** \brief the size of the locked mapping. */
+    size_t mapped_size;
+
+    /** \brief a bit for each slot in use. */
+    uint64_t slots_used;
+
+    /** \brief the number of computations run. */
+    uint64_t flights;
+
+    /** \brief the number of callers which shared another's computation. */
+    uint64_t shared;
+} singleflight;
+
+/**
+ * \brief Create a single-flight group.
+ *
+ * \param group         The group to initialize.
+ * \param result_size   The size of a result.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - VCTOOL_ERROR_GENERAL_SECURE_MEMORY if the result slots could not be
+ *        locked in memory.
+ *      - VCTOOL_ERROR_GENERAL_OUT_OF_MEMORY if an allocation failed.
+ */
+int singleflight_init(singleflight* group, size_t result_size);
+
+/**
+ * \brief Compute the result for a key, or share the computation in flight.
+ *
+ * \param group         The group.
+ * \param key           The key, naming the operation and its arguments.
+ * \param key_size      The size of the key.
+ * \param fn            The computation, run only if none is in flight.
+ * \param context       The user context passed to fn.
+ * \param result        Buffer of the group's result size receiving the
+ *                      result, if the status is success; NULL if results
+ *                      are empty.
+ * \param shared        Set to true if another caller ran the computation.
+ *
+ * \returns a status code indicating success or failure.
+ *      - the status code returned by the computation.
+ *      - VCTOOL_ERROR_GENERAL_OUT_OF_MEMORY if an allocation failed.
+ */
+int singleflight_do(
+    singleflight* group, const void* key, size_t key_size, singleflight_fn fn,
+    void* context, void* result, bool* shared);
+
+/* make this header C++ friendly. */
+#ifdef __cplusplus
+}
+#endif
+
+#endif /*VCTOOL_SINGLEFLIGHT_HEADER_GUARD*/
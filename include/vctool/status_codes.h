@@ -10,11 +10,27 @@
 #define VCTOOL_STATUS_CODES_HEADER_GUARD
 
 #include <vctool/components.h>
+#include <vctool/status_codes/agent.h>
+#include <vctool/status_codes/blockstore.h>
+#include <vctool/status_codes/certcache.h>
 #include <vctool/status_codes/certificate.h>
+#include <vctool/status_codes/certjson.h>
+#include <vctool/status_codes/certschema.h>
+#include <vctool/status_codes/certstore.h>
+#include <vctool/status_codes/certstream.h>
+#include <vctool/status_codes/certtemplate.h>
 #include <vctool/status_codes/commandline.h>
+#include <vctool/status_codes/contract.h>
+#include <vctool/status_codes/extsort.h>
 #include <vctool/status_codes/file.h>
 #include <vctool/status_codes/general.h>
+#include <vctool/status_codes/journal.h>
+#include <vctool/status_codes/mph.h>
+#include <vctool/status_codes/query.h>
 #include <vctool/status_codes/readpassword.h>
+#include <vctool/status_codes/revocation.h>
+#include <vctool/status_codes/scheduler.h>
+#include <vctool/status_codes/uuid.h>
 
 /* make this header C++ friendly. */
 #ifdef __cplusplus
@@ -0,0 +1,102 @@
+/**
+ * \file include/vctool/status_codes/agent.h
+ *
+ * \brief Status codes for the agent component.
+ *
+ * \copyright 2020 Velo Payments.  See License.txt for license terms.
+ */
+
+#ifndef VCTOOL_STATUS_CODES_AGENT_HEADER_GUARD
+#define VCTOOL_STATUS_CODES_AGENT_HEADER_GUARD
+
+#include <vctool/status_codes.h>
+
+/* make this header C++ friendly. */
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * \brief An agent address could not be resolved.
+ */
+#define VCTOOL_ERROR_AGENT_BAD_ADDRESS \
+    VCTOOL_STATUS_ERROR_MACRO(VCTOOL_COMPONENT_AGENT, 0x0001U)
+
+/**
+ * \brief The connection to the agent could not be established.
+ */
+#define VCTOOL_ERROR_AGENT_CONNECT \
+    VCTOOL_STATUS_ERROR_MACRO(VCTOOL_COMPONENT_AGENT, 0x0002U)
+
+/**
+ * \brief The agent closed the connection.
+ */
+#define VCTOOL_ERROR_AGENT_DISCONNECTED \
+    VCTOOL_STATUS_ERROR_MACRO(VCTOOL_COMPONENT_AGENT, 0x0003U)
+
+/**
+ * \brief A malformed frame was received.
+ */
+#define VCTOOL_ERROR_AGENT_BAD_FRAME \
+    VCTOOL_STATUS_ERROR_MACRO(VCTOOL_COMPONENT_AGENT, 0x0004U)
+
+/**
+ * \brief A message of an unexpected type was received.
+ */
+#define VCTOOL_ERROR_AGENT_UNEXPECTED_MESSAGE \
+    VCTOOL_STATUS_ERROR_MACRO(VCTOOL_COMPONENT_AGENT, 0x0005U)
+
+/**
+ * \brief Session keys could not be locked in memory.
+ */
+#define VCTOOL_ERROR_AGENT_SECURE_MEMORY \
+    VCTOOL_STATUS_ERROR_MACRO(VCTOOL_COMPONENT_AGENT, 0x0006U)
+
+/**
+ * \brief The agent could not prove that it holds the resumed session key.
+ */
+#define VCTOOL_ERROR_AGENT_RESUME_FAILED \
+    VCTOOL_STATUS_ERROR_MACRO(VCTOOL_COMPONENT_AGENT, 0x0007U)
+
+/**
+ * \brief A session key or ticket is too large to be cached.
+ */
+#define VCTOOL_ERROR_AGENT_BAD_SESSION \
+    VCTOOL_STATUS_ERROR_MACRO(VCTOOL_COMPONENT_AGENT, 0x0008U)
+
+/**
+ * \brief A replayed request was not in the recording.
+ */
+#define VCTOOL_ERROR_AGENT_NOT_RECORDED \
+    VCTOOL_STATUS_ERROR_MACRO(VCTOOL_COMPONENT_AGENT, 0x0009U)
+
+/**
+ * \brief An agent recording is malformed.
+ */
+#define VCTOOL_ERROR_AGENT_BAD_RECORDING \
+    VCTOOL_STATUS_ERROR_MACRO(VCTOOL_COMPONENT_AGENT, 0x000AU)
+
+/**
+ * \brief The agent is too busy to accept a submission.
+ */
+#define VCTOOL_ERROR_AGENT_BUSY \
+    VCTOOL_STATUS_ERROR_MACRO(VCTOOL_COMPONENT_AGENT, 0x000BU)
+
+/**
+ * \brief A session cache has no seal key to save its sessions under.
+ */
+#define VCTOOL_ERROR_AGENT_NO_SEAL_KEY \
+    VCTOOL_STATUS_ERROR_MACRO(VCTOOL_COMPONENT_AGENT, 0x000CU)
+
+/**
+ * \brief The agent sent a block other than the next one.
+ */
+#define VCTOOL_ERROR_AGENT_BLOCK_OUT_OF_ORDER \
+    VCTOOL_STATUS_ERROR_MACRO(VCTOOL_COMPONENT_AGENT, 0x000DU)
+
+/* make this header C++ friendly. */
+#ifdef __cplusplus
+}
+#endif
+
+#endif /*VCTOOL_STATUS_CODES_AGENT_HEADER_GUARD*/
@@ -0,0 +1,60 @@
+/**
+ * \file include/vctool/status_codes/blockstore.h
+ *
+ * \brief Status codes for the blockstore component.
+ *
+ * \copyright 2020 Velo Payments.  See License.txt for license terms.
+ */
+
+#ifndef VCTOOL_STATUS_CODES_BLOCKSTORE_HEADER_GUARD
+#define VCTOOL_STATUS_CODES_BLOCKSTORE_HEADER_GUARD
+
+#include <vctool/status_codes.h>
+
+/* make this header C++ friendly. */
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * \brief The file is not a block store segment.
+ */
+#define VCTOOL_ERROR_BLOCKSTORE_BAD_SEGMENT \
+    VCTOOL_STATUS_ERROR_MACRO(VCTOOL_COMPONENT_BLOCKSTORE, 0x0001U)
+
+/**
+ * \brief A segment contains corrupt records.
+ */
+#define VCTOOL_ERROR_BLOCKSTORE_CORRUPT \
+    VCTOOL_STATUS_ERROR_MACRO(VCTOOL_COMPONENT_BLOCKSTORE, 0x0002U)
+
+/**
+ * \brief A block is too large to be stored in a record.
+ */
+#define VCTOOL_ERROR_BLOCKSTORE_RECORD_TOO_LARGE \
+    VCTOOL_STATUS_ERROR_MACRO(VCTOOL_COMPONENT_BLOCKSTORE, 0x0003U)
+
+/**
+ * \brief A segment summary is malformed.
+ */
+#define VCTOOL_ERROR_BLOCKSTORE_BAD_SUMMARY \
+    VCTOOL_STATUS_ERROR_MACRO(VCTOOL_COMPONENT_BLOCKSTORE, 0x0004U)
+
+/**
+ * \brief A segment has changed since its summary was built.
+ */
+#define VCTOOL_ERROR_BLOCKSTORE_STALE_SUMMARY \
+    VCTOOL_STATUS_ERROR_MACRO(VCTOOL_COMPONENT_BLOCKSTORE, 0x0005U)
+
+/**
+ * \brief Two segments hold different records.
+ */
+#define VCTOOL_ERROR_BLOCKSTORE_DIVERGED \
+    VCTOOL_STATUS_ERROR_MACRO(VCTOOL_COMPONENT_BLOCKSTORE, 0x0006U)
+
+/* make this header C++ friendly. */
+#ifdef __cplusplus
+}
+#endif
+
+#endif /*VCTOOL_STATUS_CODES_BLOCKSTORE_HEADER_GUARD*/
@@ -0,0 +1,48 @@
+/**
+ * \file include/vctool/status_codes/certcache.h
+ *
+ * \brief Status codes for the certcache component.
+ *
+ * \copyright 2020 Velo Payments.  See License.txt for license terms.
+ */
+
+#ifndef VCTOOL_STATUS_CODES_CERTCACHE_HEADER_GUARD
+#define VCTOOL_STATUS_CODES_CERTCACHE_HEADER_GUARD
+
+#include <vctool/status_codes.h>
+
+/* make this header C++ friendly. */
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * \brief The certificate cache is disabled.
+ */
+#define VCTOOL_ERROR_CERTCACHE_DISABLED \
+    VCTOOL_STATUS_ERROR_MACRO(VCTOOL_COMPONENT_CERTCACHE, 0x0001U)
+
+/**
+ * \brief The certificate cache database could not be opened.
+ */
+#define VCTOOL_ERROR_CERTCACHE_OPEN \
+    VCTOOL_STATUS_ERROR_MACRO(VCTOOL_COMPONENT_CERTCACHE, 0x0002U)
+
+/**
+ * \brief An error occurred reading from the certificate cache.
+ */
+#define VCTOOL_ERROR_CERTCACHE_READ \
+    VCTOOL_STATUS_ERROR_MACRO(VCTOOL_COMPONENT_CERTCACHE, 0x0003U)
+
+/**
+ * \brief An error occurred writing to the certificate cache.
+ */
+#define VCTOOL_ERROR_CERTCACHE_WRITE \
+    VCTOOL_STATUS_ERROR_MACRO(VCTOOL_COMPONENT_CERTCACHE, 0x0004U)
+
+/* make this header C++ friendly. */
+#ifdef __cplusplus
+}
+#endif
+
+#endif /*VCTOOL_STATUS_CODES_CERTCACHE_HEADER_GUARD*/
@@ -28,6 +28,25 @@ extern "C" {
 #define VCTOOL_ERROR_CERTIFICATE_VERIFICATION \
     VCTOOL_STATUS_ERROR_MACRO(VCTOOL_COMPONENT_CERTIFICATE, 0x0002U)
 
+/**
+ * \brief A certificate failed attestation.
+ */
+#define VCTOOL_ERROR_CERTIFICATE_ATTESTATION \
+    VCTOOL_STATUS_ERROR_MACRO(VCTOOL_COMPONENT_CERTIFICATE, 0x0003U)
+
+/**
+ * \brief A trusted entity certificate is not a valid public entity
+ * certificate.
+ */
+#define VCTOOL_ERROR_CERTIFICATE_BAD_ENTITY \
+    VCTOOL_STATUS_ERROR_MACRO(VCTOOL_COMPONENT_CERTIFICATE, 0x0004U)
+
+/**
+ * \brief A keypair certificate file is accessible to others than its owner.
+ */
+#define VCTOOL_ERROR_CERTIFICATE_BAD_PERMISSIONS \
+    VCTOOL_STATUS_ERROR_MACRO(VCTOOL_COMPONENT_CERTIFICATE, 0x0005U)
+
 /* make this header C++ friendly. */
 #ifdef __cplusplus
 }
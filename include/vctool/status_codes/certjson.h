@@ -0,0 +1,54 @@
+/**
+ * \file include/vctool/status_codes/certjson.h
+ *
+ * \brief Status codes for the certjson component.
+ *
+ * \copyright 2020 Velo Payments.  See License.txt for license terms.
+ */
+
+#ifndef VCTOOL_STATUS_CODES_CERTJSON_HEADER_GUARD
+#define VCTOOL_STATUS_CODES_CERTJSON_HEADER_GUARD
+
+#include <vctool/status_codes.h>
+
+/* make this header C++ friendly. */
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * \brief A certificate field runs past the end of the certificate.
+ */
+#define VCTOOL_ERROR_CERTJSON_BAD_CERTIFICATE \
+    VCTOOL_STATUS_ERROR_MACRO(VCTOOL_COMPONENT_CERTJSON, 0x0001U)
+
+/**
+ * \brief The JSON text is malformed.
+ */
+#define VCTOOL_ERROR_CERTJSON_BAD_JSON \
+    VCTOOL_STATUS_ERROR_MACRO(VCTOOL_COMPONENT_CERTJSON, 0x0002U)
+
+/**
+ * \brief A JSON key does not name a field type.
+ */
+#define VCTOOL_ERROR_CERTJSON_UNKNOWN_FIELD \
+    VCTOOL_STATUS_ERROR_MACRO(VCTOOL_COMPONENT_CERTJSON, 0x0003U)
+
+/**
+ * \brief A JSON value is not a uuid or hex bytes, or is too large.
+ */
+#define VCTOOL_ERROR_CERTJSON_BAD_VALUE \
+    VCTOOL_STATUS_ERROR_MACRO(VCTOOL_COMPONENT_CERTJSON, 0x0004U)
+
+/**
+ * \brief A certificate does not fit in the buffer.
+ */
+#define VCTOOL_ERROR_CERTJSON_BUFFER_TOO_SMALL \
+    VCTOOL_STATUS_ERROR_MACRO(VCTOOL_COMPONENT_CERTJSON, 0x0005U)
+
+/* make this header C++ friendly. */
+#ifdef __cplusplus
+}
+#endif
+
+#endif /*VCTOOL_STATUS_CODES_CERTJSON_HEADER_GUARD*/
@@ -0,0 +1,72 @@
+/**
+ * \file include/vctool/status_codes/certschema.h
+ *
+ * \brief Status codes for the certschema component.
+ *
+ * \copyright 2020 Velo Payments.  See License.txt for license terms.
+ */
+
+#ifndef VCTOOL_STATUS_CODES_CERTSCHEMA_HEADER_GUARD
+#define VCTOOL_STATUS_CODES_CERTSCHEMA_HEADER_GUARD
+
+#include <vctool/status_codes.h>
+
+/* make this header C++ friendly. */
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * \brief A certificate field runs past the end of the certificate.
+ */
+#define VCTOOL_ERROR_CERTSCHEMA_BAD_CERTIFICATE \
+    VCTOOL_STATUS_ERROR_MACRO(VCTOOL_COMPONENT_CERTSCHEMA, 0x0001U)
+
+/**
+ * \brief A certificate has no certificate type.
+ */
+#define VCTOOL_ERROR_CERTSCHEMA_MISSING_TYPE \
+    VCTOOL_STATUS_ERROR_MACRO(VCTOOL_COMPONENT_CERTSCHEMA, 0x0002U)
+
+/**
+ * \brief There is no schema for a certificate type.
+ */
+#define VCTOOL_ERROR_CERTSCHEMA_UNKNOWN_TYPE \
+    VCTOOL_STATUS_ERROR_MACRO(VCTOOL_COMPONENT_CERTSCHEMA, 0x0003U)
+
+/**
+ * \brief A certificate holds a field outside the schema of its type.
+ */
+#define VCTOOL_ERROR_CERTSCHEMA_UNEXPECTED_FIELD \
+    VCTOOL_STATUS_ERROR_MACRO(VCTOOL_COMPONENT_CERTSCHEMA, 0x0004U)
+
+/**
+ * \brief A certificate holds a field twice.
+ */
+#define VCTOOL_ERROR_CERTSCHEMA_DUPLICATE_FIELD \
+    VCTOOL_STATUS_ERROR_MACRO(VCTOOL_COMPONENT_CERTSCHEMA, 0x0005U)
+
+/**
+ * \brief A certificate field has the wrong size.
+ */
+#define VCTOOL_ERROR_CERTSCHEMA_BAD_FIELD_SIZE \
+    VCTOOL_STATUS_ERROR_MACRO(VCTOOL_COMPONENT_CERTSCHEMA, 0x0006U)
+
+/**
+ * \brief A certificate lacks a field its schema requires.
+ */
+#define VCTOOL_ERROR_CERTSCHEMA_MISSING_FIELD \
+    VCTOOL_STATUS_ERROR_MACRO(VCTOOL_COMPONENT_CERTSCHEMA, 0x0007U)
+
+/**
+ * \brief One or more certificates failed validation or could not be read.
+ */
+#define VCTOOL_ERROR_CERTSCHEMA_INVALID \
+    VCTOOL_STATUS_ERROR_MACRO(VCTOOL_COMPONENT_CERTSCHEMA, 0x0008U)
+
+/* make this header C++ friendly. */
+#ifdef __cplusplus
+}
+#endif
+
+#endif /*VCTOOL_STATUS_CODES_CERTSCHEMA_HEADER_GUARD*/
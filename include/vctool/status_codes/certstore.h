@@ -0,0 +1,42 @@
+/**
+ * \file include/vctool/status_codes/certstore.h
+ *
+ * \brief Status codes for the certstore component.
+ *
+ * \copyright 2020 Velo Payments.  See License.txt for license terms.
+ */
+
+#ifndef VCTOOL_STATUS_CODES_CERTSTORE_HEADER_GUARD
+#define VCTOOL_STATUS_CODES_CERTSTORE_HEADER_GUARD
+
+#include <vctool/status_codes.h>
+
+/* make this header C++ friendly. */
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * \brief A reference name is empty or is not a plain file name.
+ */
+#define VCTOOL_ERROR_CERTSTORE_BAD_NAME \
+    VCTOOL_STATUS_ERROR_MACRO(VCTOOL_COMPONENT_CERTSTORE, 0x0001U)
+
+/**
+ * \brief A reference list is not a whole number of hashes.
+ */
+#define VCTOOL_ERROR_CERTSTORE_BAD_REF \
+    VCTOOL_STATUS_ERROR_MACRO(VCTOOL_COMPONENT_CERTSTORE, 0x0002U)
+
+/**
+ * \brief A store file was replaced while it was being read.
+ */
+#define VCTOOL_ERROR_CERTSTORE_CHANGED \
+    VCTOOL_STATUS_ERROR_MACRO(VCTOOL_COMPONENT_CERTSTORE, 0x0003U)
+
+/* make this header C++ friendly. */
+#ifdef __cplusplus
+}
+#endif
+
+#endif /*VCTOOL_STATUS_CODES_CERTSTORE_HEADER_GUARD*/
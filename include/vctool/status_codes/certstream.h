@@ -0,0 +1,37 @@
+/**
+ * \file include/vctool/status_codes/certstream.h
+ *
+ * \brief Status codes for the certstream component.
+ *
+ * \copyright 2020 Velo Payments.  See License.txt for license terms.
+ */
+
+#ifndef VCTOOL_STATUS_CODES_CERTSTREAM_HEADER_GUARD
+#define VCTOOL_STATUS_CODES_CERTSTREAM_HEADER_GUARD
+
+#include <vctool/status_codes.h>
+
+/* make this header C++ friendly. */
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * \brief A certificate stream ended inside a field.
+ */
+#define VCTOOL_ERROR_CERTSTREAM_TRUNCATED \
+    VCTOOL_STATUS_ERROR_MACRO(VCTOOL_COMPONENT_CERTSTREAM, 0x0001U)
+
+/**
+ * \brief A field of a wrapped transaction runs past the end of the
+ * transaction.
+ */
+#define VCTOOL_ERROR_CERTSTREAM_BAD_TRANSACTION \
+    VCTOOL_STATUS_ERROR_MACRO(VCTOOL_COMPONENT_CERTSTREAM, 0x0002U)
+
+/* make this header C++ friendly. */
+#ifdef __cplusplus
+}
+#endif
+
+#endif /*VCTOOL_STATUS_CODES_CERTSTREAM_HEADER_GUARD*/
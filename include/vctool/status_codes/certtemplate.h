@@ -0,0 +1,48 @@
+/**
+ * \file include/vctool/status_codes/certtemplate.h
+ *
+ * \brief Status codes for the certtemplate component.
+ *
+ * \copyright 2020 Velo Payments.  See License.txt for license terms.
+ */
+
+#ifndef VCTOOL_STATUS_CODES_CERTTEMPLATE_HEADER_GUARD
+#define VCTOOL_STATUS_CODES_CERTTEMPLATE_HEADER_GUARD
+
+#include <vctool/status_codes.h>
+
+/* make this header C++ friendly. */
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * \brief A template line could not be compiled.
+ */
+#define VCTOOL_ERROR_CERTTEMPLATE_BAD_TEMPLATE \
+    VCTOOL_STATUS_ERROR_MACRO(VCTOOL_COMPONENT_CERTTEMPLATE, 0x0001U)
+
+/**
+ * \brief A row value does not match the kind of its field.
+ */
+#define VCTOOL_ERROR_CERTTEMPLATE_BAD_VALUE \
+    VCTOOL_STATUS_ERROR_MACRO(VCTOOL_COMPONENT_CERTTEMPLATE, 0x0002U)
+
+/**
+ * \brief A row has fewer columns than the template uses.
+ */
+#define VCTOOL_ERROR_CERTTEMPLATE_MISSING_COLUMN \
+    VCTOOL_STATUS_ERROR_MACRO(VCTOOL_COMPONENT_CERTTEMPLATE, 0x0003U)
+
+/**
+ * \brief A certificate does not fit in the buffer.
+ */
+#define VCTOOL_ERROR_CERTTEMPLATE_BUFFER_TOO_SMALL \
+    VCTOOL_STATUS_ERROR_MACRO(VCTOOL_COMPONENT_CERTTEMPLATE, 0x0004U)
+
+/* make this header C++ friendly. */
+#ifdef __cplusplus
+}
+#endif
+
+#endif /*VCTOOL_STATUS_CODES_CERTTEMPLATE_HEADER_GUARD*/
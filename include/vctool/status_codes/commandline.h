@@ -46,6 +46,12 @@ extern "C" {
 #define VCTOOL_ERROR_COMMANDLINE_BAD_KEY_ROUNDS \
     VCTOOL_STATUS_ERROR_MACRO(VCTOOL_COMPONENT_COMMANDLINE, 0x0005U)
 
+/**
+ * \brief A command argument is malformed.
+ */
+#define VCTOOL_ERROR_COMMANDLINE_BAD_ARGUMENT \
+    VCTOOL_STATUS_ERROR_MACRO(VCTOOL_COMPONENT_COMMANDLINE, 0x0006U)
+
 /* make this header C++ friendly. */
 #ifdef __cplusplus
 }
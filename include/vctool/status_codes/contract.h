@@ -0,0 +1,48 @@
+/**
+ * \file include/vctool/status_codes/contract.h
+ *
+ * \brief Status codes for the contract component.
+ *
+ * \copyright 2020 Velo Payments.  See License.txt for license terms.
+ */
+
+#ifndef VCTOOL_STATUS_CODES_CONTRACT_HEADER_GUARD
+#define VCTOOL_STATUS_CODES_CONTRACT_HEADER_GUARD
+
+#include <vctool/status_codes.h>
+
+/* make this header C++ friendly. */
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * \brief A contract is already registered for this type pair.
+ */
+#define VCTOOL_ERROR_CONTRACT_DUPLICATE \
+    VCTOOL_STATUS_ERROR_MACRO(VCTOOL_COMPONENT_CONTRACT, 0x0001U)
+
+/**
+ * \brief No contract is registered for this type pair.
+ */
+#define VCTOOL_ERROR_CONTRACT_NOT_FOUND \
+    VCTOOL_STATUS_ERROR_MACRO(VCTOOL_COMPONENT_CONTRACT, 0x0002U)
+
+/**
+ * \brief The contract plugin could not be loaded.
+ */
+#define VCTOOL_ERROR_CONTRACT_PLUGIN_LOAD \
+    VCTOOL_STATUS_ERROR_MACRO(VCTOOL_COMPONENT_CONTRACT, 0x0003U)
+
+/**
+ * \brief The contract plugin does not export an init function.
+ */
+#define VCTOOL_ERROR_CONTRACT_PLUGIN_SYMBOL \
+    VCTOOL_STATUS_ERROR_MACRO(VCTOOL_COMPONENT_CONTRACT, 0x0004U)
+
+/* make this header C++ friendly. */
+#ifdef __cplusplus
+}
+#endif
+
+#endif /*VCTOOL_STATUS_CODES_CONTRACT_HEADER_GUARD*/
@@ -0,0 +1,30 @@
+/**
+ * \file include/vctool/status_codes/extsort.h
+ *
+ * \brief Status codes for the extsort component.
+ *
+ * \copyright 2020 Velo Payments.  See License.txt for license terms.
+ */
+
+#ifndef VCTOOL_STATUS_CODES_EXTSORT_HEADER_GUARD
+#define VCTOOL_STATUS_CODES_EXTSORT_HEADER_GUARD
+
+#include <vctool/status_codes.h>
+
+/* make this header C++ friendly. */
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * \brief A run file does not hold a whole number of records.
+ */
+#define VCTOOL_ERROR_EXTSORT_BAD_RUN \
+    VCTOOL_STATUS_ERROR_MACRO(VCTOOL_COMPONENT_EXTSORT, 0x0001U)
+
+/* make this header C++ friendly. */
+#ifdef __cplusplus
+}
+#endif
+
+#endif /*VCTOOL_STATUS_CODES_EXTSORT_HEADER_GUARD*/
@@ -22,6 +22,12 @@ extern "C" {
 #define VCTOOL_ERROR_GENERAL_OUT_OF_MEMORY \
     VCTOOL_STATUS_ERROR_MACRO(VCTOOL_COMPONENT_GENERAL, 0x0001U)
 
+/**
+ * \brief Memory for secrets could not be locked.
+ */
+#define VCTOOL_ERROR_GENERAL_SECURE_MEMORY \
+    VCTOOL_STATUS_ERROR_MACRO(VCTOOL_COMPONENT_GENERAL, 0x0002U)
+
 /* make this header C++ friendly. */
 #ifdef __cplusplus
 }
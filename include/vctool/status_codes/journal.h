@@ -0,0 +1,36 @@
+/**
+ * \file include/vctool/status_codes/journal.h
+ *
+ * \brief Status codes for the journal component.
+ *
+ * \copyright 2020 Velo Payments.  See License.txt for license terms.
+ */
+
+#ifndef VCTOOL_STATUS_CODES_JOURNAL_HEADER_GUARD
+#define VCTOOL_STATUS_CODES_JOURNAL_HEADER_GUARD
+
+#include <vctool/status_codes.h>
+
+/* make this header C++ friendly. */
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * \brief A file is not a submission journal.
+ */
+#define VCTOOL_ERROR_JOURNAL_BAD_JOURNAL \
+    VCTOOL_STATUS_ERROR_MACRO(VCTOOL_COMPONENT_JOURNAL, 0x0001U)
+
+/**
+ * \brief A transaction certificate has no certificate id to journal.
+ */
+#define VCTOOL_ERROR_JOURNAL_NO_TRANSACTION_ID \
+    VCTOOL_STATUS_ERROR_MACRO(VCTOOL_COMPONENT_JOURNAL, 0x0002U)
+
+/* make this header C++ friendly. */
+#ifdef __cplusplus
+}
+#endif
+
+#endif /*VCTOOL_STATUS_CODES_JOURNAL_HEADER_GUARD*/
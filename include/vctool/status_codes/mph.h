@@ -0,0 +1,42 @@
+/**
+ * \file include/vctool/status_codes/mph.h
+ *
+ * \brief Status codes for the mph component.
+ *
+ * \copyright 2020 Velo Payments.  See License.txt for license terms.
+ */
+
+#ifndef VCTOOL_STATUS_CODES_MPH_HEADER_GUARD
+#define VCTOOL_STATUS_CODES_MPH_HEADER_GUARD
+
+#include <vctool/status_codes.h>
+
+/* make this header C++ friendly. */
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * \brief The serialized perfect hash is malformed.
+ */
+#define VCTOOL_ERROR_MPH_BAD_FORMAT \
+    VCTOOL_STATUS_ERROR_MACRO(VCTOOL_COMPONENT_MPH, 0x0001U)
+
+/**
+ * \brief Two distinct keys have the same 64-bit hash.
+ */
+#define VCTOOL_ERROR_MPH_HASH_COLLISION \
+    VCTOOL_STATUS_ERROR_MACRO(VCTOOL_COMPONENT_MPH, 0x0002U)
+
+/**
+ * \brief A build thread could not be started.
+ */
+#define VCTOOL_ERROR_MPH_THREAD \
+    VCTOOL_STATUS_ERROR_MACRO(VCTOOL_COMPONENT_MPH, 0x0003U)
+
+/* make this header C++ friendly. */
+#ifdef __cplusplus
+}
+#endif
+
+#endif /*VCTOOL_STATUS_CODES_MPH_HEADER_GUARD*/
@@ -0,0 +1,42 @@
+/**
+ * \file include/vctool/status_codes/query.h
+ *
+ * \brief Status codes for the query component.
+ *
+ * \copyright 2020 Velo Payments.  See License.txt for license terms.
+ */
+
+#ifndef VCTOOL_STATUS_CODES_QUERY_HEADER_GUARD
+#define VCTOOL_STATUS_CODES_QUERY_HEADER_GUARD
+
+#include <vctool/status_codes.h>
+
+/* make this header C++ friendly. */
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * \brief A block could not be split into its transactions.
+ */
+#define VCTOOL_ERROR_QUERY_BAD_BLOCK \
+    VCTOOL_STATUS_ERROR_MACRO(VCTOOL_COMPONENT_QUERY, 0x0001U)
+
+/**
+ * \brief A request was not understood.
+ */
+#define VCTOOL_ERROR_QUERY_BAD_REQUEST \
+    VCTOOL_STATUS_ERROR_MACRO(VCTOOL_COMPONENT_QUERY, 0x0002U)
+
+/**
+ * \brief The query server socket could not be opened.
+ */
+#define VCTOOL_ERROR_QUERY_LISTEN \
+    VCTOOL_STATUS_ERROR_MACRO(VCTOOL_COMPONENT_QUERY, 0x0003U)
+
+/* make this header C++ friendly. */
+#ifdef __cplusplus
+}
+#endif
+
+#endif /*VCTOOL_STATUS_CODES_QUERY_HEADER_GUARD*/
@@ -0,0 +1,42 @@
+/**
+ * \file include/vctool/status_codes/revocation.h
+ *
+ * \brief Status codes for the revocation component.
+ *
+ * \copyright 2020 Velo Payments.  See License.txt for license terms.
+ */
+
+#ifndef VCTOOL_STATUS_CODES_REVOCATION_HEADER_GUARD
+#define VCTOOL_STATUS_CODES_REVOCATION_HEADER_GUARD
+
+#include <vctool/status_codes.h>
+
+/* make this header C++ friendly. */
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * \brief The revocation list has a bad header.
+ */
+#define VCTOOL_ERROR_REVOCATION_BAD_HEADER \
+    VCTOOL_STATUS_ERROR_MACRO(VCTOOL_COMPONENT_REVOCATION, 0x0001U)
+
+/**
+ * \brief The revocation list size does not match its header.
+ */
+#define VCTOOL_ERROR_REVOCATION_BAD_SIZE \
+    VCTOOL_STATUS_ERROR_MACRO(VCTOOL_COMPONENT_REVOCATION, 0x0002U)
+
+/**
+ * \brief At least one checked id has been revoked.
+ */
+#define VCTOOL_ERROR_REVOCATION_REVOKED \
+    VCTOOL_STATUS_ERROR_MACRO(VCTOOL_COMPONENT_REVOCATION, 0x0003U)
+
+/* make this header C++ friendly. */
+#ifdef __cplusplus
+}
+#endif
+
+#endif /*VCTOOL_STATUS_CODES_REVOCATION_HEADER_GUARD*/
@@ -0,0 +1,30 @@
+/**
+ * \file include/vctool/status_codes/scheduler.h
+ *
+ * \brief Status codes for the scheduler component.
+ *
+ * \copyright 2020 Velo Payments.  See License.txt for license terms.
+ */
+
+#ifndef VCTOOL_STATUS_CODES_SCHEDULER_HEADER_GUARD
+#define VCTOOL_STATUS_CODES_SCHEDULER_HEADER_GUARD
+
+#include <vctool/status_codes.h>
+
+/* make this header C++ friendly. */
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * \brief The scheduler was stopped.
+ */
+#define VCTOOL_ERROR_SCHEDULER_STOPPED \
+    VCTOOL_STATUS_ERROR_MACRO(VCTOOL_COMPONENT_SCHEDULER, 0x0001U)
+
+/* make this header C++ friendly. */
+#ifdef __cplusplus
+}
+#endif
+
+#endif /*VCTOOL_STATUS_CODES_SCHEDULER_HEADER_GUARD*/
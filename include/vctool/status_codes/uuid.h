@@ -0,0 +1,48 @@
+/**
+ * \file include/vctool/status_codes/uuid.h
+ *
+ * \brief Status codes for the uuid component.
+ *
+ * \copyright 2020 Velo Payments.  See License.txt for license terms.
+ */
+
+#ifndef VCTOOL_STATUS_CODES_UUID_HEADER_GUARD
+#define VCTOOL_STATUS_CODES_UUID_HEADER_GUARD
+
+#include <vctool/status_codes.h>
+
+/* make this header C++ friendly. */
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * \brief The string is not a valid uuid.
+ */
+#define VCTOOL_ERROR_UUID_INVALID_STRING \
+    VCTOOL_STATUS_ERROR_MACRO(VCTOOL_COMPONENT_UUID, 0x0001U)
+
+/**
+ * \brief The uuid is not in the dictionary.
+ */
+#define VCTOOL_ERROR_UUID_DICT_NOT_FOUND \
+    VCTOOL_STATUS_ERROR_MACRO(VCTOOL_COMPONENT_UUID, 0x0002U)
+
+/**
+ * \brief The uuid dictionary file is malformed.
+ */
+#define VCTOOL_ERROR_UUID_DICT_BAD_FORMAT \
+    VCTOOL_STATUS_ERROR_MACRO(VCTOOL_COMPONENT_UUID, 0x0003U)
+
+/**
+ * \brief The uuid dictionary has no more ids.
+ */
+#define VCTOOL_ERROR_UUID_DICT_FULL \
+    VCTOOL_STATUS_ERROR_MACRO(VCTOOL_COMPONENT_UUID, 0x0004U)
+
+/* make this header C++ friendly. */
+#ifdef __cplusplus
+}
+#endif
+
+#endif /*VCTOOL_STATUS_CODES_UUID_HEADER_GUARD*/
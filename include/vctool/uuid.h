@@ -0,0 +1,53 @@
+/**
+ * \file include/vctool/uuid.h
+ *
+ * \brief UUID string conversion.
+ *
+ * \copyright 2020 Velo Payments.  See License.txt for license terms.
+ */
+
+#ifndef  VCTOOL_UUID_HEADER_GUARD
+# define VCTOOL_UUID_HEADER_GUARD
+
+#include <stdint.h>
+#include <vctool/status_codes.h>
+
+/* make this header C++ friendly. */
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* the size of a binary uuid. */
+#define UUID_SIZE                                       16
+
+/* the size of a uuid string, including the asciiz terminator. */
+#define UUID_STRING_SIZE                                37
+
+/**
+ * \brief Parse a uuid string.
+ *
+ * Both the canonical 8-4-4-4-12 form and 32 bare hex digits are accepted.
+ *
+ * \param uuid          Buffer of UUID_SIZE bytes to receive the uuid.
+ * \param str           The string to parse.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - VCTOOL_ERROR_UUID_INVALID_STRING if the string is not a uuid.
+ */
+int uuid_from_string(uint8_t* uuid, const char* str);
+
+/**
+ * \brief Format a uuid in canonical 8-4-4-4-12 form.
+ *
+ * \param str           Buffer of UUID_STRING_SIZE bytes to receive the string.
+ * \param uuid          The uuid to format.
+ */
+void uuid_to_string(char* str, const uint8_t* uuid);
+
+/* make this header C++ friendly. */
+#ifdef __cplusplus
+}
+#endif
+
+#endif /*VCTOOL_UUID_HEADER_GUARD*/
@@ -0,0 +1,151 @@
+/**
+ * \file include/vctool/uuid_dict.h
+ *
+ * \brief Persistent uuid interning dictionary.
+ *
+ * A uuid dictionary assigns each distinct uuid a dense 32-bit id, in the
+ * order in which uuids are first interned.  Secondary indexes can then store
+ * and compare 4-byte ids instead of 16-byte uuids.  Ids are stable: once
+ * saved, a uuid keeps its id across loads.
+ *
+ * The file format is UUID_DICT_MAGIC, a big endian 64-bit count, and then
+ * the uuids in id order.
+ *
+ * \copyright 2020 Velo Payments.  See License.txt for license terms.
+ */
+
+#ifndef  VCTOOL_UUID_DICT_HEADER_GUARD
+# define VCTOOL_UUID_DICT_HEADER_GUARD
+
+#include <stdint.h>
+#include <vctool/file.h>
+#include <vctool/status_codes.h>
+#include <vctool/uuid.h>
+#include <vpr/disposable.h>
+
+/* make this header C++ friendly. */
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* uuid dictionary magic. */
+#define UUID_DICT_MAGIC                                 "VCUDICT1"
+#define UUID_DICT_MAGIC_SIZE                            8
+
+/* the size of the uuid dictionary header. */
+#define UUID_DICT_HEADER_SIZE                           16
+
+/* the initial number of hash table slots.  Must be a power of two. */
+#define UUID_DICT_INITIAL_SLOTS                         1024
+
+/* the largest id; UINT32_MAX marks an empty slot. */
+#define UUID_DICT_MAX_ID                                (UINT32_MAX - 1)
+
+/**
+ * \brief Uuid interning dictionary.
+ */
+typedef struct uuid_dict
+{
+    /** \brief uuid_dict is disposable. */
+    disposable_t hdr;
+
+    /** \brief uuids in id order. */
+    uint8_t* uuids;
+
+    /** \brief the number of uuids. */
+    uint32_t count;
+
+    /** \brief the number of uuids allocated. */
+    uint32_t reserved;
+
+    /** \brief open addressing table of ids, keyed by uuid hash. */
+    uint32_t* slots;
+
+    /** \brief the number of slots; a power of two. */
+    size_t slot_count;
+} uuid_dict;
+
+/**
+ * \brief Initialize an empty uuid dictionary.
+ *
+ * \param dict          The dictionary to initialize.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - VCTOOL_ERROR_GENERAL_OUT_OF_MEMORY if an allocation failed.
+ */
+int uuid_dict_init(uuid_dict* dict);
+
+/**
+ * \brief Load a uuid dictionary from a file.
+ *
+ * \param dict          The dictionary to initialize.
+ * \param f             The file abstraction layer to use.
+ * \param path          The path of the dictionary file.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - VCTOOL_ERROR_UUID_DICT_BAD_FORMAT if the file is malformed.
+ *      - a non-zero error code on failure.
+ */
+int uuid_dict_load(uuid_dict* dict, file* f, const char* path);
+
+/**
+ * \brief Save a uuid dictionary to a file.
+ *
+ * The dictionary is written to a temporary file which is then renamed over
+ * path.
+ *
+ * \param dict          The dictionary to save.
+ * \param f             The file abstraction layer to use.
+ * \param path          The path of the dictionary file.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - a non-zero error code on failure.
+ */
+int uuid_dict_save(const uuid_dict* dict, file* f, const char* path);
+
+/**
+ * \brief Get the id of a uuid, assigning the next id if it is new.
+ *
+ * \param dict          The dictionary.
+ * \param uuid          The UUID_SIZE byte uuid.
+ * \param id            Pointer to receive the id.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - VCTOOL_ERROR_UUID_DICT_FULL if there are no more ids.
+ *      - VCTOOL_ERROR_GENERAL_OUT_OF_MEMORY if an allocation failed.
+ */
+int uuid_dict_intern(uuid_dict* dict, const uint8_t* uuid, uint32_t* id);
+
+/**
+ * \brief Get the id of a uuid.
+ *
+ * \param dict          The dictionary.
+ * \param uuid          The UUID_SIZE byte uuid.
+ * \param id            Pointer to receive the id.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - VCTOOL_ERROR_UUID_DICT_NOT_FOUND if this uuid is not interned.
+ */
+int uuid_dict_find(const uuid_dict* dict, const uint8_t* uuid, uint32_t* id);
+
+/**
+ * \brief Get the uuid for an id.
+ *
+ * \param dict          The dictionary.
+ * \param id            The id.
+ *
+ * \returns the UUID_SIZE byte uuid, or NULL if this id is not assigned.
+ */
+const uint8_t* uuid_dict_get(const uuid_dict* dict, uint32_t id);
+
+/* make this header C++ friendly. */
+#ifdef __cplusplus
+}
+#endif
+
+#endif /*VCTOOL_UUID_DICT_HEADER_GUARD*/
@@ -0,0 +1,95 @@
+/**
+ * \file include/vctool/uuid_index.h
+ *
+ * \brief Cache friendly search index over sorted uuids.
+ *
+ * A uuid index stores a sorted uuid array in Eytzinger (breadth first) order,
+ * so the first levels of every search share the same few cache lines and the
+ * four grandchildren of a node share one cache line, which is prefetched two
+ * levels ahead.  The batch lookup interleaves many searches so that their
+ * memory accesses overlap.
+ *
+ * \copyright 2020 Velo Payments.  See License.txt for license terms.
+ */
+
+#ifndef  VCTOOL_UUID_INDEX_HEADER_GUARD
+# define VCTOOL_UUID_INDEX_HEADER_GUARD
+
+#include <stddef.h>
+#include <stdint.h>
+#include <vctool/status_codes.h>
+#include <vctool/uuid.h>
+#include <vpr/disposable.h>
+
+/* make this header C++ friendly. */
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* the number of searches interleaved by uuid_index_find_batch. */
+#define UUID_INDEX_BATCH_WIDTH                          16
+
+/* returned for uuids which are not in the index. */
+#define UUID_INDEX_NOT_FOUND                            SIZE_MAX
+
+/**
+ * \brief Search index over sorted uuids.
+ */
+typedef struct uuid_index
+{
+    /** \brief uuid_index is disposable. */
+    disposable_t hdr;
+
+    /** \brief the number of uuids. */
+    size_t count;
+
+    /** \brief uuids in Eytzinger order, starting at slot 1. */
+    uint8_t* keys;
+
+    /** \brief the sorted position of the uuid in each slot. */
+    size_t* positions;
+} uuid_index;
+
+/**
+ * \brief Build a search index over a sorted uuid array.
+ *
+ * \param index         The index to initialize.
+ * \param sorted        Array of sorted, distinct UUID_SIZE byte uuids.
+ * \param count         The number of uuids.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - VCTOOL_ERROR_GENERAL_OUT_OF_MEMORY if an allocation failed.
+ */
+int uuid_index_init(uuid_index* index, const uint8_t* sorted, size_t count);
+
+/**
+ * \brief Find the sorted position of a uuid.
+ *
+ * \param index         The index to search.
+ * \param key           The UUID_SIZE byte uuid.
+ *
+ * \returns the position of this uuid in the sorted array, or
+ *          UUID_INDEX_NOT_FOUND.
+ */
+size_t uuid_index_find(const uuid_index* index, const uint8_t* key);
+
+/**
+ * \brief Find the sorted positions of many uuids.
+ *
+ * \param index         The index to search.
+ * \param keys          Array of UUID_SIZE byte uuids.
+ * \param count         The number of uuids.
+ * \param positions     Array receiving the sorted position of each uuid, or
+ *                      UUID_INDEX_NOT_FOUND.
+ */
+void uuid_index_find_batch(
+    const uuid_index* index, const uint8_t* keys, size_t count,
+    size_t* positions);
+
+/* make this header C++ friendly. */
+#ifdef __cplusplus
+}
+#endif
+
+#endif /*VCTOOL_UUID_INDEX_HEADER_GUARD*/
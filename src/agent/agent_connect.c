@@ -0,0 +1,166 @@
+/**
+ * \file agent/agent_connect.c
+ *
+ * \brief Connect to an agent.
+ *
+ * \copyright 2020 Velo Payments.  See License.txt for license terms.
+ */
+
+#include <cbmc/model_assert.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include <vctool/agent.h>
+
+/* forward decls. */
+static int agent_connect_unix(int* sock, const char* path);
+static int agent_connect_tcp(int* sock, const char* address);
+
+/**
+ * \brief Connect to an agent.
+ *
+ * An address containing a slash is the path of a unix domain socket;
+ * otherwise it is host:port.  Nagle's algorithm is disabled on TCP
+ * connections, since each frame is written with a single write.
+ *
+ * \param sock          Pointer to receive the connected socket.
+ * \param address       The agent address.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - VCTOOL_ERROR_AGENT_BAD_ADDRESS if the address could not be resolved.
+ *      - VCTOOL_ERROR_AGENT_CONNECT if the connection failed.
+ */
+int agent_connect(int* sock, const char* address)
+{
+    /* parameter sanity checks. */
+    MODEL_ASSERT(NULL != sock);
+    MODEL_ASSERT(NULL != address);
+
+    if (NULL != strchr(address, '/'))
+    {
+        return agent_connect_unix(sock, address);
+    }
+    else
+    {
+        return agent_connect_tcp(sock, address);
+    }
+}
+
+/**
+ * \brief Connect to a unix domain socket.
+ *
+ * \param sock          Pointer to receive the connected socket.
+ * \param path          The socket path.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - VCTOOL_ERROR_AGENT_BAD_ADDRESS if the path is too long.
+ *      - VCTOOL_ERROR_AGENT_CONNECT if the connection failed.
+ */
+static int agent_connect_unix(int* sock, const char* path)
+{
+    struct sockaddr_un addr;
+
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    if (strlen(path) >= sizeof(addr.sun_path))
+    {
+        return VCTOOL_ERROR_AGENT_BAD_ADDRESS;
+    }
+    strcpy(addr.sun_path, path);
+
+    int s = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (s < 0)
+    {
+        return VCTOOL_ERROR_AGENT_CONNECT;
+    }
+
+    if (connect(s, (struct sockaddr*)&addr, sizeof(addr)) < 0)
+    {
+        close(s);
+        return VCTOOL_ERROR_AGENT_CONNECT;
+    }
+
+    *sock = s;
+
+    return VCTOOL_STATUS_SUCCESS;
+}
+
+/**
+ * \brief Connect to a TCP address.
+ *
+ * \param sock          Pointer to receive the connected socket.
+ * \param address       The address, as host:port.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - VCTOOL_ERROR_AGENT_BAD_ADDRESS if the address could not be resolved.
+ *      - VCTOOL_ERROR_AGENT_CONNECT if the connection failed.
+ */
+static int agent_connect_tcp(int* sock, const char* address)
+{
+    int retval;
+    struct addrinfo hints, *res, *ai;
+
+    /* split host and port at the last colon, so that the host may be an
+     * IPv6 address. */
+    const char* colon = strrchr(address, ':');
+    if (NULL == colon || colon == address || 0 == colon[1])
+    {
+        return VCTOOL_ERROR_AGENT_BAD_ADDRESS;
+    }
+
+    char* host = strndup(address, (size_t)(colon - address));
+    if (NULL == host)
+    {
+        return VCTOOL_ERROR_GENERAL_OUT_OF_MEMORY;
+    }
+
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    if (0 != getaddrinfo(host, colon + 1, &hints, &res))
+    {
+        retval = VCTOOL_ERROR_AGENT_BAD_ADDRESS;
+        goto cleanup_host;
+    }
+
+    /* try each resolved address in turn. */
+    retval = VCTOOL_ERROR_AGENT_CONNECT;
+    for (ai = res; NULL != ai; ai = ai->ai_next)
+    {
+        int s =
+            socket(ai->ai_family, ai->ai_socktype | SOCK_CLOEXEC,
+                ai->ai_protocol);
+        if (s < 0)
+        {
+            continue;
+        }
+
+        if (connect(s, ai->ai_addr, ai->ai_addrlen) < 0)
+        {
+            close(s);
+            continue;
+        }
+
+        int one = 1;
+        setsockopt(s, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+
+        *sock = s;
+        retval = VCTOOL_STATUS_SUCCESS;
+        break;
+    }
+
+    freeaddrinfo(res);
+
+cleanup_host:
+    free(host);
+
+    return retval;
+}
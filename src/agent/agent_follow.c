@@ -0,0 +1,182 @@
+/**
+ * \file agent/agent_follow.c
+ *
+ * \brief Follow canonized blocks from an agent.
+ *
+ * \copyright 2020 Velo Payments.  See License.txt for license terms.
+ */
+
+#include <cbmc/model_assert.h>
+#include <vctool/agent.h>
+#include <vctool/blockstore.h>
+
+/* forward decls. */
+static uint64_t agent_read_u64(const uint8_t* buf);
+static void agent_write_u64(uint8_t* buf, uint64_t val);
+
+/**
+ * \brief Follow canonized blocks, appending each to a segment.
+ *
+ * Subscribes from the given height, then appends each block received to the
+ * segment and, if out is not negative, copies its frame to out as soon as it
+ * has been appended.  Blocks must arrive in order, starting at the subscribed
+ * height, so the segment never skips or repeats a height.
+ *
+ * \param f             The file abstraction layer to use.
+ * \param sock          The socket connected to the agent.
+ * \param segment       The path of the segment.
+ * \param height        The height of the first block wanted; updated to the
+ *                      height after the last block appended.
+ * \param out           Descriptor receiving block frames, or -1.
+ * \param recorder      Captures the subscription and its blocks, or NULL.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_ERROR_AGENT_DISCONNECTED when the agent closes the
+ *        connection.
+ *      - VCTOOL_ERROR_AGENT_UNEXPECTED_MESSAGE if the agent sent something
+ *        other than a block.
+ *      - VCTOOL_ERROR_AGENT_BAD_FRAME if a frame was malformed.
+ *      - VCTOOL_ERROR_AGENT_BLOCK_OUT_OF_ORDER if a block was not the next
+ *        one.
+ *      - a non-zero error code on failure.
+ */
+int agent_follow(
+    file* f, int sock, const char* segment, uint64_t* height, int out,
+    agent_recorder* recorder)
+{
+    int retval;
+    agent_frame frame;
+    uint8_t subscribe[AGENT_SUBSCRIBE_SIZE];
+
+    /* parameter sanity checks. */
+    MODEL_ASSERT(PROP_FILE_VALID(f));
+    MODEL_ASSERT(NULL != segment);
+    MODEL_ASSERT(NULL != height);
+
+    /* ask for blocks from the next height on. */
+    agent_write_u64(subscribe, *height);
+
+    /* every block received belongs to the subscription's exchange. */
+    uint64_t exchange = 0;
+    if (NULL != recorder)
+    {
+        exchange = agent_recorder_exchange(recorder);
+        agent_recorder_write(
+            recorder, exchange, AGENT_RECORD_REQUEST, AGENT_MSG_SUBSCRIBE,
+            subscribe, sizeof(subscribe));
+    }
+
+    retval =
+        agent_frame_write(
+            f, sock, AGENT_MSG_SUBSCRIBE, subscribe, sizeof(subscribe));
+    if (VCTOOL_STATUS_SUCCESS != retval)
+    {
+        return retval;
+    }
+
+    retval = agent_frame_init(&frame);
+    if (VCTOOL_STATUS_SUCCESS != retval)
+    {
+        return retval;
+    }
+
+    /* handle blocks until the connection ends. */
+    for (;;)
+    {
+        retval = agent_frame_read(f, sock, &frame);
+        if (VCTOOL_STATUS_SUCCESS != retval)
+        {
+            break;
+        }
+
+        if (NULL != recorder)
+        {
+            agent_recorder_write(
+                recorder, exchange, AGENT_RECORD_RESPONSE, frame.type,
+                frame.payload, frame.size);
+        }
+
+        if (AGENT_MSG_BLOCK != frame.type)
+        {
+            retval = VCTOOL_ERROR_AGENT_UNEXPECTED_MESSAGE;
+            break;
+        }
+
+        if (frame.size < AGENT_BLOCK_HEADER_SIZE)
+        {
+            retval = VCTOOL_ERROR_AGENT_BAD_FRAME;
+            break;
+        }
+
+        /* a repeated or skipped height would leave the segment with a
+         * duplicate or a gap. */
+        uint64_t block_height = agent_read_u64(frame.payload);
+        if (block_height != *height)
+        {
+            retval = VCTOOL_ERROR_AGENT_BLOCK_OUT_OF_ORDER;
+            break;
+        }
+
+        retval =
+            blockstore_segment_append(
+                f, segment, block_height, frame.payload + 8,
+                frame.payload + AGENT_BLOCK_HEADER_SIZE,
+                frame.size - AGENT_BLOCK_HEADER_SIZE);
+        if (VCTOOL_STATUS_SUCCESS != retval)
+        {
+            break;
+        }
+
+        *height = block_height + 1;
+
+        /* pass the block on without waiting for the next one. */
+        if (out >= 0)
+        {
+            retval =
+                agent_frame_write(
+                    f, out, AGENT_MSG_BLOCK, frame.payload, frame.size);
+            if (VCTOOL_STATUS_SUCCESS != retval)
+            {
+                break;
+            }
+        }
+    }
+
+    dispose((disposable_t*)&frame);
+
+    return retval;
+}
+
+/**
+ * \brief Read a big endian 64-bit value.
+ *
+ * \param buf           The buffer from which the value is read.
+ *
+ * \returns the value.
+ */
+static uint64_t agent_read_u64(const uint8_t* buf)
+{
+    uint64_t val = 0;
+
+    for (int i = 0; i < 8; ++i)
+    {
+        val = (val << 8) | buf[i];
+    }
+
+    return val;
+}
+
+/**
+ * \brief Write a big endian 64-bit value.
+ *
+ * \param buf           The buffer to which the value is written.
+ * \param val           The value to write.
+ */
+static void agent_write_u64(uint8_t* buf, uint64_t val)
+{
+    for (int i = 7; i >= 0; --i)
+    {
+        buf[i] = (uint8_t)(val & 0xff);
+        val >>= 8;
+    }
+}
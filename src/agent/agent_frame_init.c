@@ -0,0 +1,52 @@
+/**
+ * \file agent/agent_frame_init.c
+ *
+ * \brief Initialize an agent frame.
+ *
+ * \copyright 2020 Velo Payments.  See License.txt for license terms.
+ */
+
+#include <cbmc/model_assert.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vctool/agent.h>
+
+/* forward decls. */
+static void agent_frame_dispose(void* disp);
+
+/**
+ * \brief Initialize an empty frame.
+ *
+ * \param frame         The frame to initialize.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ */
+int agent_frame_init(agent_frame* frame)
+{
+    /* parameter sanity checks. */
+    MODEL_ASSERT(NULL != frame);
+
+    /* clear the frame. */
+    memset(frame, 0, sizeof(agent_frame));
+
+    frame->hdr.dispose = &agent_frame_dispose;
+
+    /* success. */
+    return VCTOOL_STATUS_SUCCESS;
+}
+
+/**
+ * \brief Dispose of an agent frame.
+ *
+ * \param disp          The frame to dispose.
+ */
+static void agent_frame_dispose(void* disp)
+{
+    agent_frame* frame = (agent_frame*)disp;
+
+    free(frame->payload);
+
+    /* clear the frame. */
+    memset(frame, 0, sizeof(agent_frame));
+}
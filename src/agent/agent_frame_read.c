@@ -0,0 +1,145 @@
+/**
+ * \file agent/agent_frame_read.c
+ *
+ * \brief Read a frame from a peer.
+ *
+ * \copyright 2020 Velo Payments.  See License.txt for license terms.
+ */
+
+#include <cbmc/model_assert.h>
+#include <stdlib.h>
+#include <vctool/agent.h>
+
+/* forward decls. */
+static int agent_read_all(
+    file* f, int sock, uint8_t* buf, size_t size, size_t* got);
+static uint32_t agent_read_u32(const uint8_t* buf);
+
+/**
+ * \brief Read the next frame from a peer.
+ *
+ * \param f             The file abstraction layer to use.
+ * \param sock          The socket to read from.
+ * \param frame         The frame receiving the message.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - VCTOOL_ERROR_AGENT_DISCONNECTED if the peer closed the connection
+ *        between frames.
+ *      - VCTOOL_ERROR_AGENT_BAD_FRAME if the frame was truncated or too
+ *        large.
+ *      - VCTOOL_ERROR_GENERAL_OUT_OF_MEMORY if an allocation failed.
+ *      - a non-zero error code returned by the file layer.
+ */
+int agent_frame_read(file* f, int sock, agent_frame* frame)
+{
+    int retval;
+    uint8_t header[AGENT_FRAME_HEADER_SIZE];
+    size_t got;
+
+    /* parameter sanity checks. */
+    MODEL_ASSERT(PROP_FILE_VALID(f));
+    MODEL_ASSERT(NULL != frame);
+
+    /* read the header. */
+    retval = agent_read_all(f, sock, header, sizeof(header), &got);
+    if (VCTOOL_STATUS_SUCCESS != retval)
+    {
+        return retval;
+    }
+    else if (0 == got)
+    {
+        return VCTOOL_ERROR_AGENT_DISCONNECTED;
+    }
+    else if (sizeof(header) != got)
+    {
+        return VCTOOL_ERROR_AGENT_BAD_FRAME;
+    }
+
+    uint32_t type = agent_read_u32(header);
+    uint32_t size = agent_read_u32(header + 4);
+    if (size > AGENT_MAX_PAYLOAD_SIZE)
+    {
+        return VCTOOL_ERROR_AGENT_BAD_FRAME;
+    }
+
+    /* grow the payload buffer if needed. */
+    if (size > frame->capacity)
+    {
+        uint8_t* tmp = (uint8_t*)realloc(frame->payload, size);
+        if (NULL == tmp)
+        {
+            return VCTOOL_ERROR_GENERAL_OUT_OF_MEMORY;
+        }
+
+        frame->payload = tmp;
+        frame->capacity = size;
+    }
+
+    /* read the payload. */
+    retval = agent_read_all(f, sock, frame->payload, size, &got);
+    if (VCTOOL_STATUS_SUCCESS != retval)
+    {
+        return retval;
+    }
+    else if (size != got)
+    {
+        return VCTOOL_ERROR_AGENT_BAD_FRAME;
+    }
+
+    frame->type = type;
+    frame->size = size;
+
+    return VCTOOL_STATUS_SUCCESS;
+}
+
+/**
+ * \brief Read until a buffer is full or the peer closes the connection.
+ *
+ * \param f             The file abstraction layer to use.
+ * \param sock          The socket to read from.
+ * \param buf           The buffer to fill.
+ * \param size          The size of the buffer.
+ * \param got           Set to the number of bytes read.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - a non-zero error code returned by the file layer.
+ */
+static int agent_read_all(
+    file* f, int sock, uint8_t* buf, size_t size, size_t* got)
+{
+    int retval;
+    size_t rbytes;
+
+    for (*got = 0; *got < size; *got += rbytes)
+    {
+        retval = file_read(f, sock, buf + *got, size - *got, &rbytes);
+        if (VCTOOL_STATUS_SUCCESS != retval)
+        {
+            return retval;
+        }
+
+        /* end of stream. */
+        if (0 == rbytes)
+        {
+            break;
+        }
+    }
+
+    return VCTOOL_STATUS_SUCCESS;
+}
+
+/**
+ * \brief Read a big endian 32-bit value.
+ *
+ * \param buf           The buffer from which the value is read.
+ *
+ * \returns the value.
+ */
+static uint32_t agent_read_u32(const uint8_t* buf)
+{
+    return
+        ((uint32_t)buf[0] << 24) | ((uint32_t)buf[1] << 16)
+      | ((uint32_t)buf[2] << 8) | (uint32_t)buf[3];
+}
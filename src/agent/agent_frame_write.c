@@ -0,0 +1,81 @@
+/**
+ * \file agent/agent_frame_write.c
+ *
+ * \brief Write a frame to a peer.
+ *
+ * \copyright 2020 Velo Payments.  See License.txt for license terms.
+ */
+
+#include <cbmc/model_assert.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vctool/agent.h>
+
+/* forward decls. */
+static void agent_write_u32(uint8_t* buf, uint32_t val);
+
+/**
+ * \brief Write a frame to a peer.
+ *
+ * The header and payload go out in a single write, so that a frame is not
+ * split across packets.
+ *
+ * \param f             The file abstraction layer to use.
+ * \param sock          The socket to write to.
+ * \param type          The message type.
+ * \param payload       The payload.
+ * \param size          The size of the payload.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - VCTOOL_ERROR_AGENT_BAD_FRAME if the payload is too large.
+ *      - VCTOOL_ERROR_GENERAL_OUT_OF_MEMORY if an allocation failed.
+ *      - a non-zero error code returned by the file layer.
+ */
+int agent_frame_write(
+    file* f, int sock, uint32_t type, const void* payload, size_t size)
+{
+    int retval;
+
+    /* parameter sanity checks. */
+    MODEL_ASSERT(PROP_FILE_VALID(f));
+    MODEL_ASSERT(0 == size || NULL != payload);
+
+    if (size > AGENT_MAX_PAYLOAD_SIZE)
+    {
+        return VCTOOL_ERROR_AGENT_BAD_FRAME;
+    }
+
+    uint8_t* buf = (uint8_t*)malloc(AGENT_FRAME_HEADER_SIZE + size);
+    if (NULL == buf)
+    {
+        return VCTOOL_ERROR_GENERAL_OUT_OF_MEMORY;
+    }
+
+    agent_write_u32(buf, type);
+    agent_write_u32(buf + 4, (uint32_t)size);
+    if (size > 0)
+    {
+        memcpy(buf + AGENT_FRAME_HEADER_SIZE, payload, size);
+    }
+
+    retval = file_write_all(f, sock, buf, AGENT_FRAME_HEADER_SIZE + size);
+
+    free(buf);
+
+    return retval;
+}
+
+/**
+ * \brief Write a big endian 32-bit value.
+ *
+ * \param buf           The buffer to which the value is written.
+ * \param val           The value to write.
+ */
+static void agent_write_u32(uint8_t* buf, uint32_t val)
+{
+    buf[0] = (uint8_t)(val >> 24);
+    buf[1] = (uint8_t)(val >> 16);
+    buf[2] = (uint8_t)(val >> 8);
+    buf[3] = (uint8_t)val;
+}
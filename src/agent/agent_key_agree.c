@@ -0,0 +1,151 @@
+/**
+ * \file agent/agent_key_agree.c
+ *
+ * \brief Run the full key agreement with an agent.
+ *
+ * \copyright 2020 Velo Payments.  See License.txt for license terms.
+ */
+
+#include <cbmc/model_assert.h>
+#include <string.h>
+#include <time.h>
+#include <vctool/agent.h>
+
+/* the size of an AGENT_MSG_KEY_AGREED payload before its ticket. */
+#define AGENT_KEY_AGREED_HEADER_SIZE \
+    (AGENT_SESSION_NONCE_SIZE + 8)
+
+/* forward decls. */
+static uint64_t agent_read_u64(const uint8_t* buf);
+
+/**
+ * \brief Run the full key agreement with an agent.
+ *
+ * This is an agent_key_agreement_fn, for an agent_session_resumer.
+ *
+ * \param context       The agent_key_agreement.
+ * \param f             The file abstraction layer.
+ * \param sock          The connection.
+ * \param session       The session to fill in with the agreed key, its
+ *                      nonces, its ticket, and its expiry.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - VCTOOL_ERROR_AGENT_UNEXPECTED_MESSAGE if the agent answered with
+ *        something else.
+ *      - VCTOOL_ERROR_AGENT_BAD_FRAME if the answer is too short.
+ *      - VCTOOL_ERROR_AGENT_BAD_SESSION if the ticket or the key is too large
+ *        to be cached.
+ *      - a non-zero error code on failure.
+ */
+int agent_key_agree(void* context, file* f, int sock, agent_session* session)
+{
+    int retval;
+    vccrypt_prng_context_t prng;
+    agent_frame response;
+    uint8_t request[AGENT_ENTITY_ID_SIZE + AGENT_SESSION_NONCE_SIZE];
+    agent_key_agreement* keys = (agent_key_agreement*)context;
+
+    /* parameter sanity checks. */
+    MODEL_ASSERT(NULL != keys);
+    MODEL_ASSERT(NULL != keys->suite);
+    MODEL_ASSERT(PROP_FILE_VALID(f));
+    MODEL_ASSERT(NULL != session);
+
+    /* the client nonce makes every session key fresh. */
+    retval = vccrypt_suite_prng_init(keys->suite, &prng);
+    if (VCCRYPT_STATUS_SUCCESS != retval)
+    {
+        goto done;
+    }
+
+    retval =
+        vccrypt_prng_read_c(
+            &prng, session->client_nonce, AGENT_SESSION_NONCE_SIZE);
+    dispose((disposable_t*)&prng);
+    if (VCCRYPT_STATUS_SUCCESS != retval)
+    {
+        goto done;
+    }
+
+    memcpy(request, keys->client_id, AGENT_ENTITY_ID_SIZE);
+    memcpy(
+        request + AGENT_ENTITY_ID_SIZE, session->client_nonce,
+        AGENT_SESSION_NONCE_SIZE);
+
+    retval =
+        agent_frame_write(
+            f, sock, AGENT_MSG_KEY_AGREE, request, sizeof(request));
+    if (VCTOOL_STATUS_SUCCESS != retval)
+    {
+        goto done;
+    }
+
+    retval = agent_frame_init(&response);
+    if (VCTOOL_STATUS_SUCCESS != retval)
+    {
+        goto done;
+    }
+
+    retval = agent_frame_read(f, sock, &response);
+    if (VCTOOL_STATUS_SUCCESS != retval)
+    {
+        goto cleanup_response;
+    }
+
+    if (AGENT_MSG_KEY_AGREED != response.type)
+    {
+        retval = VCTOOL_ERROR_AGENT_UNEXPECTED_MESSAGE;
+        goto cleanup_response;
+    }
+
+    if (response.size < AGENT_KEY_AGREED_HEADER_SIZE)
+    {
+        retval = VCTOOL_ERROR_AGENT_BAD_FRAME;
+        goto cleanup_response;
+    }
+
+    size_t ticket_size = response.size - AGENT_KEY_AGREED_HEADER_SIZE;
+    if (ticket_size > AGENT_SESSION_TICKET_MAX)
+    {
+        retval = VCTOOL_ERROR_AGENT_BAD_SESSION;
+        goto cleanup_response;
+    }
+
+    memcpy(session->agent_nonce, response.payload, AGENT_SESSION_NONCE_SIZE);
+    session->expires =
+        (uint64_t)time(NULL)
+      + agent_read_u64(response.payload + AGENT_SESSION_NONCE_SIZE);
+    session->ticket_size = ticket_size;
+    memcpy(
+        session->ticket, response.payload + AGENT_KEY_AGREED_HEADER_SIZE,
+        ticket_size);
+
+    /* both sides derive the key from both nonces. */
+    retval = agent_session_derive_key(keys, session);
+
+cleanup_response:
+    dispose((disposable_t*)&response);
+
+done:
+    return retval;
+}
+
+/**
+ * \brief Read a big endian 64-bit value.
+ *
+ * \param buf           The buffer from which the value is read.
+ *
+ * \returns the value.
+ */
+static uint64_t agent_read_u64(const uint8_t* buf)
+{
+    uint64_t val = 0;
+
+    for (int i = 0; i < 8; ++i)
+    {
+        val = (val << 8) | buf[i];
+    }
+
+    return val;
+}
@@ -0,0 +1,67 @@
+/**
+ * \file agent/agent_limiter_acquire.c
+ *
+ * \brief Wait for room in a limiter's window.
+ *
+ * \copyright 2020 Velo Payments.  See License.txt for license terms.
+ */
+
+#include <cbmc/model_assert.h>
+#include <time.h>
+#include <vctool/agent.h>
+
+/* forward decls. */
+static uint64_t agent_limiter_now(void);
+
+/**
+ * \brief Wait until the window admits another request.
+ *
+ * \param limiter       The limiter.
+ * \param ticket        Receives the ticket to pass to agent_limiter_release.
+ */
+void agent_limiter_acquire(
+    agent_limiter* limiter, agent_limiter_ticket* ticket)
+{
+    /* parameter sanity checks. */
+    MODEL_ASSERT(NULL != limiter);
+    MODEL_ASSERT(NULL != ticket);
+
+    pthread_mutex_lock(&limiter->lock);
+
+    uint64_t queued_at = agent_limiter_now();
+
+    /* the window always admits at least one request. */
+    ++limiter->queued;
+    while ((limiter->in_flight + 1) * AGENT_LIMIT_SCALE > limiter->window)
+    {
+        pthread_cond_wait(&limiter->ready, &limiter->lock);
+    }
+    --limiter->queued;
+    ++limiter->in_flight;
+
+    ticket->start = agent_limiter_now();
+    ticket->epoch = limiter->epoch;
+
+    uint64_t waited = ticket->start - queued_at;
+    limiter->queue_time_total += waited;
+    if (waited > limiter->queue_time_max)
+    {
+        limiter->queue_time_max = waited;
+    }
+
+    pthread_mutex_unlock(&limiter->lock);
+}
+
+/**
+ * \brief Get the monotonic time.
+ *
+ * \returns the time in nanoseconds.
+ */
+static uint64_t agent_limiter_now(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
@@ -0,0 +1,84 @@
+/**
+ * \file agent/agent_limiter_init.c
+ *
+ * \brief Create an adaptive limit on requests in flight.
+ *
+ * \copyright 2020 Velo Payments.  See License.txt for license terms.
+ */
+
+#include <cbmc/model_assert.h>
+#include <string.h>
+#include <vctool/agent.h>
+
+/* forward decls. */
+static void agent_limiter_dispose(void* disp);
+
+/**
+ * \brief Create a limiter.
+ *
+ * \param limiter       The limiter to initialize.
+ * \param initial       The initial window, in requests.
+ * \param min           The smallest window, at least 1.
+ * \param max           The largest window.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - VCTOOL_ERROR_GENERAL_OUT_OF_MEMORY if the lock could not be created.
+ */
+int agent_limiter_init(
+    agent_limiter* limiter, size_t initial, size_t min, size_t max)
+{
+    /* parameter sanity checks. */
+    MODEL_ASSERT(NULL != limiter);
+    MODEL_ASSERT(min > 0);
+    MODEL_ASSERT(min <= max);
+
+    /* clear the limiter. */
+    memset(limiter, 0, sizeof(agent_limiter));
+
+    /* start within the bounds. */
+    if (initial < min)
+    {
+        initial = min;
+    }
+    else if (initial > max)
+    {
+        initial = max;
+    }
+
+    limiter->window = (uint64_t)initial * AGENT_LIMIT_SCALE;
+    limiter->min_window = (uint64_t)min * AGENT_LIMIT_SCALE;
+    limiter->max_window = (uint64_t)max * AGENT_LIMIT_SCALE;
+
+    if (0 != pthread_mutex_init(&limiter->lock, NULL))
+    {
+        return VCTOOL_ERROR_GENERAL_OUT_OF_MEMORY;
+    }
+
+    if (0 != pthread_cond_init(&limiter->ready, NULL))
+    {
+        pthread_mutex_destroy(&limiter->lock);
+        return VCTOOL_ERROR_GENERAL_OUT_OF_MEMORY;
+    }
+
+    limiter->hdr.dispose = &agent_limiter_dispose;
+
+    /* success. */
+    return VCTOOL_STATUS_SUCCESS;
+}
+
+/**
+ * \brief Dispose of a limiter.
+ *
+ * \param disp          The limiter to dispose.
+ */
+static void agent_limiter_dispose(void* disp)
+{
+    agent_limiter* limiter = (agent_limiter*)disp;
+
+    pthread_cond_destroy(&limiter->ready);
+    pthread_mutex_destroy(&limiter->lock);
+
+    /* clear the limiter. */
+    memset(limiter, 0, sizeof(agent_limiter));
+}
@@ -0,0 +1,44 @@
+/**
+ * \file agent/agent_limiter_metrics_get.c
+ *
+ * \brief Take a snapshot of a limiter.
+ *
+ * \copyright 2020 Velo Payments.  See License.txt for license terms.
+ */
+
+#include <cbmc/model_assert.h>
+#include <vctool/agent.h>
+
+/**
+ * \brief Take a snapshot of a limiter.
+ *
+ * \param limiter       The limiter.
+ * \param metrics       Receives the snapshot.
+ */
+void agent_limiter_metrics_get(
+    agent_limiter* limiter, agent_limiter_metrics* metrics)
+{
+    /* parameter sanity checks. */
+    MODEL_ASSERT(NULL != limiter);
+    MODEL_ASSERT(NULL != metrics);
+
+    pthread_mutex_lock(&limiter->lock);
+
+    metrics->window = (size_t)(limiter->window / AGENT_LIMIT_SCALE);
+    metrics->in_flight = limiter->in_flight;
+    metrics->queued = limiter->queued;
+    metrics->baseline = limiter->baseline;
+    metrics->completed = limiter->completed;
+    metrics->busy = limiter->busy;
+    metrics->failed = limiter->failed;
+    metrics->queue_time_max = limiter->queue_time_max;
+
+    /* every admitted request has waited, whatever its outcome. */
+    uint64_t admitted =
+        limiter->completed + limiter->busy + limiter->failed
+      + limiter->in_flight;
+    metrics->queue_time_mean =
+        (0 == admitted) ? 0 : limiter->queue_time_total / admitted;
+
+    pthread_mutex_unlock(&limiter->lock);
+}
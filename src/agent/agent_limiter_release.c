@@ -0,0 +1,140 @@
+/**
+ * \file agent/agent_limiter_release.c
+ *
+ * \brief Complete a request, adjusting a limiter's window.
+ *
+ * \copyright 2020 Velo Payments.  See License.txt for license terms.
+ */
+
+#include <cbmc/model_assert.h>
+#include <vctool/agent.h>
+
+/* forward decls. */
+static void agent_limiter_sample(agent_limiter* limiter, uint64_t latency);
+static void agent_limiter_decrease(
+    agent_limiter* limiter, const agent_limiter_ticket* ticket,
+    uint64_t num, uint64_t den);
+
+/**
+ * \brief Complete a request, adjusting the window from its outcome.
+ *
+ * An accepted request grows a full window by one request per window's worth
+ * of completions, as long as its latency is within AGENT_LIMIT_TOLERANCE of
+ * the baseline; a slower request shrinks the window by an eighth.  A busy
+ * agent halves the window.  Only the first signal from the requests
+ * admitted at the same window size shrinks it, so a burst of busy answers to
+ * one round of requests counts once.  Other failures leave the window be.
+ *
+ * \param limiter       The limiter.
+ * \param ticket        The ticket from agent_limiter_acquire.
+ * \param latency       The request latency, in nanoseconds.
+ * \param status        VCTOOL_STATUS_SUCCESS if the agent accepted the
+ *                      request, VCTOOL_ERROR_AGENT_BUSY if it was too busy,
+ *                      or another error code if the request failed.
+ */
+void agent_limiter_release(
+    agent_limiter* limiter, const agent_limiter_ticket* ticket,
+    uint64_t latency, int status)
+{
+    /* parameter sanity checks. */
+    MODEL_ASSERT(NULL != limiter);
+    MODEL_ASSERT(NULL != ticket);
+    MODEL_ASSERT(limiter->in_flight > 0);
+
+    pthread_mutex_lock(&limiter->lock);
+
+    /* the window only grows while it is what limits the requests. */
+    bool saturated =
+        limiter->in_flight * AGENT_LIMIT_SCALE + AGENT_LIMIT_SCALE
+            > limiter->window;
+    --limiter->in_flight;
+
+    if (VCTOOL_STATUS_SUCCESS == status)
+    {
+        ++limiter->completed;
+        agent_limiter_sample(limiter, latency);
+
+        if (latency > limiter->baseline * AGENT_LIMIT_TOLERANCE)
+        {
+            agent_limiter_decrease(limiter, ticket, 7, 8);
+        }
+        else if (saturated)
+        {
+            limiter->window +=
+                (uint64_t)AGENT_LIMIT_SCALE * AGENT_LIMIT_SCALE
+                    / limiter->window;
+            if (limiter->window > limiter->max_window)
+            {
+                limiter->window = limiter->max_window;
+            }
+        }
+    }
+    else if (VCTOOL_ERROR_AGENT_BUSY == status)
+    {
+        ++limiter->busy;
+        agent_limiter_decrease(limiter, ticket, 1, 2);
+    }
+    else
+    {
+        ++limiter->failed;
+    }
+
+    pthread_cond_broadcast(&limiter->ready);
+
+    pthread_mutex_unlock(&limiter->lock);
+}
+
+/**
+ * \brief Fold a latency sample into the baseline.
+ *
+ * The baseline is the lowest latency seen, and is reset to the lowest of
+ * each AGENT_LIMIT_BASELINE_SAMPLES samples, so that it follows the agent
+ * when it becomes slower for good.
+ *
+ * \param limiter       The limiter.
+ * \param latency       The sample, in nanoseconds.
+ */
+static void agent_limiter_sample(agent_limiter* limiter, uint64_t latency)
+{
+    if (0 == limiter->baseline || latency < limiter->baseline)
+    {
+        limiter->baseline = latency;
+    }
+
+    if (0 == limiter->period_samples || latency < limiter->period_min)
+    {
+        limiter->period_min = latency;
+    }
+
+    if (++limiter->period_samples >= AGENT_LIMIT_BASELINE_SAMPLES)
+    {
+        limiter->baseline = limiter->period_min;
+        limiter->period_samples = 0;
+    }
+}
+
+/**
+ * \brief Shrink the window, once per round of requests.
+ *
+ * \param limiter       The limiter.
+ * \param ticket        The ticket of the request which signaled.
+ * \param num           The numerator of the factor to shrink by.
+ * \param den           The denominator of the factor to shrink by.
+ */
+static void agent_limiter_decrease(
+    agent_limiter* limiter, const agent_limiter_ticket* ticket,
+    uint64_t num, uint64_t den)
+{
+    if (ticket->epoch != limiter->epoch)
+    {
+        return;
+    }
+
+    limiter->window = limiter->window * num / den;
+    if (limiter->window < limiter->min_window)
+    {
+        limiter->window = limiter->min_window;
+    }
+
+    ++limiter->epoch;
+}
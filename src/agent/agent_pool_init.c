@@ -0,0 +1,168 @@
+/**
+ * \file agent/agent_pool_init.c
+ *
+ * \brief Open a pool of connections to an agent.
+ *
+ * \copyright 2020 Velo Payments.  See License.txt for license terms.
+ */
+
+#include <cbmc/model_assert.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <vctool/agent.h>
+
+/* forward decls. */
+static void agent_pool_dispose(void* disp);
+static void agent_pool_close(agent_pool* pool);
+
+/**
+ * \brief Open a pool of connections to an agent.
+ *
+ * \param pool          The pool to initialize.
+ * \param f             The file abstraction layer to use.
+ * \param address       The agent address, as for agent_connect.
+ * \param count         The number of connections.
+ * \param handshake     Function run on each new connection, or NULL.
+ * \param context       The user context passed to handshake.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - VCTOOL_ERROR_GENERAL_OUT_OF_MEMORY if an allocation failed.
+ *      - a non-zero error code from agent_connect or the handshake.
+ */
+int agent_pool_init(
+    agent_pool* pool, file* f, const char* address, size_t count,
+    agent_handshake_fn handshake, void* context)
+{
+    int retval;
+
+    /* parameter sanity checks. */
+    MODEL_ASSERT(NULL != pool);
+    MODEL_ASSERT(PROP_FILE_VALID(f));
+    MODEL_ASSERT(NULL != address);
+    MODEL_ASSERT(count > 0);
+
+    /* clear the pool. */
+    memset(pool, 0, sizeof(agent_pool));
+    pool->f = f;
+    pool->handshake = handshake;
+    pool->handshake_context = context;
+
+    pool->address = strdup(address);
+    if (NULL == pool->address)
+    {
+        return VCTOOL_ERROR_GENERAL_OUT_OF_MEMORY;
+    }
+
+    pool->connections =
+        (agent_pool_connection*)calloc(count, sizeof(agent_pool_connection));
+    if (NULL == pool->connections)
+    {
+        retval = VCTOOL_ERROR_GENERAL_OUT_OF_MEMORY;
+        goto cleanup_address;
+    }
+
+    if (0 != pthread_mutex_init(&pool->lock, NULL))
+    {
+        retval = VCTOOL_ERROR_GENERAL_OUT_OF_MEMORY;
+        goto cleanup_connections;
+    }
+
+    if (0 != pthread_cond_init(&pool->idle, NULL))
+    {
+        retval = VCTOOL_ERROR_GENERAL_OUT_OF_MEMORY;
+        goto cleanup_lock;
+    }
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        pool->connections[i].sock = -1;
+        agent_frame_init(&pool->connections[i].response);
+    }
+    pool->count = count;
+
+    /* open every connection up front, so that a bad address or a refused
+     * handshake is reported here. */
+    for (size_t i = 0; i < count; ++i)
+    {
+        agent_pool_connection* conn = &pool->connections[i];
+
+        retval = agent_connect(&conn->sock, address);
+        if (VCTOOL_STATUS_SUCCESS != retval)
+        {
+            conn->sock = -1;
+            goto cleanup_pool;
+        }
+
+        if (NULL != handshake)
+        {
+            retval = handshake(context, f, conn->sock);
+            if (VCTOOL_STATUS_SUCCESS != retval)
+            {
+                goto cleanup_pool;
+            }
+        }
+    }
+
+    pool->hdr.dispose = &agent_pool_dispose;
+
+    /* success. */
+    return VCTOOL_STATUS_SUCCESS;
+
+cleanup_pool:
+    agent_pool_close(pool);
+    pthread_cond_destroy(&pool->idle);
+
+cleanup_lock:
+    pthread_mutex_destroy(&pool->lock);
+
+cleanup_connections:
+    free(pool->connections);
+
+cleanup_address:
+    free(pool->address);
+    memset(pool, 0, sizeof(agent_pool));
+
+    return retval;
+}
+
+/**
+ * \brief Dispose of an agent pool.
+ *
+ * \param disp          The pool to dispose.
+ */
+static void agent_pool_dispose(void* disp)
+{
+    agent_pool* pool = (agent_pool*)disp;
+
+    agent_pool_close(pool);
+    pthread_cond_destroy(&pool->idle);
+    pthread_mutex_destroy(&pool->lock);
+    free(pool->connections);
+    free(pool->address);
+
+    /* clear the pool. */
+    memset(pool, 0, sizeof(agent_pool));
+}
+
+/**
+ * \brief Close every connection and release its buffers.
+ *
+ * \param pool          The pool.
+ */
+static void agent_pool_close(agent_pool* pool)
+{
+    for (size_t i = 0; i < pool->count; ++i)
+    {
+        agent_pool_connection* conn = &pool->connections[i];
+
+        if (conn->sock >= 0)
+        {
+            close(conn->sock);
+        }
+
+        dispose((disposable_t*)&conn->response);
+        free(conn->request);
+    }
+}
@@ -0,0 +1,351 @@
+/**
+ * \file agent/agent_pool_request.c
+ *
+ * \brief Send a request over an agent pool.
+ *
+ * \copyright 2020 Velo Payments.  See License.txt for license terms.
+ */
+
+#include <cbmc/model_assert.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <vctool/agent.h>
+
+/* forward decls. */
+static agent_pool_connection* agent_pool_acquire(agent_pool* pool);
+static void agent_pool_release(
+    agent_pool* pool, agent_pool_connection* conn, bool failed,
+    uint64_t latency);
+static int agent_pool_reopen(agent_pool* pool, agent_pool_connection* conn);
+static int agent_pool_send(
+    agent_pool* pool, agent_pool_connection* conn, uint32_t type,
+    const void* payload, size_t size);
+static void agent_pool_reset(agent_pool_connection* conn);
+static uint64_t agent_pool_now(void);
+static void agent_write_u32(uint8_t* buf, uint32_t val);
+
+/**
+ * \brief Send a request over a pool and receive its response.
+ *
+ * Any number of threads may make requests at once; each waits for an idle
+ * connection.  A connection which fails is reopened by the next request to
+ * use it, but the failed request is not retried.
+ *
+ * \param pool          The pool.
+ * \param type          The request type.
+ * \param payload       The request payload.
+ * \param size          The size of the request payload.
+ * \param response      Function receiving the response.
+ * \param context       The user context passed to response.
+ *
+ * \returns a status code indicating success or failure.
+ *      - the status code returned by response on success.
+ *      - VCTOOL_ERROR_AGENT_DISCONNECTED if the agent closed the connection.
+ *      - VCTOOL_ERROR_AGENT_BAD_FRAME if the request was too large or the
+ *        response was malformed.
+ *      - a non-zero error code on failure.
+ */
+int agent_pool_request(
+    agent_pool* pool, uint32_t type, const void* payload, size_t size,
+    agent_response_fn response, void* context)
+{
+    int retval;
+
+    /* parameter sanity checks. */
+    MODEL_ASSERT(NULL != pool);
+    MODEL_ASSERT(0 == size || NULL != payload);
+    MODEL_ASSERT(NULL != response);
+
+    if (size > AGENT_MAX_PAYLOAD_SIZE)
+    {
+        return VCTOOL_ERROR_AGENT_BAD_FRAME;
+    }
+
+    agent_pool_connection* conn = agent_pool_acquire(pool);
+
+    /* a connection closed by an earlier failure is opened again. */
+    if (conn->sock < 0)
+    {
+        retval = agent_pool_reopen(pool, conn);
+        if (VCTOOL_STATUS_SUCCESS != retval)
+        {
+            agent_pool_release(pool, conn, true, 0);
+            return retval;
+        }
+    }
+
+    /* a frame which can't be recorded only leaves a gap in the recording. */
+    uint64_t exchange = 0;
+    if (NULL != pool->recorder)
+    {
+        exchange = agent_recorder_exchange(pool->recorder);
+        agent_recorder_write(
+            pool->recorder, exchange, AGENT_RECORD_REQUEST, type, payload,
+            size);
+    }
+
+    uint64_t start = agent_pool_now();
+
+    retval = agent_pool_send(pool, conn, type, payload, size);
+    if (VCTOOL_STATUS_SUCCESS != retval)
+    {
+        agent_pool_release(pool, conn, true, 0);
+        return retval;
+    }
+
+    retval = agent_frame_read(pool->f, conn->sock, &conn->response);
+    if (VCTOOL_STATUS_SUCCESS != retval)
+    {
+        agent_pool_release(pool, conn, true, 0);
+        return retval;
+    }
+
+    uint64_t latency = agent_pool_now() - start;
+
+    if (NULL != pool->recorder)
+    {
+        agent_recorder_write(
+            pool->recorder, exchange, AGENT_RECORD_RESPONSE,
+            conn->response.type, conn->response.payload,
+            conn->response.size);
+    }
+
+    /* the response buffer stays ours until the connection is released. */
+    retval = response(context, &conn->response);
+
+    agent_pool_release(pool, conn, false, latency);
+
+    return retval;
+}
+
+/**
+ * \brief Wait for an idle connection, and claim the one with the lowest
+ * recent latency.
+ *
+ * \param pool          The pool.
+ *
+ * \returns the claimed connection.
+ */
+static agent_pool_connection* agent_pool_acquire(agent_pool* pool)
+{
+    agent_pool_connection* best = NULL;
+
+    pthread_mutex_lock(&pool->lock);
+
+    for (;;)
+    {
+        for (size_t i = 0; i < pool->count; ++i)
+        {
+            agent_pool_connection* conn = &pool->connections[i];
+            if (!conn->busy
+             && (NULL == best || conn->latency < best->latency))
+            {
+                best = conn;
+            }
+        }
+
+        if (NULL != best)
+        {
+            break;
+        }
+
+        pthread_cond_wait(&pool->idle, &pool->lock);
+    }
+
+    best->busy = true;
+
+    pthread_mutex_unlock(&pool->lock);
+
+    return best;
+}
+
+/**
+ * \brief Return a connection to the pool.
+ *
+ * A failed connection is closed.  A connection which has become much slower
+ * than the fastest connection is closed too, so that the next request to use
+ * it opens a fresh one.
+ *
+ * \param pool          The pool.
+ * \param conn          The connection.
+ * \param failed        Whether the request failed on this connection.
+ * \param latency       The request latency, in nanoseconds.
+ */
+static void agent_pool_release(
+    agent_pool* pool, agent_pool_connection* conn, bool failed,
+    uint64_t latency)
+{
+    pthread_mutex_lock(&pool->lock);
+
+    if (failed)
+    {
+        agent_pool_reset(conn);
+    }
+    else
+    {
+        ++conn->requests;
+
+        /* fold this sample into the moving average. */
+        if (0 == conn->samples++)
+        {
+            conn->latency = latency;
+        }
+        else
+        {
+            conn->latency =
+                conn->latency - (conn->latency >> AGENT_POOL_EWMA_SHIFT)
+              + (latency >> AGENT_POOL_EWMA_SHIFT);
+        }
+
+        /* compare against the fastest other well-measured connection. */
+        uint64_t fastest = UINT64_MAX;
+        for (size_t i = 0; i < pool->count; ++i)
+        {
+            agent_pool_connection* other = &pool->connections[i];
+            if (other != conn && other->sock >= 0
+             && other->samples >= AGENT_POOL_MIN_SAMPLES
+             && other->latency < fastest)
+            {
+                fastest = other->latency;
+            }
+        }
+
+        if (conn->samples >= AGENT_POOL_MIN_SAMPLES
+         && UINT64_MAX != fastest
+         && conn->latency / AGENT_POOL_SLOW_FACTOR > fastest)
+        {
+            agent_pool_reset(conn);
+        }
+    }
+
+    conn->busy = false;
+    pthread_cond_signal(&pool->idle);
+
+    pthread_mutex_unlock(&pool->lock);
+}
+
+/**
+ * \brief Open a connection again, and run the handshake on it.
+ *
+ * \param pool          The pool.
+ * \param conn          The connection, which has no socket.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - a non-zero error code from agent_connect or the handshake.
+ */
+static int agent_pool_reopen(agent_pool* pool, agent_pool_connection* conn)
+{
+    int retval, sock;
+
+    retval = agent_connect(&sock, pool->address);
+    if (VCTOOL_STATUS_SUCCESS != retval)
+    {
+        return retval;
+    }
+
+    if (NULL != pool->handshake)
+    {
+        retval = pool->handshake(pool->handshake_context, pool->f, sock);
+        if (VCTOOL_STATUS_SUCCESS != retval)
+        {
+            close(sock);
+            return retval;
+        }
+    }
+
+    conn->sock = sock;
+    ++conn->reconnects;
+
+    return VCTOOL_STATUS_SUCCESS;
+}
+
+/**
+ * \brief Write a request frame from the connection's request buffer.
+ *
+ * \param pool          The pool.
+ * \param conn          The connection.
+ * \param type          The request type.
+ * \param payload       The request payload.
+ * \param size          The size of the request payload.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - VCTOOL_ERROR_GENERAL_OUT_OF_MEMORY if an allocation failed.
+ *      - a non-zero error code returned by the file layer.
+ */
+static int agent_pool_send(
+    agent_pool* pool, agent_pool_connection* conn, uint32_t type,
+    const void* payload, size_t size)
+{
+    size_t total = AGENT_FRAME_HEADER_SIZE + size;
+
+    /* grow the request buffer if needed. */
+    if (total > conn->request_capacity)
+    {
+        uint8_t* tmp = (uint8_t*)realloc(conn->request, total);
+        if (NULL == tmp)
+        {
+            return VCTOOL_ERROR_GENERAL_OUT_OF_MEMORY;
+        }
+
+        conn->request = tmp;
+        conn->request_capacity = total;
+    }
+
+    agent_write_u32(conn->request, type);
+    agent_write_u32(conn->request + 4, (uint32_t)size);
+    if (size > 0)
+    {
+        memcpy(conn->request + AGENT_FRAME_HEADER_SIZE, payload, size);
+    }
+
+    return file_write_all(pool->f, conn->sock, conn->request, total);
+}
+
+/**
+ * \brief Close a connection and forget its latency.
+ *
+ * \param conn          The connection.
+ */
+static void agent_pool_reset(agent_pool_connection* conn)
+{
+    if (conn->sock >= 0)
+    {
+        close(conn->sock);
+        conn->sock = -1;
+    }
+
+    conn->latency = 0;
+    conn->samples = 0;
+}
+
+/**
+ * \brief Read the monotonic clock.
+ *
+ * \returns the time in nanoseconds.
+ */
+static uint64_t agent_pool_now(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+/**
+ * \brief Write a big endian 32-bit value.
+ *
+ * \param buf           The buffer to which the value is written.
+ * \param val           The value to write.
+ */
+static void agent_write_u32(uint8_t* buf, uint32_t val)
+{
+    buf[0] = (uint8_t)(val >> 24);
+    buf[1] = (uint8_t)(val >> 16);
+    buf[2] = (uint8_t)(val >> 8);
+    buf[3] = (uint8_t)val;
+}
@@ -0,0 +1,26 @@
+/**
+ * \file agent/agent_recorder_exchange.c
+ *
+ * \brief Start a new recorded exchange.
+ *
+ * \copyright 2020 Velo Payments.  See License.txt for license terms.
+ */
+
+#include <cbmc/model_assert.h>
+#include <vctool/agent.h>
+
+/**
+ * \brief Start a new exchange.
+ *
+ * \param recorder      The recorder.
+ *
+ * \returns the id of the exchange.
+ */
+uint64_t agent_recorder_exchange(agent_recorder* recorder)
+{
+    /* parameter sanity checks. */
+    MODEL_ASSERT(NULL != recorder);
+
+    return
+        __atomic_fetch_add(&recorder->next_exchange, 1, __ATOMIC_RELAXED);
+}
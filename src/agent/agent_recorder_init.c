@@ -0,0 +1,99 @@
+/**
+ * \file agent/agent_recorder_init.c
+ *
+ * \brief Start a recording of agent traffic.
+ *
+ * \copyright 2020 Velo Payments.  See License.txt for license terms.
+ */
+
+#include <cbmc/model_assert.h>
+#include <fcntl.h>
+#include <string.h>
+#include <time.h>
+#include <vctool/agent.h>
+
+/* forward decls. */
+static void agent_recorder_dispose(void* disp);
+
+/**
+ * \brief Start a recording, replacing any file at path.
+ *
+ * \param recorder      The recorder to initialize.
+ * \param f             The file abstraction layer to use.
+ * \param path          The path of the recording.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - VCTOOL_ERROR_GENERAL_OUT_OF_MEMORY if an allocation failed.
+ *      - a non-zero error code returned by the file layer.
+ */
+int agent_recorder_init(agent_recorder* recorder, file* f, const char* path)
+{
+    int retval;
+    struct timespec ts;
+
+    /* parameter sanity checks. */
+    MODEL_ASSERT(NULL != recorder);
+    MODEL_ASSERT(PROP_FILE_VALID(f));
+    MODEL_ASSERT(NULL != path);
+
+    /* clear the recorder. */
+    memset(recorder, 0, sizeof(agent_recorder));
+    recorder->f = f;
+
+    /* recorded payloads may be sensitive, so only the owner may read them. */
+    retval =
+        file_open(
+            f, &recorder->fd, path, O_CREAT | O_TRUNC | O_WRONLY, 0600);
+    if (VCTOOL_STATUS_SUCCESS != retval)
+    {
+        goto clear_recorder;
+    }
+
+    retval =
+        file_write_all(
+            f, recorder->fd, AGENT_RECORD_MAGIC, AGENT_RECORD_MAGIC_SIZE);
+    if (VCTOOL_STATUS_SUCCESS != retval)
+    {
+        goto cleanup_fd;
+    }
+
+    if (0 != pthread_mutex_init(&recorder->lock, NULL))
+    {
+        retval = VCTOOL_ERROR_GENERAL_OUT_OF_MEMORY;
+        goto cleanup_fd;
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    recorder->start =
+        (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+
+    recorder->hdr.dispose = &agent_recorder_dispose;
+
+    /* success. */
+    return VCTOOL_STATUS_SUCCESS;
+
+cleanup_fd:
+    file_close(f, recorder->fd);
+
+clear_recorder:
+    memset(recorder, 0, sizeof(agent_recorder));
+
+    return retval;
+}
+
+/**
+ * \brief Dispose of a recorder, closing its recording.
+ *
+ * \param disp          The recorder to dispose.
+ */
+static void agent_recorder_dispose(void* disp)
+{
+    agent_recorder* recorder = (agent_recorder*)disp;
+
+    file_close(recorder->f, recorder->fd);
+    pthread_mutex_destroy(&recorder->lock);
+
+    /* clear the recorder. */
+    memset(recorder, 0, sizeof(agent_recorder));
+}
@@ -0,0 +1,95 @@
+/**
+ * \file agent/agent_recorder_write.c
+ *
+ * \brief Record a frame.
+ *
+ * \copyright 2020 Velo Payments.  See License.txt for license terms.
+ */
+
+#include <cbmc/model_assert.h>
+#include <time.h>
+#include <vctool/agent.h>
+
+/* forward decls. */
+static void agent_write_u64(uint8_t* buf, uint64_t val);
+static void agent_write_u32(uint8_t* buf, uint32_t val);
+
+/**
+ * \brief Record a frame, stamped with the time since recording started.
+ *
+ * \param recorder      The recorder.
+ * \param exchange      The exchange the frame belongs to.
+ * \param direction     AGENT_RECORD_REQUEST or AGENT_RECORD_RESPONSE.
+ * \param type          The message type.
+ * \param payload       The payload.
+ * \param size          The size of the payload.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - a non-zero error code returned by the file layer.
+ */
+int agent_recorder_write(
+    agent_recorder* recorder, uint64_t exchange, uint32_t direction,
+    uint32_t type, const void* payload, size_t size)
+{
+    int retval;
+    struct timespec ts;
+    uint8_t header[AGENT_RECORD_HEADER_SIZE];
+
+    /* parameter sanity checks. */
+    MODEL_ASSERT(NULL != recorder);
+    MODEL_ASSERT(0 == size || NULL != payload);
+    MODEL_ASSERT(size <= AGENT_MAX_PAYLOAD_SIZE);
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    uint64_t now = (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+
+    agent_write_u64(header, exchange);
+    agent_write_u64(header + 8, now - recorder->start);
+    agent_write_u32(header + 16, direction);
+    agent_write_u32(header + 20, type);
+    agent_write_u32(header + 24, (uint32_t)size);
+
+    /* records from concurrent exchanges must not interleave. */
+    pthread_mutex_lock(&recorder->lock);
+
+    retval =
+        file_write_all(recorder->f, recorder->fd, header, sizeof(header));
+    if (VCTOOL_STATUS_SUCCESS == retval && size > 0)
+    {
+        retval = file_write_all(recorder->f, recorder->fd, payload, size);
+    }
+
+    pthread_mutex_unlock(&recorder->lock);
+
+    return retval;
+}
+
+/**
+ * \brief Write a big endian 64-bit value.
+ *
+ * \param buf           The buffer to which the value is written.
+ * \param val           The value to write.
+ */
+static void agent_write_u64(uint8_t* buf, uint64_t val)
+{
+    for (int i = 7; i >= 0; --i)
+    {
+        buf[i] = (uint8_t)(val & 0xff);
+        val >>= 8;
+    }
+}
+
+/**
+ * \brief Write a big endian 32-bit value.
+ *
+ * \param buf           The buffer to which the value is written.
+ * \param val           The value to write.
+ */
+static void agent_write_u32(uint8_t* buf, uint32_t val)
+{
+    buf[0] = (uint8_t)((val >> 24) & 0xff);
+    buf[1] = (uint8_t)((val >> 16) & 0xff);
+    buf[2] = (uint8_t)((val >> 8) & 0xff);
+    buf[3] = (uint8_t)(val & 0xff);
+}
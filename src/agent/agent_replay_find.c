@@ -0,0 +1,74 @@
+/**
+ * \file agent/agent_replay_find.c
+ *
+ * \brief Find a recorded exchange for a request.
+ *
+ * \copyright 2020 Velo Payments.  See License.txt for license terms.
+ */
+
+#include <cbmc/model_assert.h>
+#include <string.h>
+#include <vctool/agent.h>
+
+/**
+ * \brief Find a recorded exchange for a request.
+ *
+ * When the same request was recorded several times, successive calls cycle
+ * through its exchanges in recorded order.
+ *
+ * \param replay        The replay.
+ * \param type          The request type.
+ * \param payload       The request payload.
+ * \param size          The size of the request payload.
+ *
+ * \returns the exchange, or NULL if the request was not recorded.
+ */
+const agent_replay_exchange* agent_replay_find(
+    agent_replay* replay, uint32_t type, const void* payload, size_t size)
+{
+    /* parameter sanity checks. */
+    MODEL_ASSERT(NULL != replay);
+    MODEL_ASSERT(0 == size || NULL != payload);
+
+    /* binary search over the sorted requests. */
+    size_t lo = 0, hi = replay->exchange_count;
+    while (lo < hi)
+    {
+        size_t mid = lo + (hi - lo) / 2;
+        agent_replay_exchange* exchange = &replay->exchanges[mid];
+
+        int cmp;
+        if (exchange->type != type)
+        {
+            cmp = (exchange->type < type) ? -1 : 1;
+        }
+        else if (exchange->size != size)
+        {
+            cmp = (exchange->size < size) ? -1 : 1;
+        }
+        else
+        {
+            cmp = memcmp(exchange->payload, payload, size);
+        }
+
+        if (cmp < 0)
+        {
+            lo = mid + 1;
+        }
+        else if (cmp > 0)
+        {
+            hi = mid;
+        }
+        else
+        {
+            /* take the group's exchanges in turn. */
+            agent_replay_exchange* group = exchange->group;
+            uint64_t turn =
+                __atomic_fetch_add(&group->cursor, 1, __ATOMIC_RELAXED);
+
+            return group + (turn % group->group_size);
+        }
+    }
+
+    return NULL;
+}
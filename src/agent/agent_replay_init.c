@@ -0,0 +1,420 @@
+/**
+ * \file agent/agent_replay_init.c
+ *
+ * \brief Load a recording of agent traffic for replay.
+ *
+ * \copyright 2020 Velo Payments.  See License.txt for license terms.
+ */
+
+#include <cbmc/model_assert.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vctool/agent.h>
+
+/**
+ * \brief A record, as found in the recording.
+ */
+typedef struct agent_replay_record
+{
+    uint64_t exchange;
+    uint64_t time;
+    uint32_t type;
+    uint32_t size;
+    const uint8_t* payload;
+} agent_replay_record;
+
+/* forward decls. */
+static void agent_replay_dispose(void* disp);
+static int agent_replay_index(agent_replay* replay);
+static int agent_replay_record_compare(const void* lhs, const void* rhs);
+static int agent_replay_exchange_compare(const void* lhs, const void* rhs);
+static uint64_t agent_read_u64(const uint8_t* buf);
+static uint32_t agent_read_u32(const uint8_t* buf);
+
+/**
+ * \brief Load a recording for replay.
+ *
+ * An exchange whose request was not recorded, for instance because the
+ * recording was cut short, is dropped.
+ *
+ * \param replay        The replay to initialize.
+ * \param f             The file abstraction layer to use.
+ * \param path          The path of the recording.
+ * \param latency_percent   Recorded latency is scaled by this percentage;
+ *                          100 replays the original timing, and 0 answers
+ *                          at once.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - VCTOOL_ERROR_AGENT_BAD_RECORDING if the recording is malformed.
+ *      - VCTOOL_ERROR_GENERAL_OUT_OF_MEMORY if an allocation failed.
+ *      - a non-zero error code returned by the file layer.
+ */
+int agent_replay_init(
+    agent_replay* replay, file* f, const char* path,
+    unsigned latency_percent)
+{
+    int retval, fd;
+    file_stat_st st;
+    void* map;
+
+    /* parameter sanity checks. */
+    MODEL_ASSERT(NULL != replay);
+    MODEL_ASSERT(PROP_FILE_VALID(f));
+    MODEL_ASSERT(NULL != path);
+
+    /* clear the replay. */
+    memset(replay, 0, sizeof(agent_replay));
+    replay->f = f;
+    replay->latency_percent = latency_percent;
+
+    retval = file_stat(f, path, &st);
+    if (VCTOOL_STATUS_SUCCESS != retval)
+    {
+        return retval;
+    }
+
+    if ((uint64_t)st.fst_size < AGENT_RECORD_MAGIC_SIZE)
+    {
+        return VCTOOL_ERROR_AGENT_BAD_RECORDING;
+    }
+
+    /* map the recording; the mapping outlives the descriptor. */
+    retval = file_open(f, &fd, path, O_RDONLY, 0);
+    if (VCTOOL_STATUS_SUCCESS != retval)
+    {
+        return retval;
+    }
+
+    retval = file_mmap(f, &map, fd, (size_t)st.fst_size);
+    file_close(f, fd);
+    if (VCTOOL_STATUS_SUCCESS != retval)
+    {
+        return retval;
+    }
+
+    replay->data = (uint8_t*)map;
+    replay->size = (size_t)st.fst_size;
+
+    if (memcmp(replay->data, AGENT_RECORD_MAGIC, AGENT_RECORD_MAGIC_SIZE))
+    {
+        retval = VCTOOL_ERROR_AGENT_BAD_RECORDING;
+        goto cleanup_map;
+    }
+
+    retval = agent_replay_index(replay);
+    if (VCTOOL_STATUS_SUCCESS != retval)
+    {
+        goto cleanup_map;
+    }
+
+    replay->hdr.dispose = &agent_replay_dispose;
+
+    /* success. */
+    return VCTOOL_STATUS_SUCCESS;
+
+cleanup_map:
+    file_munmap(f, map, replay->size);
+    memset(replay, 0, sizeof(agent_replay));
+
+    return retval;
+}
+
+/**
+ * \brief Dispose of a replay.
+ *
+ * \param disp          The replay to dispose.
+ */
+static void agent_replay_dispose(void* disp)
+{
+    agent_replay* replay = (agent_replay*)disp;
+
+    free(replay->exchanges);
+    free(replay->responses);
+    file_munmap(replay->f, replay->data, replay->size);
+
+    /* clear the replay. */
+    memset(replay, 0, sizeof(agent_replay));
+}
+
+/**
+ * \brief Build the exchanges and their responses from the records.
+ *
+ * \param replay        The replay, with its recording mapped.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - VCTOOL_ERROR_AGENT_BAD_RECORDING if the recording is malformed.
+ *      - VCTOOL_ERROR_GENERAL_OUT_OF_MEMORY if an allocation failed.
+ */
+static int agent_replay_index(agent_replay* replay)
+{
+    int retval;
+    size_t request_count = 0, response_count = 0;
+
+    /* count the records, checking that each is whole. */
+    size_t offset = AGENT_RECORD_MAGIC_SIZE;
+    while (offset < replay->size)
+    {
+        if (replay->size - offset < AGENT_RECORD_HEADER_SIZE)
+        {
+            return VCTOOL_ERROR_AGENT_BAD_RECORDING;
+        }
+
+        const uint8_t* header = replay->data + offset;
+        uint32_t direction = agent_read_u32(header + 16);
+        uint32_t size = agent_read_u32(header + 24);
+        offset += AGENT_RECORD_HEADER_SIZE;
+
+        if (size > replay->size - offset)
+        {
+            return VCTOOL_ERROR_AGENT_BAD_RECORDING;
+        }
+        offset += size;
+
+        if (AGENT_RECORD_REQUEST == direction)
+        {
+            ++request_count;
+        }
+        else if (AGENT_RECORD_RESPONSE == direction)
+        {
+            ++response_count;
+        }
+        else
+        {
+            return VCTOOL_ERROR_AGENT_BAD_RECORDING;
+        }
+    }
+
+    /* one allocation holds the requests, then the responses. */
+    agent_replay_record* records =
+        (agent_replay_record*)calloc(
+            request_count + response_count + 1, sizeof(agent_replay_record));
+    if (NULL == records)
+    {
+        return VCTOOL_ERROR_GENERAL_OUT_OF_MEMORY;
+    }
+
+    agent_replay_record* requests = records;
+    agent_replay_record* responses = records + request_count;
+    size_t r = 0, s = 0;
+
+    for (offset = AGENT_RECORD_MAGIC_SIZE; offset < replay->size; )
+    {
+        const uint8_t* header = replay->data + offset;
+        agent_replay_record* record =
+            (AGENT_RECORD_REQUEST == agent_read_u32(header + 16))
+                ? &requests[r++] : &responses[s++];
+
+        record->exchange = agent_read_u64(header);
+        record->time = agent_read_u64(header + 8);
+        record->type = agent_read_u32(header + 20);
+        record->size = agent_read_u32(header + 24);
+        record->payload = header + AGENT_RECORD_HEADER_SIZE;
+        offset += AGENT_RECORD_HEADER_SIZE + record->size;
+    }
+
+    /* group responses by exchange, keeping their recorded order. */
+    qsort(
+        requests, request_count, sizeof(agent_replay_record),
+        &agent_replay_record_compare);
+    qsort(
+        responses, response_count, sizeof(agent_replay_record),
+        &agent_replay_record_compare);
+
+    replay->exchanges =
+        (agent_replay_exchange*)calloc(
+            request_count + 1, sizeof(agent_replay_exchange));
+    if (NULL == replay->exchanges)
+    {
+        retval = VCTOOL_ERROR_GENERAL_OUT_OF_MEMORY;
+        goto cleanup_records;
+    }
+
+    replay->responses =
+        (agent_replay_response*)calloc(
+            response_count + 1, sizeof(agent_replay_response));
+    if (NULL == replay->responses)
+    {
+        retval = VCTOOL_ERROR_GENERAL_OUT_OF_MEMORY;
+        goto cleanup_exchanges;
+    }
+
+    /* pair each request with its responses; responses whose request is
+     * missing are dropped. */
+    size_t kept = 0;
+    s = 0;
+    for (r = 0; r < request_count; ++r)
+    {
+        const agent_replay_record* request = &requests[r];
+        agent_replay_exchange* exchange = &replay->exchanges[r];
+
+        if (r > 0 && requests[r - 1].exchange == request->exchange)
+        {
+            retval = VCTOOL_ERROR_AGENT_BAD_RECORDING;
+            goto cleanup_responses;
+        }
+
+        while (s < response_count
+            && responses[s].exchange < request->exchange)
+        {
+            ++s;
+        }
+
+        exchange->type = request->type;
+        exchange->size = request->size;
+        exchange->payload = request->payload;
+        exchange->responses = &replay->responses[kept];
+
+        for (; s < response_count
+            && responses[s].exchange == request->exchange; ++s)
+        {
+            agent_replay_response* response = &replay->responses[kept++];
+
+            response->delay =
+                (responses[s].time > request->time)
+                    ? responses[s].time - request->time : 0;
+            response->type = responses[s].type;
+            response->size = responses[s].size;
+            response->payload = responses[s].payload;
+            ++exchange->response_count;
+        }
+    }
+
+    replay->exchange_count = request_count;
+
+    /* sort the exchanges by request; identical requests stay in recorded
+     * order, and form a group which is replayed in turn. */
+    qsort(
+        replay->exchanges, replay->exchange_count,
+        sizeof(agent_replay_exchange), &agent_replay_exchange_compare);
+
+    for (size_t i = 0; i < replay->exchange_count; ++i)
+    {
+        agent_replay_exchange* exchange = &replay->exchanges[i];
+        agent_replay_exchange* prev = (i > 0) ? exchange - 1 : NULL;
+
+        if (NULL != prev
+         && prev->type == exchange->type && prev->size == exchange->size
+         && !memcmp(prev->payload, exchange->payload, exchange->size))
+        {
+            exchange->group = prev->group;
+        }
+        else
+        {
+            exchange->group = exchange;
+        }
+
+        ++exchange->group->group_size;
+    }
+
+    for (size_t i = 0; i < replay->exchange_count; ++i)
+    {
+        replay->exchanges[i].group_size =
+            replay->exchanges[i].group->group_size;
+    }
+
+    /* success. */
+    retval = VCTOOL_STATUS_SUCCESS;
+    goto cleanup_records;
+
+cleanup_responses:
+    free(replay->responses);
+    replay->responses = NULL;
+
+cleanup_exchanges:
+    free(replay->exchanges);
+    replay->exchanges = NULL;
+
+cleanup_records:
+    free(records);
+
+    return retval;
+}
+
+/**
+ * \brief Order records by exchange, then by position in the recording.
+ *
+ * \param lhs           The left record.
+ * \param rhs           The right record.
+ *
+ * \returns less than, equal to, or greater than zero.
+ */
+static int agent_replay_record_compare(const void* lhs, const void* rhs)
+{
+    const agent_replay_record* l = (const agent_replay_record*)lhs;
+    const agent_replay_record* r = (const agent_replay_record*)rhs;
+
+    if (l->exchange != r->exchange)
+    {
+        return (l->exchange < r->exchange) ? -1 : 1;
+    }
+
+    return (l->payload < r->payload) ? -1 : (l->payload > r->payload);
+}
+
+/**
+ * \brief Order exchanges by request, then by position in the recording.
+ *
+ * \param lhs           The left exchange.
+ * \param rhs           The right exchange.
+ *
+ * \returns less than, equal to, or greater than zero.
+ */
+static int agent_replay_exchange_compare(const void* lhs, const void* rhs)
+{
+    const agent_replay_exchange* l = (const agent_replay_exchange*)lhs;
+    const agent_replay_exchange* r = (const agent_replay_exchange*)rhs;
+
+    if (l->type != r->type)
+    {
+        return (l->type < r->type) ? -1 : 1;
+    }
+
+    if (l->size != r->size)
+    {
+        return (l->size < r->size) ? -1 : 1;
+    }
+
+    int cmp = memcmp(l->payload, r->payload, l->size);
+    if (0 != cmp)
+    {
+        return cmp;
+    }
+
+    return (l->payload < r->payload) ? -1 : (l->payload > r->payload);
+}
+
+/**
+ * \brief Read a big endian 64-bit value.
+ *
+ * \param buf           The buffer from which the value is read.
+ *
+ * \returns the value.
+ */
+static uint64_t agent_read_u64(const uint8_t* buf)
+{
+    uint64_t val = 0;
+
+    for (int i = 0; i < 8; ++i)
+    {
+        val = (val << 8) | buf[i];
+    }
+
+    return val;
+}
+
+/**
+ * \brief Read a big endian 32-bit value.
+ *
+ * \param buf           The buffer from which the value is read.
+ *
+ * \returns the value.
+ */
+static uint32_t agent_read_u32(const uint8_t* buf)
+{
+    return
+        ((uint32_t)buf[0] << 24) | ((uint32_t)buf[1] << 16)
+      | ((uint32_t)buf[2] << 8) | (uint32_t)buf[3];
+}
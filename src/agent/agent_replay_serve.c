@@ -0,0 +1,122 @@
+/**
+ * \file agent/agent_replay_serve.c
+ *
+ * \brief Answer requests on a connection from a recording.
+ *
+ * \copyright 2020 Velo Payments.  See License.txt for license terms.
+ */
+
+#include <cbmc/model_assert.h>
+#include <errno.h>
+#include <time.h>
+#include <vctool/agent.h>
+
+/* forward decls. */
+static void agent_replay_sleep_until(
+    const struct timespec* start, uint64_t delay);
+
+/**
+ * \brief Answer requests on a connection from the recording until the client
+ * closes it.
+ *
+ * Each response is sent when its scaled delay after the request has passed.
+ *
+ * \param replay        The replay.
+ * \param sock          The client connection.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS when the client closes the connection.
+ *      - VCTOOL_ERROR_AGENT_NOT_RECORDED if a request was not recorded.
+ *      - VCTOOL_ERROR_AGENT_BAD_FRAME if a request frame was malformed.
+ *      - a non-zero error code on failure.
+ */
+int agent_replay_serve(agent_replay* replay, int sock)
+{
+    int retval;
+    agent_frame request;
+    struct timespec start;
+
+    /* parameter sanity checks. */
+    MODEL_ASSERT(NULL != replay);
+
+    retval = agent_frame_init(&request);
+    if (VCTOOL_STATUS_SUCCESS != retval)
+    {
+        return retval;
+    }
+
+    for (;;)
+    {
+        retval = agent_frame_read(replay->f, sock, &request);
+        if (VCTOOL_ERROR_AGENT_DISCONNECTED == retval)
+        {
+            retval = VCTOOL_STATUS_SUCCESS;
+            break;
+        }
+        else if (VCTOOL_STATUS_SUCCESS != retval)
+        {
+            break;
+        }
+
+        /* delays are measured from when the request arrived. */
+        clock_gettime(CLOCK_MONOTONIC, &start);
+
+        const agent_replay_exchange* exchange =
+            agent_replay_find(
+                replay, request.type, request.payload, request.size);
+        if (NULL == exchange)
+        {
+            retval = VCTOOL_ERROR_AGENT_NOT_RECORDED;
+            break;
+        }
+
+        for (size_t i = 0; i < exchange->response_count; ++i)
+        {
+            const agent_replay_response* response = &exchange->responses[i];
+
+            agent_replay_sleep_until(
+                &start, response->delay / 100 * replay->latency_percent);
+
+            retval =
+                agent_frame_write(
+                    replay->f, sock, response->type, response->payload,
+                    response->size);
+            if (VCTOOL_STATUS_SUCCESS != retval)
+            {
+                goto cleanup_request;
+            }
+        }
+    }
+
+cleanup_request:
+    dispose((disposable_t*)&request);
+
+    return retval;
+}
+
+/**
+ * \brief Sleep until a delay has passed since a start time.
+ *
+ * \param start         The start time, on the monotonic clock.
+ * \param delay         The delay, in nanoseconds.
+ */
+static void agent_replay_sleep_until(
+    const struct timespec* start, uint64_t delay)
+{
+    struct timespec when;
+
+    if (0 == delay)
+    {
+        return;
+    }
+
+    uint64_t nsec = (uint64_t)start->tv_nsec + delay;
+    when.tv_sec = start->tv_sec + (time_t)(nsec / 1000000000ULL);
+    when.tv_nsec = (long)(nsec % 1000000000ULL);
+
+    /* a signal only interrupts the sleep. */
+    while (EINTR
+            == clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &when, NULL))
+    {
+    }
+}
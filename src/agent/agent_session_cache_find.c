@@ -0,0 +1,55 @@
+/**
+ * \file agent/agent_session_cache_find.c
+ *
+ * \brief Find an unexpired session for an agent.
+ *
+ * \copyright 2020 Velo Payments.  See License.txt for license terms.
+ */
+
+#include <cbmc/model_assert.h>
+#include <string.h>
+#include <time.h>
+#include <vctool/agent.h>
+
+/**
+ * \brief Find an unexpired session for an agent.
+ *
+ * \param cache         The cache.
+ * \param address       The agent address.
+ * \param session       Receives a copy of the session; the caller must wipe
+ *                      it when done.
+ *
+ * \returns true if a session was found.
+ */
+bool agent_session_cache_find(
+    agent_session_cache* cache, const char* address, agent_session* session)
+{
+    bool found = false;
+
+    /* parameter sanity checks. */
+    MODEL_ASSERT(NULL != cache);
+    MODEL_ASSERT(NULL != address);
+    MODEL_ASSERT(NULL != session);
+
+    uint64_t now = (uint64_t)time(NULL);
+
+    pthread_mutex_lock(&cache->lock);
+
+    for (size_t i = 0; i < AGENT_SESSION_CACHE_ENTRIES; ++i)
+    {
+        agent_session_entry* entry = &cache->entries[i];
+
+        if (0 != entry->address[0]
+         && entry->session.expires > now
+         && !strcmp(entry->address, address))
+        {
+            memcpy(session, &entry->session, sizeof(agent_session));
+            found = true;
+            break;
+        }
+    }
+
+    pthread_mutex_unlock(&cache->lock);
+
+    return found;
+}
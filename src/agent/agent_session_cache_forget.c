@@ -0,0 +1,39 @@
+/**
+ * \file agent/agent_session_cache_forget.c
+ *
+ * \brief Wipe the session cached for an agent.
+ *
+ * \copyright 2020 Velo Payments.  See License.txt for license terms.
+ */
+
+#include <cbmc/model_assert.h>
+#include <string.h>
+#include <vctool/agent.h>
+
+/**
+ * \brief Wipe the session cached for an agent.
+ *
+ * \param cache         The cache.
+ * \param address       The agent address.
+ */
+void agent_session_cache_forget(
+    agent_session_cache* cache, const char* address)
+{
+    /* parameter sanity checks. */
+    MODEL_ASSERT(NULL != cache);
+    MODEL_ASSERT(NULL != address);
+
+    pthread_mutex_lock(&cache->lock);
+
+    for (size_t i = 0; i < AGENT_SESSION_CACHE_ENTRIES; ++i)
+    {
+        agent_session_entry* entry = &cache->entries[i];
+
+        if (0 != entry->address[0] && !strcmp(entry->address, address))
+        {
+            explicit_bzero(entry, sizeof(agent_session_entry));
+        }
+    }
+
+    pthread_mutex_unlock(&cache->lock);
+}
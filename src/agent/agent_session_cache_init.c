@@ -0,0 +1,552 @@
+/**
+ * \file agent/agent_session_cache_init.c
+ *
+ * \brief Create a session cache in locked memory.
+ *
+ * \copyright 2020 Velo Payments.  See License.txt for license terms.
+ */
+
+#include <cbmc/model_assert.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <time.h>
+#include <unistd.h>
+#include <vccrypt/compare.h>
+#include <vctool/agent.h>
+#include <vctool/crypt.h>
+
+/* forward decls. */
+static void agent_session_cache_dispose(void* disp);
+static void agent_session_cache_key(agent_session_cache* cache);
+static void agent_session_cache_load(agent_session_cache* cache);
+static size_t agent_session_cache_unseal(
+    agent_session_cache* cache, const uint8_t* data, size_t size,
+    uint8_t* sessions);
+static void agent_session_cache_parse(
+    agent_session_cache* cache, const uint8_t* data, size_t size);
+static uint64_t agent_session_read_u64(const uint8_t* buf);
+static uint16_t agent_session_read_u16(const uint8_t* buf);
+
+/**
+ * \brief Create a session cache, loading saved sessions if a path is given.
+ *
+ * The seal key is read from path plus AGENT_SESSION_SEAL_KEY_SUFFIX.  A seal
+ * key which is missing, the wrong size, or readable by anyone but the owner
+ * is replaced with a new random key, which no saved cache matches.  A cache
+ * file which is missing, damaged, or sealed under another key leaves the
+ * cache empty, and expired sessions are not loaded.  The bytes read are
+ * wiped once they are parsed.
+ *
+ * \param cache         The cache to initialize.
+ * \param f             The file abstraction layer to use.
+ * \param suite         The crypto suite which seals saved sessions.
+ * \param path          The path the cache is loaded from and saved to, or
+ *                      NULL for a cache which is never saved.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - VCTOOL_ERROR_AGENT_SECURE_MEMORY if the entries could not be locked
+ *        in memory.
+ *      - VCTOOL_ERROR_GENERAL_OUT_OF_MEMORY if an allocation failed.
+ */
+int agent_session_cache_init(
+    agent_session_cache* cache, file* f, vccrypt_suite_options_t* suite,
+    const char* path)
+{
+    int retval;
+
+    /* parameter sanity checks. */
+    MODEL_ASSERT(NULL != cache);
+    MODEL_ASSERT(PROP_FILE_VALID(f));
+    MODEL_ASSERT(NULL != suite);
+
+    /* clear the cache. */
+    memset(cache, 0, sizeof(agent_session_cache));
+    cache->f = f;
+    cache->suite = suite;
+
+    /* round the entries and the seal key up to whole pages, which are locked
+     * as a unit. */
+    long page = sysconf(_SC_PAGESIZE);
+    size_t page_size = (page > 0) ? (size_t)page : 4096;
+    size_t entries_size =
+        AGENT_SESSION_CACHE_ENTRIES * sizeof(agent_session_entry);
+    size_t size = entries_size + AGENT_SESSION_SEAL_KEY_SIZE;
+    cache->mapped_size = ((size + page_size - 1) / page_size) * page_size;
+
+    /* anonymous memory starts out zeroed, so every entry is unused. */
+    void* map =
+        mmap(
+            NULL, cache->mapped_size, PROT_READ | PROT_WRITE,
+            MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (MAP_FAILED == map)
+    {
+        retval = VCTOOL_ERROR_GENERAL_OUT_OF_MEMORY;
+        goto clear_cache;
+    }
+
+    /* keep session keys out of swap and out of core dumps. */
+    if (0 != mlock(map, cache->mapped_size))
+    {
+        retval = VCTOOL_ERROR_AGENT_SECURE_MEMORY;
+        goto cleanup_map;
+    }
+
+    if (0 != madvise(map, cache->mapped_size, MADV_DONTDUMP))
+    {
+        retval = VCTOOL_ERROR_AGENT_SECURE_MEMORY;
+        goto cleanup_lock;
+    }
+
+    if (NULL != path)
+    {
+        cache->path = strdup(path);
+        if (NULL == cache->path)
+        {
+            retval = VCTOOL_ERROR_GENERAL_OUT_OF_MEMORY;
+            goto cleanup_lock;
+        }
+    }
+
+    if (0 != pthread_mutex_init(&cache->lock, NULL))
+    {
+        retval = VCTOOL_ERROR_GENERAL_OUT_OF_MEMORY;
+        goto free_path;
+    }
+
+    cache->entries = (agent_session_entry*)map;
+    cache->seal_key = (uint8_t*)map + entries_size;
+
+    if (NULL != path)
+    {
+        agent_session_cache_key(cache);
+    }
+
+    if (cache->sealed)
+    {
+        agent_session_cache_load(cache);
+    }
+
+    cache->hdr.dispose = &agent_session_cache_dispose;
+
+    /* success. */
+    return VCTOOL_STATUS_SUCCESS;
+
+free_path:
+    free(cache->path);
+
+cleanup_lock:
+    munlock(map, cache->mapped_size);
+
+cleanup_map:
+    munmap(map, cache->mapped_size);
+
+clear_cache:
+    memset(cache, 0, sizeof(agent_session_cache));
+
+    return retval;
+}
+
+/**
+ * \brief Dispose of a session cache, wiping its entries and its seal key.
+ *
+ * \param disp          The cache to dispose.
+ */
+static void agent_session_cache_dispose(void* disp)
+{
+    agent_session_cache* cache = (agent_session_cache*)disp;
+
+    explicit_bzero(cache->entries, cache->mapped_size);
+    munlock(cache->entries, cache->mapped_size);
+    munmap(cache->entries, cache->mapped_size);
+    pthread_mutex_destroy(&cache->lock);
+    free(cache->path);
+
+    /* clear the cache. */
+    memset(cache, 0, sizeof(agent_session_cache));
+}
+
+/**
+ * \brief Read the seal key of the cache path, or replace it with a new one.
+ *
+ * The cache is sealed if a key was read or written.  Otherwise, the cache
+ * works in memory only.
+ *
+ * \param cache         The cache, which has a path.
+ */
+static void agent_session_cache_key(agent_session_cache* cache)
+{
+    int retval, fd;
+    file_stat_st st;
+    size_t read_size;
+    vccrypt_prng_context_t prng;
+
+    size_t key_path_size =
+        strlen(cache->path) + sizeof(AGENT_SESSION_SEAL_KEY_SUFFIX);
+    char* key_path = (char*)malloc(key_path_size);
+    if (NULL == key_path)
+    {
+        return;
+    }
+
+    memcpy(key_path, cache->path, strlen(cache->path));
+    memcpy(
+        key_path + strlen(cache->path), AGENT_SESSION_SEAL_KEY_SUFFIX,
+        sizeof(AGENT_SESSION_SEAL_KEY_SUFFIX));
+
+    /* use the key on disk if only its owner can read it. */
+    mode_t bad_bits = S_ISUID | S_ISGID | S_ISVTX | S_IRWXG | S_IRWXO;
+    if (VCTOOL_STATUS_SUCCESS == file_stat(cache->f, key_path, &st)
+     && 0 == (st.fst_mode & bad_bits)
+     && AGENT_SESSION_SEAL_KEY_SIZE == (uint64_t)st.fst_size
+     && VCTOOL_STATUS_SUCCESS
+            == file_open(cache->f, &fd, key_path, O_RDONLY, 0))
+    {
+        retval =
+            file_read(
+                cache->f, fd, cache->seal_key, AGENT_SESSION_SEAL_KEY_SIZE,
+                &read_size);
+        file_close(cache->f, fd);
+        if (VCTOOL_STATUS_SUCCESS == retval
+         && AGENT_SESSION_SEAL_KEY_SIZE == read_size)
+        {
+            cache->sealed = true;
+            goto free_key_path;
+        }
+    }
+
+    /* otherwise, replace it; sessions sealed under the old key are lost. */
+    file_unlink(cache->f, key_path);
+
+    if (VCCRYPT_STATUS_SUCCESS != vccrypt_suite_prng_init(cache->suite, &prng))
+    {
+        goto free_key_path;
+    }
+
+    retval =
+        vccrypt_prng_read_c(
+            &prng, cache->seal_key, AGENT_SESSION_SEAL_KEY_SIZE);
+    dispose((disposable_t*)&prng);
+    if (VCCRYPT_STATUS_SUCCESS != retval)
+    {
+        goto wipe_key;
+    }
+
+    if (VCTOOL_STATUS_SUCCESS
+            != file_open(
+                    cache->f, &fd, key_path, O_CREAT | O_EXCL | O_WRONLY,
+                    0600))
+    {
+        goto wipe_key;
+    }
+
+    retval =
+        file_write_all(
+            cache->f, fd, cache->seal_key, AGENT_SESSION_SEAL_KEY_SIZE);
+    if (VCTOOL_STATUS_SUCCESS == retval)
+    {
+        retval = file_fsync(cache->f, fd);
+    }
+
+    file_close(cache->f, fd);
+    if (VCTOOL_STATUS_SUCCESS != retval)
+    {
+        file_unlink(cache->f, key_path);
+        goto wipe_key;
+    }
+
+    cache->sealed = true;
+    goto free_key_path;
+
+wipe_key:
+    explicit_bzero(cache->seal_key, AGENT_SESSION_SEAL_KEY_SIZE);
+
+free_key_path:
+    free(key_path);
+}
+
+/**
+ * \brief Load the sessions saved in the cache file.
+ *
+ * \param cache         The cache, which is empty and sealed.
+ */
+static void agent_session_cache_load(agent_session_cache* cache)
+{
+    int fd;
+    file_stat_st st;
+    size_t read_size;
+
+    /* a cache file which can't be read is the same as no cache file. */
+    if (VCTOOL_STATUS_SUCCESS != file_stat(cache->f, cache->path, &st)
+     || (uint64_t)st.fst_size < AGENT_SESSION_CACHE_MAGIC_SIZE)
+    {
+        return;
+    }
+
+    size_t size = (size_t)st.fst_size;
+    uint8_t* data = (uint8_t*)malloc(2 * size);
+    if (NULL == data)
+    {
+        return;
+    }
+
+    if (VCTOOL_STATUS_SUCCESS
+            != file_open(cache->f, &fd, cache->path, O_RDONLY, 0))
+    {
+        goto cleanup_data;
+    }
+
+    /* read a private copy, since a file mapping can't be wiped, and decrypt
+     * it into the second half of the buffer. */
+    int retval = file_read(cache->f, fd, data, size, &read_size);
+    file_close(cache->f, fd);
+    if (VCTOOL_STATUS_SUCCESS == retval && read_size == size)
+    {
+        uint8_t* sessions = data + size;
+        size_t sessions_size =
+            agent_session_cache_unseal(cache, data, size, sessions);
+        agent_session_cache_parse(cache, sessions, sessions_size);
+    }
+
+cleanup_data:
+    explicit_bzero(data, 2 * size);
+    free(data);
+}
+
+/**
+ * \brief Check the MAC of a cache file and decrypt its sessions.
+ *
+ * \param cache         The cache, which is sealed.
+ * \param data          The contents of the cache file.
+ * \param size          The size of the cache file.
+ * \param sessions      Receives the decrypted sessions; it must hold size
+ *                      bytes.
+ *
+ * \returns the size of the decrypted sessions, or zero if the file is
+ *          damaged or sealed under another key.
+ */
+static size_t agent_session_cache_unseal(
+    agent_session_cache* cache, const uint8_t* data, size_t size,
+    uint8_t* sessions)
+{
+    size_t sessions_size = 0;
+    vccrypt_buffer_t password, salt, mac_buffer;
+    vccrypt_stream_context_t cipher;
+    vccrypt_mac_context_t mac;
+    vccrypt_suite_options_t* suite = cache->suite;
+
+    size_t salt_size = suite->stream_cipher_opts.key_size;
+    size_t iv_size = suite->stream_cipher_opts.IV_size;
+    size_t mac_size = suite->mac_opts.mac_size;
+    size_t overhead =
+        AGENT_SESSION_CACHE_MAGIC_SIZE + salt_size + iv_size + mac_size;
+
+    if (size < overhead
+     || crypto_memcmp(
+            data, AGENT_SESSION_CACHE_MAGIC, AGENT_SESSION_CACHE_MAGIC_SIZE))
+    {
+        goto done;
+    }
+
+    if (VCCRYPT_STATUS_SUCCESS
+            != vccrypt_buffer_init(
+                    &password, suite->alloc_opts,
+                    AGENT_SESSION_SEAL_KEY_SIZE))
+    {
+        goto done;
+    }
+
+    memcpy(password.data, cache->seal_key, AGENT_SESSION_SEAL_KEY_SIZE);
+
+    if (VCCRYPT_STATUS_SUCCESS
+            != vccrypt_buffer_init(&salt, suite->alloc_opts, salt_size))
+    {
+        goto cleanup_password;
+    }
+
+    memcpy(salt.data, data + AGENT_SESSION_CACHE_MAGIC_SIZE, salt_size);
+
+    if (VCCRYPT_STATUS_SUCCESS
+            != vccrypt_suite_buffer_init_for_mac_authentication_code(
+                    suite, &mac_buffer, false))
+    {
+        goto cleanup_salt;
+    }
+
+    /* a key derivation round gives every saved file its own key. */
+    if (VCTOOL_STATUS_SUCCESS
+            != crypt_cipher_mac_init_from_password(
+                    &cipher, &mac, suite, &password, &salt,
+                    AGENT_SESSION_SEAL_ROUNDS))
+    {
+        goto cleanup_mac_buffer;
+    }
+
+    /* check the MAC before decrypting anything. */
+    if (VCCRYPT_STATUS_SUCCESS
+            != vccrypt_mac_digest(&mac, data, size - mac_size)
+     || VCCRYPT_STATUS_SUCCESS != vccrypt_mac_finalize(&mac, &mac_buffer)
+     || crypto_memcmp(data + size - mac_size, mac_buffer.data, mac_size))
+    {
+        goto cleanup_cipher_mac;
+    }
+
+    const uint8_t* sealed = data + AGENT_SESSION_CACHE_MAGIC_SIZE + salt_size;
+    size_t sealed_size = size - overhead;
+    size_t input_offset = 0;
+    size_t output_offset = 0;
+    if (VCCRYPT_STATUS_SUCCESS
+            != vccrypt_stream_start_decryption(&cipher, sealed, &input_offset)
+     || VCCRYPT_STATUS_SUCCESS
+            != vccrypt_stream_decrypt(
+                    &cipher, sealed + input_offset, sealed_size, sessions,
+                    &output_offset))
+    {
+        explicit_bzero(sessions, size);
+        goto cleanup_cipher_mac;
+    }
+
+    sessions_size = sealed_size;
+
+cleanup_cipher_mac:
+    dispose((disposable_t*)&cipher);
+    dispose((disposable_t*)&mac);
+
+cleanup_mac_buffer:
+    dispose((disposable_t*)&mac_buffer);
+
+cleanup_salt:
+    dispose((disposable_t*)&salt);
+
+cleanup_password:
+    explicit_bzero(password.data, password.size);
+    dispose((disposable_t*)&password);
+
+done:
+    return sessions_size;
+}
+
+/**
+ * \brief Copy the unexpired sessions from a cache file into the entries.
+ *
+ * Each session is saved as:
+ *
+ *      size    field
+ *      2       address size
+ *      ...     address
+ *      8       expiry, in seconds since the epoch
+ *      2       session key size
+ *      ...     session key
+ *      2       ticket size
+ *      ...     ticket
+ *
+ * Parsing stops at the first malformed session.
+ *
+ * \param cache         The cache, which is empty.
+ * \param data          The decrypted sessions.
+ * \param size          The size of the decrypted sessions.
+ */
+static void agent_session_cache_parse(
+    agent_session_cache* cache, const uint8_t* data, size_t size)
+{
+    uint64_t now = (uint64_t)time(NULL);
+    size_t offset = 0;
+    size_t count = 0;
+
+    while (offset < size && count < AGENT_SESSION_CACHE_ENTRIES)
+    {
+        agent_session_entry* entry = &cache->entries[count];
+
+        /* address. */
+        if (size - offset < 2)
+        {
+            break;
+        }
+        size_t address_size = agent_session_read_u16(data + offset);
+        offset += 2;
+        if (0 == address_size || address_size >= AGENT_SESSION_ADDRESS_MAX
+         || size - offset < address_size + 8)
+        {
+            break;
+        }
+        const uint8_t* address = data + offset;
+        offset += address_size;
+
+        /* expiry. */
+        uint64_t expires = agent_session_read_u64(data + offset);
+        offset += 8;
+
+        /* session key. */
+        if (size - offset < 2)
+        {
+            break;
+        }
+        size_t key_size = agent_session_read_u16(data + offset);
+        offset += 2;
+        if (key_size > AGENT_SESSION_KEY_MAX || size - offset < key_size + 2)
+        {
+            break;
+        }
+        const uint8_t* key = data + offset;
+        offset += key_size;
+
+        /* ticket. */
+        size_t ticket_size = agent_session_read_u16(data + offset);
+        offset += 2;
+        if (ticket_size > AGENT_SESSION_TICKET_MAX
+         || size - offset < ticket_size)
+        {
+            break;
+        }
+        const uint8_t* ticket = data + offset;
+        offset += ticket_size;
+
+        /* expired sessions are dropped. */
+        if (expires <= now)
+        {
+            continue;
+        }
+
+        memcpy(entry->address, address, address_size);
+        entry->address[address_size] = 0;
+        entry->session.expires = expires;
+        entry->session.key_size = key_size;
+        memcpy(entry->session.key, key, key_size);
+        entry->session.ticket_size = ticket_size;
+        memcpy(entry->session.ticket, ticket, ticket_size);
+        ++count;
+    }
+}
+
+/**
+ * \brief Read a big endian 64-bit value.
+ *
+ * \param buf           The buffer from which the value is read.
+ *
+ * \returns the value.
+ */
+static uint64_t agent_session_read_u64(const uint8_t* buf)
+{
+    uint64_t val = 0;
+
+    for (int i = 0; i < 8; ++i)
+    {
+        val = (val << 8) | buf[i];
+    }
+
+    return val;
+}
+
+/**
+ * \brief Read a big endian 16-bit value.
+ *
+ * \param buf           The buffer from which the value is read.
+ *
+ * \returns the value.
+ */
+static uint16_t agent_session_read_u16(const uint8_t* buf)
+{
+    return (uint16_t)((buf[0] << 8) | buf[1]);
+}
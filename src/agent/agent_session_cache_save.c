@@ -0,0 +1,361 @@
+/**
+ * \file agent/agent_session_cache_save.c
+ *
+ * \brief Save the unexpired sessions in a cache.
+ *
+ * \copyright 2020 Velo Payments.  See License.txt for license terms.
+ */
+
+#include <cbmc/model_assert.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <vctool/agent.h>
+#include <vctool/crypt.h>
+
+/* the largest saved size of one session. */
+#define AGENT_SESSION_SAVED_MAX \
+    (2 + AGENT_SESSION_ADDRESS_MAX + 8 + 2 + AGENT_SESSION_KEY_MAX + 2 \
+   + AGENT_SESSION_TICKET_MAX)
+
+/* distinguishes the temporary files of concurrent saves. */
+static unsigned agent_session_temp_serial = 0;
+
+/* forward decls. */
+static int agent_session_cache_seal(
+    agent_session_cache* cache, const uint8_t* sessions, size_t size,
+    uint8_t* sealed, size_t* sealed_size);
+static size_t agent_session_write_u64(uint8_t* buf, uint64_t val);
+static size_t agent_session_write_u16(uint8_t* buf, size_t val);
+
+/**
+ * \brief Save the unexpired sessions to the path of the cache, readable only
+ * by the owner.
+ *
+ * The sessions, keys included, are encrypted and MACed under a key derived
+ * from the seal key and a fresh salt, and the plaintext is wiped as soon as
+ * it is sealed.  The file is written next to the path, synced, and renamed
+ * into place, so a reader never sees a partial cache.
+ *
+ * \param cache         The cache.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - VCTOOL_ERROR_AGENT_NO_SEAL_KEY if the cache has no path, or no seal
+ *        key could be created for it.
+ *      - VCTOOL_ERROR_GENERAL_OUT_OF_MEMORY if an allocation failed.
+ *      - a non-zero error code returned by the file layer or the suite.
+ */
+int agent_session_cache_save(agent_session_cache* cache)
+{
+    int retval, fd;
+    size_t sealed_size;
+
+    /* parameter sanity checks. */
+    MODEL_ASSERT(NULL != cache);
+
+    /* session keys are only written sealed. */
+    if (!cache->sealed)
+    {
+        return VCTOOL_ERROR_AGENT_NO_SEAL_KEY;
+    }
+
+    size_t capacity = AGENT_SESSION_CACHE_ENTRIES * AGENT_SESSION_SAVED_MAX;
+    size_t sealed_capacity =
+        AGENT_SESSION_CACHE_MAGIC_SIZE
+      + cache->suite->stream_cipher_opts.key_size
+      + cache->suite->stream_cipher_opts.IV_size
+      + capacity
+      + cache->suite->mac_opts.mac_size;
+    uint8_t* buf = (uint8_t*)malloc(capacity + sealed_capacity);
+    if (NULL == buf)
+    {
+        return VCTOOL_ERROR_GENERAL_OUT_OF_MEMORY;
+    }
+
+    uint8_t* sealed = buf + capacity;
+
+    /* serialize the unexpired sessions. */
+    size_t size = 0;
+    uint64_t now = (uint64_t)time(NULL);
+
+    pthread_mutex_lock(&cache->lock);
+
+    for (size_t i = 0; i < AGENT_SESSION_CACHE_ENTRIES; ++i)
+    {
+        const agent_session_entry* entry = &cache->entries[i];
+        const agent_session* session = &entry->session;
+
+        if (0 == entry->address[0] || session->expires <= now)
+        {
+            continue;
+        }
+
+        size_t address_size = strlen(entry->address);
+        size += agent_session_write_u16(buf + size, address_size);
+        memcpy(buf + size, entry->address, address_size);
+        size += address_size;
+        size += agent_session_write_u64(buf + size, session->expires);
+        size += agent_session_write_u16(buf + size, session->key_size);
+        memcpy(buf + size, session->key, session->key_size);
+        size += session->key_size;
+        size += agent_session_write_u16(buf + size, session->ticket_size);
+        memcpy(buf + size, session->ticket, session->ticket_size);
+        size += session->ticket_size;
+    }
+
+    pthread_mutex_unlock(&cache->lock);
+
+    /* seal the sessions, and wipe the plaintext at once. */
+    retval = agent_session_cache_seal(cache, buf, size, sealed, &sealed_size);
+    explicit_bzero(buf, size);
+    if (VCTOOL_STATUS_SUCCESS != retval)
+    {
+        goto cleanup_buf;
+    }
+
+    /* build a temporary name next to the file. */
+    unsigned serial =
+        __atomic_fetch_add(&agent_session_temp_serial, 1, __ATOMIC_RELAXED);
+    size_t temp_size = strlen(cache->path) + 64;
+    char* temp = (char*)malloc(temp_size);
+    if (NULL == temp)
+    {
+        retval = VCTOOL_ERROR_GENERAL_OUT_OF_MEMORY;
+        goto cleanup_buf;
+    }
+
+    snprintf(
+        temp, temp_size, "%s.%ld-%u.tmp", cache->path, (long)getpid(),
+        serial);
+
+    retval =
+        file_open(cache->f, &fd, temp, O_CREAT | O_EXCL | O_WRONLY, 0600);
+    if (VCTOOL_STATUS_SUCCESS != retval)
+    {
+        goto cleanup_temp;
+    }
+
+    /* the contents must be on disk before the rename makes them the cache. */
+    retval = file_write_all(cache->f, fd, sealed, sealed_size);
+    if (VCTOOL_STATUS_SUCCESS == retval)
+    {
+        retval = file_fsync(cache->f, fd);
+    }
+
+    file_close(cache->f, fd);
+    if (VCTOOL_STATUS_SUCCESS != retval)
+    {
+        goto unlink_temp;
+    }
+
+    /* move the complete file into place. */
+    retval = file_rename(cache->f, temp, cache->path);
+    if (VCTOOL_STATUS_SUCCESS != retval)
+    {
+        goto unlink_temp;
+    }
+
+    /* success. */
+    goto cleanup_temp;
+
+unlink_temp:
+    file_unlink(cache->f, temp);
+
+cleanup_temp:
+    free(temp);
+
+cleanup_buf:
+    free(buf);
+
+    return retval;
+}
+
+/**
+ * \brief Encrypt and MAC the serialized sessions under the seal key.
+ *
+ * \param cache         The cache, which is sealed.
+ * \param sessions      The serialized sessions.
+ * \param size          The size of the serialized sessions.
+ * \param sealed        Receives the contents of the cache file.
+ * \param sealed_size   Set to the size of the contents of the cache file.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - a non-zero error code returned by the suite.
+ */
+static int agent_session_cache_seal(
+    agent_session_cache* cache, const uint8_t* sessions, size_t size,
+    uint8_t* sealed, size_t* sealed_size)
+{
+    int retval;
+    vccrypt_buffer_t password, salt, iv, mac_buffer;
+    vccrypt_prng_context_t prng;
+    vccrypt_stream_context_t cipher;
+    vccrypt_mac_context_t mac;
+    vccrypt_suite_options_t* suite = cache->suite;
+
+    retval =
+        vccrypt_buffer_init(
+            &password, suite->alloc_opts, AGENT_SESSION_SEAL_KEY_SIZE);
+    if (VCCRYPT_STATUS_SUCCESS != retval)
+    {
+        goto done;
+    }
+
+    memcpy(password.data, cache->seal_key, AGENT_SESSION_SEAL_KEY_SIZE);
+
+    retval =
+        vccrypt_buffer_init(
+            &salt, suite->alloc_opts, suite->stream_cipher_opts.key_size);
+    if (VCCRYPT_STATUS_SUCCESS != retval)
+    {
+        goto cleanup_password;
+    }
+
+    retval =
+        vccrypt_buffer_init(
+            &iv, suite->alloc_opts, suite->stream_cipher_opts.IV_size);
+    if (VCCRYPT_STATUS_SUCCESS != retval)
+    {
+        goto cleanup_salt;
+    }
+
+    retval =
+        vccrypt_suite_buffer_init_for_mac_authentication_code(
+            suite, &mac_buffer, false);
+    if (VCCRYPT_STATUS_SUCCESS != retval)
+    {
+        goto cleanup_iv;
+    }
+
+    /* a fresh salt gives every saved file its own key. */
+    retval = vccrypt_suite_prng_init(suite, &prng);
+    if (VCCRYPT_STATUS_SUCCESS != retval)
+    {
+        goto cleanup_mac_buffer;
+    }
+
+    retval = vccrypt_prng_read(&prng, &salt, salt.size);
+    if (VCCRYPT_STATUS_SUCCESS == retval)
+    {
+        retval = vccrypt_prng_read(&prng, &iv, iv.size);
+    }
+
+    dispose((disposable_t*)&prng);
+    if (VCCRYPT_STATUS_SUCCESS != retval)
+    {
+        goto cleanup_mac_buffer;
+    }
+
+    retval =
+        crypt_cipher_mac_init_from_password(
+            &cipher, &mac, suite, &password, &salt,
+            AGENT_SESSION_SEAL_ROUNDS);
+    if (VCTOOL_STATUS_SUCCESS != retval)
+    {
+        goto cleanup_mac_buffer;
+    }
+
+    /* magic, salt, then the IV and the encrypted sessions. */
+    memcpy(sealed, AGENT_SESSION_CACHE_MAGIC, AGENT_SESSION_CACHE_MAGIC_SIZE);
+    size_t offset = AGENT_SESSION_CACHE_MAGIC_SIZE;
+    memcpy(sealed + offset, salt.data, salt.size);
+    offset += salt.size;
+
+    size_t stream_offset = 0;
+    retval =
+        vccrypt_stream_start_encryption(
+            &cipher, iv.data, iv.size, sealed + offset, &stream_offset);
+    if (VCCRYPT_STATUS_SUCCESS != retval)
+    {
+        goto cleanup_cipher_mac;
+    }
+
+    retval =
+        vccrypt_stream_encrypt(
+            &cipher, sessions, size, sealed + offset, &stream_offset);
+    if (VCCRYPT_STATUS_SUCCESS != retval)
+    {
+        goto cleanup_cipher_mac;
+    }
+
+    offset += stream_offset;
+
+    /* the MAC covers everything before it. */
+    retval = vccrypt_mac_digest(&mac, sealed, offset);
+    if (VCCRYPT_STATUS_SUCCESS != retval)
+    {
+        goto cleanup_cipher_mac;
+    }
+
+    retval = vccrypt_mac_finalize(&mac, &mac_buffer);
+    if (VCCRYPT_STATUS_SUCCESS != retval)
+    {
+        goto cleanup_cipher_mac;
+    }
+
+    memcpy(sealed + offset, mac_buffer.data, mac_buffer.size);
+    *sealed_size = offset + mac_buffer.size;
+
+    /* success. */
+    retval = VCTOOL_STATUS_SUCCESS;
+
+cleanup_cipher_mac:
+    dispose((disposable_t*)&cipher);
+    dispose((disposable_t*)&mac);
+
+cleanup_mac_buffer:
+    dispose((disposable_t*)&mac_buffer);
+
+cleanup_iv:
+    dispose((disposable_t*)&iv);
+
+cleanup_salt:
+    dispose((disposable_t*)&salt);
+
+cleanup_password:
+    explicit_bzero(password.data, password.size);
+    dispose((disposable_t*)&password);
+
+done:
+    return retval;
+}
+
+/**
+ * \brief Write a big endian 64-bit value.
+ *
+ * \param buf           The buffer to which the value is written.
+ * \param val           The value to write.
+ *
+ * \returns the number of bytes written.
+ */
+static size_t agent_session_write_u64(uint8_t* buf, uint64_t val)
+{
+    for (int i = 7; i >= 0; --i)
+    {
+        buf[i] = (uint8_t)(val & 0xFF);
+        val >>= 8;
+    }
+
+    return 8;
+}
+
+/**
+ * \brief Write a big endian 16-bit value.
+ *
+ * \param buf           The buffer to which the value is written.
+ * \param val           The value to write, which fits in 16 bits.
+ *
+ * \returns the number of bytes written.
+ */
+static size_t agent_session_write_u16(uint8_t* buf, size_t val)
+{
+    buf[0] = (uint8_t)((val >> 8) & 0xFF);
+    buf[1] = (uint8_t)(val & 0xFF);
+
+    return 2;
+}
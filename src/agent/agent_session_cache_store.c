@@ -0,0 +1,75 @@
+/**
+ * \file agent/agent_session_cache_store.c
+ *
+ * \brief Cache a session for an agent.
+ *
+ * \copyright 2020 Velo Payments.  See License.txt for license terms.
+ */
+
+#include <cbmc/model_assert.h>
+#include <string.h>
+#include <vctool/agent.h>
+
+/**
+ * \brief Cache a session for an agent, replacing any older one.
+ *
+ * When the cache is full, the session which expires first is evicted.
+ *
+ * \param cache         The cache.
+ * \param address       The agent address.
+ * \param session       The session.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - VCTOOL_ERROR_AGENT_BAD_SESSION if the address, key, or ticket is
+ *        too large.
+ */
+int agent_session_cache_store(
+    agent_session_cache* cache, const char* address,
+    const agent_session* session)
+{
+    /* parameter sanity checks. */
+    MODEL_ASSERT(NULL != cache);
+    MODEL_ASSERT(NULL != address);
+    MODEL_ASSERT(NULL != session);
+
+    size_t address_size = strlen(address);
+    if (0 == address_size || address_size >= AGENT_SESSION_ADDRESS_MAX
+     || session->key_size > AGENT_SESSION_KEY_MAX
+     || session->ticket_size > AGENT_SESSION_TICKET_MAX)
+    {
+        return VCTOOL_ERROR_AGENT_BAD_SESSION;
+    }
+
+    pthread_mutex_lock(&cache->lock);
+
+    /* prefer the entry for this agent, then an unused entry, then the entry
+     * which expires first. */
+    agent_session_entry* slot = NULL;
+    for (size_t i = 0; i < AGENT_SESSION_CACHE_ENTRIES; ++i)
+    {
+        agent_session_entry* entry = &cache->entries[i];
+
+        if (!strcmp(entry->address, address))
+        {
+            slot = entry;
+            break;
+        }
+
+        if (NULL == slot
+         || (0 != slot->address[0]
+          && (0 == entry->address[0]
+           || entry->session.expires < slot->session.expires)))
+        {
+            slot = entry;
+        }
+    }
+
+    explicit_bzero(slot, sizeof(agent_session_entry));
+    memcpy(slot->address, address, address_size);
+    memcpy(&slot->session, session, sizeof(agent_session));
+
+    pthread_mutex_unlock(&cache->lock);
+
+    return VCTOOL_STATUS_SUCCESS;
+}
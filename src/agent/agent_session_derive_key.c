@@ -0,0 +1,114 @@
+/**
+ * \file agent/agent_session_derive_key.c
+ *
+ * \brief Derive the key of a session from its nonces.
+ *
+ * \copyright 2020 Velo Payments.  See License.txt for license terms.
+ */
+
+#include <cbmc/model_assert.h>
+#include <string.h>
+#include <vctool/agent.h>
+
+/**
+ * \brief Derive the key of a session from its nonces.
+ *
+ * agent_key_agree derives the session key with this once the agent's nonce
+ * arrives; the agent derives the same key with its own keys.
+ *
+ * \param context       The agent_key_agreement.
+ * \param session       The session, whose key is set.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - VCTOOL_ERROR_AGENT_BAD_SESSION if the suite's nonces or keys don't
+ *        fit a session.
+ *      - a non-zero error code on failure.
+ */
+int agent_session_derive_key(void* context, agent_session* session)
+{
+    int retval;
+    vccrypt_key_agreement_context_t agreement;
+    vccrypt_buffer_t client_nonce, agent_nonce, shared;
+    agent_key_agreement* keys = (agent_key_agreement*)context;
+
+    /* parameter sanity checks. */
+    MODEL_ASSERT(NULL != keys);
+    MODEL_ASSERT(NULL != keys->suite);
+    MODEL_ASSERT(NULL != keys->client_private_key);
+    MODEL_ASSERT(NULL != keys->agent_public_key);
+    MODEL_ASSERT(NULL != session);
+
+    retval = vccrypt_suite_cipher_key_agreement_init(keys->suite, &agreement);
+    if (VCCRYPT_STATUS_SUCCESS != retval)
+    {
+        goto done;
+    }
+
+    retval =
+        vccrypt_suite_buffer_init_for_cipher_key_agreement_nonce(
+            keys->suite, &client_nonce);
+    if (VCCRYPT_STATUS_SUCCESS != retval)
+    {
+        goto cleanup_agreement;
+    }
+
+    retval =
+        vccrypt_suite_buffer_init_for_cipher_key_agreement_nonce(
+            keys->suite, &agent_nonce);
+    if (VCCRYPT_STATUS_SUCCESS != retval)
+    {
+        goto cleanup_client_nonce;
+    }
+
+    retval =
+        vccrypt_suite_buffer_init_for_cipher_key_agreement_shared_secret(
+            keys->suite, &shared);
+    if (VCCRYPT_STATUS_SUCCESS != retval)
+    {
+        goto cleanup_agent_nonce;
+    }
+
+    /* the session must hold the suite's nonces and its secret. */
+    if (AGENT_SESSION_NONCE_SIZE != client_nonce.size
+     || AGENT_SESSION_NONCE_SIZE != agent_nonce.size
+     || shared.size > AGENT_SESSION_KEY_MAX)
+    {
+        retval = VCTOOL_ERROR_AGENT_BAD_SESSION;
+        goto cleanup_shared;
+    }
+
+    memcpy(client_nonce.data, session->client_nonce, client_nonce.size);
+    memcpy(agent_nonce.data, session->agent_nonce, agent_nonce.size);
+
+    retval =
+        vccrypt_key_agreement_short_term_secret_create(
+            &agreement, keys->client_private_key, keys->agent_public_key,
+            &agent_nonce, &client_nonce, &shared);
+    if (VCCRYPT_STATUS_SUCCESS != retval)
+    {
+        goto cleanup_shared;
+    }
+
+    memcpy(session->key, shared.data, shared.size);
+    session->key_size = shared.size;
+
+    /* success. */
+    retval = VCTOOL_STATUS_SUCCESS;
+
+cleanup_shared:
+    explicit_bzero(shared.data, shared.size);
+    dispose((disposable_t*)&shared);
+
+cleanup_agent_nonce:
+    dispose((disposable_t*)&agent_nonce);
+
+cleanup_client_nonce:
+    dispose((disposable_t*)&client_nonce);
+
+cleanup_agreement:
+    dispose((disposable_t*)&agreement);
+
+done:
+    return retval;
+}
@@ -0,0 +1,414 @@
+/**
+ * \file agent/agent_session_handshake.c
+ *
+ * \brief Resume a cached session, or agree on a new one.
+ *
+ * \copyright 2020 Velo Payments.  See License.txt for license terms.
+ */
+
+#include <cbmc/model_assert.h>
+#include <string.h>
+#include <vccrypt/compare.h>
+#include <vctool/agent.h>
+
+/* the key under which key agreements with an address are coalesced. */
+#define AGENT_SESSION_FLIGHT_PREFIX                     "agree:"
+#define AGENT_SESSION_FLIGHT_KEY_MAX                    256
+
+/**
+ * \brief A key agreement to run as a single-flight computation.
+ */
+typedef struct agent_session_flight
+{
+    agent_session_resumer* resumer;
+    file* f;
+    int sock;
+} agent_session_flight;
+
+/* forward decls. */
+static int agent_session_coalesce(
+    agent_session_resumer* resumer, file* f, int sock,
+    agent_session* session);
+static int agent_session_flight_agree(void* context, void* result);
+static int agent_session_agree(
+    agent_session_resumer* resumer, file* f, int sock,
+    agent_session* session);
+static int agent_session_resume(
+    agent_session_resumer* resumer, file* f, int sock,
+    const agent_session* session);
+static int agent_session_proof(
+    vccrypt_suite_options_t* suite, const agent_session* session,
+    const uint8_t* client_nonce, const uint8_t* server_nonce,
+    vccrypt_buffer_t* proof);
+static void agent_session_count(
+    agent_session_resumer* resumer, uint64_t* counter);
+
+/**
+ * \brief Handshake which resumes a cached session, or runs the full key
+ * agreement and caches the new session.
+ *
+ * This is an agent_handshake_fn, so it can be given to agent_pool_init.  A
+ * session the agent rejects is forgotten, and the full key agreement runs on
+ * the same connection.
+ *
+ * If the resumer has a single-flight group, connections which need a key
+ * agreement with the same address at the same time share one: the first
+ * runs it, and the rest resume the session it agreed.
+ *
+ * \param context       The agent_session_resumer.
+ * \param f             The file abstraction layer.
+ * \param sock          The new connection.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - VCTOOL_ERROR_AGENT_RESUME_FAILED if the agent accepted the ticket
+ *        but could not prove that it holds the session key.
+ *      - VCTOOL_ERROR_AGENT_UNEXPECTED_MESSAGE if the agent answered the
+ *        resumption with something else.
+ *      - a non-zero error code from the key agreement or on failure.
+ */
+int agent_session_handshake(void* context, file* f, int sock)
+{
+    int retval;
+    agent_session session;
+    agent_session_resumer* resumer = (agent_session_resumer*)context;
+
+    /* parameter sanity checks. */
+    MODEL_ASSERT(NULL != resumer);
+    MODEL_ASSERT(NULL != resumer->cache);
+    MODEL_ASSERT(NULL != resumer->address);
+    MODEL_ASSERT(NULL != resumer->key_agreement);
+    MODEL_ASSERT(PROP_FILE_VALID(f));
+
+    /* a warm session costs one round trip and a MAC. */
+    if (agent_session_cache_find(resumer->cache, resumer->address, &session))
+    {
+        retval = agent_session_resume(resumer, f, sock, &session);
+
+        /* a ticket the agent no longer honors is forgotten, as is the
+         * session of an agent which can't prove it holds the key. */
+        if (VCTOOL_ERROR_AGENT_BAD_SESSION == retval
+         || VCTOOL_ERROR_AGENT_RESUME_FAILED == retval)
+        {
+            agent_session_cache_forget(resumer->cache, resumer->address);
+        }
+
+        /* only a rejected ticket falls back to the full key agreement. */
+        if (VCTOOL_ERROR_AGENT_BAD_SESSION != retval)
+        {
+            goto wipe_session;
+        }
+    }
+
+    /* otherwise, run the full key agreement and cache its session. */
+    explicit_bzero(&session, sizeof(session));
+    if (NULL != resumer->flights)
+    {
+        retval = agent_session_coalesce(resumer, f, sock, &session);
+    }
+    else
+    {
+        retval = agent_session_agree(resumer, f, sock, &session);
+    }
+
+wipe_session:
+    explicit_bzero(&session, sizeof(session));
+
+    return retval;
+}
+
+/**
+ * \brief Run the key agreement, or share the one in flight to the same
+ * address.
+ *
+ * \param resumer       The handshake state.
+ * \param f             The file abstraction layer.
+ * \param sock          The connection.
+ * \param session       The session receiving the agreed or shared key.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - a non-zero error code from the key agreement or on failure.
+ */
+static int agent_session_coalesce(
+    agent_session_resumer* resumer, file* f, int sock,
+    agent_session* session)
+{
+    int retval;
+    bool shared;
+    char key[AGENT_SESSION_FLIGHT_KEY_MAX];
+    agent_session_flight flight = { resumer, f, sock };
+
+    /* an address too long to be a key just isn't coalesced. */
+    size_t prefix_size = sizeof(AGENT_SESSION_FLIGHT_PREFIX) - 1;
+    size_t address_size = strlen(resumer->address);
+    if (prefix_size + address_size > sizeof(key))
+    {
+        return agent_session_agree(resumer, f, sock, session);
+    }
+
+    memcpy(key, AGENT_SESSION_FLIGHT_PREFIX, prefix_size);
+    memcpy(key + prefix_size, resumer->address, address_size);
+
+    retval =
+        singleflight_do(
+            resumer->flights, key, prefix_size + address_size,
+            &agent_session_flight_agree, &flight, session, &shared);
+    if (!shared)
+    {
+        return retval;
+    }
+
+    /* a follower resumes the leader's session on its own connection. */
+    if (VCTOOL_STATUS_SUCCESS == retval)
+    {
+        retval = agent_session_resume(resumer, f, sock, session);
+        if (VCTOOL_ERROR_AGENT_BAD_SESSION != retval)
+        {
+            return retval;
+        }
+    }
+
+    /* if the leader failed, or its session was rejected, agree alone. */
+    explicit_bzero(session, sizeof(agent_session));
+
+    return agent_session_agree(resumer, f, sock, session);
+}
+
+/**
+ * \brief Run the key agreement as a single-flight computation.
+ *
+ * \param context       The agent_session_flight.
+ * \param result        The agent_session receiving the agreed key.
+ *
+ * \returns a status code indicating success or failure.
+ */
+static int agent_session_flight_agree(void* context, void* result)
+{
+    agent_session_flight* flight = (agent_session_flight*)context;
+
+    return
+        agent_session_agree(
+            flight->resumer, flight->f, flight->sock,
+            (agent_session*)result);
+}
+
+/**
+ * \brief Run the full key agreement and cache its session.
+ *
+ * \param resumer       The handshake state.
+ * \param f             The file abstraction layer.
+ * \param sock          The connection.
+ * \param session       The session receiving the agreed key.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - a non-zero error code from the key agreement or on failure.
+ */
+static int agent_session_agree(
+    agent_session_resumer* resumer, file* f, int sock,
+    agent_session* session)
+{
+    int retval;
+
+    retval =
+        resumer->key_agreement(
+            resumer->key_agreement_context, f, sock, session);
+    if (VCTOOL_STATUS_SUCCESS != retval)
+    {
+        return retval;
+    }
+
+    agent_session_count(resumer, &resumer->full_handshakes);
+
+    return agent_session_cache_store(resumer->cache, resumer->address, session);
+}
+
+/**
+ * \brief Resume a session.
+ *
+ * \param resumer       The handshake state.
+ * \param f             The file abstraction layer.
+ * \param sock          The connection.
+ * \param session       The cached session.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS if the session was resumed.
+ *      - VCTOOL_ERROR_AGENT_BAD_SESSION if the agent rejected the ticket, so
+ *        the full key agreement should run.
+ *      - VCTOOL_ERROR_AGENT_RESUME_FAILED if the agent's proof was wrong.
+ *      - a non-zero error code on failure.
+ */
+static int agent_session_resume(
+    agent_session_resumer* resumer, file* f, int sock,
+    const agent_session* session)
+{
+    int retval;
+    vccrypt_prng_context_t prng;
+    vccrypt_buffer_t proof;
+    agent_frame response;
+    uint8_t request[AGENT_SESSION_NONCE_SIZE + AGENT_SESSION_TICKET_MAX];
+
+    /* the client nonce makes every resumption proof fresh. */
+    retval = vccrypt_suite_prng_init(resumer->suite, &prng);
+    if (VCCRYPT_STATUS_SUCCESS != retval)
+    {
+        goto done;
+    }
+
+    retval = vccrypt_prng_read_c(&prng, request, AGENT_SESSION_NONCE_SIZE);
+    dispose((disposable_t*)&prng);
+    if (VCCRYPT_STATUS_SUCCESS != retval)
+    {
+        goto done;
+    }
+
+    memcpy(
+        request + AGENT_SESSION_NONCE_SIZE, session->ticket,
+        session->ticket_size);
+
+    retval =
+        agent_frame_write(
+            f, sock, AGENT_MSG_RESUME, request,
+            AGENT_SESSION_NONCE_SIZE + session->ticket_size);
+    if (VCTOOL_STATUS_SUCCESS != retval)
+    {
+        goto done;
+    }
+
+    agent_frame_init(&response);
+
+    retval = agent_frame_read(f, sock, &response);
+    if (VCTOOL_STATUS_SUCCESS != retval)
+    {
+        goto cleanup_response;
+    }
+
+    if (AGENT_MSG_RESUME_REJECTED == response.type)
+    {
+        retval = VCTOOL_ERROR_AGENT_BAD_SESSION;
+        goto cleanup_response;
+    }
+    else if (AGENT_MSG_RESUMED != response.type)
+    {
+        retval = VCTOOL_ERROR_AGENT_UNEXPECTED_MESSAGE;
+        goto cleanup_response;
+    }
+
+    retval =
+        vccrypt_suite_buffer_init_for_mac_authentication_code(
+            resumer->suite, &proof, false);
+    if (VCCRYPT_STATUS_SUCCESS != retval)
+    {
+        goto cleanup_response;
+    }
+
+    if (response.size != AGENT_SESSION_NONCE_SIZE + proof.size)
+    {
+        retval = VCTOOL_ERROR_AGENT_RESUME_FAILED;
+        goto cleanup_proof;
+    }
+
+    retval =
+        agent_session_proof(
+            resumer->suite, session, request, response.payload, &proof);
+    if (VCTOOL_STATUS_SUCCESS != retval)
+    {
+        goto cleanup_proof;
+    }
+
+    if (crypto_memcmp(
+            response.payload + AGENT_SESSION_NONCE_SIZE, proof.data,
+            proof.size))
+    {
+        retval = VCTOOL_ERROR_AGENT_RESUME_FAILED;
+        goto cleanup_proof;
+    }
+
+    agent_session_count(resumer, &resumer->resumptions);
+
+    /* success. */
+    retval = VCTOOL_STATUS_SUCCESS;
+
+cleanup_proof:
+    dispose((disposable_t*)&proof);
+
+cleanup_response:
+    dispose((disposable_t*)&response);
+
+done:
+    return retval;
+}
+
+/**
+ * \brief Compute the MAC of both nonces, keyed with the session key.
+ *
+ * \param suite         The crypto suite.
+ * \param session       The session.
+ * \param client_nonce  The client nonce.
+ * \param server_nonce  The agent nonce.
+ * \param proof         The buffer receiving the MAC.
+ *
+ * \returns a status code indicating success or failure.
+ */
+static int agent_session_proof(
+    vccrypt_suite_options_t* suite, const agent_session* session,
+    const uint8_t* client_nonce, const uint8_t* server_nonce,
+    vccrypt_buffer_t* proof)
+{
+    int retval;
+    vccrypt_buffer_t key;
+    vccrypt_mac_context_t mac;
+
+    retval = vccrypt_buffer_init(&key, suite->alloc_opts, session->key_size);
+    if (VCCRYPT_STATUS_SUCCESS != retval)
+    {
+        goto done;
+    }
+
+    memcpy(key.data, session->key, session->key_size);
+
+    retval = vccrypt_suite_mac_init(suite, &mac, &key);
+    if (VCCRYPT_STATUS_SUCCESS != retval)
+    {
+        goto cleanup_key;
+    }
+
+    retval = vccrypt_mac_digest(&mac, client_nonce, AGENT_SESSION_NONCE_SIZE);
+    if (VCCRYPT_STATUS_SUCCESS != retval)
+    {
+        goto cleanup_mac;
+    }
+
+    retval = vccrypt_mac_digest(&mac, server_nonce, AGENT_SESSION_NONCE_SIZE);
+    if (VCCRYPT_STATUS_SUCCESS != retval)
+    {
+        goto cleanup_mac;
+    }
+
+    retval = vccrypt_mac_finalize(&mac, proof);
+
+cleanup_mac:
+    dispose((disposable_t*)&mac);
+
+cleanup_key:
+    explicit_bzero(key.data, key.size);
+    dispose((disposable_t*)&key);
+
+done:
+    return retval;
+}
+
+/**
+ * \brief Count a handshake.
+ *
+ * \param resumer       The handshake state, shared by the pool connections.
+ * \param counter       The counter to increment.
+ */
+static void agent_session_count(
+    agent_session_resumer* resumer, uint64_t* counter)
+{
+    pthread_mutex_lock(&resumer->cache->lock);
+    ++*counter;
+    pthread_mutex_unlock(&resumer->cache->lock);
+}
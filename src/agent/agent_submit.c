@@ -0,0 +1,97 @@
+/**
+ * \file agent/agent_submit.c
+ *
+ * \brief Submit a transaction to an agent.
+ *
+ * \copyright 2020 Velo Payments.  See License.txt for license terms.
+ */
+
+#include <cbmc/model_assert.h>
+#include <time.h>
+#include <vctool/agent.h>
+#include <vpr/parameters.h>
+
+/* forward decls. */
+static int agent_submit_response(
+    void* context, const agent_frame* response);
+static uint64_t agent_submit_now(void);
+
+/**
+ * \brief Submit a transaction over a pool, within a limiter's window.
+ *
+ * The pool should have as many connections as the limiter's largest window,
+ * so that an admitted request never waits for a connection.
+ *
+ * \param pool          The pool.
+ * \param limiter       The limiter.
+ * \param txn           The transaction certificate.
+ * \param size          The size of the certificate.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS if the agent accepted the transaction.
+ *      - VCTOOL_ERROR_AGENT_BUSY if the agent was too busy, and the
+ *        transaction should be submitted again.
+ *      - VCTOOL_ERROR_AGENT_UNEXPECTED_MESSAGE if the agent answered with
+ *        something else.
+ *      - a non-zero error code from agent_pool_request.
+ */
+int agent_submit(
+    agent_pool* pool, agent_limiter* limiter, const void* txn, size_t size)
+{
+    int retval;
+    agent_limiter_ticket ticket;
+
+    /* parameter sanity checks. */
+    MODEL_ASSERT(NULL != pool);
+    MODEL_ASSERT(NULL != limiter);
+    MODEL_ASSERT(NULL != txn);
+
+    agent_limiter_acquire(limiter, &ticket);
+
+    retval =
+        agent_pool_request(
+            pool, AGENT_MSG_SUBMIT, txn, size, &agent_submit_response, NULL);
+
+    agent_limiter_release(
+        limiter, &ticket, agent_submit_now() - ticket.start, retval);
+
+    return retval;
+}
+
+/**
+ * \brief Map the agent's answer to a submission onto a status code.
+ *
+ * \param context       Unused.
+ * \param response      The response.
+ *
+ * \returns a status code indicating the outcome of the submission.
+ */
+static int agent_submit_response(
+    void* UNUSED(context), const agent_frame* response)
+{
+    switch (response->type)
+    {
+        case AGENT_MSG_SUBMIT_ACCEPTED:
+            return VCTOOL_STATUS_SUCCESS;
+
+        case AGENT_MSG_SUBMIT_BUSY:
+            return VCTOOL_ERROR_AGENT_BUSY;
+
+        default:
+            return VCTOOL_ERROR_AGENT_UNEXPECTED_MESSAGE;
+    }
+}
+
+/**
+ * \brief Get the monotonic time.
+ *
+ * \returns the time in nanoseconds.
+ */
+static uint64_t agent_submit_now(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
@@ -0,0 +1,167 @@
+/**
+ * \file agent/agent_txn_status.c
+ *
+ * \brief Query the states of transactions in pipelined batches.
+ *
+ * \copyright 2020 Velo Payments.  See License.txt for license terms.
+ */
+
+#include <cbmc/model_assert.h>
+#include <vctool/agent.h>
+#include <vctool/uuid.h>
+
+/* forward decls. */
+static uint32_t agent_read_u32(const uint8_t* buf);
+
+/**
+ * \brief Query the states of transactions in pipelined batches.
+ *
+ * Results are passed to the callback one batch at a time, in the order of
+ * the transaction ids, as soon as each batch is answered.
+ *
+ * \param f             The file abstraction layer to use.
+ * \param sock          The socket connected to the agent.
+ * \param txn_ids       Array of count 16 byte transaction ids.
+ * \param count         The number of transactions.
+ * \param result        Function receiving each batch of states.
+ * \param context       The user context passed to result.
+ * \param recorder      Captures each batch and its result, or NULL.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - VCTOOL_ERROR_AGENT_UNEXPECTED_MESSAGE if the agent answered with
+ *        something else.
+ *      - VCTOOL_ERROR_AGENT_BAD_FRAME if a result did not match its batch.
+ *      - the status code returned by result, if not success.
+ *      - a non-zero error code on failure.
+ */
+int agent_txn_status(
+    file* f, int sock, const uint8_t* txn_ids, size_t count,
+    agent_txn_status_fn result, void* context, agent_recorder* recorder)
+{
+    int retval;
+    agent_frame frame;
+    uint32_t states[AGENT_TXN_STATUS_BATCH];
+    uint64_t exchanges[AGENT_TXN_STATUS_PIPELINE];
+
+    /* parameter sanity checks. */
+    MODEL_ASSERT(PROP_FILE_VALID(f));
+    MODEL_ASSERT(0 == count || NULL != txn_ids);
+    MODEL_ASSERT(NULL != result);
+
+    retval = agent_frame_init(&frame);
+    if (VCTOOL_STATUS_SUCCESS != retval)
+    {
+        return retval;
+    }
+
+    size_t batches =
+        (count + AGENT_TXN_STATUS_BATCH - 1) / AGENT_TXN_STATUS_BATCH;
+    size_t sent = 0, received = 0;
+
+    while (received < batches)
+    {
+        /* keep the pipeline full; it is short enough that the results of
+         * the batches in flight fit in the socket buffers, so writing
+         * can't stall behind an agent blocked on its own writes. */
+        while (sent < batches && sent - received < AGENT_TXN_STATUS_PIPELINE)
+        {
+            const uint8_t* batch =
+                txn_ids + sent * AGENT_TXN_STATUS_BATCH * UUID_SIZE;
+            size_t batch_count = count - sent * AGENT_TXN_STATUS_BATCH;
+            if (batch_count > AGENT_TXN_STATUS_BATCH)
+            {
+                batch_count = AGENT_TXN_STATUS_BATCH;
+            }
+
+            if (NULL != recorder)
+            {
+                uint64_t exchange = agent_recorder_exchange(recorder);
+                exchanges[sent % AGENT_TXN_STATUS_PIPELINE] = exchange;
+                agent_recorder_write(
+                    recorder, exchange, AGENT_RECORD_REQUEST,
+                    AGENT_MSG_TXN_STATUS, batch, batch_count * UUID_SIZE);
+            }
+
+            retval =
+                agent_frame_write(
+                    f, sock, AGENT_MSG_TXN_STATUS, batch,
+                    batch_count * UUID_SIZE);
+            if (VCTOOL_STATUS_SUCCESS != retval)
+            {
+                goto cleanup_frame;
+            }
+
+            ++sent;
+        }
+
+        /* results arrive in request order. */
+        retval = agent_frame_read(f, sock, &frame);
+        if (VCTOOL_STATUS_SUCCESS != retval)
+        {
+            goto cleanup_frame;
+        }
+
+        if (NULL != recorder)
+        {
+            agent_recorder_write(
+                recorder, exchanges[received % AGENT_TXN_STATUS_PIPELINE],
+                AGENT_RECORD_RESPONSE, frame.type, frame.payload,
+                frame.size);
+        }
+
+        if (AGENT_MSG_TXN_STATUS_RESULT != frame.type)
+        {
+            retval = VCTOOL_ERROR_AGENT_UNEXPECTED_MESSAGE;
+            goto cleanup_frame;
+        }
+
+        size_t batch_count = count - received * AGENT_TXN_STATUS_BATCH;
+        if (batch_count > AGENT_TXN_STATUS_BATCH)
+        {
+            batch_count = AGENT_TXN_STATUS_BATCH;
+        }
+
+        if (frame.size != batch_count * 4)
+        {
+            retval = VCTOOL_ERROR_AGENT_BAD_FRAME;
+            goto cleanup_frame;
+        }
+
+        for (size_t i = 0; i < batch_count; ++i)
+        {
+            states[i] = agent_read_u32(frame.payload + 4 * i);
+        }
+
+        const uint8_t* batch =
+            txn_ids + received * AGENT_TXN_STATUS_BATCH * UUID_SIZE;
+        retval = result(context, batch, states, batch_count);
+        if (VCTOOL_STATUS_SUCCESS != retval)
+        {
+            goto cleanup_frame;
+        }
+
+        ++received;
+    }
+
+    retval = VCTOOL_STATUS_SUCCESS;
+
+cleanup_frame:
+    dispose((disposable_t*)&frame);
+
+    return retval;
+}
+
+/**
+ * \brief Read a big endian 32-bit value.
+ *
+ * \param buf           The buffer from which the value is read.
+ *
+ * \returns the value.
+ */
+static uint32_t agent_read_u32(const uint8_t* buf)
+{
+    return
+        ((uint32_t)buf[0] << 24) | ((uint32_t)buf[1] << 16)
+      | ((uint32_t)buf[2] << 8) | (uint32_t)buf[3];
+}
@@ -0,0 +1,32 @@
+/**
+ * \file blockstore/blockstore_record_checksum.c
+ *
+ * \brief Compute the checksum of a block store record.
+ *
+ * \copyright 2020 Velo Payments.  See License.txt for license terms.
+ */
+
+#include <cbmc/model_assert.h>
+#include <vctool/blockstore.h>
+#include <vctool/crc32c.h>
+
+/**
+ * \brief Compute the checksum of a record.
+ *
+ * \param header        The BLOCKSTORE_RECORD_HEADER_SIZE byte record header.
+ * \param block         The block.
+ * \param size          The size of the block.
+ *
+ * \returns the CRC-32C of the checked header bytes and the block.
+ */
+uint32_t blockstore_record_checksum(
+    const uint8_t* header, const void* block, size_t size)
+{
+    /* parameter sanity checks. */
+    MODEL_ASSERT(NULL != header);
+    MODEL_ASSERT(0 == size || NULL != block);
+
+    uint32_t crc = crc32c(0, header, BLOCKSTORE_RECORD_CHECKED_SIZE);
+
+    return crc32c(crc, block, size);
+}
@@ -0,0 +1,101 @@
+/**
+ * \file blockstore/blockstore_record_verify.c
+ *
+ * \brief Verify a block store record.
+ *
+ * \copyright 2020 Velo Payments.  See License.txt for license terms.
+ */
+
+#include <cbmc/model_assert.h>
+#include <vctool/blockstore.h>
+
+/* forward decls. */
+static uint32_t blockstore_read_u32(const uint8_t* buf);
+static uint64_t blockstore_read_u64(const uint8_t* buf);
+
+/**
+ * \brief Check whether an intact record starts at the given offset.
+ *
+ * \param base          The mapped segment.
+ * \param size          The size of the segment.
+ * \param offset        The offset of the record, at most size.
+ * \param length        Set to the length of the record, including its header,
+ *                      if it is intact.
+ * \param height        Set to the height of the record if it is intact.
+ *
+ * \returns true if an intact record starts at offset.
+ */
+bool blockstore_record_verify(
+    const uint8_t* base, uint64_t size, uint64_t offset, uint64_t* length,
+    uint64_t* height)
+{
+    /* parameter sanity checks. */
+    MODEL_ASSERT(NULL != base);
+    MODEL_ASSERT(offset <= size);
+    MODEL_ASSERT(NULL != length);
+    MODEL_ASSERT(NULL != height);
+
+    if (size - offset < BLOCKSTORE_RECORD_HEADER_SIZE)
+    {
+        return false;
+    }
+
+    const uint8_t* header = base + offset;
+    if (BLOCKSTORE_RECORD_MAGIC != blockstore_read_u32(header)
+     || 0 != blockstore_read_u32(header + 36))
+    {
+        return false;
+    }
+
+    uint64_t block_size = blockstore_read_u32(header + 4);
+    if (block_size > size - offset - BLOCKSTORE_RECORD_HEADER_SIZE)
+    {
+        return false;
+    }
+
+    uint32_t crc =
+        blockstore_record_checksum(
+            header, header + BLOCKSTORE_RECORD_HEADER_SIZE, (size_t)block_size);
+    if (crc != blockstore_read_u32(header + 32))
+    {
+        return false;
+    }
+
+    *length = BLOCKSTORE_RECORD_HEADER_SIZE + block_size;
+    *height = blockstore_read_u64(header + 8);
+
+    return true;
+}
+
+/**
+ * \brief Read a big endian 32-bit value.
+ *
+ * \param buf           The buffer from which the value is read.
+ *
+ * \returns the value.
+ */
+static uint32_t blockstore_read_u32(const uint8_t* buf)
+{
+    return
+        ((uint32_t)buf[0] << 24) | ((uint32_t)buf[1] << 16)
+      | ((uint32_t)buf[2] << 8) | (uint32_t)buf[3];
+}
+
+/**
+ * \brief Read a big endian 64-bit value.
+ *
+ * \param buf           The buffer from which the value is read.
+ *
+ * \returns the value.
+ */
+static uint64_t blockstore_read_u64(const uint8_t* buf)
+{
+    uint64_t val = 0;
+
+    for (int i = 0; i < 8; ++i)
+    {
+        val = (val << 8) | buf[i];
+    }
+
+    return val;
+}
@@ -0,0 +1,158 @@
+/**
+ * \file blockstore/blockstore_segment_append.c
+ *
+ * \brief Append a block to a block store segment.
+ *
+ * \copyright 2020 Velo Payments.  See License.txt for license terms.
+ */
+
+#include <cbmc/model_assert.h>
+#include <fcntl.h>
+#include <string.h>
+#include <vctool/blockstore.h>
+
+/* forward decls. */
+static void blockstore_write_u32(uint8_t* buf, uint32_t val);
+static void blockstore_write_u64(uint8_t* buf, uint64_t val);
+
+/**
+ * \brief Append a block to a segment, creating the segment if necessary.
+ *
+ * A segment has a single writer; concurrent appends may interleave.
+ *
+ * \param f             The file abstraction layer to use.
+ * \param path          The path of the segment.
+ * \param height        The block height.
+ * \param block_id      The BLOCKSTORE_BLOCK_ID_SIZE byte block id.
+ * \param block         The block.
+ * \param size          The size of the block.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - VCTOOL_ERROR_BLOCKSTORE_BAD_SEGMENT if path is not a segment.
+ *      - VCTOOL_ERROR_BLOCKSTORE_RECORD_TOO_LARGE if the block is too large.
+ *      - a non-zero error code returned by the file layer.
+ */
+int blockstore_segment_append(
+    file* f, const char* path, uint64_t height, const uint8_t* block_id,
+    const void* block, size_t size)
+{
+    int retval, fd;
+    file_stat_st fst;
+    uint8_t header[BLOCKSTORE_RECORD_HEADER_SIZE];
+    bool created = false;
+
+    /* parameter sanity checks. */
+    MODEL_ASSERT(PROP_FILE_VALID(f));
+    MODEL_ASSERT(NULL != path);
+    MODEL_ASSERT(NULL != block_id);
+    MODEL_ASSERT(0 == size || NULL != block);
+
+    /* the block size must fit in the header. */
+    if (size > UINT32_MAX)
+    {
+        return VCTOOL_ERROR_BLOCKSTORE_RECORD_TOO_LARGE;
+    }
+
+    /* a missing or empty segment needs its magic. */
+    retval = file_stat(f, path, &fst);
+    if (VCTOOL_ERROR_FILE_NO_ENTRY == retval)
+    {
+        created = true;
+    }
+    else if (VCTOOL_STATUS_SUCCESS != retval)
+    {
+        return retval;
+    }
+    else if (0 == fst.fst_size)
+    {
+        created = true;
+    }
+    else if ((uint64_t)fst.fst_size < BLOCKSTORE_SEGMENT_MAGIC_SIZE)
+    {
+        return VCTOOL_ERROR_BLOCKSTORE_BAD_SEGMENT;
+    }
+
+    retval =
+        file_open(
+            f, &fd, path, O_CREAT | O_WRONLY | O_APPEND,
+            S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH);
+    if (VCTOOL_STATUS_SUCCESS != retval)
+    {
+        return retval;
+    }
+
+    if (created)
+    {
+        retval =
+            file_write_all(
+                f, fd, BLOCKSTORE_SEGMENT_MAGIC,
+                BLOCKSTORE_SEGMENT_MAGIC_SIZE);
+        if (VCTOOL_STATUS_SUCCESS != retval)
+        {
+            goto cleanup_fd;
+        }
+    }
+
+    /* build the record header. */
+    memset(header, 0, sizeof(header));
+    blockstore_write_u32(header, BLOCKSTORE_RECORD_MAGIC);
+    blockstore_write_u32(header + 4, (uint32_t)size);
+    blockstore_write_u64(header + 8, height);
+    memcpy(header + 16, block_id, BLOCKSTORE_BLOCK_ID_SIZE);
+    blockstore_write_u32(
+        header + 32, blockstore_record_checksum(header, block, size));
+
+    /* write the record. */
+    retval = file_write_all(f, fd, header, sizeof(header));
+    if (VCTOOL_STATUS_SUCCESS != retval)
+    {
+        goto cleanup_fd;
+    }
+
+    if (size > 0)
+    {
+        retval = file_write_all(f, fd, block, size);
+        if (VCTOOL_STATUS_SUCCESS != retval)
+        {
+            goto cleanup_fd;
+        }
+    }
+
+    /* close the segment. */
+    return file_close(f, fd);
+
+cleanup_fd:
+    file_close(f, fd);
+
+    return retval;
+}
+
+/**
+ * \brief Write a big endian 32-bit value.
+ *
+ * \param buf           The buffer to which the value is written.
+ * \param val           The value to write.
+ */
+static void blockstore_write_u32(uint8_t* buf, uint32_t val)
+{
+    buf[0] = (uint8_t)(val >> 24);
+    buf[1] = (uint8_t)(val >> 16);
+    buf[2] = (uint8_t)(val >> 8);
+    buf[3] = (uint8_t)val;
+}
+
+/**
+ * \brief Write a big endian 64-bit value.
+ *
+ * \param buf           The buffer to which the value is written.
+ * \param val           The value to write.
+ */
+static void blockstore_write_u64(uint8_t* buf, uint64_t val)
+{
+    for (int i = 7; i >= 0; --i)
+    {
+        buf[i] = (uint8_t)(val & 0xff);
+        val >>= 8;
+    }
+}
@@ -0,0 +1,168 @@
+/**
+ * \file blockstore/blockstore_segment_scrub.c
+ *
+ * \brief Verify the records of a block store segment.
+ *
+ * \copyright 2020 Velo Payments.  See License.txt for license terms.
+ */
+
+#include <cbmc/model_assert.h>
+#include <fcntl.h>
+#include <string.h>
+#include <vctool/blockstore.h>
+
+/* forward decls. */
+static uint64_t blockstore_resync(
+    const uint8_t* base, uint64_t size, uint64_t offset, uint64_t* length,
+    uint64_t* height);
+
+/**
+ * \brief Verify the checksum of every record in a segment.
+ *
+ * Each damaged range runs from the start of a record which fails to verify to
+ * the next intact record, or the end of the segment.
+ *
+ * \param f             The file abstraction layer to use.
+ * \param path          The path of the segment.
+ * \param result        Totals for this segment.
+ * \param bad_range     Function receiving each damaged range, or NULL.
+ * \param context       The user context passed to bad_range.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS if every record is intact.
+ *      - VCTOOL_ERROR_BLOCKSTORE_CORRUPT if a damaged range was found.
+ *      - VCTOOL_ERROR_BLOCKSTORE_BAD_SEGMENT if path is not a segment.
+ *      - a non-zero error code returned by the file layer.
+ */
+int blockstore_segment_scrub(
+    file* f, const char* path, blockstore_scrub_result* result,
+    blockstore_bad_range_fn bad_range, void* context)
+{
+    int retval, fd;
+    file_stat_st fst;
+    void* map;
+
+    /* parameter sanity checks. */
+    MODEL_ASSERT(PROP_FILE_VALID(f));
+    MODEL_ASSERT(NULL != path);
+    MODEL_ASSERT(NULL != result);
+
+    memset(result, 0, sizeof(blockstore_scrub_result));
+
+    /* get the size of the segment. */
+    retval = file_stat(f, path, &fst);
+    if (VCTOOL_STATUS_SUCCESS != retval)
+    {
+        return retval;
+    }
+
+    uint64_t size = (uint64_t)fst.fst_size;
+    if (size < BLOCKSTORE_SEGMENT_MAGIC_SIZE)
+    {
+        return VCTOOL_ERROR_BLOCKSTORE_BAD_SEGMENT;
+    }
+
+    /* map the segment; the mapping outlives the descriptor. */
+    retval = file_open(f, &fd, path, O_RDONLY, 0);
+    if (VCTOOL_STATUS_SUCCESS != retval)
+    {
+        return retval;
+    }
+
+    retval = file_mmap(f, &map, fd, (size_t)size);
+    file_close(f, fd);
+    if (VCTOOL_STATUS_SUCCESS != retval)
+    {
+        return retval;
+    }
+
+    const uint8_t* base = (const uint8_t*)map;
+    if (memcmp(base, BLOCKSTORE_SEGMENT_MAGIC, BLOCKSTORE_SEGMENT_MAGIC_SIZE))
+    {
+        retval = VCTOOL_ERROR_BLOCKSTORE_BAD_SEGMENT;
+        goto cleanup_map;
+    }
+
+    /* walk the records. */
+    uint64_t offset = BLOCKSTORE_SEGMENT_MAGIC_SIZE;
+    uint64_t height_before = BLOCKSTORE_NO_HEIGHT;
+    uint64_t length, height;
+    while (offset < size)
+    {
+        if (blockstore_record_verify(base, size, offset, &length, &height))
+        {
+            ++result->records;
+            height_before = height;
+            offset += length;
+            continue;
+        }
+
+        /* this record is damaged; skip to the next intact one. */
+        blockstore_bad_range range;
+        range.begin = offset;
+        range.height_before = height_before;
+        range.end = blockstore_resync(base, size, offset + 1, &length, &height);
+        range.height_after = (range.end < size) ? height : BLOCKSTORE_NO_HEIGHT;
+
+        ++result->bad_ranges;
+        result->bad_bytes += range.end - range.begin;
+        if (NULL != bad_range)
+        {
+            bad_range(context, path, &range);
+        }
+
+        offset = range.end;
+    }
+
+    retval =
+        (0 == result->bad_ranges)
+            ? VCTOOL_STATUS_SUCCESS
+            : VCTOOL_ERROR_BLOCKSTORE_CORRUPT;
+
+cleanup_map:
+    file_munmap(f, map, (size_t)size);
+
+    return retval;
+}
+
+/**
+ * \brief Find the next intact record at or after the given offset.
+ *
+ * Only offsets holding the record magic are checked in full.
+ *
+ * \param base          The mapped segment.
+ * \param size          The size of the segment.
+ * \param offset        The offset at which to start searching.
+ * \param length        Set to the length of the record found.
+ * \param height        Set to the height of the record found.
+ *
+ * \returns the offset of the next intact record, or size if there is none.
+ */
+static uint64_t blockstore_resync(
+    const uint8_t* base, uint64_t size, uint64_t offset, uint64_t* length,
+    uint64_t* height)
+{
+    const uint8_t first = (uint8_t)(BLOCKSTORE_RECORD_MAGIC >> 24);
+
+    while (offset + BLOCKSTORE_RECORD_HEADER_SIZE <= size)
+    {
+        const uint8_t* next =
+            (const uint8_t*)memchr(
+                base + offset, first,
+                (size_t)(size - offset - BLOCKSTORE_RECORD_HEADER_SIZE + 1));
+        if (NULL == next)
+        {
+            break;
+        }
+
+        offset = (uint64_t)(next - base);
+        if (blockstore_record_verify(base, size, offset, length, height))
+        {
+            return offset;
+        }
+
+        ++offset;
+    }
+
+    return size;
+}
@@ -0,0 +1,206 @@
+/**
+ * \file blockstore/blockstore_segment_tail.c
+ *
+ * \brief Find the height of the last record of a segment.
+ *
+ * \copyright 2020 Velo Payments.  See License.txt for license terms.
+ */
+
+#include <cbmc/model_assert.h>
+#include <fcntl.h>
+#include <stdbool.h>
+#include <string.h>
+#include <vctool/blockstore.h>
+
+/* forward decls. */
+static bool blockstore_record_torn(
+    const uint8_t* base, uint64_t size, uint64_t offset);
+static int blockstore_segment_truncate(
+    file* f, const char* path, uint64_t size);
+static uint32_t blockstore_read_u32(const uint8_t* buf);
+
+/**
+ * \brief Find the height of the last record of a segment.
+ *
+ * A final record which was torn by a crash during an append is truncated, so
+ * that appending resumes after the last intact record.  A damaged record
+ * before the final one is not repaired.
+ *
+ * \param f             The file abstraction layer to use.
+ * \param path          The path of the segment.
+ * \param height        Set to the height of the last record, or
+ *                      BLOCKSTORE_NO_HEIGHT if the segment is empty or does
+ *                      not exist.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - VCTOOL_ERROR_BLOCKSTORE_BAD_SEGMENT if path is not a segment.
+ *      - VCTOOL_ERROR_BLOCKSTORE_CORRUPT if a record before the final one is
+ *        damaged.
+ *      - a non-zero error code returned by the file layer.
+ */
+int blockstore_segment_tail(file* f, const char* path, uint64_t* height)
+{
+    int retval, fd;
+    file_stat_st fst;
+    void* map;
+    uint64_t offset, length, record_height;
+
+    /* parameter sanity checks. */
+    MODEL_ASSERT(PROP_FILE_VALID(f));
+    MODEL_ASSERT(NULL != path);
+    MODEL_ASSERT(NULL != height);
+
+    *height = BLOCKSTORE_NO_HEIGHT;
+
+    /* a missing or empty segment has no records. */
+    retval = file_stat(f, path, &fst);
+    if (VCTOOL_ERROR_FILE_NO_ENTRY == retval)
+    {
+        return VCTOOL_STATUS_SUCCESS;
+    }
+    else if (VCTOOL_STATUS_SUCCESS != retval)
+    {
+        return retval;
+    }
+
+    uint64_t size = (uint64_t)fst.fst_size;
+    if (0 == size)
+    {
+        return VCTOOL_STATUS_SUCCESS;
+    }
+    else if (size < BLOCKSTORE_SEGMENT_MAGIC_SIZE)
+    {
+        return VCTOOL_ERROR_BLOCKSTORE_BAD_SEGMENT;
+    }
+
+    retval = file_open(f, &fd, path, O_RDONLY, 0);
+    if (VCTOOL_STATUS_SUCCESS != retval)
+    {
+        return retval;
+    }
+
+    retval = file_mmap(f, &map, fd, (size_t)size);
+    file_close(f, fd);
+    if (VCTOOL_STATUS_SUCCESS != retval)
+    {
+        return retval;
+    }
+
+    const uint8_t* base = (const uint8_t*)map;
+    if (memcmp(base, BLOCKSTORE_SEGMENT_MAGIC, BLOCKSTORE_SEGMENT_MAGIC_SIZE))
+    {
+        retval = VCTOOL_ERROR_BLOCKSTORE_BAD_SEGMENT;
+        goto cleanup_map;
+    }
+
+    /* appending after a damaged record would hide it, so every record but a
+     * torn final one must verify. */
+    for (offset = BLOCKSTORE_SEGMENT_MAGIC_SIZE; offset < size;
+         offset += length)
+    {
+        if (!blockstore_record_verify(
+                base, size, offset, &length, &record_height))
+        {
+            break;
+        }
+
+        *height = record_height;
+    }
+
+    bool torn = offset < size;
+    if (torn && !blockstore_record_torn(base, size, offset))
+    {
+        retval = VCTOOL_ERROR_BLOCKSTORE_CORRUPT;
+        goto cleanup_map;
+    }
+
+    retval = VCTOOL_STATUS_SUCCESS;
+
+cleanup_map:
+    file_munmap(f, map, (size_t)size);
+
+    /* drop the torn record once the segment is no longer mapped. */
+    if (VCTOOL_STATUS_SUCCESS == retval && torn)
+    {
+        retval = blockstore_segment_truncate(f, path, offset);
+    }
+
+    return retval;
+}
+
+/**
+ * \brief Check whether a record which failed to verify was torn by a crash.
+ *
+ * An append writes the header before the block, so a torn record either has
+ * an incomplete header, or has a header whose block runs to the end of the
+ * segment.
+ *
+ * \param base          The mapped segment.
+ * \param size          The size of the segment.
+ * \param offset        The offset of the record, less than size.
+ *
+ * \returns true if the record is the torn final record of the segment.
+ */
+static bool blockstore_record_torn(
+    const uint8_t* base, uint64_t size, uint64_t offset)
+{
+    if (size - offset < BLOCKSTORE_RECORD_HEADER_SIZE)
+    {
+        return true;
+    }
+
+    const uint8_t* header = base + offset;
+    uint64_t block_size = blockstore_read_u32(header + 4);
+
+    return
+        BLOCKSTORE_RECORD_MAGIC == blockstore_read_u32(header)
+     && block_size >= size - offset - BLOCKSTORE_RECORD_HEADER_SIZE;
+}
+
+/**
+ * \brief Truncate a segment to a length and flush it.
+ *
+ * \param f             The file abstraction layer to use.
+ * \param path          The path of the segment.
+ * \param size          The new size of the segment.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - a non-zero error code returned by the file layer.
+ */
+static int blockstore_segment_truncate(
+    file* f, const char* path, uint64_t size)
+{
+    int retval, fd;
+
+    retval = file_open(f, &fd, path, O_WRONLY, 0);
+    if (VCTOOL_STATUS_SUCCESS != retval)
+    {
+        return retval;
+    }
+
+    retval = file_ftruncate(f, fd, (off_t)size);
+    if (VCTOOL_STATUS_SUCCESS == retval)
+    {
+        retval = file_fsync(f, fd);
+    }
+
+    file_close(f, fd);
+
+    return retval;
+}
+
+/**
+ * \brief Read a big endian 32-bit value.
+ *
+ * \param buf           The buffer from which the value is read.
+ *
+ * \returns the value.
+ */
+static uint32_t blockstore_read_u32(const uint8_t* buf)
+{
+    return
+        ((uint32_t)buf[0] << 24) | ((uint32_t)buf[1] << 16)
+      | ((uint32_t)buf[2] << 8) | (uint32_t)buf[3];
+}
@@ -0,0 +1,369 @@
+/**
+ * \file blockstore/blockstore_summary_build.c
+ *
+ * \brief Build the summary of a segment.
+ *
+ * \copyright 2020 Velo Payments.  See License.txt for license terms.
+ */
+
+#include <cbmc/model_assert.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vctool/blockstore.h>
+
+/* forward decls. */
+static int blockstore_summary_hash(
+    vccrypt_suite_options_t* suite, uint8_t* out, const void* first,
+    size_t first_size, const void* second, size_t second_size);
+static int blockstore_summary_write(blockstore_summary* summary);
+static void blockstore_write_u32(uint8_t* buf, uint32_t val);
+static void blockstore_write_u64(uint8_t* buf, uint64_t val);
+
+/**
+ * \brief Build the summary of a segment and write its summary file.
+ *
+ * \param summary       The summary.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - VCTOOL_ERROR_BLOCKSTORE_BAD_SEGMENT if the path is not a segment.
+ *      - VCTOOL_ERROR_BLOCKSTORE_CORRUPT if a record is damaged.
+ *      - VCTOOL_ERROR_GENERAL_OUT_OF_MEMORY if an allocation failed.
+ *      - a non-zero error code on failure.
+ */
+int blockstore_summary_build(blockstore_summary* summary)
+{
+    int retval, fd;
+    file_stat_st fst;
+    void* map;
+    uint64_t offset, length, height;
+
+    /* parameter sanity checks. */
+    MODEL_ASSERT(NULL != summary);
+    MODEL_ASSERT(NULL == summary->data);
+
+    /* map the segment. */
+    retval = file_stat(summary->f, summary->segment_path, &fst);
+    if (VCTOOL_STATUS_SUCCESS != retval)
+    {
+        return retval;
+    }
+
+    uint64_t size = (uint64_t)fst.fst_size;
+    if (size < BLOCKSTORE_SEGMENT_MAGIC_SIZE)
+    {
+        return VCTOOL_ERROR_BLOCKSTORE_BAD_SEGMENT;
+    }
+
+    retval = file_open(summary->f, &fd, summary->segment_path, O_RDONLY, 0);
+    if (VCTOOL_STATUS_SUCCESS != retval)
+    {
+        return retval;
+    }
+
+    retval = file_mmap(summary->f, &map, fd, (size_t)size);
+    file_close(summary->f, fd);
+    if (VCTOOL_STATUS_SUCCESS != retval)
+    {
+        return retval;
+    }
+
+    const uint8_t* base = (const uint8_t*)map;
+    if (memcmp(base, BLOCKSTORE_SEGMENT_MAGIC, BLOCKSTORE_SEGMENT_MAGIC_SIZE))
+    {
+        retval = VCTOOL_ERROR_BLOCKSTORE_BAD_SEGMENT;
+        goto cleanup_map;
+    }
+
+    /* count the records; a summary of a damaged segment would be wrong. */
+    uint64_t count = 0;
+    for (offset = BLOCKSTORE_SEGMENT_MAGIC_SIZE; offset < size;
+         offset += length)
+    {
+        if (!blockstore_record_verify(base, size, offset, &length, &height))
+        {
+            retval = VCTOOL_ERROR_BLOCKSTORE_CORRUPT;
+            goto cleanup_map;
+        }
+
+        ++count;
+    }
+
+    /* size the levels. */
+    size_t hash_size = summary->hash_size;
+    uint64_t level_sizes[BLOCKSTORE_SUMMARY_MAX_LEVELS];
+    uint32_t level_count = 0;
+    uint64_t hashes = 0;
+    uint64_t n = count;
+    while (n > 0)
+    {
+        level_sizes[level_count++] = n;
+        hashes += n;
+
+        /* the root is the only node of the last level. */
+        if (1 == n)
+        {
+            break;
+        }
+
+        n = (n + BLOCKSTORE_SUMMARY_FANOUT - 1) / BLOCKSTORE_SUMMARY_FANOUT;
+    }
+
+    summary->size =
+        BLOCKSTORE_SUMMARY_HEADER_SIZE + count * sizeof(uint64_t)
+      + hashes * hash_size;
+    summary->data = (uint8_t*)malloc(summary->size);
+    if (NULL == summary->data)
+    {
+        retval = VCTOOL_ERROR_GENERAL_OUT_OF_MEMORY;
+        goto cleanup_map;
+    }
+    summary->mapped = false;
+
+    /* write the header. */
+    memcpy(
+        summary->data, BLOCKSTORE_SUMMARY_MAGIC,
+        BLOCKSTORE_SUMMARY_MAGIC_SIZE);
+    blockstore_write_u64(summary->data + 8, size);
+    blockstore_write_u64(summary->data + 16, count);
+    blockstore_write_u32(summary->data + 24, (uint32_t)hash_size);
+    blockstore_write_u32(summary->data + 28, level_count);
+
+    /* each leaf is the hash of a record's checked bytes. */
+    uint8_t* heights = summary->data + BLOCKSTORE_SUMMARY_HEADER_SIZE;
+    uint8_t* level = heights + count * sizeof(uint64_t);
+    uint64_t i = 0;
+    for (offset = BLOCKSTORE_SEGMENT_MAGIC_SIZE; offset < size;
+         offset += length, ++i)
+    {
+        blockstore_record_verify(base, size, offset, &length, &height);
+        blockstore_write_u64(heights + i * sizeof(uint64_t), height);
+
+        const uint8_t* header = base + offset;
+        retval =
+            blockstore_summary_hash(
+                summary->suite, level + i * hash_size, header,
+                BLOCKSTORE_RECORD_CHECKED_SIZE,
+                header + BLOCKSTORE_RECORD_HEADER_SIZE,
+                length - BLOCKSTORE_RECORD_HEADER_SIZE);
+        if (VCTOOL_STATUS_SUCCESS != retval)
+        {
+            goto cleanup_data;
+        }
+    }
+
+    /* each interior node is the hash of its children. */
+    for (uint32_t l = 1; l < level_count; ++l)
+    {
+        uint8_t* children = level;
+        level += level_sizes[l - 1] * hash_size;
+
+        for (uint64_t j = 0; j < level_sizes[l]; ++j)
+        {
+            uint64_t first = j * BLOCKSTORE_SUMMARY_FANOUT;
+            uint64_t last = first + BLOCKSTORE_SUMMARY_FANOUT;
+            if (last > level_sizes[l - 1])
+            {
+                last = level_sizes[l - 1];
+            }
+
+            retval =
+                blockstore_summary_hash(
+                    summary->suite, level + j * hash_size,
+                    children + first * hash_size, (last - first) * hash_size,
+                    NULL, 0);
+            if (VCTOOL_STATUS_SUCCESS != retval)
+            {
+                goto cleanup_data;
+            }
+        }
+    }
+
+    retval = blockstore_summary_layout(summary);
+    if (VCTOOL_STATUS_SUCCESS != retval)
+    {
+        goto cleanup_data;
+    }
+
+    /* persist the summary so that later comparisons skip this work. */
+    retval = blockstore_summary_write(summary);
+    if (VCTOOL_STATUS_SUCCESS != retval)
+    {
+        goto cleanup_data;
+    }
+
+    /* success. */
+    goto cleanup_map;
+
+cleanup_data:
+    free(summary->data);
+    summary->data = NULL;
+    summary->size = 0;
+
+cleanup_map:
+    file_munmap(summary->f, map, (size_t)size);
+
+    return retval;
+}
+
+/**
+ * \brief Hash one or two byte ranges with the suite hash.
+ *
+ * \param suite         The crypto suite.
+ * \param out           Buffer receiving the hash.
+ * \param first         The first range.
+ * \param first_size    The size of the first range.
+ * \param second        The second range, or NULL.
+ * \param second_size   The size of the second range.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - a non-zero error code on failure.
+ */
+static int blockstore_summary_hash(
+    vccrypt_suite_options_t* suite, uint8_t* out, const void* first,
+    size_t first_size, const void* second, size_t second_size)
+{
+    int retval;
+    vccrypt_hash_context_t hash;
+    vccrypt_buffer_t digest;
+
+    /* create a buffer for the digest. */
+    retval = vccrypt_suite_buffer_init_for_hash(suite, &digest);
+    if (VCCRYPT_STATUS_SUCCESS != retval)
+    {
+        goto done;
+    }
+
+    /* create the hash instance. */
+    retval = vccrypt_suite_hash_init(suite, &hash);
+    if (VCCRYPT_STATUS_SUCCESS != retval)
+    {
+        goto cleanup_digest;
+    }
+
+    retval = vccrypt_hash_digest(&hash, (const uint8_t*)first, first_size);
+    if (VCCRYPT_STATUS_SUCCESS != retval)
+    {
+        goto cleanup_hash;
+    }
+
+    if (second_size > 0)
+    {
+        retval =
+            vccrypt_hash_digest(&hash, (const uint8_t*)second, second_size);
+        if (VCCRYPT_STATUS_SUCCESS != retval)
+        {
+            goto cleanup_hash;
+        }
+    }
+
+    retval = vccrypt_hash_finalize(&hash, &digest);
+    if (VCCRYPT_STATUS_SUCCESS != retval)
+    {
+        goto cleanup_hash;
+    }
+
+    memcpy(out, digest.data, digest.size);
+
+    /* success. */
+    retval = VCTOOL_STATUS_SUCCESS;
+
+cleanup_hash:
+    dispose((disposable_t*)&hash);
+
+cleanup_digest:
+    dispose((disposable_t*)&digest);
+
+done:
+    return retval;
+}
+
+/**
+ * \brief Atomically replace the summary file.
+ *
+ * \param summary       The built summary.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - a non-zero error code on failure.
+ */
+static int blockstore_summary_write(blockstore_summary* summary)
+{
+    int retval, fd;
+
+    /* build the temporary filename. */
+    size_t tmp_size =
+        strlen(summary->path)
+      + 4 /* .tmp */
+      + 1;/* asciiz */
+    char* tmp = (char*)malloc(tmp_size);
+    if (NULL == tmp)
+    {
+        return VCTOOL_ERROR_GENERAL_OUT_OF_MEMORY;
+    }
+    snprintf(tmp, tmp_size, "%s.tmp", summary->path);
+
+    /* open the temporary file. */
+    retval =
+        file_open(
+            summary->f, &fd, tmp, O_CREAT | O_TRUNC | O_WRONLY,
+            S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH);
+    if (VCTOOL_STATUS_SUCCESS != retval)
+    {
+        goto cleanup_tmp;
+    }
+
+    retval = file_write_all(summary->f, fd, summary->data, summary->size);
+    if (VCTOOL_STATUS_SUCCESS != retval)
+    {
+        file_close(summary->f, fd);
+        goto cleanup_tmp;
+    }
+
+    /* close the file before replacing the summary. */
+    retval = file_close(summary->f, fd);
+    if (VCTOOL_STATUS_SUCCESS != retval)
+    {
+        goto cleanup_tmp;
+    }
+
+    /* atomically replace the summary. */
+    retval = file_rename(summary->f, tmp, summary->path);
+
+cleanup_tmp:
+    free(tmp);
+
+    return retval;
+}
+
+/**
+ * \brief Write a big endian 32-bit value.
+ *
+ * \param buf           The buffer to which the value is written.
+ * \param val           The value to write.
+ */
+static void blockstore_write_u32(uint8_t* buf, uint32_t val)
+{
+    buf[0] = (uint8_t)(val >> 24);
+    buf[1] = (uint8_t)(val >> 16);
+    buf[2] = (uint8_t)(val >> 8);
+    buf[3] = (uint8_t)val;
+}
+
+/**
+ * \brief Write a big endian 64-bit value.
+ *
+ * \param buf           The buffer to which the value is written.
+ * \param val           The value to write.
+ */
+static void blockstore_write_u64(uint8_t* buf, uint64_t val)
+{
+    for (int i = 7; i >= 0; --i)
+    {
+        buf[i] = (uint8_t)(val & 0xff);
+        val >>= 8;
+    }
+}
@@ -0,0 +1,202 @@
+/**
+ * \file blockstore/blockstore_summary_diff.c
+ *
+ * \brief Compare two segment summaries.
+ *
+ * \copyright 2020 Velo Payments.  See License.txt for license terms.
+ */
+
+#include <cbmc/model_assert.h>
+#include <string.h>
+#include <vctool/blockstore.h>
+
+/* forward decls. */
+static bool blockstore_diff_node(
+    const blockstore_summary* a, const blockstore_summary* b, uint32_t level,
+    uint64_t index, uint64_t* first);
+static const uint8_t* blockstore_summary_node(
+    const blockstore_summary* summary, uint32_t level, uint64_t index);
+static uint64_t blockstore_summary_height(
+    const blockstore_summary* summary, uint64_t index);
+
+/**
+ * \brief Find the first range of heights over which two summaries differ.
+ *
+ * The common prefix is found by descending only into nodes which differ.
+ * From the first differing record, records are matched by height until a
+ * height holds the same record in both segments, which ends the range.  A
+ * height held by only one segment is part of the range.  Records are expected
+ * in ascending height order, as a chain is appended.
+ *
+ * \param a             The first summary.
+ * \param b             The second summary, built with the same hash.
+ * \param divergence    Set to the first divergent range if the summaries
+ *                      differ.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS if the summaries are identical.
+ *      - VCTOOL_ERROR_BLOCKSTORE_DIVERGED if they differ.
+ */
+int blockstore_summary_diff(
+    const blockstore_summary* a, const blockstore_summary* b,
+    blockstore_divergence* divergence)
+{
+    uint64_t first;
+
+    /* parameter sanity checks. */
+    MODEL_ASSERT(NULL != a);
+    MODEL_ASSERT(NULL != b);
+    MODEL_ASSERT(a->hash_size == b->hash_size);
+    MODEL_ASSERT(NULL != divergence);
+
+    /* start at the node covering every record of either segment. */
+    uint32_t levels =
+        (a->level_count > b->level_count) ? a->level_count : b->level_count;
+    if (0 == levels || !blockstore_diff_node(a, b, levels - 1, 0, &first))
+    {
+        return VCTOOL_STATUS_SUCCESS;
+    }
+
+    memset(divergence, 0, sizeof(blockstore_divergence));
+    divergence->index = first;
+
+    /* the records before the first difference are the same in both, so the
+     * range starts at the lower of the two heights there. */
+    uint64_t i = first, j = first;
+    uint64_t height_a = blockstore_summary_height(a, i);
+    uint64_t height_b = blockstore_summary_height(b, j);
+    divergence->first_height = (height_a < height_b) ? height_a : height_b;
+
+    /* match records by height until both segments agree again. */
+    while (BLOCKSTORE_NO_HEIGHT != height_a
+        || BLOCKSTORE_NO_HEIGHT != height_b)
+    {
+        if (height_a == height_b)
+        {
+            if (!memcmp(
+                    a->levels[0] + i * a->hash_size,
+                    b->levels[0] + j * b->hash_size, a->hash_size))
+            {
+                divergence->converged = true;
+                break;
+            }
+
+            divergence->last_height = height_a;
+            ++divergence->count_a;
+            ++divergence->count_b;
+            height_a = blockstore_summary_height(a, ++i);
+            height_b = blockstore_summary_height(b, ++j);
+        }
+        else if (height_a < height_b)
+        {
+            divergence->last_height = height_a;
+            ++divergence->count_a;
+            height_a = blockstore_summary_height(a, ++i);
+        }
+        else
+        {
+            divergence->last_height = height_b;
+            ++divergence->count_b;
+            height_b = blockstore_summary_height(b, ++j);
+        }
+    }
+
+    return VCTOOL_ERROR_BLOCKSTORE_DIVERGED;
+}
+
+/**
+ * \brief Find the first record under one node at which two summaries differ.
+ *
+ * \param a             The first summary.
+ * \param b             The second summary.
+ * \param level         The level of the node.
+ * \param index         The index of the node in its level.
+ * \param first         Set to the position of the first differing record.
+ *
+ * \returns true if a differing record was found, and false otherwise.
+ */
+static bool blockstore_diff_node(
+    const blockstore_summary* a, const blockstore_summary* b, uint32_t level,
+    uint64_t index, uint64_t* first)
+{
+    const uint8_t* node_a = blockstore_summary_node(a, level, index);
+    const uint8_t* node_b = blockstore_summary_node(b, level, index);
+
+    /* nodes covering the same records with the same hash match. */
+    if (NULL == node_a && NULL == node_b)
+    {
+        return false;
+    }
+    else if (
+        NULL != node_a && NULL != node_b
+     && !memcmp(node_a, node_b, a->hash_size))
+    {
+        return false;
+    }
+
+    /* a differing leaf is a differing record. */
+    if (0 == level)
+    {
+        *first = index;
+        return true;
+    }
+
+    /* otherwise, the first child which differs holds the first record. */
+    for (uint64_t i = 0; i < BLOCKSTORE_SUMMARY_FANOUT; ++i)
+    {
+        if (blockstore_diff_node(
+                a, b, level - 1, index * BLOCKSTORE_SUMMARY_FANOUT + i,
+                first))
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/**
+ * \brief Get the hash of a summary node.
+ *
+ * \param summary       The summary.
+ * \param level         The level of the node.
+ * \param index         The index of the node in its level.
+ *
+ * \returns the hash, or NULL if the summary has no such node.
+ */
+static const uint8_t* blockstore_summary_node(
+    const blockstore_summary* summary, uint32_t level, uint64_t index)
+{
+    if (level >= summary->level_count || index >= summary->level_sizes[level])
+    {
+        return NULL;
+    }
+
+    return summary->levels[level] + index * summary->hash_size;
+}
+
+/**
+ * \brief Get the height of a record.
+ *
+ * \param summary       The summary.
+ * \param index         The position of the record.
+ *
+ * \returns the height, or BLOCKSTORE_NO_HEIGHT if there is no such record.
+ */
+static uint64_t blockstore_summary_height(
+    const blockstore_summary* summary, uint64_t index)
+{
+    if (index >= summary->record_count)
+    {
+        return BLOCKSTORE_NO_HEIGHT;
+    }
+
+    const uint8_t* buf = summary->heights + index * sizeof(uint64_t);
+    uint64_t val = 0;
+    for (int i = 0; i < 8; ++i)
+    {
+        val = (val << 8) | buf[i];
+    }
+
+    return val;
+}
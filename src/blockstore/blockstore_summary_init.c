@@ -0,0 +1,101 @@
+/**
+ * \file blockstore/blockstore_summary_init.c
+ *
+ * \brief Initialize a segment summary.
+ *
+ * \copyright 2020 Velo Payments.  See License.txt for license terms.
+ */
+
+#include <cbmc/model_assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vctool/blockstore.h>
+
+/* forward decls. */
+static void blockstore_summary_dispose(void* disp);
+
+/**
+ * \brief Initialize an empty summary for a segment.
+ *
+ * \param summary       The summary to initialize.
+ * \param f             The file abstraction layer to use.
+ * \param suite         The crypto suite used to hash records.
+ * \param segment_path  The path of the segment.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - VCTOOL_ERROR_GENERAL_OUT_OF_MEMORY if an allocation failed.
+ */
+int blockstore_summary_init(
+    blockstore_summary* summary, file* f, vccrypt_suite_options_t* suite,
+    const char* segment_path)
+{
+    /* parameter sanity checks. */
+    MODEL_ASSERT(NULL != summary);
+    MODEL_ASSERT(PROP_FILE_VALID(f));
+    MODEL_ASSERT(NULL != suite);
+    MODEL_ASSERT(NULL != segment_path);
+
+    /* clear the summary. */
+    memset(summary, 0, sizeof(blockstore_summary));
+
+    summary->segment_path = strdup(segment_path);
+    if (NULL == summary->segment_path)
+    {
+        goto fail;
+    }
+
+    /* the summary file sits next to the segment. */
+    size_t path_size =
+        strlen(segment_path) + strlen(BLOCKSTORE_SUMMARY_SUFFIX) + 1;
+    summary->path = (char*)malloc(path_size);
+    if (NULL == summary->path)
+    {
+        goto cleanup_segment_path;
+    }
+    snprintf(
+        summary->path, path_size, "%s%s", segment_path,
+        BLOCKSTORE_SUMMARY_SUFFIX);
+
+    summary->hdr.dispose = &blockstore_summary_dispose;
+    summary->f = f;
+    summary->suite = suite;
+    summary->hash_size = suite->hash_opts.hash_size;
+
+    /* success. */
+    return VCTOOL_STATUS_SUCCESS;
+
+cleanup_segment_path:
+    free(summary->segment_path);
+
+fail:
+    memset(summary, 0, sizeof(blockstore_summary));
+
+    return VCTOOL_ERROR_GENERAL_OUT_OF_MEMORY;
+}
+
+/**
+ * \brief Dispose of a segment summary.
+ *
+ * \param disp          The summary to dispose.
+ */
+static void blockstore_summary_dispose(void* disp)
+{
+    blockstore_summary* summary = (blockstore_summary*)disp;
+
+    if (summary->mapped)
+    {
+        file_munmap(summary->f, summary->data, summary->size);
+    }
+    else
+    {
+        free(summary->data);
+    }
+
+    free(summary->path);
+    free(summary->segment_path);
+
+    /* clear the summary. */
+    memset(summary, 0, sizeof(blockstore_summary));
+}
@@ -0,0 +1,129 @@
+/**
+ * \file blockstore/blockstore_summary_layout.c
+ *
+ * \brief Locate the levels of a segment summary.
+ *
+ * \copyright 2020 Velo Payments.  See License.txt for license terms.
+ */
+
+#include <cbmc/model_assert.h>
+#include <string.h>
+#include <vctool/blockstore.h>
+
+/* forward decls. */
+static uint32_t blockstore_read_u32(const uint8_t* buf);
+static uint64_t blockstore_read_u64(const uint8_t* buf);
+
+/**
+ * \brief Set the level pointers of a summary from its file contents.
+ *
+ * \param summary       The summary, whose data and size are set.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - VCTOOL_ERROR_BLOCKSTORE_BAD_SUMMARY if the contents are malformed
+ *        or were built with a different hash.
+ */
+int blockstore_summary_layout(blockstore_summary* summary)
+{
+    /* parameter sanity checks. */
+    MODEL_ASSERT(NULL != summary);
+    MODEL_ASSERT(NULL != summary->data);
+
+    const uint8_t* data = summary->data;
+    if (summary->size < BLOCKSTORE_SUMMARY_HEADER_SIZE
+     || memcmp(data, BLOCKSTORE_SUMMARY_MAGIC, BLOCKSTORE_SUMMARY_MAGIC_SIZE))
+    {
+        return VCTOOL_ERROR_BLOCKSTORE_BAD_SUMMARY;
+    }
+
+    uint64_t count = blockstore_read_u64(data + 16);
+    uint32_t hash_size = blockstore_read_u32(data + 24);
+    uint32_t level_count = blockstore_read_u32(data + 28);
+    if (hash_size != summary->hash_size)
+    {
+        return VCTOOL_ERROR_BLOCKSTORE_BAD_SUMMARY;
+    }
+
+    /* the record count determines every level; check that the file holds
+     * them all, without letting a bad count overflow the arithmetic. */
+    uint64_t avail = summary->size - BLOCKSTORE_SUMMARY_HEADER_SIZE;
+    if (count > avail / sizeof(uint64_t))
+    {
+        return VCTOOL_ERROR_BLOCKSTORE_BAD_SUMMARY;
+    }
+
+    summary->heights = data + BLOCKSTORE_SUMMARY_HEADER_SIZE;
+    avail -= count * sizeof(uint64_t);
+
+    const uint8_t* level = summary->heights + count * sizeof(uint64_t);
+    uint64_t level_size = count;
+    uint32_t l = 0;
+    while (level_size > 0)
+    {
+        if (l >= BLOCKSTORE_SUMMARY_MAX_LEVELS
+         || level_size > avail / hash_size)
+        {
+            return VCTOOL_ERROR_BLOCKSTORE_BAD_SUMMARY;
+        }
+
+        summary->levels[l] = level;
+        summary->level_sizes[l] = level_size;
+        level += level_size * hash_size;
+        avail -= level_size * hash_size;
+        ++l;
+
+        /* the root is the only node of the last level. */
+        if (1 == level_size)
+        {
+            break;
+        }
+
+        level_size =
+            (level_size + BLOCKSTORE_SUMMARY_FANOUT - 1)
+                / BLOCKSTORE_SUMMARY_FANOUT;
+    }
+
+    if (l != level_count || 0 != avail)
+    {
+        return VCTOOL_ERROR_BLOCKSTORE_BAD_SUMMARY;
+    }
+
+    summary->record_count = count;
+    summary->level_count = level_count;
+
+    return VCTOOL_STATUS_SUCCESS;
+}
+
+/**
+ * \brief Read a big endian 32-bit value.
+ *
+ * \param buf           The buffer from which the value is read.
+ *
+ * \returns the value.
+ */
+static uint32_t blockstore_read_u32(const uint8_t* buf)
+{
+    return
+        ((uint32_t)buf[0] << 24) | ((uint32_t)buf[1] << 16)
+      | ((uint32_t)buf[2] << 8) | (uint32_t)buf[3];
+}
+
+/**
+ * \brief Read a big endian 64-bit value.
+ *
+ * \param buf           The buffer from which the value is read.
+ *
+ * \returns the value.
+ */
+static uint64_t blockstore_read_u64(const uint8_t* buf)
+{
+    uint64_t val = 0;
+
+    for (int i = 0; i < 8; ++i)
+    {
+        val = (val << 8) | buf[i];
+    }
+
+    return val;
+}
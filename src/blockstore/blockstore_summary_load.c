@@ -0,0 +1,120 @@
+/**
+ * \file blockstore/blockstore_summary_load.c
+ *
+ * \brief Map the summary file of a segment.
+ *
+ * \copyright 2020 Velo Payments.  See License.txt for license terms.
+ */
+
+#include <cbmc/model_assert.h>
+#include <fcntl.h>
+#include <vctool/blockstore.h>
+
+/* forward decls. */
+static uint64_t blockstore_read_u64(const uint8_t* buf);
+
+/**
+ * \brief Map the summary file of a segment, if it is up to date.
+ *
+ * Segments are only ever appended to, so a summary is up to date if the
+ * segment has the size it had when the summary was built.
+ *
+ * \param summary       The summary.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - VCTOOL_ERROR_BLOCKSTORE_STALE_SUMMARY if the segment has changed
+ *        since the summary was built.
+ *      - VCTOOL_ERROR_BLOCKSTORE_BAD_SUMMARY if the summary is malformed or
+ *        was built with a different hash.
+ *      - a non-zero error code returned by the file layer.
+ */
+int blockstore_summary_load(blockstore_summary* summary)
+{
+    int retval, fd;
+    file_stat_st segment_st, summary_st;
+    void* map;
+
+    /* parameter sanity checks. */
+    MODEL_ASSERT(NULL != summary);
+    MODEL_ASSERT(NULL == summary->data);
+
+    retval = file_stat(summary->f, summary->segment_path, &segment_st);
+    if (VCTOOL_STATUS_SUCCESS != retval)
+    {
+        return retval;
+    }
+
+    retval = file_stat(summary->f, summary->path, &summary_st);
+    if (VCTOOL_STATUS_SUCCESS != retval)
+    {
+        return retval;
+    }
+
+    if ((uint64_t)summary_st.fst_size < BLOCKSTORE_SUMMARY_HEADER_SIZE)
+    {
+        return VCTOOL_ERROR_BLOCKSTORE_BAD_SUMMARY;
+    }
+
+    /* map the summary; the mapping outlives the descriptor. */
+    retval = file_open(summary->f, &fd, summary->path, O_RDONLY, 0);
+    if (VCTOOL_STATUS_SUCCESS != retval)
+    {
+        return retval;
+    }
+
+    retval =
+        file_mmap(summary->f, &map, fd, (size_t)summary_st.fst_size);
+    file_close(summary->f, fd);
+    if (VCTOOL_STATUS_SUCCESS != retval)
+    {
+        return retval;
+    }
+
+    summary->data = (uint8_t*)map;
+    summary->size = (size_t)summary_st.fst_size;
+    summary->mapped = true;
+
+    retval = blockstore_summary_layout(summary);
+    if (VCTOOL_STATUS_SUCCESS != retval)
+    {
+        goto cleanup_map;
+    }
+
+    if (blockstore_read_u64(summary->data + 8)
+            != (uint64_t)segment_st.fst_size)
+    {
+        retval = VCTOOL_ERROR_BLOCKSTORE_STALE_SUMMARY;
+        goto cleanup_map;
+    }
+
+    /* success. */
+    return VCTOOL_STATUS_SUCCESS;
+
+cleanup_map:
+    file_munmap(summary->f, map, summary->size);
+    summary->data = NULL;
+    summary->size = 0;
+    summary->mapped = false;
+
+    return retval;
+}
+
+/**
+ * \brief Read a big endian 64-bit value.
+ *
+ * \param buf           The buffer from which the value is read.
+ *
+ * \returns the value.
+ */
+static uint64_t blockstore_read_u64(const uint8_t* buf)
+{
+    uint64_t val = 0;
+
+    for (int i = 0; i < 8; ++i)
+    {
+        val = (val << 8) | buf[i];
+    }
+
+    return val;
+}
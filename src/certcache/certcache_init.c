@@ -0,0 +1,85 @@
+/**
+ * \file certcache/certcache_init.c
+ *
+ * \brief Initialize a certificate cache.
+ *
+ * \copyright 2020 Velo Payments.  See License.txt for license terms.
+ */
+
+#include <cbmc/model_assert.h>
+#include <string.h>
+#include <vctool/certcache.h>
+
+/* forward decls. */
+static void certcache_dispose(void* disp);
+
+/**
+ * \brief Initialize a certificate cache.
+ *
+ * The database is not opened until it is first used.
+ *
+ * \param cache         The cache to initialize.
+ * \param suite         The crypto suite used to hash certificates.
+ * \param path          Path to the cache database file, or NULL to create a
+ *                      disabled cache.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - a non-zero error code on failure.
+ */
+int certcache_init(
+    certcache* cache, vccrypt_suite_options_t* suite, const char* path)
+{
+    /* parameter sanity checks. */
+    MODEL_ASSERT(NULL != cache);
+    MODEL_ASSERT(NULL != suite);
+
+    /* clear the cache structure. */
+    memset(cache, 0, sizeof(certcache));
+
+    /* set the disposer and suite. */
+    cache->hdr.dispose = &certcache_dispose;
+    cache->suite = suite;
+
+    /* without a path, the cache is disabled. */
+    if (NULL == path)
+    {
+        cache->disabled = true;
+        return VCTOOL_STATUS_SUCCESS;
+    }
+
+    /* copy the path. */
+    cache->path = strdup(path);
+    if (NULL == cache->path)
+    {
+        return VCTOOL_ERROR_GENERAL_OUT_OF_MEMORY;
+    }
+
+    /* success. */
+    return VCTOOL_STATUS_SUCCESS;
+}
+
+/**
+ * \brief Dispose of a certificate cache.
+ *
+ * \param disp          The cache to dispose.
+ */
+static void certcache_dispose(void* disp)
+{
+    certcache* cache = (certcache*)disp;
+
+    /* close the environment if it was opened. */
+    if (cache->opened)
+    {
+        mdb_env_close(cache->env);
+    }
+
+    /* free the path. */
+    if (NULL != cache->path)
+    {
+        free(cache->path);
+    }
+
+    /* clear the structure. */
+    memset(cache, 0, sizeof(certcache));
+}
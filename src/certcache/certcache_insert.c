@@ -0,0 +1,100 @@
+/**
+ * \file certcache/certcache_insert.c
+ *
+ * \brief Record a verified certificate in the certificate cache.
+ *
+ * \copyright 2020 Velo Payments.  See License.txt for license terms.
+ */
+
+#include <cbmc/model_assert.h>
+#include <time.h>
+#include <vctool/certcache.h>
+
+/**
+ * \brief Record a successfully verified certificate in the cache.
+ *
+ * If a bulk loader is attached to this cache, the certificate is collected by
+ * the loader instead.
+ *
+ * \param cache         The cache to update.
+ * \param cert          The certificate bytes.
+ * \param size          The size of the certificate.
+ * \param version       The resolver context version.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - VCTOOL_ERROR_CERTCACHE_DISABLED if the cache is disabled.
+ *      - VCTOOL_ERROR_CERTCACHE_WRITE if the update failed.
+ *      - a non-zero error code on failure.
+ */
+int certcache_insert(
+    certcache* cache, const void* cert, size_t size, uint64_t version)
+{
+    int retval;
+    vccrypt_buffer_t key;
+    MDB_txn* txn;
+    MDB_val mkey, mval;
+
+    /* parameter sanity checks. */
+    MODEL_ASSERT(NULL != cache);
+    MODEL_ASSERT(NULL != cert);
+
+    /* open the cache if needed. */
+    retval = certcache_open(cache);
+    if (VCTOOL_STATUS_SUCCESS != retval)
+    {
+        goto done;
+    }
+
+    /* an attached bulk loader writes the entry later. */
+    if (NULL != cache->loader)
+    {
+        retval = certcache_loader_add(cache->loader, cert, size, version);
+        goto done;
+    }
+
+    /* compute the key for this certificate. */
+    retval = certcache_key_create(cache, &key, cert, size, version);
+    if (VCTOOL_STATUS_SUCCESS != retval)
+    {
+        goto done;
+    }
+
+    /* begin a write transaction. */
+    if (MDB_SUCCESS != mdb_txn_begin(cache->env, NULL, 0, &txn))
+    {
+        retval = VCTOOL_ERROR_CERTCACHE_WRITE;
+        goto cleanup_key;
+    }
+
+    /* the value is the time at which this certificate was verified. */
+    uint64_t verified_time = (uint64_t)time(NULL);
+    mkey.mv_size = key.size;
+    mkey.mv_data = key.data;
+    mval.mv_size = sizeof(verified_time);
+    mval.mv_data = &verified_time;
+
+    /* write the entry. */
+    if (MDB_SUCCESS != mdb_put(txn, cache->dbi, &mkey, &mval, 0))
+    {
+        mdb_txn_abort(txn);
+        retval = VCTOOL_ERROR_CERTCACHE_WRITE;
+        goto cleanup_key;
+    }
+
+    /* commit the transaction. */
+    if (MDB_SUCCESS != mdb_txn_commit(txn))
+    {
+        retval = VCTOOL_ERROR_CERTCACHE_WRITE;
+        goto cleanup_key;
+    }
+
+    /* success. */
+    retval = VCTOOL_STATUS_SUCCESS;
+
+cleanup_key:
+    dispose((disposable_t*)&key);
+
+done:
+    return retval;
+}
@@ -0,0 +1,98 @@
+/**
+ * \file certcache/certcache_key_create.c
+ *
+ * \brief Compute the cache key for a certificate.
+ *
+ * \copyright 2020 Velo Payments.  See License.txt for license terms.
+ */
+
+#include <cbmc/model_assert.h>
+#include <string.h>
+#include <vctool/certcache.h>
+
+/**
+ * \brief Compute the cache key for a certificate.
+ *
+ * The key is the suite hash of the certificate followed by the big-endian
+ * resolver context version.
+ *
+ * \param cache         The cache for this key.
+ * \param key           Buffer to be initialized with the key.  The caller owns
+ *                      this buffer on success and must dispose it.
+ * \param cert          The certificate bytes.
+ * \param size          The size of the certificate.
+ * \param version       The resolver context version.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - a non-zero error code on failure.
+ */
+int certcache_key_create(
+    certcache* cache, vccrypt_buffer_t* key, const void* cert, size_t size,
+    uint64_t version)
+{
+    int retval;
+    vccrypt_hash_context_t hash;
+    vccrypt_buffer_t digest;
+
+    /* parameter sanity checks. */
+    MODEL_ASSERT(NULL != cache);
+    MODEL_ASSERT(NULL != key);
+    MODEL_ASSERT(NULL != cert);
+
+    /* create a buffer for the digest. */
+    retval = vccrypt_suite_buffer_init_for_hash(cache->suite, &digest);
+    if (VCCRYPT_STATUS_SUCCESS != retval)
+    {
+        goto done;
+    }
+
+    /* create the hash instance. */
+    retval = vccrypt_suite_hash_init(cache->suite, &hash);
+    if (VCCRYPT_STATUS_SUCCESS != retval)
+    {
+        goto cleanup_digest;
+    }
+
+    /* hash the certificate. */
+    retval = vccrypt_hash_digest(&hash, (const uint8_t*)cert, size);
+    if (VCCRYPT_STATUS_SUCCESS != retval)
+    {
+        goto cleanup_hash;
+    }
+
+    retval = vccrypt_hash_finalize(&hash, &digest);
+    if (VCCRYPT_STATUS_SUCCESS != retval)
+    {
+        goto cleanup_hash;
+    }
+
+    /* create the key buffer. */
+    retval =
+        vccrypt_buffer_init(
+            key, cache->suite->alloc_opts, digest.size + sizeof(uint64_t));
+    if (VCCRYPT_STATUS_SUCCESS != retval)
+    {
+        goto cleanup_hash;
+    }
+
+    /* the key is the digest followed by the big-endian version. */
+    uint8_t* bkey = (uint8_t*)key->data;
+    memcpy(bkey, digest.data, digest.size);
+    for (size_t i = 0; i < sizeof(uint64_t); ++i)
+    {
+        bkey[digest.size + i] = (uint8_t)(version >> (56 - 8 * i));
+    }
+
+    /* success. */
+    retval = VCTOOL_STATUS_SUCCESS;
+
+cleanup_hash:
+    dispose((disposable_t*)&hash);
+
+cleanup_digest:
+    dispose((disposable_t*)&digest);
+
+done:
+    return retval;
+}
@@ -0,0 +1,58 @@
+/**
+ * \file certcache/certcache_loader_add.c
+ *
+ * \brief Collect a verified certificate for a bulk load.
+ *
+ * \copyright 2020 Velo Payments.  See License.txt for license terms.
+ */
+
+#include <cbmc/model_assert.h>
+#include <string.h>
+#include <time.h>
+#include <vctool/certcache.h>
+
+/**
+ * \brief Collect a successfully verified certificate for a bulk load.
+ *
+ * \param loader        The loader.
+ * \param cert          The certificate bytes.
+ * \param size          The size of the certificate.
+ * \param version       The resolver context version.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - a non-zero error code on failure.
+ */
+int certcache_loader_add(
+    certcache_loader* loader, const void* cert, size_t size, uint64_t version)
+{
+    int retval;
+    vccrypt_buffer_t key;
+
+    /* parameter sanity checks. */
+    MODEL_ASSERT(NULL != loader);
+    MODEL_ASSERT(NULL != loader->cache);
+    MODEL_ASSERT(NULL != cert);
+
+    /* compute the key for this certificate. */
+    retval = certcache_key_create(loader->cache, &key, cert, size, version);
+    if (VCTOOL_STATUS_SUCCESS != retval)
+    {
+        return retval;
+    }
+
+    MODEL_ASSERT(key.size == loader->key_size);
+
+    /* the value is the time at which this certificate was verified. */
+    uint64_t verified_time = (uint64_t)time(NULL);
+    memcpy(loader->record, key.data, loader->key_size);
+    memcpy(
+        loader->record + loader->key_size, &verified_time,
+        sizeof(verified_time));
+
+    retval = extsort_add(&loader->sorter, loader->record);
+
+    dispose((disposable_t*)&key);
+
+    return retval;
+}
@@ -0,0 +1,190 @@
+/**
+ * \file certcache/certcache_loader_finish.c
+ *
+ * \brief Write the entries collected by a certificate cache bulk loader.
+ *
+ * \copyright 2020 Velo Payments.  See License.txt for license terms.
+ */
+
+#include <cbmc/model_assert.h>
+#include <vctool/certcache.h>
+
+/**
+ * \brief The write transaction being filled by a bulk load.
+ */
+typedef struct certcache_loader_batch
+{
+    certcache_loader* loader;
+    MDB_txn* txn;
+    MDB_cursor* cursor;
+    size_t pending;
+} certcache_loader_batch;
+
+/* forward decls. */
+static int certcache_loader_batch_begin(certcache_loader_batch* batch);
+static int certcache_loader_put(void* context, const void* record);
+
+/**
+ * \brief Write the collected entries to the cache and detach the loader.
+ *
+ * Entries arrive in key order, so each is appended to the end of the database
+ * with MDB_APPEND, which skips the tree search and fills pages completely.  An
+ * entry which sorts before existing data falls back to an ordinary put.
+ * Batches are committed without syncing, and the database is synced once at
+ * the end.
+ *
+ * \param loader        The loader.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - VCTOOL_ERROR_CERTCACHE_WRITE if the database could not be updated.
+ *      - a non-zero error code on failure.
+ */
+int certcache_loader_finish(certcache_loader* loader)
+{
+    int retval;
+    certcache_loader_batch batch;
+
+    /* parameter sanity checks. */
+    MODEL_ASSERT(NULL != loader);
+    MODEL_ASSERT(NULL != loader->cache);
+
+    certcache* cache = loader->cache;
+
+    /* inserts from here on go straight to the database. */
+    if (cache->loader == loader)
+    {
+        cache->loader = NULL;
+    }
+
+    /* a crash during the load loses at most the unsynced batches. */
+    if (MDB_SUCCESS != mdb_env_set_flags(cache->env, MDB_NOSYNC, 1))
+    {
+        return VCTOOL_ERROR_CERTCACHE_WRITE;
+    }
+
+    batch.loader = loader;
+    batch.pending = 0;
+    retval = certcache_loader_batch_begin(&batch);
+    if (VCTOOL_STATUS_SUCCESS != retval)
+    {
+        goto restore_sync;
+    }
+
+    /* append every entry in key order. */
+    retval =
+        extsort_finish(&loader->sorter, &certcache_loader_put, &batch);
+    if (VCTOOL_STATUS_SUCCESS != retval)
+    {
+        /* a failed commit or begin leaves no transaction to abort. */
+        if (NULL != batch.txn)
+        {
+            mdb_txn_abort(batch.txn);
+        }
+
+        goto restore_sync;
+    }
+
+    /* commit the last batch. */
+    if (MDB_SUCCESS != mdb_txn_commit(batch.txn))
+    {
+        retval = VCTOOL_ERROR_CERTCACHE_WRITE;
+        goto restore_sync;
+    }
+
+    retval = VCTOOL_STATUS_SUCCESS;
+
+restore_sync:
+    mdb_env_set_flags(cache->env, MDB_NOSYNC, 0);
+
+    /* make the committed batches durable. */
+    if (MDB_SUCCESS != mdb_env_sync(cache->env, 1)
+     && VCTOOL_STATUS_SUCCESS == retval)
+    {
+        retval = VCTOOL_ERROR_CERTCACHE_WRITE;
+    }
+
+    return retval;
+}
+
+/**
+ * \brief Begin a bulk load write transaction.
+ *
+ * \param batch         The batch.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - VCTOOL_ERROR_CERTCACHE_WRITE if the transaction could not be started,
+ *        in which case batch->txn is NULL.
+ */
+static int certcache_loader_batch_begin(certcache_loader_batch* batch)
+{
+    certcache* cache = batch->loader->cache;
+
+    if (MDB_SUCCESS != mdb_txn_begin(cache->env, NULL, 0, &batch->txn))
+    {
+        batch->txn = NULL;
+        return VCTOOL_ERROR_CERTCACHE_WRITE;
+    }
+
+    if (MDB_SUCCESS != mdb_cursor_open(batch->txn, cache->dbi, &batch->cursor))
+    {
+        mdb_txn_abort(batch->txn);
+        batch->txn = NULL;
+        return VCTOOL_ERROR_CERTCACHE_WRITE;
+    }
+
+    return VCTOOL_STATUS_SUCCESS;
+}
+
+/**
+ * \brief Write one sorted entry, committing the batch when it is full.
+ *
+ * \param context       The batch.
+ * \param record        The sort record: key, then value.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - VCTOOL_ERROR_CERTCACHE_WRITE if the database could not be updated.
+ */
+static int certcache_loader_put(void* context, const void* record)
+{
+    certcache_loader_batch* batch = (certcache_loader_batch*)context;
+    certcache_loader* loader = batch->loader;
+    MDB_val mkey, mval;
+    int retval;
+
+    mkey.mv_size = loader->key_size;
+    mkey.mv_data = (void*)record;
+    mval.mv_size = sizeof(uint64_t);
+    mval.mv_data = (uint8_t*)record + loader->key_size;
+
+    /* MDB_APPEND refuses keys which don't sort after the last key, such as
+     * repeats or keys loaded earlier; those are put the ordinary way. */
+    retval = mdb_cursor_put(batch->cursor, &mkey, &mval, MDB_APPEND);
+    if (MDB_KEYEXIST == retval)
+    {
+        retval = mdb_cursor_put(batch->cursor, &mkey, &mval, 0);
+    }
+
+    if (MDB_SUCCESS != retval)
+    {
+        return VCTOOL_ERROR_CERTCACHE_WRITE;
+    }
+
+    /* start a new transaction once this one is full. */
+    if (++batch->pending == loader->batch_size)
+    {
+        retval = mdb_txn_commit(batch->txn);
+        batch->txn = NULL;
+        batch->pending = 0;
+        if (MDB_SUCCESS != retval)
+        {
+            return VCTOOL_ERROR_CERTCACHE_WRITE;
+        }
+
+        return certcache_loader_batch_begin(batch);
+    }
+
+    return VCTOOL_STATUS_SUCCESS;
+}
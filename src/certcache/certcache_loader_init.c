@@ -0,0 +1,112 @@
+/**
+ * \file certcache/certcache_loader_init.c
+ *
+ * \brief Attach a bulk loader to a certificate cache.
+ *
+ * \copyright 2020 Velo Payments.  See License.txt for license terms.
+ */
+
+#include <cbmc/model_assert.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vctool/certcache.h>
+
+/* forward decls. */
+static void certcache_loader_dispose(void* disp);
+
+/**
+ * \brief Attach a bulk loader to a certificate cache.
+ *
+ * \param loader        The loader to initialize.
+ * \param cache         The cache to load, which must not already have a
+ *                      loader attached.
+ * \param f             The file abstraction layer used for sort runs.
+ * \param temp_dir      The directory in which sort runs are created.
+ * \param batch_size    The number of entries committed per transaction, or 0
+ *                      for CERTCACHE_LOADER_BATCH_SIZE.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - VCTOOL_ERROR_CERTCACHE_DISABLED if the cache is disabled.
+ *      - VCTOOL_ERROR_CERTCACHE_OPEN if the database could not be opened.
+ *      - VCTOOL_ERROR_GENERAL_OUT_OF_MEMORY if an allocation failed.
+ */
+int certcache_loader_init(
+    certcache_loader* loader, certcache* cache, file* f, const char* temp_dir,
+    size_t batch_size)
+{
+    int retval;
+
+    /* parameter sanity checks. */
+    MODEL_ASSERT(NULL != loader);
+    MODEL_ASSERT(NULL != cache);
+    MODEL_ASSERT(NULL == cache->loader);
+    MODEL_ASSERT(PROP_FILE_VALID(f));
+    MODEL_ASSERT(NULL != temp_dir);
+
+    /* clear the loader. */
+    memset(loader, 0, sizeof(certcache_loader));
+
+    /* open the cache, so that a disabled cache fails up front. */
+    retval = certcache_open(cache);
+    if (VCTOOL_STATUS_SUCCESS != retval)
+    {
+        return retval;
+    }
+
+    /* a key is the certificate hash followed by the resolver version. */
+    loader->key_size = cache->suite->hash_opts.hash_size + sizeof(uint64_t);
+
+    /* sort records are the key followed by the verified time. */
+    size_t record_size = loader->key_size + sizeof(uint64_t);
+    loader->record = (uint8_t*)malloc(record_size);
+    if (NULL == loader->record)
+    {
+        return VCTOOL_ERROR_GENERAL_OUT_OF_MEMORY;
+    }
+
+    retval =
+        extsort_init(
+            &loader->sorter, f, temp_dir, record_size, loader->key_size,
+            CERTCACHE_LOADER_SORT_BUDGET, 0);
+    if (VCTOOL_STATUS_SUCCESS != retval)
+    {
+        free(loader->record);
+        loader->record = NULL;
+        return retval;
+    }
+
+    loader->hdr.dispose = &certcache_loader_dispose;
+    loader->cache = cache;
+    loader->batch_size =
+        (0 == batch_size) ? CERTCACHE_LOADER_BATCH_SIZE : batch_size;
+
+    /* route inserts to this loader. */
+    cache->loader = loader;
+
+    /* success. */
+    return VCTOOL_STATUS_SUCCESS;
+}
+
+/**
+ * \brief Dispose of a bulk loader, detaching it from its cache.
+ *
+ * Entries which were not written by certcache_loader_finish are discarded.
+ *
+ * \param disp          The loader to dispose.
+ */
+static void certcache_loader_dispose(void* disp)
+{
+    certcache_loader* loader = (certcache_loader*)disp;
+
+    if (loader->cache->loader == loader)
+    {
+        loader->cache->loader = NULL;
+    }
+
+    dispose((disposable_t*)&loader->sorter);
+    free(loader->record);
+
+    /* clear the loader. */
+    memset(loader, 0, sizeof(certcache_loader));
+}
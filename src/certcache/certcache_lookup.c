@@ -0,0 +1,91 @@
+/**
+ * \file certcache/certcache_lookup.c
+ *
+ * \brief Look up a certificate in the certificate cache.
+ *
+ * \copyright 2020 Velo Payments.  See License.txt for license terms.
+ */
+
+#include <cbmc/model_assert.h>
+#include <vctool/certcache.h>
+
+/**
+ * \brief Look up a certificate in the cache.
+ *
+ * \param cache         The cache to search.
+ * \param cert          The certificate bytes.
+ * \param size          The size of the certificate.
+ * \param version       The resolver context version.
+ * \param found         Set to true if this certificate was verified under this
+ *                      resolver context version, false otherwise.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - VCTOOL_ERROR_CERTCACHE_DISABLED if the cache is disabled.
+ *      - VCTOOL_ERROR_CERTCACHE_READ if the lookup failed.
+ *      - a non-zero error code on failure.
+ */
+int certcache_lookup(
+    certcache* cache, const void* cert, size_t size, uint64_t version,
+    bool* found)
+{
+    int retval;
+    vccrypt_buffer_t key;
+    MDB_txn* txn;
+    MDB_val mkey, mval;
+
+    /* parameter sanity checks. */
+    MODEL_ASSERT(NULL != cache);
+    MODEL_ASSERT(NULL != cert);
+    MODEL_ASSERT(NULL != found);
+
+    /* not found, unless proven otherwise. */
+    *found = false;
+
+    /* open the cache if needed. */
+    retval = certcache_open(cache);
+    if (VCTOOL_STATUS_SUCCESS != retval)
+    {
+        goto done;
+    }
+
+    /* compute the key for this certificate. */
+    retval = certcache_key_create(cache, &key, cert, size, version);
+    if (VCTOOL_STATUS_SUCCESS != retval)
+    {
+        goto done;
+    }
+
+    /* begin a read transaction. */
+    if (MDB_SUCCESS != mdb_txn_begin(cache->env, NULL, MDB_RDONLY, &txn))
+    {
+        retval = VCTOOL_ERROR_CERTCACHE_READ;
+        goto cleanup_key;
+    }
+
+    /* look up the key. */
+    mkey.mv_size = key.size;
+    mkey.mv_data = key.data;
+    retval = mdb_get(txn, cache->dbi, &mkey, &mval);
+    if (MDB_SUCCESS == retval)
+    {
+        *found = true;
+        retval = VCTOOL_STATUS_SUCCESS;
+    }
+    else if (MDB_NOTFOUND == retval)
+    {
+        retval = VCTOOL_STATUS_SUCCESS;
+    }
+    else
+    {
+        retval = VCTOOL_ERROR_CERTCACHE_READ;
+    }
+
+    mdb_txn_abort(txn);
+
+cleanup_key:
+    dispose((disposable_t*)&key);
+
+done:
+    return retval;
+}
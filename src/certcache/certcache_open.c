@@ -0,0 +1,102 @@
+/**
+ * \file certcache/certcache_open.c
+ *
+ * \brief Open the certificate cache database.
+ *
+ * \copyright 2020 Velo Payments.  See License.txt for license terms.
+ */
+
+#include <cbmc/model_assert.h>
+#include <stdio.h>
+#include <vctool/certcache.h>
+
+/**
+ * \brief Open the cache database, if it is not already open.
+ *
+ * If the database can't be opened, the cache is disabled for the remainder of
+ * this run.
+ *
+ * \param cache         The cache to open.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - VCTOOL_ERROR_CERTCACHE_DISABLED if the cache is disabled.
+ *      - VCTOOL_ERROR_CERTCACHE_OPEN if the database could not be opened.
+ */
+int certcache_open(certcache* cache)
+{
+    int retval;
+    MDB_txn* txn;
+
+    /* parameter sanity checks. */
+    MODEL_ASSERT(NULL != cache);
+
+    /* nothing to do if the cache is disabled or already open. */
+    if (cache->disabled)
+    {
+        return VCTOOL_ERROR_CERTCACHE_DISABLED;
+    }
+    else if (cache->opened)
+    {
+        return VCTOOL_STATUS_SUCCESS;
+    }
+
+    /* create the environment. */
+    retval = mdb_env_create(&cache->env);
+    if (MDB_SUCCESS != retval)
+    {
+        goto disable_cache;
+    }
+
+    /* set the map size. */
+    retval = mdb_env_set_mapsize(cache->env, CERTCACHE_MAP_SIZE);
+    if (MDB_SUCCESS != retval)
+    {
+        goto close_env;
+    }
+
+    /* open the environment as a single file readable only by this user. */
+    retval =
+        mdb_env_open(
+            cache->env, cache->path, MDB_NOSUBDIR | MDB_NOTLS, 0600);
+    if (MDB_SUCCESS != retval)
+    {
+        goto close_env;
+    }
+
+    /* open the unnamed database. */
+    retval = mdb_txn_begin(cache->env, NULL, 0, &txn);
+    if (MDB_SUCCESS != retval)
+    {
+        goto close_env;
+    }
+
+    retval = mdb_dbi_open(txn, NULL, 0, &cache->dbi);
+    if (MDB_SUCCESS != retval)
+    {
+        mdb_txn_abort(txn);
+        goto close_env;
+    }
+
+    retval = mdb_txn_commit(txn);
+    if (MDB_SUCCESS != retval)
+    {
+        goto close_env;
+    }
+
+    /* success. */
+    cache->opened = true;
+    return VCTOOL_STATUS_SUCCESS;
+
+close_env:
+    mdb_env_close(cache->env);
+    cache->env = NULL;
+
+disable_cache:
+    fprintf(
+        stderr, "Warning: certificate cache %s unavailable: %s\n",
+        cache->path, mdb_strerror(retval));
+    cache->disabled = true;
+
+    return VCTOOL_ERROR_CERTCACHE_OPEN;
+}
@@ -0,0 +1,40 @@
+/**
+ * \file certcache/certcache_version_mix.c
+ *
+ * \brief Mix resolver context data into a resolver version.
+ *
+ * \copyright 2020 Velo Payments.  See License.txt for license terms.
+ */
+
+#include <cbmc/model_assert.h>
+#include <vctool/certcache.h>
+
+/* the 64-bit FNV prime. */
+#define CERTCACHE_FNV_PRIME                         0x00000100000001b3UL
+
+/**
+ * \brief Mix resolver context data into a resolver version.
+ *
+ * Anything that changes the outcome of attestation (contract plugins, key
+ * sources, revocation lists) must be mixed into the resolver version, so that
+ * cached results from a different context are not reused.
+ *
+ * \param version       The version to update.
+ * \param data          The data to mix into the version.
+ * \param size          The size of the data.
+ */
+void certcache_version_mix(uint64_t* version, const void* data, size_t size)
+{
+    const uint8_t* bdata = (const uint8_t*)data;
+
+    /* parameter sanity checks. */
+    MODEL_ASSERT(NULL != version);
+    MODEL_ASSERT(NULL != data);
+
+    /* FNV-1a over the data. */
+    for (size_t i = 0; i < size; ++i)
+    {
+        *version ^= bdata[i];
+        *version *= CERTCACHE_FNV_PRIME;
+    }
+}
@@ -0,0 +1,89 @@
+/**
+ * \file certificate/certificate_attest.c
+ *
+ * \brief Attest a certificate, using the certificate cache.
+ *
+ * \copyright 2020 Velo Payments.  See License.txt for license terms.
+ */
+
+#include <cbmc/model_assert.h>
+#include <vctool/certcache.h>
+#include <vctool/certificate.h>
+
+/**
+ * \brief Attest a certificate, consulting the certificate cache first.
+ *
+ * If this certificate was already verified at this height under the current
+ * resolver version, the signature check is skipped.  Otherwise, the
+ * certificate is attested and, on success, recorded in the cache.  The height
+ * is part of the key, since a certificate valid at one height need not be
+ * valid at another.
+ *
+ * \param opts              The command-line options to use.
+ * \param parser_options    The parser options, including resolvers, to use
+ *                          for attestation.
+ * \param cert              The certificate to attest.
+ * \param height            The block height at which to attest.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - a non-zero error code on failure.
+ */
+int certificate_attest(
+    commandline_opts* opts, vccert_parser_options_t* parser_options,
+    const vccrypt_buffer_t* cert, uint64_t height)
+{
+    int retval;
+    bool cached = false;
+    vccert_parser_context_t parser;
+    uint8_t height_bytes[8];
+
+    /* parameter sanity checks. */
+    MODEL_ASSERT(PROP_VALID_COMMANDLINE_OPTS(opts));
+    MODEL_ASSERT(NULL != parser_options);
+    MODEL_ASSERT(NULL != cert);
+
+    /* the result holds for this height alone. */
+    uint64_t version = opts->resolver_version;
+    for (int i = 0; i < 8; ++i)
+    {
+        height_bytes[i] = (uint8_t)(height >> (56 - 8 * i));
+    }
+    certcache_version_mix(&version, height_bytes, sizeof(height_bytes));
+
+    /* consult the cache.  A cache failure only means we verify the hard way. */
+    retval =
+        certcache_lookup(
+            &opts->certcache, cert->data, cert->size, version, &cached);
+    if (VCTOOL_STATUS_SUCCESS == retval && cached)
+    {
+        return VCTOOL_STATUS_SUCCESS;
+    }
+
+    /* create a parser for this certificate. */
+    retval =
+        vccert_parser_init(parser_options, &parser, cert->data, cert->size);
+    if (VCCERT_STATUS_SUCCESS != retval)
+    {
+        goto done;
+    }
+
+    /* attest the certificate, including its contract. */
+    retval = vccert_parser_attest(&parser, height, true);
+    if (VCCERT_STATUS_SUCCESS != retval)
+    {
+        goto cleanup_parser;
+    }
+
+    /* remember this result.  Failing to cache is not a verification error. */
+    certcache_insert(&opts->certcache, cert->data, cert->size, version);
+
+    /* success. */
+    retval = VCTOOL_STATUS_SUCCESS;
+
+cleanup_parser:
+    dispose((disposable_t*)&parser);
+
+done:
+    return retval;
+}
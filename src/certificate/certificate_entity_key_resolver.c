@@ -0,0 +1,94 @@
+/**
+ * \file certificate/certificate_entity_key_resolver.c
+ *
+ * \brief Entity key resolver for certificate parser options.
+ *
+ * \copyright 2020 Velo Payments.  See License.txt for license terms.
+ */
+
+#include <cbmc/model_assert.h>
+#include <string.h>
+#include <vctool/certificate.h>
+#include <vctool/revocation.h>
+#include <vpr/parameters.h>
+
+/**
+ * \brief Entity key resolver for certificate parser options.
+ *
+ * The parser options context must be the commandline_opts for this command.
+ * Only the entities trusted on the command line resolve.  Revoked entities
+ * never resolve, so every certificate signed by a revoked entity fails
+ * attestation.
+ *
+ * \param options           The parser options.
+ * \param parser            The parser for the certificate being attested.
+ * \param height            The block height of the certificate.
+ * \param entity_id         The entity id to resolve.
+ * \param pubenckey_buffer  Buffer to receive the public encryption key.
+ * \param pubsignkey_buffer Buffer to receive the public signing key.
+ *
+ * \returns true if the entity keys were resolved, and false otherwise.
+ */
+bool certificate_entity_key_resolver(
+    void* options, void* UNUSED(parser), uint64_t UNUSED(height),
+    const uint8_t* entity_id, vccrypt_buffer_t* pubenckey_buffer,
+    vccrypt_buffer_t* pubsignkey_buffer)
+{
+    vccert_parser_options_t* parser_options =
+        (vccert_parser_options_t*)options;
+
+    /* parameter sanity checks. */
+    MODEL_ASSERT(NULL != parser_options);
+    MODEL_ASSERT(NULL != entity_id);
+    MODEL_ASSERT(NULL != pubenckey_buffer);
+    MODEL_ASSERT(NULL != pubsignkey_buffer);
+
+    commandline_opts* opts = (commandline_opts*)parser_options->context;
+    MODEL_ASSERT(PROP_VALID_COMMANDLINE_OPTS(opts));
+
+    /* a revoked entity has no valid keys. */
+    if (NULL != opts->revocations
+     && revocation_set_contains(opts->revocations, entity_id))
+    {
+        return false;
+    }
+
+    /* find the entity among the trusted entities. */
+    const commandline_entity* entity = opts->entities;
+    while (NULL != entity && memcmp(entity->id, entity_id, sizeof(entity->id)))
+    {
+        entity = entity->next;
+    }
+
+    if (NULL == entity)
+    {
+        return false;
+    }
+
+    /* the parser owns copies of the keys. */
+    if (VCCRYPT_STATUS_SUCCESS !=
+            vccrypt_buffer_init(
+                pubenckey_buffer, opts->suite->alloc_opts,
+                entity->encryption_pubkey.size))
+    {
+        return false;
+    }
+
+    if (VCCRYPT_STATUS_SUCCESS !=
+            vccrypt_buffer_init(
+                pubsignkey_buffer, opts->suite->alloc_opts,
+                entity->signing_pubkey.size))
+    {
+        dispose((disposable_t*)pubenckey_buffer);
+        return false;
+    }
+
+    memcpy(
+        pubenckey_buffer->data, entity->encryption_pubkey.data,
+        pubenckey_buffer->size);
+    memcpy(
+        pubsignkey_buffer->data, entity->signing_pubkey.data,
+        pubsignkey_buffer->size);
+
+    return true;
+}
@@ -0,0 +1,255 @@
+/**
+ * \file certificate/certificate_keypair_load.c
+ *
+ * \brief Read a private entity keypair certificate.
+ *
+ * \copyright 2020 Velo Payments.  See License.txt for license terms.
+ */
+
+#include <cbmc/model_assert.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vccert/certificate_types.h>
+#include <vccrypt/compare.h>
+#include <vctool/certificate.h>
+#include <vctool/certstore.h>
+#include <vctool/certschema.h>
+#include <vctool/readpassword.h>
+
+/* forward decls. */
+static int certificate_keypair_path(
+    commandline_opts* opts, char** path, const char* key_filename);
+
+/**
+ * \brief Read a private entity keypair certificate, decrypting it if needed.
+ *
+ * With a certificate store, key_filename names a reference list in the store
+ * instead of a file.  The file must be accessible to its owner alone.  If it
+ * is encrypted, the passphrase is read with a prompt on standard error, so
+ * that standard output stays free for results.  The certificate is checked
+ * against the private entity schema before it is returned.  Errors are
+ * reported on standard error.
+ *
+ * \param opts              The command-line options to use.
+ * \param keypair           Pointer to the pointer to receive an allocated
+ *                          vccrypt_buffer_t instance holding the decrypted
+ *                          keypair certificate on function success.
+ * \param key_filename      The keypair certificate file.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - VCTOOL_ERROR_CERTIFICATE_BAD_PERMISSIONS if others than the owner
+ *        may access the file.
+ *      - VCTOOL_ERROR_FILE_IO if the file could not be read.
+ *      - VCTOOL_ERROR_CERTSTORE_BAD_REF if the name in the store does not
+ *        refer to exactly one certificate.
+ *      - VCTOOL_ERROR_CERTSCHEMA_UNKNOWN_TYPE if the certificate is valid but
+ *        is not a private entity keypair.
+ *      - a non-zero error code returned by certschema_validate, or on
+ *        failure.
+ */
+int certificate_keypair_load(
+    commandline_opts* opts, vccrypt_buffer_t** keypair,
+    const char* key_filename)
+{
+    int retval, fd;
+    char* key_path;
+    file_stat_st fst;
+    vccrypt_buffer_t password_buffer;
+    vccrypt_buffer_t* cert;
+    const certschema_type* type;
+    uint16_t field;
+
+    /* parameter sanity checks. */
+    MODEL_ASSERT(PROP_VALID_COMMANDLINE_OPTS(opts));
+    MODEL_ASSERT(NULL != keypair);
+    MODEL_ASSERT(NULL != key_filename);
+
+    retval = certificate_keypair_path(opts, &key_path, key_filename);
+    if (VCTOOL_STATUS_SUCCESS != retval)
+    {
+        fprintf(stderr, "Error finding key %s.\n", key_filename);
+        goto done;
+    }
+
+    /* the keypair must be accessible to its owner alone. */
+    retval = file_stat(opts->file, key_path, &fst);
+    if (VCTOOL_STATUS_SUCCESS != retval)
+    {
+        fprintf(stderr, "Missing key file %s.\n", key_filename);
+        goto free_key_path;
+    }
+
+    mode_t bad_bits = S_ISUID | S_ISGID | S_ISVTX | S_IRWXG | S_IRWXO;
+    if (fst.fst_mode & bad_bits)
+    {
+        retval = VCTOOL_ERROR_CERTIFICATE_BAD_PERMISSIONS;
+        fprintf(
+            stderr, "Only user permissions allowed for %s.\n", key_filename);
+        goto free_key_path;
+    }
+
+    /* allocate space for the certificate. */
+    cert = (vccrypt_buffer_t*)malloc(sizeof(vccrypt_buffer_t));
+    if (NULL == cert)
+    {
+        retval = VCTOOL_ERROR_GENERAL_OUT_OF_MEMORY;
+        goto free_key_path;
+    }
+
+    retval = vccrypt_buffer_init(cert, opts->suite->alloc_opts, fst.fst_size);
+    if (VCCRYPT_STATUS_SUCCESS != retval)
+    {
+        goto free_cert;
+    }
+
+    retval = file_open(opts->file, &fd, key_path, O_RDONLY, 0);
+    if (VCTOOL_STATUS_SUCCESS != retval)
+    {
+        fprintf(stderr, "Error opening file %s for read.\n", key_filename);
+        goto cleanup_cert;
+    }
+
+    size_t read_bytes;
+    retval = file_read(opts->file, fd, cert->data, cert->size, &read_bytes);
+    file_close(opts->file, fd);
+    if (VCTOOL_STATUS_SUCCESS != retval || read_bytes != cert->size)
+    {
+        retval = VCTOOL_ERROR_FILE_IO;
+        fprintf(stderr, "Error reading from %s.\n", key_filename);
+        goto cleanup_cert;
+    }
+
+    /* an encrypted keypair is replaced by its decryption. */
+    if (cert->size > ENCRYPTED_CERT_MAGIC_SIZE
+     && !crypto_memcmp(
+            cert->data, ENCRYPTED_CERT_MAGIC_STRING,
+            ENCRYPTED_CERT_MAGIC_SIZE))
+    {
+        vccrypt_buffer_t* decrypted_cert;
+
+        fprintf(stderr, "Enter passphrase: ");
+        fflush(stderr);
+        retval = readpassword(opts, &password_buffer);
+        fprintf(stderr, "\n");
+        if (VCTOOL_STATUS_SUCCESS != retval)
+        {
+            goto cleanup_cert;
+        }
+
+        retval =
+            certificate_decrypt(opts, &decrypted_cert, cert, &password_buffer);
+        dispose((disposable_t*)&password_buffer);
+        if (VCTOOL_STATUS_SUCCESS != retval)
+        {
+            fprintf(stderr, "Error decrypting %s.\n", key_filename);
+            goto cleanup_cert;
+        }
+
+        dispose((disposable_t*)cert);
+        free(cert);
+        cert = decrypted_cert;
+    }
+
+    /* check the fields of the cert before trusting any of them. */
+    retval =
+        certschema_validate(
+            &opts->contracts.schema, (const uint8_t*)cert->data, cert->size,
+            &type, &field);
+    if (VCTOOL_STATUS_SUCCESS == retval
+     && memcmp(
+            type->type, vccert_certificate_type_uuid_private_entity,
+            UUID_SIZE))
+    {
+        retval = VCTOOL_ERROR_CERTSCHEMA_UNKNOWN_TYPE;
+    }
+
+    if (VCTOOL_STATUS_SUCCESS != retval)
+    {
+        fprintf(stderr, "%s is not a valid keypair.\n", key_filename);
+        goto cleanup_cert;
+    }
+
+    /* success.  The caller owns the certificate. */
+    *keypair = cert;
+    retval = VCTOOL_STATUS_SUCCESS;
+    goto free_key_path;
+
+cleanup_cert:
+    dispose((disposable_t*)cert);
+
+free_cert:
+    free(cert);
+
+free_key_path:
+    free(key_path);
+
+done:
+    return retval;
+}
+
+/**
+ * \brief Find the file holding a keypair.
+ *
+ * \param opts              The command-line options to use.
+ * \param path              Pointer to receive the path, which the caller must
+ *                          free.
+ * \param key_filename      The keypair file, or its name in the store.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - VCTOOL_ERROR_CERTSTORE_BAD_REF if the name does not refer to exactly
+ *        one certificate.
+ *      - a non-zero error code on failure.
+ */
+static int certificate_keypair_path(
+    commandline_opts* opts, char** path, const char* key_filename)
+{
+    int retval;
+    certstore store;
+    vccrypt_buffer_t hashes;
+
+    /* without a store, the name is the file. */
+    if (NULL == opts->store_path)
+    {
+        *path = strdup(key_filename);
+        return
+            (NULL == *path)
+                ? VCTOOL_ERROR_GENERAL_OUT_OF_MEMORY : VCTOOL_STATUS_SUCCESS;
+    }
+
+    retval =
+        certstore_init(&store, opts->file, opts->suite, opts->store_path);
+    if (VCTOOL_STATUS_SUCCESS != retval)
+    {
+        return retval;
+    }
+
+    const char* name = strrchr(key_filename, '/');
+    name = (NULL == name) ? key_filename : name + 1;
+
+    retval = certstore_ref_read(&store, &hashes, name);
+    if (VCTOOL_STATUS_SUCCESS != retval)
+    {
+        goto cleanup_store;
+    }
+
+    /* a keypair name refers to a single certificate. */
+    if (hashes.size != store.hash_size)
+    {
+        retval = VCTOOL_ERROR_CERTSTORE_BAD_REF;
+        goto cleanup_hashes;
+    }
+
+    retval = certstore_object_path(&store, path, (const uint8_t*)hashes.data);
+
+cleanup_hashes:
+    dispose((disposable_t*)&hashes);
+
+cleanup_store:
+    dispose((disposable_t*)&store);
+
+    return retval;
+}
@@ -0,0 +1,160 @@
+/**
+ * \file certificate/certificate_output_write.c
+ *
+ * \brief Write a generated certificate to a new file or to the store.
+ *
+ * \copyright 2020 Velo Payments.  See License.txt for license terms.
+ */
+
+#include <cbmc/model_assert.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vctool/certificate.h>
+#include <vctool/certstore.h>
+
+/* forward decls. */
+static int certificate_output_store(
+    commandline_opts* opts, const char* name, const vccrypt_buffer_t* cert,
+    mode_t mode);
+
+/**
+ * \brief Write a generated certificate, never replacing an existing one.
+ *
+ * Without a certificate store, the certificate is written to a new file.
+ * With one, it is added to the store, and the reference list named by the
+ * last component of output_filename is created to point at it.  Errors are
+ * reported on standard error.
+ *
+ * \param opts              The command-line options to use.
+ * \param output_filename   The output file, or reference name.
+ * \param cert              The certificate to write.
+ * \param mode              The permissions of the file; a stored object gets
+ *                          the read permissions alone.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - VCTOOL_ERROR_FILE_EXISTS if the output already exists.
+ *      - a non-zero error code on failure.
+ */
+int certificate_output_write(
+    commandline_opts* opts, const char* output_filename,
+    const vccrypt_buffer_t* cert, mode_t mode)
+{
+    int retval, fd;
+
+    /* parameter sanity checks. */
+    MODEL_ASSERT(PROP_VALID_COMMANDLINE_OPTS(opts));
+    MODEL_ASSERT(NULL != output_filename);
+    MODEL_ASSERT(NULL != cert);
+
+    if (NULL != opts->store_path)
+    {
+        const char* name = strrchr(output_filename, '/');
+        name = (NULL == name) ? output_filename : name + 1;
+
+        return certificate_output_store(opts, name, cert, mode);
+    }
+
+    retval =
+        file_open(
+            opts->file, &fd, output_filename, O_CREAT | O_EXCL | O_WRONLY,
+            mode);
+    if (VCTOOL_ERROR_FILE_EXISTS == retval)
+    {
+        fprintf(
+            stderr, "Won't clobber existing file %s.  Stopping.\n",
+            output_filename);
+        return retval;
+    }
+    else if (VCTOOL_STATUS_SUCCESS != retval)
+    {
+        fprintf(stderr, "Error opening output file %s.\n", output_filename);
+        return retval;
+    }
+
+    retval = file_write_all(opts->file, fd, cert->data, cert->size);
+    if (VCTOOL_STATUS_SUCCESS != retval)
+    {
+        fprintf(stderr, "Error writing output file %s.\n", output_filename);
+    }
+
+    file_close(opts->file, fd);
+
+    return retval;
+}
+
+/**
+ * \brief Add a certificate to the store under a new reference list.
+ *
+ * \param opts              The command-line options to use.
+ * \param name              The reference name.
+ * \param cert              The certificate to store.
+ * \param mode              The permissions of the certificate.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - VCTOOL_ERROR_FILE_EXISTS if the reference list already exists.
+ *      - a non-zero error code on failure.
+ */
+static int certificate_output_store(
+    commandline_opts* opts, const char* name, const vccrypt_buffer_t* cert,
+    mode_t mode)
+{
+    int retval;
+    certstore store;
+    vccrypt_buffer_t hashes;
+
+    retval =
+        certstore_init(&store, opts->file, opts->suite, opts->store_path);
+    if (VCTOOL_STATUS_SUCCESS != retval)
+    {
+        fprintf(stderr, "Error opening store %s.\n", opts->store_path);
+        return retval;
+    }
+
+    /* an existing name is never repointed. */
+    retval = certstore_ref_read(&store, &hashes, name);
+    if (VCTOOL_STATUS_SUCCESS == retval)
+    {
+        dispose((disposable_t*)&hashes);
+        retval = VCTOOL_ERROR_FILE_EXISTS;
+        fprintf(stderr, "Won't clobber existing name %s.  Stopping.\n", name);
+        goto cleanup_store;
+    }
+    else if (VCTOOL_ERROR_FILE_NO_ENTRY != retval)
+    {
+        fprintf(stderr, "Error reading name %s from store.\n", name);
+        goto cleanup_store;
+    }
+
+    uint8_t* hash = (uint8_t*)malloc(store.hash_size);
+    if (NULL == hash)
+    {
+        retval = VCTOOL_ERROR_GENERAL_OUT_OF_MEMORY;
+        goto cleanup_store;
+    }
+
+    retval = certstore_put(&store, hash, cert->data, cert->size, mode);
+    if (VCTOOL_STATUS_SUCCESS != retval)
+    {
+        fprintf(stderr, "Error adding %s to store.\n", name);
+        goto free_hash;
+    }
+
+    retval = certstore_ref_write(&store, name, hash, 1);
+    if (VCTOOL_STATUS_SUCCESS != retval)
+    {
+        fprintf(stderr, "Error writing name %s to store.\n", name);
+        goto free_hash;
+    }
+
+free_hash:
+    free(hash);
+
+cleanup_store:
+    dispose((disposable_t*)&store);
+
+    return retval;
+}
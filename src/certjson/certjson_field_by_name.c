@@ -0,0 +1,46 @@
+/**
+ * \file certjson/certjson_field_by_name.c
+ *
+ * \brief Look up a field type by name.
+ *
+ * \copyright 2020 Velo Payments.  See License.txt for license terms.
+ */
+
+#include <cbmc/model_assert.h>
+#include <string.h>
+#include <vctool/certjson.h>
+
+/**
+ * \brief Look up a field type by name.
+ *
+ * The name is hashed with FNV-1a, starting from CERTJSON_NAME_SEED, and the
+ * top bits of the hash pick its slot; the name in that slot is the only one
+ * it can be.
+ *
+ * \param name          The name, which need not be NUL-terminated.
+ * \param length        The length of the name.
+ *
+ * \returns the field, or NULL if no field type has this name.
+ */
+const certjson_field* certjson_field_by_name(const char* name, size_t length)
+{
+    /* parameter sanity checks. */
+    MODEL_ASSERT(0 == length || NULL != name);
+
+    uint32_t hash = CERTJSON_NAME_SEED;
+    for (size_t i = 0; i < length; ++i)
+    {
+        hash = (hash ^ (uint8_t)name[i]) * 0x01000193U;
+    }
+
+    /* the top five bits pick one of the CERTJSON_FIELD_SLOTS slots. */
+    const certjson_field* field = certjson_fields + (hash >> 27);
+    if (NULL == field->name
+     || field->length != length
+     || memcmp(field->name, name, length))
+    {
+        return NULL;
+    }
+
+    return field;
+}
@@ -0,0 +1,87 @@
+/**
+ * \file certjson/certjson_field_by_type.c
+ *
+ * \brief Look up the name of a field type.
+ *
+ * \copyright 2020 Velo Payments.  See License.txt for license terms.
+ */
+
+#include <stddef.h>
+#include <vccert/fields.h>
+#include <vctool/certjson.h>
+
+/**
+ * \brief Look up the name of a field type.
+ *
+ * The switch leaves it to the compiler to find the slot of each type, with a
+ * jump table over the dense ranges of field types.
+ *
+ * \param type          The field type.
+ *
+ * \returns the field, or NULL if the field type has no name.
+ */
+const certjson_field* certjson_field_by_type(uint16_t type)
+{
+    switch (type)
+    {
+        case VCCERT_FIELD_TYPE_ARTIFACT_ID:
+            return certjson_fields + 15;
+
+        case VCCERT_FIELD_TYPE_ARTIFACT_TYPE:
+            return certjson_fields + 24;
+
+        case VCCERT_FIELD_TYPE_BLOCK_HEIGHT:
+            return certjson_fields + 20;
+
+        case VCCERT_FIELD_TYPE_CERTIFICATE_CRYPTO_SUITE:
+            return certjson_fields + 22;
+
+        case VCCERT_FIELD_TYPE_CERTIFICATE_ID:
+            return certjson_fields + 30;
+
+        case VCCERT_FIELD_TYPE_CERTIFICATE_TYPE:
+            return certjson_fields + 4;
+
+        case VCCERT_FIELD_TYPE_CERTIFICATE_VALID_FROM:
+            return certjson_fields + 11;
+
+        case VCCERT_FIELD_TYPE_CERTIFICATE_VALID_TO:
+            return certjson_fields + 26;
+
+        case VCCERT_FIELD_TYPE_CERTIFICATE_VERSION:
+            return certjson_fields + 5;
+
+        case VCCERT_FIELD_TYPE_NEW_ARTIFACT_STATE:
+            return certjson_fields + 23;
+
+        case VCCERT_FIELD_TYPE_PREVIOUS_ARTIFACT_STATE:
+            return certjson_fields + 29;
+
+        case VCCERT_FIELD_TYPE_PREVIOUS_CERTIFICATE_ID:
+            return certjson_fields + 25;
+
+        case VCCERT_FIELD_TYPE_PRIVATE_ENCRYPTION_KEY:
+            return certjson_fields + 12;
+
+        case VCCERT_FIELD_TYPE_PRIVATE_SIGNING_KEY:
+            return certjson_fields + 28;
+
+        case VCCERT_FIELD_TYPE_PUBLIC_ENCRYPTION_KEY:
+            return certjson_fields + 14;
+
+        case VCCERT_FIELD_TYPE_PUBLIC_SIGNING_KEY:
+            return certjson_fields + 2;
+
+        case VCCERT_FIELD_TYPE_SIGNATURE:
+            return certjson_fields + 17;
+
+        case VCCERT_FIELD_TYPE_SIGNER_ID:
+            return certjson_fields + 31;
+
+        case VCCERT_FIELD_TYPE_WRAPPED_TRANSACTION_TUPLE:
+            return certjson_fields + 18;
+
+        default:
+            return NULL;
+    }
+}
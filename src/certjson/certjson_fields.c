@@ -0,0 +1,69 @@
+/**
+ * \file certjson/certjson_fields.c
+ *
+ * \brief The field name table.
+ *
+ * \copyright 2020 Velo Payments.  See License.txt for license terms.
+ */
+
+#include <vccert/fields.h>
+#include <vctool/certjson.h>
+
+/* a field entry, with the length of its name. */
+#define CERTJSON_FIELD(name, type, uuid) \
+    { name, sizeof(name) - 1, type, uuid }
+
+/**
+ * \brief The field name table.
+ *
+ * Each name sits in the slot given by certjson_field_by_name's hash of it,
+ * with CERTJSON_NAME_SEED; a new name needs a seed under which every name
+ * still has a slot of its own.
+ */
+const certjson_field certjson_fields[CERTJSON_FIELD_SLOTS] = {
+    [2] = CERTJSON_FIELD(
+        "public_signing_key", VCCERT_FIELD_TYPE_PUBLIC_SIGNING_KEY, false),
+    [4] = CERTJSON_FIELD(
+        "certificate_type", VCCERT_FIELD_TYPE_CERTIFICATE_TYPE, true),
+    [5] = CERTJSON_FIELD(
+        "certificate_version", VCCERT_FIELD_TYPE_CERTIFICATE_VERSION, false),
+    [11] = CERTJSON_FIELD(
+        "certificate_valid_from",
+        VCCERT_FIELD_TYPE_CERTIFICATE_VALID_FROM, false),
+    [12] = CERTJSON_FIELD(
+        "private_encryption_key",
+        VCCERT_FIELD_TYPE_PRIVATE_ENCRYPTION_KEY, false),
+    [14] = CERTJSON_FIELD(
+        "public_encryption_key",
+        VCCERT_FIELD_TYPE_PUBLIC_ENCRYPTION_KEY, false),
+    [15] = CERTJSON_FIELD(
+        "artifact_id", VCCERT_FIELD_TYPE_ARTIFACT_ID, true),
+    [17] = CERTJSON_FIELD(
+        "signature", VCCERT_FIELD_TYPE_SIGNATURE, false),
+    [18] = CERTJSON_FIELD(
+        "wrapped_transaction_tuple",
+        VCCERT_FIELD_TYPE_WRAPPED_TRANSACTION_TUPLE, false),
+    [20] = CERTJSON_FIELD(
+        "block_height", VCCERT_FIELD_TYPE_BLOCK_HEIGHT, false),
+    [22] = CERTJSON_FIELD(
+        "certificate_crypto_suite",
+        VCCERT_FIELD_TYPE_CERTIFICATE_CRYPTO_SUITE, false),
+    [23] = CERTJSON_FIELD(
+        "new_artifact_state", VCCERT_FIELD_TYPE_NEW_ARTIFACT_STATE, false),
+    [24] = CERTJSON_FIELD(
+        "artifact_type", VCCERT_FIELD_TYPE_ARTIFACT_TYPE, true),
+    [25] = CERTJSON_FIELD(
+        "previous_certificate_id",
+        VCCERT_FIELD_TYPE_PREVIOUS_CERTIFICATE_ID, true),
+    [26] = CERTJSON_FIELD(
+        "certificate_valid_to", VCCERT_FIELD_TYPE_CERTIFICATE_VALID_TO, false),
+    [28] = CERTJSON_FIELD(
+        "private_signing_key", VCCERT_FIELD_TYPE_PRIVATE_SIGNING_KEY, false),
+    [29] = CERTJSON_FIELD(
+        "previous_artifact_state",
+        VCCERT_FIELD_TYPE_PREVIOUS_ARTIFACT_STATE, false),
+    [30] = CERTJSON_FIELD(
+        "certificate_id", VCCERT_FIELD_TYPE_CERTIFICATE_ID, true),
+    [31] = CERTJSON_FIELD(
+        "signer_id", VCCERT_FIELD_TYPE_SIGNER_ID, true),
+};
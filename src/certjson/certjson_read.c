@@ -0,0 +1,346 @@
+/**
+ * \file certjson/certjson_read.c
+ *
+ * \brief Read a certificate from a JSON object.
+ *
+ * \copyright 2020 Velo Payments.  See License.txt for license terms.
+ */
+
+#include <cbmc/model_assert.h>
+#include <string.h>
+#include <vctool/certjson.h>
+#include <vctool/uuid.h>
+
+/* the length of a canonical uuid. */
+#define CERTJSON_UUID_LENGTH                            36
+
+/* set on the value of every hex digit. */
+#define CERTJSON_HEX_DIGIT                              0x10
+
+/* forward decls. */
+static size_t certjson_skip(const char* json, size_t size, size_t pos);
+static int certjson_string(
+    const char* json, size_t size, size_t* pos, const char** str,
+    size_t* length);
+static int certjson_type(const char* key, size_t length, uint16_t* type);
+static int certjson_value(
+    const char* value, size_t length, uint8_t* out, size_t capacity,
+    size_t* out_size);
+static bool certjson_unhex(const char* hex, size_t size, uint8_t* out);
+
+/* JSON whitespace. */
+static const uint8_t certjson_space[256] = {
+    [' '] = 1, ['\t'] = 1, ['\n'] = 1, ['\r'] = 1,
+};
+
+/* the value of each hex digit, with CERTJSON_HEX_DIGIT set. */
+static const uint8_t certjson_digits[256] = {
+    ['0'] = 0x10, ['1'] = 0x11, ['2'] = 0x12, ['3'] = 0x13, ['4'] = 0x14,
+    ['5'] = 0x15, ['6'] = 0x16, ['7'] = 0x17, ['8'] = 0x18, ['9'] = 0x19,
+    ['a'] = 0x1A, ['b'] = 0x1B, ['c'] = 0x1C, ['d'] = 0x1D, ['e'] = 0x1E,
+    ['f'] = 0x1F,
+    ['A'] = 0x1A, ['B'] = 0x1B, ['C'] = 0x1C, ['D'] = 0x1D, ['E'] = 0x1E,
+    ['F'] = 0x1F,
+};
+
+/**
+ * \brief Read a certificate from a JSON object.
+ *
+ * The end of each string is found with memchr, which scans many bytes at a
+ * time, and hex values are decoded through a table, checking every digit at
+ * once at the end of the value.
+ *
+ * \param json          The JSON text, starting with the object or the
+ *                      whitespace before it.
+ * \param size          The size of the text.
+ * \param consumed      Set to the size of the text up to the end of the
+ *                      object.
+ * \param cert          Buffer receiving the certificate.
+ * \param capacity      The size of the buffer.
+ * \param cert_size     Set to the size of the certificate.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - VCTOOL_ERROR_CERTJSON_BAD_JSON if the text is not an object of
+ *        string members.
+ *      - VCTOOL_ERROR_CERTJSON_UNKNOWN_FIELD if a key names no field type.
+ *      - VCTOOL_ERROR_CERTJSON_BAD_VALUE if a value is not a uuid or hex
+ *        bytes, or is too large for a field.
+ *      - VCTOOL_ERROR_CERTJSON_BUFFER_TOO_SMALL if the certificate does not
+ *        fit.
+ */
+int certjson_read(
+    const char* json, size_t size, size_t* consumed, uint8_t* cert,
+    size_t capacity, size_t* cert_size)
+{
+    int retval;
+    const char* key;
+    const char* value;
+    size_t key_length, value_length, value_size;
+    uint16_t type;
+
+    /* parameter sanity checks. */
+    MODEL_ASSERT(0 == size || NULL != json);
+    MODEL_ASSERT(NULL != consumed);
+    MODEL_ASSERT(0 == capacity || NULL != cert);
+    MODEL_ASSERT(NULL != cert_size);
+
+    size_t pos = certjson_skip(json, size, 0);
+    if (pos >= size || '{' != json[pos])
+    {
+        return VCTOOL_ERROR_CERTJSON_BAD_JSON;
+    }
+
+    size_t out = 0;
+    pos = certjson_skip(json, size, pos + 1);
+    if (pos < size && '}' == json[pos])
+    {
+        ++pos;
+        goto done;
+    }
+
+    for (;;)
+    {
+        /* "key" : "value" */
+        retval = certjson_string(json, size, &pos, &key, &key_length);
+        if (VCTOOL_STATUS_SUCCESS != retval)
+        {
+            return retval;
+        }
+
+        pos = certjson_skip(json, size, pos);
+        if (pos >= size || ':' != json[pos])
+        {
+            return VCTOOL_ERROR_CERTJSON_BAD_JSON;
+        }
+
+        pos = certjson_skip(json, size, pos + 1);
+        retval = certjson_string(json, size, &pos, &value, &value_length);
+        if (VCTOOL_STATUS_SUCCESS != retval)
+        {
+            return retval;
+        }
+
+        retval = certjson_type(key, key_length, &type);
+        if (VCTOOL_STATUS_SUCCESS != retval)
+        {
+            return retval;
+        }
+
+        if (capacity - out < CERTJSON_FIELD_HEADER_SIZE)
+        {
+            return VCTOOL_ERROR_CERTJSON_BUFFER_TOO_SMALL;
+        }
+
+        retval =
+            certjson_value(
+                value, value_length, cert + out + CERTJSON_FIELD_HEADER_SIZE,
+                capacity - out - CERTJSON_FIELD_HEADER_SIZE, &value_size);
+        if (VCTOOL_STATUS_SUCCESS != retval)
+        {
+            return retval;
+        }
+
+        cert[out] = (uint8_t)(type >> 8);
+        cert[out + 1] = (uint8_t)type;
+        cert[out + 2] = (uint8_t)(value_size >> 8);
+        cert[out + 3] = (uint8_t)value_size;
+        out += CERTJSON_FIELD_HEADER_SIZE + value_size;
+
+        /* , or } */
+        pos = certjson_skip(json, size, pos);
+        if (pos >= size)
+        {
+            return VCTOOL_ERROR_CERTJSON_BAD_JSON;
+        }
+        else if (',' == json[pos])
+        {
+            pos = certjson_skip(json, size, pos + 1);
+        }
+        else if ('}' == json[pos])
+        {
+            ++pos;
+            break;
+        }
+        else
+        {
+            return VCTOOL_ERROR_CERTJSON_BAD_JSON;
+        }
+    }
+
+done:
+    *consumed = pos;
+    *cert_size = out;
+
+    return VCTOOL_STATUS_SUCCESS;
+}
+
+/**
+ * \brief Skip whitespace.
+ *
+ * \param json          The JSON text.
+ * \param size          The size of the text.
+ * \param pos           The position from which to skip.
+ *
+ * \returns the position of the next token, or size.
+ */
+static size_t certjson_skip(const char* json, size_t size, size_t pos)
+{
+    while (pos < size && certjson_space[(uint8_t)json[pos]])
+    {
+        ++pos;
+    }
+
+    return pos;
+}
+
+/**
+ * \brief Read a string without escapes.
+ *
+ * \param json          The JSON text.
+ * \param size          The size of the text.
+ * \param pos           The position of the opening quote, set to the
+ *                      position after the closing quote.
+ * \param str           Set to the start of the string.
+ * \param length        Set to the length of the string.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - VCTOOL_ERROR_CERTJSON_BAD_JSON if there is no string here, or it
+ *        has escapes.
+ */
+static int certjson_string(
+    const char* json, size_t size, size_t* pos, const char** str,
+    size_t* length)
+{
+    if (*pos >= size || '"' != json[*pos])
+    {
+        return VCTOOL_ERROR_CERTJSON_BAD_JSON;
+    }
+
+    const char* start = json + *pos + 1;
+    const char* end = (const char*)memchr(start, '"', size - *pos - 1);
+    if (NULL == end || NULL != memchr(start, '\\', (size_t)(end - start)))
+    {
+        return VCTOOL_ERROR_CERTJSON_BAD_JSON;
+    }
+
+    *str = start;
+    *length = (size_t)(end - start);
+    *pos = (size_t)(end - json) + 1;
+
+    return VCTOOL_STATUS_SUCCESS;
+}
+
+/**
+ * \brief Decode a key as a field type.
+ *
+ * \param key           The key.
+ * \param length        The length of the key.
+ * \param type          Set to the field type.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - VCTOOL_ERROR_CERTJSON_UNKNOWN_FIELD if the key names no field type.
+ */
+static int certjson_type(const char* key, size_t length, uint16_t* type)
+{
+    uint8_t bytes[2];
+
+    const certjson_field* field = certjson_field_by_name(key, length);
+    if (NULL != field)
+    {
+        *type = field->type;
+        return VCTOOL_STATUS_SUCCESS;
+    }
+
+    /* a field type without a name is written as 0xNNNN. */
+    if (6 != length || '0' != key[0] || 'x' != key[1]
+     || !certjson_unhex(key + 2, 2, bytes))
+    {
+        return VCTOOL_ERROR_CERTJSON_UNKNOWN_FIELD;
+    }
+
+    *type = (uint16_t)((bytes[0] << 8) | bytes[1]);
+
+    return VCTOOL_STATUS_SUCCESS;
+}
+
+/**
+ * \brief Decode a value as a canonical uuid or as hex bytes.
+ *
+ * \param value         The value.
+ * \param length        The length of the value.
+ * \param out           Buffer receiving the bytes.
+ * \param capacity      The size of the buffer.
+ * \param out_size      Set to the number of bytes.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - VCTOOL_ERROR_CERTJSON_BAD_VALUE if the value is malformed or too
+ *        large for a field.
+ *      - VCTOOL_ERROR_CERTJSON_BUFFER_TOO_SMALL if the bytes do not fit.
+ */
+static int certjson_value(
+    const char* value, size_t length, uint8_t* out, size_t capacity,
+    size_t* out_size)
+{
+    char digits[2 * UUID_SIZE];
+
+    /* a canonical uuid is 8-4-4-4-12 hex digits. */
+    if (CERTJSON_UUID_LENGTH == length && '-' == value[8]
+     && '-' == value[13] && '-' == value[18] && '-' == value[23])
+    {
+        memcpy(digits, value, 8);
+        memcpy(digits + 8, value + 9, 4);
+        memcpy(digits + 12, value + 14, 4);
+        memcpy(digits + 16, value + 19, 4);
+        memcpy(digits + 20, value + 24, 12);
+        value = digits;
+        length = sizeof(digits);
+    }
+
+    if (0 != length % 2 || length / 2 > CERTJSON_FIELD_MAX)
+    {
+        return VCTOOL_ERROR_CERTJSON_BAD_VALUE;
+    }
+
+    if (length / 2 > capacity)
+    {
+        return VCTOOL_ERROR_CERTJSON_BUFFER_TOO_SMALL;
+    }
+
+    if (!certjson_unhex(value, length / 2, out))
+    {
+        return VCTOOL_ERROR_CERTJSON_BAD_VALUE;
+    }
+
+    *out_size = length / 2;
+
+    return VCTOOL_STATUS_SUCCESS;
+}
+
+/**
+ * \brief Decode hex digits.
+ *
+ * \param hex           The digits.
+ * \param size          The number of bytes to decode.
+ * \param out           Buffer receiving the bytes.
+ *
+ * \returns true if every character was a hex digit.
+ */
+static bool certjson_unhex(const char* hex, size_t size, uint8_t* out)
+{
+    uint8_t valid = CERTJSON_HEX_DIGIT;
+
+    for (size_t i = 0; i < size; ++i)
+    {
+        uint8_t high = certjson_digits[(uint8_t)hex[2 * i]];
+        uint8_t low = certjson_digits[(uint8_t)hex[2 * i + 1]];
+
+        valid &= high & low;
+        out[i] = (uint8_t)((high << 4) | (low & 0x0f));
+    }
+
+    return 0 != valid;
+}
@@ -0,0 +1,77 @@
+/**
+ * \file certjson/certjson_write.c
+ *
+ * \brief Write a certificate as a line of JSON.
+ *
+ * \copyright 2020 Velo Payments.  See License.txt for license terms.
+ */
+
+#include <cbmc/model_assert.h>
+#include <vctool/certjson.h>
+
+/**
+ * \brief Write a certificate as a line of JSON.
+ *
+ * \param w             The writer.
+ * \param cert          The certificate.
+ * \param size          The size of the certificate.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - VCTOOL_ERROR_CERTJSON_BAD_CERTIFICATE if a field runs past the end
+ *        of the certificate, in which case nothing was written.
+ *      - a non-zero error code returned by the file layer.
+ */
+int certjson_write(certjson_writer* w, const uint8_t* cert, size_t size)
+{
+    int retval;
+    size_t offset;
+
+    /* parameter sanity checks. */
+    MODEL_ASSERT(NULL != w);
+    MODEL_ASSERT(0 == size || NULL != cert);
+
+    /* check the fields first, so that a bad certificate writes nothing. */
+    for (offset = 0; offset < size;)
+    {
+        if (size - offset < CERTJSON_FIELD_HEADER_SIZE)
+        {
+            return VCTOOL_ERROR_CERTJSON_BAD_CERTIFICATE;
+        }
+
+        size_t field_size =
+            ((size_t)cert[offset + 2] << 8) | (size_t)cert[offset + 3];
+        offset += CERTJSON_FIELD_HEADER_SIZE;
+        if (size - offset < field_size)
+        {
+            return VCTOOL_ERROR_CERTJSON_BAD_CERTIFICATE;
+        }
+
+        offset += field_size;
+    }
+
+    retval = certjson_write_begin(w);
+    if (VCTOOL_STATUS_SUCCESS != retval)
+    {
+        return retval;
+    }
+
+    for (offset = 0; offset < size;)
+    {
+        uint16_t type = (uint16_t)((cert[offset] << 8) | cert[offset + 1]);
+        size_t field_size =
+            ((size_t)cert[offset + 2] << 8) | (size_t)cert[offset + 3];
+        const uint8_t* value = cert + offset + CERTJSON_FIELD_HEADER_SIZE;
+
+        retval =
+            certjson_write_field(w, 0 == offset, type, value, field_size);
+        if (VCTOOL_STATUS_SUCCESS != retval)
+        {
+            return retval;
+        }
+
+        offset += CERTJSON_FIELD_HEADER_SIZE + field_size;
+    }
+
+    return certjson_write_end(w);
+}
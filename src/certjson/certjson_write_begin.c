@@ -0,0 +1,35 @@
+/**
+ * \file certjson/certjson_write_begin.c
+ *
+ * \brief Start writing a certificate as a line of JSON.
+ *
+ * \copyright 2020 Velo Payments.  See License.txt for license terms.
+ */
+
+#include <cbmc/model_assert.h>
+#include <vctool/certjson.h>
+
+/**
+ * \brief Start writing a certificate as a line of JSON.
+ *
+ * \param w             The writer.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - a non-zero error code returned by the file layer.
+ */
+int certjson_write_begin(certjson_writer* w)
+{
+    /* parameter sanity checks. */
+    MODEL_ASSERT(NULL != w);
+
+    int retval = certjson_writer_reserve(w, 1);
+    if (VCTOOL_STATUS_SUCCESS != retval)
+    {
+        return retval;
+    }
+
+    w->buffer[w->used++] = '{';
+
+    return VCTOOL_STATUS_SUCCESS;
+}
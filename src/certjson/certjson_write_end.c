@@ -0,0 +1,36 @@
+/**
+ * \file certjson/certjson_write_end.c
+ *
+ * \brief Finish writing a certificate as a line of JSON.
+ *
+ * \copyright 2020 Velo Payments.  See License.txt for license terms.
+ */
+
+#include <cbmc/model_assert.h>
+#include <vctool/certjson.h>
+
+/**
+ * \brief Finish writing a certificate as a line of JSON.
+ *
+ * \param w             The writer.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - a non-zero error code returned by the file layer.
+ */
+int certjson_write_end(certjson_writer* w)
+{
+    /* parameter sanity checks. */
+    MODEL_ASSERT(NULL != w);
+
+    int retval = certjson_writer_reserve(w, 2);
+    if (VCTOOL_STATUS_SUCCESS != retval)
+    {
+        return retval;
+    }
+
+    w->buffer[w->used++] = '}';
+    w->buffer[w->used++] = '\n';
+
+    return VCTOOL_STATUS_SUCCESS;
+}
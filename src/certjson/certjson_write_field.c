@@ -0,0 +1,155 @@
+/**
+ * \file certjson/certjson_write_field.c
+ *
+ * \brief Write a field of a certificate as a JSON member.
+ *
+ * \copyright 2020 Velo Payments.  See License.txt for license terms.
+ */
+
+#include <cbmc/model_assert.h>
+#include <string.h>
+#include <vctool/certjson.h>
+#include <vctool/uuid.h>
+
+/* room for a separator, a key and a uuid value, with its quotes. */
+#define CERTJSON_MEMBER_MAX                             128
+
+/* forward decls. */
+static int certjson_write_hex(
+    certjson_writer* w, const uint8_t* value, size_t size);
+
+/* lower case hex digits. */
+static const char certjson_hex[] = "0123456789abcdef";
+
+/**
+ * \brief Write a field of a certificate as a JSON member.
+ *
+ * Text goes straight into the writer's buffer; a hex value larger than the
+ * buffer is written in pieces.
+ *
+ * \param w             The writer.
+ * \param first         True for the first field of the certificate.
+ * \param type          The field type.
+ * \param value         The field value.
+ * \param size          The size of the value.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - a non-zero error code returned by the file layer.
+ */
+int certjson_write_field(
+    certjson_writer* w, bool first, uint16_t type, const uint8_t* value,
+    size_t size)
+{
+    int retval;
+    const certjson_field* field = certjson_field_by_type(type);
+
+    /* parameter sanity checks. */
+    MODEL_ASSERT(NULL != w);
+    MODEL_ASSERT(0 == size || NULL != value);
+
+    retval = certjson_writer_reserve(w, CERTJSON_MEMBER_MAX);
+    if (VCTOOL_STATUS_SUCCESS != retval)
+    {
+        return retval;
+    }
+
+    char* out = (char*)w->buffer + w->used;
+    if (!first)
+    {
+        *out++ = ',';
+    }
+
+    /* the key. */
+    *out++ = '"';
+    if (NULL != field)
+    {
+        memcpy(out, field->name, field->length);
+        out += field->length;
+    }
+    else
+    {
+        *out++ = '0';
+        *out++ = 'x';
+        *out++ = certjson_hex[type >> 12];
+        *out++ = certjson_hex[(type >> 8) & 0x0f];
+        *out++ = certjson_hex[(type >> 4) & 0x0f];
+        *out++ = certjson_hex[type & 0x0f];
+    }
+
+    *out++ = '"';
+    *out++ = ':';
+    *out++ = '"';
+
+    /* the value. */
+    if (NULL != field && field->uuid && UUID_SIZE == size)
+    {
+        uuid_to_string(out, value);
+        out += UUID_STRING_SIZE - 1;
+        w->used = (size_t)((uint8_t*)out - w->buffer);
+    }
+    else
+    {
+        w->used = (size_t)((uint8_t*)out - w->buffer);
+        retval = certjson_write_hex(w, value, size);
+        if (VCTOOL_STATUS_SUCCESS != retval)
+        {
+            return retval;
+        }
+    }
+
+    retval = certjson_writer_reserve(w, 1);
+    if (VCTOOL_STATUS_SUCCESS != retval)
+    {
+        return retval;
+    }
+
+    w->buffer[w->used++] = '"';
+
+    return VCTOOL_STATUS_SUCCESS;
+}
+
+/**
+ * \brief Write bytes as hex digits.
+ *
+ * \param w             The writer.
+ * \param value         The bytes.
+ * \param size          The number of bytes.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - a non-zero error code returned by the file layer.
+ */
+static int certjson_write_hex(
+    certjson_writer* w, const uint8_t* value, size_t size)
+{
+    int retval;
+
+    while (size > 0)
+    {
+        retval = certjson_writer_reserve(w, 2);
+        if (VCTOOL_STATUS_SUCCESS != retval)
+        {
+            return retval;
+        }
+
+        size_t chunk = (CERTJSON_WRITER_BUFFER_SIZE - w->used) / 2;
+        if (chunk > size)
+        {
+            chunk = size;
+        }
+
+        uint8_t* out = w->buffer + w->used;
+        for (size_t i = 0; i < chunk; ++i)
+        {
+            out[2 * i] = (uint8_t)certjson_hex[value[i] >> 4];
+            out[2 * i + 1] = (uint8_t)certjson_hex[value[i] & 0x0f];
+        }
+
+        w->used += 2 * chunk;
+        value += chunk;
+        size -= chunk;
+    }
+
+    return VCTOOL_STATUS_SUCCESS;
+}
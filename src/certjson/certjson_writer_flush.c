@@ -0,0 +1,35 @@
+/**
+ * \file certjson/certjson_writer_flush.c
+ *
+ * \brief Write the buffered text of a JSON writer.
+ *
+ * \copyright 2020 Velo Payments.  See License.txt for license terms.
+ */
+
+#include <cbmc/model_assert.h>
+#include <vctool/certjson.h>
+
+/**
+ * \brief Write the buffered text.
+ *
+ * \param w             The writer.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - a non-zero error code returned by the file layer.
+ */
+int certjson_writer_flush(certjson_writer* w)
+{
+    /* parameter sanity checks. */
+    MODEL_ASSERT(NULL != w);
+
+    if (0 == w->used)
+    {
+        return VCTOOL_STATUS_SUCCESS;
+    }
+
+    int retval = file_write_all(w->f, w->fd, w->buffer, w->used);
+    w->used = 0;
+
+    return retval;
+}
@@ -0,0 +1,28 @@
+/**
+ * \file certjson/certjson_writer_init.c
+ *
+ * \brief Initialize a JSON writer.
+ *
+ * \copyright 2020 Velo Payments.  See License.txt for license terms.
+ */
+
+#include <cbmc/model_assert.h>
+#include <vctool/certjson.h>
+
+/**
+ * \brief Initialize a writer.
+ *
+ * \param w             The writer to initialize.
+ * \param f             The file abstraction layer.
+ * \param fd            The descriptor to write to.
+ */
+void certjson_writer_init(certjson_writer* w, file* f, int fd)
+{
+    /* parameter sanity checks. */
+    MODEL_ASSERT(NULL != w);
+    MODEL_ASSERT(PROP_FILE_VALID(f));
+
+    w->f = f;
+    w->fd = fd;
+    w->used = 0;
+}
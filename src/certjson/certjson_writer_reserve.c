@@ -0,0 +1,35 @@
+/**
+ * \file certjson/certjson_writer_reserve.c
+ *
+ * \brief Make room in a writer's buffer.
+ *
+ * \copyright 2020 Velo Payments.  See License.txt for license terms.
+ */
+
+#include <cbmc/model_assert.h>
+#include <vctool/certjson.h>
+
+/**
+ * \brief Make room in the buffer, flushing it if needed.
+ *
+ * \param w             The writer.
+ * \param size          The number of bytes needed, which is at most the
+ *                      size of the buffer.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - a non-zero error code returned by the file layer.
+ */
+int certjson_writer_reserve(certjson_writer* w, size_t size)
+{
+    /* parameter sanity checks. */
+    MODEL_ASSERT(NULL != w);
+    MODEL_ASSERT(size <= CERTJSON_WRITER_BUFFER_SIZE);
+
+    if (CERTJSON_WRITER_BUFFER_SIZE - w->used >= size)
+    {
+        return VCTOOL_STATUS_SUCCESS;
+    }
+
+    return certjson_writer_flush(w);
+}
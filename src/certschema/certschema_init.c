@@ -0,0 +1,170 @@
+/**
+ * \file certschema/certschema_init.c
+ *
+ * \brief Build the schemas of the known certificate types.
+ *
+ * \copyright 2020 Velo Payments.  See License.txt for license terms.
+ */
+
+#include <cbmc/model_assert.h>
+#include <string.h>
+#include <vccert/certificate_types.h>
+#include <vccert/fields.h>
+#include <vctool/certschema.h>
+
+/* how the size of a field is given. */
+#define CERTSCHEMA_SIZE_EXACT                           0
+#define CERTSCHEMA_SIZE_ENCRYPTION_PUBLIC_KEY           1
+#define CERTSCHEMA_SIZE_ENCRYPTION_PRIVATE_KEY          2
+#define CERTSCHEMA_SIZE_SIGNING_PUBLIC_KEY              3
+#define CERTSCHEMA_SIZE_SIGNING_PRIVATE_KEY             4
+#define CERTSCHEMA_SIZE_SIGNATURE                       5
+
+/* the end of a field list. */
+#define CERTSCHEMA_END                                  { 0, false, 0, 0 }
+
+/**
+ * \brief A field in the schema table.
+ */
+typedef struct certschema_spec_field
+{
+    uint16_t type;
+    bool required;
+    unsigned size_kind;
+    size_t size;
+} certschema_spec_field;
+
+/**
+ * \brief A certificate type in the schema table.
+ */
+typedef struct certschema_spec
+{
+    const uint8_t* type;
+    const char* name;
+    const certschema_spec_field* fields;
+} certschema_spec;
+
+/* the fields of a private entity keypair certificate. */
+static const certschema_spec_field certschema_private_entity[] = {
+    { VCCERT_FIELD_TYPE_CERTIFICATE_VERSION, true,
+      CERTSCHEMA_SIZE_EXACT, 4 },
+    { VCCERT_FIELD_TYPE_CERTIFICATE_TYPE, true,
+      CERTSCHEMA_SIZE_EXACT, UUID_SIZE },
+    { VCCERT_FIELD_TYPE_CERTIFICATE_CRYPTO_SUITE, true,
+      CERTSCHEMA_SIZE_EXACT, 2 },
+    { VCCERT_FIELD_TYPE_ARTIFACT_ID, true,
+      CERTSCHEMA_SIZE_EXACT, UUID_SIZE },
+    { VCCERT_FIELD_TYPE_PUBLIC_ENCRYPTION_KEY, true,
+      CERTSCHEMA_SIZE_ENCRYPTION_PUBLIC_KEY, 0 },
+    { VCCERT_FIELD_TYPE_PRIVATE_ENCRYPTION_KEY, true,
+      CERTSCHEMA_SIZE_ENCRYPTION_PRIVATE_KEY, 0 },
+    { VCCERT_FIELD_TYPE_PUBLIC_SIGNING_KEY, true,
+      CERTSCHEMA_SIZE_SIGNING_PUBLIC_KEY, 0 },
+    { VCCERT_FIELD_TYPE_PRIVATE_SIGNING_KEY, true,
+      CERTSCHEMA_SIZE_SIGNING_PRIVATE_KEY, 0 },
+    CERTSCHEMA_END
+};
+
+/* the fields of a public entity certificate, which may be signed. */
+static const certschema_spec_field certschema_public_entity[] = {
+    { VCCERT_FIELD_TYPE_CERTIFICATE_VERSION, true,
+      CERTSCHEMA_SIZE_EXACT, 4 },
+    { VCCERT_FIELD_TYPE_CERTIFICATE_TYPE, true,
+      CERTSCHEMA_SIZE_EXACT, UUID_SIZE },
+    { VCCERT_FIELD_TYPE_CERTIFICATE_CRYPTO_SUITE, true,
+      CERTSCHEMA_SIZE_EXACT, 2 },
+    { VCCERT_FIELD_TYPE_ARTIFACT_ID, true,
+      CERTSCHEMA_SIZE_EXACT, UUID_SIZE },
+    { VCCERT_FIELD_TYPE_PUBLIC_ENCRYPTION_KEY, true,
+      CERTSCHEMA_SIZE_ENCRYPTION_PUBLIC_KEY, 0 },
+    { VCCERT_FIELD_TYPE_PUBLIC_SIGNING_KEY, true,
+      CERTSCHEMA_SIZE_SIGNING_PUBLIC_KEY, 0 },
+    { VCCERT_FIELD_TYPE_SIGNER_ID, false,
+      CERTSCHEMA_SIZE_EXACT, UUID_SIZE },
+    { VCCERT_FIELD_TYPE_SIGNATURE, false,
+      CERTSCHEMA_SIZE_SIGNATURE, 0 },
+    CERTSCHEMA_END
+};
+
+/* the known certificate types. */
+static const certschema_spec certschema_specs[] = {
+    { vccert_certificate_type_uuid_private_entity, "private entity",
+      certschema_private_entity },
+    { vccert_certificate_type_uuid_public_entity, "public entity",
+      certschema_public_entity },
+};
+
+/**
+ * \brief Build the schemas of the known certificate types.
+ *
+ * Sizes which depend on the crypto suite are resolved here, so that
+ * validation only compares numbers.
+ *
+ * \param schema        The schema set to initialize.
+ * \param sizes         The sizes of keys and signatures.
+ */
+void certschema_init(certschema* schema, const certschema_sizes* sizes)
+{
+    /* parameter sanity checks. */
+    MODEL_ASSERT(NULL != schema);
+    MODEL_ASSERT(NULL != sizes);
+
+    memset(schema, 0, sizeof(certschema));
+
+    size_t count = sizeof(certschema_specs) / sizeof(certschema_spec);
+    MODEL_ASSERT(count <= CERTSCHEMA_MAX_TYPES);
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        const certschema_spec* spec = certschema_specs + i;
+        certschema_type* type = schema->types + schema->type_count++;
+
+        memcpy(type->type, spec->type, UUID_SIZE);
+        type->name = spec->name;
+
+        for (const certschema_spec_field* field = spec->fields;
+             0 != field->type; ++field)
+        {
+            MODEL_ASSERT(type->rule_count < CERTSCHEMA_MAX_RULES);
+            certschema_rule* rule = type->rules + type->rule_count;
+
+            size_t size;
+            switch (field->size_kind)
+            {
+                case CERTSCHEMA_SIZE_ENCRYPTION_PUBLIC_KEY:
+                    size = sizes->encryption_public_key;
+                    break;
+
+                case CERTSCHEMA_SIZE_ENCRYPTION_PRIVATE_KEY:
+                    size = sizes->encryption_private_key;
+                    break;
+
+                case CERTSCHEMA_SIZE_SIGNING_PUBLIC_KEY:
+                    size = sizes->signing_public_key;
+                    break;
+
+                case CERTSCHEMA_SIZE_SIGNING_PRIVATE_KEY:
+                    size = sizes->signing_private_key;
+                    break;
+
+                case CERTSCHEMA_SIZE_SIGNATURE:
+                    size = sizes->signature;
+                    break;
+
+                default:
+                    size = field->size;
+                    break;
+            }
+
+            rule->type = field->type;
+            rule->required = field->required;
+            rule->size = size;
+            if (field->required)
+            {
+                type->required |= UINT32_C(1) << type->rule_count;
+            }
+
+            ++type->rule_count;
+        }
+    }
+}
@@ -0,0 +1,30 @@
+/**
+ * \file certschema/certschema_sizes_init.c
+ *
+ * \brief Read the sizes of keys and signatures from a crypto suite.
+ *
+ * \copyright 2020 Velo Payments.  See License.txt for license terms.
+ */
+
+#include <cbmc/model_assert.h>
+#include <vctool/certschema.h>
+
+/**
+ * \brief Read the sizes of keys and signatures from a crypto suite.
+ *
+ * \param sizes         The sizes to initialize.
+ * \param suite         The crypto suite.
+ */
+void certschema_sizes_init(
+    certschema_sizes* sizes, const vccrypt_suite_options_t* suite)
+{
+    /* parameter sanity checks. */
+    MODEL_ASSERT(NULL != sizes);
+    MODEL_ASSERT(NULL != suite);
+
+    sizes->encryption_public_key = suite->key_cipher_opts.public_key_size;
+    sizes->encryption_private_key = suite->key_cipher_opts.private_key_size;
+    sizes->signing_public_key = suite->sign_opts.public_key_size;
+    sizes->signing_private_key = suite->sign_opts.private_key_size;
+    sizes->signature = suite->sign_opts.signature_size;
+}
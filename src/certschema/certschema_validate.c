@@ -0,0 +1,178 @@
+/**
+ * \file certschema/certschema_validate.c
+ *
+ * \brief Validate a certificate against the schema of its type.
+ *
+ * \copyright 2020 Velo Payments.  See License.txt for license terms.
+ */
+
+#include <cbmc/model_assert.h>
+#include <string.h>
+#include <vccert/fields.h>
+#include <vctool/certschema.h>
+
+/* forward decls. */
+static int certschema_find_type(
+    const certschema* schema, const uint8_t* cert, size_t size,
+    const certschema_type** type);
+
+/**
+ * \brief Validate a certificate against the schema of its type.
+ *
+ * \param schema        The schema set.
+ * \param cert          The certificate.
+ * \param size          The size of the certificate.
+ * \param type          Set to the schema of the certificate, or NULL if its
+ *                      type is missing or unknown.
+ * \param field         Set to the field type at fault, on failure.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS if the certificate is valid.
+ *      - VCTOOL_ERROR_CERTSCHEMA_BAD_CERTIFICATE if a field runs past the end
+ *        of the certificate.
+ *      - VCTOOL_ERROR_CERTSCHEMA_MISSING_TYPE if the certificate has no
+ *        certificate type.
+ *      - VCTOOL_ERROR_CERTSCHEMA_UNKNOWN_TYPE if there is no schema for the
+ *        certificate type.
+ *      - VCTOOL_ERROR_CERTSCHEMA_UNEXPECTED_FIELD if a field is not in the
+ *        schema.
+ *      - VCTOOL_ERROR_CERTSCHEMA_DUPLICATE_FIELD if a field appears twice.
+ *      - VCTOOL_ERROR_CERTSCHEMA_BAD_FIELD_SIZE if a field has the wrong size.
+ *      - VCTOOL_ERROR_CERTSCHEMA_MISSING_FIELD if a required field is absent.
+ */
+int certschema_validate(
+    const certschema* schema, const uint8_t* cert, size_t size,
+    const certschema_type** type, uint16_t* field)
+{
+    int retval;
+    uint32_t seen = 0;
+
+    /* parameter sanity checks. */
+    MODEL_ASSERT(NULL != schema);
+    MODEL_ASSERT(0 == size || NULL != cert);
+    MODEL_ASSERT(NULL != type);
+    MODEL_ASSERT(NULL != field);
+
+    *field = VCCERT_FIELD_TYPE_CERTIFICATE_TYPE;
+    retval = certschema_find_type(schema, cert, size, type);
+    if (VCTOOL_STATUS_SUCCESS != retval)
+    {
+        return retval;
+    }
+
+    const certschema_type* t = *type;
+    for (size_t offset = 0; offset < size;)
+    {
+        /* a partial header trails the last field. */
+        if (size - offset < CERTSCHEMA_FIELD_HEADER_SIZE)
+        {
+            *field = 0;
+            return VCTOOL_ERROR_CERTSCHEMA_BAD_CERTIFICATE;
+        }
+
+        *field = (uint16_t)((cert[offset] << 8) | cert[offset + 1]);
+        size_t field_size =
+            ((size_t)cert[offset + 2] << 8) | (size_t)cert[offset + 3];
+        offset += CERTSCHEMA_FIELD_HEADER_SIZE;
+        if (size - offset < field_size)
+        {
+            return VCTOOL_ERROR_CERTSCHEMA_BAD_CERTIFICATE;
+        }
+
+        offset += field_size;
+
+        /* schemas are short, so a scan beats anything cleverer. */
+        size_t i = 0;
+        while (i < t->rule_count && t->rules[i].type != *field)
+        {
+            ++i;
+        }
+
+        if (i == t->rule_count)
+        {
+            return VCTOOL_ERROR_CERTSCHEMA_UNEXPECTED_FIELD;
+        }
+
+        uint32_t bit = UINT32_C(1) << i;
+        if (seen & bit)
+        {
+            return VCTOOL_ERROR_CERTSCHEMA_DUPLICATE_FIELD;
+        }
+
+        if (field_size != t->rules[i].size)
+        {
+            return VCTOOL_ERROR_CERTSCHEMA_BAD_FIELD_SIZE;
+        }
+
+        seen |= bit;
+    }
+
+    /* report the first required field which is absent. */
+    uint32_t missing = t->required & ~seen;
+    if (0 != missing)
+    {
+        *field = t->rules[__builtin_ctz(missing)].type;
+        return VCTOOL_ERROR_CERTSCHEMA_MISSING_FIELD;
+    }
+
+    return VCTOOL_STATUS_SUCCESS;
+}
+
+/**
+ * \brief Find the schema of a certificate from its certificate type field.
+ *
+ * \param schema        The schema set.
+ * \param cert          The certificate.
+ * \param size          The size of the certificate.
+ * \param type          Set to the schema, or NULL if there is none.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - VCTOOL_ERROR_CERTSCHEMA_BAD_CERTIFICATE if a field before the type
+ *        runs past the end of the certificate.
+ *      - VCTOOL_ERROR_CERTSCHEMA_MISSING_TYPE if there is no certificate type
+ *        of the right size.
+ *      - VCTOOL_ERROR_CERTSCHEMA_UNKNOWN_TYPE if there is no schema for the
+ *        certificate type.
+ */
+static int certschema_find_type(
+    const certschema* schema, const uint8_t* cert, size_t size,
+    const certschema_type** type)
+{
+    *type = NULL;
+
+    for (size_t offset = 0; size - offset >= CERTSCHEMA_FIELD_HEADER_SIZE;)
+    {
+        uint16_t field = (uint16_t)((cert[offset] << 8) | cert[offset + 1]);
+        size_t field_size =
+            ((size_t)cert[offset + 2] << 8) | (size_t)cert[offset + 3];
+        offset += CERTSCHEMA_FIELD_HEADER_SIZE;
+        if (size - offset < field_size)
+        {
+            return VCTOOL_ERROR_CERTSCHEMA_BAD_CERTIFICATE;
+        }
+
+        if (VCCERT_FIELD_TYPE_CERTIFICATE_TYPE == field)
+        {
+            if (UUID_SIZE != field_size)
+            {
+                return VCTOOL_ERROR_CERTSCHEMA_MISSING_TYPE;
+            }
+
+            for (size_t i = 0; i < schema->type_count; ++i)
+            {
+                if (!memcmp(schema->types[i].type, cert + offset, UUID_SIZE))
+                {
+                    *type = schema->types + i;
+                    return VCTOOL_STATUS_SUCCESS;
+                }
+            }
+
+            return VCTOOL_ERROR_CERTSCHEMA_UNKNOWN_TYPE;
+        }
+
+        offset += field_size;
+    }
+
+    return VCTOOL_ERROR_CERTSCHEMA_MISSING_TYPE;
+}
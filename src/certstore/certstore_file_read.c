@@ -0,0 +1,105 @@
+/**
+ * \file certstore/certstore_file_read.c
+ *
+ * \brief Read a whole store file.
+ *
+ * \copyright 2020 Velo Payments.  See License.txt for license terms.
+ */
+
+#include <cbmc/model_assert.h>
+#include <fcntl.h>
+#include <vctool/certstore.h>
+
+/**
+ * \brief Read a whole store file.
+ *
+ * \param store         The store.
+ * \param data          Buffer to be initialized with the file contents.  The
+ *                      caller owns this buffer on success and must dispose it.
+ * \param path          The path of the file.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - VCTOOL_ERROR_CERTSTORE_CHANGED if the file was replaced while it
+ *        was being read.
+ *      - a non-zero error code on failure.
+ */
+int certstore_file_read(
+    certstore* store, vccrypt_buffer_t* data, const char* path)
+{
+    int retval, fd;
+    file_stat_st fst;
+    size_t offset, rbytes;
+
+    /* parameter sanity checks. */
+    MODEL_ASSERT(NULL != store);
+    MODEL_ASSERT(NULL != data);
+    MODEL_ASSERT(NULL != path);
+
+    retval = file_open(store->f, &fd, path, O_RDONLY, 0);
+    if (VCTOOL_STATUS_SUCCESS != retval)
+    {
+        goto done;
+    }
+
+    /* store files are replaced, never rewritten, so the size only changes
+     * if path is renamed over between the open and the stat. */
+    retval = file_stat(store->f, path, &fst);
+    if (VCTOOL_STATUS_SUCCESS != retval)
+    {
+        goto cleanup_fd;
+    }
+
+    retval =
+        vccrypt_buffer_init(
+            data, store->suite->alloc_opts, (size_t)fst.fst_size);
+    if (VCCRYPT_STATUS_SUCCESS != retval)
+    {
+        goto cleanup_fd;
+    }
+
+    /* read the whole file. */
+    for (offset = 0; offset < data->size; offset += rbytes)
+    {
+        retval =
+            file_read(
+                store->f, fd, (uint8_t*)data->data + offset,
+                data->size - offset, &rbytes);
+        if (VCTOOL_STATUS_SUCCESS != retval)
+        {
+            goto cleanup_data;
+        }
+
+        if (0 == rbytes)
+        {
+            retval = VCTOOL_ERROR_CERTSTORE_CHANGED;
+            goto cleanup_data;
+        }
+    }
+
+    /* the file must end where the stat said it would. */
+    uint8_t extra;
+    retval = file_read(store->f, fd, &extra, sizeof(extra), &rbytes);
+    if (VCTOOL_STATUS_SUCCESS != retval)
+    {
+        goto cleanup_data;
+    }
+
+    if (0 != rbytes)
+    {
+        retval = VCTOOL_ERROR_CERTSTORE_CHANGED;
+        goto cleanup_data;
+    }
+
+    /* success. */
+    goto cleanup_fd;
+
+cleanup_data:
+    dispose((disposable_t*)data);
+
+cleanup_fd:
+    file_close(store->f, fd);
+
+done:
+    return retval;
+}
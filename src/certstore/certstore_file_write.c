@@ -0,0 +1,98 @@
+/**
+ * \file certstore/certstore_file_write.c
+ *
+ * \brief Atomically replace a store file.
+ *
+ * \copyright 2020 Velo Payments.  See License.txt for license terms.
+ */
+
+#include <cbmc/model_assert.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <vctool/certstore.h>
+
+/* distinguishes temporary files written by threads of this process. */
+static unsigned certstore_temp_serial;
+
+/**
+ * \brief Atomically replace a store file.
+ *
+ * The data is written to a temporary file in the same directory, which is
+ * synced and then renamed over path.
+ *
+ * \param store         The store.
+ * \param path          The path of the file.
+ * \param data          The file contents.
+ * \param size          The size of the file contents.
+ * \param mode          The permissions of the file.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - a non-zero error code on failure.
+ */
+int certstore_file_write(
+    certstore* store, const char* path, const void* data, size_t size,
+    mode_t mode)
+{
+    int retval, fd;
+
+    /* parameter sanity checks. */
+    MODEL_ASSERT(NULL != store);
+    MODEL_ASSERT(NULL != path);
+    MODEL_ASSERT(0 == size || NULL != data);
+
+    /* build a temporary name next to the file. */
+    unsigned serial =
+        __atomic_fetch_add(&certstore_temp_serial, 1, __ATOMIC_RELAXED);
+    size_t temp_size = strlen(path) + 64;
+    char* temp = (char*)malloc(temp_size);
+    if (NULL == temp)
+    {
+        return VCTOOL_ERROR_GENERAL_OUT_OF_MEMORY;
+    }
+
+    snprintf(temp, temp_size, "%s.%ld-%u.tmp", path, (long)getpid(), serial);
+
+    retval =
+        file_open(store->f, &fd, temp, O_CREAT | O_EXCL | O_WRONLY, mode);
+    if (VCTOOL_STATUS_SUCCESS != retval)
+    {
+        goto cleanup_temp;
+    }
+
+    retval = file_write_all(store->f, fd, data, size);
+    if (VCTOOL_STATUS_SUCCESS != retval)
+    {
+        file_close(store->f, fd);
+        goto unlink_temp;
+    }
+
+    /* the data must be durable before the rename makes it visible. */
+    retval = file_fsync(store->f, fd);
+    file_close(store->f, fd);
+    if (VCTOOL_STATUS_SUCCESS != retval)
+    {
+        goto unlink_temp;
+    }
+
+    /* move the complete file into place. */
+    retval = file_rename(store->f, temp, path);
+    if (VCTOOL_STATUS_SUCCESS != retval)
+    {
+        goto unlink_temp;
+    }
+
+    /* success. */
+    goto cleanup_temp;
+
+unlink_temp:
+    file_unlink(store->f, temp);
+
+cleanup_temp:
+    free(temp);
+
+    return retval;
+}
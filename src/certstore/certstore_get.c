@@ -0,0 +1,48 @@
+/**
+ * \file certstore/certstore_get.c
+ *
+ * \brief Read a certificate from a certificate store.
+ *
+ * \copyright 2020 Velo Payments.  See License.txt for license terms.
+ */
+
+#include <cbmc/model_assert.h>
+#include <stdlib.h>
+#include <vctool/certstore.h>
+
+/**
+ * \brief Read a certificate from the store.
+ *
+ * \param store         The store.
+ * \param cert          Buffer to be initialized with the certificate.  The
+ *                      caller owns this buffer on success and must dispose it.
+ * \param hash          The store->hash_size byte hash of the certificate.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - VCTOOL_ERROR_FILE_NO_ENTRY if the certificate is not in the store.
+ *      - a non-zero error code on failure.
+ */
+int certstore_get(
+    certstore* store, vccrypt_buffer_t* cert, const uint8_t* hash)
+{
+    int retval;
+    char* path;
+
+    /* parameter sanity checks. */
+    MODEL_ASSERT(NULL != store);
+    MODEL_ASSERT(NULL != cert);
+    MODEL_ASSERT(NULL != hash);
+
+    retval = certstore_object_path(store, &path, hash);
+    if (VCTOOL_STATUS_SUCCESS != retval)
+    {
+        return retval;
+    }
+
+    retval = certstore_file_read(store, cert, path);
+
+    free(path);
+
+    return retval;
+}
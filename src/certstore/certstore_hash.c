@@ -0,0 +1,78 @@
+/**
+ * \file certstore/certstore_hash.c
+ *
+ * \brief Compute the hash of a certificate.
+ *
+ * \copyright 2020 Velo Payments.  See License.txt for license terms.
+ */
+
+#include <cbmc/model_assert.h>
+#include <string.h>
+#include <vctool/certstore.h>
+
+/**
+ * \brief Compute the hash of a certificate.
+ *
+ * \param store         The store.
+ * \param hash          Buffer receiving the store->hash_size byte hash.
+ * \param cert          The certificate bytes.
+ * \param size          The size of the certificate.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - a non-zero error code on failure.
+ */
+int certstore_hash(
+    certstore* store, uint8_t* hash, const void* cert, size_t size)
+{
+    int retval;
+    vccrypt_hash_context_t ctx;
+    vccrypt_buffer_t digest;
+
+    /* parameter sanity checks. */
+    MODEL_ASSERT(NULL != store);
+    MODEL_ASSERT(NULL != hash);
+    MODEL_ASSERT(NULL != cert);
+
+    /* create a buffer for the digest. */
+    retval = vccrypt_suite_buffer_init_for_hash(store->suite, &digest);
+    if (VCCRYPT_STATUS_SUCCESS != retval)
+    {
+        goto done;
+    }
+
+    /* create the hash instance. */
+    retval = vccrypt_suite_hash_init(store->suite, &ctx);
+    if (VCCRYPT_STATUS_SUCCESS != retval)
+    {
+        goto cleanup_digest;
+    }
+
+    /* hash the certificate. */
+    retval = vccrypt_hash_digest(&ctx, (const uint8_t*)cert, size);
+    if (VCCRYPT_STATUS_SUCCESS != retval)
+    {
+        goto cleanup_hash;
+    }
+
+    retval = vccrypt_hash_finalize(&ctx, &digest);
+    if (VCCRYPT_STATUS_SUCCESS != retval)
+    {
+        goto cleanup_hash;
+    }
+
+    MODEL_ASSERT(digest.size == store->hash_size);
+    memcpy(hash, digest.data, store->hash_size);
+
+    /* success. */
+    retval = VCTOOL_STATUS_SUCCESS;
+
+cleanup_hash:
+    dispose((disposable_t*)&ctx);
+
+cleanup_digest:
+    dispose((disposable_t*)&digest);
+
+done:
+    return retval;
+}
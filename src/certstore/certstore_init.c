@@ -0,0 +1,142 @@
+/**
+ * \file certstore/certstore_init.c
+ *
+ * \brief Initialize a certificate store.
+ *
+ * \copyright 2020 Velo Payments.  See License.txt for license terms.
+ */
+
+#include <cbmc/model_assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vctool/certstore.h>
+
+/* forward decls. */
+static int certstore_mkdir(file* f, const char* root, const char* sub);
+static void certstore_dispose(void* disp);
+
+/**
+ * \brief Initialize a certificate store, creating its directories if needed.
+ *
+ * \param store         The store to initialize.
+ * \param f             The file abstraction layer to use.
+ * \param suite         The crypto suite used to hash certificates.
+ * \param root          The root directory of the store.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - VCTOOL_ERROR_GENERAL_OUT_OF_MEMORY if an allocation failed.
+ *      - a non-zero error code returned by the file layer.
+ */
+int certstore_init(
+    certstore* store, file* f, vccrypt_suite_options_t* suite,
+    const char* root)
+{
+    int retval;
+
+    /* parameter sanity checks. */
+    MODEL_ASSERT(NULL != store);
+    MODEL_ASSERT(PROP_FILE_VALID(f));
+    MODEL_ASSERT(NULL != suite);
+    MODEL_ASSERT(NULL != root);
+
+    /* clear the store. */
+    memset(store, 0, sizeof(certstore));
+
+    /* create the store directories. */
+    retval = certstore_mkdir(f, root, NULL);
+    if (VCTOOL_STATUS_SUCCESS != retval)
+    {
+        return retval;
+    }
+
+    retval = certstore_mkdir(f, root, CERTSTORE_OBJECTS_DIR);
+    if (VCTOOL_STATUS_SUCCESS != retval)
+    {
+        return retval;
+    }
+
+    retval = certstore_mkdir(f, root, CERTSTORE_REFS_DIR);
+    if (VCTOOL_STATUS_SUCCESS != retval)
+    {
+        return retval;
+    }
+
+    store->root = strdup(root);
+    if (NULL == store->root)
+    {
+        return VCTOOL_ERROR_GENERAL_OUT_OF_MEMORY;
+    }
+
+    store->hdr.dispose = &certstore_dispose;
+    store->f = f;
+    store->suite = suite;
+    store->hash_size = suite->hash_opts.hash_size;
+
+    /* success. */
+    return VCTOOL_STATUS_SUCCESS;
+}
+
+/**
+ * \brief Create a store directory, if it does not already exist.
+ *
+ * \param f             The file abstraction layer to use.
+ * \param root          The root directory of the store.
+ * \param sub           The subdirectory to create, or NULL for the root.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - VCTOOL_ERROR_GENERAL_OUT_OF_MEMORY if an allocation failed.
+ *      - a non-zero error code returned by the file layer.
+ */
+static int certstore_mkdir(file* f, const char* root, const char* sub)
+{
+    int retval;
+    char* path;
+
+    if (NULL == sub)
+    {
+        path = strdup(root);
+    }
+    else
+    {
+        size_t path_size = strlen(root) + strlen(sub) + 2;
+        path = (char*)malloc(path_size);
+        if (NULL != path)
+        {
+            snprintf(path, path_size, "%s/%s", root, sub);
+        }
+    }
+
+    if (NULL == path)
+    {
+        return VCTOOL_ERROR_GENERAL_OUT_OF_MEMORY;
+    }
+
+    retval =
+        file_mkdir(f, path, S_IRWXU | S_IRGRP | S_IXGRP | S_IROTH | S_IXOTH);
+    if (VCTOOL_ERROR_FILE_EXISTS == retval)
+    {
+        retval = VCTOOL_STATUS_SUCCESS;
+    }
+
+    free(path);
+
+    return retval;
+}
+
+/**
+ * \brief Dispose of a certificate store.
+ *
+ * \param disp          The store to dispose.
+ */
+static void certstore_dispose(void* disp)
+{
+    certstore* store = (certstore*)disp;
+
+    free(store->root);
+
+    /* clear the store. */
+    memset(store, 0, sizeof(certstore));
+}
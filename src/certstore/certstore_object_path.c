@@ -0,0 +1,65 @@
+/**
+ * \file certstore/certstore_object_path.c
+ *
+ * \brief Build the path of a certificate object.
+ *
+ * \copyright 2020 Velo Payments.  See License.txt for license terms.
+ */
+
+#include <cbmc/model_assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vctool/certstore.h>
+
+/**
+ * \brief Build the path of the object holding a certificate.
+ *
+ * \param store         The store.
+ * \param path          Pointer to receive the path, which the caller must
+ *                      free.
+ * \param hash          The store->hash_size byte hash of the certificate.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - VCTOOL_ERROR_GENERAL_OUT_OF_MEMORY if an allocation failed.
+ */
+int certstore_object_path(
+    certstore* store, char** path, const uint8_t* hash)
+{
+    static const char hex[] = "0123456789abcdef";
+
+    /* parameter sanity checks. */
+    MODEL_ASSERT(NULL != store);
+    MODEL_ASSERT(NULL != path);
+    MODEL_ASSERT(NULL != hash);
+    MODEL_ASSERT(store->hash_size > 1);
+
+    /* root, "/objects/", two digits, "/", the remaining digits. */
+    size_t prefix_size =
+        strlen(store->root) + strlen(CERTSTORE_OBJECTS_DIR) + 2;
+    size_t path_size = prefix_size + 2 * store->hash_size + 2;
+    char* out = (char*)malloc(path_size);
+    if (NULL == out)
+    {
+        return VCTOOL_ERROR_GENERAL_OUT_OF_MEMORY;
+    }
+
+    snprintf(out, path_size, "%s/%s/", store->root, CERTSTORE_OBJECTS_DIR);
+
+    /* the first byte names the fan-out directory. */
+    char* p = out + prefix_size;
+    *p++ = hex[hash[0] >> 4];
+    *p++ = hex[hash[0] & 0x0f];
+    *p++ = '/';
+    for (size_t i = 1; i < store->hash_size; ++i)
+    {
+        *p++ = hex[hash[i] >> 4];
+        *p++ = hex[hash[i] & 0x0f];
+    }
+    *p = 0;
+
+    *path = out;
+
+    return VCTOOL_STATUS_SUCCESS;
+}
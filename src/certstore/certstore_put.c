@@ -0,0 +1,84 @@
+/**
+ * \file certstore/certstore_put.c
+ *
+ * \brief Add a certificate to a certificate store.
+ *
+ * \copyright 2020 Velo Payments.  See License.txt for license terms.
+ */
+
+#include <cbmc/model_assert.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vctool/certstore.h>
+
+/**
+ * \brief Add a certificate to the store, unless it is already present.
+ *
+ * \param store         The store.
+ * \param hash          Buffer receiving the store->hash_size byte hash under
+ *                      which the certificate is stored.
+ * \param cert          The certificate bytes.
+ * \param size          The size of the certificate.
+ * \param mode          The read permissions of a new object, such as
+ *                      S_IRUSR alone for a private keypair.  Objects are
+ *                      never writable.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - a non-zero error code on failure.
+ */
+int certstore_put(
+    certstore* store, uint8_t* hash, const void* cert, size_t size,
+    mode_t mode)
+{
+    int retval;
+    file_stat_st fst;
+    char* path;
+
+    /* parameter sanity checks. */
+    MODEL_ASSERT(NULL != store);
+    MODEL_ASSERT(NULL != hash);
+    MODEL_ASSERT(NULL != cert);
+
+    /* the hash names the object. */
+    retval = certstore_hash(store, hash, cert, size);
+    if (VCTOOL_STATUS_SUCCESS != retval)
+    {
+        return retval;
+    }
+
+    retval = certstore_object_path(store, &path, hash);
+    if (VCTOOL_STATUS_SUCCESS != retval)
+    {
+        return retval;
+    }
+
+    /* a certificate which is already stored is not written again. */
+    retval = file_stat(store->f, path, &fst);
+    if (VCTOOL_ERROR_FILE_NO_ENTRY != retval)
+    {
+        goto cleanup_path;
+    }
+
+    /* create the fan-out directory, which ends at the last slash. */
+    char* slash = strrchr(path, '/');
+    *slash = 0;
+    retval =
+        file_mkdir(
+            store->f, path, S_IRWXU | S_IRGRP | S_IXGRP | S_IROTH | S_IXOTH);
+    *slash = '/';
+    if (VCTOOL_STATUS_SUCCESS != retval && VCTOOL_ERROR_FILE_EXISTS != retval)
+    {
+        goto cleanup_path;
+    }
+
+    /* objects are never modified once written. */
+    retval =
+        certstore_file_write(
+            store, path, cert, size, mode & (S_IRUSR | S_IRGRP | S_IROTH));
+
+cleanup_path:
+    free(path);
+
+    return retval;
+}
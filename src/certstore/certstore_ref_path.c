@@ -0,0 +1,55 @@
+/**
+ * \file certstore/certstore_ref_path.c
+ *
+ * \brief Build the path of a reference list.
+ *
+ * \copyright 2020 Velo Payments.  See License.txt for license terms.
+ */
+
+#include <cbmc/model_assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vctool/certstore.h>
+
+/**
+ * \brief Build the path of the reference list for a name.
+ *
+ * \param store         The store.
+ * \param path          Pointer to receive the path, which the caller must
+ *                      free.
+ * \param name          The name, which must be a plain file name.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - VCTOOL_ERROR_CERTSTORE_BAD_NAME if the name is not valid.
+ *      - VCTOOL_ERROR_GENERAL_OUT_OF_MEMORY if an allocation failed.
+ */
+int certstore_ref_path(certstore* store, char** path, const char* name)
+{
+    /* parameter sanity checks. */
+    MODEL_ASSERT(NULL != store);
+    MODEL_ASSERT(NULL != path);
+    MODEL_ASSERT(NULL != name);
+
+    /* a name may not be ".", "..", or leave the refs directory. */
+    if (0 == name[0] || '.' == name[0] || NULL != strchr(name, '/'))
+    {
+        return VCTOOL_ERROR_CERTSTORE_BAD_NAME;
+    }
+
+    size_t path_size =
+        strlen(store->root) + strlen(CERTSTORE_REFS_DIR) + strlen(name) + 3;
+    char* out = (char*)malloc(path_size);
+    if (NULL == out)
+    {
+        return VCTOOL_ERROR_GENERAL_OUT_OF_MEMORY;
+    }
+
+    snprintf(
+        out, path_size, "%s/%s/%s", store->root, CERTSTORE_REFS_DIR, name);
+
+    *path = out;
+
+    return VCTOOL_STATUS_SUCCESS;
+}
@@ -0,0 +1,63 @@
+/**
+ * \file certstore/certstore_ref_read.c
+ *
+ * \brief Read a reference list.
+ *
+ * \copyright 2020 Velo Payments.  See License.txt for license terms.
+ */
+
+#include <cbmc/model_assert.h>
+#include <stdlib.h>
+#include <vctool/certstore.h>
+
+/**
+ * \brief Read the reference list for a name.
+ *
+ * \param store         The store.
+ * \param hashes        Buffer to be initialized with the hashes in the list,
+ *                      back to back.  The caller owns this buffer on success
+ *                      and must dispose it.
+ * \param name          The name.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - VCTOOL_ERROR_CERTSTORE_BAD_NAME if the name is not valid.
+ *      - VCTOOL_ERROR_CERTSTORE_BAD_REF if the list is malformed.
+ *      - VCTOOL_ERROR_FILE_NO_ENTRY if there is no list for this name.
+ *      - a non-zero error code on failure.
+ */
+int certstore_ref_read(
+    certstore* store, vccrypt_buffer_t* hashes, const char* name)
+{
+    int retval;
+    char* path;
+
+    /* parameter sanity checks. */
+    MODEL_ASSERT(NULL != store);
+    MODEL_ASSERT(NULL != hashes);
+    MODEL_ASSERT(NULL != name);
+
+    retval = certstore_ref_path(store, &path, name);
+    if (VCTOOL_STATUS_SUCCESS != retval)
+    {
+        return retval;
+    }
+
+    retval = certstore_file_read(store, hashes, path);
+    if (VCTOOL_STATUS_SUCCESS != retval)
+    {
+        goto cleanup_path;
+    }
+
+    /* a list holds whole hashes. */
+    if (0 != hashes->size % store->hash_size)
+    {
+        dispose((disposable_t*)hashes);
+        retval = VCTOOL_ERROR_CERTSTORE_BAD_REF;
+    }
+
+cleanup_path:
+    free(path);
+
+    return retval;
+}
@@ -0,0 +1,51 @@
+/**
+ * \file certstore/certstore_ref_write.c
+ *
+ * \brief Replace a reference list.
+ *
+ * \copyright 2020 Velo Payments.  See License.txt for license terms.
+ */
+
+#include <cbmc/model_assert.h>
+#include <stdlib.h>
+#include <vctool/certstore.h>
+
+/**
+ * \brief Replace the reference list for a name.
+ *
+ * \param store         The store.
+ * \param name          The name, which must be a plain file name.
+ * \param hashes        The store->hash_size byte hashes in the list.
+ * \param count         The number of hashes.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - VCTOOL_ERROR_CERTSTORE_BAD_NAME if the name is not valid.
+ *      - a non-zero error code on failure.
+ */
+int certstore_ref_write(
+    certstore* store, const char* name, const uint8_t* hashes, size_t count)
+{
+    int retval;
+    char* path;
+
+    /* parameter sanity checks. */
+    MODEL_ASSERT(NULL != store);
+    MODEL_ASSERT(NULL != name);
+    MODEL_ASSERT(0 == count || NULL != hashes);
+
+    retval = certstore_ref_path(store, &path, name);
+    if (VCTOOL_STATUS_SUCCESS != retval)
+    {
+        return retval;
+    }
+
+    retval =
+        certstore_file_write(
+            store, path, hashes, count * store->hash_size,
+            S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH);
+
+    free(path);
+
+    return retval;
+}
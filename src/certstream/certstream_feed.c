@@ -0,0 +1,222 @@
+/**
+ * \file certstream/certstream_feed.c
+ *
+ * \brief Feed the next chunk of a certificate to a stream.
+ *
+ * \copyright 2020 Velo Payments.  See License.txt for license terms.
+ */
+
+#include <cbmc/model_assert.h>
+#include <string.h>
+#include <vccert/fields.h>
+#include <vctool/certstream.h>
+
+/* forward decls. */
+static size_t certstream_field_size(const uint8_t* header);
+static int certstream_emit(certstream* stream, const uint8_t* field);
+static int certstream_emit_transaction(
+    certstream* stream, const uint8_t* cert, size_t size, uint64_t offset);
+
+/**
+ * \brief Feed the next chunk of a certificate to a stream.
+ *
+ * A field split from an earlier chunk is completed first.  The fields which
+ * follow are passed straight from the chunk, and a field split at the end of
+ * the chunk is held until the next.
+ *
+ * \param stream        The stream.
+ * \param data          The chunk.
+ * \param size          The size of the chunk, which may be zero.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - VCTOOL_ERROR_CERTSTREAM_BAD_TRANSACTION if a field of a wrapped
+ *        transaction runs past the end of the transaction.
+ *      - a non-zero status code returned by the callback.
+ */
+int certstream_feed(certstream* stream, const uint8_t* data, size_t size)
+{
+    int retval;
+    size_t take;
+
+    /* parameter sanity checks. */
+    MODEL_ASSERT(NULL != stream);
+    MODEL_ASSERT(0 == size || NULL != data);
+
+    if (0 == size)
+    {
+        return VCTOOL_STATUS_SUCCESS;
+    }
+
+    /* complete the field held from the last chunk. */
+    if (stream->pending > 0)
+    {
+        /* the header says how much more to take. */
+        if (stream->pending < CERTSTREAM_FIELD_HEADER_SIZE)
+        {
+            take = CERTSTREAM_FIELD_HEADER_SIZE - stream->pending;
+            take = (take < size) ? take : size;
+            memcpy(stream->buffer + stream->pending, data, take);
+            stream->pending += take;
+            data += take;
+            size -= take;
+
+            if (stream->pending < CERTSTREAM_FIELD_HEADER_SIZE)
+            {
+                return VCTOOL_STATUS_SUCCESS;
+            }
+        }
+
+        size_t total = certstream_field_size(stream->buffer);
+        total += CERTSTREAM_FIELD_HEADER_SIZE;
+        take = total - stream->pending;
+        take = (take < size) ? take : size;
+        memcpy(stream->buffer + stream->pending, data, take);
+        stream->pending += take;
+        data += take;
+        size -= take;
+
+        if (stream->pending < total)
+        {
+            return VCTOOL_STATUS_SUCCESS;
+        }
+
+        stream->pending = 0;
+        retval = certstream_emit(stream, stream->buffer);
+        if (VCTOOL_STATUS_SUCCESS != retval)
+        {
+            return retval;
+        }
+    }
+
+    /* pass each whole field straight from the chunk. */
+    while (size >= CERTSTREAM_FIELD_HEADER_SIZE)
+    {
+        size_t total =
+            CERTSTREAM_FIELD_HEADER_SIZE + certstream_field_size(data);
+        if (size < total)
+        {
+            break;
+        }
+
+        retval = certstream_emit(stream, data);
+        if (VCTOOL_STATUS_SUCCESS != retval)
+        {
+            return retval;
+        }
+
+        data += total;
+        size -= total;
+    }
+
+    /* hold the start of a field split at the end of the chunk. */
+    if (size > 0)
+    {
+        memcpy(stream->buffer, data, size);
+        stream->pending = size;
+    }
+
+    return VCTOOL_STATUS_SUCCESS;
+}
+
+/**
+ * \brief Read the value size from a field header.
+ *
+ * \param header        The field header.
+ *
+ * \returns the size of the value.
+ */
+static size_t certstream_field_size(const uint8_t* header)
+{
+    return ((size_t)header[2] << 8) | (size_t)header[3];
+}
+
+/**
+ * \brief Pass a whole field to the callback, followed by the fields of a
+ * wrapped transaction.
+ *
+ * \param stream        The stream.
+ * \param field         The field, starting with its header.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - VCTOOL_ERROR_CERTSTREAM_BAD_TRANSACTION if a field of a wrapped
+ *        transaction runs past the end of the transaction.
+ *      - a non-zero status code returned by the callback.
+ */
+static int certstream_emit(certstream* stream, const uint8_t* field)
+{
+    int retval;
+    certstream_field f;
+
+    f.depth = 0;
+    f.type = (uint16_t)((field[0] << 8) | field[1]);
+    f.value = field + CERTSTREAM_FIELD_HEADER_SIZE;
+    f.size = certstream_field_size(field);
+    f.offset = stream->offset + CERTSTREAM_FIELD_HEADER_SIZE;
+
+    stream->offset += CERTSTREAM_FIELD_HEADER_SIZE + f.size;
+
+    retval = stream->field_fn(stream->context, &f);
+    if (VCTOOL_STATUS_SUCCESS != retval)
+    {
+        return retval;
+    }
+
+    if (VCCERT_FIELD_TYPE_WRAPPED_TRANSACTION_TUPLE == f.type)
+    {
+        return certstream_emit_transaction(stream, f.value, f.size, f.offset);
+    }
+
+    return VCTOOL_STATUS_SUCCESS;
+}
+
+/**
+ * \brief Pass each field of a wrapped transaction to the callback.
+ *
+ * \param stream        The stream.
+ * \param cert          The transaction certificate.
+ * \param size          The size of the transaction certificate.
+ * \param offset        The offset of the transaction in the stream.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - VCTOOL_ERROR_CERTSTREAM_BAD_TRANSACTION if a field runs past the end
+ *        of the transaction.
+ *      - a non-zero status code returned by the callback.
+ */
+static int certstream_emit_transaction(
+    certstream* stream, const uint8_t* cert, size_t size, uint64_t offset)
+{
+    int retval;
+    certstream_field f;
+
+    f.depth = 1;
+    for (size_t pos = 0; pos < size;)
+    {
+        if (size - pos < CERTSTREAM_FIELD_HEADER_SIZE)
+        {
+            return VCTOOL_ERROR_CERTSTREAM_BAD_TRANSACTION;
+        }
+
+        f.type = (uint16_t)((cert[pos] << 8) | cert[pos + 1]);
+        f.size = certstream_field_size(cert + pos);
+        pos += CERTSTREAM_FIELD_HEADER_SIZE;
+        if (size - pos < f.size)
+        {
+            return VCTOOL_ERROR_CERTSTREAM_BAD_TRANSACTION;
+        }
+
+        f.value = cert + pos;
+        f.offset = offset + pos;
+        pos += f.size;
+
+        retval = stream->field_fn(stream->context, &f);
+        if (VCTOOL_STATUS_SUCCESS != retval)
+        {
+            return retval;
+        }
+    }
+
+    return VCTOOL_STATUS_SUCCESS;
+}
@@ -0,0 +1,32 @@
+/**
+ * \file certstream/certstream_finish.c
+ *
+ * \brief Check that a certificate stream ended between fields.
+ *
+ * \copyright 2020 Velo Payments.  See License.txt for license terms.
+ */
+
+#include <cbmc/model_assert.h>
+#include <vctool/certstream.h>
+
+/**
+ * \brief Check that a certificate stream ended between fields.
+ *
+ * \param stream        The stream.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - VCTOOL_ERROR_CERTSTREAM_TRUNCATED if the stream ended inside a field.
+ */
+int certstream_finish(const certstream* stream)
+{
+    /* parameter sanity checks. */
+    MODEL_ASSERT(NULL != stream);
+
+    if (stream->pending > 0)
+    {
+        return VCTOOL_ERROR_CERTSTREAM_TRUNCATED;
+    }
+
+    return VCTOOL_STATUS_SUCCESS;
+}
@@ -0,0 +1,30 @@
+/**
+ * \file certstream/certstream_init.c
+ *
+ * \brief Initialize a certificate stream.
+ *
+ * \copyright 2020 Velo Payments.  See License.txt for license terms.
+ */
+
+#include <cbmc/model_assert.h>
+#include <vctool/certstream.h>
+
+/**
+ * \brief Initialize a certificate stream.
+ *
+ * \param stream        The stream to initialize.
+ * \param field_fn      The callback which receives each field.
+ * \param context       The user context for the callback.
+ */
+void certstream_init(
+    certstream* stream, certstream_field_fn field_fn, void* context)
+{
+    /* parameter sanity checks. */
+    MODEL_ASSERT(NULL != stream);
+    MODEL_ASSERT(NULL != field_fn);
+
+    stream->field_fn = field_fn;
+    stream->context = context;
+    stream->offset = 0;
+    stream->pending = 0;
+}
@@ -0,0 +1,57 @@
+/**
+ * \file certstream/certstream_read.c
+ *
+ * \brief Parse a certificate read from a descriptor.
+ *
+ * \copyright 2020 Velo Payments.  See License.txt for license terms.
+ */
+
+#include <cbmc/model_assert.h>
+#include <vctool/certstream.h>
+
+/**
+ * \brief Parse a certificate read from a descriptor until end of file.
+ *
+ * Only one chunk of the certificate is held at a time.
+ *
+ * \param stream        The stream.
+ * \param f             The file abstraction layer.
+ * \param fd            The descriptor to read from.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - VCTOOL_ERROR_CERTSTREAM_TRUNCATED if the file ended inside a field.
+ *      - a non-zero error code returned by certstream_feed or the file layer.
+ */
+int certstream_read(certstream* stream, file* f, int fd)
+{
+    int retval;
+    size_t read_bytes;
+
+    /* parameter sanity checks. */
+    MODEL_ASSERT(NULL != stream);
+    MODEL_ASSERT(PROP_FILE_VALID(f));
+
+    for (;;)
+    {
+        retval =
+            file_read(
+                f, fd, stream->chunk, sizeof(stream->chunk), &read_bytes);
+        if (VCTOOL_STATUS_SUCCESS != retval)
+        {
+            return retval;
+        }
+
+        /* end of file. */
+        if (0 == read_bytes)
+        {
+            return certstream_finish(stream);
+        }
+
+        retval = certstream_feed(stream, stream->chunk, read_bytes);
+        if (VCTOOL_STATUS_SUCCESS != retval)
+        {
+            return retval;
+        }
+    }
+}
@@ -0,0 +1,514 @@
+/**
+ * \file certtemplate/certtemplate_compile.c
+ *
+ * \brief Compile a certificate template.
+ *
+ * \copyright 2020 Velo Payments.  See License.txt for license terms.
+ */
+
+#include <cbmc/model_assert.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vccert/fields.h>
+#include <vctool/certtemplate.h>
+
+/* the longest field type or kind word. */
+#define CERTTEMPLATE_WORD_MAX                           64
+
+/**
+ * \brief A named field type.
+ */
+typedef struct certtemplate_field_name
+{
+    const char* name;
+    uint16_t type;
+} certtemplate_field_name;
+
+/**
+ * \brief A named kind, with the size of its values.
+ */
+typedef struct certtemplate_kind_name
+{
+    const char* name;
+    uint32_t kind;
+    size_t size;
+} certtemplate_kind_name;
+
+/* field types by name. */
+static const certtemplate_field_name certtemplate_fields[] = {
+    { "certificate_version", VCCERT_FIELD_TYPE_CERTIFICATE_VERSION },
+    { "certificate_valid_from", VCCERT_FIELD_TYPE_CERTIFICATE_VALID_FROM },
+    { "certificate_valid_to", VCCERT_FIELD_TYPE_CERTIFICATE_VALID_TO },
+    { "certificate_crypto_suite",
+      VCCERT_FIELD_TYPE_CERTIFICATE_CRYPTO_SUITE },
+    { "certificate_type", VCCERT_FIELD_TYPE_CERTIFICATE_TYPE },
+    { "certificate_id", VCCERT_FIELD_TYPE_CERTIFICATE_ID },
+    { "previous_certificate_id",
+      VCCERT_FIELD_TYPE_PREVIOUS_CERTIFICATE_ID },
+    { "signer_id", VCCERT_FIELD_TYPE_SIGNER_ID },
+    { "artifact_id", VCCERT_FIELD_TYPE_ARTIFACT_ID },
+    { "artifact_type", VCCERT_FIELD_TYPE_ARTIFACT_TYPE },
+    { "previous_artifact_state",
+      VCCERT_FIELD_TYPE_PREVIOUS_ARTIFACT_STATE },
+    { "new_artifact_state", VCCERT_FIELD_TYPE_NEW_ARTIFACT_STATE },
+    { "block_height", VCCERT_FIELD_TYPE_BLOCK_HEIGHT },
+    { "public_encryption_key", VCCERT_FIELD_TYPE_PUBLIC_ENCRYPTION_KEY },
+    { "private_encryption_key", VCCERT_FIELD_TYPE_PRIVATE_ENCRYPTION_KEY },
+    { "public_signing_key", VCCERT_FIELD_TYPE_PUBLIC_SIGNING_KEY },
+    { "private_signing_key", VCCERT_FIELD_TYPE_PRIVATE_SIGNING_KEY },
+};
+
+/* kinds by name. */
+static const certtemplate_kind_name certtemplate_kinds[] = {
+    { "uint8", CERTTEMPLATE_UINT8, 1 },
+    { "uint16", CERTTEMPLATE_UINT16, 2 },
+    { "uint32", CERTTEMPLATE_UINT32, 4 },
+    { "uint64", CERTTEMPLATE_UINT64, 8 },
+    { "uuid", CERTTEMPLATE_UUID, 16 },
+    { "hex", CERTTEMPLATE_HEX, 0 },
+    { "string", CERTTEMPLATE_STRING, 0 },
+};
+
+/* forward decls. */
+static void certtemplate_dispose(void* disp);
+static int certtemplate_compile_line(
+    certtemplate* tmpl, const char* text, size_t size, size_t* run_start,
+    bool* fixed);
+static size_t certtemplate_word(
+    const char* text, size_t size, size_t* offset, char* word);
+static int certtemplate_field_type(const char* word, uint16_t* type);
+static const certtemplate_kind_name* certtemplate_kind(const char* word);
+static int certtemplate_column(const char* value, size_t size, size_t* column);
+static int certtemplate_add_literal(
+    certtemplate* tmpl, const uint8_t* bytes, size_t size);
+static int certtemplate_add_step(
+    certtemplate* tmpl, size_t* run_start, uint32_t kind, size_t column,
+    size_t size, size_t offset);
+static void certtemplate_write_u16(uint8_t* buf, uint16_t val);
+
+/**
+ * \brief Compile a certificate template.
+ *
+ * \param tmpl          The template to initialize.
+ * \param text          The template text.
+ * \param size          The size of the template text.
+ * \param line          Set to the line number of an error.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - VCTOOL_ERROR_CERTTEMPLATE_BAD_TEMPLATE if a line is malformed.
+ *      - VCTOOL_ERROR_GENERAL_OUT_OF_MEMORY if an allocation failed.
+ */
+int certtemplate_compile(
+    certtemplate* tmpl, const char* text, size_t size, size_t* line)
+{
+    int retval;
+    size_t run_start = 0;
+    bool fixed = true;
+
+    /* parameter sanity checks. */
+    MODEL_ASSERT(NULL != tmpl);
+    MODEL_ASSERT(NULL != text || 0 == size);
+    MODEL_ASSERT(NULL != line);
+
+    memset(tmpl, 0, sizeof(certtemplate));
+    *line = 0;
+
+    for (size_t offset = 0; offset < size;)
+    {
+        const char* start = text + offset;
+        const char* end = (const char*)memchr(start, '\n', size - offset);
+        size_t length = (NULL == end) ? size - offset : (size_t)(end - start);
+        offset += length + 1;
+        ++*line;
+
+        retval =
+            certtemplate_compile_line(
+                tmpl, start, length, &run_start, &fixed);
+        if (VCTOOL_STATUS_SUCCESS != retval)
+        {
+            goto cleanup_template;
+        }
+    }
+
+    /* the last step copies the trailing literals. */
+    retval =
+        certtemplate_add_step(
+            tmpl, &run_start, CERTTEMPLATE_END, 0, 0, CERTTEMPLATE_VARIABLE);
+    if (VCTOOL_STATUS_SUCCESS != retval)
+    {
+        goto cleanup_template;
+    }
+
+    tmpl->max_size =
+        tmpl->fixed_size + tmpl->variable_count * CERTTEMPLATE_FIELD_MAX;
+    tmpl->hdr.dispose = &certtemplate_dispose;
+    *line = 0;
+
+    return VCTOOL_STATUS_SUCCESS;
+
+cleanup_template:
+    free(tmpl->steps);
+    free(tmpl->literals);
+    memset(tmpl, 0, sizeof(certtemplate));
+
+    return retval;
+}
+
+/**
+ * \brief Dispose of a compiled template.
+ *
+ * \param disp          The template to dispose.
+ */
+static void certtemplate_dispose(void* disp)
+{
+    certtemplate* tmpl = (certtemplate*)disp;
+
+    free(tmpl->steps);
+    free(tmpl->literals);
+}
+
+/**
+ * \brief Compile a line of a template.
+ *
+ * \param tmpl          The template being compiled.
+ * \param text          The line.
+ * \param size          The size of the line.
+ * \param run_start     The start of the current literal run.
+ * \param fixed         True while every value so far has a fixed size.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - VCTOOL_ERROR_CERTTEMPLATE_BAD_TEMPLATE if the line is malformed.
+ *      - VCTOOL_ERROR_GENERAL_OUT_OF_MEMORY if an allocation failed.
+ */
+static int certtemplate_compile_line(
+    certtemplate* tmpl, const char* text, size_t size, size_t* run_start,
+    bool* fixed)
+{
+    int retval;
+    size_t offset = 0;
+    uint16_t type;
+    char field_word[CERTTEMPLATE_WORD_MAX + 1];
+    char kind_word[CERTTEMPLATE_WORD_MAX + 1];
+    uint8_t header[CERTTEMPLATE_FIELD_HEADER_SIZE];
+
+    /* tolerate CRLF line endings, and trailing blanks. */
+    while (size > 0
+        && (' ' == text[size - 1] || '\t' == text[size - 1]
+         || '\r' == text[size - 1]))
+    {
+        --size;
+    }
+
+    /* blank lines and comments are skipped. */
+    if (0 == certtemplate_word(text, size, &offset, field_word)
+     || '#' == field_word[0])
+    {
+        return VCTOOL_STATUS_SUCCESS;
+    }
+
+    if (0 == certtemplate_word(text, size, &offset, kind_word)
+     || VCTOOL_STATUS_SUCCESS != certtemplate_field_type(field_word, &type))
+    {
+        return VCTOOL_ERROR_CERTTEMPLATE_BAD_TEMPLATE;
+    }
+
+    const certtemplate_kind_name* kind = certtemplate_kind(kind_word);
+    if (NULL == kind)
+    {
+        return VCTOOL_ERROR_CERTTEMPLATE_BAD_TEMPLATE;
+    }
+
+    /* the value is the rest of the line. */
+    while (offset < size && (' ' == text[offset] || '\t' == text[offset]))
+    {
+        ++offset;
+    }
+
+    const char* value = text + offset;
+    size_t value_size = size - offset;
+
+    certtemplate_write_u16(header, type);
+
+    /* a literal field is encoded whole. */
+    size_t column;
+    if (VCTOOL_STATUS_SUCCESS !=
+            certtemplate_column(value, value_size, &column))
+    {
+        uint8_t encoded[CERTTEMPLATE_FIELD_MAX];
+        size_t encoded_size;
+
+        if (value_size > CERTTEMPLATE_FIELD_MAX
+         || VCTOOL_STATUS_SUCCESS !=
+                certtemplate_encode(
+                    kind->kind, value, value_size, encoded, &encoded_size))
+        {
+            return VCTOOL_ERROR_CERTTEMPLATE_BAD_TEMPLATE;
+        }
+
+        certtemplate_write_u16(header + 2, (uint16_t)encoded_size);
+        retval = certtemplate_add_literal(tmpl, header, sizeof(header));
+        if (VCTOOL_STATUS_SUCCESS != retval)
+        {
+            return retval;
+        }
+
+        tmpl->fixed_size += sizeof(header) + encoded_size;
+
+        return certtemplate_add_literal(tmpl, encoded, encoded_size);
+    }
+
+    if (column >= tmpl->column_count)
+    {
+        tmpl->column_count = column + 1;
+    }
+
+    size_t value_offset =
+        *fixed
+            ? tmpl->fixed_size + sizeof(header)
+            : CERTTEMPLATE_VARIABLE;
+    tmpl->fixed_size += sizeof(header) + kind->size;
+
+    /* the header of a fixed size value is known; a variable size value
+     * leaves its size to be written with it. */
+    if (kind->size > 0)
+    {
+        certtemplate_write_u16(header + 2, (uint16_t)kind->size);
+        retval = certtemplate_add_literal(tmpl, header, sizeof(header));
+    }
+    else
+    {
+        *fixed = false;
+        ++tmpl->variable_count;
+        retval = certtemplate_add_literal(tmpl, header, 2);
+    }
+
+    if (VCTOOL_STATUS_SUCCESS != retval)
+    {
+        return retval;
+    }
+
+    return
+        certtemplate_add_step(
+            tmpl, run_start, kind->kind, column, kind->size, value_offset);
+}
+
+/**
+ * \brief Read the next blank separated word of a line.
+ *
+ * \param text          The line.
+ * \param size          The size of the line.
+ * \param offset        The offset to read from, which is advanced.
+ * \param word          Buffer of CERTTEMPLATE_WORD_MAX + 1 bytes receiving
+ *                      the word; a longer word is cut short.
+ *
+ * \returns the length of the word, or zero at the end of the line.
+ */
+static size_t certtemplate_word(
+    const char* text, size_t size, size_t* offset, char* word)
+{
+    size_t length = 0;
+
+    while (*offset < size && (' ' == text[*offset] || '\t' == text[*offset]))
+    {
+        ++*offset;
+    }
+
+    while (*offset < size && ' ' != text[*offset] && '\t' != text[*offset])
+    {
+        if (length < CERTTEMPLATE_WORD_MAX)
+        {
+            word[length++] = text[*offset];
+        }
+
+        ++*offset;
+    }
+
+    word[length] = 0;
+
+    return length;
+}
+
+/**
+ * \brief Look up a field type by name or number.
+ *
+ * \param word          The name, or a decimal or 0x prefixed hex number.
+ * \param type          Set to the field type.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - VCTOOL_ERROR_CERTTEMPLATE_BAD_TEMPLATE if the field is unknown.
+ */
+static int certtemplate_field_type(const char* word, uint16_t* type)
+{
+    uint8_t encoded[2];
+    size_t encoded_size;
+
+    for (size_t i = 0;
+         i < sizeof(certtemplate_fields) / sizeof(certtemplate_fields[0]);
+         ++i)
+    {
+        if (!strcmp(word, certtemplate_fields[i].name))
+        {
+            *type = certtemplate_fields[i].type;
+            return VCTOOL_STATUS_SUCCESS;
+        }
+    }
+
+    if (VCTOOL_STATUS_SUCCESS !=
+            certtemplate_encode(
+                CERTTEMPLATE_UINT16, word, strlen(word), encoded,
+                &encoded_size))
+    {
+        return VCTOOL_ERROR_CERTTEMPLATE_BAD_TEMPLATE;
+    }
+
+    *type = (uint16_t)((encoded[0] << 8) | encoded[1]);
+
+    return VCTOOL_STATUS_SUCCESS;
+}
+
+/**
+ * \brief Look up a kind by name.
+ *
+ * \param word          The name.
+ *
+ * \returns the kind, or NULL if it is unknown.
+ */
+static const certtemplate_kind_name* certtemplate_kind(const char* word)
+{
+    for (size_t i = 0;
+         i < sizeof(certtemplate_kinds) / sizeof(certtemplate_kinds[0]);
+         ++i)
+    {
+        if (!strcmp(word, certtemplate_kinds[i].name))
+        {
+            return &certtemplate_kinds[i];
+        }
+    }
+
+    return NULL;
+}
+
+/**
+ * \brief Parse a $N column reference.
+ *
+ * \param value         The value.
+ * \param size          The size of the value.
+ * \param column        Set to the zero-based column.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS if the value is a column reference.
+ *      - VCTOOL_ERROR_CERTTEMPLATE_BAD_VALUE if it is a literal.
+ */
+static int certtemplate_column(const char* value, size_t size, size_t* column)
+{
+    size_t number = 0;
+
+    if (size < 2 || size > 6 || '$' != value[0])
+    {
+        return VCTOOL_ERROR_CERTTEMPLATE_BAD_VALUE;
+    }
+
+    for (size_t i = 1; i < size; ++i)
+    {
+        if (value[i] < '0' || value[i] > '9')
+        {
+            return VCTOOL_ERROR_CERTTEMPLATE_BAD_VALUE;
+        }
+
+        number = number * 10 + (size_t)(value[i] - '0');
+    }
+
+    /* columns are numbered from one. */
+    if (0 == number)
+    {
+        return VCTOOL_ERROR_CERTTEMPLATE_BAD_VALUE;
+    }
+
+    *column = number - 1;
+
+    return VCTOOL_STATUS_SUCCESS;
+}
+
+/**
+ * \brief Append bytes to the current literal run.
+ *
+ * \param tmpl          The template being compiled.
+ * \param bytes         The bytes.
+ * \param size          The number of bytes.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - VCTOOL_ERROR_GENERAL_OUT_OF_MEMORY if an allocation failed.
+ */
+static int certtemplate_add_literal(
+    certtemplate* tmpl, const uint8_t* bytes, size_t size)
+{
+    uint8_t* literals =
+        (uint8_t*)realloc(tmpl->literals, tmpl->literal_size + size + 1);
+    if (NULL == literals)
+    {
+        return VCTOOL_ERROR_GENERAL_OUT_OF_MEMORY;
+    }
+
+    memcpy(literals + tmpl->literal_size, bytes, size);
+    tmpl->literals = literals;
+    tmpl->literal_size += size;
+
+    return VCTOOL_STATUS_SUCCESS;
+}
+
+/**
+ * \brief End the current literal run with a step.
+ *
+ * \param tmpl          The template being compiled.
+ * \param run_start     The start of the literal run, which is moved past it.
+ * \param kind          The kind of the value.
+ * \param column        The column of the value.
+ * \param size          The size of the value, or zero.
+ * \param offset        The offset of the value in the certificate.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - VCTOOL_ERROR_GENERAL_OUT_OF_MEMORY if an allocation failed.
+ */
+static int certtemplate_add_step(
+    certtemplate* tmpl, size_t* run_start, uint32_t kind, size_t column,
+    size_t size, size_t offset)
+{
+    certtemplate_step* steps =
+        (certtemplate_step*)realloc(
+            tmpl->steps, (tmpl->step_count + 1) * sizeof(certtemplate_step));
+    if (NULL == steps)
+    {
+        return VCTOOL_ERROR_GENERAL_OUT_OF_MEMORY;
+    }
+
+    certtemplate_step* step = steps + tmpl->step_count;
+    step->literal_offset = *run_start;
+    step->literal_size = tmpl->literal_size - *run_start;
+    step->kind = kind;
+    step->column = column;
+    step->size = size;
+    step->offset = offset;
+
+    tmpl->steps = steps;
+    ++tmpl->step_count;
+    *run_start = tmpl->literal_size;
+
+    return VCTOOL_STATUS_SUCCESS;
+}
+
+/**
+ * \brief Write a big-endian 16-bit value.
+ *
+ * \param buf           The buffer to which the value is written.
+ * \param val           The value to write.
+ */
+static void certtemplate_write_u16(uint8_t* buf, uint16_t val)
+{
+    buf[0] = (uint8_t)(val >> 8);
+    buf[1] = (uint8_t)val;
+}
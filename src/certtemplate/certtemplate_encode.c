@@ -0,0 +1,190 @@
+/**
+ * \file certtemplate/certtemplate_encode.c
+ *
+ * \brief Encode a template value.
+ *
+ * \copyright 2020 Velo Payments.  See License.txt for license terms.
+ */
+
+#include <cbmc/model_assert.h>
+#include <string.h>
+#include <vctool/certtemplate.h>
+#include <vctool/uuid.h>
+
+/* forward decls. */
+static int certtemplate_encode_uint(
+    const char* value, size_t size, uint8_t* out, size_t width);
+static int certtemplate_digit(char ch, unsigned base);
+
+/**
+ * \brief Encode a value of a kind as field bytes.
+ *
+ * Integers are decimal, or hex with a 0x prefix.  Uuids are canonical or 32
+ * bare hex digits.
+ *
+ * \param kind          The kind of the value.
+ * \param value         The value, which need not be NUL-terminated.
+ * \param size          The size of the value.
+ * \param out           Buffer receiving the encoded value, large enough for
+ *                      the kind's size, half of size for hex, or size for a
+ *                      string.
+ * \param out_size      Set to the size of the encoded value.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - VCTOOL_ERROR_CERTTEMPLATE_BAD_VALUE if the value does not match its
+ *        kind.
+ */
+int certtemplate_encode(
+    uint32_t kind, const char* value, size_t size, uint8_t* out,
+    size_t* out_size)
+{
+    char uuid_str[UUID_STRING_SIZE];
+
+    /* parameter sanity checks. */
+    MODEL_ASSERT(NULL != value || 0 == size);
+    MODEL_ASSERT(NULL != out);
+    MODEL_ASSERT(NULL != out_size);
+
+    switch (kind)
+    {
+        case CERTTEMPLATE_UINT8:
+            *out_size = 1;
+            return certtemplate_encode_uint(value, size, out, 1);
+
+        case CERTTEMPLATE_UINT16:
+            *out_size = 2;
+            return certtemplate_encode_uint(value, size, out, 2);
+
+        case CERTTEMPLATE_UINT32:
+            *out_size = 4;
+            return certtemplate_encode_uint(value, size, out, 4);
+
+        case CERTTEMPLATE_UINT64:
+            *out_size = 8;
+            return certtemplate_encode_uint(value, size, out, 8);
+
+        case CERTTEMPLATE_UUID:
+            if (size >= sizeof(uuid_str))
+            {
+                return VCTOOL_ERROR_CERTTEMPLATE_BAD_VALUE;
+            }
+
+            memcpy(uuid_str, value, size);
+            uuid_str[size] = 0;
+            *out_size = UUID_SIZE;
+            if (VCTOOL_STATUS_SUCCESS != uuid_from_string(out, uuid_str))
+            {
+                return VCTOOL_ERROR_CERTTEMPLATE_BAD_VALUE;
+            }
+
+            return VCTOOL_STATUS_SUCCESS;
+
+        case CERTTEMPLATE_HEX:
+            if (size % 2)
+            {
+                return VCTOOL_ERROR_CERTTEMPLATE_BAD_VALUE;
+            }
+
+            for (size_t i = 0; i < size; i += 2)
+            {
+                int high = certtemplate_digit(value[i], 16);
+                int low = certtemplate_digit(value[i + 1], 16);
+                if (high < 0 || low < 0)
+                {
+                    return VCTOOL_ERROR_CERTTEMPLATE_BAD_VALUE;
+                }
+
+                out[i / 2] = (uint8_t)((high << 4) | low);
+            }
+
+            *out_size = size / 2;
+            return VCTOOL_STATUS_SUCCESS;
+
+        case CERTTEMPLATE_STRING:
+            memcpy(out, value, size);
+            *out_size = size;
+            return VCTOOL_STATUS_SUCCESS;
+
+        default:
+            return VCTOOL_ERROR_CERTTEMPLATE_BAD_VALUE;
+    }
+}
+
+/**
+ * \brief Encode an unsigned integer big-endian.
+ *
+ * \param value         The integer, in decimal or 0x prefixed hex.
+ * \param size          The size of the value.
+ * \param out           Buffer receiving the integer.
+ * \param width         The width of the integer in bytes.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - VCTOOL_ERROR_CERTTEMPLATE_BAD_VALUE if the value is not an integer
+ *        or does not fit.
+ */
+static int certtemplate_encode_uint(
+    const char* value, size_t size, uint8_t* out, size_t width)
+{
+    unsigned base = 10;
+    uint64_t val = 0;
+    uint64_t max = (8 == width) ? UINT64_MAX : (1ULL << (8 * width)) - 1;
+
+    if (size > 2 && '0' == value[0] && ('x' == value[1] || 'X' == value[1]))
+    {
+        base = 16;
+        value += 2;
+        size -= 2;
+    }
+
+    if (0 == size)
+    {
+        return VCTOOL_ERROR_CERTTEMPLATE_BAD_VALUE;
+    }
+
+    for (size_t i = 0; i < size; ++i)
+    {
+        int digit = certtemplate_digit(value[i], base);
+        if (digit < 0 || val > (max - (uint64_t)digit) / base)
+        {
+            return VCTOOL_ERROR_CERTTEMPLATE_BAD_VALUE;
+        }
+
+        val = val * base + (uint64_t)digit;
+    }
+
+    for (size_t i = width; i > 0; --i)
+    {
+        out[i - 1] = (uint8_t)val;
+        val >>= 8;
+    }
+
+    return VCTOOL_STATUS_SUCCESS;
+}
+
+/**
+ * \brief Decode a digit.
+ *
+ * \param ch            The character.
+ * \param base          10 or 16.
+ *
+ * \returns the value of the digit, or -1 if it is not a digit.
+ */
+static int certtemplate_digit(char ch, unsigned base)
+{
+    if (ch >= '0' && ch <= '9')
+    {
+        return ch - '0';
+    }
+    else if (16 == base && ch >= 'a' && ch <= 'f')
+    {
+        return ch - 'a' + 10;
+    }
+    else if (16 == base && ch >= 'A' && ch <= 'F')
+    {
+        return ch - 'A' + 10;
+    }
+
+    return -1;
+}
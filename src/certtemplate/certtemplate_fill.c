@@ -0,0 +1,155 @@
+/**
+ * \file certtemplate/certtemplate_fill.c
+ *
+ * \brief Fill a template with a row.
+ *
+ * \copyright 2020 Velo Payments.  See License.txt for license terms.
+ */
+
+#include <cbmc/model_assert.h>
+#include <string.h>
+#include <vctool/certtemplate.h>
+
+/* forward decls. */
+static int certtemplate_value_size(
+    uint32_t kind, size_t value_size, size_t* size);
+
+/**
+ * \brief Fill a template with a row, writing the certificate.
+ *
+ * \param tmpl          The compiled template.
+ * \param values        The column values of the row, which need not be
+ *                      NUL-terminated.
+ * \param value_sizes   The size of each column value.
+ * \param count         The number of columns.
+ * \param cert          Buffer receiving the certificate.
+ * \param capacity      The size of the buffer; max_size always suffices.
+ * \param cert_size     Set to the size of the certificate.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - VCTOOL_ERROR_CERTTEMPLATE_MISSING_COLUMN if the row has too few
+ *        columns.
+ *      - VCTOOL_ERROR_CERTTEMPLATE_BAD_VALUE if a value does not match its
+ *        kind.
+ *      - VCTOOL_ERROR_CERTTEMPLATE_BUFFER_TOO_SMALL if the certificate does
+ *        not fit; cert_size is set to the size needed.
+ */
+int certtemplate_fill(
+    const certtemplate* tmpl, const char* const* values,
+    const size_t* value_sizes, size_t count, uint8_t* cert, size_t capacity,
+    size_t* cert_size)
+{
+    int retval;
+    size_t size;
+
+    /* parameter sanity checks. */
+    MODEL_ASSERT(NULL != tmpl);
+    MODEL_ASSERT(NULL != values || 0 == count);
+    MODEL_ASSERT(NULL != value_sizes || 0 == count);
+    MODEL_ASSERT(NULL != cert);
+    MODEL_ASSERT(NULL != cert_size);
+
+    if (count < tmpl->column_count)
+    {
+        return VCTOOL_ERROR_CERTTEMPLATE_MISSING_COLUMN;
+    }
+
+    /* only variable size values change the size of the certificate. */
+    *cert_size = tmpl->fixed_size;
+    for (size_t i = 0; tmpl->variable_count > 0 && i < tmpl->step_count; ++i)
+    {
+        const certtemplate_step* step = tmpl->steps + i;
+        if (CERTTEMPLATE_END != step->kind && 0 == step->size)
+        {
+            retval =
+                certtemplate_value_size(
+                    step->kind, value_sizes[step->column], &size);
+            if (VCTOOL_STATUS_SUCCESS != retval)
+            {
+                return retval;
+            }
+
+            *cert_size += size;
+        }
+    }
+
+    if (*cert_size > capacity)
+    {
+        return VCTOOL_ERROR_CERTTEMPLATE_BUFFER_TOO_SMALL;
+    }
+
+    /* write the certificate in one pass. */
+    uint8_t* out = cert;
+    for (size_t i = 0; i < tmpl->step_count; ++i)
+    {
+        const certtemplate_step* step = tmpl->steps + i;
+
+        memcpy(out, tmpl->literals + step->literal_offset, step->literal_size);
+        out += step->literal_size;
+
+        if (CERTTEMPLATE_END == step->kind)
+        {
+            break;
+        }
+
+        const char* value = values[step->column];
+        size_t value_size = value_sizes[step->column];
+
+        /* a variable size value writes the size in its header. */
+        if (0 == step->size)
+        {
+            certtemplate_value_size(step->kind, value_size, &size);
+            out[0] = (uint8_t)(size >> 8);
+            out[1] = (uint8_t)size;
+            out += 2;
+        }
+
+        retval = certtemplate_encode(step->kind, value, value_size, out, &size);
+        if (VCTOOL_STATUS_SUCCESS != retval)
+        {
+            return retval;
+        }
+
+        out += size;
+    }
+
+    return VCTOOL_STATUS_SUCCESS;
+}
+
+/**
+ * \brief Compute the encoded size of a variable size value.
+ *
+ * \param kind          The kind of the value.
+ * \param value_size    The size of the value as written.
+ * \param size          Set to the encoded size.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - VCTOOL_ERROR_CERTTEMPLATE_BAD_VALUE if the value is malformed or
+ *        too large for a field.
+ */
+static int certtemplate_value_size(
+    uint32_t kind, size_t value_size, size_t* size)
+{
+    if (CERTTEMPLATE_HEX == kind)
+    {
+        if (value_size % 2)
+        {
+            return VCTOOL_ERROR_CERTTEMPLATE_BAD_VALUE;
+        }
+
+        *size = value_size / 2;
+    }
+    else
+    {
+        *size = value_size;
+    }
+
+    if (*size > CERTTEMPLATE_FIELD_MAX)
+    {
+        return VCTOOL_ERROR_CERTTEMPLATE_BAD_VALUE;
+    }
+
+    return VCTOOL_STATUS_SUCCESS;
+}
@@ -0,0 +1,311 @@
+/**
+ * \file command/cert_gen/cert_gen_command_func.c
+ *
+ * \brief Entry point for the cert-gen command.
+ *
+ * \copyright 2020 Velo Payments.  See License.txt for license terms.
+ */
+
+#include <cbmc/model_assert.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <vctool/certtemplate.h>
+#include <vctool/command/cert_gen.h>
+#include <vctool/commandline.h>
+
+/* forward decls. */
+static int cert_gen_map(file* f, const char* path, void** map, size_t* size);
+static size_t cert_gen_split(
+    const char* line, size_t size, const char** values, size_t* value_sizes,
+    size_t count);
+static int cert_gen_write(
+    file* f, const char* dir, size_t number, const uint8_t* cert,
+    size_t size);
+
+/**
+ * \brief Execute the cert-gen command.
+ *
+ * The template is compiled once.  Each non-blank line of the rows file is a
+ * row of comma separated columns, which fills the template; certificate N
+ * is written to NNNNNNNN.cert in the output directory, which is created if
+ * it does not exist.  Columns past the last one the template uses are
+ * ignored.
+ *
+ * \param opts          The commandline opts for this operation.
+ *
+ * \returns a status code indicating success or failure.
+ *      - a non-zero error code on failure.
+ */
+int cert_gen_command_func(commandline_opts* opts)
+{
+    int retval;
+    certtemplate tmpl;
+    void* text;
+    size_t text_size, line_number;
+    void* rows;
+    size_t rows_size, generated = 0;
+
+    /* parameter sanity checks. */
+    MODEL_ASSERT(PROP_VALID_COMMANDLINE_OPTS(opts));
+
+    /* get the cert-gen command. */
+    cert_gen_command* cert_gen = (cert_gen_command*)opts->cmd;
+    MODEL_ASSERT(NULL != cert_gen);
+
+    /* compile the template. */
+    retval =
+        cert_gen_map(
+            opts->file, cert_gen->template_file, &text, &text_size);
+    if (VCTOOL_STATUS_SUCCESS != retval)
+    {
+        fprintf(stderr, "Could not read %s.\n", cert_gen->template_file);
+        goto done;
+    }
+
+    retval =
+        certtemplate_compile(&tmpl, (const char*)text, text_size, &line_number);
+    if (text_size > 0)
+    {
+        file_munmap(opts->file, text, text_size);
+    }
+
+    if (VCTOOL_STATUS_SUCCESS != retval)
+    {
+        fprintf(
+            stderr, "Bad template line %zu of %s.\n", line_number,
+            cert_gen->template_file);
+        goto done;
+    }
+
+    retval = cert_gen_map(opts->file, cert_gen->rows_file, &rows, &rows_size);
+    if (VCTOOL_STATUS_SUCCESS != retval)
+    {
+        fprintf(stderr, "Could not read %s.\n", cert_gen->rows_file);
+        goto cleanup_template;
+    }
+
+    retval =
+        file_mkdir(
+            opts->file, cert_gen->output_dir,
+            S_IRWXU | S_IRGRP | S_IXGRP | S_IROTH | S_IXOTH);
+    if (VCTOOL_STATUS_SUCCESS != retval
+     && VCTOOL_ERROR_FILE_EXISTS != retval)
+    {
+        fprintf(stderr, "Could not create %s.\n", cert_gen->output_dir);
+        goto cleanup_rows;
+    }
+
+    /* one certificate buffer and one set of columns serve every row. */
+    uint8_t* cert = (uint8_t*)malloc(tmpl.max_size + 1);
+    const char** values =
+        (const char**)malloc((tmpl.column_count + 1) * sizeof(const char*));
+    size_t* value_sizes =
+        (size_t*)malloc((tmpl.column_count + 1) * sizeof(size_t));
+    if (NULL == cert || NULL == values || NULL == value_sizes)
+    {
+        retval = VCTOOL_ERROR_GENERAL_OUT_OF_MEMORY;
+        goto cleanup_buffers;
+    }
+
+    const char* base = (const char*)rows;
+    line_number = 0;
+    for (size_t offset = 0; offset < rows_size;)
+    {
+        const char* start = base + offset;
+        const char* end = (const char*)memchr(start, '\n', rows_size - offset);
+        size_t length =
+            (NULL == end) ? rows_size - offset : (size_t)(end - start);
+        offset += length + 1;
+        ++line_number;
+
+        /* tolerate CRLF line endings. */
+        if (length > 0 && '\r' == start[length - 1])
+        {
+            --length;
+        }
+
+        if (0 == length)
+        {
+            continue;
+        }
+
+        size_t count =
+            cert_gen_split(
+                start, length, values, value_sizes, tmpl.column_count);
+
+        size_t cert_size;
+        retval =
+            certtemplate_fill(
+                &tmpl, values, value_sizes, count, cert, tmpl.max_size,
+                &cert_size);
+        if (VCTOOL_STATUS_SUCCESS != retval)
+        {
+            fprintf(
+                stderr, "Bad row on line %zu of %s (%x).\n", line_number,
+                cert_gen->rows_file, (unsigned)retval);
+            goto cleanup_buffers;
+        }
+
+        retval =
+            cert_gen_write(
+                opts->file, cert_gen->output_dir, ++generated, cert,
+                cert_size);
+        if (VCTOOL_STATUS_SUCCESS != retval)
+        {
+            fprintf(
+                stderr, "Could not write certificate %zu.\n", generated);
+            goto cleanup_buffers;
+        }
+    }
+
+    printf(
+        "Generated %zu certificates in %s.\n", generated,
+        cert_gen->output_dir);
+
+    retval = VCTOOL_STATUS_SUCCESS;
+
+cleanup_buffers:
+    free(cert);
+    free(values);
+    free(value_sizes);
+
+cleanup_rows:
+    if (rows_size > 0)
+    {
+        file_munmap(opts->file, rows, rows_size);
+    }
+
+cleanup_template:
+    dispose((disposable_t*)&tmpl);
+
+done:
+    return retval;
+}
+
+/**
+ * \brief Map a whole file for reading.
+ *
+ * \param f             The file abstraction layer.
+ * \param path          The path of the file.
+ * \param map           Set to the mapping, unless the file is empty.
+ * \param size          Set to the size of the file.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - a non-zero error code returned by the file layer.
+ */
+static int cert_gen_map(file* f, const char* path, void** map, size_t* size)
+{
+    int retval, fd;
+    file_stat_st fst;
+
+    retval = file_stat(f, path, &fst);
+    if (VCTOOL_STATUS_SUCCESS != retval)
+    {
+        return retval;
+    }
+
+    *map = NULL;
+    *size = (size_t)fst.fst_size;
+    if (0 == *size)
+    {
+        return VCTOOL_STATUS_SUCCESS;
+    }
+
+    retval = file_open(f, &fd, path, O_RDONLY, 0);
+    if (VCTOOL_STATUS_SUCCESS != retval)
+    {
+        return retval;
+    }
+
+    retval = file_mmap(f, map, fd, *size);
+    file_close(f, fd);
+
+    return retval;
+}
+
+/**
+ * \brief Split a row into comma separated columns, in place.
+ *
+ * \param line          The row.
+ * \param size          The size of the row.
+ * \param values        Array receiving the start of each column.
+ * \param value_sizes   Array receiving the size of each column.
+ * \param count         The number of columns wanted.
+ *
+ * \returns the number of columns found, up to count.
+ */
+static size_t cert_gen_split(
+    const char* line, size_t size, const char** values, size_t* value_sizes,
+    size_t count)
+{
+    size_t found = 0;
+    size_t offset = 0;
+
+    while (found < count)
+    {
+        const char* start = line + offset;
+        const char* comma = (const char*)memchr(start, ',', size - offset);
+        size_t length =
+            (NULL == comma) ? size - offset : (size_t)(comma - start);
+
+        values[found] = start;
+        value_sizes[found] = length;
+        ++found;
+
+        if (NULL == comma)
+        {
+            break;
+        }
+
+        offset += length + 1;
+    }
+
+    return found;
+}
+
+/**
+ * \brief Write a certificate to the output directory.
+ *
+ * \param f             The file abstraction layer.
+ * \param dir           The output directory.
+ * \param number        The number of the certificate.
+ * \param cert          The certificate.
+ * \param size          The size of the certificate.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - VCTOOL_ERROR_FILE_NAME_TOO_LONG if the path is too long.
+ *      - a non-zero error code returned by the file layer.
+ */
+static int cert_gen_write(
+    file* f, const char* dir, size_t number, const uint8_t* cert,
+    size_t size)
+{
+    int retval, fd;
+    char path[PATH_MAX];
+
+    int length = snprintf(path, sizeof(path), "%s/%08zu.cert", dir, number);
+    if (length < 0 || (size_t)length >= sizeof(path))
+    {
+        return VCTOOL_ERROR_FILE_NAME_TOO_LONG;
+    }
+
+    retval =
+        file_open(
+            f, &fd, path, O_WRONLY | O_CREAT | O_TRUNC,
+            S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH);
+    if (VCTOOL_STATUS_SUCCESS != retval)
+    {
+        return retval;
+    }
+
+    retval = file_write_all(f, fd, cert, size);
+    file_close(f, fd);
+
+    return retval;
+}
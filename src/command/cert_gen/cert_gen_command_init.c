@@ -0,0 +1,52 @@
+/**
+ * \file command/cert_gen/cert_gen_command_init.c
+ *
+ * \brief Initialize a cert-gen command structure.
+ *
+ * \copyright 2020 Velo Payments.  See License.txt for license terms.
+ */
+
+#include <cbmc/model_assert.h>
+#include <string.h>
+#include <vctool/command/cert_gen.h>
+#include <vctool/command/root.h>
+#include <vctool/status_codes.h>
+#include <vpr/parameters.h>
+
+/* forward decls. */
+static void cert_gen_command_dispose(void* disp);
+
+/**
+ * \brief Initialize a cert-gen command structure.
+ *
+ * \param cert_gen      The cert-gen command structure to initialize.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - a non-zero error code on failure.
+ */
+int cert_gen_command_init(cert_gen_command* cert_gen)
+{
+    /* parameter sanity checks. */
+    MODEL_ASSERT(NULL != cert_gen);
+
+    /* clear cert_gen command structure. */
+    memset(cert_gen, 0, sizeof(cert_gen_command));
+
+    /* set disposer, func, etc. */
+    cert_gen->hdr.hdr.dispose = &cert_gen_command_dispose;
+    cert_gen->hdr.func = &cert_gen_command_func;
+
+    /* success. */
+    return VCTOOL_STATUS_SUCCESS;
+}
+
+/**
+ * \brief Dispose of a cert_gen_command structure.
+ *
+ * \param disp          The cert_gen_command structure to dispose.
+ */
+static void cert_gen_command_dispose(void* UNUSED(disp))
+{
+    /* do nothing. */
+}
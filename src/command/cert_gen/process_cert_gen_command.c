@@ -0,0 +1,76 @@
+/**
+ * \file command/cert_gen/process_cert_gen_command.c
+ *
+ * \brief Process command-line options to build a cert-gen command.
+ *
+ * \copyright 2020 Velo Payments.  See License.txt for license terms.
+ */
+
+#include <cbmc/model_assert.h>
+#include <stdio.h>
+#include <string.h>
+#include <vctool/command/cert_gen.h>
+#include <vctool/command/root.h>
+#include <vctool/commandline.h>
+#include <vctool/status_codes.h>
+
+/**
+ * \brief Process the cert-gen command.
+ *
+ * \param opts          The command-line option structure.
+ * \param argc          The argument count.
+ * \param argv          The argument vector.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - a non-zero error code on failure.
+ */
+int process_cert_gen_command(commandline_opts* opts, int argc, char* argv[])
+{
+    int retval;
+
+    /* parameter sanity checks. */
+    MODEL_ASSERT(PROP_VALID_COMMANDLINE_OPTS(opts));
+
+    /* we need a template, a file of rows, and an output directory. */
+    if (3 != argc)
+    {
+        fprintf(stderr, "Expecting cert-gen template rows output-dir.\n");
+        retval = VCTOOL_ERROR_COMMANDLINE_MISSING_ARGUMENT;
+        goto done;
+    }
+
+    /* allocate memory for a cert_gen_command structure. */
+    cert_gen_command* cert_gen =
+        (cert_gen_command*)malloc(sizeof(cert_gen_command));
+    if (NULL == cert_gen)
+    {
+        retval = VCTOOL_ERROR_GENERAL_OUT_OF_MEMORY;
+        goto done;
+    }
+
+    /* initialize the structure. */
+    retval = cert_gen_command_init(cert_gen);
+    if (VCTOOL_STATUS_SUCCESS != retval)
+    {
+        goto free_cert_gen;
+    }
+
+    cert_gen->template_file = argv[0];
+    cert_gen->rows_file = argv[1];
+    cert_gen->output_dir = argv[2];
+
+    /* set cert_gen command as the head of opts command. */
+    cert_gen->hdr.next = opts->cmd;
+    opts->cmd = &cert_gen->hdr;
+
+    /* success. */
+    retval = VCTOOL_STATUS_SUCCESS;
+    goto done;
+
+free_cert_gen:
+    free(cert_gen);
+
+done:
+    return retval;
+}
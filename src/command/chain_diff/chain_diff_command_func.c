@@ -0,0 +1,148 @@
+/**
+ * \file command/chain_diff/chain_diff_command_func.c
+ *
+ * \brief Entry point for the chain-diff command.
+ *
+ * \copyright 2020 Velo Payments.  See License.txt for license terms.
+ */
+
+#include <cbmc/model_assert.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include <vctool/blockstore.h>
+#include <vctool/command/chain_diff.h>
+#include <vctool/commandline.h>
+
+/* forward decls. */
+static int chain_diff_open_summary(
+    commandline_opts* opts, blockstore_summary* summary, const char* path);
+static void chain_diff_report(const blockstore_divergence* divergence);
+
+/**
+ * \brief Execute the chain-diff command.
+ *
+ * Each segment's summary is loaded if it is up to date, and built otherwise.
+ *
+ * \param opts          The commandline opts for this operation.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - VCTOOL_ERROR_BLOCKSTORE_DIVERGED if the segments differ.
+ *      - a non-zero error code on failure.
+ */
+int chain_diff_command_func(commandline_opts* opts)
+{
+    int retval;
+    blockstore_summary summary_a, summary_b;
+    blockstore_divergence divergence;
+
+    /* parameter sanity checks. */
+    MODEL_ASSERT(PROP_VALID_COMMANDLINE_OPTS(opts));
+
+    /* get the chain-diff command. */
+    chain_diff_command* chain_diff = (chain_diff_command*)opts->cmd;
+    MODEL_ASSERT(NULL != chain_diff);
+
+    retval = chain_diff_open_summary(opts, &summary_a, chain_diff->segment_a);
+    if (VCTOOL_STATUS_SUCCESS != retval)
+    {
+        goto done;
+    }
+
+    retval = chain_diff_open_summary(opts, &summary_b, chain_diff->segment_b);
+    if (VCTOOL_STATUS_SUCCESS != retval)
+    {
+        goto cleanup_summary_a;
+    }
+
+    /* report the first divergent range. */
+    retval = blockstore_summary_diff(&summary_a, &summary_b, &divergence);
+    if (VCTOOL_STATUS_SUCCESS == retval)
+    {
+        printf(
+            "Segments are identical: %" PRIu64 " records.\n",
+            summary_a.record_count);
+    }
+    else
+    {
+        chain_diff_report(&divergence);
+    }
+
+    dispose((disposable_t*)&summary_b);
+
+cleanup_summary_a:
+    dispose((disposable_t*)&summary_a);
+
+done:
+    return retval;
+}
+
+/**
+ * \brief Load the summary of a segment, building it if needed.
+ *
+ * \param opts          The commandline opts for this operation.
+ * \param summary       The summary to initialize.
+ * \param path          The path of the segment.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - a non-zero error code on failure.
+ */
+static int chain_diff_open_summary(
+    commandline_opts* opts, blockstore_summary* summary, const char* path)
+{
+    int retval;
+
+    retval = blockstore_summary_init(summary, opts->file, opts->suite, path);
+    if (VCTOOL_STATUS_SUCCESS != retval)
+    {
+        return retval;
+    }
+
+    /* a missing, stale, or unreadable summary is rebuilt. */
+    retval = blockstore_summary_load(summary);
+    if (VCTOOL_STATUS_SUCCESS != retval)
+    {
+        fprintf(stderr, "Building summary for %s.\n", path);
+
+        retval = blockstore_summary_build(summary);
+        if (VCTOOL_ERROR_BLOCKSTORE_CORRUPT == retval)
+        {
+            fprintf(stderr, "%s is damaged; scrub it first.\n", path);
+        }
+    }
+
+    if (VCTOOL_STATUS_SUCCESS != retval)
+    {
+        dispose((disposable_t*)summary);
+    }
+
+    return retval;
+}
+
+/**
+ * \brief Print the first divergent range of two segments.
+ *
+ * \param divergence    The divergent range.
+ */
+static void chain_diff_report(const blockstore_divergence* divergence)
+{
+    printf("First divergent height: %" PRIu64 ".\n", divergence->first_height);
+    printf(
+        "Divergent heights: %" PRIu64 " through %" PRIu64 ", from record %"
+        PRIu64 ": %" PRIu64 " records in the first segment, %" PRIu64
+        " in the second.\n", divergence->first_height,
+        divergence->last_height, divergence->index, divergence->count_a,
+        divergence->count_b);
+
+    if (divergence->converged)
+    {
+        printf(
+            "Segments agree again after height %" PRIu64 ".\n",
+            divergence->last_height);
+    }
+    else
+    {
+        printf("Segments do not agree again.\n");
+    }
+}
@@ -0,0 +1,52 @@
+/**
+ * \file command/chain_diff/chain_diff_command_init.c
+ *
+ * \brief Initialize a chain-diff command structure.
+ *
+ * \copyright 2020 Velo Payments.  See License.txt for license terms.
+ */
+
+#include <cbmc/model_assert.h>
+#include <string.h>
+#include <vctool/command/chain_diff.h>
+#include <vctool/command/root.h>
+#include <vctool/status_codes.h>
+#include <vpr/parameters.h>
+
+/* forward decls. */
+static void chain_diff_command_dispose(void* disp);
+
+/**
+ * \brief Initialize a chain-diff command structure.
+ *
+ * \param chain_diff    The chain-diff command structure to initialize.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - a non-zero error code on failure.
+ */
+int chain_diff_command_init(chain_diff_command* chain_diff)
+{
+    /* parameter sanity checks. */
+    MODEL_ASSERT(NULL != chain_diff);
+
+    /* clear chain_diff command structure. */
+    memset(chain_diff, 0, sizeof(chain_diff_command));
+
+    /* set disposer, func, etc. */
+    chain_diff->hdr.hdr.dispose = &chain_diff_command_dispose;
+    chain_diff->hdr.func = &chain_diff_command_func;
+
+    /* success. */
+    return VCTOOL_STATUS_SUCCESS;
+}
+
+/**
+ * \brief Dispose of a chain_diff_command structure.
+ *
+ * \param disp          The chain_diff_command structure to dispose.
+ */
+static void chain_diff_command_dispose(void* UNUSED(disp))
+{
+    /* do nothing. */
+}
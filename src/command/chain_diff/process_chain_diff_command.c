@@ -0,0 +1,76 @@
+/**
+ * \file command/chain_diff/process_chain_diff_command.c
+ *
+ * \brief Process command-line options to build a chain-diff command.
+ *
+ * \copyright 2020 Velo Payments.  See License.txt for license terms.
+ */
+
+#include <cbmc/model_assert.h>
+#include <stdio.h>
+#include <string.h>
+#include <vctool/command/chain_diff.h>
+#include <vctool/command/root.h>
+#include <vctool/commandline.h>
+#include <vctool/status_codes.h>
+
+/**
+ * \brief Process the chain-diff command.
+ *
+ * \param opts          The command-line option structure.
+ * \param argc          The argument count.
+ * \param argv          The argument vector.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - a non-zero error code on failure.
+ */
+int process_chain_diff_command(
+    commandline_opts* opts, int argc, char* argv[])
+{
+    int retval;
+
+    /* parameter sanity checks. */
+    MODEL_ASSERT(PROP_VALID_COMMANDLINE_OPTS(opts));
+
+    /* we need exactly two segments. */
+    if (2 != argc)
+    {
+        fprintf(stderr, "Expecting chain-diff segmentA segmentB.\n");
+        retval = VCTOOL_ERROR_COMMANDLINE_MISSING_ARGUMENT;
+        goto done;
+    }
+
+    /* allocate memory for a chain_diff_command structure. */
+    chain_diff_command* chain_diff =
+        (chain_diff_command*)malloc(sizeof(chain_diff_command));
+    if (NULL == chain_diff)
+    {
+        retval = VCTOOL_ERROR_GENERAL_OUT_OF_MEMORY;
+        goto done;
+    }
+
+    /* initialize the structure. */
+    retval = chain_diff_command_init(chain_diff);
+    if (VCTOOL_STATUS_SUCCESS != retval)
+    {
+        goto free_chain_diff;
+    }
+
+    chain_diff->segment_a = argv[0];
+    chain_diff->segment_b = argv[1];
+
+    /* set chain_diff command as the head of opts command. */
+    chain_diff->hdr.next = opts->cmd;
+    opts->cmd = &chain_diff->hdr;
+
+    /* success. */
+    retval = VCTOOL_STATUS_SUCCESS;
+    goto done;
+
+free_chain_diff:
+    free(chain_diff);
+
+done:
+    return retval;
+}
@@ -0,0 +1,147 @@
+/**
+ * \file command/follow/follow_command_func.c
+ *
+ * \brief Entry point for the follow command.
+ *
+ * \copyright 2020 Velo Payments.  See License.txt for license terms.
+ */
+
+#include <cbmc/model_assert.h>
+#include <inttypes.h>
+#include <signal.h>
+#include <stdio.h>
+#include <time.h>
+#include <unistd.h>
+#include <vctool/agent.h>
+#include <vctool/blockstore.h>
+#include <vctool/command/follow.h>
+#include <vctool/commandline.h>
+
+/* reconnect delays, in milliseconds. */
+#define FOLLOW_RETRY_MIN_MS                             100
+#define FOLLOW_RETRY_MAX_MS                             5000
+
+/* forward decls. */
+static void follow_sleep_ms(long ms);
+
+/**
+ * \brief Execute the follow command.
+ *
+ * Blocks are appended to the segment and written to stdout, or to the output
+ * address, as block frames.  When the agent connection drops, the command
+ * reconnects and resubscribes from the block after the last one appended.
+ * Reconnects back off exponentially; the delay is reset only once a
+ * connection delivers a block, so an agent which accepts and then drops
+ * every connection is not retried in a tight loop.
+ *
+ * \param opts          The commandline opts for this operation.
+ *
+ * \returns a status code indicating success or failure.
+ *      - a non-zero error code on failure.
+ */
+int follow_command_func(commandline_opts* opts)
+{
+    int retval, sock, out = STDOUT_FILENO;
+    uint64_t height;
+    long delay = FOLLOW_RETRY_MIN_MS;
+
+    /* parameter sanity checks. */
+    MODEL_ASSERT(PROP_VALID_COMMANDLINE_OPTS(opts));
+
+    /* get the follow command. */
+    follow_command* follow = (follow_command*)opts->cmd;
+    MODEL_ASSERT(NULL != follow);
+
+    /* a dropped consumer or agent is reported by a write, not by a signal. */
+    signal(SIGPIPE, SIG_IGN);
+
+    /* resume after the last block in the segment. */
+    retval = blockstore_segment_tail(opts->file, follow->segment, &height);
+    if (VCTOOL_STATUS_SUCCESS != retval)
+    {
+        fprintf(stderr, "Could not read segment %s.\n", follow->segment);
+        goto done;
+    }
+    height = (BLOCKSTORE_NO_HEIGHT == height) ? 0 : height + 1;
+
+    /* connect to the consumer, if it isn't stdout. */
+    if (NULL != follow->output_address)
+    {
+        retval = agent_connect(&out, follow->output_address);
+        if (VCTOOL_STATUS_SUCCESS != retval)
+        {
+            fprintf(
+                stderr, "Could not connect to %s.\n", follow->output_address);
+            goto done;
+        }
+    }
+
+    for (;;)
+    {
+        retval = agent_connect(&sock, follow->agent_address);
+        if (VCTOOL_ERROR_AGENT_CONNECT == retval)
+        {
+            /* back off while the agent is unreachable. */
+            follow_sleep_ms(delay);
+            delay = (2 * delay > FOLLOW_RETRY_MAX_MS)
+                ? FOLLOW_RETRY_MAX_MS : 2 * delay;
+            continue;
+        }
+        else if (VCTOOL_STATUS_SUCCESS != retval)
+        {
+            fprintf(
+                stderr, "Could not resolve %s.\n", follow->agent_address);
+            goto cleanup_out;
+        }
+
+        uint64_t start = height;
+        retval =
+            agent_follow(
+                opts->file, sock, follow->segment, &height, out,
+                opts->agent_recorder);
+        close(sock);
+
+        /* only a dropped connection is retried. */
+        if (VCTOOL_ERROR_AGENT_DISCONNECTED != retval)
+        {
+            fprintf(
+                stderr, "Stopped following at height %" PRIu64 " (%x).\n",
+                height, (unsigned)retval);
+            goto cleanup_out;
+        }
+
+        /* a connection which delivered a block was healthy. */
+        if (height != start)
+        {
+            delay = FOLLOW_RETRY_MIN_MS;
+        }
+
+        /* back off before reconnecting. */
+        follow_sleep_ms(delay);
+        delay = (2 * delay > FOLLOW_RETRY_MAX_MS)
+            ? FOLLOW_RETRY_MAX_MS : 2 * delay;
+    }
+
+cleanup_out:
+    if (STDOUT_FILENO != out)
+    {
+        close(out);
+    }
+
+done:
+    return retval;
+}
+
+/**
+ * \brief Sleep for a number of milliseconds.
+ *
+ * \param ms            The number of milliseconds to sleep.
+ */
+static void follow_sleep_ms(long ms)
+{
+    struct timespec ts;
+
+    ts.tv_sec = ms / 1000;
+    ts.tv_nsec = (ms % 1000) * 1000000L;
+    nanosleep(&ts, NULL);
+}
@@ -0,0 +1,52 @@
+/**
+ * \file command/follow/follow_command_init.c
+ *
+ * \brief Initialize a follow command structure.
+ *
+ * \copyright 2020 Velo Payments.  See License.txt for license terms.
+ */
+
+#include <cbmc/model_assert.h>
+#include <string.h>
+#include <vctool/command/follow.h>
+#include <vctool/command/root.h>
+#include <vctool/status_codes.h>
+#include <vpr/parameters.h>
+
+/* forward decls. */
+static void follow_command_dispose(void* disp);
+
+/**
+ * \brief Initialize a follow command structure.
+ *
+ * \param follow        The follow command structure to initialize.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - a non-zero error code on failure.
+ */
+int follow_command_init(follow_command* follow)
+{
+    /* parameter sanity checks. */
+    MODEL_ASSERT(NULL != follow);
+
+    /* clear follow command structure. */
+    memset(follow, 0, sizeof(follow_command));
+
+    /* set disposer, func, etc. */
+    follow->hdr.hdr.dispose = &follow_command_dispose;
+    follow->hdr.func = &follow_command_func;
+
+    /* success. */
+    return VCTOOL_STATUS_SUCCESS;
+}
+
+/**
+ * \brief Dispose of a follow_command structure.
+ *
+ * \param disp          The follow_command structure to dispose.
+ */
+static void follow_command_dispose(void* UNUSED(disp))
+{
+    /* do nothing. */
+}
@@ -0,0 +1,75 @@
+/**
+ * \file command/follow/process_follow_command.c
+ *
+ * \brief Process command-line options to build a follow command.
+ *
+ * \copyright 2020 Velo Payments.  See License.txt for license terms.
+ */
+
+#include <cbmc/model_assert.h>
+#include <stdio.h>
+#include <string.h>
+#include <vctool/command/follow.h>
+#include <vctool/command/root.h>
+#include <vctool/commandline.h>
+#include <vctool/status_codes.h>
+
+/**
+ * \brief Process the follow command.
+ *
+ * \param opts          The command-line option structure.
+ * \param argc          The argument count.
+ * \param argv          The argument vector.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - a non-zero error code on failure.
+ */
+int process_follow_command(commandline_opts* opts, int argc, char* argv[])
+{
+    int retval;
+
+    /* parameter sanity checks. */
+    MODEL_ASSERT(PROP_VALID_COMMANDLINE_OPTS(opts));
+
+    /* we need an agent and a segment, and may have an output address. */
+    if (argc < 2 || argc > 3)
+    {
+        fprintf(stderr, "Expecting follow agent segment [output].\n");
+        retval = VCTOOL_ERROR_COMMANDLINE_MISSING_ARGUMENT;
+        goto done;
+    }
+
+    /* allocate memory for a follow_command structure. */
+    follow_command* follow = (follow_command*)malloc(sizeof(follow_command));
+    if (NULL == follow)
+    {
+        retval = VCTOOL_ERROR_GENERAL_OUT_OF_MEMORY;
+        goto done;
+    }
+
+    /* initialize the structure. */
+    retval = follow_command_init(follow);
+    if (VCTOOL_STATUS_SUCCESS != retval)
+    {
+        goto free_follow;
+    }
+
+    follow->agent_address = argv[0];
+    follow->segment = argv[1];
+    follow->output_address = (3 == argc) ? argv[2] : NULL;
+
+    /* set follow command as the head of opts command. */
+    follow->hdr.next = opts->cmd;
+    opts->cmd = &follow->hdr;
+
+    /* success. */
+    retval = VCTOOL_STATUS_SUCCESS;
+    goto done;
+
+free_follow:
+    free(follow);
+
+done:
+    return retval;
+}
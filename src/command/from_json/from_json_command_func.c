@@ -0,0 +1,262 @@
+/**
+ * \file command/from_json/from_json_command_func.c
+ *
+ * \brief Entry point for the from-json command.
+ *
+ * \copyright 2020 Velo Payments.  See License.txt for license terms.
+ */
+
+#include <cbmc/model_assert.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <vctool/certjson.h>
+#include <vctool/command/from_json.h>
+#include <vctool/commandline.h>
+
+/* forward decls. */
+static int from_json_convert(
+    file* f, const from_json_command* from_json, const char* text,
+    size_t size, size_t* converted);
+static int from_json_write(
+    file* f, const char* dir, size_t number, const uint8_t* cert,
+    size_t size);
+static bool from_json_space(char ch);
+
+/**
+ * \brief Execute the from-json command.
+ *
+ * The JSON file holds one certificate object per line.  Certificate N is
+ * written to NNNNNNNN.cert in the output directory, which is created if it
+ * does not exist.  A certificate is never larger than its line, so one
+ * buffer the size of the longest line serves every certificate.
+ *
+ * \param opts          The commandline opts for this operation.
+ *
+ * \returns a status code indicating success or failure.
+ *      - a non-zero error code on failure.
+ */
+int from_json_command_func(commandline_opts* opts)
+{
+    int retval, fd;
+    file_stat_st fst;
+    void* map;
+    size_t converted = 0;
+
+    /* parameter sanity checks. */
+    MODEL_ASSERT(PROP_VALID_COMMANDLINE_OPTS(opts));
+
+    /* get the from-json command. */
+    from_json_command* from_json = (from_json_command*)opts->cmd;
+    MODEL_ASSERT(NULL != from_json);
+
+    retval = file_stat(opts->file, from_json->json_file, &fst);
+    if (VCTOOL_STATUS_SUCCESS != retval)
+    {
+        fprintf(stderr, "Could not read %s.\n", from_json->json_file);
+        goto done;
+    }
+
+    retval =
+        file_mkdir(
+            opts->file, from_json->output_dir,
+            S_IRWXU | S_IRGRP | S_IXGRP | S_IROTH | S_IXOTH);
+    if (VCTOOL_STATUS_SUCCESS != retval
+     && VCTOOL_ERROR_FILE_EXISTS != retval)
+    {
+        fprintf(stderr, "Could not create %s.\n", from_json->output_dir);
+        goto done;
+    }
+
+    size_t size = (size_t)fst.fst_size;
+    if (size > 0)
+    {
+        retval =
+            file_open(opts->file, &fd, from_json->json_file, O_RDONLY, 0);
+        if (VCTOOL_STATUS_SUCCESS != retval)
+        {
+            fprintf(stderr, "Could not read %s.\n", from_json->json_file);
+            goto done;
+        }
+
+        retval = file_mmap(opts->file, &map, fd, size);
+        file_close(opts->file, fd);
+        if (VCTOOL_STATUS_SUCCESS != retval)
+        {
+            fprintf(stderr, "Could not read %s.\n", from_json->json_file);
+            goto done;
+        }
+
+        retval =
+            from_json_convert(
+                opts->file, from_json, (const char*)map, size, &converted);
+        file_munmap(opts->file, map, size);
+        if (VCTOOL_STATUS_SUCCESS != retval)
+        {
+            goto done;
+        }
+    }
+
+    printf(
+        "Converted %zu certificates into %s.\n", converted,
+        from_json->output_dir);
+
+    retval = VCTOOL_STATUS_SUCCESS;
+
+done:
+    return retval;
+}
+
+/**
+ * \brief Convert each line of JSON text to a certificate file.
+ *
+ * \param f             The file abstraction layer.
+ * \param from_json     The from-json command.
+ * \param text          The JSON text.
+ * \param size          The size of the text.
+ * \param converted     Set to the number of certificates written.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - VCTOOL_ERROR_GENERAL_OUT_OF_MEMORY if an allocation failed.
+ *      - a non-zero error code returned by certjson_read or the file layer.
+ */
+static int from_json_convert(
+    file* f, const from_json_command* from_json, const char* text,
+    size_t size, size_t* converted)
+{
+    int retval;
+    uint8_t* cert = NULL;
+    size_t capacity = 0, line_number = 0;
+
+    for (size_t offset = 0; offset < size;)
+    {
+        const char* start = text + offset;
+        const char* end = (const char*)memchr(start, '\n', size - offset);
+        size_t length = (NULL == end) ? size - offset : (size_t)(end - start);
+        offset += length + 1;
+        ++line_number;
+
+        /* skip blank lines. */
+        size_t blank = 0;
+        while (blank < length && from_json_space(start[blank]))
+        {
+            ++blank;
+        }
+
+        if (blank == length)
+        {
+            continue;
+        }
+
+        if (length > capacity)
+        {
+            uint8_t* grown = (uint8_t*)realloc(cert, length);
+            if (NULL == grown)
+            {
+                retval = VCTOOL_ERROR_GENERAL_OUT_OF_MEMORY;
+                goto cleanup_cert;
+            }
+
+            cert = grown;
+            capacity = length;
+        }
+
+        size_t consumed, cert_size;
+        retval =
+            certjson_read(
+                start, length, &consumed, cert, capacity, &cert_size);
+
+        /* only whitespace may follow the object. */
+        while (VCTOOL_STATUS_SUCCESS == retval && consumed < length)
+        {
+            if (!from_json_space(start[consumed++]))
+            {
+                retval = VCTOOL_ERROR_CERTJSON_BAD_JSON;
+            }
+        }
+
+        if (VCTOOL_STATUS_SUCCESS != retval)
+        {
+            fprintf(
+                stderr, "Bad certificate on line %zu of %s (%x).\n",
+                line_number, from_json->json_file, (unsigned)retval);
+            goto cleanup_cert;
+        }
+
+        retval =
+            from_json_write(
+                f, from_json->output_dir, ++*converted, cert, cert_size);
+        if (VCTOOL_STATUS_SUCCESS != retval)
+        {
+            fprintf(
+                stderr, "Could not write certificate %zu.\n", *converted);
+            goto cleanup_cert;
+        }
+    }
+
+    retval = VCTOOL_STATUS_SUCCESS;
+
+cleanup_cert:
+    free(cert);
+
+    return retval;
+}
+
+/**
+ * \brief Write a certificate to the output directory.
+ *
+ * \param f             The file abstraction layer.
+ * \param dir           The output directory.
+ * \param number        The number of the certificate.
+ * \param cert          The certificate.
+ * \param size          The size of the certificate.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - VCTOOL_ERROR_FILE_NAME_TOO_LONG if the path is too long.
+ *      - a non-zero error code returned by the file layer.
+ */
+static int from_json_write(
+    file* f, const char* dir, size_t number, const uint8_t* cert,
+    size_t size)
+{
+    int retval, fd;
+    char path[PATH_MAX];
+
+    int length = snprintf(path, sizeof(path), "%s/%08zu.cert", dir, number);
+    if (length < 0 || (size_t)length >= sizeof(path))
+    {
+        return VCTOOL_ERROR_FILE_NAME_TOO_LONG;
+    }
+
+    retval =
+        file_open(
+            f, &fd, path, O_WRONLY | O_CREAT | O_TRUNC,
+            S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH);
+    if (VCTOOL_STATUS_SUCCESS != retval)
+    {
+        return retval;
+    }
+
+    retval = file_write_all(f, fd, cert, size);
+    file_close(f, fd);
+
+    return retval;
+}
+
+/**
+ * \brief Check for whitespace within a line.
+ *
+ * \param ch            The character.
+ *
+ * \returns true if the character is whitespace.
+ */
+static bool from_json_space(char ch)
+{
+    return ' ' == ch || '\t' == ch || '\r' == ch;
+}
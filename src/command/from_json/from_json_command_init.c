@@ -0,0 +1,52 @@
+/**
+ * \file command/from_json/from_json_command_init.c
+ *
+ * \brief Initialize a from-json command structure.
+ *
+ * \copyright 2020 Velo Payments.  See License.txt for license terms.
+ */
+
+#include <cbmc/model_assert.h>
+#include <string.h>
+#include <vctool/command/from_json.h>
+#include <vctool/command/root.h>
+#include <vctool/status_codes.h>
+#include <vpr/parameters.h>
+
+/* forward decls. */
+static void from_json_command_dispose(void* disp);
+
+/**
+ * \brief Initialize a from-json command structure.
+ *
+ * \param from_json     The from-json command structure to initialize.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - a non-zero error code on failure.
+ */
+int from_json_command_init(from_json_command* from_json)
+{
+    /* parameter sanity checks. */
+    MODEL_ASSERT(NULL != from_json);
+
+    /* clear from_json command structure. */
+    memset(from_json, 0, sizeof(from_json_command));
+
+    /* set disposer, func, etc. */
+    from_json->hdr.hdr.dispose = &from_json_command_dispose;
+    from_json->hdr.func = &from_json_command_func;
+
+    /* success. */
+    return VCTOOL_STATUS_SUCCESS;
+}
+
+/**
+ * \brief Dispose of a from_json_command structure.
+ *
+ * \param disp          The from_json_command structure to dispose.
+ */
+static void from_json_command_dispose(void* UNUSED(disp))
+{
+    /* do nothing. */
+}
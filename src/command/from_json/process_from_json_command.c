@@ -0,0 +1,75 @@
+/**
+ * \file command/from_json/process_from_json_command.c
+ *
+ * \brief Process command-line options to build a from-json command.
+ *
+ * \copyright 2020 Velo Payments.  See License.txt for license terms.
+ */
+
+#include <cbmc/model_assert.h>
+#include <stdio.h>
+#include <string.h>
+#include <vctool/command/from_json.h>
+#include <vctool/command/root.h>
+#include <vctool/commandline.h>
+#include <vctool/status_codes.h>
+
+/**
+ * \brief Process the from-json command.
+ *
+ * \param opts          The command-line option structure.
+ * \param argc          The argument count.
+ * \param argv          The argument vector.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - a non-zero error code on failure.
+ */
+int process_from_json_command(commandline_opts* opts, int argc, char* argv[])
+{
+    int retval;
+
+    /* parameter sanity checks. */
+    MODEL_ASSERT(PROP_VALID_COMMANDLINE_OPTS(opts));
+
+    /* we need a JSON file and an output directory. */
+    if (2 != argc)
+    {
+        fprintf(stderr, "Expecting from-json json-file output-dir.\n");
+        retval = VCTOOL_ERROR_COMMANDLINE_MISSING_ARGUMENT;
+        goto done;
+    }
+
+    /* allocate memory for a from_json_command structure. */
+    from_json_command* from_json =
+        (from_json_command*)malloc(sizeof(from_json_command));
+    if (NULL == from_json)
+    {
+        retval = VCTOOL_ERROR_GENERAL_OUT_OF_MEMORY;
+        goto done;
+    }
+
+    /* initialize the structure. */
+    retval = from_json_command_init(from_json);
+    if (VCTOOL_STATUS_SUCCESS != retval)
+    {
+        goto free_from_json;
+    }
+
+    from_json->json_file = argv[0];
+    from_json->output_dir = argv[1];
+
+    /* set from_json command as the head of opts command. */
+    from_json->hdr.next = opts->cmd;
+    opts->cmd = &from_json->hdr;
+
+    /* success. */
+    retval = VCTOOL_STATUS_SUCCESS;
+    goto done;
+
+free_from_json:
+    free(from_json);
+
+done:
+    return retval;
+}
@@ -20,12 +20,47 @@ void help_print(FILE* out)
     fprintf(out, "Options:\n");
     fprintf(out, "   %-12s Print this help menu.\n", "-h / -?");
     fprintf(out, "   %-12s Set output filename.\n", "-o file");
+    fprintf(out, "   %-12s Load a contract plugin.\n", "-P file");
+    fprintf(out, "   %-12s Reject entities in this revocation list.\n",
+           "-r file");
     fprintf(out, "   %-12s Number of key derivation rounds.\n", "-R num");
     fprintf(out, "   %-12s The private keypair file.\n", "-k file");
+    fprintf(out, "   %-12s Don't use the certificate verification cache.\n",
+           "--no-cache");
+    fprintf(out, "   %-12s Record agent traffic to a file for replay-serve.\n",
+           "--record-agent");
+    fprintf(out, "   %-12s Journal submissions so submit can resume.\n",
+           "--journal");
+    fprintf(out, "   %-12s Trust the keys in a public entity certificate.\n",
+           "--entity");
+    fprintf(out, "   %-12s Keep keys in a certificate store directory.\n",
+           "--store");
     fprintf(out, "\n");
     fprintf(out, "Commands:\n");
     fprintf(out, "   %-12s Print this help menu.\n", "help");
+    fprintf(out, "   %-12s Generate certificates from a template and rows.\n",
+           "cert-gen");
+    fprintf(out, "   %-12s Find where two block store segments diverge.\n",
+           "chain-diff");
+    fprintf(out, "   %-12s Stream new blocks from an agent.\n", "follow");
+    fprintf(out, "   %-12s Convert JSON lines to certificate files.\n",
+           "from-json");
     fprintf(out, "   %-12s Generate a keypair certificate file.\n", "keygen");
     fprintf(out, "   %-12s Create a pubkey certificate from a keypair.\n",
            "pubkey");
+    fprintf(out, "   %-12s Serve block store lookups on a local socket.\n",
+           "query-serve");
+    fprintf(out, "   %-12s Serve recorded agent traffic on a local socket.\n",
+           "replay-serve");
+    fprintf(out, "   %-12s Add to or check a revocation list.\n", "revoke");
+    fprintf(out, "   %-12s Verify block store segment checksums.\n", "scrub");
+    fprintf(out, "   %-12s Submit transactions to an agent.\n", "submit");
+    fprintf(out, "   %-12s Write certificate files as JSON lines.\n",
+           "to-json");
+    fprintf(out, "   %-12s Report transaction states as JSON lines.\n",
+           "txn-status");
+    fprintf(out, "   %-12s Check certificates against their type's schema.\n",
+           "validate");
+    fprintf(out, "   %-12s Attest certificates at a block height.\n",
+           "verify");
 }
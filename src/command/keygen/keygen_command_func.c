@@ -27,7 +27,7 @@
  */
 int keygen_command_func(commandline_opts* opts)
 {
-    int retval, fd;
+    int retval;
     const char* output_filename;
     vccrypt_buffer_t password_buffer;
     vccrypt_buffer_t verify_buffer;
@@ -57,7 +57,7 @@ int keygen_command_func(commandline_opts* opts)
     /* make sure we don't clobber an existing file. */
     file_stat_st fst;
     retval = file_stat(opts->file, output_filename, &fst);
-    if (VCTOOL_ERROR_FILE_NO_ENTRY != retval)
+    if (NULL == opts->store_path && VCTOOL_ERROR_FILE_NO_ENTRY != retval)
     {
         fprintf(stderr, "Won't clobber existing file.  Stopping.\n");
         goto done;
@@ -128,17 +128,6 @@ int keygen_command_func(commandline_opts* opts)
         }
     }
 
-    /* open a file readable / writable by user, and no one else. */
-    retval =
-        file_open(
-            opts->file, &fd, output_filename, O_CREAT | O_EXCL | O_WRONLY, 
-            S_IRUSR | S_IWUSR);
-    if (VCTOOL_STATUS_SUCCESS != retval)
-    {
-        fprintf(stderr, "Error opening output file.\n");
-        goto cleanup_encrypted_cert;
-    }
-
     /* determine which certificate to write. */
     if (NULL != encrypted_cert)
     {
@@ -149,28 +138,18 @@ int keygen_command_func(commandline_opts* opts)
         write_cert = &private_cert;
     }
 
-    /* write our certificate to the file. */
-    size_t wrote_size;
+    /* write our certificate, readable / writable by user and no one else. */
     retval =
-        file_write(
-            opts->file, fd, write_cert->data, write_cert->size, &wrote_size);
+        certificate_output_write(
+            opts, output_filename, write_cert, S_IRUSR | S_IWUSR);
     if (VCTOOL_STATUS_SUCCESS != retval)
     {
-        fprintf(stderr, "Error writing output file.\n");
-        goto cleanup_file;
-    }
-    else if (wrote_size != write_cert->size)
-    {
-        fprintf(stderr, "Error: file truncated.\n");
-        goto cleanup_file;
+        goto cleanup_encrypted_cert;
     }
 
     /* success. */
     retval = VCTOOL_STATUS_SUCCESS;
 
-cleanup_file:
-    file_close(opts->file, fd);
-
 cleanup_encrypted_cert:
     if (NULL != encrypted_cert)
     {
@@ -11,12 +11,11 @@
 #include <stdio.h>
 #include <string.h>
 #include <vccert/fields.h>
-#include <vccrypt/compare.h>
 #include <vctool/certificate.h>
 #include <vctool/commandline.h>
+#include <vctool/contract.h>
 #include <vctool/command/pubkey.h>
 #include <vctool/command/root.h>
-#include <vctool/readpassword.h>
 #include <vpr/parameters.h>
 
 /* forward decls. */
@@ -28,11 +27,6 @@ static bool dummy_txn_resolver(
     void*, void*, const uint8_t*, const uint8_t*, vccrypt_buffer_t*, bool*);
 static int32_t dummy_artifact_state_resolver(
     void*, void*, const uint8_t*, vccrypt_buffer_t*);
-static int dummy_contract_resolver(
-    void*, void*, const uint8_t*, const uint8_t*, vccert_contract_closure_t*);
-static bool dummy_key_resolver(
-    void*, void*, uint64_t, const uint8_t*, vccrypt_buffer_t*,
-    vccrypt_buffer_t*);
 
 /**
  * \brief Execute the pubkey command.
@@ -45,13 +39,11 @@ static bool dummy_key_resolver(
  */
 int pubkey_command_func(commandline_opts* opts)
 {
-    int retval, fd, out_fd;
+    int retval;
     char* output_filename;
     const char* key_filename;
-    vccrypt_buffer_t cert, password_buffer, uuid, encryption_pubkey,
-                     signing_pubkey, pubcert;
-    vccrypt_buffer_t* decrypted_cert = NULL;
-    vccrypt_buffer_t* work_cert = NULL;
+    vccrypt_buffer_t uuid, encryption_pubkey, signing_pubkey, pubcert;
+    vccrypt_buffer_t* keypair;
 
     /* parameter sanity checks. */
     MODEL_ASSERT(PROP_VALID_COMMANDLINE_OPTS(opts));
@@ -95,7 +87,7 @@ int pubkey_command_func(commandline_opts* opts)
     /* make sure we don't clobber an existing file. */
     file_stat_st fst;
     retval = file_stat(opts->file, output_filename, &fst);
-    if (VCTOOL_ERROR_FILE_NO_ENTRY != retval)
+    if (NULL == opts->store_path && VCTOOL_ERROR_FILE_NO_ENTRY != retval)
     {
         fprintf(
             stderr, "Won't clobber existing file %s.  Stopping.\n",
@@ -103,97 +95,22 @@ int pubkey_command_func(commandline_opts* opts)
         goto free_output_filename;
     }
 
-    /* make sure the key file exists. */
-    retval = file_stat(opts->file, key_filename, &fst);
+    /* read the keypair. */
+    retval = certificate_keypair_load(opts, &keypair, key_filename);
     if (VCTOOL_STATUS_SUCCESS != retval)
-    {
-        fprintf(stderr, "Missing key file %s.\n", key_filename);
-        goto free_output_filename;
-    }
-
-    /* make sure the permission bits are set appropriately. */
-    mode_t bad_bits = S_ISUID | S_ISGID | S_ISVTX | S_IRWXG | S_IRWXO;
-    if (fst.fst_mode & bad_bits)
-    {
-        fprintf(
-            stderr, "Only user permissions allowed for %s.\n", key_filename);
-        goto free_output_filename;
-    }
-    else if (! (fst.fst_mode & S_IRUSR))
-    {
-        fprintf(stderr, "Can't read %s.\n", key_filename);
-        goto free_output_filename;
-    }
-
-    /* create the certificate buffer. */
-    size_t file_size = fst.fst_size;
-    retval = vccrypt_buffer_init(&cert, opts->suite->alloc_opts, file_size);
-    if (VCCRYPT_STATUS_SUCCESS != retval)
     {
         goto free_output_filename;
     }
 
-    /* open file. */
-    retval =
-        file_open(
-            opts->file, &fd, key_filename, O_RDONLY, 0);
-    if (VCTOOL_STATUS_SUCCESS != retval)
-    {
-        fprintf(stderr, "Error opening file %s for read.\n", key_filename);
-        goto cleanup_cert;
-    }
-
-    /* read contents into certificate buffer. */
-    size_t read_bytes;
-    retval = file_read(opts->file, fd, cert.data, cert.size, &read_bytes);
-    if (VCTOOL_STATUS_SUCCESS != retval || read_bytes != cert.size)
-    {
-        fprintf(stderr, "Error reading from %s.\n", key_filename);
-        goto cleanup_file;
-    }
-
-    /* Does it have encryption magic? */
-    if (cert.size > ENCRYPTED_CERT_MAGIC_SIZE
-     && !crypto_memcmp(
-            cert.data, ENCRYPTED_CERT_MAGIC_STRING, ENCRYPTED_CERT_MAGIC_SIZE))
-    {
-        /* Yes: read password and decrypt. */
-        printf("Enter passphrase: ");
-        fflush(stdout);
-        retval = readpassword(opts, &password_buffer);
-        if (VCTOOL_STATUS_SUCCESS != retval)
-        {
-            printf("Failure.\n");
-            goto cleanup_file;
-        }
-        printf("\n");
-
-        retval =
-            certificate_decrypt(opts, &decrypted_cert, &cert, &password_buffer);
-        if (VCTOOL_STATUS_SUCCESS != retval)
-        {
-            fprintf(stderr, "Error decrypting %s.\n", key_filename);
-            dispose((disposable_t*)&password_buffer);
-            goto cleanup_file;
-        }
-
-        dispose((disposable_t*)&password_buffer);
-        work_cert = decrypted_cert;
-    }
-    else
-    {
-        work_cert = &cert;
-    }
-
     /* extract uuid, public encryption key, and public signing key from cert. */
     retval =
         pubkey_extract_public_fields_from_private_cert(
-            opts, &uuid, &encryption_pubkey, &signing_pubkey, work_cert);
+            opts, &uuid, &encryption_pubkey, &signing_pubkey, keypair);
     if (VCTOOL_STATUS_SUCCESS != retval)
     {
         fprintf(
             stderr, "Error extracting public fields from %s.\n", key_filename);
-        goto cleanup_file;
+        goto cleanup_keypair;
     }
 
     /* create method for creating pubkey cert with these three items. */
@@ -206,40 +123,20 @@ int pubkey_command_func(commandline_opts* opts)
         goto cleanup_cert_fields;
     }
 
-    /* open output file. */
+    /* a public certificate may be shared with everyone. */
     retval =
-        file_open(
-            opts->file, &out_fd, output_filename, O_CREAT | O_EXCL | O_WRONLY,
-            S_IRUSR | S_IWUSR);
+        certificate_output_write(
+            opts, output_filename, &pubcert,
+            S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH);
     if (VCTOOL_STATUS_SUCCESS != retval)
     {
-        fprintf(stderr, "Error opening output file %s.\n", output_filename);
         goto cleanup_pubcert;
     }
 
-    /* write this cert to the output file. */
-    size_t wrote_size;
-    retval =
-        file_write(
-            opts->file, out_fd, pubcert.data, pubcert.size, &wrote_size);
-    if (VCTOOL_STATUS_SUCCESS != retval)
-    {
-        fprintf(stderr, "Error writing to output file.\n");
-        goto cleanup_outfile;
-    }
-    else if (wrote_size != pubcert.size)
-    {
-        fprintf(stderr, "Error: file truncated.\n");
-        goto cleanup_outfile;
-    }
-
     /* success. */
     retval = VCTOOL_STATUS_SUCCESS;
     /* fall-through. */
 
-cleanup_outfile:
-    file_close(opts->file, out_fd);
-
 cleanup_pubcert:
     dispose((disposable_t*)&pubcert);
 
@@ -248,16 +145,9 @@ cleanup_cert_fields:
     dispose((disposable_t*)&encryption_pubkey);
     dispose((disposable_t*)&signing_pubkey);
 
-cleanup_file:
-    file_close(opts->file, fd);
-
-cleanup_cert:
-    dispose((disposable_t*)&cert);
-    if (NULL != decrypted_cert)
-    {
-        dispose((disposable_t*)decrypted_cert);
-        free(decrypted_cert);
-    }
+cleanup_keypair:
+    dispose((disposable_t*)keypair);
+    free(keypair);
 
 free_output_filename:
     free(output_filename);
@@ -304,7 +194,8 @@ static int pubkey_extract_public_fields_from_private_cert(
         vccert_parser_options_init(
             &parser_options, opts->suite->alloc_opts, opts->suite,
             &dummy_txn_resolver, &dummy_artifact_state_resolver,
-            &dummy_contract_resolver, &dummy_key_resolver, NULL);
+            &contract_registry_resolve, &certificate_entity_key_resolver,
+            opts);
     if (VCCERT_STATUS_SUCCESS != retval)
     {
         goto done;
@@ -457,24 +348,3 @@ static int32_t dummy_artifact_state_resolver(
 {
     return -1;
 }
-
-/**
- * \brief Dummy contract resolver for parser options.
- */
-static int dummy_contract_resolver(
-    void* UNUSED(a), void* UNUSED(b), const uint8_t* UNUSED(c),
-    const uint8_t* UNUSED(d), vccert_contract_closure_t* UNUSED(e))
-{
-    return -1;
-}
-
-/**
- * \brief Dummy key resolver for parser options.
- */
-static bool dummy_key_resolver(
-    void* UNUSED(a), void* UNUSED(b), uint64_t UNUSED(c),
-    const uint8_t* UNUSED(d), vccrypt_buffer_t* UNUSED(e),
-    vccrypt_buffer_t* UNUSED(f))
-{
-    return false;
-}
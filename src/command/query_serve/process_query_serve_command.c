@@ -0,0 +1,76 @@
+/**
+ * \file command/query_serve/process_query_serve_command.c
+ *
+ * \brief Process command-line options to build a query-serve command.
+ *
+ * \copyright 2020 Velo Payments.  See License.txt for license terms.
+ */
+
+#include <cbmc/model_assert.h>
+#include <stdio.h>
+#include <string.h>
+#include <vctool/command/query_serve.h>
+#include <vctool/command/root.h>
+#include <vctool/commandline.h>
+#include <vctool/status_codes.h>
+
+/**
+ * \brief Process the query-serve command.
+ *
+ * \param opts          The command-line option structure.
+ * \param argc          The argument count.
+ * \param argv          The argument vector.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - a non-zero error code on failure.
+ */
+int process_query_serve_command(
+    commandline_opts* opts, int argc, char* argv[])
+{
+    int retval;
+
+    /* parameter sanity checks. */
+    MODEL_ASSERT(PROP_VALID_COMMANDLINE_OPTS(opts));
+
+    /* we need a segment and a socket path. */
+    if (2 != argc)
+    {
+        fprintf(stderr, "Expecting query-serve segment socket.\n");
+        retval = VCTOOL_ERROR_COMMANDLINE_MISSING_ARGUMENT;
+        goto done;
+    }
+
+    /* allocate memory for a query_serve_command structure. */
+    query_serve_command* query_serve =
+        (query_serve_command*)malloc(sizeof(query_serve_command));
+    if (NULL == query_serve)
+    {
+        retval = VCTOOL_ERROR_GENERAL_OUT_OF_MEMORY;
+        goto done;
+    }
+
+    /* initialize the structure. */
+    retval = query_serve_command_init(query_serve);
+    if (VCTOOL_STATUS_SUCCESS != retval)
+    {
+        goto free_query_serve;
+    }
+
+    query_serve->segment = argv[0];
+    query_serve->socket_path = argv[1];
+
+    /* set query_serve command as the head of opts command. */
+    query_serve->hdr.next = opts->cmd;
+    opts->cmd = &query_serve->hdr;
+
+    /* success. */
+    retval = VCTOOL_STATUS_SUCCESS;
+    goto done;
+
+free_query_serve:
+    free(query_serve);
+
+done:
+    return retval;
+}
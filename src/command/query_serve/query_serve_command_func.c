@@ -0,0 +1,441 @@
+/**
+ * \file command/query_serve/query_serve_command_func.c
+ *
+ * \brief Entry point for the query-serve command.
+ *
+ * \copyright 2020 Velo Payments.  See License.txt for license terms.
+ */
+
+#include <cbmc/model_assert.h>
+#include <errno.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <vctool/command/query_serve.h>
+#include <vctool/commandline.h>
+#include <vctool/query.h>
+#include <vctool/scheduler.h>
+
+/* the response bytes each waiting client may send in a round. */
+#define QUERY_SERVE_QUANTUM                             (64 * 1024)
+
+/* the pipeline depth past which a client is running a bulk job. */
+#define QUERY_SERVE_INTERACTIVE_DEPTH                   4
+
+/* the pipeline depth past which a client's requests are not read. */
+#define QUERY_SERVE_MAX_DEPTH                           64
+
+typedef struct query_serve_state query_serve_state;
+
+/**
+ * \brief A client connection.
+ */
+typedef struct query_serve_connection
+{
+    /* the flow is first, so that a flow is its connection. */
+    scheduler_flow flow;
+    struct query_serve_connection* next;
+    struct query_serve_connection* prev;
+    query_serve_state* state;
+    int sock;
+    bool failed;
+} query_serve_connection;
+
+/**
+ * \brief A request read from a connection.
+ */
+typedef struct query_serve_request
+{
+    /* the item is first, so that an item is its request. */
+    scheduler_item item;
+    agent_frame frame;
+} query_serve_request;
+
+/**
+ * \brief State shared by the query workers and connection readers.
+ */
+struct query_serve_state
+{
+    query_index* index;
+    int listener;
+    scheduler sched;
+    pthread_mutex_t lock;
+    pthread_cond_t closed;
+    query_serve_connection* connections;
+};
+
+/* forward decls. */
+static void query_serve_accept(query_serve_state* state);
+static void* query_serve_reader(void* arg);
+static void* query_serve_worker(void* arg);
+static void query_serve_close(query_serve_connection* conn);
+
+/**
+ * \brief Execute the query-serve command.
+ *
+ * The segment is indexed once, then a thread per connection reads requests
+ * and queues them with the scheduler, and one worker thread per online
+ * processor answers them.  Artifact queries, which can return any number of
+ * certificates, and the requests of clients pipelining deeply are bulk
+ * work; other lookups are interactive, and run ahead of bulk work, which
+ * may only occupy half of the workers.  Clients within a class share the
+ * workers in proportion to the bytes sent to them.  The command runs until
+ * it is killed.
+ *
+ * \param opts          The commandline opts for this operation.
+ *
+ * \returns a status code indicating success or failure.
+ *      - a non-zero error code on failure.
+ */
+int query_serve_command_func(commandline_opts* opts)
+{
+    int retval;
+    query_index index;
+    query_serve_state state;
+
+    /* parameter sanity checks. */
+    MODEL_ASSERT(PROP_VALID_COMMANDLINE_OPTS(opts));
+
+    /* get the query-serve command. */
+    query_serve_command* query_serve = (query_serve_command*)opts->cmd;
+    MODEL_ASSERT(NULL != query_serve);
+
+    /* a client which hangs up mid-response must not kill the server. */
+    signal(SIGPIPE, SIG_IGN);
+
+    retval = query_index_init(&index, opts->file, query_serve->segment);
+    if (VCTOOL_STATUS_SUCCESS != retval)
+    {
+        fprintf(stderr, "Could not index %s.\n", query_serve->segment);
+        goto done;
+    }
+
+    retval = query_listen(&state.listener, query_serve->socket_path);
+    if (VCTOOL_STATUS_SUCCESS != retval)
+    {
+        fprintf(
+            stderr, "Could not listen on %s.\n", query_serve->socket_path);
+        goto cleanup_index;
+    }
+
+    state.index = &index;
+    state.connections = NULL;
+
+    /* one worker per processor, at most half of them running bulk work. */
+    long online = sysconf(_SC_NPROCESSORS_ONLN);
+    size_t thread_count = (online > 0) ? (size_t)online : 1;
+    size_t bulk_limit = (thread_count > 1) ? thread_count / 2 : 1;
+
+    retval =
+        scheduler_init(
+            &state.sched, bulk_limit, QUERY_SERVE_INTERACTIVE_DEPTH,
+            QUERY_SERVE_QUANTUM, QUERY_SERVE_MAX_DEPTH);
+    if (VCTOOL_STATUS_SUCCESS != retval)
+    {
+        goto cleanup_listener;
+    }
+
+    if (0 != pthread_mutex_init(&state.lock, NULL))
+    {
+        retval = VCTOOL_ERROR_GENERAL_OUT_OF_MEMORY;
+        goto cleanup_sched;
+    }
+
+    if (0 != pthread_cond_init(&state.closed, NULL))
+    {
+        retval = VCTOOL_ERROR_GENERAL_OUT_OF_MEMORY;
+        goto cleanup_lock;
+    }
+
+    pthread_t* threads =
+        (pthread_t*)calloc(thread_count, sizeof(pthread_t));
+    if (NULL == threads)
+    {
+        retval = VCTOOL_ERROR_GENERAL_OUT_OF_MEMORY;
+        goto cleanup_closed;
+    }
+
+    /* a worker which can't be started just leaves more for the others. */
+    size_t started = 0;
+    for (; started < thread_count; ++started)
+    {
+        if (0 !=
+                pthread_create(
+                    &threads[started], NULL, &query_serve_worker, &state))
+        {
+            break;
+        }
+    }
+
+    if (0 == started)
+    {
+        retval = VCTOOL_ERROR_GENERAL_OUT_OF_MEMORY;
+        goto cleanup_threads;
+    }
+
+    printf(
+        "Serving %zu blocks, %zu transactions and %zu artifacts on %s.\n",
+        index.block_count, (size_t)index.transaction_ids.count,
+        (size_t)index.artifact_ids.count, query_serve->socket_path);
+    fflush(stdout);
+
+    /* the calling thread accepts connections until the listening socket
+     * fails. */
+    query_serve_accept(&state);
+    retval = VCTOOL_ERROR_QUERY_LISTEN;
+
+    /* stop the workers, and hang up on every client. */
+    scheduler_stop(&state.sched);
+    for (size_t t = 0; t < started; ++t)
+    {
+        pthread_join(threads[t], NULL);
+    }
+
+    pthread_mutex_lock(&state.lock);
+    for (query_serve_connection* conn = state.connections; NULL != conn;
+         conn = conn->next)
+    {
+        shutdown(conn->sock, SHUT_RDWR);
+    }
+
+    while (NULL != state.connections)
+    {
+        pthread_cond_wait(&state.closed, &state.lock);
+    }
+    pthread_mutex_unlock(&state.lock);
+
+cleanup_threads:
+    free(threads);
+
+cleanup_closed:
+    pthread_cond_destroy(&state.closed);
+
+cleanup_lock:
+    pthread_mutex_destroy(&state.lock);
+
+cleanup_sched:
+    dispose((disposable_t*)&state.sched);
+
+cleanup_listener:
+    close(state.listener);
+    unlink(query_serve->socket_path);
+
+cleanup_index:
+    dispose((disposable_t*)&index);
+
+done:
+    return retval;
+}
+
+/**
+ * \brief Accept connections, starting a reader for each.
+ *
+ * \param state         The shared query-serve state.
+ */
+static void query_serve_accept(query_serve_state* state)
+{
+    pthread_attr_t attr;
+
+    if (0 != pthread_attr_init(&attr))
+    {
+        return;
+    }
+
+    pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
+
+    for (;;)
+    {
+        pthread_t reader;
+
+        int sock = accept(state->listener, NULL, NULL);
+        if (sock < 0)
+        {
+            /* a failed connection does not stop the server. */
+            if (EINTR == errno || ECONNABORTED == errno)
+            {
+                continue;
+            }
+
+            break;
+        }
+
+        query_serve_connection* conn =
+            (query_serve_connection*)malloc(sizeof(query_serve_connection));
+        if (NULL == conn)
+        {
+            close(sock);
+            continue;
+        }
+
+        scheduler_flow_init(&conn->flow);
+        conn->state = state;
+        conn->sock = sock;
+        conn->failed = false;
+
+        pthread_mutex_lock(&state->lock);
+        conn->prev = NULL;
+        conn->next = state->connections;
+        if (NULL != conn->next)
+        {
+            conn->next->prev = conn;
+        }
+        state->connections = conn;
+        pthread_mutex_unlock(&state->lock);
+
+        if (0 != pthread_create(&reader, &attr, &query_serve_reader, conn))
+        {
+            query_serve_close(conn);
+        }
+    }
+
+    pthread_attr_destroy(&attr);
+}
+
+/**
+ * \brief Read requests from a connection and queue them, until the client
+ * closes it.
+ *
+ * \param arg           The connection.
+ *
+ * \returns NULL.
+ */
+static void* query_serve_reader(void* arg)
+{
+    int retval;
+    query_serve_connection* conn = (query_serve_connection*)arg;
+    query_serve_state* state = conn->state;
+
+    for (;;)
+    {
+        query_serve_request* request =
+            (query_serve_request*)malloc(sizeof(query_serve_request));
+        if (NULL == request)
+        {
+            break;
+        }
+
+        agent_frame_init(&request->frame);
+        retval = agent_frame_read(state->index->f, conn->sock, &request->frame);
+        if (VCTOOL_STATUS_SUCCESS == retval)
+        {
+            /* an artifact query returns any number of certificates. */
+            request->item.priority =
+                (QUERY_REQ_ARTIFACT == request->frame.type)
+                    ? SCHEDULER_BULK : SCHEDULER_INTERACTIVE;
+
+            retval =
+                scheduler_submit(&state->sched, &conn->flow, &request->item);
+        }
+
+        if (VCTOOL_STATUS_SUCCESS != retval)
+        {
+            if (VCTOOL_ERROR_AGENT_DISCONNECTED != retval
+             && VCTOOL_ERROR_SCHEDULER_STOPPED != retval)
+            {
+                fprintf(
+                    stderr, "Dropped a query client (%x).\n",
+                    (unsigned)retval);
+            }
+
+            dispose((disposable_t*)&request->frame);
+            free(request);
+            break;
+        }
+    }
+
+    query_serve_close(conn);
+
+    return NULL;
+}
+
+/**
+ * \brief Answer queued requests until the scheduler is stopped.
+ *
+ * \param arg           The shared query-serve state.
+ *
+ * \returns NULL.
+ */
+static void* query_serve_worker(void* arg)
+{
+    query_serve_state* state = (query_serve_state*)arg;
+    scheduler_flow* flow;
+    scheduler_item* item;
+
+    while (
+        VCTOOL_STATUS_SUCCESS == scheduler_next(&state->sched, &flow, &item))
+    {
+        query_serve_connection* conn = (query_serve_connection*)flow;
+        query_serve_request* request = (query_serve_request*)item;
+        size_t sent = 0;
+
+        /* once a response fails, the rest of the pipeline is dropped; only
+         * one request of a connection runs at a time. */
+        if (!conn->failed)
+        {
+            int retval =
+                query_answer(
+                    state->index, conn->sock, &request->frame, &sent);
+            if (VCTOOL_STATUS_SUCCESS != retval)
+            {
+                fprintf(
+                    stderr, "Dropped a query client (%x).\n",
+                    (unsigned)retval);
+                conn->failed = true;
+                shutdown(conn->sock, SHUT_RDWR);
+            }
+        }
+
+        scheduler_done(&state->sched, flow, item, (int64_t)sent);
+        dispose((disposable_t*)&request->frame);
+        free(request);
+    }
+
+    return NULL;
+}
+
+/**
+ * \brief Close a connection once its requests are done.
+ *
+ * \param conn          The connection.
+ */
+static void query_serve_close(query_serve_connection* conn)
+{
+    query_serve_state* state = conn->state;
+
+    scheduler_drain(&state->sched, &conn->flow);
+
+    /* release requests left waiting by a stopped scheduler. */
+    while (NULL != conn->flow.head)
+    {
+        query_serve_request* request = (query_serve_request*)conn->flow.head;
+        conn->flow.head = request->item.next;
+        dispose((disposable_t*)&request->frame);
+        free(request);
+    }
+
+    close(conn->sock);
+
+    pthread_mutex_lock(&state->lock);
+    if (NULL != conn->prev)
+    {
+        conn->prev->next = conn->next;
+    }
+    else
+    {
+        state->connections = conn->next;
+    }
+
+    if (NULL != conn->next)
+    {
+        conn->next->prev = conn->prev;
+    }
+
+    pthread_cond_broadcast(&state->closed);
+    pthread_mutex_unlock(&state->lock);
+
+    free(conn);
+}
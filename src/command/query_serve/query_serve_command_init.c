@@ -0,0 +1,52 @@
+/**
+ * \file command/query_serve/query_serve_command_init.c
+ *
+ * \brief Initialize a query-serve command structure.
+ *
+ * \copyright 2020 Velo Payments.  See License.txt for license terms.
+ */
+
+#include <cbmc/model_assert.h>
+#include <string.h>
+#include <vctool/command/query_serve.h>
+#include <vctool/command/root.h>
+#include <vctool/status_codes.h>
+#include <vpr/parameters.h>
+
+/* forward decls. */
+static void query_serve_command_dispose(void* disp);
+
+/**
+ * \brief Initialize a query-serve command structure.
+ *
+ * \param query_serve   The query-serve command structure to initialize.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - a non-zero error code on failure.
+ */
+int query_serve_command_init(query_serve_command* query_serve)
+{
+    /* parameter sanity checks. */
+    MODEL_ASSERT(NULL != query_serve);
+
+    /* clear query_serve command structure. */
+    memset(query_serve, 0, sizeof(query_serve_command));
+
+    /* set disposer, func, etc. */
+    query_serve->hdr.hdr.dispose = &query_serve_command_dispose;
+    query_serve->hdr.func = &query_serve_command_func;
+
+    /* success. */
+    return VCTOOL_STATUS_SUCCESS;
+}
+
+/**
+ * \brief Dispose of a query_serve_command structure.
+ *
+ * \param disp          The query_serve_command structure to dispose.
+ */
+static void query_serve_command_dispose(void* UNUSED(disp))
+{
+    /* do nothing. */
+}
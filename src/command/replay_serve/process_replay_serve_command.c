@@ -0,0 +1,96 @@
+/**
+ * \file command/replay_serve/process_replay_serve_command.c
+ *
+ * \brief Process command-line options to build a replay-serve command.
+ *
+ * \copyright 2020 Velo Payments.  See License.txt for license terms.
+ */
+
+#include <cbmc/model_assert.h>
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vctool/command/replay_serve.h>
+#include <vctool/command/root.h>
+#include <vctool/commandline.h>
+#include <vctool/status_codes.h>
+
+/**
+ * \brief Process the replay-serve command.
+ *
+ * \param opts          The command-line option structure.
+ * \param argc          The argument count.
+ * \param argv          The argument vector.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - a non-zero error code on failure.
+ */
+int process_replay_serve_command(
+    commandline_opts* opts, int argc, char* argv[])
+{
+    int retval;
+
+    /* parameter sanity checks. */
+    MODEL_ASSERT(PROP_VALID_COMMANDLINE_OPTS(opts));
+
+    /* we need a recording and a socket path, and may have a latency. */
+    if (argc < 2 || argc > 3)
+    {
+        fprintf(
+            stderr,
+            "Expecting replay-serve recording socket [latency-percent].\n");
+        retval = VCTOOL_ERROR_COMMANDLINE_MISSING_ARGUMENT;
+        goto done;
+    }
+
+    /* recorded latency is replayed as is unless it is scaled. */
+    long latency_percent = 100;
+    if (3 == argc)
+    {
+        char* end;
+        latency_percent = strtol(argv[2], &end, 10);
+        if (0 == *argv[2] || 0 != *end
+         || latency_percent < 0 || latency_percent > UINT_MAX / 2)
+        {
+            fprintf(stderr, "Latency percent must be a number >= 0.\n");
+            retval = VCTOOL_ERROR_COMMANDLINE_BAD_ARGUMENT;
+            goto done;
+        }
+    }
+
+    /* allocate memory for a replay_serve_command structure. */
+    replay_serve_command* replay_serve =
+        (replay_serve_command*)malloc(sizeof(replay_serve_command));
+    if (NULL == replay_serve)
+    {
+        retval = VCTOOL_ERROR_GENERAL_OUT_OF_MEMORY;
+        goto done;
+    }
+
+    /* initialize the structure. */
+    retval = replay_serve_command_init(replay_serve);
+    if (VCTOOL_STATUS_SUCCESS != retval)
+    {
+        goto free_replay_serve;
+    }
+
+    replay_serve->recording = argv[0];
+    replay_serve->socket_path = argv[1];
+    replay_serve->latency_percent = (unsigned)latency_percent;
+
+    /* set replay_serve command as the head of opts command. */
+    replay_serve->hdr.next = opts->cmd;
+    opts->cmd = &replay_serve->hdr;
+
+    /* success. */
+    retval = VCTOOL_STATUS_SUCCESS;
+    goto done;
+
+free_replay_serve:
+    free(replay_serve);
+
+done:
+    return retval;
+}
@@ -0,0 +1,170 @@
+/**
+ * \file command/replay_serve/replay_serve_command_func.c
+ *
+ * \brief Entry point for the replay-serve command.
+ *
+ * \copyright 2020 Velo Payments.  See License.txt for license terms.
+ */
+
+#include <cbmc/model_assert.h>
+#include <errno.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <vctool/agent.h>
+#include <vctool/command/replay_serve.h>
+#include <vctool/commandline.h>
+#include <vctool/query.h>
+
+/**
+ * \brief A connection served by its own thread.
+ */
+typedef struct replay_serve_connection
+{
+    agent_replay* replay;
+    int sock;
+} replay_serve_connection;
+
+/* forward decls. */
+static void* replay_serve_worker(void* arg);
+
+/**
+ * \brief Execute the replay-serve command.
+ *
+ * The recording is loaded once, then every connection accepted on the socket
+ * is answered from it by its own thread, since a replayed subscription holds
+ * its connection for as long as the recorded one did.  The command runs
+ * until it is killed.
+ *
+ * \param opts          The commandline opts for this operation.
+ *
+ * \returns a status code indicating success or failure.
+ *      - a non-zero error code on failure.
+ */
+int replay_serve_command_func(commandline_opts* opts)
+{
+    int retval, listener;
+    agent_replay replay;
+    pthread_attr_t attr;
+
+    /* parameter sanity checks. */
+    MODEL_ASSERT(PROP_VALID_COMMANDLINE_OPTS(opts));
+
+    /* get the replay-serve command. */
+    replay_serve_command* replay_serve = (replay_serve_command*)opts->cmd;
+    MODEL_ASSERT(NULL != replay_serve);
+
+    /* a client which hangs up mid-response must not kill the server. */
+    signal(SIGPIPE, SIG_IGN);
+
+    retval =
+        agent_replay_init(
+            &replay, opts->file, replay_serve->recording,
+            replay_serve->latency_percent);
+    if (VCTOOL_STATUS_SUCCESS != retval)
+    {
+        fprintf(stderr, "Could not load %s.\n", replay_serve->recording);
+        goto done;
+    }
+
+    /* the query server's listener serves any framed protocol. */
+    retval = query_listen(&listener, replay_serve->socket_path);
+    if (VCTOOL_STATUS_SUCCESS != retval)
+    {
+        fprintf(
+            stderr, "Could not listen on %s.\n", replay_serve->socket_path);
+        goto cleanup_replay;
+    }
+
+    if (0 != pthread_attr_init(&attr))
+    {
+        retval = VCTOOL_ERROR_GENERAL_OUT_OF_MEMORY;
+        goto cleanup_listener;
+    }
+    pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
+
+    printf(
+        "Replaying %zu exchanges at %u%% latency on %s.\n",
+        replay.exchange_count, replay_serve->latency_percent,
+        replay_serve->socket_path);
+    fflush(stdout);
+
+    for (;;)
+    {
+        pthread_t thread;
+
+        int sock = accept(listener, NULL, NULL);
+        if (sock < 0)
+        {
+            /* a failed connection does not stop the server. */
+            if (EINTR == errno || ECONNABORTED == errno)
+            {
+                continue;
+            }
+
+            retval = VCTOOL_ERROR_QUERY_LISTEN;
+            break;
+        }
+
+        replay_serve_connection* conn =
+            (replay_serve_connection*)malloc(sizeof(replay_serve_connection));
+        if (NULL == conn)
+        {
+            close(sock);
+            continue;
+        }
+
+        conn->replay = &replay;
+        conn->sock = sock;
+
+        if (0 != pthread_create(&thread, &attr, &replay_serve_worker, conn))
+        {
+            close(sock);
+            free(conn);
+        }
+    }
+
+    pthread_attr_destroy(&attr);
+    close(listener);
+    unlink(replay_serve->socket_path);
+
+    /* workers may still be answering from the replay, so it is left for the
+     * process exit to release. */
+    goto done;
+
+cleanup_listener:
+    close(listener);
+    unlink(replay_serve->socket_path);
+
+cleanup_replay:
+    dispose((disposable_t*)&replay);
+
+done:
+    return retval;
+}
+
+/**
+ * \brief Answer a connection from the recording.
+ *
+ * \param arg           The connection, which this thread owns.
+ *
+ * \returns NULL.
+ */
+static void* replay_serve_worker(void* arg)
+{
+    replay_serve_connection* conn = (replay_serve_connection*)arg;
+
+    int retval = agent_replay_serve(conn->replay, conn->sock);
+    if (VCTOOL_STATUS_SUCCESS != retval)
+    {
+        fprintf(stderr, "Dropped a replay client (%x).\n", (unsigned)retval);
+    }
+
+    close(conn->sock);
+    free(conn);
+
+    return NULL;
+}
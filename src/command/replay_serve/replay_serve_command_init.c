@@ -0,0 +1,52 @@
+/**
+ * \file command/replay_serve/replay_serve_command_init.c
+ *
+ * \brief Initialize a replay-serve command structure.
+ *
+ * \copyright 2020 Velo Payments.  See License.txt for license terms.
+ */
+
+#include <cbmc/model_assert.h>
+#include <string.h>
+#include <vctool/command/replay_serve.h>
+#include <vctool/command/root.h>
+#include <vctool/status_codes.h>
+#include <vpr/parameters.h>
+
+/* forward decls. */
+static void replay_serve_command_dispose(void* disp);
+
+/**
+ * \brief Initialize a replay-serve command structure.
+ *
+ * \param replay_serve  The replay-serve command structure to initialize.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - a non-zero error code on failure.
+ */
+int replay_serve_command_init(replay_serve_command* replay_serve)
+{
+    /* parameter sanity checks. */
+    MODEL_ASSERT(NULL != replay_serve);
+
+    /* clear replay_serve command structure. */
+    memset(replay_serve, 0, sizeof(replay_serve_command));
+
+    /* set disposer, func, etc. */
+    replay_serve->hdr.hdr.dispose = &replay_serve_command_dispose;
+    replay_serve->hdr.func = &replay_serve_command_func;
+
+    /* success. */
+    return VCTOOL_STATUS_SUCCESS;
+}
+
+/**
+ * \brief Dispose of a replay_serve_command structure.
+ *
+ * \param disp          The replay_serve_command structure to dispose.
+ */
+static void replay_serve_command_dispose(void* UNUSED(disp))
+{
+    /* do nothing. */
+}
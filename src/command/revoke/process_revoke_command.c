@@ -0,0 +1,94 @@
+/**
+ * \file command/revoke/process_revoke_command.c
+ *
+ * \brief Process command-line options to build a revoke command.
+ *
+ * \copyright 2020 Velo Payments.  See License.txt for license terms.
+ */
+
+#include <cbmc/model_assert.h>
+#include <stdio.h>
+#include <string.h>
+#include <vctool/command/revoke.h>
+#include <vctool/command/root.h>
+#include <vctool/commandline.h>
+#include <vctool/status_codes.h>
+
+/**
+ * \brief Process the revoke command.
+ *
+ * \param opts          The command-line option structure.
+ * \param argc          The argument count.
+ * \param argv          The argument vector.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - a non-zero error code on failure.
+ */
+int process_revoke_command(commandline_opts* opts, int argc, char* argv[])
+{
+    int retval;
+    revoke_action action;
+
+    /* parameter sanity checks. */
+    MODEL_ASSERT(PROP_VALID_COMMANDLINE_OPTS(opts));
+
+    /* we need a subcommand and a list filename. */
+    if (argc < 2)
+    {
+        fprintf(stderr, "Expecting revoke add|check list.rev [uuid ...].\n");
+        retval = VCTOOL_ERROR_COMMANDLINE_MISSING_ARGUMENT;
+        goto done;
+    }
+
+    /* decode the subcommand. */
+    if (!strcmp(argv[0], "add"))
+    {
+        action = REVOKE_ACTION_ADD;
+    }
+    else if (!strcmp(argv[0], "check"))
+    {
+        action = REVOKE_ACTION_CHECK;
+    }
+    else
+    {
+        fprintf(stderr, "Unknown revoke command %s.\n", argv[0]);
+        retval = VCTOOL_ERROR_COMMANDLINE_UNKNOWN_COMMAND;
+        goto done;
+    }
+
+    /* allocate memory for a revoke_command structure. */
+    revoke_command* revoke = (revoke_command*)malloc(sizeof(revoke_command));
+    if (NULL == revoke)
+    {
+        retval = VCTOOL_ERROR_GENERAL_OUT_OF_MEMORY;
+        goto done;
+    }
+
+    /* initialize the structure. */
+    retval = revoke_command_init(revoke);
+    if (VCTOOL_STATUS_SUCCESS != retval)
+    {
+        goto free_revoke;
+    }
+
+    /* the remaining arguments are ids; if there are none, read stdin. */
+    revoke->action = action;
+    revoke->list_filename = argv[1];
+    revoke->ids = argv + 2;
+    revoke->id_count = argc - 2;
+
+    /* set revoke command as the head of opts command. */
+    revoke->hdr.next = opts->cmd;
+    opts->cmd = &revoke->hdr;
+
+    /* success. */
+    retval = VCTOOL_STATUS_SUCCESS;
+    goto done;
+
+free_revoke:
+    free(revoke);
+
+done:
+    return retval;
+}
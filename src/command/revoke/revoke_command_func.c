@@ -0,0 +1,394 @@
+/**
+ * \file command/revoke/revoke_command_func.c
+ *
+ * \brief Entry point for the revoke command.
+ *
+ * \copyright 2020 Velo Payments.  See License.txt for license terms.
+ */
+
+#include <cbmc/model_assert.h>
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vctool/command/revoke.h>
+#include <vctool/commandline.h>
+#include <vctool/revocation.h>
+#include <vctool/uuid.h>
+
+/**
+ * \brief Receive an id read for this command.
+ *
+ * \param context       The user context passed to revoke_read_ids.
+ * \param id            The REVOCATION_ENTRY_SIZE byte id.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - a non-zero error code to stop reading.
+ */
+typedef int (*revoke_id_fn)(void* context, const uint8_t* id);
+
+/**
+ * \brief Ids collected in memory.
+ */
+typedef struct revoke_ids
+{
+    uint8_t* ids;
+    size_t count;
+    size_t reserved;
+} revoke_ids;
+
+/**
+ * \brief Ids streamed into a revocation list builder.
+ */
+typedef struct revoke_build_state
+{
+    revocation_builder* builder;
+    size_t count;
+} revoke_build_state;
+
+/* forward decls. */
+static int revoke_read_ids(
+    revoke_command* revoke, revoke_id_fn fn, void* context);
+static int revoke_parse_id(
+    const char* str, revoke_id_fn fn, void* context);
+static int revoke_collect_id(void* context, const uint8_t* id);
+static int revoke_build_id(void* context, const uint8_t* id);
+static int revoke_add(commandline_opts* opts, revoke_command* revoke);
+static int revoke_check(
+    commandline_opts* opts, revoke_command* revoke, const uint8_t* ids,
+    size_t count);
+
+/**
+ * \brief Execute the revoke command.
+ *
+ * \param opts          The commandline opts for this operation.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - VCTOOL_ERROR_REVOCATION_REVOKED if a checked id is revoked.
+ *      - a non-zero error code on failure.
+ */
+int revoke_command_func(commandline_opts* opts)
+{
+    int retval = VCTOOL_STATUS_SUCCESS;
+    revoke_ids ids = { NULL, 0, 0 };
+
+    /* parameter sanity checks. */
+    MODEL_ASSERT(PROP_VALID_COMMANDLINE_OPTS(opts));
+
+    /* get the revoke command. */
+    revoke_command* revoke = (revoke_command*)opts->cmd;
+    MODEL_ASSERT(NULL != revoke);
+
+    /* run the subcommand. */
+    switch (revoke->action)
+    {
+        case REVOKE_ACTION_ADD:
+            retval = revoke_add(opts, revoke);
+            break;
+
+        case REVOKE_ACTION_CHECK:
+            /* gather the ids from the command line or stdin. */
+            retval = revoke_read_ids(revoke, &revoke_collect_id, &ids);
+            if (VCTOOL_STATUS_SUCCESS == retval)
+            {
+                retval = revoke_check(opts, revoke, ids.ids, ids.count);
+            }
+            break;
+    }
+
+    free(ids.ids);
+
+    return retval;
+}
+
+/**
+ * \brief Read the ids for this command, passing each to a function.
+ *
+ * \param revoke        The revoke command.
+ * \param fn            The function which receives each id.
+ * \param context       The user context for fn.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - a non-zero error code on failure.
+ */
+static int revoke_read_ids(
+    revoke_command* revoke, revoke_id_fn fn, void* context)
+{
+    int retval = VCTOOL_STATUS_SUCCESS;
+
+    /* ids on the command line take precedence. */
+    if (revoke->id_count > 0)
+    {
+        for (int i = 0; i < revoke->id_count; ++i)
+        {
+            retval = revoke_parse_id(revoke->ids[i], fn, context);
+            if (VCTOOL_STATUS_SUCCESS != retval)
+            {
+                return retval;
+            }
+        }
+
+        return VCTOOL_STATUS_SUCCESS;
+    }
+
+    /* otherwise, read one id per line from stdin. */
+    char* line = NULL;
+    size_t line_size = 0;
+    while (getline(&line, &line_size, stdin) >= 0)
+    {
+        /* trim trailing whitespace. */
+        size_t len = strlen(line);
+        while (len > 0 && isspace((unsigned char)line[len - 1]))
+        {
+            line[--len] = 0;
+        }
+
+        /* skip blank lines. */
+        if (0 == len)
+        {
+            continue;
+        }
+
+        retval = revoke_parse_id(line, fn, context);
+        if (VCTOOL_STATUS_SUCCESS != retval)
+        {
+            break;
+        }
+    }
+
+    free(line);
+
+    return retval;
+}
+
+/**
+ * \brief Parse an id and pass it to a function.
+ *
+ * \param str           The id string to parse.
+ * \param fn            The function which receives the id.
+ * \param context       The user context for fn.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - a non-zero error code on failure.
+ */
+static int revoke_parse_id(
+    const char* str, revoke_id_fn fn, void* context)
+{
+    int retval;
+    uint8_t id[REVOCATION_ENTRY_SIZE];
+
+    retval = uuid_from_string(id, str);
+    if (VCTOOL_STATUS_SUCCESS != retval)
+    {
+        fprintf(stderr, "Invalid uuid %s.\n", str);
+        return retval;
+    }
+
+    return fn(context, id);
+}
+
+/**
+ * \brief Append an id to an id array.
+ *
+ * \param context       The revoke_ids array.
+ * \param id            The id to append.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - VCTOOL_ERROR_GENERAL_OUT_OF_MEMORY if an allocation failed.
+ */
+static int revoke_collect_id(void* context, const uint8_t* id)
+{
+    revoke_ids* ids = (revoke_ids*)context;
+
+    /* grow the array if needed. */
+    if (ids->count == ids->reserved)
+    {
+        size_t new_reserved = (0 == ids->reserved) ? 16 : 2 * ids->reserved;
+        uint8_t* tmp =
+            (uint8_t*)realloc(ids->ids, new_reserved * REVOCATION_ENTRY_SIZE);
+        if (NULL == tmp)
+        {
+            return VCTOOL_ERROR_GENERAL_OUT_OF_MEMORY;
+        }
+
+        ids->ids = tmp;
+        ids->reserved = new_reserved;
+    }
+
+    memcpy(
+        ids->ids + ids->count * REVOCATION_ENTRY_SIZE, id,
+        REVOCATION_ENTRY_SIZE);
+    ++ids->count;
+
+    return VCTOOL_STATUS_SUCCESS;
+}
+
+/**
+ * \brief Add an id to a revocation list builder.
+ *
+ * \param context       The revoke_build_state.
+ * \param id            The id to add.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - a non-zero error code on failure.
+ */
+static int revoke_build_id(void* context, const uint8_t* id)
+{
+    revoke_build_state* state = (revoke_build_state*)context;
+
+    ++state->count;
+
+    return revocation_builder_add(state->builder, id);
+}
+
+/**
+ * \brief Add ids to a revocation list, creating it if necessary.
+ *
+ * The new ids and the entries of the existing list are streamed into a
+ * revocation list builder, so neither is copied into memory before sorting.
+ *
+ * \param opts          The commandline opts for this operation.
+ * \param revoke        The revoke command.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - a non-zero error code on failure.
+ */
+static int revoke_add(commandline_opts* opts, revoke_command* revoke)
+{
+    int retval;
+    revocation_builder builder;
+    revocation_set set;
+    file_stat_st fst;
+    revoke_build_state state = { &builder, 0 };
+
+    retval =
+        revocation_builder_init(&builder, opts->file, revoke->list_filename);
+    if (VCTOOL_STATUS_SUCCESS != retval)
+    {
+        goto check_write;
+    }
+
+    /* stream the new ids into the builder. */
+    retval = revoke_read_ids(revoke, &revoke_build_id, &state);
+    if (VCTOOL_STATUS_SUCCESS != retval)
+    {
+        goto cleanup_builder_quiet;
+    }
+
+    /* if there is no list yet, write the new ids on their own. */
+    retval = file_stat(opts->file, revoke->list_filename, &fst);
+    if (VCTOOL_ERROR_FILE_NO_ENTRY == retval)
+    {
+        retval = revocation_builder_finish(&builder);
+        goto cleanup_builder;
+    }
+
+    /* nothing to add to an existing list. */
+    if (0 == state.count)
+    {
+        retval = VCTOOL_STATUS_SUCCESS;
+        goto cleanup_builder;
+    }
+
+    /* open the existing list. */
+    retval = revocation_set_open(&set, opts->file, revoke->list_filename);
+    if (VCTOOL_STATUS_SUCCESS != retval)
+    {
+        fprintf(stderr, "Error opening %s.\n", revoke->list_filename);
+        goto cleanup_builder_quiet;
+    }
+
+    /* stream the existing entries into the builder. */
+    for (uint64_t i = 0; i < set.count; ++i)
+    {
+        retval =
+            revocation_builder_add(
+                &builder, set.entries + i * REVOCATION_ENTRY_SIZE);
+        if (VCTOOL_STATUS_SUCCESS != retval)
+        {
+            break;
+        }
+    }
+
+    /* the old mapping must not outlive the list it maps. */
+    dispose((disposable_t*)&set);
+    if (VCTOOL_STATUS_SUCCESS != retval)
+    {
+        goto cleanup_builder;
+    }
+
+    /* replace the list. */
+    retval = revocation_builder_finish(&builder);
+
+cleanup_builder:
+    dispose((disposable_t*)&builder);
+
+check_write:
+    if (VCTOOL_STATUS_SUCCESS != retval)
+    {
+        fprintf(stderr, "Error writing %s.\n", revoke->list_filename);
+    }
+
+    return retval;
+
+cleanup_builder_quiet:
+    dispose((disposable_t*)&builder);
+
+    return retval;
+}
+
+/**
+ * \brief Check ids against a revocation list.
+ *
+ * \param opts          The commandline opts for this operation.
+ * \param revoke        The revoke command.
+ * \param ids           The ids to check.
+ * \param count         The number of ids to check.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS if no id is revoked.
+ *      - VCTOOL_ERROR_REVOCATION_REVOKED if any id is revoked.
+ *      - a non-zero error code on failure.
+ */
+static int revoke_check(
+    commandline_opts* opts, revoke_command* revoke, const uint8_t* ids,
+    size_t count)
+{
+    int retval;
+    revocation_set set;
+    char str[UUID_STRING_SIZE];
+
+    /* open the list. */
+    retval = revocation_set_open(&set, opts->file, revoke->list_filename);
+    if (VCTOOL_STATUS_SUCCESS != retval)
+    {
+        fprintf(stderr, "Error opening %s.\n", revoke->list_filename);
+        return retval;
+    }
+
+    /* check each id. */
+    for (size_t i = 0; i < count; ++i)
+    {
+        const uint8_t* id = ids + i * REVOCATION_ENTRY_SIZE;
+        bool revoked = revocation_set_contains(&set, id);
+
+        uuid_to_string(str, id);
+        printf("%s %s\n", str, revoked ? "revoked" : "ok");
+
+        if (revoked)
+        {
+            retval = VCTOOL_ERROR_REVOCATION_REVOKED;
+        }
+    }
+
+    dispose((disposable_t*)&set);
+
+    return retval;
+}
@@ -0,0 +1,52 @@
+/**
+ * \file command/revoke/revoke_command_init.c
+ *
+ * \brief Initialize a revoke command structure.
+ *
+ * \copyright 2020 Velo Payments.  See License.txt for license terms.
+ */
+
+#include <cbmc/model_assert.h>
+#include <string.h>
+#include <vctool/command/revoke.h>
+#include <vctool/command/root.h>
+#include <vctool/status_codes.h>
+#include <vpr/parameters.h>
+
+/* forward decls. */
+static void revoke_command_dispose(void* disp);
+
+/**
+ * \brief Initialize a revoke command structure.
+ *
+ * \param revoke        The revoke command structure to initialize.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - a non-zero error code on failure.
+ */
+int revoke_command_init(revoke_command* revoke)
+{
+    /* parameter sanity checks. */
+    MODEL_ASSERT(NULL != revoke);
+
+    /* clear revoke command structure. */
+    memset(revoke, 0, sizeof(revoke_command));
+
+    /* set disposer, func, etc. */
+    revoke->hdr.hdr.dispose = &revoke_command_dispose;
+    revoke->hdr.func = &revoke_command_func;
+
+    /* success. */
+    return VCTOOL_STATUS_SUCCESS;
+}
+
+/**
+ * \brief Dispose of a revoke_command structure.
+ *
+ * \param disp          The revoke_command structure to dispose.
+ */
+static void revoke_command_dispose(void* UNUSED(disp))
+{
+    /* do nothing. */
+}
@@ -9,10 +9,23 @@
 #include <cbmc/model_assert.h>
 #include <stdio.h>
 #include <string.h>
+#include <vctool/command/cert_gen.h>
+#include <vctool/command/chain_diff.h>
+#include <vctool/command/follow.h>
+#include <vctool/command/from_json.h>
 #include <vctool/command/help.h>
 #include <vctool/command/keygen.h>
 #include <vctool/command/pubkey.h>
+#include <vctool/command/query_serve.h>
+#include <vctool/command/replay_serve.h>
+#include <vctool/command/revoke.h>
 #include <vctool/command/root.h>
+#include <vctool/command/scrub.h>
+#include <vctool/command/submit.h>
+#include <vctool/command/to_json.h>
+#include <vctool/command/txn_status.h>
+#include <vctool/command/validate.h>
+#include <vctool/command/verify.h>
 #include <vctool/status_codes.h>
 
 /**
@@ -49,6 +62,26 @@ int dispatch_root_commands(commandline_opts* opts, int argc, char* argv[])
     {
         return process_help_command(opts, argc, argv);
     }
+    /* is this the cert-gen command? */
+    else if (!strcmp(command, "cert-gen"))
+    {
+        return process_cert_gen_command(opts, argc, argv);
+    }
+    /* is this the chain-diff command? */
+    else if (!strcmp(command, "chain-diff"))
+    {
+        return process_chain_diff_command(opts, argc, argv);
+    }
+    /* is this the follow command? */
+    else if (!strcmp(command, "follow"))
+    {
+        return process_follow_command(opts, argc, argv);
+    }
+    /* is this the from-json command? */
+    else if (!strcmp(command, "from-json"))
+    {
+        return process_from_json_command(opts, argc, argv);
+    }
     /* is this the keygen command? */
     else if (!strcmp(command, "keygen"))
     {
@@ -59,6 +92,51 @@ int dispatch_root_commands(commandline_opts* opts, int argc, char* argv[])
     {
         return process_pubkey_command(opts, argc, argv);
     }
+    /* is this the query-serve command? */
+    else if (!strcmp(command, "query-serve"))
+    {
+        return process_query_serve_command(opts, argc, argv);
+    }
+    /* is this the replay-serve command? */
+    else if (!strcmp(command, "replay-serve"))
+    {
+        return process_replay_serve_command(opts, argc, argv);
+    }
+    /* is this the revoke command? */
+    else if (!strcmp(command, "revoke"))
+    {
+        return process_revoke_command(opts, argc, argv);
+    }
+    /* is this the scrub command? */
+    else if (!strcmp(command, "scrub"))
+    {
+        return process_scrub_command(opts, argc, argv);
+    }
+    /* is this the submit command? */
+    else if (!strcmp(command, "submit"))
+    {
+        return process_submit_command(opts, argc, argv);
+    }
+    /* is this the to-json command? */
+    else if (!strcmp(command, "to-json"))
+    {
+        return process_to_json_command(opts, argc, argv);
+    }
+    /* is this the txn-status command? */
+    else if (!strcmp(command, "txn-status"))
+    {
+        return process_txn_status_command(opts, argc, argv);
+    }
+    /* is this the validate command? */
+    else if (!strcmp(command, "validate"))
+    {
+        return process_validate_command(opts, argc, argv);
+    }
+    /* is this the verify command? */
+    else if (!strcmp(command, "verify"))
+    {
+        return process_verify_command(opts, argc, argv);
+    }
     /* handle unknown command. */
     else
     {
@@ -0,0 +1,67 @@
+/**
+ * \file command/scrub/process_scrub_command.c
+ *
+ * \brief Process command-line options to build a scrub command.
+ *
+ * \copyright 2020 Velo Payments.  See License.txt for license terms.
+ */
+
+#include <cbmc/model_assert.h>
+#include <stdio.h>
+#include <string.h>
+#include <vctool/command/root.h>
+#include <vctool/command/scrub.h>
+#include <vctool/commandline.h>
+#include <vctool/status_codes.h>
+
+/**
+ * \brief Process the scrub command.
+ *
+ * \param opts          The command-line option structure.
+ * \param argc          The argument count.
+ * \param argv          The argument vector.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - a non-zero error code on failure.
+ */
+int process_scrub_command(commandline_opts* opts, int argc, char* argv[])
+{
+    int retval;
+
+    /* parameter sanity checks. */
+    MODEL_ASSERT(PROP_VALID_COMMANDLINE_OPTS(opts));
+
+    /* allocate memory for a scrub_command structure. */
+    scrub_command* scrub = (scrub_command*)malloc(sizeof(scrub_command));
+    if (NULL == scrub)
+    {
+        retval = VCTOOL_ERROR_GENERAL_OUT_OF_MEMORY;
+        goto done;
+    }
+
+    /* initialize the structure. */
+    retval = scrub_command_init(scrub);
+    if (VCTOOL_STATUS_SUCCESS != retval)
+    {
+        goto free_scrub;
+    }
+
+    /* the arguments are segments; if there are none, read stdin. */
+    scrub->segments = argv;
+    scrub->segment_count = argc;
+
+    /* set scrub command as the head of opts command. */
+    scrub->hdr.next = opts->cmd;
+    opts->cmd = &scrub->hdr;
+
+    /* success. */
+    retval = VCTOOL_STATUS_SUCCESS;
+    goto done;
+
+free_scrub:
+    free(scrub);
+
+done:
+    return retval;
+}
@@ -0,0 +1,355 @@
+/**
+ * \file command/scrub/scrub_command_func.c
+ *
+ * \brief Entry point for the scrub command.
+ *
+ * \copyright 2020 Velo Payments.  See License.txt for license terms.
+ */
+
+#include <cbmc/model_assert.h>
+#include <ctype.h>
+#include <inttypes.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <vctool/blockstore.h>
+#include <vctool/command/scrub.h>
+#include <vctool/commandline.h>
+
+/**
+ * \brief State shared by the scrub workers.
+ */
+typedef struct scrub_state
+{
+    file* f;
+    char** paths;
+    size_t count;
+    size_t next;
+    pthread_mutex_t lock;
+    blockstore_scrub_result total;
+    size_t failed;
+} scrub_state;
+
+/* forward decls. */
+static int scrub_read_paths(
+    scrub_command* scrub, char*** paths, size_t* count);
+static int scrub_append_path(
+    char*** paths, size_t* count, size_t* reserved, const char* path);
+static void* scrub_worker(void* arg);
+static void scrub_report_range(
+    void* context, const char* path, const blockstore_bad_range* range);
+static void scrub_print_height(uint64_t height);
+
+/**
+ * \brief Execute the scrub command.
+ *
+ * Segments are shared among one thread per online processor; each thread
+ * claims the next unscrubbed segment, so a large segment does not hold up the
+ * rest.
+ *
+ * \param opts          The commandline opts for this operation.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - VCTOOL_ERROR_BLOCKSTORE_CORRUPT if a segment is damaged.
+ *      - a non-zero error code on failure.
+ */
+int scrub_command_func(commandline_opts* opts)
+{
+    int retval;
+    scrub_state state;
+    char** paths = NULL;
+    size_t count = 0;
+
+    /* parameter sanity checks. */
+    MODEL_ASSERT(PROP_VALID_COMMANDLINE_OPTS(opts));
+
+    /* get the scrub command. */
+    scrub_command* scrub = (scrub_command*)opts->cmd;
+    MODEL_ASSERT(NULL != scrub);
+
+    /* gather the segments from the command line or stdin. */
+    retval = scrub_read_paths(scrub, &paths, &count);
+    if (VCTOOL_STATUS_SUCCESS != retval)
+    {
+        goto done;
+    }
+
+    memset(&state, 0, sizeof(state));
+    state.f = opts->file;
+    state.paths = paths;
+    state.count = count;
+    if (0 != pthread_mutex_init(&state.lock, NULL))
+    {
+        retval = VCTOOL_ERROR_GENERAL_OUT_OF_MEMORY;
+        goto done;
+    }
+
+    /* one thread per processor, but no more than there are segments. */
+    long online = sysconf(_SC_NPROCESSORS_ONLN);
+    size_t thread_count = (online > 0) ? (size_t)online : 1;
+    if (count < thread_count)
+    {
+        thread_count = (0 == count) ? 1 : count;
+    }
+
+    pthread_t* threads =
+        (pthread_t*)calloc(thread_count, sizeof(pthread_t));
+    if (NULL == threads)
+    {
+        retval = VCTOOL_ERROR_GENERAL_OUT_OF_MEMORY;
+        goto cleanup_lock;
+    }
+
+    /* start a thread for every worker but the first; a thread which can't
+     * be started just leaves more segments for the others. */
+    size_t started = 1;
+    for (; started < thread_count; ++started)
+    {
+        if (0 !=
+                pthread_create(&threads[started], NULL, &scrub_worker, &state))
+        {
+            break;
+        }
+    }
+
+    /* the calling thread is the first worker. */
+    scrub_worker(&state);
+
+    /* wait for the others. */
+    for (size_t t = 1; t < started; ++t)
+    {
+        pthread_join(threads[t], NULL);
+    }
+
+    printf(
+        "Scrubbed %zu segments: %" PRIu64 " records intact, %" PRIu64
+        " bad ranges (%" PRIu64 " bytes), %zu unreadable.\n",
+        count, state.total.records, state.total.bad_ranges,
+        state.total.bad_bytes, state.failed);
+
+    if (state.total.bad_ranges > 0)
+    {
+        retval = VCTOOL_ERROR_BLOCKSTORE_CORRUPT;
+    }
+    else if (state.failed > 0)
+    {
+        retval = VCTOOL_ERROR_BLOCKSTORE_BAD_SEGMENT;
+    }
+    else
+    {
+        retval = VCTOOL_STATUS_SUCCESS;
+    }
+
+    free(threads);
+
+cleanup_lock:
+    pthread_mutex_destroy(&state.lock);
+
+done:
+    for (size_t i = 0; i < count; ++i)
+    {
+        free(paths[i]);
+    }
+    free(paths);
+
+    return retval;
+}
+
+/**
+ * \brief Read the segment paths for this command.
+ *
+ * \param scrub         The scrub command.
+ * \param paths         Pointer to receive an allocated array of paths.
+ * \param count         Pointer to receive the number of paths.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - a non-zero error code on failure.
+ */
+static int scrub_read_paths(
+    scrub_command* scrub, char*** paths, size_t* count)
+{
+    int retval = VCTOOL_STATUS_SUCCESS;
+    size_t reserved = 0;
+
+    /* segments on the command line take precedence. */
+    if (scrub->segment_count > 0)
+    {
+        for (int i = 0; i < scrub->segment_count; ++i)
+        {
+            retval =
+                scrub_append_path(paths, count, &reserved, scrub->segments[i]);
+            if (VCTOOL_STATUS_SUCCESS != retval)
+            {
+                return retval;
+            }
+        }
+
+        return VCTOOL_STATUS_SUCCESS;
+    }
+
+    /* otherwise, read one path per line from stdin. */
+    char* line = NULL;
+    size_t line_size = 0;
+    while (getline(&line, &line_size, stdin) >= 0)
+    {
+        /* trim trailing whitespace. */
+        size_t len = strlen(line);
+        while (len > 0 && isspace((unsigned char)line[len - 1]))
+        {
+            line[--len] = 0;
+        }
+
+        /* skip blank lines. */
+        if (0 == len)
+        {
+            continue;
+        }
+
+        retval = scrub_append_path(paths, count, &reserved, line);
+        if (VCTOOL_STATUS_SUCCESS != retval)
+        {
+            break;
+        }
+    }
+
+    free(line);
+
+    return retval;
+}
+
+/**
+ * \brief Append a copy of a path to a path array.
+ *
+ * \param paths         The path array.
+ * \param count         The number of paths in the array.
+ * \param reserved      The number of paths allocated.
+ * \param path          The path to append.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - VCTOOL_ERROR_GENERAL_OUT_OF_MEMORY if an allocation failed.
+ */
+static int scrub_append_path(
+    char*** paths, size_t* count, size_t* reserved, const char* path)
+{
+    /* grow the array if needed. */
+    if (*count == *reserved)
+    {
+        size_t new_reserved = (0 == *reserved) ? 16 : 2 * *reserved;
+        char** tmp = (char**)realloc(*paths, new_reserved * sizeof(char*));
+        if (NULL == tmp)
+        {
+            return VCTOOL_ERROR_GENERAL_OUT_OF_MEMORY;
+        }
+
+        *paths = tmp;
+        *reserved = new_reserved;
+    }
+
+    char* copy = strdup(path);
+    if (NULL == copy)
+    {
+        return VCTOOL_ERROR_GENERAL_OUT_OF_MEMORY;
+    }
+
+    (*paths)[(*count)++] = copy;
+
+    return VCTOOL_STATUS_SUCCESS;
+}
+
+/**
+ * \brief Scrub segments until none are left.
+ *
+ * \param arg           The shared scrub state.
+ *
+ * \returns NULL.
+ */
+static void* scrub_worker(void* arg)
+{
+    scrub_state* state = (scrub_state*)arg;
+    blockstore_scrub_result result;
+
+    for (;;)
+    {
+        /* claim the next segment. */
+        pthread_mutex_lock(&state->lock);
+        size_t i = state->next++;
+        pthread_mutex_unlock(&state->lock);
+
+        if (i >= state->count)
+        {
+            break;
+        }
+
+        int retval =
+            blockstore_segment_scrub(
+                state->f, state->paths[i], &result, &scrub_report_range,
+                state);
+
+        /* fold this segment into the totals. */
+        pthread_mutex_lock(&state->lock);
+        state->total.records += result.records;
+        state->total.bad_ranges += result.bad_ranges;
+        state->total.bad_bytes += result.bad_bytes;
+        if (VCTOOL_STATUS_SUCCESS != retval
+         && VCTOOL_ERROR_BLOCKSTORE_CORRUPT != retval)
+        {
+            ++state->failed;
+            fprintf(
+                stderr, "%s: could not scrub segment (%x).\n",
+                state->paths[i], (unsigned)retval);
+        }
+        pthread_mutex_unlock(&state->lock);
+    }
+
+    return NULL;
+}
+
+/**
+ * \brief Print a damaged range.
+ *
+ * The heights on either side bound the blocks which must be fetched again to
+ * repair the range.
+ *
+ * \param context       The shared scrub state.
+ * \param path          The path of the segment.
+ * \param range         The damaged range.
+ */
+static void scrub_report_range(
+    void* context, const char* path, const blockstore_bad_range* range)
+{
+    scrub_state* state = (scrub_state*)context;
+
+    pthread_mutex_lock(&state->lock);
+
+    printf(
+        "%s: bad range %" PRIu64 "-%" PRIu64 " after height ", path,
+        range->begin, range->end);
+    scrub_print_height(range->height_before);
+    printf(", before height ");
+    scrub_print_height(range->height_after);
+    printf(".\n");
+
+    pthread_mutex_unlock(&state->lock);
+}
+
+/**
+ * \brief Print a block height, or "none" if there is none.
+ *
+ * \param height        The height to print.
+ */
+static void scrub_print_height(uint64_t height)
+{
+    if (BLOCKSTORE_NO_HEIGHT == height)
+    {
+        printf("none");
+    }
+    else
+    {
+        printf("%" PRIu64, height);
+    }
+}
@@ -0,0 +1,52 @@
+/**
+ * \file command/scrub/scrub_command_init.c
+ *
+ * \brief Initialize a scrub command structure.
+ *
+ * \copyright 2020 Velo Payments.  See License.txt for license terms.
+ */
+
+#include <cbmc/model_assert.h>
+#include <string.h>
+#include <vctool/command/scrub.h>
+#include <vctool/command/root.h>
+#include <vctool/status_codes.h>
+#include <vpr/parameters.h>
+
+/* forward decls. */
+static void scrub_command_dispose(void* disp);
+
+/**
+ * \brief Initialize a scrub command structure.
+ *
+ * \param scrub        The scrub command structure to initialize.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - a non-zero error code on failure.
+ */
+int scrub_command_init(scrub_command* scrub)
+{
+    /* parameter sanity checks. */
+    MODEL_ASSERT(NULL != scrub);
+
+    /* clear scrub command structure. */
+    memset(scrub, 0, sizeof(scrub_command));
+
+    /* set disposer, func, etc. */
+    scrub->hdr.hdr.dispose = &scrub_command_dispose;
+    scrub->hdr.func = &scrub_command_func;
+
+    /* success. */
+    return VCTOOL_STATUS_SUCCESS;
+}
+
+/**
+ * \brief Dispose of a scrub_command structure.
+ *
+ * \param disp          The scrub_command structure to dispose.
+ */
+static void scrub_command_dispose(void* UNUSED(disp))
+{
+    /* do nothing. */
+}
@@ -0,0 +1,75 @@
+/**
+ * \file command/submit/process_submit_command.c
+ *
+ * \brief Process command-line options to build a submit command.
+ *
+ * \copyright 2020 Velo Payments.  See License.txt for license terms.
+ */
+
+#include <cbmc/model_assert.h>
+#include <stdio.h>
+#include <string.h>
+#include <vctool/command/submit.h>
+#include <vctool/command/root.h>
+#include <vctool/commandline.h>
+#include <vctool/status_codes.h>
+
+/**
+ * \brief Process the submit command.
+ *
+ * \param opts          The command-line option structure.
+ * \param argc          The argument count.
+ * \param argv          The argument vector.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - a non-zero error code on failure.
+ */
+int process_submit_command(commandline_opts* opts, int argc, char* argv[])
+{
+    int retval;
+
+    /* parameter sanity checks. */
+    MODEL_ASSERT(PROP_VALID_COMMANDLINE_OPTS(opts));
+
+    /* we need an agent and at least one transaction. */
+    if (argc < 2)
+    {
+        fprintf(stderr, "Expecting submit agent txn-file [txn-file ...].\n");
+        retval = VCTOOL_ERROR_COMMANDLINE_MISSING_ARGUMENT;
+        goto done;
+    }
+
+    /* allocate memory for a submit_command structure. */
+    submit_command* submit = (submit_command*)malloc(sizeof(submit_command));
+    if (NULL == submit)
+    {
+        retval = VCTOOL_ERROR_GENERAL_OUT_OF_MEMORY;
+        goto done;
+    }
+
+    /* initialize the structure. */
+    retval = submit_command_init(submit);
+    if (VCTOOL_STATUS_SUCCESS != retval)
+    {
+        goto free_submit;
+    }
+
+    submit->agent_address = argv[0];
+    submit->txn_files = argv + 1;
+    submit->txn_count = (size_t)(argc - 1);
+
+    /* set submit command as the head of opts command. */
+    submit->hdr.next = opts->cmd;
+    opts->cmd = &submit->hdr;
+
+    /* success. */
+    retval = VCTOOL_STATUS_SUCCESS;
+    goto done;
+
+free_submit:
+    free(submit);
+
+done:
+    return retval;
+}
@@ -0,0 +1,344 @@
+/**
+ * \file command/submit/submit_command_func.c
+ *
+ * \brief Entry point for the submit command.
+ *
+ * \copyright 2020 Velo Payments.  See License.txt for license terms.
+ */
+
+#include <cbmc/model_assert.h>
+#include <fcntl.h>
+#include <inttypes.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <vctool/agent.h>
+#include <vctool/command/submit.h>
+#include <vctool/commandline.h>
+#include <vctool/journal.h>
+
+/**
+ * \brief State shared by the submission workers.
+ */
+typedef struct submit_state
+{
+    commandline_opts* opts;
+    submit_command* submit;
+    agent_pool* pool;
+    agent_limiter* limiter;
+    journal* journal;
+    size_t next;
+    size_t accepted;
+    size_t skipped;
+    size_t uncertain;
+    int status;
+} submit_state;
+
+/* forward decls. */
+static void* submit_worker(void* arg);
+static int submit_file(submit_state* state, const char* path);
+static void submit_sleep_ms(long ms);
+
+/**
+ * \brief Execute the submit command.
+ *
+ * Each file holds one transaction certificate.  Up to
+ * SUBMIT_COMMAND_MAX_WINDOW transactions are submitted at once, but an agent
+ * limiter decides how many are actually in flight, from the latency and
+ * busy answers it sees, so the submission rate follows what the agent can
+ * take.  A transaction the agent is too busy for is submitted again, after
+ * a growing delay.
+ *
+ * With a journal, each transaction is journaled by its certificate id when it
+ * is sent and again when it is accepted, and acknowledgements are committed
+ * before they are counted.  A restarted submit skips the transactions the
+ * journal holds as acknowledged and sends the rest, including those whose
+ * outcome was uncertain when it stopped.
+ *
+ * \param opts          The commandline opts for this operation.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS if every transaction was accepted.
+ *      - the error of a transaction which was not accepted.
+ *      - a non-zero error code on failure.
+ */
+int submit_command_func(commandline_opts* opts)
+{
+    int retval;
+    agent_pool pool;
+    agent_limiter limiter;
+    agent_limiter_metrics metrics;
+    journal txn_journal;
+    submit_state state;
+    pthread_t threads[SUBMIT_COMMAND_MAX_WINDOW];
+
+    /* parameter sanity checks. */
+    MODEL_ASSERT(PROP_VALID_COMMANDLINE_OPTS(opts));
+
+    /* get the submit command. */
+    submit_command* submit = (submit_command*)opts->cmd;
+    MODEL_ASSERT(NULL != submit);
+
+    /* a dropped connection is reported by the pool, not by a signal. */
+    signal(SIGPIPE, SIG_IGN);
+
+    /* one connection for every request the window can admit. */
+    retval =
+        agent_pool_init(
+            &pool, opts->file, submit->agent_address,
+            SUBMIT_COMMAND_MAX_WINDOW, NULL, NULL);
+    if (VCTOOL_STATUS_SUCCESS != retval)
+    {
+        fprintf(
+            stderr, "Could not connect to %s.\n", submit->agent_address);
+        goto done;
+    }
+    pool.recorder = opts->agent_recorder;
+
+    /* start with one request in flight, as an unknown agent may be slow. */
+    retval = agent_limiter_init(&limiter, 1, 1, SUBMIT_COMMAND_MAX_WINDOW);
+    if (VCTOOL_STATUS_SUCCESS != retval)
+    {
+        goto cleanup_pool;
+    }
+
+    state.opts = opts;
+    state.submit = submit;
+    state.pool = &pool;
+    state.limiter = &limiter;
+    state.journal = NULL;
+    state.next = 0;
+    state.accepted = 0;
+    state.skipped = 0;
+    state.uncertain = 0;
+    state.status = VCTOOL_STATUS_SUCCESS;
+
+    /* the journal is indexed once, so resuming doesn't depend on its size. */
+    if (NULL != opts->journal_path)
+    {
+        retval = journal_open(&txn_journal, opts->file, opts->journal_path);
+        if (VCTOOL_STATUS_SUCCESS != retval)
+        {
+            fprintf(
+                stderr, "Could not open journal %s.\n", opts->journal_path);
+            goto cleanup_limiter;
+        }
+
+        state.journal = &txn_journal;
+    }
+
+    /* the calling thread is the first worker. */
+    size_t started = 1;
+    for (; started < SUBMIT_COMMAND_MAX_WINDOW; ++started)
+    {
+        if (0 !=
+                pthread_create(&threads[started], NULL, &submit_worker, &state))
+        {
+            break;
+        }
+    }
+
+    submit_worker(&state);
+
+    for (size_t t = 1; t < started; ++t)
+    {
+        pthread_join(threads[t], NULL);
+    }
+
+    agent_limiter_metrics_get(&limiter, &metrics);
+
+    printf(
+        "Submitted %zu of %zu transactions.\n",
+        state.accepted - state.skipped, submit->txn_count);
+    printf(
+        "Window %zu; baseline latency %.3f ms; queue time mean %.3f ms, "
+        "max %.3f ms; %" PRIu64 " busy, %" PRIu64 " failed.\n",
+        metrics.window, metrics.baseline / 1e6,
+        metrics.queue_time_mean / 1e6, metrics.queue_time_max / 1e6,
+        metrics.busy, metrics.failed);
+
+    if (NULL != state.journal)
+    {
+        printf(
+            "Skipped %zu acknowledged and resent %zu uncertain transactions "
+            "from %s.\n", state.skipped, state.uncertain, opts->journal_path);
+
+        dispose((disposable_t*)&txn_journal);
+    }
+
+    /* report the error of a transaction which wasn't accepted. */
+    retval = state.status;
+
+cleanup_limiter:
+    dispose((disposable_t*)&limiter);
+
+cleanup_pool:
+    dispose((disposable_t*)&pool);
+
+done:
+    return retval;
+}
+
+/**
+ * \brief Submit transactions until none are left.
+ *
+ * \param arg           The shared submit state.
+ *
+ * \returns NULL.
+ */
+static void* submit_worker(void* arg)
+{
+    submit_state* state = (submit_state*)arg;
+
+    for (;;)
+    {
+        size_t i = __atomic_fetch_add(&state->next, 1, __ATOMIC_RELAXED);
+        if (i >= state->submit->txn_count)
+        {
+            break;
+        }
+
+        const char* path = state->submit->txn_files[i];
+        int retval = submit_file(state, path);
+        if (VCTOOL_STATUS_SUCCESS == retval)
+        {
+            __atomic_fetch_add(&state->accepted, 1, __ATOMIC_RELAXED);
+        }
+        else
+        {
+            fprintf(
+                stderr, "Could not submit %s (%x).\n", path,
+                (unsigned)retval);
+            __atomic_store_n(&state->status, retval, __ATOMIC_RELAXED);
+        }
+    }
+
+    return NULL;
+}
+
+/**
+ * \brief Submit the transaction in a file, again while the agent is busy.
+ *
+ * Resubmissions back off exponentially, with jitter, so workers turned away
+ * together don't all come back at the same moment.
+ *
+ * \param state         The shared submit state.
+ * \param path          The path of the transaction certificate.
+ *
+ * \returns a status code indicating success or failure.
+ */
+static int submit_file(submit_state* state, const char* path)
+{
+    int retval, fd;
+    file_stat_st st;
+    void* txn;
+    uint8_t txn_id[UUID_SIZE];
+    uint64_t sequence;
+    file* f = state->opts->file;
+
+    retval = file_stat(f, path, &st);
+    if (VCTOOL_STATUS_SUCCESS != retval)
+    {
+        return retval;
+    }
+
+    retval = file_open(f, &fd, path, O_RDONLY, 0);
+    if (VCTOOL_STATUS_SUCCESS != retval)
+    {
+        return retval;
+    }
+
+    retval = file_mmap(f, &txn, fd, (size_t)st.fst_size);
+    file_close(f, fd);
+    if (VCTOOL_STATUS_SUCCESS != retval)
+    {
+        return retval;
+    }
+
+    if (NULL != state->journal)
+    {
+        retval =
+            journal_transaction_id(
+                txn_id, (const uint8_t*)txn, (size_t)st.fst_size);
+        if (VCTOOL_STATUS_SUCCESS != retval)
+        {
+            goto cleanup_txn;
+        }
+
+        switch (journal_state(state->journal, txn_id))
+        {
+            case JOURNAL_ACKNOWLEDGED:
+                __atomic_fetch_add(&state->skipped, 1, __ATOMIC_RELAXED);
+                retval = VCTOOL_STATUS_SUCCESS;
+                goto cleanup_txn;
+
+            case JOURNAL_SUBMITTED:
+                __atomic_fetch_add(&state->uncertain, 1, __ATOMIC_RELAXED);
+                break;
+        }
+
+        /* the submission isn't committed: a transaction missing from the
+         * journal is sent again, just as an uncertain one is. */
+        retval =
+            journal_append(
+                state->journal, JOURNAL_SUBMITTED, txn_id, &sequence);
+        if (VCTOOL_STATUS_SUCCESS != retval)
+        {
+            goto cleanup_txn;
+        }
+    }
+
+    /* the limiter has already shrunk the window by the time a busy answer
+     * comes back, so the retry waits its turn behind the others. */
+    unsigned attempt = 0;
+    long delay = SUBMIT_COMMAND_RETRY_MIN_MS;
+    for (;;)
+    {
+        retval =
+            agent_submit(
+                state->pool, state->limiter, txn, (size_t)st.fst_size);
+        if (VCTOOL_ERROR_AGENT_BUSY != retval
+         || ++attempt >= SUBMIT_COMMAND_RETRIES)
+        {
+            break;
+        }
+
+        /* give the agent time to drain before trying again. */
+        submit_sleep_ms(delay / 2 + rand() % (delay / 2 + 1));
+        delay = (2 * delay > SUBMIT_COMMAND_RETRY_MAX_MS)
+            ? SUBMIT_COMMAND_RETRY_MAX_MS : 2 * delay;
+    }
+
+    /* acknowledgements from concurrent workers share one fsync. */
+    if (VCTOOL_STATUS_SUCCESS == retval && NULL != state->journal)
+    {
+        retval =
+            journal_append(
+                state->journal, JOURNAL_ACKNOWLEDGED, txn_id, &sequence);
+        if (VCTOOL_STATUS_SUCCESS == retval)
+        {
+            retval = journal_commit(state->journal, sequence);
+        }
+    }
+
+cleanup_txn:
+    file_munmap(f, txn, (size_t)st.fst_size);
+
+    return retval;
+}
+
+/**
+ * \brief Sleep for a number of milliseconds.
+ *
+ * \param ms            The number of milliseconds to sleep.
+ */
+static void submit_sleep_ms(long ms)
+{
+    struct timespec ts;
+
+    ts.tv_sec = ms / 1000;
+    ts.tv_nsec = (ms % 1000) * 1000000L;
+    nanosleep(&ts, NULL);
+}
@@ -0,0 +1,52 @@
+/**
+ * \file command/submit/submit_command_init.c
+ *
+ * \brief Initialize a submit command structure.
+ *
+ * \copyright 2020 Velo Payments.  See License.txt for license terms.
+ */
+
+#include <cbmc/model_assert.h>
+#include <string.h>
+#include <vctool/command/submit.h>
+#include <vctool/command/root.h>
+#include <vctool/status_codes.h>
+#include <vpr/parameters.h>
+
+/* forward decls. */
+static void submit_command_dispose(void* disp);
+
+/**
+ * \brief Initialize a submit command structure.
+ *
+ * \param submit        The submit command structure to initialize.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - a non-zero error code on failure.
+ */
+int submit_command_init(submit_command* submit)
+{
+    /* parameter sanity checks. */
+    MODEL_ASSERT(NULL != submit);
+
+    /* clear submit command structure. */
+    memset(submit, 0, sizeof(submit_command));
+
+    /* set disposer, func, etc. */
+    submit->hdr.hdr.dispose = &submit_command_dispose;
+    submit->hdr.func = &submit_command_func;
+
+    /* success. */
+    return VCTOOL_STATUS_SUCCESS;
+}
+
+/**
+ * \brief Dispose of a submit_command structure.
+ *
+ * \param disp          The submit_command structure to dispose.
+ */
+static void submit_command_dispose(void* UNUSED(disp))
+{
+    /* do nothing. */
+}
@@ -0,0 +1,75 @@
+/**
+ * \file command/to_json/process_to_json_command.c
+ *
+ * \brief Process command-line options to build a to-json command.
+ *
+ * \copyright 2020 Velo Payments.  See License.txt for license terms.
+ */
+
+#include <cbmc/model_assert.h>
+#include <stdio.h>
+#include <string.h>
+#include <vctool/command/root.h>
+#include <vctool/command/to_json.h>
+#include <vctool/commandline.h>
+#include <vctool/status_codes.h>
+
+/**
+ * \brief Process the to-json command.
+ *
+ * \param opts          The command-line option structure.
+ * \param argc          The argument count.
+ * \param argv          The argument vector.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - a non-zero error code on failure.
+ */
+int process_to_json_command(commandline_opts* opts, int argc, char* argv[])
+{
+    int retval;
+
+    /* parameter sanity checks. */
+    MODEL_ASSERT(PROP_VALID_COMMANDLINE_OPTS(opts));
+
+    /* we need at least one certificate. */
+    if (argc < 1)
+    {
+        fprintf(stderr, "Expecting to-json cert-file [cert-file ...].\n");
+        retval = VCTOOL_ERROR_COMMANDLINE_MISSING_ARGUMENT;
+        goto done;
+    }
+
+    /* allocate memory for a to_json_command structure. */
+    to_json_command* to_json =
+        (to_json_command*)malloc(sizeof(to_json_command));
+    if (NULL == to_json)
+    {
+        retval = VCTOOL_ERROR_GENERAL_OUT_OF_MEMORY;
+        goto done;
+    }
+
+    /* initialize the structure. */
+    retval = to_json_command_init(to_json);
+    if (VCTOOL_STATUS_SUCCESS != retval)
+    {
+        goto free_to_json;
+    }
+
+    to_json->cert_files = argv;
+    to_json->cert_count = (size_t)argc;
+
+    /* set to_json command as the head of opts command. */
+    to_json->hdr.next = opts->cmd;
+    opts->cmd = &to_json->hdr;
+
+    /* success. */
+    retval = VCTOOL_STATUS_SUCCESS;
+    goto done;
+
+free_to_json:
+    free(to_json);
+
+done:
+    return retval;
+}
@@ -0,0 +1,241 @@
+/**
+ * \file command/to_json/to_json_command_func.c
+ *
+ * \brief Entry point for the to-json command.
+ *
+ * \copyright 2020 Velo Payments.  See License.txt for license terms.
+ */
+
+#include <cbmc/model_assert.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <vctool/certjson.h>
+#include <vctool/certstream.h>
+#include <vctool/command/to_json.h>
+#include <vctool/commandline.h>
+#include <vpr/parameters.h>
+
+/**
+ * \brief The state of a certificate being written as JSON.
+ */
+typedef struct to_json_context
+{
+    certjson_writer* w;
+    bool first;
+} to_json_context;
+
+/* forward decls. */
+static int to_json_convert(
+    file* f, const char* path, certstream* stream, certjson_writer* w);
+static int to_json_parse(
+    file* f, const char* path, certstream* stream, certstream_field_fn fn,
+    void* context);
+static int to_json_check_field(void* context, const certstream_field* field);
+static int to_json_write_field(void* context, const certstream_field* field);
+
+/**
+ * \brief Execute the to-json command.
+ *
+ * Each certificate file is written to standard output as a line of JSON, in
+ * the order given.  Certificates are parsed in chunks with one certstream,
+ * so that a block of any size is converted in fixed memory, and the JSON
+ * text goes through one writer.
+ *
+ * \param opts          The commandline opts for this operation.
+ *
+ * \returns a status code indicating success or failure.
+ *      - a non-zero error code on failure.
+ */
+int to_json_command_func(commandline_opts* opts)
+{
+    int retval, flush_retval;
+
+    /* parameter sanity checks. */
+    MODEL_ASSERT(PROP_VALID_COMMANDLINE_OPTS(opts));
+
+    /* get the to-json command. */
+    to_json_command* to_json = (to_json_command*)opts->cmd;
+    MODEL_ASSERT(NULL != to_json);
+
+    /* the writer and stream are too large for the stack. */
+    certjson_writer* w = (certjson_writer*)malloc(sizeof(certjson_writer));
+    if (NULL == w)
+    {
+        retval = VCTOOL_ERROR_GENERAL_OUT_OF_MEMORY;
+        goto done;
+    }
+
+    certstream* stream = (certstream*)malloc(sizeof(certstream));
+    if (NULL == stream)
+    {
+        retval = VCTOOL_ERROR_GENERAL_OUT_OF_MEMORY;
+        goto free_writer;
+    }
+
+    certjson_writer_init(w, opts->file, STDOUT_FILENO);
+
+    for (size_t i = 0; i < to_json->cert_count; ++i)
+    {
+        retval =
+            to_json_convert(opts->file, to_json->cert_files[i], stream, w);
+        if (VCTOOL_STATUS_SUCCESS != retval)
+        {
+            goto cleanup_writer;
+        }
+    }
+
+    retval = VCTOOL_STATUS_SUCCESS;
+
+cleanup_writer:
+    /* what was converted is written even if a later certificate failed. */
+    flush_retval = certjson_writer_flush(w);
+    if (VCTOOL_STATUS_SUCCESS != flush_retval)
+    {
+        fprintf(stderr, "Could not write JSON.\n");
+        if (VCTOOL_STATUS_SUCCESS == retval)
+        {
+            retval = flush_retval;
+        }
+    }
+
+    free(stream);
+
+free_writer:
+    free(w);
+
+done:
+    return retval;
+}
+
+/**
+ * \brief Write a certificate file as a line of JSON.
+ *
+ * The file is parsed twice: once to check that every field is whole, so that
+ * a bad certificate writes nothing, and once to write its fields.  Errors
+ * are reported on standard error.
+ *
+ * \param f             The file abstraction layer.
+ * \param path          The path of the certificate file.
+ * \param stream        The stream used to parse the file.
+ * \param w             The writer.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - VCTOOL_ERROR_CERTSTREAM_TRUNCATED if the file ended inside a field.
+ *      - VCTOOL_ERROR_CERTSTREAM_BAD_TRANSACTION if a wrapped transaction is
+ *        malformed.
+ *      - a non-zero error code returned by the file layer.
+ */
+static int to_json_convert(
+    file* f, const char* path, certstream* stream, certjson_writer* w)
+{
+    int retval;
+    to_json_context context = { w, true };
+
+    retval = to_json_parse(f, path, stream, &to_json_check_field, NULL);
+    if (VCTOOL_ERROR_CERTSTREAM_TRUNCATED == retval
+     || VCTOOL_ERROR_CERTSTREAM_BAD_TRANSACTION == retval)
+    {
+        fprintf(stderr, "Bad certificate %s.\n", path);
+        return retval;
+    }
+    else if (VCTOOL_STATUS_SUCCESS != retval)
+    {
+        fprintf(stderr, "Could not read %s.\n", path);
+        return retval;
+    }
+
+    retval = certjson_write_begin(w);
+    if (VCTOOL_STATUS_SUCCESS == retval)
+    {
+        retval =
+            to_json_parse(f, path, stream, &to_json_write_field, &context);
+    }
+    if (VCTOOL_STATUS_SUCCESS == retval)
+    {
+        retval = certjson_write_end(w);
+    }
+
+    if (VCTOOL_STATUS_SUCCESS != retval)
+    {
+        fprintf(stderr, "Could not write JSON.\n");
+    }
+
+    return retval;
+}
+
+/**
+ * \brief Parse a certificate file with a stream.
+ *
+ * \param f             The file abstraction layer.
+ * \param path          The path of the certificate file.
+ * \param stream        The stream used to parse the file.
+ * \param fn            The callback which receives each field.
+ * \param context       The user context for the callback.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - a non-zero error code returned by certstream_read or the file layer.
+ */
+static int to_json_parse(
+    file* f, const char* path, certstream* stream, certstream_field_fn fn,
+    void* context)
+{
+    int retval, fd;
+
+    retval = file_open(f, &fd, path, O_RDONLY, 0);
+    if (VCTOOL_STATUS_SUCCESS != retval)
+    {
+        return retval;
+    }
+
+    certstream_init(stream, fn, context);
+    retval = certstream_read(stream, f, fd);
+
+    file_close(f, fd);
+
+    return retval;
+}
+
+/**
+ * \brief Accept a field, so that certstream only checks the framing.
+ *
+ * \returns VCTOOL_STATUS_SUCCESS.
+ */
+static int to_json_check_field(
+    void* UNUSED(context), const certstream_field* UNUSED(field))
+{
+    return VCTOOL_STATUS_SUCCESS;
+}
+
+/**
+ * \brief Write a field of the certificate as a JSON member.
+ *
+ * The fields of a wrapped transaction are written as part of its value, so
+ * only the fields of the certificate itself are written.
+ *
+ * \param context       The to_json_context.
+ * \param field         The field.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - a non-zero error code returned by the file layer.
+ */
+static int to_json_write_field(void* context, const certstream_field* field)
+{
+    to_json_context* ctx = (to_json_context*)context;
+
+    if (0 != field->depth)
+    {
+        return VCTOOL_STATUS_SUCCESS;
+    }
+
+    int retval =
+        certjson_write_field(
+            ctx->w, ctx->first, field->type, field->value, field->size);
+    ctx->first = false;
+
+    return retval;
+}
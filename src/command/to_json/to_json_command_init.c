@@ -0,0 +1,52 @@
+/**
+ * \file command/to_json/to_json_command_init.c
+ *
+ * \brief Initialize a to-json command structure.
+ *
+ * \copyright 2020 Velo Payments.  See License.txt for license terms.
+ */
+
+#include <cbmc/model_assert.h>
+#include <string.h>
+#include <vctool/command/root.h>
+#include <vctool/command/to_json.h>
+#include <vctool/status_codes.h>
+#include <vpr/parameters.h>
+
+/* forward decls. */
+static void to_json_command_dispose(void* disp);
+
+/**
+ * \brief Initialize a to-json command structure.
+ *
+ * \param to_json       The to-json command structure to initialize.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - a non-zero error code on failure.
+ */
+int to_json_command_init(to_json_command* to_json)
+{
+    /* parameter sanity checks. */
+    MODEL_ASSERT(NULL != to_json);
+
+    /* clear to_json command structure. */
+    memset(to_json, 0, sizeof(to_json_command));
+
+    /* set disposer, func, etc. */
+    to_json->hdr.hdr.dispose = &to_json_command_dispose;
+    to_json->hdr.func = &to_json_command_func;
+
+    /* success. */
+    return VCTOOL_STATUS_SUCCESS;
+}
+
+/**
+ * \brief Dispose of a to_json_command structure.
+ *
+ * \param disp          The to_json_command structure to dispose.
+ */
+static void to_json_command_dispose(void* UNUSED(disp))
+{
+    /* do nothing. */
+}
@@ -0,0 +1,78 @@
+/**
+ * \file command/txn_status/process_txn_status_command.c
+ *
+ * \brief Process command-line options to build a txn-status command.
+ *
+ * \copyright 2020 Velo Payments.  See License.txt for license terms.
+ */
+
+#include <cbmc/model_assert.h>
+#include <stdio.h>
+#include <string.h>
+#include <vctool/command/txn_status.h>
+#include <vctool/command/root.h>
+#include <vctool/commandline.h>
+#include <vctool/status_codes.h>
+
+/**
+ * \brief Process the txn-status command.
+ *
+ * \param opts          The command-line option structure.
+ * \param argc          The argument count.
+ * \param argv          The argument vector.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - a non-zero error code on failure.
+ */
+int process_txn_status_command(commandline_opts* opts, int argc, char* argv[])
+{
+    int retval;
+
+    /* parameter sanity checks. */
+    MODEL_ASSERT(PROP_VALID_COMMANDLINE_OPTS(opts));
+
+    /* we need an agent and a file of transaction ids; a segment is
+     * optional. */
+    if (argc < 2 || argc > 3)
+    {
+        fprintf(
+            stderr, "Expecting txn-status agent txn-id-file [segment].\n");
+        retval = VCTOOL_ERROR_COMMANDLINE_MISSING_ARGUMENT;
+        goto done;
+    }
+
+    /* allocate memory for a txn_status_command structure. */
+    txn_status_command* txn_status =
+        (txn_status_command*)malloc(sizeof(txn_status_command));
+    if (NULL == txn_status)
+    {
+        retval = VCTOOL_ERROR_GENERAL_OUT_OF_MEMORY;
+        goto done;
+    }
+
+    /* initialize the structure. */
+    retval = txn_status_command_init(txn_status);
+    if (VCTOOL_STATUS_SUCCESS != retval)
+    {
+        goto free_txn_status;
+    }
+
+    txn_status->agent_address = argv[0];
+    txn_status->txn_id_file = argv[1];
+    txn_status->segment = (3 == argc) ? argv[2] : NULL;
+
+    /* set txn_status command as the head of opts command. */
+    txn_status->hdr.next = opts->cmd;
+    opts->cmd = &txn_status->hdr;
+
+    /* success. */
+    retval = VCTOOL_STATUS_SUCCESS;
+    goto done;
+
+free_txn_status:
+    free(txn_status);
+
+done:
+    return retval;
+}
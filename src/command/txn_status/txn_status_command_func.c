@@ -0,0 +1,652 @@
+/**
+ * \file command/txn_status/txn_status_command_func.c
+ *
+ * \brief Entry point for the txn-status command.
+ *
+ * \copyright 2020 Velo Payments.  See License.txt for license terms.
+ */
+
+#include <cbmc/model_assert.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <vccert/fields.h>
+#include <vctool/agent.h>
+#include <vctool/certificate.h>
+#include <vctool/command/root.h>
+#include <vctool/command/txn_status.h>
+#include <vctool/commandline.h>
+#include <vctool/query.h>
+#include <vctool/uuid.h>
+
+/* the size of the output buffer. */
+#define TXN_STATUS_OUTPUT_BUFFER_SIZE                   (1024 * 1024)
+
+/**
+ * \brief Totals over the reported transactions.
+ */
+typedef struct txn_status_totals
+{
+    size_t canonized;
+    size_t pending;
+    size_t unknown;
+    size_t local;
+} txn_status_totals;
+
+/**
+ * \brief The agent session, resumed from the session file of the keypair.
+ *
+ * The keypair is only read if the full key agreement runs.
+ */
+typedef struct txn_status_session
+{
+    commandline_opts* opts;
+    const char* key_filename;
+    bool keys_loaded;
+    agent_key_agreement keys;
+    vccrypt_buffer_t private_key;
+    agent_session_cache cache;
+    agent_session_resumer resumer;
+    char* path;
+} txn_status_session;
+
+/* forward decls. */
+static int txn_status_session_init(
+    commandline_opts* opts, txn_status_session* session,
+    const char* key_filename, const char* address);
+static void txn_status_session_dispose(txn_status_session* session);
+static int txn_status_key_agree(
+    void* context, file* f, int sock, agent_session* session);
+static int txn_status_load_keys(txn_status_session* session);
+static int txn_status_find_field(
+    const vccrypt_buffer_t* cert, uint16_t type, const uint8_t** value,
+    size_t* size);
+static int txn_status_read_ids(
+    file* f, const char* path, uint8_t** ids, size_t* count);
+static int txn_status_agent_result(
+    void* context, const uint8_t* txn_ids, const uint32_t* states,
+    size_t count);
+static void txn_status_print(
+    txn_status_totals* totals, const uint8_t* txn_id, uint32_t state,
+    const char* source);
+
+/**
+ * \brief Execute the txn-status command.
+ *
+ * The transaction id file holds one uuid per line.  Transactions found in
+ * the segment, if one is given, are canonized and are answered locally; the
+ * rest are queried from the agent in pipelined batches over one connection.
+ * A JSON object is written to standard output for each transaction as soon
+ * as its state is known, one per line:
+ *
+ *      {"txn_id":"...","status":"canonized","source":"local"}
+ *
+ * The status is canonized, pending or unknown, and the source is local or
+ * agent.  Local answers come first, so the output is not in file order.
+ *
+ * Given a keypair (-k) and the agent's public entity as the one trusted
+ * entity, the connection runs the key agreement with the agent.  Sessions
+ * are saved next to the keypair, in keypair.cert.sessions, sealed under the
+ * key in keypair.cert.sessions.key, and a later run resumes the saved
+ * session instead of agreeing on a new key.  Resuming costs a MAC: the
+ * keypair is only read, and its passphrase asked for, when a new key is
+ * agreed.
+ *
+ * \param opts          The commandline opts for this operation.
+ *
+ * \returns a status code indicating success or failure.
+ *      - a non-zero error code on failure.
+ */
+int txn_status_command_func(commandline_opts* opts)
+{
+    int retval, sock;
+    uint8_t* ids;
+    size_t count;
+    query_index index;
+    txn_status_totals totals;
+    txn_status_session session;
+
+    /* parameter sanity checks. */
+    MODEL_ASSERT(PROP_VALID_COMMANDLINE_OPTS(opts));
+
+    /* get the txn-status command. */
+    txn_status_command* txn_status = (txn_status_command*)opts->cmd;
+    MODEL_ASSERT(NULL != txn_status);
+    root_command* root = (root_command*)txn_status->hdr.next;
+    MODEL_ASSERT(NULL != root);
+
+    /* a dropped agent is reported by a write, not by a signal. */
+    signal(SIGPIPE, SIG_IGN);
+
+    memset(&totals, 0, sizeof(totals));
+
+    retval =
+        txn_status_read_ids(opts->file, txn_status->txn_id_file, &ids, &count);
+    if (VCTOOL_STATUS_SUCCESS != retval)
+    {
+        goto done;
+    }
+
+    /* results are written a line at a time, so buffer them in bulk. */
+    setvbuf(stdout, NULL, _IOFBF, TXN_STATUS_OUTPUT_BUFFER_SIZE);
+
+    /* answer what the segment holds, keeping the rest for the agent. */
+    size_t remaining = count;
+    if (NULL != txn_status->segment)
+    {
+        retval = query_index_init(&index, opts->file, txn_status->segment);
+        if (VCTOOL_STATUS_SUCCESS != retval)
+        {
+            fprintf(stderr, "Could not index %s.\n", txn_status->segment);
+            goto cleanup_ids;
+        }
+
+        /* compact the unanswered ids in place. */
+        remaining = 0;
+        for (size_t i = 0; i < count; ++i)
+        {
+            uint8_t* id = ids + i * UUID_SIZE;
+            if (NULL != query_index_find_transaction(&index, id))
+            {
+                txn_status_print(&totals, id, AGENT_TXN_CANONIZED, "local");
+                ++totals.local;
+            }
+            else
+            {
+                memmove(ids + remaining++ * UUID_SIZE, id, UUID_SIZE);
+            }
+        }
+
+        dispose((disposable_t*)&index);
+    }
+
+    /* ask the agent about the rest. */
+    if (remaining > 0)
+    {
+        retval = agent_connect(&sock, txn_status->agent_address);
+        if (VCTOOL_STATUS_SUCCESS != retval)
+        {
+            fprintf(
+                stderr, "Could not connect to %s.\n",
+                txn_status->agent_address);
+            goto cleanup_ids;
+        }
+
+        /* resume the saved session, or agree on a new one. */
+        if (NULL != root->key_filename
+         && NULL != opts->entities && NULL == opts->entities->next)
+        {
+            retval =
+                txn_status_session_init(
+                    opts, &session, root->key_filename,
+                    txn_status->agent_address);
+            if (VCTOOL_STATUS_SUCCESS != retval)
+            {
+                close(sock);
+                goto cleanup_ids;
+            }
+
+            retval =
+                agent_session_handshake(&session.resumer, opts->file, sock);
+            txn_status_session_dispose(&session);
+            if (VCTOOL_STATUS_SUCCESS != retval)
+            {
+                fprintf(
+                    stderr, "Handshake with %s failed (%x).\n",
+                    txn_status->agent_address, (unsigned)retval);
+                close(sock);
+                goto cleanup_ids;
+            }
+        }
+
+        retval =
+            agent_txn_status(
+                opts->file, sock, ids, remaining, &txn_status_agent_result,
+                &totals, opts->agent_recorder);
+        close(sock);
+        if (VCTOOL_STATUS_SUCCESS != retval)
+        {
+            fprintf(
+                stderr, "Status query failed (%x).\n", (unsigned)retval);
+            goto cleanup_ids;
+        }
+    }
+
+    fprintf(
+        stderr, "%zu canonized, %zu pending, %zu unknown; %zu answered "
+        "locally.\n", totals.canonized, totals.pending, totals.unknown,
+        totals.local);
+
+    retval = VCTOOL_STATUS_SUCCESS;
+
+cleanup_ids:
+    fflush(stdout);
+    free(ids);
+
+done:
+    return retval;
+}
+
+/**
+ * \brief Set up the session resumer for an agent.
+ *
+ * The sessions come from the session file of the keypair, and the agent's
+ * public key from the one trusted entity.
+ *
+ * \param opts          The commandline opts for this operation.
+ * \param session       The session state to initialize.
+ * \param key_filename  The keypair certificate.
+ * \param address       The agent address.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - VCTOOL_ERROR_GENERAL_OUT_OF_MEMORY if an allocation failed.
+ *      - a non-zero error code on failure.
+ */
+static int txn_status_session_init(
+    commandline_opts* opts, txn_status_session* session,
+    const char* key_filename, const char* address)
+{
+    int retval;
+
+    memset(session, 0, sizeof(txn_status_session));
+    session->opts = opts;
+    session->key_filename = key_filename;
+
+    size_t path_length =
+        strlen(key_filename)
+      + 9 /* .sessions */
+      + 1;/* asciiz */
+
+    session->path = (char*)malloc(path_length);
+    if (NULL == session->path)
+    {
+        retval = VCTOOL_ERROR_GENERAL_OUT_OF_MEMORY;
+        goto done;
+    }
+
+    snprintf(session->path, path_length, "%s.sessions", key_filename);
+
+    retval =
+        agent_session_cache_init(
+            &session->cache, opts->file, opts->suite, session->path);
+    if (VCTOOL_STATUS_SUCCESS != retval)
+    {
+        fprintf(stderr, "Could not create the session cache.\n");
+        goto free_path;
+    }
+
+    session->keys.suite = opts->suite;
+    session->keys.client_private_key = &session->private_key;
+    session->keys.agent_public_key = &opts->entities->encryption_pubkey;
+
+    session->resumer.cache = &session->cache;
+    session->resumer.address = address;
+    session->resumer.suite = opts->suite;
+    session->resumer.key_agreement = &txn_status_key_agree;
+    session->resumer.key_agreement_context = session;
+
+    /* success. */
+    return VCTOOL_STATUS_SUCCESS;
+
+free_path:
+    free(session->path);
+
+done:
+    memset(session, 0, sizeof(txn_status_session));
+
+    return retval;
+}
+
+/**
+ * \brief Save the sessions and wipe the keys.
+ *
+ * \param session       The session state to dispose.
+ */
+static void txn_status_session_dispose(txn_status_session* session)
+{
+    if (VCTOOL_STATUS_SUCCESS != agent_session_cache_save(&session->cache))
+    {
+        fprintf(stderr, "Could not save %s.\n", session->path);
+    }
+
+    dispose((disposable_t*)&session->cache);
+    if (session->keys_loaded)
+    {
+        dispose((disposable_t*)&session->private_key);
+    }
+
+    free(session->path);
+    memset(session, 0, sizeof(txn_status_session));
+}
+
+/**
+ * \brief Run the full key agreement, reading the keypair first.
+ *
+ * This is the agent_key_agreement_fn of the session resumer, so the keypair
+ * is read only when no saved session can be resumed.
+ *
+ * \param context       The txn_status_session.
+ * \param f             The file abstraction layer.
+ * \param sock          The connection.
+ * \param session       The session to fill in.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - a non-zero error code from reading the keypair or from the key
+ *        agreement.
+ */
+static int txn_status_key_agree(
+    void* context, file* f, int sock, agent_session* session)
+{
+    int retval;
+    txn_status_session* state = (txn_status_session*)context;
+
+    if (!state->keys_loaded)
+    {
+        retval = txn_status_load_keys(state);
+        if (VCTOOL_STATUS_SUCCESS != retval)
+        {
+            return retval;
+        }
+    }
+
+    return agent_key_agree(&state->keys, f, sock, session);
+}
+
+/**
+ * \brief Read the entity id and the private encryption key of the keypair.
+ *
+ * \param session       The session state, whose client id and private key
+ *                      are set.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - a non-zero error code returned by certificate_keypair_load, or on
+ *        failure.
+ */
+static int txn_status_load_keys(txn_status_session* session)
+{
+    int retval;
+    vccrypt_buffer_t* keypair;
+    const uint8_t* value;
+    size_t value_size;
+    commandline_opts* opts = session->opts;
+
+    retval = certificate_keypair_load(opts, &keypair, session->key_filename);
+    if (VCTOOL_STATUS_SUCCESS != retval)
+    {
+        goto done;
+    }
+
+    /* get the entity id; the schema fixed its size. */
+    retval =
+        txn_status_find_field(
+            keypair, VCCERT_FIELD_TYPE_ARTIFACT_ID, &value, &value_size);
+    if (VCTOOL_STATUS_SUCCESS != retval)
+    {
+        goto cleanup_keypair;
+    }
+
+    memcpy(session->keys.client_id, value, AGENT_ENTITY_ID_SIZE);
+
+    /* get the private encryption key. */
+    retval =
+        txn_status_find_field(
+            keypair, VCCERT_FIELD_TYPE_PRIVATE_ENCRYPTION_KEY, &value,
+            &value_size);
+    if (VCTOOL_STATUS_SUCCESS != retval)
+    {
+        goto cleanup_keypair;
+    }
+
+    retval =
+        vccrypt_suite_buffer_init_for_cipher_key_agreement_private_key(
+            opts->suite, &session->private_key);
+    if (VCCRYPT_STATUS_SUCCESS != retval)
+    {
+        goto cleanup_keypair;
+    }
+
+    if (session->private_key.size != value_size)
+    {
+        retval = VCTOOL_ERROR_CERTSCHEMA_BAD_FIELD_SIZE;
+        dispose((disposable_t*)&session->private_key);
+        goto cleanup_keypair;
+    }
+
+    memcpy(session->private_key.data, value, value_size);
+    session->keys_loaded = true;
+
+    /* success. */
+    retval = VCTOOL_STATUS_SUCCESS;
+
+cleanup_keypair:
+    dispose((disposable_t*)keypair);
+    free(keypair);
+
+done:
+    return retval;
+}
+
+/**
+ * \brief Find a field of a validated certificate.
+ *
+ * \param cert          The certificate.
+ * \param type          The field type.
+ * \param value         Set to the value of the field.
+ * \param size          Set to the size of the value.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - VCTOOL_ERROR_CERTSCHEMA_MISSING_FIELD if there is no such field.
+ */
+static int txn_status_find_field(
+    const vccrypt_buffer_t* cert, uint16_t type, const uint8_t** value,
+    size_t* size)
+{
+    const uint8_t* data = (const uint8_t*)cert->data;
+
+    for (size_t pos = 0; pos + 4 <= cert->size;)
+    {
+        uint16_t field_type = (uint16_t)((data[pos] << 8) | data[pos + 1]);
+        size_t field_size = ((size_t)data[pos + 2] << 8) | data[pos + 3];
+        pos += 4;
+
+        if (type == field_type)
+        {
+            *value = data + pos;
+            *size = field_size;
+            return VCTOOL_STATUS_SUCCESS;
+        }
+
+        pos += field_size;
+    }
+
+    return VCTOOL_ERROR_CERTSCHEMA_MISSING_FIELD;
+}
+
+/**
+ * \brief Read a file of transaction ids, one uuid per line.
+ *
+ * Blank lines are skipped.
+ *
+ * \param f             The file abstraction layer.
+ * \param path          The path of the file.
+ * \param ids           Set to an array of UUID_SIZE byte ids, which the
+ *                      caller frees.
+ * \param count         Set to the number of ids.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - VCTOOL_ERROR_UUID_INVALID_STRING if a line is not a uuid.
+ *      - VCTOOL_ERROR_GENERAL_OUT_OF_MEMORY if an allocation failed.
+ *      - a non-zero error code returned by the file layer.
+ */
+static int txn_status_read_ids(
+    file* f, const char* path, uint8_t** ids, size_t* count)
+{
+    int retval, fd;
+    file_stat_st fst;
+    void* map;
+    char line[UUID_STRING_SIZE + 1];
+
+    retval = file_stat(f, path, &fst);
+    if (VCTOOL_STATUS_SUCCESS != retval)
+    {
+        fprintf(stderr, "Could not read %s.\n", path);
+        return retval;
+    }
+
+    size_t size = (size_t)fst.fst_size;
+
+    /* each id takes at least a bare 32 digit uuid and its newline. */
+    *count = 0;
+    *ids = (uint8_t*)malloc((size / 33 + 1) * UUID_SIZE);
+    if (NULL == *ids)
+    {
+        return VCTOOL_ERROR_GENERAL_OUT_OF_MEMORY;
+    }
+
+    if (0 == size)
+    {
+        return VCTOOL_STATUS_SUCCESS;
+    }
+
+    retval = file_open(f, &fd, path, O_RDONLY, 0);
+    if (VCTOOL_STATUS_SUCCESS != retval)
+    {
+        fprintf(stderr, "Could not read %s.\n", path);
+        goto cleanup_ids;
+    }
+
+    retval = file_mmap(f, &map, fd, size);
+    file_close(f, fd);
+    if (VCTOOL_STATUS_SUCCESS != retval)
+    {
+        goto cleanup_ids;
+    }
+
+    const char* text = (const char*)map;
+    size_t line_number = 0;
+    for (size_t offset = 0; offset < size;)
+    {
+        const char* start = text + offset;
+        const char* end = (const char*)memchr(start, '\n', size - offset);
+        size_t length = (NULL == end) ? size - offset : (size_t)(end - start);
+        offset += length + 1;
+        ++line_number;
+
+        /* tolerate CRLF line endings. */
+        if (length > 0 && '\r' == start[length - 1])
+        {
+            --length;
+        }
+
+        if (0 == length)
+        {
+            continue;
+        }
+
+        if (length >= sizeof(line))
+        {
+            retval = VCTOOL_ERROR_UUID_INVALID_STRING;
+        }
+        else
+        {
+            memcpy(line, start, length);
+            line[length] = 0;
+            retval = uuid_from_string(*ids + *count * UUID_SIZE, line);
+        }
+
+        if (VCTOOL_STATUS_SUCCESS != retval)
+        {
+            fprintf(
+                stderr, "Bad transaction id on line %zu of %s.\n",
+                line_number, path);
+            goto cleanup_map;
+        }
+
+        ++*count;
+    }
+
+    retval = VCTOOL_STATUS_SUCCESS;
+
+cleanup_map:
+    file_munmap(f, map, size);
+
+cleanup_ids:
+    if (VCTOOL_STATUS_SUCCESS != retval)
+    {
+        free(*ids);
+        *ids = NULL;
+    }
+
+    return retval;
+}
+
+/**
+ * \brief Report a batch of states from the agent.
+ *
+ * \param context       The totals.
+ * \param txn_ids       The transaction ids in this batch.
+ * \param states        The state of each transaction.
+ * \param count         The number of transactions in this batch.
+ *
+ * \returns VCTOOL_STATUS_SUCCESS.
+ */
+static int txn_status_agent_result(
+    void* context, const uint8_t* txn_ids, const uint32_t* states,
+    size_t count)
+{
+    txn_status_totals* totals = (txn_status_totals*)context;
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        txn_status_print(totals, txn_ids + i * UUID_SIZE, states[i], "agent");
+    }
+
+    return VCTOOL_STATUS_SUCCESS;
+}
+
+/**
+ * \brief Write the state of a transaction as a line of JSON.
+ *
+ * \param totals        The totals to update.
+ * \param txn_id        The transaction id.
+ * \param state         The AGENT_TXN_* state.
+ * \param source        Where the state came from.
+ */
+static void txn_status_print(
+    txn_status_totals* totals, const uint8_t* txn_id, uint32_t state,
+    const char* source)
+{
+    char id[UUID_STRING_SIZE];
+    const char* status;
+
+    switch (state)
+    {
+        case AGENT_TXN_CANONIZED:
+            status = "canonized";
+            ++totals->canonized;
+            break;
+
+        case AGENT_TXN_PENDING:
+            status = "pending";
+            ++totals->pending;
+            break;
+
+        default:
+            status = "unknown";
+            ++totals->unknown;
+            break;
+    }
+
+    uuid_to_string(id, txn_id);
+    printf(
+        "{\"txn_id\":\"%s\",\"status\":\"%s\",\"source\":\"%s\"}\n", id,
+        status, source);
+}
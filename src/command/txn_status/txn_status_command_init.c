@@ -0,0 +1,52 @@
+/**
+ * \file command/txn_status/txn_status_command_init.c
+ *
+ * \brief Initialize a txn-status command structure.
+ *
+ * \copyright 2020 Velo Payments.  See License.txt for license terms.
+ */
+
+#include <cbmc/model_assert.h>
+#include <string.h>
+#include <vctool/command/txn_status.h>
+#include <vctool/command/root.h>
+#include <vctool/status_codes.h>
+#include <vpr/parameters.h>
+
+/* forward decls. */
+static void txn_status_command_dispose(void* disp);
+
+/**
+ * \brief Initialize a txn-status command structure.
+ *
+ * \param txn_status    The txn-status command structure to initialize.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - a non-zero error code on failure.
+ */
+int txn_status_command_init(txn_status_command* txn_status)
+{
+    /* parameter sanity checks. */
+    MODEL_ASSERT(NULL != txn_status);
+
+    /* clear txn_status command structure. */
+    memset(txn_status, 0, sizeof(txn_status_command));
+
+    /* set disposer, func, etc. */
+    txn_status->hdr.hdr.dispose = &txn_status_command_dispose;
+    txn_status->hdr.func = &txn_status_command_func;
+
+    /* success. */
+    return VCTOOL_STATUS_SUCCESS;
+}
+
+/**
+ * \brief Dispose of a txn_status_command structure.
+ *
+ * \param disp          The txn_status_command structure to dispose.
+ */
+static void txn_status_command_dispose(void* UNUSED(disp))
+{
+    /* do nothing. */
+}
@@ -0,0 +1,68 @@
+/**
+ * \file command/validate/process_validate_command.c
+ *
+ * \brief Process command-line options to build a validate command.
+ *
+ * \copyright 2020 Velo Payments.  See License.txt for license terms.
+ */
+
+#include <cbmc/model_assert.h>
+#include <stdio.h>
+#include <string.h>
+#include <vctool/command/root.h>
+#include <vctool/command/validate.h>
+#include <vctool/commandline.h>
+#include <vctool/status_codes.h>
+
+/**
+ * \brief Process the validate command.
+ *
+ * \param opts          The command-line option structure.
+ * \param argc          The argument count.
+ * \param argv          The argument vector.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - a non-zero error code on failure.
+ */
+int process_validate_command(commandline_opts* opts, int argc, char* argv[])
+{
+    int retval;
+
+    /* parameter sanity checks. */
+    MODEL_ASSERT(PROP_VALID_COMMANDLINE_OPTS(opts));
+
+    /* allocate memory for a validate_command structure. */
+    validate_command* validate =
+        (validate_command*)malloc(sizeof(validate_command));
+    if (NULL == validate)
+    {
+        retval = VCTOOL_ERROR_GENERAL_OUT_OF_MEMORY;
+        goto done;
+    }
+
+    /* initialize the structure. */
+    retval = validate_command_init(validate);
+    if (VCTOOL_STATUS_SUCCESS != retval)
+    {
+        goto free_validate;
+    }
+
+    /* the arguments are files; if there are none, read stdin. */
+    validate->cert_files = argv;
+    validate->cert_file_count = argc;
+
+    /* set validate command as the head of opts command. */
+    validate->hdr.next = opts->cmd;
+    opts->cmd = &validate->hdr;
+
+    /* success. */
+    retval = VCTOOL_STATUS_SUCCESS;
+    goto done;
+
+free_validate:
+    free(validate);
+
+done:
+    return retval;
+}
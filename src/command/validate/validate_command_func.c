@@ -0,0 +1,569 @@
+/**
+ * \file command/validate/validate_command_func.c
+ *
+ * \brief Entry point for the validate command.
+ *
+ * \copyright 2020 Velo Payments.  See License.txt for license terms.
+ */
+
+#include <cbmc/model_assert.h>
+#include <ctype.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <vctool/certjson.h>
+#include <vctool/certschema.h>
+#include <vctool/command/validate.h>
+#include <vctool/commandline.h>
+
+/**
+ * \brief State shared by the validate workers.
+ */
+typedef struct validate_state
+{
+    file* f;
+    const certschema* schema;
+    char** paths;
+    size_t count;
+    size_t next;
+    pthread_mutex_t lock;
+    size_t certificates;
+    size_t invalid;
+    size_t failed;
+} validate_state;
+
+/**
+ * \brief The buffer of a validate worker.
+ */
+typedef struct validate_buffer
+{
+    uint8_t* data;
+    size_t capacity;
+} validate_buffer;
+
+/* forward decls. */
+static int validate_read_paths(
+    validate_command* validate, char*** paths, size_t* count);
+static int validate_append_path(
+    char*** paths, size_t* count, size_t* reserved, const char* path);
+static void* validate_worker(void* arg);
+static int validate_file(
+    validate_state* state, const char* path, validate_buffer* buffer);
+static int validate_lines(
+    validate_state* state, const char* path, const char* text, size_t size,
+    validate_buffer* buffer);
+static void validate_certificate(
+    validate_state* state, const char* path, size_t line,
+    const uint8_t* cert, size_t size);
+static const char* validate_reason(int status);
+
+/**
+ * \brief Execute the validate command.
+ *
+ * Each file is either a single certificate or, if it starts with '{', a
+ * stream of certificates as JSON lines, as written by to-json.  Files are
+ * shared among one thread per online processor; each thread claims the next
+ * unchecked file.  Every invalid certificate is reported on a line of its
+ * own.
+ *
+ * \param opts          The commandline opts for this operation.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - VCTOOL_ERROR_CERTSCHEMA_INVALID if a certificate is invalid or
+ *        could not be read.
+ *      - a non-zero error code on failure.
+ */
+int validate_command_func(commandline_opts* opts)
+{
+    int retval;
+    validate_state state;
+    certschema_sizes sizes;
+    char** paths = NULL;
+    size_t count = 0;
+
+    /* parameter sanity checks. */
+    MODEL_ASSERT(PROP_VALID_COMMANDLINE_OPTS(opts));
+
+    /* get the validate command. */
+    validate_command* validate = (validate_command*)opts->cmd;
+    MODEL_ASSERT(NULL != validate);
+
+    /* gather the files from the command line or stdin. */
+    retval = validate_read_paths(validate, &paths, &count);
+    if (VCTOOL_STATUS_SUCCESS != retval)
+    {
+        goto done;
+    }
+
+    /* the schemas are shared, read-only, by every worker. */
+    certschema* schema = (certschema*)malloc(sizeof(certschema));
+    if (NULL == schema)
+    {
+        retval = VCTOOL_ERROR_GENERAL_OUT_OF_MEMORY;
+        goto done;
+    }
+
+    certschema_sizes_init(&sizes, opts->suite);
+    certschema_init(schema, &sizes);
+
+    memset(&state, 0, sizeof(state));
+    state.f = opts->file;
+    state.schema = schema;
+    state.paths = paths;
+    state.count = count;
+    if (0 != pthread_mutex_init(&state.lock, NULL))
+    {
+        retval = VCTOOL_ERROR_GENERAL_OUT_OF_MEMORY;
+        goto cleanup_schema;
+    }
+
+    /* one thread per processor, but no more than there are files. */
+    long online = sysconf(_SC_NPROCESSORS_ONLN);
+    size_t thread_count = (online > 0) ? (size_t)online : 1;
+    if (count < thread_count)
+    {
+        thread_count = (0 == count) ? 1 : count;
+    }
+
+    pthread_t* threads =
+        (pthread_t*)calloc(thread_count, sizeof(pthread_t));
+    if (NULL == threads)
+    {
+        retval = VCTOOL_ERROR_GENERAL_OUT_OF_MEMORY;
+        goto cleanup_lock;
+    }
+
+    /* start a thread for every worker but the first; a thread which can't
+     * be started just leaves more files for the others. */
+    size_t started = 1;
+    for (; started < thread_count; ++started)
+    {
+        if (0 !=
+                pthread_create(
+                    &threads[started], NULL, &validate_worker, &state))
+        {
+            break;
+        }
+    }
+
+    /* the calling thread is the first worker. */
+    validate_worker(&state);
+
+    /* wait for the others. */
+    for (size_t t = 1; t < started; ++t)
+    {
+        pthread_join(threads[t], NULL);
+    }
+
+    printf(
+        "Validated %zu certificates in %zu files: %zu invalid, %zu "
+        "unreadable files.\n", state.certificates, count, state.invalid,
+        state.failed);
+
+    if (state.invalid > 0 || state.failed > 0)
+    {
+        retval = VCTOOL_ERROR_CERTSCHEMA_INVALID;
+    }
+    else
+    {
+        retval = VCTOOL_STATUS_SUCCESS;
+    }
+
+    free(threads);
+
+cleanup_lock:
+    pthread_mutex_destroy(&state.lock);
+
+cleanup_schema:
+    free(schema);
+
+done:
+    for (size_t i = 0; i < count; ++i)
+    {
+        free(paths[i]);
+    }
+    free(paths);
+
+    return retval;
+}
+
+/**
+ * \brief Read the file paths for this command.
+ *
+ * \param validate      The validate command.
+ * \param paths         Pointer to receive an allocated array of paths.
+ * \param count         Pointer to receive the number of paths.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - a non-zero error code on failure.
+ */
+static int validate_read_paths(
+    validate_command* validate, char*** paths, size_t* count)
+{
+    int retval = VCTOOL_STATUS_SUCCESS;
+    size_t reserved = 0;
+
+    /* files on the command line take precedence. */
+    if (validate->cert_file_count > 0)
+    {
+        for (int i = 0; i < validate->cert_file_count; ++i)
+        {
+            retval =
+                validate_append_path(
+                    paths, count, &reserved, validate->cert_files[i]);
+            if (VCTOOL_STATUS_SUCCESS != retval)
+            {
+                return retval;
+            }
+        }
+
+        return VCTOOL_STATUS_SUCCESS;
+    }
+
+    /* otherwise, read one path per line from stdin. */
+    char* line = NULL;
+    size_t line_size = 0;
+    while (getline(&line, &line_size, stdin) >= 0)
+    {
+        /* trim trailing whitespace. */
+        size_t len = strlen(line);
+        while (len > 0 && isspace((unsigned char)line[len - 1]))
+        {
+            line[--len] = 0;
+        }
+
+        /* skip blank lines. */
+        if (0 == len)
+        {
+            continue;
+        }
+
+        retval = validate_append_path(paths, count, &reserved, line);
+        if (VCTOOL_STATUS_SUCCESS != retval)
+        {
+            break;
+        }
+    }
+
+    free(line);
+
+    return retval;
+}
+
+/**
+ * \brief Append a copy of a path to a path array.
+ *
+ * \param paths         The path array.
+ * \param count         The number of paths in the array.
+ * \param reserved      The number of paths allocated.
+ * \param path          The path to append.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - VCTOOL_ERROR_GENERAL_OUT_OF_MEMORY if an allocation failed.
+ */
+static int validate_append_path(
+    char*** paths, size_t* count, size_t* reserved, const char* path)
+{
+    /* grow the array if needed. */
+    if (*count == *reserved)
+    {
+        size_t new_reserved = (0 == *reserved) ? 16 : 2 * *reserved;
+        char** tmp = (char**)realloc(*paths, new_reserved * sizeof(char*));
+        if (NULL == tmp)
+        {
+            return VCTOOL_ERROR_GENERAL_OUT_OF_MEMORY;
+        }
+
+        *paths = tmp;
+        *reserved = new_reserved;
+    }
+
+    char* copy = strdup(path);
+    if (NULL == copy)
+    {
+        return VCTOOL_ERROR_GENERAL_OUT_OF_MEMORY;
+    }
+
+    (*paths)[(*count)++] = copy;
+
+    return VCTOOL_STATUS_SUCCESS;
+}
+
+/**
+ * \brief Validate files until none are left.
+ *
+ * \param arg           The shared validate state.
+ *
+ * \returns NULL.
+ */
+static void* validate_worker(void* arg)
+{
+    validate_state* state = (validate_state*)arg;
+    validate_buffer buffer = { NULL, 0 };
+
+    for (;;)
+    {
+        /* claim the next file. */
+        pthread_mutex_lock(&state->lock);
+        size_t i = state->next++;
+        pthread_mutex_unlock(&state->lock);
+
+        if (i >= state->count)
+        {
+            break;
+        }
+
+        int retval = validate_file(state, state->paths[i], &buffer);
+        if (VCTOOL_STATUS_SUCCESS != retval)
+        {
+            pthread_mutex_lock(&state->lock);
+            ++state->failed;
+            fprintf(
+                stderr, "%s: could not read file (%x).\n", state->paths[i],
+                (unsigned)retval);
+            pthread_mutex_unlock(&state->lock);
+        }
+    }
+
+    free(buffer.data);
+
+    return NULL;
+}
+
+/**
+ * \brief Validate the certificates in a file.
+ *
+ * \param state         The shared validate state.
+ * \param path          The path of the file.
+ * \param buffer        The worker's buffer for certificates read from JSON.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS if the file was read.
+ *      - VCTOOL_ERROR_GENERAL_OUT_OF_MEMORY if the buffer could not grow.
+ *      - a non-zero error code returned by the file layer.
+ */
+static int validate_file(
+    validate_state* state, const char* path, validate_buffer* buffer)
+{
+    int retval, fd;
+    file_stat_st fst;
+    void* map;
+
+    retval = file_stat(state->f, path, &fst);
+    if (VCTOOL_STATUS_SUCCESS != retval)
+    {
+        return retval;
+    }
+
+    /* an empty file is an empty certificate, which has no type. */
+    size_t size = (size_t)fst.fst_size;
+    if (0 == size)
+    {
+        validate_certificate(state, path, 0, NULL, 0);
+        return VCTOOL_STATUS_SUCCESS;
+    }
+
+    retval = file_open(state->f, &fd, path, O_RDONLY, 0);
+    if (VCTOOL_STATUS_SUCCESS != retval)
+    {
+        return retval;
+    }
+
+    retval = file_mmap(state->f, &map, fd, size);
+    file_close(state->f, fd);
+    if (VCTOOL_STATUS_SUCCESS != retval)
+    {
+        return retval;
+    }
+
+    /* a certificate starts with a field type, never with a brace. */
+    const char* text = (const char*)map;
+    size_t start = 0;
+    while (start < size && isspace((unsigned char)text[start]))
+    {
+        ++start;
+    }
+
+    if (start < size && '{' == text[start])
+    {
+        retval = validate_lines(state, path, text, size, buffer);
+    }
+    else
+    {
+        validate_certificate(state, path, 0, (const uint8_t*)map, size);
+    }
+
+    file_munmap(state->f, map, size);
+
+    return retval;
+}
+
+/**
+ * \brief Validate a stream of certificates as JSON lines.
+ *
+ * A line which is not a certificate is reported as invalid.
+ *
+ * \param state         The shared validate state.
+ * \param path          The path of the file.
+ * \param text          The JSON text.
+ * \param size          The size of the text.
+ * \param buffer        The worker's buffer for certificates.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - VCTOOL_ERROR_GENERAL_OUT_OF_MEMORY if the buffer could not grow.
+ */
+static int validate_lines(
+    validate_state* state, const char* path, const char* text, size_t size,
+    validate_buffer* buffer)
+{
+    size_t line_number = 0;
+
+    for (size_t offset = 0; offset < size;)
+    {
+        const char* start = text + offset;
+        const char* end = (const char*)memchr(start, '\n', size - offset);
+        size_t length = (NULL == end) ? size - offset : (size_t)(end - start);
+        offset += length + 1;
+        ++line_number;
+
+        /* skip blank lines. */
+        size_t blank = 0;
+        while (blank < length && isspace((unsigned char)start[blank]))
+        {
+            ++blank;
+        }
+
+        if (blank == length)
+        {
+            continue;
+        }
+
+        /* a certificate is never larger than its line. */
+        if (length > buffer->capacity)
+        {
+            uint8_t* grown = (uint8_t*)realloc(buffer->data, length);
+            if (NULL == grown)
+            {
+                return VCTOOL_ERROR_GENERAL_OUT_OF_MEMORY;
+            }
+
+            buffer->data = grown;
+            buffer->capacity = length;
+        }
+
+        size_t consumed, cert_size;
+        int retval =
+            certjson_read(
+                start, length, &consumed, buffer->data, buffer->capacity,
+                &cert_size);
+        if (VCTOOL_STATUS_SUCCESS != retval)
+        {
+            pthread_mutex_lock(&state->lock);
+            ++state->certificates;
+            ++state->invalid;
+            printf("%s:%zu: not a certificate.\n", path, line_number);
+            pthread_mutex_unlock(&state->lock);
+            continue;
+        }
+
+        validate_certificate(
+            state, path, line_number, buffer->data, cert_size);
+    }
+
+    return VCTOOL_STATUS_SUCCESS;
+}
+
+/**
+ * \brief Validate a certificate, reporting it if it is invalid.
+ *
+ * \param state         The shared validate state.
+ * \param path          The path of the file holding the certificate.
+ * \param line          The line of the certificate, or zero if the file is
+ *                      the certificate.
+ * \param cert          The certificate.
+ * \param size          The size of the certificate.
+ */
+static void validate_certificate(
+    validate_state* state, const char* path, size_t line,
+    const uint8_t* cert, size_t size)
+{
+    const certschema_type* type;
+    uint16_t field;
+    char where[24] = "";
+    char field_name[8];
+
+    int retval = certschema_validate(state->schema, cert, size, &type, &field);
+
+    if (VCTOOL_STATUS_SUCCESS == retval)
+    {
+        pthread_mutex_lock(&state->lock);
+        ++state->certificates;
+        pthread_mutex_unlock(&state->lock);
+        return;
+    }
+
+    if (line > 0)
+    {
+        snprintf(where, sizeof(where), ":%zu", line);
+    }
+
+    const certjson_field* named = certjson_field_by_type(field);
+    if (NULL == named)
+    {
+        snprintf(field_name, sizeof(field_name), "0x%04x", field);
+    }
+
+    pthread_mutex_lock(&state->lock);
+    ++state->certificates;
+    ++state->invalid;
+    printf(
+        "%s%s: %s%s%s (%s).\n", path, where,
+        (NULL != type) ? type->name : "certificate",
+        (NULL != type) ? " certificate" : "", validate_reason(retval),
+        (NULL != named) ? named->name : field_name);
+    pthread_mutex_unlock(&state->lock);
+}
+
+/**
+ * \brief Describe a validation failure.
+ *
+ * \param status        The status code returned by certschema_validate.
+ *
+ * \returns the description.
+ */
+static const char* validate_reason(int status)
+{
+    switch (status)
+    {
+        case VCTOOL_ERROR_CERTSCHEMA_BAD_CERTIFICATE:
+            return " has a truncated field";
+
+        case VCTOOL_ERROR_CERTSCHEMA_MISSING_TYPE:
+            return " has no certificate type";
+
+        case VCTOOL_ERROR_CERTSCHEMA_UNKNOWN_TYPE:
+            return " has an unknown certificate type";
+
+        case VCTOOL_ERROR_CERTSCHEMA_UNEXPECTED_FIELD:
+            return " has an unexpected field";
+
+        case VCTOOL_ERROR_CERTSCHEMA_DUPLICATE_FIELD:
+            return " has a duplicate field";
+
+        case VCTOOL_ERROR_CERTSCHEMA_BAD_FIELD_SIZE:
+            return " has a field of the wrong size";
+
+        case VCTOOL_ERROR_CERTSCHEMA_MISSING_FIELD:
+            return " is missing a field";
+
+        default:
+            return " is invalid";
+    }
+}
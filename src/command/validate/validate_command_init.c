@@ -0,0 +1,52 @@
+/**
+ * \file command/validate/validate_command_init.c
+ *
+ * \brief Initialize a validate command structure.
+ *
+ * \copyright 2020 Velo Payments.  See License.txt for license terms.
+ */
+
+#include <cbmc/model_assert.h>
+#include <string.h>
+#include <vctool/command/root.h>
+#include <vctool/command/validate.h>
+#include <vctool/status_codes.h>
+#include <vpr/parameters.h>
+
+/* forward decls. */
+static void validate_command_dispose(void* disp);
+
+/**
+ * \brief Initialize a validate command structure.
+ *
+ * \param validate        The validate command structure to initialize.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - a non-zero error code on failure.
+ */
+int validate_command_init(validate_command* validate)
+{
+    /* parameter sanity checks. */
+    MODEL_ASSERT(NULL != validate);
+
+    /* clear validate command structure. */
+    memset(validate, 0, sizeof(validate_command));
+
+    /* set disposer, func, etc. */
+    validate->hdr.hdr.dispose = &validate_command_dispose;
+    validate->hdr.func = &validate_command_func;
+
+    /* success. */
+    return VCTOOL_STATUS_SUCCESS;
+}
+
+/**
+ * \brief Dispose of a validate_command structure.
+ *
+ * \param disp          The validate_command structure to dispose.
+ */
+static void validate_command_dispose(void* UNUSED(disp))
+{
+    /* do nothing. */
+}
@@ -0,0 +1,89 @@
+/**
+ * \file command/verify/process_verify_command.c
+ *
+ * \brief Process command-line options to build a verify command.
+ *
+ * \copyright 2020 Velo Payments.  See License.txt for license terms.
+ */
+
+#include <cbmc/model_assert.h>
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vctool/command/root.h>
+#include <vctool/command/verify.h>
+#include <vctool/commandline.h>
+#include <vctool/status_codes.h>
+
+/**
+ * \brief Process the verify command.
+ *
+ * \param opts          The command-line option structure.
+ * \param argc          The argument count.
+ * \param argv          The argument vector.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - a non-zero error code on failure.
+ */
+int process_verify_command(commandline_opts* opts, int argc, char* argv[])
+{
+    int retval;
+    char* end;
+
+    /* parameter sanity checks. */
+    MODEL_ASSERT(PROP_VALID_COMMANDLINE_OPTS(opts));
+
+    /* we need a height; the files are optional. */
+    if (argc < 1)
+    {
+        fprintf(stderr, "Expecting verify height [file...].\n");
+        retval = VCTOOL_ERROR_COMMANDLINE_MISSING_ARGUMENT;
+        goto done;
+    }
+
+    errno = 0;
+    unsigned long long height = strtoull(argv[0], &end, 10);
+    if (0 != errno || end == argv[0] || 0 != *end || '-' == argv[0][0])
+    {
+        fprintf(stderr, "Bad block height %s.\n", argv[0]);
+        retval = VCTOOL_ERROR_COMMANDLINE_BAD_ARGUMENT;
+        goto done;
+    }
+
+    /* allocate memory for a verify_command structure. */
+    verify_command* verify =
+        (verify_command*)malloc(sizeof(verify_command));
+    if (NULL == verify)
+    {
+        retval = VCTOOL_ERROR_GENERAL_OUT_OF_MEMORY;
+        goto done;
+    }
+
+    /* initialize the structure. */
+    retval = verify_command_init(verify);
+    if (VCTOOL_STATUS_SUCCESS != retval)
+    {
+        goto free_verify;
+    }
+
+    /* the remaining arguments are files; if there are none, read stdin. */
+    verify->height = (uint64_t)height;
+    verify->cert_files = argv + 1;
+    verify->cert_file_count = argc - 1;
+
+    /* set verify command as the head of opts command. */
+    verify->hdr.next = opts->cmd;
+    opts->cmd = &verify->hdr;
+
+    /* success. */
+    retval = VCTOOL_STATUS_SUCCESS;
+    goto done;
+
+free_verify:
+    free(verify);
+
+done:
+    return retval;
+}
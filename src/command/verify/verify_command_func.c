@@ -0,0 +1,393 @@
+/**
+ * \file command/verify/verify_command_func.c
+ *
+ * \brief Entry point for the verify command.
+ *
+ * \copyright 2020 Velo Payments.  See License.txt for license terms.
+ */
+
+#include <cbmc/model_assert.h>
+#include <ctype.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vctool/certificate.h>
+#include <vctool/command/verify.h>
+#include <vctool/commandline.h>
+#include <vctool/contract.h>
+#include <vpr/parameters.h>
+
+/* forward decls. */
+static int verify_read_paths(
+    verify_command* verify, char*** paths, size_t* count);
+static int verify_append_path(
+    char*** paths, size_t* count, size_t* reserved, const char* path);
+static int verify_file(
+    commandline_opts* opts, vccert_parser_options_t* parser_options,
+    const char* path, uint64_t height, int* status);
+static bool verify_loader_init(
+    commandline_opts* opts, certcache_loader* loader);
+static bool dummy_txn_resolver(
+    void*, void*, const uint8_t*, const uint8_t*, vccrypt_buffer_t*, bool*);
+static int32_t dummy_artifact_state_resolver(
+    void*, void*, const uint8_t*, vccrypt_buffer_t*);
+
+/**
+ * \brief Execute the verify command.
+ *
+ * Each file holds a single certificate, which is attested at the given block
+ * height with certificate_attest.  Signers resolve to the entities trusted
+ * with --entity, and contracts to the built-in and plugin contracts; a
+ * certificate verified before under the same height, entities, revocations,
+ * and plugins is found in the certificate cache.  Newly verified certificates
+ * are collected by a certificate cache bulk loader and written to the cache
+ * in sorted batches once every file is checked.  Every certificate which
+ * fails attestation is reported on a line of its own.
+ *
+ * \param opts          The commandline opts for this operation.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - VCTOOL_ERROR_CERTIFICATE_ATTESTATION if a certificate failed
+ *        attestation or could not be read.
+ *      - a non-zero error code on failure.
+ */
+int verify_command_func(commandline_opts* opts)
+{
+    int retval;
+    vccert_parser_options_t parser_options;
+    certcache_loader loader;
+    char** paths = NULL;
+    size_t count = 0;
+    size_t failed = 0;
+    size_t unreadable = 0;
+
+    /* parameter sanity checks. */
+    MODEL_ASSERT(PROP_VALID_COMMANDLINE_OPTS(opts));
+
+    /* get the verify command. */
+    verify_command* verify = (verify_command*)opts->cmd;
+    MODEL_ASSERT(NULL != verify);
+
+    /* gather the files from the command line or stdin. */
+    retval = verify_read_paths(verify, &paths, &count);
+    if (VCTOOL_STATUS_SUCCESS != retval)
+    {
+        goto done;
+    }
+
+    /* every certificate is attested with the same resolvers. */
+    retval =
+        vccert_parser_options_init(
+            &parser_options, opts->suite->alloc_opts, opts->suite,
+            &dummy_txn_resolver, &dummy_artifact_state_resolver,
+            &contract_registry_resolve, &certificate_entity_key_resolver,
+            opts);
+    if (VCCERT_STATUS_SUCCESS != retval)
+    {
+        goto done;
+    }
+
+    /* without a usable cache, each result is simply not cached. */
+    bool loading = verify_loader_init(opts, &loader);
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        int status;
+        retval =
+            verify_file(
+                opts, &parser_options, paths[i], verify->height, &status);
+        if (VCTOOL_STATUS_SUCCESS != retval)
+        {
+            ++unreadable;
+            fprintf(
+                stderr, "%s: could not read file (%x).\n", paths[i],
+                (unsigned)retval);
+        }
+        else if (VCTOOL_STATUS_SUCCESS != status)
+        {
+            ++failed;
+            printf(
+                "%s: failed attestation (%x).\n", paths[i],
+                (unsigned)status);
+        }
+    }
+
+    /* failing to cache is not a verification error. */
+    if (loading)
+    {
+        if (VCTOOL_STATUS_SUCCESS != certcache_loader_finish(&loader))
+        {
+            fprintf(stderr, "Warning: could not update the cache.\n");
+        }
+
+        dispose((disposable_t*)&loader);
+    }
+
+    printf(
+        "Verified %zu certificates at height %llu: %zu failed, %zu "
+        "unreadable files.\n", count - unreadable,
+        (unsigned long long)verify->height, failed, unreadable);
+
+    if (failed > 0 || unreadable > 0)
+    {
+        retval = VCTOOL_ERROR_CERTIFICATE_ATTESTATION;
+    }
+    else
+    {
+        retval = VCTOOL_STATUS_SUCCESS;
+    }
+
+    dispose((disposable_t*)&parser_options);
+
+done:
+    for (size_t i = 0; i < count; ++i)
+    {
+        free(paths[i]);
+    }
+    free(paths);
+
+    return retval;
+}
+
+/**
+ * \brief Read the file paths for this command.
+ *
+ * \param verify        The verify command.
+ * \param paths         Pointer to receive an allocated array of paths.
+ * \param count         Pointer to receive the number of paths.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - a non-zero error code on failure.
+ */
+static int verify_read_paths(
+    verify_command* verify, char*** paths, size_t* count)
+{
+    int retval = VCTOOL_STATUS_SUCCESS;
+    size_t reserved = 0;
+
+    /* files on the command line take precedence. */
+    if (verify->cert_file_count > 0)
+    {
+        for (int i = 0; i < verify->cert_file_count; ++i)
+        {
+            retval =
+                verify_append_path(
+                    paths, count, &reserved, verify->cert_files[i]);
+            if (VCTOOL_STATUS_SUCCESS != retval)
+            {
+                return retval;
+            }
+        }
+
+        return VCTOOL_STATUS_SUCCESS;
+    }
+
+    /* otherwise, read one path per line from stdin. */
+    char* line = NULL;
+    size_t line_size = 0;
+    while (getline(&line, &line_size, stdin) >= 0)
+    {
+        /* trim trailing whitespace. */
+        size_t len = strlen(line);
+        while (len > 0 && isspace((unsigned char)line[len - 1]))
+        {
+            line[--len] = 0;
+        }
+
+        /* skip blank lines. */
+        if (0 == len)
+        {
+            continue;
+        }
+
+        retval = verify_append_path(paths, count, &reserved, line);
+        if (VCTOOL_STATUS_SUCCESS != retval)
+        {
+            break;
+        }
+    }
+
+    free(line);
+
+    return retval;
+}
+
+/**
+ * \brief Append a copy of a path to a path array.
+ *
+ * \param paths         The path array.
+ * \param count         The number of paths in the array.
+ * \param reserved      The number of paths allocated.
+ * \param path          The path to append.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - VCTOOL_ERROR_GENERAL_OUT_OF_MEMORY if an allocation failed.
+ */
+static int verify_append_path(
+    char*** paths, size_t* count, size_t* reserved, const char* path)
+{
+    /* grow the array if needed. */
+    if (*count == *reserved)
+    {
+        size_t new_reserved = (0 == *reserved) ? 16 : 2 * *reserved;
+        char** tmp = (char**)realloc(*paths, new_reserved * sizeof(char*));
+        if (NULL == tmp)
+        {
+            return VCTOOL_ERROR_GENERAL_OUT_OF_MEMORY;
+        }
+
+        *paths = tmp;
+        *reserved = new_reserved;
+    }
+
+    char* copy = strdup(path);
+    if (NULL == copy)
+    {
+        return VCTOOL_ERROR_GENERAL_OUT_OF_MEMORY;
+    }
+
+    (*paths)[(*count)++] = copy;
+
+    return VCTOOL_STATUS_SUCCESS;
+}
+
+/**
+ * \brief Read and attest the certificate in a file.
+ *
+ * \param opts              The commandline opts for this operation.
+ * \param parser_options    The parser options to attest with.
+ * \param path              The path of the file.
+ * \param height            The block height at which to attest.
+ * \param status            Set to the status returned by certificate_attest
+ *                          if the file was read.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS if the file was read.
+ *      - a non-zero error code returned by the file layer.
+ */
+static int verify_file(
+    commandline_opts* opts, vccert_parser_options_t* parser_options,
+    const char* path, uint64_t height, int* status)
+{
+    int retval, fd;
+    file_stat_st fst;
+    vccrypt_buffer_t cert;
+    size_t read_bytes;
+
+    retval = file_stat(opts->file, path, &fst);
+    if (VCTOOL_STATUS_SUCCESS != retval)
+    {
+        return retval;
+    }
+
+    retval =
+        vccrypt_buffer_init(
+            &cert, opts->suite->alloc_opts, (size_t)fst.fst_size);
+    if (VCCRYPT_STATUS_SUCCESS != retval)
+    {
+        return VCTOOL_ERROR_GENERAL_OUT_OF_MEMORY;
+    }
+
+    retval = file_open(opts->file, &fd, path, O_RDONLY, 0);
+    if (VCTOOL_STATUS_SUCCESS != retval)
+    {
+        goto cleanup_cert;
+    }
+
+    retval = file_read(opts->file, fd, cert.data, cert.size, &read_bytes);
+    file_close(opts->file, fd);
+    if (VCTOOL_STATUS_SUCCESS != retval)
+    {
+        goto cleanup_cert;
+    }
+    else if (read_bytes != cert.size)
+    {
+        retval = VCTOOL_ERROR_FILE_IO;
+        goto cleanup_cert;
+    }
+
+    *status = certificate_attest(opts, parser_options, &cert, height);
+
+    /* success. */
+    retval = VCTOOL_STATUS_SUCCESS;
+
+cleanup_cert:
+    dispose((disposable_t*)&cert);
+
+    return retval;
+}
+
+/**
+ * \brief Attach a bulk loader to the certificate cache.
+ *
+ * Sort runs are created in the directory of the cache database.
+ *
+ * \param opts          The commandline opts for this operation.
+ * \param loader        The loader to initialize.
+ *
+ * \returns true if the loader was attached, and false if the cache is
+ *          disabled or could not be opened.
+ */
+static bool verify_loader_init(
+    commandline_opts* opts, certcache_loader* loader)
+{
+    const char* path = opts->certcache.path;
+
+    if (opts->certcache.disabled || NULL == path)
+    {
+        return false;
+    }
+
+    /* runs go in the directory of the cache. */
+    char* dir = (char*)malloc(strlen(path) + 2);
+    if (NULL == dir)
+    {
+        return false;
+    }
+
+    strcpy(dir, path);
+
+    char* slash = strrchr(dir, '/');
+    if (NULL == slash)
+    {
+        strcpy(dir, ".");
+    }
+    else if (slash == dir)
+    {
+        dir[1] = 0;
+    }
+    else
+    {
+        *slash = 0;
+    }
+
+    int retval =
+        certcache_loader_init(loader, &opts->certcache, opts->file, dir, 0);
+    free(dir);
+
+    return VCTOOL_STATUS_SUCCESS == retval;
+}
+
+/**
+ * \brief Dummy transaction resolver for parser options.
+ */
+static bool dummy_txn_resolver(
+    void* UNUSED(a), void* UNUSED(b), const uint8_t* UNUSED(c),
+    const uint8_t* UNUSED(d), vccrypt_buffer_t* UNUSED(e), bool* UNUSED(f))
+{
+    return false;
+}
+
+/**
+ * \brief Dummy artifact state resolver for parser options.
+ */
+static int32_t dummy_artifact_state_resolver(
+    void* UNUSED(a), void* UNUSED(b), const uint8_t* UNUSED(c),
+    vccrypt_buffer_t* UNUSED(d))
+{
+    return -1;
+}
@@ -0,0 +1,52 @@
+/**
+ * \file command/verify/verify_command_init.c
+ *
+ * \brief Initialize a verify command structure.
+ *
+ * \copyright 2020 Velo Payments.  See License.txt for license terms.
+ */
+
+#include <cbmc/model_assert.h>
+#include <string.h>
+#include <vctool/command/root.h>
+#include <vctool/command/verify.h>
+#include <vctool/status_codes.h>
+#include <vpr/parameters.h>
+
+/* forward decls. */
+static void verify_command_dispose(void* disp);
+
+/**
+ * \brief Initialize a verify command structure.
+ *
+ * \param verify        The verify command structure to initialize.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - a non-zero error code on failure.
+ */
+int verify_command_init(verify_command* verify)
+{
+    /* parameter sanity checks. */
+    MODEL_ASSERT(NULL != verify);
+
+    /* clear verify command structure. */
+    memset(verify, 0, sizeof(verify_command));
+
+    /* set disposer, func, etc. */
+    verify->hdr.hdr.dispose = &verify_command_dispose;
+    verify->hdr.func = &verify_command_func;
+
+    /* success. */
+    return VCTOOL_STATUS_SUCCESS;
+}
+
+/**
+ * \brief Dispose of a verify_command structure.
+ *
+ * \param disp          The verify_command structure to dispose.
+ */
+static void verify_command_dispose(void* UNUSED(disp))
+{
+    /* do nothing. */
+}
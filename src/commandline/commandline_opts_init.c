@@ -7,15 +7,56 @@
  */
 
 #include <cbmc/model_assert.h>
+#include <fcntl.h>
+#include <getopt.h>
+#include <stdio.h>
 #include <string.h>
 #include <unistd.h>
+#include <vccert/certificate_types.h>
+#include <vccert/fields.h>
 #include <vctool/command/help.h>
 #include <vctool/command/root.h>
 #include <vctool/commandline.h>
 #include <vctool/status_codes.h>
 
+/* the size of a certificate field header. */
+#define COMMANDLINE_FIELD_HEADER_SIZE                   4
+
+/* the size of a type or entity uuid. */
+#define COMMANDLINE_UUID_SIZE                           16
+
 /* forward decls */
 static void commandline_opts_dispose(void* disp);
+static int commandline_entity_load(commandline_opts* opts, const char* path);
+static int commandline_entity_create(
+    commandline_opts* opts, const uint8_t* cert, size_t size);
+static int commandline_plugin_mix(commandline_opts* opts, const char* path);
+static int commandline_certcache_init(commandline_opts* opts);
+static int commandline_revocations_load(
+    commandline_opts* opts, const char* path);
+static int commandline_recorder_init(
+    commandline_opts* opts, const char* path);
+
+/* values for options which only have a long form. */
+enum commandline_long_option
+{
+    COMMANDLINE_OPTION_NO_CACHE = 0x100,
+    COMMANDLINE_OPTION_RECORD_AGENT,
+    COMMANDLINE_OPTION_JOURNAL,
+    COMMANDLINE_OPTION_ENTITY,
+    COMMANDLINE_OPTION_STORE,
+};
+
+/* long options. */
+static struct option commandline_long_options[] = {
+    { "no-cache", no_argument, NULL, COMMANDLINE_OPTION_NO_CACHE },
+    { "record-agent", required_argument, NULL,
+      COMMANDLINE_OPTION_RECORD_AGENT },
+    { "journal", required_argument, NULL, COMMANDLINE_OPTION_JOURNAL },
+    { "entity", required_argument, NULL, COMMANDLINE_OPTION_ENTITY },
+    { "store", required_argument, NULL, COMMANDLINE_OPTION_STORE },
+    { NULL, 0, NULL, 0 }
+};
 
 /**
  * \brief Parse command-line options, initializing a commandline_opts structure.
@@ -72,8 +113,35 @@ int commandline_opts_init(
     opts->builder_opts = builder_opts;
     opts->cmd = (command*)root;
 
+    /* initialize the contract registry. */
+    retval = contract_registry_init(&opts->contracts);
+    if (VCTOOL_STATUS_SUCCESS != retval)
+    {
+        goto cleanup_root_command;
+    }
+
+    /* plugins add to the built-in contracts. */
+    retval = contract_registry_register_builtins(&opts->contracts, suite);
+    if (VCTOOL_STATUS_SUCCESS != retval)
+    {
+        goto cleanup_contracts;
+    }
+
+    /* initialize the certificate cache. */
+    retval = commandline_certcache_init(opts);
+    if (VCTOOL_STATUS_SUCCESS != retval)
+    {
+        goto cleanup_contracts;
+    }
+
+    /* start with the base resolver version. */
+    opts->resolver_version = CERTCACHE_RESOLVER_VERSION_BASE;
+
     /* read through command-line options. */
-    while ((ch = getopt(argc, argv, "?R:hk:o:")) != -1)
+    while ((ch =
+                getopt_long(
+                    argc, argv, "?P:R:hk:o:r:", commandline_long_options,
+                    NULL)) != -1)
     {
         switch (ch)
         {
@@ -102,6 +170,38 @@ int commandline_opts_init(
                 root->output_filename = strdup(optarg);
                 break;
 
+            case 'P':
+                retval =
+                    contract_registry_load_plugin(&opts->contracts, optarg);
+                if (VCTOOL_STATUS_SUCCESS != retval)
+                {
+                    fprintf(stderr, "Error loading plugin %s.\n", optarg);
+                    goto dispose_opts;
+                }
+                /* contracts change the outcome of attestation. */
+                retval = commandline_plugin_mix(opts, optarg);
+                if (VCTOOL_STATUS_SUCCESS != retval)
+                {
+                    fprintf(stderr, "Error reading plugin %s.\n", optarg);
+                    goto dispose_opts;
+                }
+                break;
+
+            case 'r':
+                if (NULL != opts->revocations)
+                {
+                    fprintf(stderr, "duplicate option -r %s\n", optarg);
+                    retval = VCTOOL_ERROR_COMMANDLINE_DUPLICATE_OPTION;
+                    goto dispose_opts;
+                }
+                retval = commandline_revocations_load(opts, optarg);
+                if (VCTOOL_STATUS_SUCCESS != retval)
+                {
+                    fprintf(stderr, "Error loading revocations %s.\n", optarg);
+                    goto dispose_opts;
+                }
+                break;
+
             case 'R':
                 rounds = atoi(optarg);
                 if (rounds <= 0)
@@ -112,6 +212,56 @@ int commandline_opts_init(
                 }
                 root->key_derivation_rounds = (unsigned int)rounds;
                 break;
+
+            case COMMANDLINE_OPTION_NO_CACHE:
+                opts->certcache.disabled = true;
+                break;
+
+            case COMMANDLINE_OPTION_RECORD_AGENT:
+                if (NULL != opts->agent_recorder)
+                {
+                    fprintf(
+                        stderr, "duplicate option --record-agent %s\n",
+                        optarg);
+                    retval = VCTOOL_ERROR_COMMANDLINE_DUPLICATE_OPTION;
+                    goto dispose_opts;
+                }
+                retval = commandline_recorder_init(opts, optarg);
+                if (VCTOOL_STATUS_SUCCESS != retval)
+                {
+                    fprintf(stderr, "Error creating recording %s.\n", optarg);
+                    goto dispose_opts;
+                }
+                break;
+
+            case COMMANDLINE_OPTION_JOURNAL:
+                if (NULL != opts->journal_path)
+                {
+                    fprintf(stderr, "duplicate option --journal %s\n", optarg);
+                    retval = VCTOOL_ERROR_COMMANDLINE_DUPLICATE_OPTION;
+                    goto dispose_opts;
+                }
+                opts->journal_path = optarg;
+                break;
+
+            case COMMANDLINE_OPTION_ENTITY:
+                retval = commandline_entity_load(opts, optarg);
+                if (VCTOOL_STATUS_SUCCESS != retval)
+                {
+                    fprintf(stderr, "Error loading entity %s.\n", optarg);
+                    goto dispose_opts;
+                }
+                break;
+
+            case COMMANDLINE_OPTION_STORE:
+                if (NULL != opts->store_path)
+                {
+                    fprintf(stderr, "duplicate option --store %s\n", optarg);
+                    retval = VCTOOL_ERROR_COMMANDLINE_DUPLICATE_OPTION;
+                    goto dispose_opts;
+                }
+                opts->store_path = optarg;
+                break;
         }
     }
 
@@ -138,6 +288,9 @@ dispose_opts:
     dispose((disposable_t*)opts);
     goto done;
 
+cleanup_contracts:
+    dispose((disposable_t*)&opts->contracts);
+
 cleanup_root_command:
     free(root);
 
@@ -166,4 +319,400 @@ static void commandline_opts_dispose(void* disp)
         /* iterate to the next value. */
         opts->cmd = tmp;
     }
+
+    /* dispose of the revocation list. */
+    if (NULL != opts->revocations)
+    {
+        dispose((disposable_t*)opts->revocations);
+        free(opts->revocations);
+    }
+
+    /* dispose of the trusted entities. */
+    while (NULL != opts->entities)
+    {
+        commandline_entity* tmp = opts->entities->next;
+
+        dispose((disposable_t*)&opts->entities->encryption_pubkey);
+        dispose((disposable_t*)&opts->entities->signing_pubkey);
+        free(opts->entities);
+
+        opts->entities = tmp;
+    }
+
+    /* close the agent recording. */
+    if (NULL != opts->agent_recorder)
+    {
+        dispose((disposable_t*)opts->agent_recorder);
+        free(opts->agent_recorder);
+    }
+
+    /* dispose of the certificate cache. */
+    dispose((disposable_t*)&opts->certcache);
+
+    /* dispose of the contract registry. */
+    dispose((disposable_t*)&opts->contracts);
+}
+
+/**
+ * \brief Trust the keys of the entity in a public entity certificate.
+ *
+ * \param opts      The commandline_opts instance for this entity.
+ * \param path      The path of the public entity certificate.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - VCTOOL_ERROR_CERTIFICATE_BAD_ENTITY if the file does not hold a
+ *        valid public entity certificate.
+ *      - a non-zero error code on failure.
+ */
+static int commandline_entity_load(commandline_opts* opts, const char* path)
+{
+    int retval, fd;
+    file_stat_st fst;
+    size_t read_bytes;
+
+    retval = file_stat(opts->file, path, &fst);
+    if (VCTOOL_STATUS_SUCCESS != retval)
+    {
+        return retval;
+    }
+
+    size_t size = (size_t)fst.fst_size;
+    uint8_t* cert = (uint8_t*)malloc(size + 1);
+    if (NULL == cert)
+    {
+        return VCTOOL_ERROR_GENERAL_OUT_OF_MEMORY;
+    }
+
+    retval = file_open(opts->file, &fd, path, O_RDONLY, 0);
+    if (VCTOOL_STATUS_SUCCESS != retval)
+    {
+        goto free_cert;
+    }
+
+    retval = file_read(opts->file, fd, cert, size, &read_bytes);
+    file_close(opts->file, fd);
+    if (VCTOOL_STATUS_SUCCESS != retval)
+    {
+        goto free_cert;
+    }
+    else if (read_bytes != size)
+    {
+        retval = VCTOOL_ERROR_FILE_IO;
+        goto free_cert;
+    }
+
+    retval = commandline_entity_create(opts, cert, size);
+    if (VCTOOL_STATUS_SUCCESS == retval)
+    {
+        /* key sources change the outcome of attestation. */
+        certcache_version_mix(&opts->resolver_version, cert, size);
+    }
+
+free_cert:
+    free(cert);
+
+    return retval;
+}
+
+/**
+ * \brief Add the entity in a public entity certificate to the trusted
+ * entities.
+ *
+ * The certificate must be a public entity certificate holding its entity id
+ * and both public keys, each once and at the size of the crypto suite.
+ *
+ * \param opts      The commandline_opts instance for this entity.
+ * \param cert      The public entity certificate.
+ * \param size      The size of the certificate.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - VCTOOL_ERROR_CERTIFICATE_BAD_ENTITY if this is not a valid public
+ *        entity certificate.
+ *      - VCTOOL_ERROR_GENERAL_OUT_OF_MEMORY if an allocation failed.
+ */
+static int commandline_entity_create(
+    commandline_opts* opts, const uint8_t* cert, size_t size)
+{
+    int retval;
+    const uint8_t* type = NULL;
+    const uint8_t* id = NULL;
+    const uint8_t* encryption_pubkey = NULL;
+    const uint8_t* signing_pubkey = NULL;
+    size_t encryption_pubkey_size =
+        opts->suite->key_cipher_opts.public_key_size;
+    size_t signing_pubkey_size = opts->suite->sign_opts.public_key_size;
+
+    /* check the fields of the cert before trusting any of them. */
+    for (size_t pos = 0; pos < size;)
+    {
+        if (size - pos < COMMANDLINE_FIELD_HEADER_SIZE)
+        {
+            return VCTOOL_ERROR_CERTIFICATE_BAD_ENTITY;
+        }
+
+        uint16_t field_type = (uint16_t)((cert[pos] << 8) | cert[pos + 1]);
+        size_t field_size = ((size_t)cert[pos + 2] << 8) | cert[pos + 3];
+        const uint8_t* value = cert + pos + COMMANDLINE_FIELD_HEADER_SIZE;
+        pos += COMMANDLINE_FIELD_HEADER_SIZE;
+        if (size - pos < field_size)
+        {
+            return VCTOOL_ERROR_CERTIFICATE_BAD_ENTITY;
+        }
+        pos += field_size;
+
+        const uint8_t** field = NULL;
+        size_t expected_size = 0;
+        switch (field_type)
+        {
+            case VCCERT_FIELD_TYPE_CERTIFICATE_TYPE:
+                field = &type;
+                expected_size = COMMANDLINE_UUID_SIZE;
+                break;
+
+            case VCCERT_FIELD_TYPE_ARTIFACT_ID:
+                field = &id;
+                expected_size = COMMANDLINE_UUID_SIZE;
+                break;
+
+            case VCCERT_FIELD_TYPE_PUBLIC_ENCRYPTION_KEY:
+                field = &encryption_pubkey;
+                expected_size = encryption_pubkey_size;
+                break;
+
+            case VCCERT_FIELD_TYPE_PUBLIC_SIGNING_KEY:
+                field = &signing_pubkey;
+                expected_size = signing_pubkey_size;
+                break;
+        }
+
+        if (NULL != field)
+        {
+            if (NULL != *field || expected_size != field_size)
+            {
+                return VCTOOL_ERROR_CERTIFICATE_BAD_ENTITY;
+            }
+            *field = value;
+        }
+    }
+
+    if (NULL == type || NULL == id || NULL == encryption_pubkey
+     || NULL == signing_pubkey
+     || memcmp(
+            type, vccert_certificate_type_uuid_public_entity,
+            COMMANDLINE_UUID_SIZE))
+    {
+        return VCTOOL_ERROR_CERTIFICATE_BAD_ENTITY;
+    }
+
+    /* allocate the entity. */
+    commandline_entity* entity =
+        (commandline_entity*)malloc(sizeof(commandline_entity));
+    if (NULL == entity)
+    {
+        return VCTOOL_ERROR_GENERAL_OUT_OF_MEMORY;
+    }
+
+    memcpy(entity->id, id, sizeof(entity->id));
+
+    retval =
+        vccrypt_buffer_init(
+            &entity->encryption_pubkey, opts->suite->alloc_opts,
+            encryption_pubkey_size);
+    if (VCCRYPT_STATUS_SUCCESS != retval)
+    {
+        retval = VCTOOL_ERROR_GENERAL_OUT_OF_MEMORY;
+        goto free_entity;
+    }
+
+    retval =
+        vccrypt_buffer_init(
+            &entity->signing_pubkey, opts->suite->alloc_opts,
+            signing_pubkey_size);
+    if (VCCRYPT_STATUS_SUCCESS != retval)
+    {
+        retval = VCTOOL_ERROR_GENERAL_OUT_OF_MEMORY;
+        goto cleanup_encryption_pubkey;
+    }
+
+    memcpy(
+        entity->encryption_pubkey.data, encryption_pubkey,
+        entity->encryption_pubkey.size);
+    memcpy(
+        entity->signing_pubkey.data, signing_pubkey,
+        entity->signing_pubkey.size);
+
+    entity->next = opts->entities;
+    opts->entities = entity;
+
+    return VCTOOL_STATUS_SUCCESS;
+
+cleanup_encryption_pubkey:
+    dispose((disposable_t*)&entity->encryption_pubkey);
+
+free_entity:
+    free(entity);
+
+    return retval;
+}
+
+/**
+ * \brief Mix the contents of a contract plugin into the resolver version.
+ *
+ * The contents, not the path, are mixed in, so that a plugin rebuilt in place
+ * does not reuse results cached under its old contracts.
+ *
+ * \param opts      The commandline_opts instance for this plugin.
+ * \param path      The path of the plugin.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - a non-zero error code on failure.
+ */
+static int commandline_plugin_mix(commandline_opts* opts, const char* path)
+{
+    int retval, fd;
+    uint8_t buf[4096];
+    size_t read_bytes;
+
+    retval = file_open(opts->file, &fd, path, O_RDONLY, 0);
+    if (VCTOOL_STATUS_SUCCESS != retval)
+    {
+        return retval;
+    }
+
+    do
+    {
+        retval = file_read(opts->file, fd, buf, sizeof(buf), &read_bytes);
+        if (VCTOOL_STATUS_SUCCESS != retval)
+        {
+            goto close_fd;
+        }
+
+        certcache_version_mix(&opts->resolver_version, buf, read_bytes);
+    } while (read_bytes > 0);
+
+close_fd:
+    file_close(opts->file, fd);
+
+    return retval;
+}
+
+/**
+ * \brief Initialize the certificate cache in the user's home directory.
+ *
+ * If there is no home directory, the cache is disabled.
+ *
+ * \param opts      The commandline_opts instance for this cache.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - a non-zero error code on failure.
+ */
+static int commandline_certcache_init(commandline_opts* opts)
+{
+    int retval;
+    const char* home = getenv("HOME");
+
+    /* without a home directory, the cache is disabled. */
+    if (NULL == home)
+    {
+        return certcache_init(&opts->certcache, opts->suite, NULL);
+    }
+
+    /* build the cache path. */
+    size_t path_size =
+        strlen(home)
+      + 1 /* / */
+      + strlen(CERTCACHE_DEFAULT_FILENAME)
+      + 1;/* asciiz */
+    char* path = (char*)malloc(path_size);
+    if (NULL == path)
+    {
+        return VCTOOL_ERROR_GENERAL_OUT_OF_MEMORY;
+    }
+    snprintf(path, path_size, "%s/%s", home, CERTCACHE_DEFAULT_FILENAME);
+
+    /* initialize the cache. */
+    retval = certcache_init(&opts->certcache, opts->suite, path);
+
+    free(path);
+
+    return retval;
+}
+
+/**
+ * \brief Load a revocation list for this command.
+ *
+ * \param opts      The commandline_opts instance for this list.
+ * \param path      The path of the revocation list.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - a non-zero error code on failure.
+ */
+static int commandline_revocations_load(
+    commandline_opts* opts, const char* path)
+{
+    int retval;
+
+    /* allocate the revocation set. */
+    revocation_set* set = (revocation_set*)malloc(sizeof(revocation_set));
+    if (NULL == set)
+    {
+        return VCTOOL_ERROR_GENERAL_OUT_OF_MEMORY;
+    }
+
+    /* open the list. */
+    retval = revocation_set_open(set, opts->file, path);
+    if (VCTOOL_STATUS_SUCCESS != retval)
+    {
+        free(set);
+        return retval;
+    }
+
+    /* revocations change the outcome of attestation. */
+    certcache_version_mix(
+        &opts->resolver_version, &set->digest, sizeof(set->digest));
+
+    opts->revocations = set;
+
+    return VCTOOL_STATUS_SUCCESS;
+}
+
+/**
+ * \brief Start recording agent traffic for this command.
+ *
+ * \param opts      The commandline_opts instance for this recording.
+ * \param path      The path of the recording.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - a non-zero error code on failure.
+ */
+static int commandline_recorder_init(
+    commandline_opts* opts, const char* path)
+{
+    int retval;
+
+    /* allocate the recorder. */
+    agent_recorder* recorder =
+        (agent_recorder*)malloc(sizeof(agent_recorder));
+    if (NULL == recorder)
+    {
+        return VCTOOL_ERROR_GENERAL_OUT_OF_MEMORY;
+    }
+
+    /* start the recording. */
+    retval = agent_recorder_init(recorder, opts->file, path);
+    if (VCTOOL_STATUS_SUCCESS != retval)
+    {
+        free(recorder);
+        return retval;
+    }
+
+    opts->agent_recorder = recorder;
+
+    return VCTOOL_STATUS_SUCCESS;
 }
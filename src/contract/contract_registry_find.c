@@ -0,0 +1,151 @@
+/**
+ * \file contract/contract_registry_find.c
+ *
+ * \brief Find a contract in a contract registry.
+ *
+ * \copyright 2020 Velo Payments.  See License.txt for license terms.
+ */
+
+#include <cbmc/model_assert.h>
+#include <string.h>
+#include <vctool/contract.h>
+
+/* forward decls. */
+typedef struct contract_cache_slot contract_cache_slot;
+static const contract_registry_entry* contract_registry_search(
+    const contract_registry* registry, const uint8_t* key);
+
+/**
+ * \brief A per-thread cache slot for a resolved contract.
+ */
+struct contract_cache_slot
+{
+    const contract_registry* registry;
+    uint64_t generation;
+    uint8_t key[2 * CONTRACT_TYPE_SIZE];
+    const contract_registry_entry* entry;
+};
+
+/* the per-thread contract cache. */
+static _Thread_local contract_cache_slot
+contract_thread_cache[CONTRACT_THREAD_CACHE_SIZE];
+
+/**
+ * \brief Find the contract for the given transaction and artifact type.
+ *
+ * An exact match is preferred; otherwise, a contract registered for any
+ * artifact type with this transaction type is returned.  Results are cached
+ * per thread, so repeated lookups for the same type pair do not search the
+ * registry.
+ *
+ * \param registry          The registry to search.
+ * \param entry             Pointer to receive the registry entry on success.
+ * \param transaction_type  The transaction type uuid.
+ * \param artifact_type     The artifact type uuid, or NULL if unknown.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - VCTOOL_ERROR_CONTRACT_NOT_FOUND if no contract matches.
+ */
+int contract_registry_find(
+    const contract_registry* registry, const contract_registry_entry** entry,
+    const uint8_t* transaction_type, const uint8_t* artifact_type)
+{
+    uint8_t key[2 * CONTRACT_TYPE_SIZE];
+    unsigned int hash = 0;
+
+    /* parameter sanity checks. */
+    MODEL_ASSERT(NULL != registry);
+    MODEL_ASSERT(NULL != entry);
+    MODEL_ASSERT(NULL != transaction_type);
+
+    /* build the lookup key. */
+    memcpy(key, transaction_type, CONTRACT_TYPE_SIZE);
+    if (NULL != artifact_type)
+    {
+        memcpy(key + CONTRACT_TYPE_SIZE, artifact_type, CONTRACT_TYPE_SIZE);
+    }
+    else
+    {
+        memset(key + CONTRACT_TYPE_SIZE, 0, CONTRACT_TYPE_SIZE);
+    }
+
+    /* type uuids are random, so a few key bytes make a fine slot hash. */
+    hash = key[0] ^ key[7] ^ key[CONTRACT_TYPE_SIZE] ^ key[31];
+    contract_cache_slot* slot =
+        contract_thread_cache + (hash & (CONTRACT_THREAD_CACHE_SIZE - 1));
+
+    /* check the thread cache. */
+    if (slot->registry != registry
+     || slot->generation != registry->generation
+     || memcmp(slot->key, key, sizeof(key)))
+    {
+        /* cache miss: try an exact match. */
+        const contract_registry_entry* found =
+            contract_registry_search(registry, key);
+
+        /* fall back to the wildcard artifact type. */
+        if (NULL == found && NULL != artifact_type)
+        {
+            uint8_t wildcard[2 * CONTRACT_TYPE_SIZE];
+            memcpy(wildcard, key, CONTRACT_TYPE_SIZE);
+            memset(wildcard + CONTRACT_TYPE_SIZE, 0, CONTRACT_TYPE_SIZE);
+            found = contract_registry_search(registry, wildcard);
+        }
+
+        /* cache this result, including a negative result. */
+        slot->registry = registry;
+        slot->generation = registry->generation;
+        memcpy(slot->key, key, sizeof(key));
+        slot->entry = found;
+    }
+
+    /* was a contract found? */
+    if (NULL == slot->entry)
+    {
+        return VCTOOL_ERROR_CONTRACT_NOT_FOUND;
+    }
+
+    /* success. */
+    *entry = slot->entry;
+    return VCTOOL_STATUS_SUCCESS;
+}
+
+/**
+ * \brief Binary search the registry for the given key.
+ *
+ * \param registry          The registry to search.
+ * \param key               The transaction type / artifact type key.
+ *
+ * \returns the matching entry, or NULL if not found.
+ */
+static const contract_registry_entry* contract_registry_search(
+    const contract_registry* registry, const uint8_t* key)
+{
+    size_t lo = 0;
+    size_t hi = registry->count;
+
+    while (lo < hi)
+    {
+        size_t mid = lo + (hi - lo) / 2;
+        int cmp =
+            memcmp(
+                registry->entries[mid].transaction_type, key,
+                2 * CONTRACT_TYPE_SIZE);
+
+        if (0 == cmp)
+        {
+            return registry->entries + mid;
+        }
+        else if (cmp < 0)
+        {
+            lo = mid + 1;
+        }
+        else
+        {
+            hi = mid;
+        }
+    }
+
+    return NULL;
+}
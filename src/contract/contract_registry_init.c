@@ -0,0 +1,79 @@
+/**
+ * \file contract/contract_registry_init.c
+ *
+ * \brief Initialize a contract registry.
+ *
+ * \copyright 2020 Velo Payments.  See License.txt for license terms.
+ */
+
+#include <cbmc/model_assert.h>
+#include <dlfcn.h>
+#include <string.h>
+#include <vctool/contract.h>
+
+/* forward decls. */
+static void contract_registry_dispose(void* disp);
+
+/* the number of registries created by this process. */
+static uint64_t contract_registry_instances = 0;
+
+/**
+ * \brief Initialize an empty contract registry.
+ *
+ * \param registry      The registry to initialize.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - a non-zero error code on failure.
+ */
+int contract_registry_init(contract_registry* registry)
+{
+    /* parameter sanity checks. */
+    MODEL_ASSERT(NULL != registry);
+
+    /* clear the registry structure. */
+    memset(registry, 0, sizeof(contract_registry));
+
+    /* set the disposer. */
+    registry->hdr.dispose = &contract_registry_dispose;
+
+    /* each registry gets its own generation range, so that a thread cache
+     * entry for a disposed registry never matches a new registry. */
+    registry->generation =
+        __atomic_add_fetch(&contract_registry_instances, 1, __ATOMIC_RELAXED)
+            << 32;
+
+    /* success. */
+    return VCTOOL_STATUS_SUCCESS;
+}
+
+/**
+ * \brief Dispose of a contract registry.
+ *
+ * \param disp          The registry to dispose.
+ */
+static void contract_registry_dispose(void* disp)
+{
+    contract_registry* registry = (contract_registry*)disp;
+
+    /* free the entries. */
+    if (NULL != registry->entries)
+    {
+        free(registry->entries);
+    }
+
+    /* unload plugins. */
+    for (size_t i = 0; i < registry->plugin_count; ++i)
+    {
+        dlclose(registry->plugins[i]);
+    }
+
+    /* free the plugin handle array. */
+    if (NULL != registry->plugins)
+    {
+        free(registry->plugins);
+    }
+
+    /* clear the structure. */
+    memset(registry, 0, sizeof(contract_registry));
+}
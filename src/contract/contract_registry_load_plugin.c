@@ -0,0 +1,82 @@
+/**
+ * \file contract/contract_registry_load_plugin.c
+ *
+ * \brief Load a site-specific contract plugin.
+ *
+ * \copyright 2020 Velo Payments.  See License.txt for license terms.
+ */
+
+#include <cbmc/model_assert.h>
+#include <dlfcn.h>
+#include <stdio.h>
+#include <vctool/contract.h>
+
+/**
+ * \brief Load a site-specific contract plugin into this registry.
+ *
+ * \param registry      The registry to which contracts are added.
+ * \param path          Path to the plugin shared object.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - VCTOOL_ERROR_CONTRACT_PLUGIN_LOAD if the plugin could not be loaded.
+ *      - VCTOOL_ERROR_CONTRACT_PLUGIN_SYMBOL if the plugin has no init
+ *        function.
+ *      - a non-zero error code returned by the plugin init function.
+ */
+int contract_registry_load_plugin(
+    contract_registry* registry, const char* path)
+{
+    int retval;
+    void* handle;
+    contract_plugin_init_fn init_fn;
+
+    /* parameter sanity checks. */
+    MODEL_ASSERT(NULL != registry);
+    MODEL_ASSERT(NULL != path);
+
+    /* grow the plugin handle array. */
+    void** plugins =
+        (void**)realloc(
+            registry->plugins, (registry->plugin_count + 1) * sizeof(void*));
+    if (NULL == plugins)
+    {
+        retval = VCTOOL_ERROR_GENERAL_OUT_OF_MEMORY;
+        goto done;
+    }
+    registry->plugins = plugins;
+
+    /* load the plugin. */
+    handle = dlopen(path, RTLD_NOW | RTLD_LOCAL);
+    if (NULL == handle)
+    {
+        fprintf(stderr, "Error loading contract plugin: %s\n", dlerror());
+        retval = VCTOOL_ERROR_CONTRACT_PLUGIN_LOAD;
+        goto done;
+    }
+
+    /* look up the init function. */
+    *(void**)&init_fn = dlsym(handle, CONTRACT_PLUGIN_INIT_SYMBOL);
+    if (NULL == init_fn)
+    {
+        fprintf(
+            stderr, "Contract plugin %s does not export %s.\n", path,
+            CONTRACT_PLUGIN_INIT_SYMBOL);
+        retval = VCTOOL_ERROR_CONTRACT_PLUGIN_SYMBOL;
+        goto close_handle;
+    }
+
+    /* the registry owns the handle from here on, since entries registered by
+     * the plugin point into it, even if init fails part way through. */
+    registry->plugins[registry->plugin_count++] = handle;
+
+    /* let the plugin register its contracts. */
+    retval = init_fn(registry);
+    goto done;
+
+close_handle:
+    dlclose(handle);
+
+done:
+    return retval;
+}
@@ -0,0 +1,108 @@
+/**
+ * \file contract/contract_registry_register.c
+ *
+ * \brief Register a contract with a contract registry.
+ *
+ * \copyright 2020 Velo Payments.  See License.txt for license terms.
+ */
+
+#include <cbmc/model_assert.h>
+#include <string.h>
+#include <vctool/contract.h>
+
+/**
+ * \brief Register a contract for the given transaction and artifact type.
+ *
+ * \param registry          The registry to which this contract is added.
+ * \param transaction_type  The transaction type uuid.
+ * \param artifact_type     The artifact type uuid, or NULL to register this
+ *                          contract for any artifact type.
+ * \param contract_fn       The contract function.
+ * \param context           User context passed to the contract function.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - VCTOOL_ERROR_CONTRACT_DUPLICATE if a contract is already registered
+ *        for this type pair.
+ *      - VCTOOL_ERROR_GENERAL_OUT_OF_MEMORY if an allocation failed.
+ */
+int contract_registry_register(
+    contract_registry* registry, const uint8_t* transaction_type,
+    const uint8_t* artifact_type, vccert_contract_fn_t contract_fn,
+    void* context)
+{
+    contract_registry_entry entry;
+    size_t lo, hi;
+
+    /* parameter sanity checks. */
+    MODEL_ASSERT(NULL != registry);
+    MODEL_ASSERT(NULL != transaction_type);
+    MODEL_ASSERT(NULL != contract_fn);
+
+    /* build the new entry.  A NULL artifact type is the all-zero wildcard. */
+    memset(&entry, 0, sizeof(entry));
+    memcpy(entry.transaction_type, transaction_type, CONTRACT_TYPE_SIZE);
+    if (NULL != artifact_type)
+    {
+        memcpy(entry.artifact_type, artifact_type, CONTRACT_TYPE_SIZE);
+    }
+    entry.contract_fn = contract_fn;
+    entry.context = context;
+
+    /* find the insertion point.  The two type fields are adjacent, so they are
+     * compared as a single 32 byte key. */
+    lo = 0;
+    hi = registry->count;
+    while (lo < hi)
+    {
+        size_t mid = lo + (hi - lo) / 2;
+        int cmp =
+            memcmp(
+                registry->entries[mid].transaction_type,
+                entry.transaction_type, 2 * CONTRACT_TYPE_SIZE);
+
+        if (0 == cmp)
+        {
+            return VCTOOL_ERROR_CONTRACT_DUPLICATE;
+        }
+        else if (cmp < 0)
+        {
+            lo = mid + 1;
+        }
+        else
+        {
+            hi = mid;
+        }
+    }
+
+    /* grow the entry array if needed. */
+    if (registry->count == registry->reserved)
+    {
+        size_t new_reserved =
+            (0 == registry->reserved) ? 16 : 2 * registry->reserved;
+        contract_registry_entry* new_entries =
+            (contract_registry_entry*)realloc(
+                registry->entries,
+                new_reserved * sizeof(contract_registry_entry));
+        if (NULL == new_entries)
+        {
+            return VCTOOL_ERROR_GENERAL_OUT_OF_MEMORY;
+        }
+
+        registry->entries = new_entries;
+        registry->reserved = new_reserved;
+    }
+
+    /* insert the entry, keeping the array sorted. */
+    memmove(
+        registry->entries + lo + 1, registry->entries + lo,
+        (registry->count - lo) * sizeof(contract_registry_entry));
+    memcpy(registry->entries + lo, &entry, sizeof(entry));
+    ++registry->count;
+
+    /* invalidate thread caches for this registry. */
+    ++registry->generation;
+
+    /* success. */
+    return VCTOOL_STATUS_SUCCESS;
+}
@@ -0,0 +1,92 @@
+/**
+ * \file contract/contract_registry_register_builtins.c
+ *
+ * \brief Register the built-in contracts with a contract registry.
+ *
+ * \copyright 2020 Velo Payments.  See License.txt for license terms.
+ */
+
+#include <cbmc/model_assert.h>
+#include <string.h>
+#include <vccert/certificate_types.h>
+#include <vctool/contract.h>
+
+/* forward decls. */
+static bool contract_builtin_schema(
+    vccert_parser_context_t* parser, void* context);
+
+/* the certificate types created by this tool. */
+static const uint8_t* const contract_builtin_types[] = {
+    vccert_certificate_type_uuid_private_entity,
+    vccert_certificate_type_uuid_public_entity,
+};
+
+/**
+ * \brief Register the built-in contracts with a contract registry.
+ *
+ * Each certificate type created by this tool has a built-in contract, for any
+ * artifact type, which holds if the certificate matches the schema of its
+ * type.  The schemas are built here, once, with the key and signature sizes
+ * of the given suite.  Plugins add contracts for other transaction types.
+ *
+ * \param registry      The registry to which contracts are added.
+ * \param suite         The crypto suite for this registry.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - a non-zero error code returned by contract_registry_register.
+ */
+int contract_registry_register_builtins(
+    contract_registry* registry, const vccrypt_suite_options_t* suite)
+{
+    int retval;
+    certschema_sizes sizes;
+
+    /* parameter sanity checks. */
+    MODEL_ASSERT(NULL != registry);
+    MODEL_ASSERT(NULL != suite);
+
+    /* build the schemas once; every built-in contract checks against them. */
+    certschema_sizes_init(&sizes, suite);
+    certschema_init(&registry->schema, &sizes);
+
+    size_t count =
+        sizeof(contract_builtin_types) / sizeof(contract_builtin_types[0]);
+    for (size_t i = 0; i < count; ++i)
+    {
+        retval =
+            contract_registry_register(
+                registry, contract_builtin_types[i], NULL,
+                &contract_builtin_schema, &registry->schema);
+        if (VCTOOL_STATUS_SUCCESS != retval)
+        {
+            return retval;
+        }
+    }
+
+    return VCTOOL_STATUS_SUCCESS;
+}
+
+/**
+ * \brief Check a certificate against the schema of its type.
+ *
+ * The registry finds this contract by the certificate's type, so the schema
+ * of that type is the one to check.
+ *
+ * \param parser        The parser for the certificate being attested.
+ * \param context       The schemas of the registry.
+ *
+ * \returns true if the certificate matches the schema of its type.
+ */
+static bool contract_builtin_schema(
+    vccert_parser_context_t* parser, void* context)
+{
+    const certschema* schema = (const certschema*)context;
+    const certschema_type* type;
+    uint16_t field;
+
+    return
+        VCTOOL_STATUS_SUCCESS ==
+            certschema_validate(
+                schema, parser->cert, parser->size, &type, &field);
+}
@@ -0,0 +1,92 @@
+/**
+ * \file contract/contract_registry_resolve.c
+ *
+ * \brief Contract resolver for certificate parser options.
+ *
+ * \copyright 2020 Velo Payments.  See License.txt for license terms.
+ */
+
+#include <cbmc/model_assert.h>
+#include <vccert/fields.h>
+#include <vctool/commandline.h>
+#include <vctool/contract.h>
+#include <vpr/parameters.h>
+
+/* forward decls. */
+static void contract_closure_dispose(void* disp);
+
+/**
+ * \brief Contract resolver for certificate parser options.
+ *
+ * The parser options context must be the commandline_opts for this command.
+ *
+ * \param options           The parser options.
+ * \param parser            The parser for the transaction being attested.
+ * \param type_id           The transaction type uuid.
+ * \param artifact_id       The artifact id.
+ * \param closure           The closure to populate with the contract.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - VCTOOL_ERROR_CONTRACT_NOT_FOUND if no contract matches.
+ */
+int contract_registry_resolve(
+    void* options, void* parser, const uint8_t* type_id,
+    const uint8_t* UNUSED(artifact_id), vccert_contract_closure_t* closure)
+{
+    int retval;
+    const contract_registry_entry* entry;
+    const uint8_t* artifact_type = NULL;
+    size_t artifact_type_size = 0U;
+
+    /* parameter sanity checks. */
+    MODEL_ASSERT(NULL != options);
+    MODEL_ASSERT(NULL != parser);
+    MODEL_ASSERT(NULL != type_id);
+    MODEL_ASSERT(NULL != closure);
+
+    /* get the registry from the command-line options. */
+    vccert_parser_options_t* parser_options =
+        (vccert_parser_options_t*)options;
+    commandline_opts* opts = (commandline_opts*)parser_options->context;
+    MODEL_ASSERT(PROP_VALID_COMMANDLINE_OPTS(opts));
+
+    /* the artifact type is optional; without it, only wildcard contracts for
+     * this transaction type can match. */
+    if (VCCERT_STATUS_SUCCESS !=
+            vccert_parser_find_short(
+                (vccert_parser_context_t*)parser,
+                VCCERT_FIELD_TYPE_ARTIFACT_TYPE, &artifact_type,
+                &artifact_type_size)
+     || CONTRACT_TYPE_SIZE != artifact_type_size)
+    {
+        artifact_type = NULL;
+    }
+
+    /* look up the contract. */
+    retval =
+        contract_registry_find(
+            &opts->contracts, &entry, type_id, artifact_type);
+    if (VCTOOL_STATUS_SUCCESS != retval)
+    {
+        return retval;
+    }
+
+    /* populate the closure.  The registry owns the contract context. */
+    closure->hdr.dispose = &contract_closure_dispose;
+    closure->contract_fn = entry->contract_fn;
+    closure->context = entry->context;
+
+    /* success. */
+    return VCTOOL_STATUS_SUCCESS;
+}
+
+/**
+ * \brief Dispose of a contract closure.
+ *
+ * \param disp          The closure to dispose.
+ */
+static void contract_closure_dispose(void* UNUSED(disp))
+{
+    /* do nothing; the registry owns the closure context. */
+}
@@ -0,0 +1,203 @@
+/**
+ * \file crc32c/crc32c.c
+ *
+ * \brief Compute CRC-32C checksums.
+ *
+ * \copyright 2020 Velo Payments.  See License.txt for license terms.
+ */
+
+#include <cbmc/model_assert.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <string.h>
+#include <vctool/crc32c.h>
+
+#if defined(__x86_64__)
+# include <nmmintrin.h>
+#elif defined(__ARM_FEATURE_CRC32)
+# include <arm_acle.h>
+#endif
+
+/* the reflected CRC-32C polynomial. */
+#define CRC32C_POLY                                     0x82f63b78U
+
+/* slicing-by-8 tables; table[k][b] is the crc of b followed by k zeroes. */
+static uint32_t crc32c_table[8][256];
+static bool crc32c_hardware;
+static pthread_once_t crc32c_once = PTHREAD_ONCE_INIT;
+
+/* forward decls. */
+static void crc32c_setup(void);
+static uint32_t crc32c_software(uint32_t crc, const uint8_t* p, size_t size);
+#if defined(__x86_64__) || defined(__ARM_FEATURE_CRC32)
+static uint32_t crc32c_instruction(
+    uint32_t crc, const uint8_t* p, size_t size);
+#endif
+
+/**
+ * \brief Extend a CRC-32C checksum with more data.
+ *
+ * Start with a crc of 0; the checksum of data split across several calls is
+ * the same as the checksum of the whole.
+ *
+ * \param crc           The checksum of the preceding data, or 0.
+ * \param data          The data to checksum.
+ * \param size          The size of the data.
+ *
+ * \returns the checksum of the preceding data followed by this data.
+ */
+uint32_t crc32c(uint32_t crc, const void* data, size_t size)
+{
+    /* parameter sanity checks. */
+    MODEL_ASSERT(0 == size || NULL != data);
+
+    pthread_once(&crc32c_once, &crc32c_setup);
+
+    /* the register holds the inverted crc. */
+    crc = ~crc;
+
+#if defined(__x86_64__) || defined(__ARM_FEATURE_CRC32)
+    if (crc32c_hardware)
+    {
+        return ~crc32c_instruction(crc, (const uint8_t*)data, size);
+    }
+#endif
+
+    return ~crc32c_software(crc, (const uint8_t*)data, size);
+}
+
+/**
+ * \brief Detect the checksum instruction and build the fallback tables.
+ */
+static void crc32c_setup(void)
+{
+    for (uint32_t b = 0; b < 256; ++b)
+    {
+        uint32_t crc = b;
+        for (int bit = 0; bit < 8; ++bit)
+        {
+            crc = (crc >> 1) ^ (CRC32C_POLY & (0U - (crc & 1U)));
+        }
+
+        crc32c_table[0][b] = crc;
+    }
+
+    for (uint32_t b = 0; b < 256; ++b)
+    {
+        for (int k = 1; k < 8; ++k)
+        {
+            uint32_t prev = crc32c_table[k - 1][b];
+            crc32c_table[k][b] = (prev >> 8) ^ crc32c_table[0][prev & 0xff];
+        }
+    }
+
+#if defined(__x86_64__)
+    crc32c_hardware = __builtin_cpu_supports("sse4.2");
+#elif defined(__ARM_FEATURE_CRC32)
+    crc32c_hardware = true;
+#endif
+}
+
+/**
+ * \brief Update an inverted crc eight bytes at a time using table lookups.
+ *
+ * \param crc           The inverted crc.
+ * \param p             The data.
+ * \param size          The size of the data.
+ *
+ * \returns the updated inverted crc.
+ */
+static uint32_t crc32c_software(uint32_t crc, const uint8_t* p, size_t size)
+{
+    while (size >= 8)
+    {
+        uint32_t lo =
+            crc ^ ((uint32_t)p[0] | (uint32_t)p[1] << 8
+                 | (uint32_t)p[2] << 16 | (uint32_t)p[3] << 24);
+
+        crc =
+            crc32c_table[7][lo & 0xff]
+          ^ crc32c_table[6][(lo >> 8) & 0xff]
+          ^ crc32c_table[5][(lo >> 16) & 0xff]
+          ^ crc32c_table[4][lo >> 24]
+          ^ crc32c_table[3][p[4]]
+          ^ crc32c_table[2][p[5]]
+          ^ crc32c_table[1][p[6]]
+          ^ crc32c_table[0][p[7]];
+
+        p += 8;
+        size -= 8;
+    }
+
+    while (size-- > 0)
+    {
+        crc = (crc >> 8) ^ crc32c_table[0][(crc ^ *p++) & 0xff];
+    }
+
+    return crc;
+}
+
+#if defined(__x86_64__)
+/**
+ * \brief Update an inverted crc using the SSE4.2 crc32 instruction.
+ *
+ * \param crc           The inverted crc.
+ * \param p             The data.
+ * \param size          The size of the data.
+ *
+ * \returns the updated inverted crc.
+ */
+__attribute__((target("sse4.2")))
+static uint32_t crc32c_instruction(
+    uint32_t crc, const uint8_t* p, size_t size)
+{
+    uint64_t crc64 = crc;
+    uint64_t word;
+
+    while (size >= 8)
+    {
+        memcpy(&word, p, sizeof(word));
+        crc64 = _mm_crc32_u64(crc64, word);
+        p += 8;
+        size -= 8;
+    }
+
+    crc = (uint32_t)crc64;
+    while (size-- > 0)
+    {
+        crc = _mm_crc32_u8(crc, *p++);
+    }
+
+    return crc;
+}
+#elif defined(__ARM_FEATURE_CRC32)
+/**
+ * \brief Update an inverted crc using the ARM crc32c instructions.
+ *
+ * \param crc           The inverted crc.
+ * \param p             The data.
+ * \param size          The size of the data.
+ *
+ * \returns the updated inverted crc.
+ */
+static uint32_t crc32c_instruction(
+    uint32_t crc, const uint8_t* p, size_t size)
+{
+    uint64_t word;
+
+    while (size >= 8)
+    {
+        memcpy(&word, p, sizeof(word));
+        crc = __crc32cd(crc, word);
+        p += 8;
+        size -= 8;
+    }
+
+    while (size-- > 0)
+    {
+        crc = __crc32cb(crc, *p++);
+    }
+
+    return crc;
+}
+#endif
@@ -0,0 +1,51 @@
+/**
+ * \file extsort/extsort_add.c
+ *
+ * \brief Add a record to an external merge sort.
+ *
+ * \copyright 2020 Velo Payments.  See License.txt for license terms.
+ */
+
+#include <cbmc/model_assert.h>
+#include <string.h>
+#include <vctool/extsort.h>
+
+/**
+ * \brief Add a record to an external merge sort.
+ *
+ * If the buffer is full, the buffered records are first sorted and spilled
+ * to runs.  Records may not be added once the sort is finished.
+ *
+ * \param sorter        The sorter.
+ * \param record        The record_size byte record to copy.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - a non-zero error code if the buffer could not be spilled.
+ */
+int extsort_add(extsort* sorter, const void* record)
+{
+    int retval;
+
+    /* parameter sanity checks. */
+    MODEL_ASSERT(NULL != sorter);
+    MODEL_ASSERT(NULL != sorter->buffer);
+    MODEL_ASSERT(NULL != record);
+
+    /* spill a full buffer. */
+    if (sorter->count == sorter->capacity)
+    {
+        retval = extsort_sort_chunks(sorter, true);
+        if (VCTOOL_STATUS_SUCCESS != retval)
+        {
+            return retval;
+        }
+    }
+
+    memcpy(
+        sorter->buffer + sorter->count * sorter->record_size, record,
+        sorter->record_size);
+    ++sorter->count;
+
+    return VCTOOL_STATUS_SUCCESS;
+}
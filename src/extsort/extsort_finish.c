@@ -0,0 +1,279 @@
+/**
+ * \file extsort/extsort_finish.c
+ *
+ * \brief Merge the runs of an external merge sort.
+ *
+ * \copyright 2020 Velo Payments.  See License.txt for license terms.
+ */
+
+#include <cbmc/model_assert.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vctool/extsort.h>
+
+/* forward decls. */
+static int extsort_merge_memory(
+    extsort* sorter, extsort_output_fn output, void* context);
+static int extsort_merge_runs(
+    extsort* sorter, size_t count, extsort_output_fn output, void* context);
+
+/**
+ * \brief Finish an external merge sort, passing every record to output in
+ * sorted order.
+ *
+ * Equal keys are not merged; output may skip duplicates if needed.  Runs are
+ * removed as they are merged.
+ *
+ * \param sorter        The sorter.
+ * \param output        The function which receives each sorted record.
+ * \param context       The user context passed to output.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - VCTOOL_ERROR_EXTSORT_BAD_RUN if a run was truncated.
+ *      - VCTOOL_ERROR_GENERAL_OUT_OF_MEMORY if an allocation failed.
+ *      - a non-zero error code returned by output or the file layer.
+ */
+int extsort_finish(extsort* sorter, extsort_output_fn output, void* context)
+{
+    int retval;
+
+    /* parameter sanity checks. */
+    MODEL_ASSERT(NULL != sorter);
+    MODEL_ASSERT(NULL != sorter->buffer);
+    MODEL_ASSERT(NULL != output);
+
+    /* if nothing was spilled, merge the sorted chunks in memory. */
+    if (0 == sorter->run_count)
+    {
+        retval = extsort_sort_chunks(sorter, false);
+        if (VCTOOL_STATUS_SUCCESS != retval)
+        {
+            return retval;
+        }
+
+        retval = extsort_merge_memory(sorter, output, context);
+        sorter->count = 0;
+        sorter->chunk_count = 0;
+
+        return retval;
+    }
+
+    /* otherwise, spill the remainder so that every record is in a run. */
+    if (sorter->count > 0)
+    {
+        retval = extsort_sort_chunks(sorter, true);
+        if (VCTOOL_STATUS_SUCCESS != retval)
+        {
+            return retval;
+        }
+    }
+
+    /* the record buffer's share of the budget now goes to read buffers. */
+    free(sorter->buffer);
+    sorter->buffer = NULL;
+    sorter->capacity = 0;
+
+    /* the fan-in is limited by the number of read buffers in the budget. */
+    size_t fan_in = sorter->memory_budget / EXTSORT_MIN_BLOCK_SIZE;
+    fan_in = (fan_in > 1) ? fan_in - 1 : 0;
+    if (fan_in > EXTSORT_MAX_FAN_IN)
+    {
+        fan_in = EXTSORT_MAX_FAN_IN;
+    }
+    if (fan_in < 2)
+    {
+        fan_in = 2;
+    }
+
+    /* merge the oldest runs into a new run until one pass is enough. */
+    while (sorter->run_count > fan_in)
+    {
+        extsort_run_writer writer;
+        memset(&writer, 0, sizeof(writer));
+        writer.sorter = sorter;
+        writer.buffer_size =
+            sorter->memory_budget / (fan_in + 1) / sorter->record_size
+                * sorter->record_size;
+        if (writer.buffer_size < sorter->record_size)
+        {
+            writer.buffer_size = sorter->record_size;
+        }
+
+        writer.buffer = (uint8_t*)malloc(writer.buffer_size);
+        if (NULL == writer.buffer)
+        {
+            return VCTOOL_ERROR_GENERAL_OUT_OF_MEMORY;
+        }
+
+        retval = extsort_run_create(sorter, &writer.fd);
+        if (VCTOOL_STATUS_SUCCESS != retval)
+        {
+            free(writer.buffer);
+            return retval;
+        }
+
+        retval =
+            extsort_merge_runs(sorter, fan_in, &extsort_run_write, &writer);
+        if (VCTOOL_STATUS_SUCCESS == retval)
+        {
+            retval = extsort_run_flush(&writer);
+        }
+
+        int close_retval = file_close(sorter->f, writer.fd);
+        if (VCTOOL_STATUS_SUCCESS == retval)
+        {
+            retval = close_retval;
+        }
+
+        free(writer.buffer);
+
+        if (VCTOOL_STATUS_SUCCESS != retval)
+        {
+            return retval;
+        }
+    }
+
+    /* the final pass goes to the caller. */
+    return extsort_merge_runs(sorter, sorter->run_count, output, context);
+}
+
+/**
+ * \brief Merge the sorted chunks of the buffer.
+ *
+ * \param sorter        The sorter.
+ * \param output        The function which receives each sorted record.
+ * \param context       The user context passed to output.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - VCTOOL_ERROR_GENERAL_OUT_OF_MEMORY if an allocation failed.
+ *      - a non-zero error code returned by output.
+ */
+static int extsort_merge_memory(
+    extsort* sorter, extsort_output_fn output, void* context)
+{
+    int retval;
+
+    extsort_source* sources =
+        (extsort_source*)calloc(sorter->chunk_count, sizeof(extsort_source));
+    if (NULL == sources)
+    {
+        return VCTOOL_ERROR_GENERAL_OUT_OF_MEMORY;
+    }
+
+    size_t begin = 0;
+    for (unsigned i = 0; i < sorter->chunk_count; ++i)
+    {
+        sources[i].next = sorter->buffer + begin * sorter->record_size;
+        sources[i].end =
+            sorter->buffer + sorter->chunk_ends[i] * sorter->record_size;
+        sources[i].fd = -1;
+        begin = sorter->chunk_ends[i];
+    }
+
+    retval =
+        extsort_merge(sorter, sources, sorter->chunk_count, output, context);
+
+    free(sources);
+
+    return retval;
+}
+
+/**
+ * \brief Merge the oldest runs, then remove them.
+ *
+ * \param sorter        The sorter.
+ * \param count         The number of runs to merge.
+ * \param output        The function which receives each sorted record.
+ * \param context       The user context passed to output.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - VCTOOL_ERROR_EXTSORT_BAD_RUN if a run was truncated.
+ *      - VCTOOL_ERROR_GENERAL_OUT_OF_MEMORY if an allocation failed.
+ *      - a non-zero error code returned by output or the file layer.
+ */
+static int extsort_merge_runs(
+    extsort* sorter, size_t count, extsort_output_fn output, void* context)
+{
+    int retval = VCTOOL_STATUS_SUCCESS;
+    size_t opened = 0;
+
+    extsort_source* sources =
+        (extsort_source*)calloc(count, sizeof(extsort_source));
+    if (NULL == sources)
+    {
+        return VCTOOL_ERROR_GENERAL_OUT_OF_MEMORY;
+    }
+
+    /* one read buffer per run, plus one for the output. */
+    size_t block =
+        sorter->memory_budget / (count + 1) / sorter->record_size
+            * sorter->record_size;
+    if (block < sorter->record_size)
+    {
+        block = sorter->record_size;
+    }
+
+    /* open each run and fill its first block. */
+    for (; opened < count; ++opened)
+    {
+        extsort_source* source = sources + opened;
+
+        source->buffer = (uint8_t*)malloc(block);
+        if (NULL == source->buffer)
+        {
+            retval = VCTOOL_ERROR_GENERAL_OUT_OF_MEMORY;
+            goto cleanup_sources;
+        }
+
+        source->buffer_size = block;
+        source->next = source->end = source->buffer;
+
+        retval =
+            file_open(
+                sorter->f, &source->fd, sorter->runs[opened], O_RDONLY, 0);
+        if (VCTOOL_STATUS_SUCCESS != retval)
+        {
+            free(source->buffer);
+            goto cleanup_sources;
+        }
+
+        retval = extsort_source_fill(sorter, source);
+        if (VCTOOL_STATUS_SUCCESS != retval)
+        {
+            ++opened;
+            goto cleanup_sources;
+        }
+    }
+
+    retval = extsort_merge(sorter, sources, count, output, context);
+
+cleanup_sources:
+    for (size_t i = 0; i < opened; ++i)
+    {
+        file_close(sorter->f, sources[i].fd);
+        free(sources[i].buffer);
+    }
+
+    free(sources);
+
+    /* a merged run is no longer needed. */
+    if (VCTOOL_STATUS_SUCCESS == retval)
+    {
+        for (size_t i = 0; i < count; ++i)
+        {
+            file_unlink(sorter->f, sorter->runs[i]);
+            free(sorter->runs[i]);
+        }
+
+        sorter->run_count -= count;
+        memmove(
+            sorter->runs, sorter->runs + count,
+            sorter->run_count * sizeof(char*));
+    }
+
+    return retval;
+}
@@ -0,0 +1,121 @@
+/**
+ * \file extsort/extsort_init.c
+ *
+ * \brief Initialize an external merge sort.
+ *
+ * \copyright 2020 Velo Payments.  See License.txt for license terms.
+ */
+
+#include <cbmc/model_assert.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <vctool/extsort.h>
+
+/* forward decls. */
+static void extsort_dispose(void* disp);
+
+/**
+ * \brief Initialize an external merge sort.
+ *
+ * \param sorter        The sorter to initialize.
+ * \param f             The file abstraction layer used for runs.
+ * \param temp_dir      The directory in which runs are created.
+ * \param record_size   The size of each record.
+ * \param key_size      The number of leading record bytes compared with
+ *                      memcmp; at most record_size.
+ * \param memory_budget The memory budget in bytes, which must hold at least
+ *                      one record.
+ * \param threads       The number of sort threads, or 0 to use one per
+ *                      online processor.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - VCTOOL_ERROR_GENERAL_OUT_OF_MEMORY if an allocation failed.
+ */
+int extsort_init(
+    extsort* sorter, file* f, const char* temp_dir, size_t record_size,
+    size_t key_size, size_t memory_budget, unsigned threads)
+{
+    /* parameter sanity checks. */
+    MODEL_ASSERT(NULL != sorter);
+    MODEL_ASSERT(PROP_FILE_VALID(f));
+    MODEL_ASSERT(NULL != temp_dir);
+    MODEL_ASSERT(record_size > 0);
+    MODEL_ASSERT(key_size > 0 && key_size <= record_size);
+    MODEL_ASSERT(memory_budget >= record_size);
+
+    /* clear the sorter. */
+    memset(sorter, 0, sizeof(extsort));
+
+    /* default to one thread per processor. */
+    if (0 == threads)
+    {
+        long online = sysconf(_SC_NPROCESSORS_ONLN);
+        threads = (online > 0) ? (unsigned)online : 1;
+    }
+
+    sorter->temp_dir = strdup(temp_dir);
+    if (NULL == sorter->temp_dir)
+    {
+        goto fail;
+    }
+
+    sorter->capacity = memory_budget / record_size;
+    sorter->buffer = (uint8_t*)malloc(sorter->capacity * record_size);
+    if (NULL == sorter->buffer)
+    {
+        goto cleanup_temp_dir;
+    }
+
+    sorter->chunk_ends = (size_t*)calloc(threads, sizeof(size_t));
+    if (NULL == sorter->chunk_ends)
+    {
+        goto cleanup_buffer;
+    }
+
+    sorter->hdr.dispose = &extsort_dispose;
+    sorter->f = f;
+    sorter->record_size = record_size;
+    sorter->key_size = key_size;
+    sorter->memory_budget = memory_budget;
+    sorter->threads = threads;
+
+    /* success. */
+    return VCTOOL_STATUS_SUCCESS;
+
+cleanup_buffer:
+    free(sorter->buffer);
+
+cleanup_temp_dir:
+    free(sorter->temp_dir);
+
+fail:
+    memset(sorter, 0, sizeof(extsort));
+
+    return VCTOOL_ERROR_GENERAL_OUT_OF_MEMORY;
+}
+
+/**
+ * \brief Dispose of an external merge sort, removing any runs left over.
+ *
+ * \param disp          The sorter to dispose.
+ */
+static void extsort_dispose(void* disp)
+{
+    extsort* sorter = (extsort*)disp;
+
+    for (size_t i = 0; i < sorter->run_count; ++i)
+    {
+        file_unlink(sorter->f, sorter->runs[i]);
+        free(sorter->runs[i]);
+    }
+
+    free(sorter->runs);
+    free(sorter->chunk_ends);
+    free(sorter->buffer);
+    free(sorter->temp_dir);
+
+    /* clear the sorter. */
+    memset(sorter, 0, sizeof(extsort));
+}
@@ -0,0 +1,189 @@
+/**
+ * \file extsort/extsort_merge.c
+ *
+ * \brief Merge sorted sources with a loser tree.
+ *
+ * \copyright 2020 Velo Payments.  See License.txt for license terms.
+ */
+
+#include <cbmc/model_assert.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vctool/extsort.h>
+
+/* forward decls. */
+static bool extsort_source_less(
+    const extsort* sorter, const extsort_source* sources, size_t lhs,
+    size_t rhs);
+static size_t extsort_tree_build(
+    const extsort* sorter, const extsort_source* sources, size_t count,
+    size_t* tree, size_t node);
+
+/**
+ * \brief Merge sorted sources with a loser tree.
+ *
+ * tree[0] holds the source with the smallest record, and every other node
+ * holds the source which lost the match played at that node.  The leaves are
+ * the implicit nodes count through 2 * count - 1, so only the path from the
+ * winner's leaf to the root is replayed after each record.
+ *
+ * \param sorter        The sorter.
+ * \param sources       The sources to merge.
+ * \param count         The number of sources.
+ * \param output        The function which receives each sorted record.
+ * \param context       The user context passed to output.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - VCTOOL_ERROR_EXTSORT_BAD_RUN if a run was truncated.
+ *      - VCTOOL_ERROR_GENERAL_OUT_OF_MEMORY if an allocation failed.
+ *      - a non-zero error code returned by output or the file layer.
+ */
+int extsort_merge(
+    extsort* sorter, extsort_source* sources, size_t count,
+    extsort_output_fn output, void* context)
+{
+    int retval = VCTOOL_STATUS_SUCCESS;
+
+    /* parameter sanity checks. */
+    MODEL_ASSERT(NULL != sorter);
+    MODEL_ASSERT(0 == count || NULL != sources);
+    MODEL_ASSERT(NULL != output);
+
+    if (0 == count)
+    {
+        return VCTOOL_STATUS_SUCCESS;
+    }
+
+    size_t* tree = (size_t*)malloc(count * sizeof(size_t));
+    if (NULL == tree)
+    {
+        return VCTOOL_ERROR_GENERAL_OUT_OF_MEMORY;
+    }
+
+    /* play the initial tournament. */
+    tree[0] =
+        (count > 1) ? extsort_tree_build(sorter, sources, count, tree, 1) : 0;
+
+    for (;;)
+    {
+        size_t winner = tree[0];
+        extsort_source* source = sources + winner;
+
+        /* every source is exhausted once the winner is. */
+        if (source->next == source->end)
+        {
+            break;
+        }
+
+        retval = output(context, source->next);
+        if (VCTOOL_STATUS_SUCCESS != retval)
+        {
+            break;
+        }
+
+        /* advance the winner, refilling its buffer if needed. */
+        source->next += sorter->record_size;
+        if (source->next == source->end)
+        {
+            retval = extsort_source_fill(sorter, source);
+            if (VCTOOL_STATUS_SUCCESS != retval)
+            {
+                break;
+            }
+        }
+
+        /* replay the winner's path to the root. */
+        for (size_t node = (winner + count) / 2; node > 0; node /= 2)
+        {
+            if (extsort_source_less(sorter, sources, tree[node], winner))
+            {
+                size_t tmp = tree[node];
+                tree[node] = winner;
+                winner = tmp;
+            }
+        }
+
+        tree[0] = winner;
+    }
+
+    free(tree);
+
+    return retval;
+}
+
+/**
+ * \brief Compare the next records of two sources.
+ *
+ * Exhausted sources sort after every record, and ties go to the lower source
+ * so that the merge order is deterministic.
+ *
+ * \param sorter        The sorter.
+ * \param sources       The sources.
+ * \param lhs           The left hand source.
+ * \param rhs           The right hand source.
+ *
+ * \returns true if lhs comes before rhs.
+ */
+static bool extsort_source_less(
+    const extsort* sorter, const extsort_source* sources, size_t lhs,
+    size_t rhs)
+{
+    const extsort_source* left = sources + lhs;
+    const extsort_source* right = sources + rhs;
+
+    if (left->next == left->end)
+    {
+        return false;
+    }
+
+    if (right->next == right->end)
+    {
+        return true;
+    }
+
+    int cmp = memcmp(left->next, right->next, sorter->key_size);
+    if (0 != cmp)
+    {
+        return cmp < 0;
+    }
+
+    return lhs < rhs;
+}
+
+/**
+ * \brief Play the initial matches of the subtree rooted at node.
+ *
+ * \param sorter        The sorter.
+ * \param sources       The sources.
+ * \param count         The number of sources.
+ * \param tree          The loser tree.
+ * \param node          The root of this subtree.
+ *
+ * \returns the winner of this subtree.
+ */
+static size_t extsort_tree_build(
+    const extsort* sorter, const extsort_source* sources, size_t count,
+    size_t* tree, size_t node)
+{
+    /* a leaf is its own winner. */
+    if (node >= count)
+    {
+        return node - count;
+    }
+
+    size_t left = extsort_tree_build(sorter, sources, count, tree, 2 * node);
+    size_t right =
+        extsort_tree_build(sorter, sources, count, tree, 2 * node + 1);
+
+    if (extsort_source_less(sorter, sources, right, left))
+    {
+        tree[node] = left;
+        return right;
+    }
+    else
+    {
+        tree[node] = right;
+        return left;
+    }
+}
@@ -0,0 +1,81 @@
+/**
+ * \file extsort/extsort_run_create.c
+ *
+ * \brief Create a run for an external merge sort.
+ *
+ * \copyright 2020 Velo Payments.  See License.txt for license terms.
+ */
+
+#include <cbmc/model_assert.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <vctool/extsort.h>
+
+/**
+ * \brief Create a new, empty run and add it to the sorter's runs.
+ *
+ * \param sorter        The sorter.
+ * \param d             Pointer to receive the descriptor of the run, open for
+ *                      writing.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - VCTOOL_ERROR_GENERAL_OUT_OF_MEMORY if an allocation failed.
+ *      - a non-zero error code returned by file_open.
+ */
+int extsort_run_create(extsort* sorter, int* d)
+{
+    int retval;
+
+    /* parameter sanity checks. */
+    MODEL_ASSERT(NULL != sorter);
+    MODEL_ASSERT(NULL != d);
+
+    /* grow the run list if needed. */
+    if (sorter->run_count == sorter->run_reserved)
+    {
+        size_t new_reserved =
+            (0 == sorter->run_reserved) ? 16 : 2 * sorter->run_reserved;
+        char** tmp =
+            (char**)realloc(sorter->runs, new_reserved * sizeof(char*));
+        if (NULL == tmp)
+        {
+            return VCTOOL_ERROR_GENERAL_OUT_OF_MEMORY;
+        }
+
+        sorter->runs = tmp;
+        sorter->run_reserved = new_reserved;
+    }
+
+    /* runs are named for this process and sorter, so that concurrent sorts
+     * sharing a directory never collide. */
+    size_t path_size =
+        strlen(sorter->temp_dir)
+      + 64 /* /extsort-<pid>-<sorter>-<serial>.run */
+      + 1; /* asciiz */
+    char* path = (char*)malloc(path_size);
+    if (NULL == path)
+    {
+        return VCTOOL_ERROR_GENERAL_OUT_OF_MEMORY;
+    }
+    snprintf(
+        path, path_size, "%s/extsort-%ld-%p-%zu.run", sorter->temp_dir,
+        (long)getpid(), (void*)sorter, sorter->run_serial);
+
+    retval =
+        file_open(
+            sorter->f, d, path, O_CREAT | O_EXCL | O_RDWR, S_IRUSR | S_IWUSR);
+    if (VCTOOL_STATUS_SUCCESS != retval)
+    {
+        free(path);
+        return retval;
+    }
+
+    sorter->runs[sorter->run_count++] = path;
+    ++sorter->run_serial;
+
+    return VCTOOL_STATUS_SUCCESS;
+}
@@ -0,0 +1,34 @@
+/**
+ * \file extsort/extsort_run_flush.c
+ *
+ * \brief Write the buffered records of a run.
+ *
+ * \copyright 2020 Velo Payments.  See License.txt for license terms.
+ */
+
+#include <cbmc/model_assert.h>
+#include <vctool/extsort.h>
+
+/**
+ * \brief Write the buffered records of a run.
+ *
+ * \param writer        The run writer.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - a non-zero error code returned by file_write_all.
+ */
+int extsort_run_flush(extsort_run_writer* writer)
+{
+    /* parameter sanity checks. */
+    MODEL_ASSERT(NULL != writer);
+    MODEL_ASSERT(NULL != writer->buffer);
+
+    int retval =
+        file_write_all(
+            writer->sorter->f, writer->fd, writer->buffer, writer->used);
+
+    writer->used = 0;
+
+    return retval;
+}
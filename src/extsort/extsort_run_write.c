@@ -0,0 +1,47 @@
+/**
+ * \file extsort/extsort_run_write.c
+ *
+ * \brief Append a record to a run.
+ *
+ * \copyright 2020 Velo Payments.  See License.txt for license terms.
+ */
+
+#include <cbmc/model_assert.h>
+#include <string.h>
+#include <vctool/extsort.h>
+
+/**
+ * \brief Append a record to a run, as an extsort_output_fn.
+ *
+ * \param context       The extsort_run_writer.
+ * \param record        The record.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - a non-zero error code returned by the file layer.
+ */
+int extsort_run_write(void* context, const void* record)
+{
+    extsort_run_writer* writer = (extsort_run_writer*)context;
+
+    /* parameter sanity checks. */
+    MODEL_ASSERT(NULL != writer);
+    MODEL_ASSERT(NULL != writer->buffer);
+    MODEL_ASSERT(NULL != record);
+
+    size_t record_size = writer->sorter->record_size;
+
+    if (writer->used + record_size > writer->buffer_size)
+    {
+        int retval = extsort_run_flush(writer);
+        if (VCTOOL_STATUS_SUCCESS != retval)
+        {
+            return retval;
+        }
+    }
+
+    memcpy(writer->buffer + writer->used, record, record_size);
+    writer->used += record_size;
+
+    return VCTOOL_STATUS_SUCCESS;
+}
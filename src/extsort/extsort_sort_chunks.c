@@ -0,0 +1,250 @@
+/**
+ * \file extsort/extsort_sort_chunks.c
+ *
+ * \brief Sort the buffered records of an external merge sort.
+ *
+ * \copyright 2020 Velo Payments.  See License.txt for license terms.
+ */
+
+#include <cbmc/model_assert.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vctool/extsort.h>
+
+/**
+ * \brief One thread's chunk of the buffer.
+ */
+typedef struct extsort_chunk_task
+{
+    extsort* sorter;
+    pthread_t thread;
+    size_t begin;
+    size_t end;
+} extsort_chunk_task;
+
+/* the key size used by qsort comparisons on this thread. */
+static _Thread_local size_t extsort_compare_size;
+
+/* forward decls. */
+static void* extsort_chunk_worker(void* arg);
+static int extsort_spill_chunks(extsort* sorter, unsigned chunk_count);
+static int extsort_record_compare(const void* lhs, const void* rhs);
+
+/**
+ * \brief Sort the buffered records in parallel chunks.
+ *
+ * The buffer is split into one chunk per thread, and each chunk is sorted by
+ * its own thread.  If spill is true, the sorted chunks are then merged into a
+ * single new run and the buffer is emptied; otherwise, the chunk boundaries
+ * are kept in chunk_ends for an in-memory merge.
+ *
+ * \param sorter        The sorter.
+ * \param spill         True if the sorted chunks are written to a run.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - a non-zero error code if a run could not be written.
+ */
+int extsort_sort_chunks(extsort* sorter, bool spill)
+{
+    int retval = VCTOOL_STATUS_SUCCESS;
+    unsigned started = 1;
+
+    /* parameter sanity checks. */
+    MODEL_ASSERT(NULL != sorter);
+    MODEL_ASSERT(NULL != sorter->buffer);
+
+    /* don't start threads for small buffers. */
+    unsigned thread_count = sorter->threads;
+    if (sorter->count / EXTSORT_MIN_RECORDS_PER_THREAD < thread_count)
+    {
+        thread_count =
+            (unsigned)(sorter->count / EXTSORT_MIN_RECORDS_PER_THREAD) + 1;
+    }
+
+    extsort_chunk_task* tasks =
+        (extsort_chunk_task*)calloc(thread_count, sizeof(extsort_chunk_task));
+    if (NULL == tasks)
+    {
+        return VCTOOL_ERROR_GENERAL_OUT_OF_MEMORY;
+    }
+
+    /* split the buffer evenly. */
+    size_t begin = 0;
+    for (unsigned t = 0; t < thread_count; ++t)
+    {
+        size_t end = begin + sorter->count / thread_count;
+        if (t < sorter->count % thread_count)
+        {
+            ++end;
+        }
+
+        tasks[t].sorter = sorter;
+        tasks[t].begin = begin;
+        tasks[t].end = end;
+        begin = end;
+    }
+
+    /* start a thread for every chunk but the first. */
+    for (; started < thread_count; ++started)
+    {
+        if (0 !=
+                pthread_create(
+                    &tasks[started].thread, NULL, &extsort_chunk_worker,
+                    &tasks[started]))
+        {
+            break;
+        }
+    }
+
+    /* the calling thread sorts the first chunk and any which could not be
+     * started. */
+    extsort_chunk_worker(&tasks[0]);
+    for (unsigned t = started; t < thread_count; ++t)
+    {
+        extsort_chunk_worker(&tasks[t]);
+    }
+
+    /* wait for the others. */
+    for (unsigned t = 1; t < started; ++t)
+    {
+        pthread_join(tasks[t].thread, NULL);
+    }
+
+    /* record the chunk boundaries. */
+    for (unsigned t = 0; t < thread_count; ++t)
+    {
+        sorter->chunk_ends[t] = tasks[t].end;
+    }
+
+    free(tasks);
+
+    if (spill)
+    {
+        retval = extsort_spill_chunks(sorter, thread_count);
+        sorter->count = 0;
+        sorter->chunk_count = 0;
+    }
+    else
+    {
+        sorter->chunk_count = thread_count;
+    }
+
+    return retval;
+}
+
+/**
+ * \brief Merge the sorted chunks of the buffer into a new run.
+ *
+ * \param sorter        The sorter.
+ * \param chunk_count   The number of sorted chunks in chunk_ends.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - VCTOOL_ERROR_GENERAL_OUT_OF_MEMORY if an allocation failed.
+ *      - a non-zero error code returned by the file layer.
+ */
+static int extsort_spill_chunks(extsort* sorter, unsigned chunk_count)
+{
+    int retval;
+    extsort_run_writer writer;
+
+    extsort_source* sources =
+        (extsort_source*)calloc(chunk_count, sizeof(extsort_source));
+    if (NULL == sources)
+    {
+        retval = VCTOOL_ERROR_GENERAL_OUT_OF_MEMORY;
+        goto done;
+    }
+
+    size_t begin = 0;
+    for (unsigned i = 0; i < chunk_count; ++i)
+    {
+        sources[i].next = sorter->buffer + begin * sorter->record_size;
+        sources[i].end =
+            sorter->buffer + sorter->chunk_ends[i] * sorter->record_size;
+        sources[i].fd = -1;
+        begin = sorter->chunk_ends[i];
+    }
+
+    /* the merged records are written out a block at a time. */
+    memset(&writer, 0, sizeof(writer));
+    writer.sorter = sorter;
+    writer.buffer_size =
+        EXTSORT_MIN_BLOCK_SIZE / sorter->record_size * sorter->record_size;
+    if (writer.buffer_size < sorter->record_size)
+    {
+        writer.buffer_size = sorter->record_size;
+    }
+
+    writer.buffer = (uint8_t*)malloc(writer.buffer_size);
+    if (NULL == writer.buffer)
+    {
+        retval = VCTOOL_ERROR_GENERAL_OUT_OF_MEMORY;
+        goto free_sources;
+    }
+
+    retval = extsort_run_create(sorter, &writer.fd);
+    if (VCTOOL_STATUS_SUCCESS != retval)
+    {
+        goto free_buffer;
+    }
+
+    retval =
+        extsort_merge(
+            sorter, sources, chunk_count, &extsort_run_write, &writer);
+    if (VCTOOL_STATUS_SUCCESS == retval)
+    {
+        retval = extsort_run_flush(&writer);
+    }
+
+    int close_retval = file_close(sorter->f, writer.fd);
+    if (VCTOOL_STATUS_SUCCESS == retval)
+    {
+        retval = close_retval;
+    }
+
+free_buffer:
+    free(writer.buffer);
+
+free_sources:
+    free(sources);
+
+done:
+    return retval;
+}
+
+/**
+ * \brief Sort one chunk of the buffer.
+ *
+ * \param arg           The task.
+ *
+ * \returns NULL.
+ */
+static void* extsort_chunk_worker(void* arg)
+{
+    extsort_chunk_task* task = (extsort_chunk_task*)arg;
+    extsort* sorter = task->sorter;
+    uint8_t* chunk = sorter->buffer + task->begin * sorter->record_size;
+
+    extsort_compare_size = sorter->key_size;
+    qsort(
+        chunk, task->end - task->begin, sorter->record_size,
+        &extsort_record_compare);
+
+    return NULL;
+}
+
+/**
+ * \brief Compare the keys of two records.
+ *
+ * \param lhs           The left hand record.
+ * \param rhs           The right hand record.
+ *
+ * \returns the memcmp order of the two keys.
+ */
+static int extsort_record_compare(const void* lhs, const void* rhs)
+{
+    return memcmp(lhs, rhs, extsort_compare_size);
+}
@@ -0,0 +1,70 @@
+/**
+ * \file extsort/extsort_source_fill.c
+ *
+ * \brief Refill the buffer of a merge source.
+ *
+ * \copyright 2020 Velo Payments.  See License.txt for license terms.
+ */
+
+#include <cbmc/model_assert.h>
+#include <vctool/extsort.h>
+
+/**
+ * \brief Refill the buffer of an exhausted source.
+ *
+ * Memory sources have no more records once exhausted.
+ *
+ * \param sorter        The sorter.
+ * \param source        The source to refill.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - VCTOOL_ERROR_EXTSORT_BAD_RUN if the run was truncated.
+ *      - a non-zero error code returned by file_read.
+ */
+int extsort_source_fill(extsort* sorter, extsort_source* source)
+{
+    int retval;
+    size_t filled = 0;
+    size_t read;
+
+    /* parameter sanity checks. */
+    MODEL_ASSERT(NULL != sorter);
+    MODEL_ASSERT(NULL != source);
+
+    if (source->fd < 0)
+    {
+        return VCTOOL_STATUS_SUCCESS;
+    }
+
+    /* read until the buffer is full or the run ends. */
+    while (filled < source->buffer_size)
+    {
+        retval =
+            file_read(
+                sorter->f, source->fd, source->buffer + filled,
+                source->buffer_size - filled, &read);
+        if (VCTOOL_STATUS_SUCCESS != retval)
+        {
+            return retval;
+        }
+
+        if (0 == read)
+        {
+            break;
+        }
+
+        filled += read;
+    }
+
+    /* a run always holds whole records. */
+    if (0 != filled % sorter->record_size)
+    {
+        return VCTOOL_ERROR_EXTSORT_BAD_RUN;
+    }
+
+    source->next = source->buffer;
+    source->end = source->buffer + filled;
+
+    return VCTOOL_STATUS_SUCCESS;
+}
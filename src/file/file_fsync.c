@@ -0,0 +1,39 @@
+/**
+ * \file file/file_fsync.c
+ *
+ * \brief Implementation of file_fsync.
+ *
+ * \copyright 2020 Velo Payments.  See License.txt for license terms.
+ */
+
+#include <cbmc/model_assert.h>
+#include <vctool/file.h>
+#include <vpr/parameters.h>
+
+/**
+ * \brief Flush the data written to a file descriptor to stable storage.
+ *
+ * Metadata which is not needed to read the data back, such as the access
+ * time, may not be flushed.
+ *
+ * \param f         The file interface.
+ * \param d         The file descriptor to flush.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - VCTOOL_ERROR_FILE_BAD_DESCRIPTOR if the descriptor is bad.
+ *      - VCTOOL_ERROR_FILE_INVALID_FLAGS if the descriptor does not support
+ *        flushing.
+ *      - VCTOOL_ERROR_FILE_IO if an I/O error occurred.
+ *      - VCTOOL_ERROR_FILE_NO_SPACE if the device is out of space.
+ *      - VCTOOL_ERROR_FILE_QUOTA if the user's quota has been exhausted.
+ *      - VCTOOL_ERROR_FILE_UNKNOWN if an unknown error occurred.
+ */
+int file_fsync(file* f, int d)
+{
+    /* parameter sanity checks. */
+    MODEL_ASSERT(PROP_FILE_VALID(f));
+    MODEL_ASSERT(d >= 0);
+
+    return f->file_fsync_method(f, d);
+}
@@ -0,0 +1,37 @@
+/**
+ * \file file/file_ftruncate.c
+ *
+ * \brief Implementation of file_ftruncate.
+ *
+ * \copyright 2020 Velo Payments.  See License.txt for license terms.
+ */
+
+#include <cbmc/model_assert.h>
+#include <vctool/file.h>
+#include <vpr/parameters.h>
+
+/**
+ * \brief Truncate the file open on a descriptor to a length.
+ *
+ * \param f         The file interface.
+ * \param d         The file descriptor, open for writing.
+ * \param length    The new length of the file.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - VCTOOL_ERROR_FILE_BAD_DESCRIPTOR if the descriptor is bad or not
+ *        open for writing.
+ *      - VCTOOL_ERROR_FILE_INVALID_FLAGS if the descriptor does not support
+ *        truncation or the length is invalid.
+ *      - VCTOOL_ERROR_FILE_IO if an I/O error occurred.
+ *      - VCTOOL_ERROR_FILE_UNKNOWN if an unknown error occurred.
+ */
+int file_ftruncate(file* f, int d, off_t length)
+{
+    /* parameter sanity checks. */
+    MODEL_ASSERT(PROP_FILE_VALID(f));
+    MODEL_ASSERT(d >= 0);
+    MODEL_ASSERT(length >= 0);
+
+    return f->file_ftruncate_method(f, d, length);
+}
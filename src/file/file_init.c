@@ -9,7 +9,11 @@
 #include <cbmc/model_assert.h>
 #include <errno.h>
 #include <fcntl.h>
+#include <stdio.h>
 #include <string.h>
+#include <sys/mman.h>
+#include <sys/sendfile.h>
+#include <sys/stat.h>
 #include <unistd.h>
 #include <vctool/file.h>
 #include <vpr/parameters.h>
@@ -21,6 +25,14 @@ static int file_os_open(file*, int*, const char*, int, mode_t);
 static int file_os_close(file*, int);
 static int file_os_read(file*, int, void*, size_t, size_t*);
 static int file_os_write(file*, int, const void*, size_t, size_t*);
+static int file_os_mmap(file*, void**, int, size_t);
+static int file_os_munmap(file*, void*, size_t);
+static int file_os_rename(file*, const char*, const char*);
+static int file_os_unlink(file*, const char*);
+static int file_os_mkdir(file*, const char*, mode_t);
+static int file_os_sendfile(file*, int, int, off_t, size_t, size_t*);
+static int file_os_fsync(file*, int);
+static int file_os_ftruncate(file*, int, off_t);
 
 /**
  * \brief Initialize a file interface backed by the operating system.
@@ -47,6 +59,14 @@ int file_init(file* f)
     f->file_close_method = &file_os_close;
     f->file_read_method = &file_os_read;
     f->file_write_method = &file_os_write;
+    f->file_mmap_method = &file_os_mmap;
+    f->file_munmap_method = &file_os_munmap;
+    f->file_rename_method = &file_os_rename;
+    f->file_unlink_method = &file_os_unlink;
+    f->file_mkdir_method = &file_os_mkdir;
+    f->file_sendfile_method = &file_os_sendfile;
+    f->file_fsync_method = &file_os_fsync;
+    f->file_ftruncate_method = &file_os_ftruncate;
 
     /* the file instance should now be valid. */
     MODEL_ASSERT(PROP_FILE_VALID(f));
@@ -423,3 +443,426 @@ static int file_os_write(
 
     return VCTOOL_STATUS_SUCCESS;
 }
+
+/**
+ * \brief Map a file descriptor into memory, read-only.
+ *
+ * \param f         The file interface.
+ * \param addr      Pointer to receive the address of the mapping.
+ * \param d         The descriptor to map.
+ * \param size      The number of bytes to map, starting at offset 0.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - VCTOOL_ERROR_FILE_ACCESS if the descriptor was not opened for read.
+ *      - VCTOOL_ERROR_FILE_BAD_DESCRIPTOR if the file descriptor is bad.
+ *      - VCTOOL_ERROR_FILE_INVALID_FLAGS if the size is invalid.
+ *      - VCTOOL_ERROR_FILE_NOT_SUPPORTED if this file can't be mapped.
+ *      - VCTOOL_ERROR_FILE_KERNEL_MEMORY if the kernel ran out of memory.
+ *      - VCTOOL_ERROR_FILE_OVERFLOW if the mapping would overflow.
+ *      - VCTOOL_ERROR_FILE_UNKNOWN if an unknown error occurred.
+ */
+static int file_os_mmap(file* UNUSED(f), void** addr, int d, size_t size)
+{
+    /* parameter sanity checks. */
+    MODEL_ASSERT(PROP_FILE_VALID(f));
+    MODEL_ASSERT(NULL != addr);
+    MODEL_ASSERT(d >= 0);
+
+    /* attempt to map this fd. */
+    *addr = mmap(NULL, size, PROT_READ, MAP_SHARED, d, 0);
+    if (MAP_FAILED == *addr)
+    {
+        *addr = NULL;
+
+        switch (errno)
+        {
+            case EACCES:
+                return VCTOOL_ERROR_FILE_ACCESS;
+            case EBADF:
+                return VCTOOL_ERROR_FILE_BAD_DESCRIPTOR;
+            case EINVAL:
+                return VCTOOL_ERROR_FILE_INVALID_FLAGS;
+            case ENODEV:
+                return VCTOOL_ERROR_FILE_NOT_SUPPORTED;
+            case ENOMEM:
+                return VCTOOL_ERROR_FILE_KERNEL_MEMORY;
+            case EOVERFLOW:
+                return VCTOOL_ERROR_FILE_OVERFLOW;
+            default:
+                return VCTOOL_ERROR_FILE_UNKNOWN;
+        }
+    }
+
+    return VCTOOL_STATUS_SUCCESS;
+}
+
+/**
+ * \brief Unmap a region mapped with file_mmap.
+ *
+ * \param f         The file interface.
+ * \param addr      The address of the mapping.
+ * \param size      The size of the mapping.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - VCTOOL_ERROR_FILE_INVALID_FLAGS if the address or size are invalid.
+ *      - VCTOOL_ERROR_FILE_UNKNOWN if an unknown error occurred.
+ */
+static int file_os_munmap(file* UNUSED(f), void* addr, size_t size)
+{
+    /* parameter sanity checks. */
+    MODEL_ASSERT(PROP_FILE_VALID(f));
+    MODEL_ASSERT(NULL != addr);
+
+    if (munmap(addr, size) < 0)
+    {
+        switch (errno)
+        {
+            case EINVAL:
+                return VCTOOL_ERROR_FILE_INVALID_FLAGS;
+            default:
+                return VCTOOL_ERROR_FILE_UNKNOWN;
+        }
+    }
+
+    return VCTOOL_STATUS_SUCCESS;
+}
+
+/**
+ * \brief Atomically rename a file, replacing any existing file.
+ *
+ * \param f         The file interface.
+ * \param oldpath   The current path of the file.
+ * \param newpath   The new path of the file.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - VCTOOL_ERROR_FILE_ACCESS if permission was denied.
+ *      - VCTOOL_ERROR_FILE_IS_DIRECTORY if newpath is a directory.
+ *      - VCTOOL_ERROR_FILE_LOOP if too many symlinks were encountered.
+ *      - VCTOOL_ERROR_FILE_NAME_TOO_LONG if a path name is too long.
+ *      - VCTOOL_ERROR_FILE_NO_ENTRY if oldpath does not exist.
+ *      - VCTOOL_ERROR_FILE_KERNEL_MEMORY if the kernel ran out of memory.
+ *      - VCTOOL_ERROR_FILE_NO_SPACE if there is no space left on the device.
+ *      - VCTOOL_ERROR_FILE_NOT_DIRECTORY if a component of a path is not a
+ *        directory.
+ *      - VCTOOL_ERROR_FILE_NOT_SUPPORTED if the paths are on different
+ *        filesystems or the filesystem is read-only.
+ *      - VCTOOL_ERROR_FILE_QUOTA if user quota has been exceeded.
+ *      - VCTOOL_ERROR_FILE_UNKNOWN if an unknown error occurred.
+ */
+static int file_os_rename(
+    file* UNUSED(f), const char* oldpath, const char* newpath)
+{
+    /* parameter sanity checks. */
+    MODEL_ASSERT(PROP_FILE_VALID(f));
+    MODEL_ASSERT(NULL != oldpath);
+    MODEL_ASSERT(NULL != newpath);
+
+    if (rename(oldpath, newpath) < 0)
+    {
+        switch (errno)
+        {
+            case EPERM: /* fall-through */
+            case EBUSY: /* fall-through */
+            case EACCES:
+                return VCTOOL_ERROR_FILE_ACCESS;
+            case EDQUOT:
+                return VCTOOL_ERROR_FILE_QUOTA;
+            case EISDIR:
+                return VCTOOL_ERROR_FILE_IS_DIRECTORY;
+            case ELOOP:
+                return VCTOOL_ERROR_FILE_LOOP;
+            case ENAMETOOLONG:
+                return VCTOOL_ERROR_FILE_NAME_TOO_LONG;
+            case ENOENT:
+                return VCTOOL_ERROR_FILE_NO_ENTRY;
+            case ENOMEM:
+                return VCTOOL_ERROR_FILE_KERNEL_MEMORY;
+            case ENOSPC:
+                return VCTOOL_ERROR_FILE_NO_SPACE;
+            case ENOTDIR:
+                return VCTOOL_ERROR_FILE_NOT_DIRECTORY;
+            case EROFS: /* fall-through */
+            case EXDEV:
+                return VCTOOL_ERROR_FILE_NOT_SUPPORTED;
+            default:
+                return VCTOOL_ERROR_FILE_UNKNOWN;
+        }
+    }
+
+    return VCTOOL_STATUS_SUCCESS;
+}
+
+/**
+ * \brief Remove a file.
+ *
+ * \param f         The file interface.
+ * \param path      The path of the file to remove.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - VCTOOL_ERROR_FILE_ACCESS if permission was denied.
+ *      - VCTOOL_ERROR_FILE_IS_DIRECTORY if path is a directory.
+ *      - VCTOOL_ERROR_FILE_LOOP if too many symlinks were encountered.
+ *      - VCTOOL_ERROR_FILE_NAME_TOO_LONG if the path name is too long.
+ *      - VCTOOL_ERROR_FILE_NO_ENTRY if path does not exist.
+ *      - VCTOOL_ERROR_FILE_KERNEL_MEMORY if the kernel ran out of memory.
+ *      - VCTOOL_ERROR_FILE_NOT_DIRECTORY if a component of the path is not a
+ *        directory.
+ *      - VCTOOL_ERROR_FILE_NOT_SUPPORTED if the filesystem is read-only.
+ *      - VCTOOL_ERROR_FILE_UNKNOWN if an unknown error occurred.
+ */
+static int file_os_unlink(file* UNUSED(f), const char* path)
+{
+    /* parameter sanity checks. */
+    MODEL_ASSERT(PROP_FILE_VALID(f));
+    MODEL_ASSERT(NULL != path);
+
+    if (unlink(path) < 0)
+    {
+        switch (errno)
+        {
+            case EPERM: /* fall-through */
+            case EBUSY: /* fall-through */
+            case EACCES:
+                return VCTOOL_ERROR_FILE_ACCESS;
+            case EISDIR:
+                return VCTOOL_ERROR_FILE_IS_DIRECTORY;
+            case ELOOP:
+                return VCTOOL_ERROR_FILE_LOOP;
+            case ENAMETOOLONG:
+                return VCTOOL_ERROR_FILE_NAME_TOO_LONG;
+            case ENOENT:
+                return VCTOOL_ERROR_FILE_NO_ENTRY;
+            case ENOMEM:
+                return VCTOOL_ERROR_FILE_KERNEL_MEMORY;
+            case ENOTDIR:
+                return VCTOOL_ERROR_FILE_NOT_DIRECTORY;
+            case EROFS:
+                return VCTOOL_ERROR_FILE_NOT_SUPPORTED;
+            default:
+                return VCTOOL_ERROR_FILE_UNKNOWN;
+        }
+    }
+
+    return VCTOOL_STATUS_SUCCESS;
+}
+
+/**
+ * \brief Create a directory.
+ *
+ * \param f         The file interface.
+ * \param path      The path of the directory to create.
+ * \param mode      The permissions of the new directory.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - VCTOOL_ERROR_FILE_ACCESS if permission was denied.
+ *      - VCTOOL_ERROR_FILE_QUOTA if the user's quota has been exhausted.
+ *      - VCTOOL_ERROR_FILE_EXISTS if path already exists.
+ *      - VCTOOL_ERROR_FILE_LOOP if too many symlinks were encountered.
+ *      - VCTOOL_ERROR_FILE_NAME_TOO_LONG if the path name is too long.
+ *      - VCTOOL_ERROR_FILE_NO_ENTRY if a parent directory does not exist.
+ *      - VCTOOL_ERROR_FILE_KERNEL_MEMORY if the kernel ran out of memory.
+ *      - VCTOOL_ERROR_FILE_NO_SPACE if the device is out of space.
+ *      - VCTOOL_ERROR_FILE_NOT_DIRECTORY if a component of the path is not a
+ *        directory.
+ *      - VCTOOL_ERROR_FILE_NOT_SUPPORTED if the filesystem is read-only.
+ *      - VCTOOL_ERROR_FILE_UNKNOWN if an unknown error occurred.
+ */
+static int file_os_mkdir(file* UNUSED(f), const char* path, mode_t mode)
+{
+    /* parameter sanity checks. */
+    MODEL_ASSERT(PROP_FILE_VALID(f));
+    MODEL_ASSERT(NULL != path);
+
+    if (mkdir(path, mode) < 0)
+    {
+        switch (errno)
+        {
+            case EPERM: /* fall-through */
+            case EACCES:
+                return VCTOOL_ERROR_FILE_ACCESS;
+            case EDQUOT:
+                return VCTOOL_ERROR_FILE_QUOTA;
+            case EEXIST:
+                return VCTOOL_ERROR_FILE_EXISTS;
+            case ELOOP:
+                return VCTOOL_ERROR_FILE_LOOP;
+            case ENAMETOOLONG:
+                return VCTOOL_ERROR_FILE_NAME_TOO_LONG;
+            case ENOENT:
+                return VCTOOL_ERROR_FILE_NO_ENTRY;
+            case ENOMEM:
+                return VCTOOL_ERROR_FILE_KERNEL_MEMORY;
+            case ENOSPC:
+                return VCTOOL_ERROR_FILE_NO_SPACE;
+            case ENOTDIR:
+                return VCTOOL_ERROR_FILE_NOT_DIRECTORY;
+            case EROFS:
+                return VCTOOL_ERROR_FILE_NOT_SUPPORTED;
+            default:
+                return VCTOOL_ERROR_FILE_UNKNOWN;
+        }
+    }
+
+    return VCTOOL_STATUS_SUCCESS;
+}
+
+/**
+ * \brief Copy bytes from a file to a descriptor in the kernel.
+ *
+ * \param f         The file interface.
+ * \param out       The descriptor to which data is written.
+ * \param in        The file descriptor from which data is read.
+ * \param offset    The offset in the input file at which to start.
+ * \param max       The maximum number of bytes to copy.
+ * \param sbytes    Pointer to receive the number of bytes copied.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - VCTOOL_ERROR_FILE_WOULD_BLOCK if the output descriptor is
+ *        non-blocking and full.
+ *      - VCTOOL_ERROR_FILE_BAD_DESCRIPTOR if a file descriptor is bad.
+ *      - VCTOOL_ERROR_FILE_FAULT if the offset is outside of the address
+ *        space.
+ *      - VCTOOL_ERROR_FILE_INVALID_FLAGS if a descriptor does not support
+ *        this operation.
+ *      - VCTOOL_ERROR_FILE_IO if an I/O error occurred.
+ *      - VCTOOL_ERROR_FILE_KERNEL_MEMORY if the kernel ran out of memory.
+ *      - VCTOOL_ERROR_FILE_OVERFLOW if the count is too large.
+ *      - VCTOOL_ERROR_FILE_BROKEN_PIPE if the reader closed the connection.
+ *      - VCTOOL_ERROR_FILE_UNKNOWN if an unknown error occurred.
+ */
+static int file_os_sendfile(
+    file* UNUSED(f), int out, int in, off_t offset, size_t max,
+    size_t* sbytes)
+{
+    /* parameter sanity checks. */
+    MODEL_ASSERT(PROP_FILE_VALID(f));
+    MODEL_ASSERT(out >= 0);
+    MODEL_ASSERT(in >= 0);
+    MODEL_ASSERT(NULL != sbytes);
+
+    /* sendfile advances the local offset, not the descriptor's. */
+    ssize_t retval = sendfile(out, in, &offset, max);
+    if (retval < 0)
+    {
+        switch (errno)
+        {
+            case EAGAIN:
+                return VCTOOL_ERROR_FILE_WOULD_BLOCK;
+            case EBADF:
+                return VCTOOL_ERROR_FILE_BAD_DESCRIPTOR;
+            case EFAULT:
+                return VCTOOL_ERROR_FILE_FAULT;
+            case EINVAL:
+                return VCTOOL_ERROR_FILE_INVALID_FLAGS;
+            case EIO:
+                return VCTOOL_ERROR_FILE_IO;
+            case ENOMEM:
+                return VCTOOL_ERROR_FILE_KERNEL_MEMORY;
+            case EOVERFLOW:
+                return VCTOOL_ERROR_FILE_OVERFLOW;
+            case EPIPE:
+                return VCTOOL_ERROR_FILE_BROKEN_PIPE;
+            default:
+                return VCTOOL_ERROR_FILE_UNKNOWN;
+        }
+    }
+
+    /* save the number of bytes copied. */
+    *sbytes = retval;
+
+    return VCTOOL_STATUS_SUCCESS;
+}
+
+/**
+ * \brief Flush the data written to a file descriptor to stable storage.
+ *
+ * \param f         The file interface.
+ * \param d         The file descriptor to flush.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - VCTOOL_ERROR_FILE_BAD_DESCRIPTOR if the descriptor is bad.
+ *      - VCTOOL_ERROR_FILE_INVALID_FLAGS if the descriptor does not support
+ *        flushing.
+ *      - VCTOOL_ERROR_FILE_IO if an I/O error occurred.
+ *      - VCTOOL_ERROR_FILE_NO_SPACE if the device is out of space.
+ *      - VCTOOL_ERROR_FILE_QUOTA if the user's quota has been exhausted.
+ *      - VCTOOL_ERROR_FILE_UNKNOWN if an unknown error occurred.
+ */
+static int file_os_fsync(file* UNUSED(f), int d)
+{
+    /* parameter sanity checks. */
+    MODEL_ASSERT(PROP_FILE_VALID(f));
+    MODEL_ASSERT(d >= 0);
+
+    /* the data and the file size are enough to read the data back. */
+    if (fdatasync(d) < 0)
+    {
+        switch (errno)
+        {
+            case EBADF:
+                return VCTOOL_ERROR_FILE_BAD_DESCRIPTOR;
+            case EROFS: /* fall-through */
+            case EINVAL:
+                return VCTOOL_ERROR_FILE_INVALID_FLAGS;
+            case EIO:
+                return VCTOOL_ERROR_FILE_IO;
+            case ENOSPC:
+                return VCTOOL_ERROR_FILE_NO_SPACE;
+            case EDQUOT:
+                return VCTOOL_ERROR_FILE_QUOTA;
+            default:
+                return VCTOOL_ERROR_FILE_UNKNOWN;
+        }
+    }
+
+    return VCTOOL_STATUS_SUCCESS;
+}
+
+/**
+ * \brief Truncate the file open on a descriptor to a length.
+ *
+ * \param f         The file interface.
+ * \param d         The file descriptor, open for writing.
+ * \param length    The new length of the file.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - VCTOOL_ERROR_FILE_BAD_DESCRIPTOR if the descriptor is bad or not
+ *        open for writing.
+ *      - VCTOOL_ERROR_FILE_INVALID_FLAGS if the descriptor does not support
+ *        truncation or the length is invalid.
+ *      - VCTOOL_ERROR_FILE_IO if an I/O error occurred.
+ *      - VCTOOL_ERROR_FILE_UNKNOWN if an unknown error occurred.
+ */
+static int file_os_ftruncate(file* UNUSED(f), int d, off_t length)
+{
+    /* parameter sanity checks. */
+    MODEL_ASSERT(PROP_FILE_VALID(f));
+    MODEL_ASSERT(d >= 0);
+    MODEL_ASSERT(length >= 0);
+
+    if (ftruncate(d, length) < 0)
+    {
+        switch (errno)
+        {
+            case EBADF:
+                return VCTOOL_ERROR_FILE_BAD_DESCRIPTOR;
+            case EINVAL: /* fall-through */
+            case EPERM:
+                return VCTOOL_ERROR_FILE_INVALID_FLAGS;
+            case EIO:
+                return VCTOOL_ERROR_FILE_IO;
+            default:
+                return VCTOOL_ERROR_FILE_UNKNOWN;
+        }
+    }
+
+    return VCTOOL_STATUS_SUCCESS;
+}
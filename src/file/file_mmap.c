@@ -0,0 +1,39 @@
+/**
+ * \file file/file_mmap.c
+ *
+ * \brief Implementation of file_mmap.
+ *
+ * \copyright 2020 Velo Payments.  See License.txt for license terms.
+ */
+
+#include <cbmc/model_assert.h>
+#include <vctool/file.h>
+#include <vpr/parameters.h>
+
+/**
+ * \brief Map a file descriptor into memory, read-only.
+ *
+ * \param f         The file interface.
+ * \param addr      Pointer to receive the address of the mapping.
+ * \param d         The descriptor to map.
+ * \param size      The number of bytes to map, starting at offset 0.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - VCTOOL_ERROR_FILE_ACCESS if the descriptor was not opened for read.
+ *      - VCTOOL_ERROR_FILE_BAD_DESCRIPTOR if the file descriptor is bad.
+ *      - VCTOOL_ERROR_FILE_INVALID_FLAGS if the size is invalid.
+ *      - VCTOOL_ERROR_FILE_NOT_SUPPORTED if this file can't be mapped.
+ *      - VCTOOL_ERROR_FILE_KERNEL_MEMORY if the kernel ran out of memory.
+ *      - VCTOOL_ERROR_FILE_OVERFLOW if the mapping would overflow.
+ *      - VCTOOL_ERROR_FILE_UNKNOWN if an unknown error occurred.
+ */
+int file_mmap(file* f, void** addr, int d, size_t size)
+{
+    /* parameter sanity checks. */
+    MODEL_ASSERT(PROP_FILE_VALID(f));
+    MODEL_ASSERT(NULL != addr);
+    MODEL_ASSERT(d >= 0);
+
+    return f->file_mmap_method(f, addr, d, size);
+}
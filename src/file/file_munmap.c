@@ -0,0 +1,32 @@
+/**
+ * \file file/file_munmap.c
+ *
+ * \brief Implementation of file_munmap.
+ *
+ * \copyright 2020 Velo Payments.  See License.txt for license terms.
+ */
+
+#include <cbmc/model_assert.h>
+#include <vctool/file.h>
+#include <vpr/parameters.h>
+
+/**
+ * \brief Unmap a region mapped with file_mmap.
+ *
+ * \param f         The file interface.
+ * \param addr      The address of the mapping.
+ * \param size      The size of the mapping.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - VCTOOL_ERROR_FILE_INVALID_FLAGS if the address or size are invalid.
+ *      - VCTOOL_ERROR_FILE_UNKNOWN if an unknown error occurred.
+ */
+int file_munmap(file* f, void* addr, size_t size)
+{
+    /* parameter sanity checks. */
+    MODEL_ASSERT(PROP_FILE_VALID(f));
+    MODEL_ASSERT(NULL != addr);
+
+    return f->file_munmap_method(f, addr, size);
+}
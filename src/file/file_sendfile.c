@@ -0,0 +1,52 @@
+/**
+ * \file file/file_sendfile.c
+ *
+ * \brief Implementation of file_sendfile.
+ *
+ * \copyright 2020 Velo Payments.  See License.txt for license terms.
+ */
+
+#include <cbmc/model_assert.h>
+#include <vctool/file.h>
+#include <vpr/parameters.h>
+
+/**
+ * \brief Copy bytes from a file to a descriptor without passing them through
+ * user space.
+ *
+ * The file offset of the input descriptor is not changed, so several threads
+ * may send from the same descriptor.
+ *
+ * \param f         The file interface.
+ * \param out       The descriptor to which data is written.
+ * \param in        The file descriptor from which data is read.
+ * \param offset    The offset in the input file at which to start.
+ * \param max       The maximum number of bytes to copy.
+ * \param sbytes    Pointer to receive the number of bytes copied.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - VCTOOL_ERROR_FILE_WOULD_BLOCK if the output descriptor is
+ *        non-blocking and full.
+ *      - VCTOOL_ERROR_FILE_BAD_DESCRIPTOR if a file descriptor is bad.
+ *      - VCTOOL_ERROR_FILE_FAULT if the offset is outside of the address
+ *        space.
+ *      - VCTOOL_ERROR_FILE_INVALID_FLAGS if a descriptor does not support
+ *        this operation.
+ *      - VCTOOL_ERROR_FILE_IO if an I/O error occurred.
+ *      - VCTOOL_ERROR_FILE_KERNEL_MEMORY if the kernel ran out of memory.
+ *      - VCTOOL_ERROR_FILE_OVERFLOW if the count is too large.
+ *      - VCTOOL_ERROR_FILE_BROKEN_PIPE if the reader closed the connection.
+ *      - VCTOOL_ERROR_FILE_UNKNOWN if an unknown error occurred.
+ */
+int file_sendfile(
+    file* f, int out, int in, off_t offset, size_t max, size_t* sbytes)
+{
+    /* parameter sanity checks. */
+    MODEL_ASSERT(PROP_FILE_VALID(f));
+    MODEL_ASSERT(out >= 0);
+    MODEL_ASSERT(in >= 0);
+    MODEL_ASSERT(NULL != sbytes);
+
+    return f->file_sendfile_method(f, out, in, offset, max, sbytes);
+}
@@ -0,0 +1,57 @@
+/**
+ * \file file/file_write_all.c
+ *
+ * \brief Implementation of file_write_all.
+ *
+ * \copyright 2020 Velo Payments.  See License.txt for license terms.
+ */
+
+#include <cbmc/model_assert.h>
+#include <stdint.h>
+#include <vctool/file.h>
+
+/**
+ * \brief Write an entire buffer to a file descriptor.
+ *
+ * Unlike file_write, this retries short writes until the whole buffer has been
+ * written.
+ *
+ * \param f         The file interface.
+ * \param d         The descriptor to which data is written.
+ * \param buf       The buffer to write from.
+ * \param size      The number of bytes to write.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - VCTOOL_ERROR_FILE_IO if the descriptor stopped accepting data.
+ *      - a non-zero error code returned by file_write.
+ */
+int file_write_all(file* f, int d, const void* buf, size_t size)
+{
+    int retval;
+    const uint8_t* bbuf = (const uint8_t*)buf;
+
+    /* parameter sanity checks. */
+    MODEL_ASSERT(PROP_FILE_VALID(f));
+    MODEL_ASSERT(d >= 0);
+    MODEL_ASSERT(0 == size || NULL != buf);
+
+    while (size > 0)
+    {
+        size_t wrote;
+        retval = file_write(f, d, bbuf, size, &wrote);
+        if (VCTOOL_STATUS_SUCCESS != retval)
+        {
+            return retval;
+        }
+        else if (0 == wrote)
+        {
+            return VCTOOL_ERROR_FILE_IO;
+        }
+
+        bbuf += wrote;
+        size -= wrote;
+    }
+
+    return VCTOOL_STATUS_SUCCESS;
+}
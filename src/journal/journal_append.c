@@ -0,0 +1,99 @@
+/**
+ * \file journal/journal_append.c
+ *
+ * \brief Append a record to a journal.
+ *
+ * \copyright 2020 Velo Payments.  See License.txt for license terms.
+ */
+
+#include <cbmc/model_assert.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vctool/crc32c.h>
+#include <vctool/journal.h>
+
+/* forward decls. */
+static void journal_write_u32(uint8_t* buf, uint32_t value);
+
+/**
+ * \brief Append a record to the journal.
+ *
+ * The record is not durable until it has been committed.
+ *
+ * \param j             The journal.
+ * \param state         JOURNAL_SUBMITTED or JOURNAL_ACKNOWLEDGED.
+ * \param txn_id        The transaction id.
+ * \param sequence      Set to the sequence number of the record.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - VCTOOL_ERROR_GENERAL_OUT_OF_MEMORY if an allocation failed.
+ *      - the error which stopped an earlier commit.
+ */
+int journal_append(
+    journal* j, uint32_t state, const uint8_t* txn_id, uint64_t* sequence)
+{
+    int retval;
+
+    /* parameter sanity checks. */
+    MODEL_ASSERT(NULL != j);
+    MODEL_ASSERT(
+        JOURNAL_SUBMITTED == state || JOURNAL_ACKNOWLEDGED == state);
+    MODEL_ASSERT(NULL != txn_id);
+    MODEL_ASSERT(NULL != sequence);
+
+    pthread_mutex_lock(&j->lock);
+
+    /* a journal which could not be written stays stopped. */
+    if (VCTOOL_STATUS_SUCCESS != j->error)
+    {
+        retval = j->error;
+        goto done;
+    }
+
+    if (j->pending_size + JOURNAL_RECORD_SIZE > j->pending_capacity)
+    {
+        size_t capacity =
+            (0 == j->pending_capacity)
+                ? 256 * JOURNAL_RECORD_SIZE : 2 * j->pending_capacity;
+        uint8_t* tmp = (uint8_t*)realloc(j->pending, capacity);
+        if (NULL == tmp)
+        {
+            retval = VCTOOL_ERROR_GENERAL_OUT_OF_MEMORY;
+            goto done;
+        }
+
+        j->pending = tmp;
+        j->pending_capacity = capacity;
+    }
+
+    uint8_t* record = j->pending + j->pending_size;
+    journal_write_u32(record, state);
+    memcpy(record + 4, txn_id, UUID_SIZE);
+    journal_write_u32(
+        record + JOURNAL_RECORD_CHECKED_SIZE,
+        crc32c(0, record, JOURNAL_RECORD_CHECKED_SIZE));
+
+    j->pending_size += JOURNAL_RECORD_SIZE;
+    *sequence = ++j->appended;
+    retval = VCTOOL_STATUS_SUCCESS;
+
+done:
+    pthread_mutex_unlock(&j->lock);
+
+    return retval;
+}
+
+/**
+ * \brief Write a big-endian 32-bit value.
+ *
+ * \param buf           The buffer to write.
+ * \param value         The value to write.
+ */
+static void journal_write_u32(uint8_t* buf, uint32_t value)
+{
+    buf[0] = (uint8_t)(value >> 24);
+    buf[1] = (uint8_t)(value >> 16);
+    buf[2] = (uint8_t)(value >> 8);
+    buf[3] = (uint8_t)value;
+}
@@ -0,0 +1,161 @@
+/**
+ * \file journal/journal_checkpoint_save.c
+ *
+ * \brief Save the state of each transaction in a journal checkpoint.
+ *
+ * \copyright 2020 Velo Payments.  See License.txt for license terms.
+ */
+
+#include <cbmc/model_assert.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vctool/crc32c.h>
+#include <vctool/journal.h>
+
+/* forward decls. */
+static void journal_write_u64(uint8_t* buf, uint64_t value);
+
+/**
+ * \brief Save the state of each transaction in a journal checkpoint.
+ *
+ * The checkpoint is written to a temporary file which is flushed and then
+ * renamed over path.
+ *
+ * \param j             The journal, with the state of each transaction up to
+ *                      offset.
+ * \param path          The path of the checkpoint.
+ * \param offset        The journal offset covered by the checkpoint.
+ * \param checksum      The checksum of the last record before offset.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - VCTOOL_ERROR_GENERAL_OUT_OF_MEMORY if an allocation failed.
+ *      - a non-zero error code returned by the file layer.
+ */
+int journal_checkpoint_save(
+    const journal* j, const char* path, uint64_t offset,
+    const uint8_t* checksum)
+{
+    int retval, fd;
+    uint8_t header[JOURNAL_CHECKPOINT_HEADER_SIZE];
+    uint8_t trailer[4];
+
+    /* parameter sanity checks. */
+    MODEL_ASSERT(NULL != j);
+    MODEL_ASSERT(NULL != path);
+    MODEL_ASSERT(NULL != checksum);
+
+    /* build the header. */
+    size_t count = j->transactions.count;
+    memcpy(header, JOURNAL_CHECKPOINT_MAGIC, JOURNAL_CHECKPOINT_MAGIC_SIZE);
+    journal_write_u64(header + 8, offset);
+    memcpy(header + 16, checksum, 4);
+    journal_write_u64(header + 20, (uint64_t)count);
+
+    /* the checksum covers everything before it. */
+    uint32_t crc = crc32c(0, header, sizeof(header));
+    crc = crc32c(crc, j->transactions.uuids, count * UUID_SIZE);
+    crc = crc32c(crc, j->states, count);
+    trailer[0] = (uint8_t)(crc >> 24);
+    trailer[1] = (uint8_t)(crc >> 16);
+    trailer[2] = (uint8_t)(crc >> 8);
+    trailer[3] = (uint8_t)crc;
+
+    /* build the temporary filename. */
+    size_t tmp_size =
+        strlen(path)
+      + 4 /* .tmp */
+      + 1;/* asciiz */
+    char* tmp = (char*)malloc(tmp_size);
+    if (NULL == tmp)
+    {
+        retval = VCTOOL_ERROR_GENERAL_OUT_OF_MEMORY;
+        goto done;
+    }
+    snprintf(tmp, tmp_size, "%s.tmp", path);
+
+    retval =
+        file_open(
+            j->f, &fd, tmp, O_CREAT | O_TRUNC | O_WRONLY, S_IRUSR | S_IWUSR);
+    if (VCTOOL_STATUS_SUCCESS != retval)
+    {
+        goto cleanup_tmp;
+    }
+
+    retval = file_write_all(j->f, fd, header, sizeof(header));
+    if (VCTOOL_STATUS_SUCCESS != retval)
+    {
+        goto cleanup_fd;
+    }
+
+    retval =
+        file_write_all(j->f, fd, j->transactions.uuids, count * UUID_SIZE);
+    if (VCTOOL_STATUS_SUCCESS != retval)
+    {
+        goto cleanup_fd;
+    }
+
+    retval = file_write_all(j->f, fd, j->states, count);
+    if (VCTOOL_STATUS_SUCCESS != retval)
+    {
+        goto cleanup_fd;
+    }
+
+    retval = file_write_all(j->f, fd, trailer, sizeof(trailer));
+    if (VCTOOL_STATUS_SUCCESS != retval)
+    {
+        goto cleanup_fd;
+    }
+
+    /* the checkpoint must be on disk before it replaces the old one. */
+    retval = file_fsync(j->f, fd);
+    if (VCTOOL_STATUS_SUCCESS != retval)
+    {
+        goto cleanup_fd;
+    }
+
+    /* close the file before replacing the checkpoint. */
+    retval = file_close(j->f, fd);
+    if (VCTOOL_STATUS_SUCCESS != retval)
+    {
+        goto cleanup_unlink;
+    }
+
+    /* atomically replace the checkpoint. */
+    retval = file_rename(j->f, tmp, path);
+    if (VCTOOL_STATUS_SUCCESS != retval)
+    {
+        goto cleanup_unlink;
+    }
+
+    goto cleanup_tmp;
+
+cleanup_fd:
+    file_close(j->f, fd);
+
+cleanup_unlink:
+    file_unlink(j->f, tmp);
+
+cleanup_tmp:
+    free(tmp);
+
+done:
+    return retval;
+}
+
+/**
+ * \brief Write a big-endian 64-bit value.
+ *
+ * \param buf           The buffer to write.
+ * \param value         The value.
+ */
+static void journal_write_u64(uint8_t* buf, uint64_t value)
+{
+    for (int i = 7; i >= 0; --i)
+    {
+        buf[i] = (uint8_t)(value & 0xff);
+        value >>= 8;
+    }
+}
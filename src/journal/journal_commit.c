@@ -0,0 +1,96 @@
+/**
+ * \file journal/journal_commit.c
+ *
+ * \brief Make journal records durable, one fsync per group of commits.
+ *
+ * \copyright 2020 Velo Payments.  See License.txt for license terms.
+ */
+
+#include <cbmc/model_assert.h>
+#include <vctool/journal.h>
+
+/**
+ * \brief Wait until a record and every record before it are on stable
+ * storage.
+ *
+ * The first caller to find no commit in progress becomes the leader: it takes
+ * every pending record, writes them and flushes the journal without holding
+ * the lock.  Callers which arrive meanwhile append behind it and wait; the
+ * next leader commits all of their records together, so concurrent commits
+ * share one fsync.
+ *
+ * \param j             The journal.
+ * \param sequence      The sequence number of the record.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - a non-zero error code returned by the file layer, which stops the
+ *        journal.
+ */
+int journal_commit(journal* j, uint64_t sequence)
+{
+    int retval;
+
+    /* parameter sanity checks. */
+    MODEL_ASSERT(NULL != j);
+
+    pthread_mutex_lock(&j->lock);
+
+    while (j->durable < sequence && VCTOOL_STATUS_SUCCESS == j->error)
+    {
+        /* follow the commit in progress; it may cover this record. */
+        if (j->committing)
+        {
+            pthread_cond_wait(&j->committed, &j->lock);
+            continue;
+        }
+
+        /* lead: take the pending records, leaving the spare buffer for
+         * appends made while they are written. */
+        uint8_t* buffer = j->pending;
+        size_t size = j->pending_size;
+        size_t capacity = j->pending_capacity;
+        uint64_t target = j->appended;
+
+        j->pending = j->spare;
+        j->pending_capacity = j->spare_capacity;
+        j->pending_size = 0;
+        j->spare = NULL;
+        j->spare_capacity = 0;
+        j->committing = true;
+
+        pthread_mutex_unlock(&j->lock);
+
+        retval = file_write_all(j->f, j->fd, buffer, size);
+        if (VCTOOL_STATUS_SUCCESS == retval)
+        {
+            retval = file_fsync(j->f, j->fd);
+        }
+
+        pthread_mutex_lock(&j->lock);
+
+        /* keep the written buffer for the next leader. */
+        j->spare = buffer;
+        j->spare_capacity = capacity;
+        j->committing = false;
+        ++j->flushes;
+
+        /* records may have been half written, so the journal stops. */
+        if (VCTOOL_STATUS_SUCCESS == retval)
+        {
+            j->durable = target;
+        }
+        else
+        {
+            j->error = retval;
+        }
+
+        pthread_cond_broadcast(&j->committed);
+    }
+
+    retval = (j->durable >= sequence) ? VCTOOL_STATUS_SUCCESS : j->error;
+
+    pthread_mutex_unlock(&j->lock);
+
+    return retval;
+}
@@ -0,0 +1,585 @@
+/**
+ * \file journal/journal_open.c
+ *
+ * \brief Open a submission journal.
+ *
+ * \copyright 2020 Velo Payments.  See License.txt for license terms.
+ */
+
+#include <cbmc/model_assert.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vctool/crc32c.h>
+#include <vctool/journal.h>
+
+/* the initial number of transaction states. */
+#define JOURNAL_INITIAL_STATES                          1024
+
+/* forward decls. */
+static void journal_dispose(void* disp);
+static int journal_create(journal* j, const char* path);
+static int journal_load(journal* j, const char* path, uint64_t size);
+static int journal_checkpoint_load(
+    journal* j, const char* path, const uint8_t* base, uint64_t size,
+    size_t* capacity, uint64_t* offset);
+static int journal_checkpoint_reset(journal* j, size_t* capacity);
+static char* journal_checkpoint_path(const char* path);
+static int journal_record(
+    journal* j, size_t* capacity, uint32_t state, const uint8_t* txn_id);
+static uint32_t journal_read_u32(const uint8_t* buf);
+static uint64_t journal_read_u64(const uint8_t* buf);
+
+/**
+ * \brief Open a submission journal, creating it if it does not exist.
+ *
+ * \param j             The journal to initialize.
+ * \param f             The file abstraction layer to use.
+ * \param path          The path of the journal.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - VCTOOL_ERROR_JOURNAL_BAD_JOURNAL if path is not a journal.
+ *      - VCTOOL_ERROR_GENERAL_OUT_OF_MEMORY if an allocation failed.
+ *      - a non-zero error code returned by the file layer.
+ */
+int journal_open(journal* j, file* f, const char* path)
+{
+    int retval;
+    file_stat_st fst;
+
+    /* parameter sanity checks. */
+    MODEL_ASSERT(NULL != j);
+    MODEL_ASSERT(PROP_FILE_VALID(f));
+    MODEL_ASSERT(NULL != path);
+
+    /* clear the journal. */
+    memset(j, 0, sizeof(journal));
+    j->f = f;
+    j->fd = -1;
+
+    /* a missing journal, or one torn before its magic was written, holds no
+     * records. */
+    retval = file_stat(f, path, &fst);
+    if (VCTOOL_ERROR_FILE_NO_ENTRY == retval
+     || (VCTOOL_STATUS_SUCCESS == retval
+      && (uint64_t)fst.fst_size < JOURNAL_MAGIC_SIZE))
+    {
+        retval = journal_create(j, path);
+    }
+    else if (VCTOOL_STATUS_SUCCESS == retval)
+    {
+        retval = journal_load(j, path, (uint64_t)fst.fst_size);
+    }
+
+    if (VCTOOL_STATUS_SUCCESS != retval)
+    {
+        goto cleanup_journal;
+    }
+
+    if (0 != pthread_mutex_init(&j->lock, NULL))
+    {
+        retval = VCTOOL_ERROR_GENERAL_OUT_OF_MEMORY;
+        goto cleanup_journal;
+    }
+
+    if (0 != pthread_cond_init(&j->committed, NULL))
+    {
+        retval = VCTOOL_ERROR_GENERAL_OUT_OF_MEMORY;
+        goto cleanup_lock;
+    }
+
+    j->hdr.dispose = &journal_dispose;
+
+    return VCTOOL_STATUS_SUCCESS;
+
+cleanup_lock:
+    pthread_mutex_destroy(&j->lock);
+
+cleanup_journal:
+    if (NULL != j->transactions.hdr.dispose)
+    {
+        dispose((disposable_t*)&j->transactions);
+    }
+
+    free(j->states);
+
+    if (j->fd >= 0)
+    {
+        file_close(f, j->fd);
+    }
+
+    return retval;
+}
+
+/**
+ * \brief Dispose of a journal, committing any records still pending.
+ *
+ * \param disp          The journal to dispose.
+ */
+static void journal_dispose(void* disp)
+{
+    journal* j = (journal*)disp;
+
+    /* a record which can't be committed is sent again on the next run. */
+    journal_commit(j, j->appended);
+
+    file_close(j->f, j->fd);
+    dispose((disposable_t*)&j->transactions);
+    memset(&j->transactions, 0, sizeof(uuid_dict));
+    free(j->states);
+    free(j->pending);
+    free(j->spare);
+    pthread_cond_destroy(&j->committed);
+    pthread_mutex_destroy(&j->lock);
+}
+
+/**
+ * \brief Create an empty journal.
+ *
+ * A checkpoint left from an earlier journal at the same path is removed.
+ *
+ * \param j             The journal being opened.
+ * \param path          The path of the journal.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - a non-zero error code on failure.
+ */
+static int journal_create(journal* j, const char* path)
+{
+    int retval;
+
+    char* checkpoint = journal_checkpoint_path(path);
+    if (NULL == checkpoint)
+    {
+        return VCTOOL_ERROR_GENERAL_OUT_OF_MEMORY;
+    }
+
+    retval = file_unlink(j->f, checkpoint);
+    free(checkpoint);
+    if (VCTOOL_STATUS_SUCCESS != retval
+     && VCTOOL_ERROR_FILE_NO_ENTRY != retval)
+    {
+        return retval;
+    }
+
+    retval =
+        file_open(
+            j->f, &j->fd, path, O_WRONLY | O_CREAT | O_TRUNC | O_APPEND,
+            0600);
+    if (VCTOOL_STATUS_SUCCESS != retval)
+    {
+        return retval;
+    }
+
+    retval = file_write_all(j->f, j->fd, JOURNAL_MAGIC, JOURNAL_MAGIC_SIZE);
+    if (VCTOOL_STATUS_SUCCESS != retval)
+    {
+        return retval;
+    }
+
+    retval = file_fsync(j->f, j->fd);
+    if (VCTOOL_STATUS_SUCCESS != retval)
+    {
+        return retval;
+    }
+
+    return uuid_dict_init(&j->transactions);
+}
+
+/**
+ * \brief Read an existing journal and index its transactions.
+ *
+ * The transactions saved in the checkpoint are loaded first, and only the
+ * records after it are replayed.  If many records were replayed, a new
+ * checkpoint is saved for the next open.
+ *
+ * \param j             The journal being opened.
+ * \param path          The path of the journal.
+ * \param size          The size of the journal.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - VCTOOL_ERROR_JOURNAL_BAD_JOURNAL if path is not a journal.
+ *      - a non-zero error code on failure.
+ */
+static int journal_load(journal* j, const char* path, uint64_t size)
+{
+    int retval;
+    void* map;
+    size_t capacity = 0;
+    uint64_t offset;
+
+    char* checkpoint = journal_checkpoint_path(path);
+    if (NULL == checkpoint)
+    {
+        return VCTOOL_ERROR_GENERAL_OUT_OF_MEMORY;
+    }
+
+    retval = file_open(j->f, &j->fd, path, O_RDWR | O_APPEND, 0);
+    if (VCTOOL_STATUS_SUCCESS != retval)
+    {
+        goto cleanup_checkpoint;
+    }
+
+    retval = uuid_dict_init(&j->transactions);
+    if (VCTOOL_STATUS_SUCCESS != retval)
+    {
+        goto cleanup_checkpoint;
+    }
+
+    retval = file_mmap(j->f, &map, j->fd, (size_t)size);
+    if (VCTOOL_STATUS_SUCCESS != retval)
+    {
+        goto cleanup_checkpoint;
+    }
+
+    const uint8_t* base = (const uint8_t*)map;
+    if (memcmp(base, JOURNAL_MAGIC, JOURNAL_MAGIC_SIZE))
+    {
+        retval = VCTOOL_ERROR_JOURNAL_BAD_JOURNAL;
+        goto cleanup_map;
+    }
+
+    retval =
+        journal_checkpoint_load(
+            j, checkpoint, base, size, &capacity, &offset);
+    if (VCTOOL_STATUS_SUCCESS != retval)
+    {
+        goto cleanup_map;
+    }
+
+    size_t records = (size - offset) / JOURNAL_RECORD_SIZE;
+    size_t tail = (size - offset) % JOURNAL_RECORD_SIZE;
+
+    /* apply the intact records after the checkpoint to their transactions. */
+    const uint8_t* record = base + offset;
+    for (size_t i = 0; i < records; ++i, record += JOURNAL_RECORD_SIZE)
+    {
+        uint32_t checksum = crc32c(0, record, JOURNAL_RECORD_CHECKED_SIZE);
+        if (checksum != journal_read_u32(record + JOURNAL_RECORD_CHECKED_SIZE))
+        {
+            ++j->damaged;
+            continue;
+        }
+
+        uint32_t state = journal_read_u32(record);
+        if (JOURNAL_ACKNOWLEDGED != state && JOURNAL_SUBMITTED != state)
+        {
+            ++j->damaged;
+            continue;
+        }
+
+        retval = journal_record(j, &capacity, state, record + 4);
+        if (VCTOOL_STATUS_SUCCESS != retval)
+        {
+            goto cleanup_map;
+        }
+    }
+
+    /* save a checkpoint once replaying the records costs more than loading
+     * it; a checkpoint which can't be saved only means a longer replay on the
+     * next open. */
+    if (records >= JOURNAL_CHECKPOINT_RECORDS
+     && records >= (size_t)j->transactions.count)
+    {
+        journal_checkpoint_save(
+            j, checkpoint, (uint64_t)(record - base), record - 4);
+    }
+
+    /* pad a torn record out, so that new records are aligned; the padded
+     * record fails its checksum. */
+    if (tail > 0)
+    {
+        uint8_t padding[JOURNAL_RECORD_SIZE];
+        memset(padding, 0, sizeof(padding));
+
+        ++j->damaged;
+        retval =
+            file_write_all(
+                j->f, j->fd, padding, JOURNAL_RECORD_SIZE - tail);
+        if (VCTOOL_STATUS_SUCCESS != retval)
+        {
+            goto cleanup_map;
+        }
+    }
+
+    retval = VCTOOL_STATUS_SUCCESS;
+
+cleanup_map:
+    file_munmap(j->f, map, (size_t)size);
+
+cleanup_checkpoint:
+    free(checkpoint);
+
+    return retval;
+}
+
+/**
+ * \brief Load the transactions saved in a journal checkpoint.
+ *
+ * A missing checkpoint, or one which is damaged or doesn't match the
+ * journal, is ignored, and the whole journal is replayed.
+ *
+ * \param j             The journal being opened, with no transactions.
+ * \param path          The path of the checkpoint.
+ * \param base          The mapped journal.
+ * \param size          The size of the journal.
+ * \param capacity      Set to the number of states allocated.
+ * \param offset        Set to the journal offset of the first record to
+ *                      replay.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - VCTOOL_ERROR_GENERAL_OUT_OF_MEMORY if an allocation failed.
+ *      - a non-zero error code on failure.
+ */
+static int journal_checkpoint_load(
+    journal* j, const char* path, const uint8_t* base, uint64_t size,
+    size_t* capacity, uint64_t* offset)
+{
+    int retval, fd;
+    file_stat_st fst;
+    void* map;
+
+    *offset = JOURNAL_MAGIC_SIZE;
+
+    retval = file_stat(j->f, path, &fst);
+    if (VCTOOL_STATUS_SUCCESS != retval)
+    {
+        return VCTOOL_STATUS_SUCCESS;
+    }
+
+    size_t ckpt_size = (size_t)fst.fst_size;
+    if (ckpt_size < JOURNAL_CHECKPOINT_HEADER_SIZE + 4)
+    {
+        return VCTOOL_STATUS_SUCCESS;
+    }
+
+    retval = file_open(j->f, &fd, path, O_RDONLY, 0);
+    if (VCTOOL_STATUS_SUCCESS != retval)
+    {
+        return VCTOOL_STATUS_SUCCESS;
+    }
+
+    retval = file_mmap(j->f, &map, fd, ckpt_size);
+    file_close(j->f, fd);
+    if (VCTOOL_STATUS_SUCCESS != retval)
+    {
+        return VCTOOL_STATUS_SUCCESS;
+    }
+
+    /* the checkpoint must be whole, and must end on a record of this
+     * journal. */
+    const uint8_t* ckpt = (const uint8_t*)map;
+    uint64_t covered = journal_read_u64(ckpt + 8);
+    uint64_t count = journal_read_u64(ckpt + 20);
+    size_t checked_size = ckpt_size - 4;
+    if (memcmp(ckpt, JOURNAL_CHECKPOINT_MAGIC, JOURNAL_CHECKPOINT_MAGIC_SIZE)
+     || count > (uint64_t)UUID_DICT_MAX_ID + 1
+     || JOURNAL_CHECKPOINT_HEADER_SIZE + count * (UUID_SIZE + 1)
+            != checked_size
+     || crc32c(0, ckpt, checked_size)
+            != journal_read_u32(ckpt + checked_size)
+     || covered < JOURNAL_MAGIC_SIZE + JOURNAL_RECORD_SIZE
+     || covered > size
+     || 0 != (covered - JOURNAL_MAGIC_SIZE) % JOURNAL_RECORD_SIZE
+     || memcmp(base + covered - 4, ckpt + 16, 4))
+    {
+        retval = VCTOOL_STATUS_SUCCESS;
+        goto cleanup_map;
+    }
+
+    if (count > 0)
+    {
+        j->states = (uint8_t*)malloc((size_t)count);
+        if (NULL == j->states)
+        {
+            retval = VCTOOL_ERROR_GENERAL_OUT_OF_MEMORY;
+            goto cleanup_map;
+        }
+
+        *capacity = (size_t)count;
+    }
+
+    /* intern every id in id order, which reproduces the saved ids. */
+    const uint8_t* ids = ckpt + JOURNAL_CHECKPOINT_HEADER_SIZE;
+    const uint8_t* states = ids + count * UUID_SIZE;
+    for (uint64_t i = 0; i < count; ++i)
+    {
+        uint32_t id;
+        retval = uuid_dict_intern(&j->transactions, ids + i * UUID_SIZE, &id);
+        if (VCTOOL_STATUS_SUCCESS != retval)
+        {
+            goto cleanup_map;
+        }
+
+        /* a duplicate id or an unknown state doesn't match any journal. */
+        if (id != i
+         || (JOURNAL_ACKNOWLEDGED != states[i]
+          && JOURNAL_SUBMITTED != states[i]))
+        {
+            retval = journal_checkpoint_reset(j, capacity);
+            goto cleanup_map;
+        }
+
+        j->states[id] = states[i];
+        if (JOURNAL_ACKNOWLEDGED == states[i])
+        {
+            ++j->acknowledged;
+        }
+        else
+        {
+            ++j->uncertain;
+        }
+    }
+
+    *offset = covered;
+    retval = VCTOOL_STATUS_SUCCESS;
+
+cleanup_map:
+    file_munmap(j->f, map, ckpt_size);
+
+    return retval;
+}
+
+/**
+ * \brief Forget the transactions loaded from a checkpoint which turned out
+ * not to match the journal.
+ *
+ * \param j             The journal being opened.
+ * \param capacity      Set to the number of states allocated.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - a non-zero error code returned by uuid_dict_init.
+ */
+static int journal_checkpoint_reset(journal* j, size_t* capacity)
+{
+    dispose((disposable_t*)&j->transactions);
+    memset(&j->transactions, 0, sizeof(uuid_dict));
+    free(j->states);
+    j->states = NULL;
+    j->acknowledged = 0;
+    j->uncertain = 0;
+    *capacity = 0;
+
+    return uuid_dict_init(&j->transactions);
+}
+
+/**
+ * \brief Build the path of a journal's checkpoint.
+ *
+ * \param path          The path of the journal.
+ *
+ * \returns the path, which the caller must free, or NULL if an allocation
+ *          failed.
+ */
+static char* journal_checkpoint_path(const char* path)
+{
+    size_t checkpoint_size =
+        strlen(path)
+      + sizeof(JOURNAL_CHECKPOINT_SUFFIX);
+    char* checkpoint = (char*)malloc(checkpoint_size);
+    if (NULL != checkpoint)
+    {
+        snprintf(
+            checkpoint, checkpoint_size, "%s%s", path,
+            JOURNAL_CHECKPOINT_SUFFIX);
+    }
+
+    return checkpoint;
+}
+
+/**
+ * \brief Apply a record to the state of its transaction.
+ *
+ * A submission is uncertain until it is acknowledged, and stays acknowledged
+ * however many times it is submitted again.
+ *
+ * \param j             The journal being opened.
+ * \param capacity      The number of states allocated; grown as needed.
+ * \param state         JOURNAL_SUBMITTED or JOURNAL_ACKNOWLEDGED.
+ * \param txn_id        The transaction id.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - VCTOOL_ERROR_GENERAL_OUT_OF_MEMORY if an allocation failed.
+ *      - a non-zero error code returned by uuid_dict_intern.
+ */
+static int journal_record(
+    journal* j, size_t* capacity, uint32_t state, const uint8_t* txn_id)
+{
+    int retval;
+    uint32_t id, count = j->transactions.count;
+
+    retval = uuid_dict_intern(&j->transactions, txn_id, &id);
+    if (VCTOOL_STATUS_SUCCESS != retval)
+    {
+        return retval;
+    }
+
+    /* a new transaction starts out uncertain. */
+    if (j->transactions.count != count)
+    {
+        if ((size_t)id == *capacity)
+        {
+            size_t grown =
+                (0 == *capacity) ? JOURNAL_INITIAL_STATES : 2 * *capacity;
+            uint8_t* tmp = (uint8_t*)realloc(j->states, grown);
+            if (NULL == tmp)
+            {
+                return VCTOOL_ERROR_GENERAL_OUT_OF_MEMORY;
+            }
+
+            j->states = tmp;
+            *capacity = grown;
+        }
+
+        j->states[id] = JOURNAL_SUBMITTED;
+        ++j->uncertain;
+    }
+
+    if (JOURNAL_ACKNOWLEDGED == state && JOURNAL_SUBMITTED == j->states[id])
+    {
+        j->states[id] = JOURNAL_ACKNOWLEDGED;
+        --j->uncertain;
+        ++j->acknowledged;
+    }
+
+    return VCTOOL_STATUS_SUCCESS;
+}
+
+/**
+ * \brief Read a big-endian 32-bit value.
+ *
+ * \param buf           The buffer to read.
+ *
+ * \returns the value.
+ */
+static uint32_t journal_read_u32(const uint8_t* buf)
+{
+    return
+        ((uint32_t)buf[0] << 24) | ((uint32_t)buf[1] << 16)
+      | ((uint32_t)buf[2] << 8) | (uint32_t)buf[3];
+}
+
+/**
+ * \brief Read a big-endian 64-bit value.
+ *
+ * \param buf           The buffer to read.
+ *
+ * \returns the value.
+ */
+static uint64_t journal_read_u64(const uint8_t* buf)
+{
+    uint64_t value = 0;
+    for (int i = 0; i < 8; ++i)
+    {
+        value = (value << 8) | buf[i];
+    }
+
+    return value;
+}
@@ -0,0 +1,35 @@
+/**
+ * \file journal/journal_state.c
+ *
+ * \brief Look up the state of a transaction in a journal.
+ *
+ * \copyright 2020 Velo Payments.  See License.txt for license terms.
+ */
+
+#include <cbmc/model_assert.h>
+#include <vctool/journal.h>
+
+/**
+ * \brief Look up the state of a transaction when the journal was opened.
+ *
+ * \param j             The journal to search.
+ * \param txn_id        The transaction id.
+ *
+ * \returns JOURNAL_ACKNOWLEDGED, JOURNAL_SUBMITTED if the transaction was
+ *          sent but its outcome is uncertain, or JOURNAL_UNKNOWN.
+ */
+uint32_t journal_state(const journal* j, const uint8_t* txn_id)
+{
+    /* parameter sanity checks. */
+    MODEL_ASSERT(NULL != j);
+    MODEL_ASSERT(NULL != txn_id);
+
+    uint32_t id;
+    int retval = uuid_dict_find(&j->transactions, txn_id, &id);
+    if (VCTOOL_STATUS_SUCCESS != retval)
+    {
+        return JOURNAL_UNKNOWN;
+    }
+
+    return j->states[id];
+}
@@ -0,0 +1,62 @@
+/**
+ * \file journal/journal_transaction_id.c
+ *
+ * \brief Find the transaction id of a transaction certificate.
+ *
+ * \copyright 2020 Velo Payments.  See License.txt for license terms.
+ */
+
+#include <cbmc/model_assert.h>
+#include <string.h>
+#include <vccert/fields.h>
+#include <vctool/journal.h>
+
+/* the size of a certificate field header. */
+#define JOURNAL_FIELD_HEADER_SIZE                       4
+
+/**
+ * \brief Find the transaction id of a transaction certificate.
+ *
+ * Fields are walked as a big-endian 2 byte type and 2 byte size, followed by
+ * the value; the first certificate id field is used.
+ *
+ * \param txn_id        Set to the value of the certificate's
+ *                      VCCERT_FIELD_TYPE_CERTIFICATE_ID field.
+ * \param cert          The transaction certificate.
+ * \param size          The size of the certificate.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - VCTOOL_ERROR_JOURNAL_NO_TRANSACTION_ID if the certificate has no
+ *        transaction id.
+ */
+int journal_transaction_id(
+    uint8_t* txn_id, const uint8_t* cert, size_t size)
+{
+    /* parameter sanity checks. */
+    MODEL_ASSERT(NULL != txn_id);
+    MODEL_ASSERT(NULL != cert);
+
+    size_t offset = 0;
+    while (offset + JOURNAL_FIELD_HEADER_SIZE <= size)
+    {
+        const uint8_t* field = cert + offset;
+        uint16_t type = (uint16_t)((field[0] << 8) | field[1]);
+        uint16_t field_size = (uint16_t)((field[2] << 8) | field[3]);
+
+        offset += JOURNAL_FIELD_HEADER_SIZE + field_size;
+        if (offset > size)
+        {
+            break;
+        }
+
+        if (VCCERT_FIELD_TYPE_CERTIFICATE_ID == type
+         && UUID_SIZE == field_size)
+        {
+            memcpy(txn_id, field + JOURNAL_FIELD_HEADER_SIZE, UUID_SIZE);
+            return VCTOOL_STATUS_SUCCESS;
+        }
+    }
+
+    return VCTOOL_ERROR_JOURNAL_NO_TRANSACTION_ID;
+}
@@ -0,0 +1,417 @@
+/**
+ * \file mph/mph_build.c
+ *
+ * \brief Build a minimal perfect hash.
+ *
+ * \copyright 2020 Velo Payments.  See License.txt for license terms.
+ */
+
+#include <cbmc/model_assert.h>
+#include <endian.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <vctool/mph.h>
+
+/**
+ * \brief The build passes run by worker threads.
+ */
+typedef enum mph_build_pass
+{
+    MPH_PASS_HASH,
+    MPH_PASS_MARK,
+    MPH_PASS_SPLIT,
+} mph_build_pass;
+
+/**
+ * \brief A slice of build work for one thread.
+ */
+typedef struct mph_build_task
+{
+    pthread_t thread;
+    mph_build_pass pass;
+    const uint8_t* keys;
+    uint64_t* hashes;
+    size_t begin;
+    size_t end;
+    uint64_t* seen;
+    uint64_t* collide;
+    uint64_t bits;
+    uint32_t level;
+    size_t kept;
+} mph_build_task;
+
+/* forward decls. */
+static int mph_run_pass(
+    mph_build_task* tasks, unsigned thread_count, mph_build_pass pass);
+static void* mph_build_worker(void* arg);
+static void mph_build_slice(
+    mph_build_task* tasks, unsigned thread_count, size_t count);
+static int mph_hash_compare(const void* lhs, const void* rhs);
+
+/**
+ * \brief Build a minimal perfect hash over a set of distinct keys.
+ *
+ * \param m             The perfect hash to initialize.
+ * \param keys          Array of MPH_KEY_SIZE byte keys.
+ * \param count         The number of keys.
+ * \param threads       The number of build threads, or 0 to use one per
+ *                      online processor.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - VCTOOL_ERROR_MPH_HASH_COLLISION if two keys share a hash; this is
+ *        practically only possible if keys are duplicated.
+ *      - VCTOOL_ERROR_MPH_THREAD if a build thread could not be started.
+ *      - VCTOOL_ERROR_GENERAL_OUT_OF_MEMORY if an allocation failed.
+ */
+int mph_build(mph* m, const uint8_t* keys, size_t count, unsigned threads)
+{
+    int retval;
+    uint64_t level_words[MPH_MAX_LEVELS];
+    uint64_t* level_bits = NULL;
+    uint64_t total_words = 0;
+    uint32_t level_count = 0;
+    uint64_t* seen = NULL;
+    uint64_t* collide = NULL;
+
+    /* parameter sanity checks. */
+    MODEL_ASSERT(NULL != m);
+    MODEL_ASSERT(0 == count || NULL != keys);
+
+    /* clear the hash. */
+    memset(m, 0, sizeof(mph));
+
+    /* default to one thread per processor. */
+    if (0 == threads)
+    {
+        long online = sysconf(_SC_NPROCESSORS_ONLN);
+        threads = (online > 0) ? (unsigned)online : 1;
+    }
+
+    /* allocate the task slices. */
+    mph_build_task* tasks =
+        (mph_build_task*)calloc(threads, sizeof(mph_build_task));
+    if (NULL == tasks)
+    {
+        retval = VCTOOL_ERROR_GENERAL_OUT_OF_MEMORY;
+        goto done;
+    }
+
+    /* allocate the working set of key hashes. */
+    uint64_t* hashes = (uint64_t*)malloc((count + 1) * sizeof(uint64_t));
+    if (NULL == hashes)
+    {
+        retval = VCTOOL_ERROR_GENERAL_OUT_OF_MEMORY;
+        goto cleanup_tasks;
+    }
+
+    /* hash every key. */
+    unsigned thread_count = threads;
+    if (count / MPH_MIN_KEYS_PER_THREAD < thread_count)
+    {
+        thread_count = (unsigned)(count / MPH_MIN_KEYS_PER_THREAD) + 1;
+    }
+    mph_build_slice(tasks, thread_count, count);
+    for (unsigned t = 0; t < thread_count; ++t)
+    {
+        tasks[t].keys = keys;
+        tasks[t].hashes = hashes;
+    }
+    retval = mph_run_pass(tasks, thread_count, MPH_PASS_HASH);
+    if (VCTOOL_STATUS_SUCCESS != retval)
+    {
+        goto cleanup_hashes;
+    }
+
+    /* place keys level by level until none collide. */
+    size_t remaining = count;
+    while (remaining > 0 && level_count < MPH_MAX_LEVELS)
+    {
+        uint64_t words = (MPH_GAMMA * (uint64_t)remaining + 63) / 64;
+        uint64_t bits = words * 64;
+
+        /* allocate the bit arrays for this level. */
+        seen = (uint64_t*)calloc(words, sizeof(uint64_t));
+        collide = (uint64_t*)calloc(words, sizeof(uint64_t));
+        uint64_t* tmp =
+            (uint64_t*)realloc(
+                level_bits, (total_words + words) * sizeof(uint64_t));
+        if (NULL != tmp)
+        {
+            level_bits = tmp;
+        }
+        if (NULL == seen || NULL == collide || NULL == tmp)
+        {
+            retval = VCTOOL_ERROR_GENERAL_OUT_OF_MEMORY;
+            goto cleanup_level;
+        }
+
+        /* split the remaining keys across threads. */
+        thread_count = threads;
+        if (remaining / MPH_MIN_KEYS_PER_THREAD < thread_count)
+        {
+            thread_count = (unsigned)(remaining / MPH_MIN_KEYS_PER_THREAD) + 1;
+        }
+        mph_build_slice(tasks, thread_count, remaining);
+        for (unsigned t = 0; t < thread_count; ++t)
+        {
+            tasks[t].hashes = hashes;
+            tasks[t].seen = seen;
+            tasks[t].collide = collide;
+            tasks[t].bits = bits;
+            tasks[t].level = level_count;
+        }
+
+        /* mark the bit of every key, noting collisions. */
+        retval = mph_run_pass(tasks, thread_count, MPH_PASS_MARK);
+        if (VCTOOL_STATUS_SUCCESS != retval)
+        {
+            goto cleanup_level;
+        }
+
+        /* keep the keys which collided for the next level. */
+        retval = mph_run_pass(tasks, thread_count, MPH_PASS_SPLIT);
+        if (VCTOOL_STATUS_SUCCESS != retval)
+        {
+            goto cleanup_level;
+        }
+
+        remaining = tasks[0].kept;
+        for (unsigned t = 1; t < thread_count; ++t)
+        {
+            memmove(
+                hashes + remaining, hashes + tasks[t].begin,
+                tasks[t].kept * sizeof(uint64_t));
+            remaining += tasks[t].kept;
+        }
+
+        /* this level holds the keys which did not collide. */
+        for (uint64_t w = 0; w < words; ++w)
+        {
+            level_bits[total_words + w] = seen[w] & ~collide[w];
+        }
+
+        level_words[level_count++] = words;
+        total_words += words;
+
+        free(seen);
+        free(collide);
+        seen = collide = NULL;
+    }
+
+    /* the stragglers go in the fallback table, sorted by hash. */
+    qsort(hashes, remaining, sizeof(uint64_t), &mph_hash_compare);
+    for (size_t i = 1; i < remaining; ++i)
+    {
+        if (hashes[i - 1] == hashes[i])
+        {
+            retval = VCTOOL_ERROR_MPH_HASH_COLLISION;
+            goto cleanup_level;
+        }
+    }
+
+    /* allocate the serialized form. */
+    uint64_t rank_count = (total_words + MPH_RANK_WORDS - 1) / MPH_RANK_WORDS;
+    size_t size =
+        (3 + level_count + total_words + rank_count + 2 * remaining)
+            * sizeof(uint64_t);
+    uint64_t* out = (uint64_t*)malloc(size);
+    if (NULL == out)
+    {
+        retval = VCTOOL_ERROR_GENERAL_OUT_OF_MEMORY;
+        goto cleanup_level;
+    }
+
+    /* write the header and level sizes. */
+    uint64_t* pos = out;
+    *pos++ = htole64(MPH_MAGIC);
+    *pos++ = htole64((uint64_t)count);
+    *pos++ = htole64((uint64_t)level_count | ((uint64_t)remaining << 32));
+    for (uint32_t level = 0; level < level_count; ++level)
+    {
+        *pos++ = htole64(level_words[level]);
+    }
+
+    /* write the level bits. */
+    for (uint64_t w = 0; w < total_words; ++w)
+    {
+        *pos++ = htole64(level_bits[w]);
+    }
+
+    /* write the ranks. */
+    uint64_t rank = 0;
+    for (uint64_t w = 0; w < total_words; ++w)
+    {
+        if (0 == w % MPH_RANK_WORDS)
+        {
+            *pos++ = htole64(rank);
+        }
+
+        rank += __builtin_popcountll(level_bits[w]);
+    }
+
+    /* fallback keys are indexed after all ranked keys. */
+    for (size_t i = 0; i < remaining; ++i)
+    {
+        *pos++ = htole64(hashes[i]);
+        *pos++ = htole64(rank + i);
+    }
+
+    /* initialize the hash from its serialized form. */
+    retval = mph_view(m, out, size);
+    if (VCTOOL_STATUS_SUCCESS != retval)
+    {
+        free(out);
+        goto cleanup_level;
+    }
+
+    /* this instance owns the serialized form. */
+    m->storage = out;
+
+    /* success. */
+    retval = VCTOOL_STATUS_SUCCESS;
+
+cleanup_level:
+    free(seen);
+    free(collide);
+    free(level_bits);
+
+cleanup_hashes:
+    free(hashes);
+
+cleanup_tasks:
+    free(tasks);
+
+done:
+    return retval;
+}
+
+/**
+ * \brief Split count keys evenly across thread_count tasks.
+ *
+ * \param tasks         The tasks.
+ * \param thread_count  The number of tasks to use.
+ * \param count         The number of keys.
+ */
+static void mph_build_slice(
+    mph_build_task* tasks, unsigned thread_count, size_t count)
+{
+    for (unsigned t = 0; t < thread_count; ++t)
+    {
+        tasks[t].begin = (count * t) / thread_count;
+        tasks[t].end = (count * (t + 1)) / thread_count;
+        tasks[t].kept = 0;
+    }
+}
+
+/**
+ * \brief Run a build pass over all tasks, on one thread per task.
+ *
+ * \param tasks         The tasks.
+ * \param thread_count  The number of tasks to run.
+ * \param pass          The pass to run.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - VCTOOL_ERROR_MPH_THREAD if a thread could not be started.
+ */
+static int mph_run_pass(
+    mph_build_task* tasks, unsigned thread_count, mph_build_pass pass)
+{
+    int retval = VCTOOL_STATUS_SUCCESS;
+    unsigned started = 1;
+
+    for (unsigned t = 0; t < thread_count; ++t)
+    {
+        tasks[t].pass = pass;
+    }
+
+    /* start a thread for every task but the first. */
+    for (; started < thread_count; ++started)
+    {
+        if (0 !=
+                pthread_create(
+                    &tasks[started].thread, NULL, &mph_build_worker,
+                    &tasks[started]))
+        {
+            retval = VCTOOL_ERROR_MPH_THREAD;
+            break;
+        }
+    }
+
+    /* the calling thread runs the first task. */
+    mph_build_worker(&tasks[0]);
+
+    /* wait for the others. */
+    for (unsigned t = 1; t < started; ++t)
+    {
+        pthread_join(tasks[t].thread, NULL);
+    }
+
+    return retval;
+}
+
+/**
+ * \brief Run one build pass over one task's slice of keys.
+ *
+ * \param arg           The task.
+ *
+ * \returns NULL.
+ */
+static void* mph_build_worker(void* arg)
+{
+    mph_build_task* task = (mph_build_task*)arg;
+    size_t kept = task->begin;
+
+    for (size_t i = task->begin; i < task->end; ++i)
+    {
+        if (MPH_PASS_HASH == task->pass)
+        {
+            task->hashes[i] = mph_key_hash(task->keys + i * MPH_KEY_SIZE);
+            continue;
+        }
+
+        uint64_t pos =
+            mph_level_position(task->hashes[i], task->level, task->bits);
+        uint64_t bit = UINT64_C(1) << (pos % 64);
+
+        if (MPH_PASS_MARK == task->pass)
+        {
+            /* a bit set twice is a collision. */
+            uint64_t old =
+                __atomic_fetch_or(&task->seen[pos / 64], bit, __ATOMIC_RELAXED);
+            if (old & bit)
+            {
+                __atomic_fetch_or(
+                    &task->collide[pos / 64], bit, __ATOMIC_RELAXED);
+            }
+        }
+        else if (task->collide[pos / 64] & bit)
+        {
+            /* compact colliding keys to the front of this slice. */
+            task->hashes[kept++] = task->hashes[i];
+        }
+    }
+
+    task->kept = kept - task->begin;
+
+    return NULL;
+}
+
+/**
+ * \brief Compare two key hashes.
+ *
+ * \param lhs           The left-hand hash.
+ * \param rhs           The right-hand hash.
+ *
+ * \returns <0, 0, or >0 as lhs is less than, equal to, or greater than rhs.
+ */
+static int mph_hash_compare(const void* lhs, const void* rhs)
+{
+    uint64_t l = *(const uint64_t*)lhs;
+    uint64_t r = *(const uint64_t*)rhs;
+
+    return (l > r) - (l < r);
+}
@@ -0,0 +1,40 @@
+/**
+ * \file mph/mph_key_hash.c
+ *
+ * \brief Hash a perfect hash key.
+ *
+ * \copyright 2020 Velo Payments.  See License.txt for license terms.
+ */
+
+#include <cbmc/model_assert.h>
+#include <string.h>
+#include <vctool/mph.h>
+
+/**
+ * \brief Hash a key.
+ *
+ * \param key           The MPH_KEY_SIZE byte key.
+ *
+ * \returns the 64-bit hash of this key.
+ */
+uint64_t mph_key_hash(const uint8_t* key)
+{
+    uint64_t hi, lo;
+
+    /* parameter sanity checks. */
+    MODEL_ASSERT(NULL != key);
+
+    memcpy(&hi, key, sizeof(hi));
+    memcpy(&lo, key + sizeof(hi), sizeof(lo));
+
+    /* two rounds of a 64-bit finalizer over the folded key. */
+    uint64_t x = hi ^ (lo * UINT64_C(0x9e3779b97f4a7c15));
+    x = (x ^ (x >> 30)) * UINT64_C(0xbf58476d1ce4e5b9);
+    x = (x ^ (x >> 27)) * UINT64_C(0x94d049bb133111eb);
+    x ^= x >> 31;
+    x ^= lo;
+    x = (x ^ (x >> 30)) * UINT64_C(0xbf58476d1ce4e5b9);
+    x = (x ^ (x >> 27)) * UINT64_C(0x94d049bb133111eb);
+
+    return x ^ (x >> 31);
+}
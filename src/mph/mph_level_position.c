@@ -0,0 +1,30 @@
+/**
+ * \file mph/mph_level_position.c
+ *
+ * \brief Compute the position of a key hash in a level.
+ *
+ * \copyright 2020 Velo Payments.  See License.txt for license terms.
+ */
+
+#include <vctool/mph.h>
+
+/**
+ * \brief Compute the position of a key hash in a level.
+ *
+ * \param hash          The key hash.
+ * \param level         The level.
+ * \param bits          The number of bits in this level.
+ *
+ * \returns the bit position within this level.
+ */
+uint64_t mph_level_position(uint64_t hash, uint32_t level, uint64_t bits)
+{
+    /* remix the hash with the level as a seed. */
+    uint64_t x = hash + (uint64_t)(level + 1) * UINT64_C(0x9e3779b97f4a7c15);
+    x = (x ^ (x >> 30)) * UINT64_C(0xbf58476d1ce4e5b9);
+    x = (x ^ (x >> 27)) * UINT64_C(0x94d049bb133111eb);
+    x ^= x >> 31;
+
+    /* map onto [0, bits) without a division. */
+    return (uint64_t)(((unsigned __int128)x * bits) >> 64);
+}
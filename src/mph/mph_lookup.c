@@ -0,0 +1,77 @@
+/**
+ * \file mph/mph_lookup.c
+ *
+ * \brief Look up a key in a minimal perfect hash.
+ *
+ * \copyright 2020 Velo Payments.  See License.txt for license terms.
+ */
+
+#include <cbmc/model_assert.h>
+#include <endian.h>
+#include <vctool/mph.h>
+
+/**
+ * \brief Look up the index of a key.
+ *
+ * \param m             The perfect hash.
+ * \param key           The MPH_KEY_SIZE byte key.
+ *
+ * \returns the index of this key if it was in the build set, and either
+ *          MPH_NOT_FOUND or an arbitrary index otherwise.
+ */
+uint64_t mph_lookup(const mph* m, const uint8_t* key)
+{
+    /* parameter sanity checks. */
+    MODEL_ASSERT(NULL != m);
+    MODEL_ASSERT(NULL != key);
+
+    uint64_t hash = mph_key_hash(key);
+
+    /* find the first level where this key's bit is set. */
+    for (uint32_t level = 0; level < m->level_count; ++level)
+    {
+        uint64_t bits = m->level_offset[level + 1] - m->level_offset[level];
+        uint64_t pos =
+            m->level_offset[level] + mph_level_position(hash, level, bits);
+        uint64_t word = le64toh(m->bits[pos / 64]);
+        uint64_t bit = UINT64_C(1) << (pos % 64);
+
+        if (word & bit)
+        {
+            /* the index is the number of set bits before this one. */
+            size_t w = pos / 64;
+            size_t group = w / MPH_RANK_WORDS;
+            uint64_t rank = le64toh(m->ranks[group]);
+
+            for (size_t i = group * MPH_RANK_WORDS; i < w; ++i)
+            {
+                rank += __builtin_popcountll(le64toh(m->bits[i]));
+            }
+
+            return rank + __builtin_popcountll(word & (bit - 1));
+        }
+    }
+
+    /* otherwise, search the fallback table. */
+    size_t lo = 0, hi = m->fallback_count;
+    while (lo < hi)
+    {
+        size_t mid = lo + (hi - lo) / 2;
+        uint64_t fhash = le64toh(m->fallback[2 * mid]);
+
+        if (fhash == hash)
+        {
+            return le64toh(m->fallback[2 * mid + 1]);
+        }
+        else if (fhash < hash)
+        {
+            lo = mid + 1;
+        }
+        else
+        {
+            hi = mid;
+        }
+    }
+
+    return MPH_NOT_FOUND;
+}
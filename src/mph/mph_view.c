@@ -0,0 +1,115 @@
+/**
+ * \file mph/mph_view.c
+ *
+ * \brief Initialize a minimal perfect hash from its serialized form.
+ *
+ * \copyright 2020 Velo Payments.  See License.txt for license terms.
+ */
+
+#include <cbmc/model_assert.h>
+#include <endian.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vctool/mph.h>
+
+/* forward decls. */
+static void mph_dispose(void* disp);
+
+/**
+ * \brief Initialize a perfect hash from its serialized form, in place.
+ *
+ * The buffer must be 8-byte aligned and must outlive this instance.
+ *
+ * \param m             The perfect hash to initialize.
+ * \param data          The serialized form.
+ * \param size          The size of the serialized form.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - VCTOOL_ERROR_MPH_BAD_FORMAT if the serialized form is malformed.
+ */
+int mph_view(mph* m, const void* data, size_t size)
+{
+    /* parameter sanity checks. */
+    MODEL_ASSERT(NULL != m);
+    MODEL_ASSERT(NULL != data);
+
+    /* clear the hash. */
+    memset(m, 0, sizeof(mph));
+
+    /* the serialized form is made of aligned words. */
+    const uint64_t* words = (const uint64_t*)data;
+    size_t word_count = size / sizeof(uint64_t);
+    if (0 != (uintptr_t)data % sizeof(uint64_t)
+     || 0 != size % sizeof(uint64_t)
+     || word_count < 3)
+    {
+        return VCTOOL_ERROR_MPH_BAD_FORMAT;
+    }
+
+    /* decode the header. */
+    uint64_t counts = le64toh(words[2]);
+    m->key_count = le64toh(words[1]);
+    m->level_count = (uint32_t)(counts & 0xffffffff);
+    m->fallback_count = (uint32_t)(counts >> 32);
+    if (MPH_MAGIC != le64toh(words[0])
+     || m->level_count > MPH_MAX_LEVELS
+     || m->fallback_count > word_count
+     || m->level_count > word_count - 3)
+    {
+        return VCTOOL_ERROR_MPH_BAD_FORMAT;
+    }
+
+    /* decode the level sizes. */
+    size_t pos = 3;
+    uint64_t total = 0;
+    for (uint32_t level = 0; level < m->level_count; ++level)
+    {
+        uint64_t level_words = le64toh(words[pos + level]);
+        if (0 == level_words || level_words > word_count)
+        {
+            return VCTOOL_ERROR_MPH_BAD_FORMAT;
+        }
+
+        m->level_offset[level] = total * 64;
+        total += level_words;
+    }
+    m->level_offset[m->level_count] = total * 64;
+    pos += m->level_count;
+
+    /* the remaining sections must exactly fill the buffer. */
+    uint64_t rank_count = (total + MPH_RANK_WORDS - 1) / MPH_RANK_WORDS;
+    if (total > word_count
+     || pos + total + rank_count + 2 * (uint64_t)m->fallback_count
+            != word_count)
+    {
+        return VCTOOL_ERROR_MPH_BAD_FORMAT;
+    }
+
+    /* set up the views into the buffer. */
+    m->hdr.dispose = &mph_dispose;
+    m->bits = words + pos;
+    m->ranks = m->bits + total;
+    m->fallback = m->ranks + rank_count;
+    m->data = data;
+    m->size = size;
+
+    /* success. */
+    return VCTOOL_STATUS_SUCCESS;
+}
+
+/**
+ * \brief Dispose of a perfect hash.
+ *
+ * \param disp          The perfect hash to dispose.
+ */
+static void mph_dispose(void* disp)
+{
+    mph* m = (mph*)disp;
+
+    /* free the serialized form if this instance owns it. */
+    free(m->storage);
+
+    /* clear the hash. */
+    memset(m, 0, sizeof(mph));
+}
@@ -0,0 +1,207 @@
+/**
+ * \file query/query_answer.c
+ *
+ * \brief Answer a single query request.
+ *
+ * \copyright 2020 Velo Payments.  See License.txt for license terms.
+ */
+
+#include <cbmc/model_assert.h>
+#include <vctool/agent.h>
+#include <vctool/query.h>
+
+/* forward decls. */
+static int query_send_entry(
+    query_index* index, int sock, uint32_t type, const query_entry* entry,
+    size_t* total);
+static int query_send_end(
+    query_index* index, int sock, int status, size_t* total);
+static void query_write_u32(uint8_t* buf, uint32_t val);
+
+/**
+ * \brief Answer a single request.
+ *
+ * A malformed request is answered with VCTOOL_ERROR_QUERY_BAD_REQUEST.
+ *
+ * \param index         The index to search.
+ * \param sock          The client connection.
+ * \param request       The request.
+ * \param sent          Set to the number of bytes sent, or NULL.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS if the response was sent.
+ *      - a non-zero error code if the connection failed.
+ */
+int query_answer(
+    query_index* index, int sock, const agent_frame* request, size_t* sent)
+{
+    int retval;
+    size_t total = 0;
+    const query_entry* entry = NULL;
+    size_t count = 0;
+    uint32_t type = QUERY_RESP_TRANSACTION;
+
+    /* parameter sanity checks. */
+    MODEL_ASSERT(NULL != index);
+    MODEL_ASSERT(sock >= 0);
+    MODEL_ASSERT(NULL != request);
+
+    if (QUERY_REQ_HEIGHT == request->type && 8 == request->size)
+    {
+        uint64_t height = 0;
+        for (int i = 0; i < 8; ++i)
+        {
+            height = (height << 8) | request->payload[i];
+        }
+
+        entry = query_index_find_height(index, height);
+        type = QUERY_RESP_BLOCK;
+    }
+    else if (QUERY_REQ_BLOCK == request->type && UUID_SIZE == request->size)
+    {
+        entry = query_index_find_block(index, request->payload);
+        type = QUERY_RESP_BLOCK;
+    }
+    else if (QUERY_REQ_TRANSACTION == request->type
+          && UUID_SIZE == request->size)
+    {
+        entry = query_index_find_transaction(index, request->payload);
+    }
+    else if (QUERY_REQ_ARTIFACT == request->type
+          && UUID_SIZE == request->size)
+    {
+        entry = query_index_find_artifact(index, request->payload, &count);
+    }
+    else
+    {
+        /* the frame was intact, so the connection can carry on. */
+        retval =
+            query_send_end(
+                index, sock, VCTOOL_ERROR_QUERY_BAD_REQUEST, &total);
+        goto done;
+    }
+
+    /* a single lookup finds at most one certificate. */
+    if (QUERY_REQ_ARTIFACT != request->type)
+    {
+        count = (NULL == entry) ? 0 : 1;
+    }
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        retval = query_send_entry(index, sock, type, entry + i, &total);
+        if (VCTOOL_STATUS_SUCCESS != retval)
+        {
+            goto done;
+        }
+    }
+
+    retval = query_send_end(index, sock, VCTOOL_STATUS_SUCCESS, &total);
+
+done:
+    if (NULL != sent)
+    {
+        *sent = total;
+    }
+
+    return retval;
+}
+
+/**
+ * \brief Send a certificate from the segment as a frame.
+ *
+ * Only the frame header is written from user space; the certificate itself
+ * goes from the page cache to the socket with sendfile.
+ *
+ * \param index         The index whose segment holds the certificate.
+ * \param sock          The client connection.
+ * \param type          The response type.
+ * \param entry         The certificate.
+ * \param total         Incremented by the number of bytes sent.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - VCTOOL_ERROR_FILE_IO if the client stopped accepting data.
+ *      - a non-zero error code returned by the file layer.
+ */
+static int query_send_entry(
+    query_index* index, int sock, uint32_t type, const query_entry* entry,
+    size_t* total)
+{
+    int retval;
+    uint8_t header[AGENT_FRAME_HEADER_SIZE];
+
+    query_write_u32(header, type);
+    query_write_u32(header + 4, (uint32_t)entry->size);
+    retval = file_write_all(index->f, sock, header, sizeof(header));
+    if (VCTOOL_STATUS_SUCCESS != retval)
+    {
+        return retval;
+    }
+
+    *total += sizeof(header);
+
+    off_t offset = (off_t)entry->offset;
+    size_t remaining = (size_t)entry->size;
+    while (remaining > 0)
+    {
+        size_t sent;
+        retval =
+            file_sendfile(
+                index->f, sock, index->fd, offset, remaining, &sent);
+        if (VCTOOL_STATUS_SUCCESS != retval)
+        {
+            return retval;
+        }
+        else if (0 == sent)
+        {
+            return VCTOOL_ERROR_FILE_IO;
+        }
+
+        offset += (off_t)sent;
+        remaining -= sent;
+        *total += sent;
+    }
+
+    return VCTOOL_STATUS_SUCCESS;
+}
+
+/**
+ * \brief Send the frame ending a response.
+ *
+ * \param index         The index being served.
+ * \param sock          The client connection.
+ * \param status        The status of the request.
+ * \param total         Incremented by the number of bytes sent.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - a non-zero error code returned by the file layer.
+ */
+static int query_send_end(
+    query_index* index, int sock, int status, size_t* total)
+{
+    uint8_t frame[AGENT_FRAME_HEADER_SIZE + QUERY_END_SIZE];
+
+    query_write_u32(frame, QUERY_RESP_END);
+    query_write_u32(frame + 4, QUERY_END_SIZE);
+    query_write_u32(frame + AGENT_FRAME_HEADER_SIZE, (uint32_t)status);
+
+    *total += sizeof(frame);
+
+    return file_write_all(index->f, sock, frame, sizeof(frame));
+}
+
+/**
+ * \brief Write a big endian 32-bit value.
+ *
+ * \param buf           The buffer to which the value is written.
+ * \param val           The value to write.
+ */
+static void query_write_u32(uint8_t* buf, uint32_t val)
+{
+    buf[0] = (uint8_t)(val >> 24);
+    buf[1] = (uint8_t)(val >> 16);
+    buf[2] = (uint8_t)(val >> 8);
+    buf[3] = (uint8_t)val;
+}
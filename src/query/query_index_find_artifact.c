@@ -0,0 +1,42 @@
+/**
+ * \file query/query_index_find_artifact.c
+ *
+ * \brief Find the transactions on an artifact.
+ *
+ * \copyright 2020 Velo Payments.  See License.txt for license terms.
+ */
+
+#include <cbmc/model_assert.h>
+#include <vctool/query.h>
+
+/**
+ * \brief Find the transactions on an artifact.
+ *
+ * \param index         The index to search.
+ * \param artifact_id   The artifact id.
+ * \param count         Set to the number of transactions found.
+ *
+ * \returns the first of count transactions, in chain order, or NULL if there
+ *          are none.
+ */
+const query_entry* query_index_find_artifact(
+    const query_index* index, const uint8_t* artifact_id, size_t* count)
+{
+    /* parameter sanity checks. */
+    MODEL_ASSERT(NULL != index);
+    MODEL_ASSERT(NULL != artifact_id);
+    MODEL_ASSERT(NULL != count);
+
+    uint32_t id;
+    int retval = uuid_dict_find(&index->artifact_ids, artifact_id, &id);
+    if (VCTOOL_STATUS_SUCCESS != retval)
+    {
+        *count = 0;
+        return NULL;
+    }
+
+    size_t start = index->artifact_starts[id];
+    *count = index->artifact_starts[id + 1] - start;
+
+    return &index->artifact_transactions[start];
+}
@@ -0,0 +1,35 @@
+/**
+ * \file query/query_index_find_block.c
+ *
+ * \brief Find a block by id.
+ *
+ * \copyright 2020 Velo Payments.  See License.txt for license terms.
+ */
+
+#include <cbmc/model_assert.h>
+#include <vctool/query.h>
+
+/**
+ * \brief Find a block by id.
+ *
+ * \param index         The index to search.
+ * \param block_id      The block id.
+ *
+ * \returns the block, or NULL if it is not in the segment.
+ */
+const query_entry* query_index_find_block(
+    const query_index* index, const uint8_t* block_id)
+{
+    /* parameter sanity checks. */
+    MODEL_ASSERT(NULL != index);
+    MODEL_ASSERT(NULL != block_id);
+
+    uint32_t id;
+    int retval = uuid_dict_find(&index->block_ids, block_id, &id);
+    if (VCTOOL_STATUS_SUCCESS != retval)
+    {
+        return NULL;
+    }
+
+    return &index->blocks_by_id[id];
+}
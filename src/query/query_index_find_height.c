@@ -0,0 +1,47 @@
+/**
+ * \file query/query_index_find_height.c
+ *
+ * \brief Find the block at a height.
+ *
+ * \copyright 2020 Velo Payments.  See License.txt for license terms.
+ */
+
+#include <cbmc/model_assert.h>
+#include <vctool/query.h>
+
+/**
+ * \brief Find the block at a height.
+ *
+ * \param index         The index to search.
+ * \param height        The block height.
+ *
+ * \returns the block, or NULL if there is no block at this height.
+ */
+const query_entry* query_index_find_height(
+    const query_index* index, uint64_t height)
+{
+    /* parameter sanity checks. */
+    MODEL_ASSERT(NULL != index);
+
+    /* binary search the sorted heights. */
+    size_t lo = 0, hi = index->block_count;
+    while (lo < hi)
+    {
+        size_t mid = lo + (hi - lo) / 2;
+        if (index->heights[mid] < height)
+        {
+            lo = mid + 1;
+        }
+        else
+        {
+            hi = mid;
+        }
+    }
+
+    if (lo < index->block_count && index->heights[lo] == height)
+    {
+        return &index->blocks[lo];
+    }
+
+    return NULL;
+}
@@ -0,0 +1,35 @@
+/**
+ * \file query/query_index_find_transaction.c
+ *
+ * \brief Find a transaction by id.
+ *
+ * \copyright 2020 Velo Payments.  See License.txt for license terms.
+ */
+
+#include <cbmc/model_assert.h>
+#include <vctool/query.h>
+
+/**
+ * \brief Find a transaction by id.
+ *
+ * \param index         The index to search.
+ * \param txn_id        The transaction id.
+ *
+ * \returns the transaction, or NULL if it is not in the segment.
+ */
+const query_entry* query_index_find_transaction(
+    const query_index* index, const uint8_t* txn_id)
+{
+    /* parameter sanity checks. */
+    MODEL_ASSERT(NULL != index);
+    MODEL_ASSERT(NULL != txn_id);
+
+    uint32_t id;
+    int retval = uuid_dict_find(&index->transaction_ids, txn_id, &id);
+    if (VCTOOL_STATUS_SUCCESS != retval)
+    {
+        return NULL;
+    }
+
+    return &index->transactions[id];
+}
@@ -0,0 +1,809 @@
+/**
+ * \file query/query_index_init.c
+ *
+ * \brief Build a query index over a segment.
+ *
+ * \copyright 2020 Velo Payments.  See License.txt for license terms.
+ */
+
+#include <cbmc/model_assert.h>
+#include <fcntl.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <vccert/fields.h>
+#include <vctool/blockstore.h>
+#include <vctool/extsort.h>
+#include <vctool/query.h>
+
+/* the size of a certificate field header. */
+#define QUERY_FIELD_HEADER_SIZE 4
+
+/* a block keyed by height: big endian height and order, then the entry. */
+#define QUERY_HEIGHT_RECORD_SIZE (16 + sizeof(query_entry))
+#define QUERY_HEIGHT_KEY_SIZE 16
+
+/* a transaction keyed by its artifact: the big endian artifact id number and
+ * order, then the entry. */
+#define QUERY_ARTIFACT_RECORD_SIZE (12 + sizeof(query_entry))
+#define QUERY_ARTIFACT_KEY_SIZE 12
+
+/* the initial number of entries in a table numbered by id. */
+#define QUERY_TABLE_INITIAL_SIZE 1024
+
+/**
+ * \brief External sorts and tables fed while walking the segment.
+ */
+typedef struct query_scan
+{
+    query_index* index;
+    extsort heights;
+    size_t height_count;
+    extsort artifacts;
+    size_t artifact_count;
+    size_t block_capacity;
+    size_t transaction_capacity;
+} query_scan;
+
+/**
+ * \brief The transactions merged out of the artifact sort.
+ */
+typedef struct query_group_state
+{
+    query_entry* entries;
+    size_t* starts;
+    size_t distinct;
+    size_t count;
+} query_group_state;
+
+/* forward decls. */
+static void query_index_dispose(void* disp);
+static void query_index_release(query_index* index);
+static int query_scan_init(
+    query_scan* scan, query_index* index, const char* segment);
+static void query_scan_dispose(query_scan* scan);
+static int query_scan_record(
+    query_scan* scan, const uint8_t* base, uint64_t offset, uint64_t length);
+static int query_scan_transaction(
+    query_scan* scan, const uint8_t* base, uint64_t offset, uint64_t size);
+static int query_scan_first(
+    uuid_dict* ids, query_entry** table, size_t* capacity,
+    const uint8_t* id, const query_entry* entry);
+static int query_scan_artifact(
+    query_scan* scan, const uint8_t* artifact_id, const query_entry* entry);
+static bool query_field_next(
+    const uint8_t* cert, uint64_t size, uint64_t* offset, uint16_t* type,
+    uint64_t* value, uint16_t* value_size);
+static int query_index_heights(query_index* index, query_scan* scan);
+static int query_height_output(void* context, const void* record);
+static int query_index_artifacts(query_index* index, query_scan* scan);
+static int query_group_output(void* context, const void* record);
+static void query_write_u32(uint8_t* buf, uint32_t val);
+static uint32_t query_read_u32(const uint8_t* buf);
+static void query_write_u64(uint8_t* buf, uint64_t val);
+static uint64_t query_read_u64(const uint8_t* buf);
+
+/**
+ * \brief Build a query index over a segment.
+ *
+ * The index covers the records in the segment when it is built; records
+ * appended later are not found.
+ *
+ * \param index         The index to initialize.
+ * \param f             The file abstraction layer to use.
+ * \param segment       The path of the segment.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - VCTOOL_ERROR_BLOCKSTORE_BAD_SEGMENT if path is not a segment.
+ *      - VCTOOL_ERROR_BLOCKSTORE_CORRUPT if a record is damaged.
+ *      - VCTOOL_ERROR_QUERY_BAD_BLOCK if a block's fields are malformed.
+ *      - VCTOOL_ERROR_GENERAL_OUT_OF_MEMORY if an allocation failed.
+ *      - a non-zero error code returned by the file layer.
+ */
+int query_index_init(query_index* index, file* f, const char* segment)
+{
+    int retval;
+    file_stat_st fst;
+    void* map;
+    query_scan scan;
+    uint64_t offset, length, height;
+
+    /* parameter sanity checks. */
+    MODEL_ASSERT(NULL != index);
+    MODEL_ASSERT(PROP_FILE_VALID(f));
+    MODEL_ASSERT(NULL != segment);
+
+    /* clear the index. */
+    memset(index, 0, sizeof(query_index));
+    index->f = f;
+    index->fd = -1;
+
+    retval = file_stat(f, segment, &fst);
+    if (VCTOOL_STATUS_SUCCESS != retval)
+    {
+        return retval;
+    }
+
+    uint64_t size = (uint64_t)fst.fst_size;
+    if (size < BLOCKSTORE_SEGMENT_MAGIC_SIZE)
+    {
+        return VCTOOL_ERROR_BLOCKSTORE_BAD_SEGMENT;
+    }
+
+    /* the descriptor stays open for sendfile. */
+    retval = file_open(f, &index->fd, segment, O_RDONLY, 0);
+    if (VCTOOL_STATUS_SUCCESS != retval)
+    {
+        return retval;
+    }
+
+    retval = file_mmap(f, &map, index->fd, (size_t)size);
+    if (VCTOOL_STATUS_SUCCESS != retval)
+    {
+        goto cleanup_index;
+    }
+
+    const uint8_t* base = (const uint8_t*)map;
+    if (memcmp(base, BLOCKSTORE_SEGMENT_MAGIC, BLOCKSTORE_SEGMENT_MAGIC_SIZE))
+    {
+        retval = VCTOOL_ERROR_BLOCKSTORE_BAD_SEGMENT;
+        goto cleanup_map;
+    }
+
+    /* collect every block and transaction. */
+    retval = query_scan_init(&scan, index, segment);
+    if (VCTOOL_STATUS_SUCCESS != retval)
+    {
+        goto cleanup_map;
+    }
+
+    for (offset = BLOCKSTORE_SEGMENT_MAGIC_SIZE; offset < size;
+         offset += length)
+    {
+        if (!blockstore_record_verify(base, size, offset, &length, &height))
+        {
+            retval = VCTOOL_ERROR_BLOCKSTORE_CORRUPT;
+            goto cleanup_scan;
+        }
+
+        retval = query_scan_record(&scan, base, offset, length);
+        if (VCTOOL_STATUS_SUCCESS != retval)
+        {
+            goto cleanup_scan;
+        }
+    }
+
+    /* sort each into its lookup table. */
+    retval = query_index_heights(index, &scan);
+    if (VCTOOL_STATUS_SUCCESS != retval)
+    {
+        goto cleanup_scan;
+    }
+
+    retval = query_index_artifacts(index, &scan);
+    if (VCTOOL_STATUS_SUCCESS != retval)
+    {
+        goto cleanup_scan;
+    }
+
+    index->hdr.dispose = &query_index_dispose;
+    retval = VCTOOL_STATUS_SUCCESS;
+
+cleanup_scan:
+    query_scan_dispose(&scan);
+
+cleanup_map:
+    file_munmap(f, map, (size_t)size);
+
+cleanup_index:
+    if (VCTOOL_STATUS_SUCCESS != retval)
+    {
+        query_index_release(index);
+    }
+
+    return retval;
+}
+
+/**
+ * \brief Dispose of a query index.
+ *
+ * \param disp          The query index to dispose.
+ */
+static void query_index_dispose(void* disp)
+{
+    query_index* index = (query_index*)disp;
+
+    query_index_release(index);
+}
+
+/**
+ * \brief Release everything held by a query index, built or not.
+ *
+ * \param index         The query index to release.
+ */
+static void query_index_release(query_index* index)
+{
+    if (index->fd >= 0)
+    {
+        file_close(index->f, index->fd);
+    }
+
+    /* only the dictionaries which were built can be disposed. */
+    if (NULL != index->block_ids.hdr.dispose)
+    {
+        dispose((disposable_t*)&index->block_ids);
+    }
+    if (NULL != index->transaction_ids.hdr.dispose)
+    {
+        dispose((disposable_t*)&index->transaction_ids);
+    }
+    if (NULL != index->artifact_ids.hdr.dispose)
+    {
+        dispose((disposable_t*)&index->artifact_ids);
+    }
+
+    free(index->heights);
+    free(index->blocks);
+    free(index->blocks_by_id);
+    free(index->transactions);
+    free(index->artifact_starts);
+    free(index->artifact_transactions);
+
+    /* clear the index. */
+    memset(index, 0, sizeof(query_index));
+    index->fd = -1;
+}
+
+/**
+ * \brief Initialize the id dictionaries and the sorts.
+ *
+ * \param scan          The sorts to initialize.
+ * \param index         The index being built.
+ * \param segment       The path of the segment, in whose directory runs are
+ *                      created.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - VCTOOL_ERROR_GENERAL_OUT_OF_MEMORY if an allocation failed.
+ */
+static int query_scan_init(
+    query_scan* scan, query_index* index, const char* segment)
+{
+    int retval;
+    file* f = index->f;
+
+    memset(scan, 0, sizeof(query_scan));
+    scan->index = index;
+
+    uuid_dict* dicts[] = {
+        &index->block_ids, &index->transaction_ids, &index->artifact_ids };
+
+    for (size_t i = 0; i < sizeof(dicts) / sizeof(dicts[0]); ++i)
+    {
+        retval = uuid_dict_init(dicts[i]);
+        if (VCTOOL_STATUS_SUCCESS != retval)
+        {
+            return retval;
+        }
+    }
+
+    /* runs go in the directory of the segment. */
+    char* dir = (char*)malloc(strlen(segment) + 2);
+    if (NULL == dir)
+    {
+        return VCTOOL_ERROR_GENERAL_OUT_OF_MEMORY;
+    }
+
+    const char* slash = strrchr(segment, '/');
+    if (NULL == slash)
+    {
+        strcpy(dir, ".");
+    }
+    else if (slash == segment)
+    {
+        strcpy(dir, "/");
+    }
+    else
+    {
+        memcpy(dir, segment, (size_t)(slash - segment));
+        dir[slash - segment] = 0;
+    }
+
+    retval =
+        extsort_init(
+            &scan->heights, f, dir, QUERY_HEIGHT_RECORD_SIZE,
+            QUERY_HEIGHT_KEY_SIZE, QUERY_SORT_BUDGET, 0);
+    if (VCTOOL_STATUS_SUCCESS != retval)
+    {
+        goto cleanup_dir;
+    }
+
+    retval =
+        extsort_init(
+            &scan->artifacts, f, dir, QUERY_ARTIFACT_RECORD_SIZE,
+            QUERY_ARTIFACT_KEY_SIZE, QUERY_SORT_BUDGET, 0);
+    if (VCTOOL_STATUS_SUCCESS != retval)
+    {
+        goto cleanup_scan;
+    }
+
+    /* success. */
+    goto cleanup_dir;
+
+cleanup_scan:
+    query_scan_dispose(scan);
+
+cleanup_dir:
+    free(dir);
+
+    return retval;
+}
+
+/**
+ * \brief Dispose of the sorts which were initialized, removing any runs left
+ * over.
+ *
+ * \param scan          The sorts to dispose.
+ */
+static void query_scan_dispose(query_scan* scan)
+{
+    extsort* sorters[] = { &scan->heights, &scan->artifacts };
+
+    for (size_t i = 0; i < sizeof(sorters) / sizeof(sorters[0]); ++i)
+    {
+        if (NULL != sorters[i]->hdr.dispose)
+        {
+            dispose((disposable_t*)sorters[i]);
+        }
+    }
+}
+
+/**
+ * \brief Collect a block and its transactions.
+ *
+ * \param scan          The sorts being fed.
+ * \param base          The mapped segment.
+ * \param offset        The offset of an intact record.
+ * \param length        The length of the record, including its header.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - VCTOOL_ERROR_QUERY_BAD_BLOCK if the block's fields are malformed.
+ *      - a non-zero error code if a sort run could not be written.
+ */
+static int query_scan_record(
+    query_scan* scan, const uint8_t* base, uint64_t offset, uint64_t length)
+{
+    int retval;
+    query_entry block;
+    uint8_t record[QUERY_HEIGHT_RECORD_SIZE];
+    uint64_t field, value;
+    uint16_t type, value_size;
+
+    block.offset = offset + BLOCKSTORE_RECORD_HEADER_SIZE;
+    block.size = length - BLOCKSTORE_RECORD_HEADER_SIZE;
+
+    /* index the block by height; the record header holds it big endian. */
+    memcpy(record, base + offset + 8, 8);
+    query_write_u64(record + 8, scan->height_count++);
+    memcpy(record + 16, &block, sizeof(block));
+    retval = extsort_add(&scan->heights, record);
+    if (VCTOOL_STATUS_SUCCESS != retval)
+    {
+        return retval;
+    }
+
+    /* index the block by id. */
+    retval =
+        query_scan_first(
+            &scan->index->block_ids, &scan->index->blocks_by_id,
+            &scan->block_capacity, base + offset + 16, &block);
+    if (VCTOOL_STATUS_SUCCESS != retval)
+    {
+        return retval;
+    }
+
+    /* index each transaction in the block. */
+    const uint8_t* cert = base + block.offset;
+    field = 0;
+    while (query_field_next(
+                cert, block.size, &field, &type, &value, &value_size))
+    {
+        if (VCCERT_FIELD_TYPE_WRAPPED_TRANSACTION_TUPLE == type)
+        {
+            retval =
+                query_scan_transaction(
+                    scan, base, block.offset + value, value_size);
+            if (VCTOOL_STATUS_SUCCESS != retval)
+            {
+                return retval;
+            }
+        }
+    }
+
+    /* the fields must fill the block exactly. */
+    if (field != block.size)
+    {
+        return VCTOOL_ERROR_QUERY_BAD_BLOCK;
+    }
+
+    return VCTOOL_STATUS_SUCCESS;
+}
+
+/**
+ * \brief Collect a transaction by its id and its artifact id.
+ *
+ * \param scan          The sorts being fed.
+ * \param base          The mapped segment.
+ * \param offset        The offset of the transaction certificate.
+ * \param size          The size of the transaction certificate.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - VCTOOL_ERROR_QUERY_BAD_BLOCK if the transaction lacks either id.
+ *      - a non-zero error code if a sort run could not be written.
+ */
+static int query_scan_transaction(
+    query_scan* scan, const uint8_t* base, uint64_t offset, uint64_t size)
+{
+    int retval;
+    const uint8_t* cert = base + offset;
+    const uint8_t* txn_id = NULL;
+    const uint8_t* artifact_id = NULL;
+    query_entry txn;
+    uint64_t field = 0, value;
+    uint16_t type, value_size;
+
+    while (query_field_next(cert, size, &field, &type, &value, &value_size))
+    {
+        if (UUID_SIZE != value_size)
+        {
+            continue;
+        }
+        else if (VCCERT_FIELD_TYPE_CERTIFICATE_ID == type && NULL == txn_id)
+        {
+            txn_id = cert + value;
+        }
+        else if (VCCERT_FIELD_TYPE_ARTIFACT_ID == type && NULL == artifact_id)
+        {
+            artifact_id = cert + value;
+        }
+    }
+
+    if (field != size || NULL == txn_id || NULL == artifact_id)
+    {
+        return VCTOOL_ERROR_QUERY_BAD_BLOCK;
+    }
+
+    txn.offset = offset;
+    txn.size = size;
+
+    retval =
+        query_scan_first(
+            &scan->index->transaction_ids, &scan->index->transactions,
+            &scan->transaction_capacity, txn_id, &txn);
+    if (VCTOOL_STATUS_SUCCESS != retval)
+    {
+        return retval;
+    }
+
+    return query_scan_artifact(scan, artifact_id, &txn);
+}
+
+/**
+ * \brief Number a certificate by its id, keeping only the first certificate
+ * with each id.
+ *
+ * \param ids           The dictionary numbering the ids.
+ * \param table         The table of certificates by id number; grown as
+ *                      needed.
+ * \param capacity      The number of entries allocated in the table.
+ * \param id            The uuid.
+ * \param entry         The certificate.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - VCTOOL_ERROR_GENERAL_OUT_OF_MEMORY if an allocation failed.
+ *      - a non-zero error code returned by uuid_dict_intern.
+ */
+static int query_scan_first(
+    uuid_dict* ids, query_entry** table, size_t* capacity,
+    const uint8_t* id, const query_entry* entry)
+{
+    int retval;
+    uint32_t number, count = ids->count;
+
+    retval = uuid_dict_intern(ids, id, &number);
+    if (VCTOOL_STATUS_SUCCESS != retval)
+    {
+        return retval;
+    }
+
+    /* a repeated id keeps its first certificate. */
+    if (ids->count == count)
+    {
+        return VCTOOL_STATUS_SUCCESS;
+    }
+
+    if ((size_t)number == *capacity)
+    {
+        size_t grown =
+            (0 == *capacity) ? QUERY_TABLE_INITIAL_SIZE : 2 * *capacity;
+        query_entry* tmp =
+            (query_entry*)realloc(*table, grown * sizeof(query_entry));
+        if (NULL == tmp)
+        {
+            return VCTOOL_ERROR_GENERAL_OUT_OF_MEMORY;
+        }
+
+        *table = tmp;
+        *capacity = grown;
+    }
+
+    (*table)[number] = *entry;
+
+    return VCTOOL_STATUS_SUCCESS;
+}
+
+/**
+ * \brief Add a transaction keyed by its artifact id number to the artifact
+ * sort, after those already added.
+ *
+ * \param scan          The sorts being fed.
+ * \param artifact_id   The artifact id.
+ * \param entry         The transaction.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - a non-zero error code returned by uuid_dict_intern, or if a sort run
+ *        could not be written.
+ */
+static int query_scan_artifact(
+    query_scan* scan, const uint8_t* artifact_id, const query_entry* entry)
+{
+    int retval;
+    uint32_t number;
+    uint8_t record[QUERY_ARTIFACT_RECORD_SIZE];
+
+    retval = uuid_dict_intern(&scan->index->artifact_ids, artifact_id, &number);
+    if (VCTOOL_STATUS_SUCCESS != retval)
+    {
+        return retval;
+    }
+
+    query_write_u32(record, number);
+    query_write_u64(record + 4, scan->artifact_count++);
+    memcpy(record + QUERY_ARTIFACT_KEY_SIZE, entry, sizeof(query_entry));
+
+    return extsort_add(&scan->artifacts, record);
+}
+
+/**
+ * \brief Read the next field of a certificate.
+ *
+ * \param cert          The certificate.
+ * \param size          The size of the certificate.
+ * \param offset        The offset of the field; advanced past it.
+ * \param type          Set to the field type.
+ * \param value         Set to the offset of the field value.
+ * \param value_size    Set to the size of the field value.
+ *
+ * \returns true if a whole field was read, or false at the end of the
+ *          certificate or at a truncated field, which leaves offset short of
+ *          size.
+ */
+static bool query_field_next(
+    const uint8_t* cert, uint64_t size, uint64_t* offset, uint16_t* type,
+    uint64_t* value, uint16_t* value_size)
+{
+    if (*offset + QUERY_FIELD_HEADER_SIZE > size)
+    {
+        return false;
+    }
+
+    const uint8_t* field = cert + *offset;
+    uint16_t field_size = (uint16_t)((field[2] << 8) | field[3]);
+    if (*offset + QUERY_FIELD_HEADER_SIZE + field_size > size)
+    {
+        return false;
+    }
+
+    *type = (uint16_t)((field[0] << 8) | field[1]);
+    *value = *offset + QUERY_FIELD_HEADER_SIZE;
+    *value_size = field_size;
+    *offset = *value + field_size;
+
+    return true;
+}
+
+/**
+ * \brief Build the height table, keeping the first block at each height.
+ *
+ * \param index         The index being built.
+ * \param scan          The collected blocks.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - VCTOOL_ERROR_GENERAL_OUT_OF_MEMORY if an allocation failed.
+ *      - a non-zero error code returned by the sort.
+ */
+static int query_index_heights(query_index* index, query_scan* scan)
+{
+    size_t count = scan->height_count;
+
+    index->heights = (uint64_t*)malloc((count + 1) * sizeof(uint64_t));
+    index->blocks = (query_entry*)malloc((count + 1) * sizeof(query_entry));
+    if (NULL == index->heights || NULL == index->blocks)
+    {
+        return VCTOOL_ERROR_GENERAL_OUT_OF_MEMORY;
+    }
+
+    /* an empty segment has nothing to merge. */
+    if (0 == count)
+    {
+        return VCTOOL_STATUS_SUCCESS;
+    }
+
+    return extsort_finish(&scan->heights, &query_height_output, index);
+}
+
+/**
+ * \brief Append a sorted block unless its height is already in the table.
+ *
+ * \param context       The index being built.
+ * \param record        The next height record in sorted order.
+ *
+ * \returns VCTOOL_STATUS_SUCCESS.
+ */
+static int query_height_output(void* context, const void* record)
+{
+    query_index* index = (query_index*)context;
+    const uint8_t* r = (const uint8_t*)record;
+    uint64_t height = query_read_u64(r);
+
+    if (0 == index->block_count
+     || index->heights[index->block_count - 1] != height)
+    {
+        index->heights[index->block_count] = height;
+        memcpy(
+            &index->blocks[index->block_count], r + 16, sizeof(query_entry));
+        ++index->block_count;
+    }
+
+    return VCTOOL_STATUS_SUCCESS;
+}
+
+/**
+ * \brief Group the transactions by artifact id number, in chain order.
+ *
+ * \param index         The index being built.
+ * \param scan          The collected transactions.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - VCTOOL_ERROR_GENERAL_OUT_OF_MEMORY if an allocation failed.
+ *      - a non-zero error code returned by the sort.
+ */
+static int query_index_artifacts(query_index* index, query_scan* scan)
+{
+    int retval;
+    query_group_state state;
+    size_t distinct = index->artifact_ids.count;
+
+    memset(&state, 0, sizeof(state));
+    state.starts = (size_t*)malloc((distinct + 1) * sizeof(size_t));
+    state.entries =
+        (query_entry*)malloc((scan->artifact_count + 1) * sizeof(query_entry));
+    index->artifact_starts = state.starts;
+    index->artifact_transactions = state.entries;
+    if (NULL == state.starts || NULL == state.entries)
+    {
+        return VCTOOL_ERROR_GENERAL_OUT_OF_MEMORY;
+    }
+
+    /* an empty segment has nothing to merge. */
+    if (scan->artifact_count > 0)
+    {
+        retval = extsort_finish(&scan->artifacts, &query_group_output, &state);
+        if (VCTOOL_STATUS_SUCCESS != retval)
+        {
+            return retval;
+        }
+    }
+
+    state.starts[distinct] = state.count;
+
+    return VCTOOL_STATUS_SUCCESS;
+}
+
+/**
+ * \brief Append a sorted transaction to its artifact's group.
+ *
+ * Artifact id numbers are dense and every one has a transaction, so each
+ * group starts where the number first appears.
+ *
+ * \param context       The groups being collected.
+ * \param record        The next artifact record in sorted order.
+ *
+ * \returns VCTOOL_STATUS_SUCCESS.
+ */
+static int query_group_output(void* context, const void* record)
+{
+    query_group_state* state = (query_group_state*)context;
+    const uint8_t* r = (const uint8_t*)record;
+
+    if ((size_t)query_read_u32(r) == state->distinct)
+    {
+        state->starts[state->distinct++] = state->count;
+    }
+
+    memcpy(
+        &state->entries[state->count++], r + QUERY_ARTIFACT_KEY_SIZE,
+        sizeof(query_entry));
+
+    return VCTOOL_STATUS_SUCCESS;
+}
+
+/**
+ * \brief Write a big endian 32-bit value.
+ *
+ * \param buf           The buffer to which the value is written.
+ * \param val           The value to write.
+ */
+static void query_write_u32(uint8_t* buf, uint32_t val)
+{
+    buf[0] = (uint8_t)(val >> 24);
+    buf[1] = (uint8_t)(val >> 16);
+    buf[2] = (uint8_t)(val >> 8);
+    buf[3] = (uint8_t)val;
+}
+
+/**
+ * \brief Read a big endian 32-bit value.
+ *
+ * \param buf           The buffer from which the value is read.
+ *
+ * \returns the value.
+ */
+static uint32_t query_read_u32(const uint8_t* buf)
+{
+    return
+        ((uint32_t)buf[0] << 24) | ((uint32_t)buf[1] << 16)
+      | ((uint32_t)buf[2] << 8) | (uint32_t)buf[3];
+}
+
+/**
+ * \brief Write a big endian 64-bit value.
+ *
+ * \param buf           The buffer to which the value is written.
+ * \param val           The value to write.
+ */
+static void query_write_u64(uint8_t* buf, uint64_t val)
+{
+    for (int i = 7; i >= 0; --i)
+    {
+        buf[i] = (uint8_t)(val & 0xff);
+        val >>= 8;
+    }
+}
+
+/**
+ * \brief Read a big endian 64-bit value.
+ *
+ * \param buf           The buffer from which the value is read.
+ *
+ * \returns the value.
+ */
+static uint64_t query_read_u64(const uint8_t* buf)
+{
+    uint64_t val = 0;
+
+    for (int i = 0; i < 8; ++i)
+    {
+        val = (val << 8) | buf[i];
+    }
+
+    return val;
+}
@@ -0,0 +1,63 @@
+/**
+ * \file query/query_listen.c
+ *
+ * \brief Open a query server socket.
+ *
+ * \copyright 2020 Velo Payments.  See License.txt for license terms.
+ */
+
+#include <cbmc/model_assert.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include <vctool/query.h>
+
+/**
+ * \brief Open a query server socket.
+ *
+ * A stale socket file left at path is removed first.
+ *
+ * \param sock          Pointer to receive the listening socket.
+ * \param path          The path of the unix domain socket.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - VCTOOL_ERROR_QUERY_LISTEN if the socket could not be opened.
+ */
+int query_listen(int* sock, const char* path)
+{
+    struct sockaddr_un addr;
+
+    /* parameter sanity checks. */
+    MODEL_ASSERT(NULL != sock);
+    MODEL_ASSERT(NULL != path);
+
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    if (strlen(path) >= sizeof(addr.sun_path))
+    {
+        return VCTOOL_ERROR_QUERY_LISTEN;
+    }
+    strcpy(addr.sun_path, path);
+
+    int s = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (s < 0)
+    {
+        return VCTOOL_ERROR_QUERY_LISTEN;
+    }
+
+    /* a previous server may have left its socket behind. */
+    unlink(path);
+
+    if (bind(s, (struct sockaddr*)&addr, sizeof(addr)) < 0
+     || listen(s, QUERY_LISTEN_BACKLOG) < 0)
+    {
+        close(s);
+        return VCTOOL_ERROR_QUERY_LISTEN;
+    }
+
+    *sock = s;
+
+    return VCTOOL_STATUS_SUCCESS;
+}
@@ -0,0 +1,62 @@
+/**
+ * \file query/query_serve.c
+ *
+ * \brief Answer query requests on a connection.
+ *
+ * \copyright 2020 Velo Payments.  See License.txt for license terms.
+ */
+
+#include <cbmc/model_assert.h>
+#include <vctool/agent.h>
+#include <vctool/query.h>
+
+/**
+ * \brief Answer requests on a connection until the client closes it.
+ *
+ * \param index         The index to search.
+ * \param sock          The client connection.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS when the client closes the connection.
+ *      - VCTOOL_ERROR_AGENT_BAD_FRAME if a request frame was malformed.
+ *      - a non-zero error code on failure.
+ */
+int query_serve(query_index* index, int sock)
+{
+    int retval;
+    agent_frame request;
+
+    /* parameter sanity checks. */
+    MODEL_ASSERT(NULL != index);
+    MODEL_ASSERT(sock >= 0);
+
+    retval = agent_frame_init(&request);
+    if (VCTOOL_STATUS_SUCCESS != retval)
+    {
+        return retval;
+    }
+
+    for (;;)
+    {
+        retval = agent_frame_read(index->f, sock, &request);
+        if (VCTOOL_ERROR_AGENT_DISCONNECTED == retval)
+        {
+            retval = VCTOOL_STATUS_SUCCESS;
+            break;
+        }
+        else if (VCTOOL_STATUS_SUCCESS != retval)
+        {
+            break;
+        }
+
+        retval = query_answer(index, sock, &request, NULL);
+        if (VCTOOL_STATUS_SUCCESS != retval)
+        {
+            break;
+        }
+    }
+
+    dispose((disposable_t*)&request);
+
+    return retval;
+}
@@ -0,0 +1,72 @@
+/**
+ * \file revocation/revocation_bloom_mask.c
+ *
+ * \brief Compute the Bloom filter position of an id.
+ *
+ * \copyright 2020 Velo Payments.  See License.txt for license terms.
+ */
+
+#include <cbmc/model_assert.h>
+#include <string.h>
+#include <vctool/revocation.h>
+
+/* forward decls. */
+static uint64_t revocation_mix(uint64_t x);
+
+/**
+ * \brief Compute the Bloom filter block and bit mask for an id.
+ *
+ * \param mask          Array of REVOCATION_BLOOM_BLOCK_WORDS words to receive
+ *                      the bit mask.
+ * \param id            The REVOCATION_ENTRY_SIZE byte id.
+ * \param blocks        The number of Bloom filter blocks.
+ * \param hashes        The number of Bloom filter hashes.
+ *
+ * \returns the Bloom filter block for this id.
+ */
+uint32_t revocation_bloom_mask(
+    uint64_t* mask, const uint8_t* id, uint32_t blocks, uint32_t hashes)
+{
+    uint64_t hi, lo;
+
+    /* parameter sanity checks. */
+    MODEL_ASSERT(NULL != mask);
+    MODEL_ASSERT(NULL != id);
+    MODEL_ASSERT(blocks > 0);
+    MODEL_ASSERT(hashes * 9 <= 64);
+
+    /* ids are random enough that two mixed halves are a good hash. */
+    memcpy(&hi, id, sizeof(hi));
+    memcpy(&lo, id + sizeof(hi), sizeof(lo));
+    uint64_t h = revocation_mix(hi ^ revocation_mix(lo));
+    uint64_t g = revocation_mix(h);
+
+    /* the block is chosen by the high half of the hash. */
+    uint32_t block = (uint32_t)(((h >> 32) * (uint64_t)blocks) >> 32);
+
+    /* each hash selects one of the 512 bits in the block. */
+    memset(mask, 0, REVOCATION_BLOOM_BLOCK_SIZE);
+    for (uint32_t i = 0; i < hashes; ++i)
+    {
+        unsigned bit = (unsigned)(g >> (9 * i)) & 0x1ff;
+        mask[bit >> 6] |= UINT64_C(1) << (bit & 0x3f);
+    }
+
+    return block;
+}
+
+/**
+ * \brief 64-bit finalizing mix.
+ *
+ * \param x             The value to mix.
+ *
+ * \returns the mixed value.
+ */
+static uint64_t revocation_mix(uint64_t x)
+{
+    x += UINT64_C(0x9e3779b97f4a7c15);
+    x = (x ^ (x >> 30)) * UINT64_C(0xbf58476d1ce4e5b9);
+    x = (x ^ (x >> 27)) * UINT64_C(0x94d049bb133111eb);
+
+    return x ^ (x >> 31);
+}
@@ -0,0 +1,29 @@
+/**
+ * \file revocation/revocation_builder_add.c
+ *
+ * \brief Add an id to a revocation list builder.
+ *
+ * \copyright 2020 Velo Payments.  See License.txt for license terms.
+ */
+
+#include <cbmc/model_assert.h>
+#include <vctool/revocation.h>
+
+/**
+ * \brief Add an id to a revocation list builder.
+ *
+ * \param builder       The builder.
+ * \param id            The REVOCATION_ENTRY_SIZE byte id to add.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - a non-zero error code if a sort run could not be written.
+ */
+int revocation_builder_add(revocation_builder* builder, const uint8_t* id)
+{
+    /* parameter sanity checks. */
+    MODEL_ASSERT(NULL != builder);
+    MODEL_ASSERT(NULL != id);
+
+    return extsort_add(&builder->sorter, id);
+}
@@ -0,0 +1,349 @@
+/**
+ * \file revocation/revocation_builder_finish.c
+ *
+ * \brief Write the revocation list built by a revocation list builder.
+ *
+ * \copyright 2020 Velo Payments.  See License.txt for license terms.
+ */
+
+#include <cbmc/model_assert.h>
+#include <endian.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vctool/extsort.h>
+#include <vctool/revocation.h>
+
+/**
+ * \brief De-duplicating output of the entry sort.
+ */
+typedef struct revocation_sort_state
+{
+    uint8_t* entries;
+    size_t count;
+    size_t reserved;
+} revocation_sort_state;
+
+/* forward decls. */
+static int revocation_sort_output(void* context, const void* record);
+static void revocation_write_u64(uint8_t* buf, uint64_t val);
+static void revocation_write_u32(uint8_t* buf, uint32_t val);
+
+/**
+ * \brief Write the revocation list holding every distinct id added.
+ *
+ * The sorted ids are merged out of the sorter, dropping duplicates, into the
+ * only array of entries held in memory.  A perfect hash is built over them.
+ * The list is written to a temporary file which is then renamed over the
+ * path, so readers never see a partially written list.  The builder must
+ * still be disposed.
+ *
+ * \param builder       The builder.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - a non-zero error code on failure.
+ */
+int revocation_builder_finish(revocation_builder* builder)
+{
+    int retval, fd;
+    revocation_sort_state state;
+    uint8_t header[REVOCATION_HEADER_SIZE];
+    uint64_t mask[REVOCATION_BLOOM_BLOCK_WORDS];
+    uint64_t* bloom = NULL;
+    uint32_t blocks = 0;
+    uint32_t* slots = NULL;
+    size_t slots_size = 0;
+    mph index;
+    bool indexed = false;
+
+    /* parameter sanity checks. */
+    MODEL_ASSERT(NULL != builder);
+
+    file* f = builder->file;
+    const char* path = builder->path;
+
+    /* merge the sorted, distinct entries; an empty list has none. */
+    memset(&state, 0, sizeof(state));
+    if (builder->sorter.count > 0 || builder->sorter.run_count > 0)
+    {
+        retval =
+            extsort_finish(&builder->sorter, &revocation_sort_output, &state);
+        if (VCTOOL_STATUS_SUCCESS != retval)
+        {
+            goto cleanup_entries;
+        }
+    }
+
+    uint8_t* entries = state.entries;
+    size_t count = state.count;
+
+    /* size the Bloom filter. */
+    uint64_t bits = (uint64_t)count * REVOCATION_BLOOM_BITS_PER_ENTRY;
+    blocks =
+        (uint32_t)((bits + REVOCATION_BLOOM_BLOCK_SIZE * 8 - 1)
+                        / (REVOCATION_BLOOM_BLOCK_SIZE * 8));
+
+    /* build the Bloom filter. */
+    if (blocks > 0)
+    {
+        bloom = (uint64_t*)calloc(blocks, REVOCATION_BLOOM_BLOCK_SIZE);
+        if (NULL == bloom)
+        {
+            retval = VCTOOL_ERROR_GENERAL_OUT_OF_MEMORY;
+            goto cleanup_entries;
+        }
+
+        for (size_t i = 0; i < count; ++i)
+        {
+            uint32_t b =
+                revocation_bloom_mask(
+                    mask, entries + i * REVOCATION_ENTRY_SIZE, blocks,
+                    REVOCATION_BLOOM_HASHES);
+
+            uint64_t* block = bloom + (size_t)b * REVOCATION_BLOOM_BLOCK_WORDS;
+            for (int j = 0; j < REVOCATION_BLOOM_BLOCK_WORDS; ++j)
+            {
+                block[j] |= mask[j];
+            }
+        }
+
+        /* the words are stored little endian, like the slot table. */
+        size_t words = (size_t)blocks * REVOCATION_BLOOM_BLOCK_WORDS;
+        for (size_t w = 0; w < words; ++w)
+        {
+            bloom[w] = htole64(bloom[w]);
+        }
+    }
+
+    /* build the perfect hash and its slot table. */
+    if (count > 0 && count <= UINT32_MAX)
+    {
+        retval = mph_build(&index, entries, count, 0);
+        if (VCTOOL_ERROR_MPH_HASH_COLLISION == retval)
+        {
+            /* vanishingly rare; this list is searched without the index. */
+            retval = VCTOOL_STATUS_SUCCESS;
+        }
+        else if (VCTOOL_STATUS_SUCCESS != retval)
+        {
+            goto cleanup_bloom;
+        }
+        else
+        {
+            indexed = true;
+        }
+    }
+
+    if (indexed)
+    {
+        slots_size = (count * sizeof(uint32_t) + 7) & ~7UL;
+        slots = (uint32_t*)calloc(1, slots_size);
+        if (NULL == slots)
+        {
+            retval = VCTOOL_ERROR_GENERAL_OUT_OF_MEMORY;
+            goto cleanup_index;
+        }
+
+        for (size_t i = 0; i < count; ++i)
+        {
+            uint64_t slot =
+                mph_lookup(&index, entries + i * REVOCATION_ENTRY_SIZE);
+            slots[slot] = htole32((uint32_t)i);
+        }
+    }
+
+    /* compute the FNV-1a digest of the sorted entries. */
+    uint64_t digest = UINT64_C(0xcbf29ce484222325);
+    for (size_t i = 0; i < count * REVOCATION_ENTRY_SIZE; ++i)
+    {
+        digest = (digest ^ entries[i]) * UINT64_C(0x100000001b3);
+    }
+
+    /* build the header. */
+    memcpy(header, REVOCATION_MAGIC, REVOCATION_MAGIC_SIZE);
+    revocation_write_u64(header + 8, count);
+    revocation_write_u64(header + 16, digest);
+    revocation_write_u32(header + 24, blocks);
+    revocation_write_u32(header + 28, REVOCATION_BLOOM_HASHES);
+
+    /* build the temporary filename. */
+    size_t tmp_size =
+        strlen(path)
+      + 4 /* .tmp */
+      + 1;/* asciiz */
+    char* tmp = (char*)malloc(tmp_size);
+    if (NULL == tmp)
+    {
+        retval = VCTOOL_ERROR_GENERAL_OUT_OF_MEMORY;
+        goto cleanup_slots;
+    }
+    snprintf(tmp, tmp_size, "%s.tmp", path);
+
+    /* open the temporary file. */
+    retval =
+        file_open(
+            f, &fd, tmp, O_CREAT | O_TRUNC | O_WRONLY,
+            S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH);
+    if (VCTOOL_STATUS_SUCCESS != retval)
+    {
+        goto cleanup_tmp;
+    }
+
+    /* write the header, Bloom filter, and entries. */
+    retval = file_write_all(f, fd, header, sizeof(header));
+    if (VCTOOL_STATUS_SUCCESS != retval)
+    {
+        goto cleanup_fd;
+    }
+
+    if (blocks > 0)
+    {
+        retval =
+            file_write_all(
+                f, fd, bloom, (size_t)blocks * REVOCATION_BLOOM_BLOCK_SIZE);
+        if (VCTOOL_STATUS_SUCCESS != retval)
+        {
+            goto cleanup_fd;
+        }
+    }
+
+    if (count > 0)
+    {
+        retval = file_write_all(f, fd, entries, count * REVOCATION_ENTRY_SIZE);
+        if (VCTOOL_STATUS_SUCCESS != retval)
+        {
+            goto cleanup_fd;
+        }
+    }
+
+    if (indexed)
+    {
+        retval = file_write_all(f, fd, slots, slots_size);
+        if (VCTOOL_STATUS_SUCCESS != retval)
+        {
+            goto cleanup_fd;
+        }
+
+        retval = file_write_all(f, fd, index.data, index.size);
+        if (VCTOOL_STATUS_SUCCESS != retval)
+        {
+            goto cleanup_fd;
+        }
+    }
+
+    /* the list must be on disk before it replaces the old one. */
+    retval = file_fsync(f, fd);
+    if (VCTOOL_STATUS_SUCCESS != retval)
+    {
+        goto cleanup_fd;
+    }
+
+    /* close the file before replacing the list. */
+    retval = file_close(f, fd);
+    if (VCTOOL_STATUS_SUCCESS != retval)
+    {
+        goto cleanup_tmp;
+    }
+
+    /* atomically replace the list. */
+    retval = file_rename(f, tmp, path);
+    goto cleanup_tmp;
+
+cleanup_fd:
+    file_close(f, fd);
+
+cleanup_tmp:
+    free(tmp);
+
+cleanup_slots:
+    free(slots);
+
+cleanup_index:
+    if (indexed)
+    {
+        dispose((disposable_t*)&index);
+    }
+
+cleanup_bloom:
+    free(bloom);
+
+cleanup_entries:
+    free(state.entries);
+
+    return retval;
+}
+
+/**
+ * \brief Append a sorted entry unless it repeats the previous one.
+ *
+ * \param context       The sort state.
+ * \param record        The next entry in sorted order.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - VCTOOL_ERROR_GENERAL_OUT_OF_MEMORY if the entries could not grow.
+ */
+static int revocation_sort_output(void* context, const void* record)
+{
+    revocation_sort_state* state = (revocation_sort_state*)context;
+    uint8_t* out = state->entries + state->count * REVOCATION_ENTRY_SIZE;
+
+    if (state->count > 0
+     && !memcmp(out - REVOCATION_ENTRY_SIZE, record, REVOCATION_ENTRY_SIZE))
+    {
+        return VCTOOL_STATUS_SUCCESS;
+    }
+
+    /* grow the entries if needed. */
+    if (state->count == state->reserved)
+    {
+        size_t reserved = (0 == state->reserved) ? 1024 : 2 * state->reserved;
+        uint8_t* tmp =
+            (uint8_t*)realloc(
+                state->entries, reserved * REVOCATION_ENTRY_SIZE);
+        if (NULL == tmp)
+        {
+            return VCTOOL_ERROR_GENERAL_OUT_OF_MEMORY;
+        }
+
+        state->entries = tmp;
+        state->reserved = reserved;
+        out = state->entries + state->count * REVOCATION_ENTRY_SIZE;
+    }
+
+    memcpy(out, record, REVOCATION_ENTRY_SIZE);
+    ++state->count;
+
+    return VCTOOL_STATUS_SUCCESS;
+}
+
+/**
+ * \brief Write a big endian 64-bit value.
+ *
+ * \param buf           The buffer to which the value is written.
+ * \param val           The value to write.
+ */
+static void revocation_write_u64(uint8_t* buf, uint64_t val)
+{
+    for (int i = 7; i >= 0; --i)
+    {
+        buf[i] = (uint8_t)(val & 0xff);
+        val >>= 8;
+    }
+}
+
+/**
+ * \brief Write a big endian 32-bit value.
+ *
+ * \param buf           The buffer to which the value is written.
+ * \param val           The value to write.
+ */
+static void revocation_write_u32(uint8_t* buf, uint32_t val)
+{
+    buf[0] = (uint8_t)(val >> 24);
+    buf[1] = (uint8_t)(val >> 16);
+    buf[2] = (uint8_t)(val >> 8);
+    buf[3] = (uint8_t)val;
+}
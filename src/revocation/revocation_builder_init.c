@@ -0,0 +1,112 @@
+/**
+ * \file revocation/revocation_builder_init.c
+ *
+ * \brief Initialize a revocation list builder.
+ *
+ * \copyright 2020 Velo Payments.  See License.txt for license terms.
+ */
+
+#include <cbmc/model_assert.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vctool/revocation.h>
+
+/* forward decls. */
+static void revocation_builder_dispose(void* disp);
+
+/**
+ * \brief Initialize a revocation list builder.
+ *
+ * Sort runs which exceed REVOCATION_SORT_BUDGET are spilled to the directory
+ * of the list.
+ *
+ * \param builder       The builder to initialize.
+ * \param f             The file abstraction layer to use.
+ * \param path          The path of the revocation list.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - VCTOOL_ERROR_GENERAL_OUT_OF_MEMORY if an allocation failed.
+ */
+int revocation_builder_init(
+    revocation_builder* builder, file* f, const char* path)
+{
+    int retval;
+
+    /* parameter sanity checks. */
+    MODEL_ASSERT(NULL != builder);
+    MODEL_ASSERT(PROP_FILE_VALID(f));
+    MODEL_ASSERT(NULL != path);
+
+    /* clear the builder. */
+    memset(builder, 0, sizeof(revocation_builder));
+
+    builder->path = strdup(path);
+    if (NULL == builder->path)
+    {
+        return VCTOOL_ERROR_GENERAL_OUT_OF_MEMORY;
+    }
+
+    /* runs go in the directory of the list. */
+    size_t dir_size = strlen(path) + 2;
+    char* dir = (char*)malloc(dir_size);
+    if (NULL == dir)
+    {
+        retval = VCTOOL_ERROR_GENERAL_OUT_OF_MEMORY;
+        goto free_path;
+    }
+
+    const char* slash = strrchr(path, '/');
+    if (NULL == slash)
+    {
+        strcpy(dir, ".");
+    }
+    else if (slash == path)
+    {
+        strcpy(dir, "/");
+    }
+    else
+    {
+        memcpy(dir, path, (size_t)(slash - path));
+        dir[slash - path] = 0;
+    }
+
+    retval =
+        extsort_init(
+            &builder->sorter, f, dir, REVOCATION_ENTRY_SIZE,
+            REVOCATION_ENTRY_SIZE, REVOCATION_SORT_BUDGET, 0);
+    free(dir);
+    if (VCTOOL_STATUS_SUCCESS != retval)
+    {
+        goto free_path;
+    }
+
+    builder->hdr.dispose = &revocation_builder_dispose;
+    builder->file = f;
+
+    /* success. */
+    return VCTOOL_STATUS_SUCCESS;
+
+free_path:
+    free(builder->path);
+    memset(builder, 0, sizeof(revocation_builder));
+
+    return retval;
+}
+
+/**
+ * \brief Dispose of a revocation list builder, removing any sort runs left
+ * over.
+ *
+ * \param disp          The builder to dispose.
+ */
+static void revocation_builder_dispose(void* disp)
+{
+    revocation_builder* builder = (revocation_builder*)disp;
+
+    dispose((disposable_t*)&builder->sorter);
+    free(builder->path);
+
+    /* clear the builder. */
+    memset(builder, 0, sizeof(revocation_builder));
+}
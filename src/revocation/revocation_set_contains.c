@@ -0,0 +1,101 @@
+/**
+ * \file revocation/revocation_set_contains.c
+ *
+ * \brief Check whether an id has been revoked.
+ *
+ * \copyright 2020 Velo Payments.  See License.txt for license terms.
+ */
+
+#include <cbmc/model_assert.h>
+#include <endian.h>
+#include <string.h>
+#include <vctool/revocation.h>
+
+/**
+ * \brief Check whether an id has been revoked.
+ *
+ * \param set           The revocation set to search.
+ * \param id            The REVOCATION_ENTRY_SIZE byte id to look up.
+ *
+ * \returns true if this id has been revoked, and false otherwise.
+ */
+bool revocation_set_contains(const revocation_set* set, const uint8_t* id)
+{
+    uint64_t mask[REVOCATION_BLOOM_BLOCK_WORDS];
+    uint64_t block[REVOCATION_BLOOM_BLOCK_WORDS];
+
+    /* parameter sanity checks. */
+    MODEL_ASSERT(NULL != set);
+    MODEL_ASSERT(NULL != id);
+
+    /* an empty list revokes nothing. */
+    if (0 == set->count)
+    {
+        return false;
+    }
+
+    /* most ids are not revoked; the Bloom filter answers these quickly. */
+    if (set->bloom_blocks > 0)
+    {
+        uint32_t b =
+            revocation_bloom_mask(
+                mask, id, set->bloom_blocks, set->bloom_hashes);
+        memcpy(
+            block, set->bloom + (size_t)b * REVOCATION_BLOOM_BLOCK_SIZE,
+            sizeof(block));
+
+        for (int i = 0; i < REVOCATION_BLOOM_BLOCK_WORDS; ++i)
+        {
+            if ((le64toh(block[i]) & mask[i]) != mask[i])
+            {
+                return false;
+            }
+        }
+    }
+
+    /* the perfect hash locates the only entry which could match. */
+    if (NULL != set->slots)
+    {
+        uint32_t pos;
+        uint64_t slot = mph_lookup(&set->index, id);
+        if (slot >= set->count)
+        {
+            return false;
+        }
+
+        memcpy(&pos, set->slots + slot * sizeof(pos), sizeof(pos));
+        pos = le32toh(pos);
+
+        return
+            pos < set->count
+         && !memcmp(
+                set->entries + (size_t)pos * REVOCATION_ENTRY_SIZE, id,
+                REVOCATION_ENTRY_SIZE);
+    }
+
+    /* otherwise, binary search the sorted entries. */
+    size_t lo = 0, hi = (size_t)set->count;
+    while (lo < hi)
+    {
+        size_t mid = lo + (hi - lo) / 2;
+        int cmp =
+            memcmp(
+                set->entries + mid * REVOCATION_ENTRY_SIZE, id,
+                REVOCATION_ENTRY_SIZE);
+
+        if (0 == cmp)
+        {
+            return true;
+        }
+        else if (cmp < 0)
+        {
+            lo = mid + 1;
+        }
+        else
+        {
+            hi = mid;
+        }
+    }
+
+    return false;
+}
@@ -0,0 +1,207 @@
+/**
+ * \file revocation/revocation_set_open.c
+ *
+ * \brief Open a revocation list.
+ *
+ * \copyright 2020 Velo Payments.  See License.txt for license terms.
+ */
+
+#include <cbmc/model_assert.h>
+#include <endian.h>
+#include <fcntl.h>
+#include <string.h>
+#include <vctool/revocation.h>
+
+/* forward decls. */
+static void revocation_set_dispose(void* disp);
+static uint64_t revocation_read_u64(const uint8_t* buf);
+static uint32_t revocation_read_u32(const uint8_t* buf);
+
+/**
+ * \brief Open a revocation list.
+ *
+ * \param set           The revocation set to initialize.
+ * \param f             The file abstraction layer to use.
+ * \param path          The path of the revocation list.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - VCTOOL_ERROR_REVOCATION_BAD_HEADER if the header is invalid.
+ *      - VCTOOL_ERROR_REVOCATION_BAD_SIZE if the file is truncated.
+ *      - a non-zero error code on failure.
+ */
+int revocation_set_open(revocation_set* set, file* f, const char* path)
+{
+    int retval, fd;
+    file_stat_st fst;
+
+    /* parameter sanity checks. */
+    MODEL_ASSERT(NULL != set);
+    MODEL_ASSERT(PROP_FILE_VALID(f));
+    MODEL_ASSERT(NULL != path);
+
+    /* clear the set. */
+    memset(set, 0, sizeof(revocation_set));
+
+    /* get the size of the list. */
+    retval = file_stat(f, path, &fst);
+    if (VCTOOL_STATUS_SUCCESS != retval)
+    {
+        goto done;
+    }
+
+    /* the list must at least hold a header. */
+    uint64_t file_size = (uint64_t)fst.fst_size;
+    if (file_size < REVOCATION_HEADER_SIZE)
+    {
+        retval = VCTOOL_ERROR_REVOCATION_BAD_HEADER;
+        goto done;
+    }
+
+    /* open the list. */
+    retval = file_open(f, &fd, path, O_RDONLY, 0);
+    if (VCTOOL_STATUS_SUCCESS != retval)
+    {
+        goto done;
+    }
+
+    /* map the list; the mapping outlives the descriptor. */
+    set->map_size = (size_t)file_size;
+    retval = file_mmap(f, &set->map, fd, set->map_size);
+    file_close(f, fd);
+    if (VCTOOL_STATUS_SUCCESS != retval)
+    {
+        goto done;
+    }
+
+    /* verify the magic. */
+    const uint8_t* base = (const uint8_t*)set->map;
+    if (memcmp(base, REVOCATION_MAGIC, REVOCATION_MAGIC_SIZE))
+    {
+        retval = VCTOOL_ERROR_REVOCATION_BAD_HEADER;
+        goto cleanup_map;
+    }
+
+    /* decode the header. */
+    set->count = revocation_read_u64(base + 8);
+    set->digest = revocation_read_u64(base + 16);
+    set->bloom_blocks = revocation_read_u32(base + 24);
+    set->bloom_hashes = revocation_read_u32(base + 28);
+    if (set->bloom_hashes > 64 / 9)
+    {
+        retval = VCTOOL_ERROR_REVOCATION_BAD_HEADER;
+        goto cleanup_map;
+    }
+
+    /* the file must hold everything described by the header. */
+    uint64_t bloom_size =
+        (uint64_t)set->bloom_blocks * REVOCATION_BLOOM_BLOCK_SIZE;
+    uint64_t list_size =
+        REVOCATION_HEADER_SIZE + bloom_size
+      + set->count * REVOCATION_ENTRY_SIZE;
+    if (set->count > file_size / REVOCATION_ENTRY_SIZE
+     || list_size > file_size)
+    {
+        retval = VCTOOL_ERROR_REVOCATION_BAD_SIZE;
+        goto cleanup_map;
+    }
+
+    /* set up the views into the mapping. */
+    set->hdr.dispose = &revocation_set_dispose;
+    set->file = f;
+    set->bloom = base + REVOCATION_HEADER_SIZE;
+    set->entries = set->bloom + bloom_size;
+
+    /* anything after the entries is the perfect hash section. */
+    if (list_size < file_size)
+    {
+        uint64_t slots_size = (set->count * sizeof(uint32_t) + 7) & ~7UL;
+        if (list_size + slots_size >= file_size)
+        {
+            retval = VCTOOL_ERROR_REVOCATION_BAD_SIZE;
+            goto cleanup_map;
+        }
+
+        retval =
+            mph_view(
+                &set->index, base + list_size + slots_size,
+                (size_t)(file_size - list_size - slots_size));
+        if (VCTOOL_STATUS_SUCCESS != retval)
+        {
+            goto cleanup_map;
+        }
+        else if (set->index.key_count != set->count)
+        {
+            retval = VCTOOL_ERROR_REVOCATION_BAD_HEADER;
+            goto cleanup_map;
+        }
+
+        set->slots = base + list_size;
+    }
+
+    /* success. */
+    retval = VCTOOL_STATUS_SUCCESS;
+    goto done;
+
+cleanup_map:
+    file_munmap(f, set->map, set->map_size);
+    memset(set, 0, sizeof(revocation_set));
+
+done:
+    return retval;
+}
+
+/**
+ * \brief Dispose of a revocation set.
+ *
+ * \param disp          The revocation set to dispose.
+ */
+static void revocation_set_dispose(void* disp)
+{
+    revocation_set* set = (revocation_set*)disp;
+
+    /* dispose of the perfect hash view. */
+    if (NULL != set->slots)
+    {
+        dispose((disposable_t*)&set->index);
+    }
+
+    /* unmap the list. */
+    file_munmap(set->file, set->map, set->map_size);
+
+    /* clear the set. */
+    memset(set, 0, sizeof(revocation_set));
+}
+
+/**
+ * \brief Read a big endian 64-bit value.
+ *
+ * \param buf           The buffer from which the value is read.
+ *
+ * \returns the value.
+ */
+static uint64_t revocation_read_u64(const uint8_t* buf)
+{
+    uint64_t val = 0;
+
+    for (int i = 0; i < 8; ++i)
+    {
+        val = (val << 8) | buf[i];
+    }
+
+    return val;
+}
+
+/**
+ * \brief Read a big endian 32-bit value.
+ *
+ * \param buf           The buffer from which the value is read.
+ *
+ * \returns the value.
+ */
+static uint32_t revocation_read_u32(const uint8_t* buf)
+{
+    return
+        ((uint32_t)buf[0] << 24) | ((uint32_t)buf[1] << 16)
+      | ((uint32_t)buf[2] << 8) | (uint32_t)buf[3];
+}
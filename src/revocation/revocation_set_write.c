@@ -0,0 +1,62 @@
+/**
+ * \file revocation/revocation_set_write.c
+ *
+ * \brief Write a revocation list.
+ *
+ * \copyright 2020 Velo Payments.  See License.txt for license terms.
+ */
+
+#include <cbmc/model_assert.h>
+#include <vctool/revocation.h>
+
+/**
+ * \brief Write a revocation list.
+ *
+ * The entries are passed through a revocation_builder, which sorts and
+ * de-duplicates them.  The entries are not modified.
+ *
+ * \param f             The file abstraction layer to use.
+ * \param path          The path of the revocation list.
+ * \param entries       Array of REVOCATION_ENTRY_SIZE byte ids.
+ * \param count         The number of ids in entries.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - a non-zero error code on failure.
+ */
+int revocation_set_write(
+    file* f, const char* path, const uint8_t* entries, size_t count)
+{
+    int retval;
+    revocation_builder builder;
+
+    /* parameter sanity checks. */
+    MODEL_ASSERT(PROP_FILE_VALID(f));
+    MODEL_ASSERT(NULL != path);
+    MODEL_ASSERT(0 == count || NULL != entries);
+
+    retval = revocation_builder_init(&builder, f, path);
+    if (VCTOOL_STATUS_SUCCESS != retval)
+    {
+        goto done;
+    }
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        retval =
+            revocation_builder_add(
+                &builder, entries + i * REVOCATION_ENTRY_SIZE);
+        if (VCTOOL_STATUS_SUCCESS != retval)
+        {
+            goto cleanup_builder;
+        }
+    }
+
+    retval = revocation_builder_finish(&builder);
+
+cleanup_builder:
+    dispose((disposable_t*)&builder);
+
+done:
+    return retval;
+}
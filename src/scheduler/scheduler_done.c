@@ -0,0 +1,43 @@
+/**
+ * \file scheduler/scheduler_done.c
+ *
+ * \brief Finish a request.
+ *
+ * \copyright 2020 Velo Payments.  See License.txt for license terms.
+ */
+
+#include <cbmc/model_assert.h>
+#include <vctool/scheduler.h>
+
+/**
+ * \brief Finish a request, charging its cost to its flow.
+ *
+ * \param sched         The scheduler.
+ * \param flow          The flow of the request.
+ * \param item          The request.
+ * \param cost          The cost of the request.
+ */
+void scheduler_done(
+    scheduler* sched, scheduler_flow* flow, scheduler_item* item,
+    int64_t cost)
+{
+    /* parameter sanity checks. */
+    MODEL_ASSERT(NULL != sched);
+    MODEL_ASSERT(NULL != flow);
+    MODEL_ASSERT(NULL != item);
+    MODEL_ASSERT(flow->busy);
+
+    pthread_mutex_lock(&sched->lock);
+
+    flow->busy = false;
+    flow->deficit -= cost;
+    --flow->depth;
+    --sched->running[item->priority];
+
+    /* the flow's next request, or a bulk request held back by the limit,
+     * may now run; waiting submitters and drains may carry on. */
+    pthread_cond_broadcast(&sched->ready);
+    pthread_cond_broadcast(&sched->done);
+
+    pthread_mutex_unlock(&sched->lock);
+}
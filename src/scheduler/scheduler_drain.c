@@ -0,0 +1,36 @@
+/**
+ * \file scheduler/scheduler_drain.c
+ *
+ * \brief Wait until a flow is idle.
+ *
+ * \copyright 2020 Velo Payments.  See License.txt for license terms.
+ */
+
+#include <cbmc/model_assert.h>
+#include <vctool/scheduler.h>
+
+/**
+ * \brief Wait until a flow has no requests waiting or running, so that it
+ * can be released.
+ *
+ * Once the scheduler is stopped, this only waits for the running request;
+ * requests still waiting are left on the flow for the caller to release.
+ *
+ * \param sched         The scheduler.
+ * \param flow          The flow.
+ */
+void scheduler_drain(scheduler* sched, scheduler_flow* flow)
+{
+    /* parameter sanity checks. */
+    MODEL_ASSERT(NULL != sched);
+    MODEL_ASSERT(NULL != flow);
+
+    pthread_mutex_lock(&sched->lock);
+
+    while (flow->busy || (!sched->stopped && flow->depth > 0))
+    {
+        pthread_cond_wait(&sched->done, &sched->lock);
+    }
+
+    pthread_mutex_unlock(&sched->lock);
+}
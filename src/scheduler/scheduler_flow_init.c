@@ -0,0 +1,25 @@
+/**
+ * \file scheduler/scheduler_flow_init.c
+ *
+ * \brief Initialize the flow of a new client.
+ *
+ * \copyright 2020 Velo Payments.  See License.txt for license terms.
+ */
+
+#include <cbmc/model_assert.h>
+#include <string.h>
+#include <vctool/scheduler.h>
+
+/**
+ * \brief Initialize the flow of a new client.
+ *
+ * \param flow          The flow to initialize.
+ */
+void scheduler_flow_init(scheduler_flow* flow)
+{
+    /* parameter sanity checks. */
+    MODEL_ASSERT(NULL != flow);
+
+    /* a new client starts with no credit, and earns it in the next round. */
+    memset(flow, 0, sizeof(scheduler_flow));
+}
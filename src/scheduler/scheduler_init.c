@@ -0,0 +1,89 @@
+/**
+ * \file scheduler/scheduler_init.c
+ *
+ * \brief Create a scheduler.
+ *
+ * \copyright 2020 Velo Payments.  See License.txt for license terms.
+ */
+
+#include <cbmc/model_assert.h>
+#include <stdint.h>
+#include <string.h>
+#include <vctool/scheduler.h>
+
+/* forward decls. */
+static void scheduler_dispose(void* disp);
+
+/**
+ * \brief Create a scheduler.
+ *
+ * \param sched         The scheduler to initialize.
+ * \param bulk_limit    The number of bulk requests which may run at once.
+ * \param interactive_depth     The number of requests a flow may have
+ *                      before new ones are demoted to bulk.
+ * \param quantum       The credit given to each waiting flow in a round.
+ * \param max_depth     The number of requests a flow may have before
+ *                      submitting blocks.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - VCTOOL_ERROR_GENERAL_OUT_OF_MEMORY if the lock could not be created.
+ */
+int scheduler_init(
+    scheduler* sched, size_t bulk_limit, size_t interactive_depth,
+    int64_t quantum, size_t max_depth)
+{
+    /* parameter sanity checks. */
+    MODEL_ASSERT(NULL != sched);
+    MODEL_ASSERT(bulk_limit > 0);
+    MODEL_ASSERT(quantum > 0);
+    MODEL_ASSERT(max_depth > 0);
+
+    memset(sched, 0, sizeof(scheduler));
+    sched->quantum = quantum;
+    sched->interactive_depth = interactive_depth;
+    sched->max_depth = max_depth;
+    sched->limit[SCHEDULER_INTERACTIVE] = SIZE_MAX;
+    sched->limit[SCHEDULER_BULK] = bulk_limit;
+
+    if (0 != pthread_mutex_init(&sched->lock, NULL))
+    {
+        return VCTOOL_ERROR_GENERAL_OUT_OF_MEMORY;
+    }
+
+    if (0 != pthread_cond_init(&sched->ready, NULL))
+    {
+        goto cleanup_lock;
+    }
+
+    if (0 != pthread_cond_init(&sched->done, NULL))
+    {
+        goto cleanup_ready;
+    }
+
+    sched->hdr.dispose = &scheduler_dispose;
+
+    return VCTOOL_STATUS_SUCCESS;
+
+cleanup_ready:
+    pthread_cond_destroy(&sched->ready);
+
+cleanup_lock:
+    pthread_mutex_destroy(&sched->lock);
+
+    return VCTOOL_ERROR_GENERAL_OUT_OF_MEMORY;
+}
+
+/**
+ * \brief Dispose of a scheduler, which no thread may still be using.
+ *
+ * \param disp          The scheduler to dispose.
+ */
+static void scheduler_dispose(void* disp)
+{
+    scheduler* sched = (scheduler*)disp;
+
+    pthread_cond_destroy(&sched->done);
+    pthread_cond_destroy(&sched->ready);
+    pthread_mutex_destroy(&sched->lock);
+}
@@ -0,0 +1,197 @@
+/**
+ * \file scheduler/scheduler_next.c
+ *
+ * \brief Wait for the next request to run.
+ *
+ * \copyright 2020 Velo Payments.  See License.txt for license terms.
+ */
+
+#include <cbmc/model_assert.h>
+#include <vctool/scheduler.h>
+
+/* forward decls. */
+static scheduler_flow* scheduler_pick(scheduler* sched, unsigned priority);
+static scheduler_flow* scheduler_find(
+    scheduler* sched, unsigned priority, int64_t* rounds);
+static bool scheduler_eligible(scheduler_flow* flow, unsigned priority);
+
+/**
+ * \brief Wait for the next request to run.
+ *
+ * Interactive requests are handed out first.  Bulk requests are handed out
+ * only while fewer than the bulk limit are running.
+ *
+ * \param sched         The scheduler.
+ * \param flow          Set to the flow of the request.
+ * \param item          Set to the request, which must be passed to
+ *                      scheduler_done once it has run.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - VCTOOL_ERROR_SCHEDULER_STOPPED if the scheduler was stopped.
+ */
+int scheduler_next(
+    scheduler* sched, scheduler_flow** flow, scheduler_item** item)
+{
+    scheduler_flow* picked = NULL;
+
+    /* parameter sanity checks. */
+    MODEL_ASSERT(NULL != sched);
+    MODEL_ASSERT(NULL != flow);
+    MODEL_ASSERT(NULL != item);
+
+    pthread_mutex_lock(&sched->lock);
+
+    for (;;)
+    {
+        if (sched->stopped)
+        {
+            pthread_mutex_unlock(&sched->lock);
+            return VCTOOL_ERROR_SCHEDULER_STOPPED;
+        }
+
+        for (unsigned p = 0; NULL == picked && p < SCHEDULER_CLASSES; ++p)
+        {
+            if (sched->running[p] < sched->limit[p])
+            {
+                picked = scheduler_pick(sched, p);
+            }
+        }
+
+        if (NULL != picked)
+        {
+            break;
+        }
+
+        pthread_cond_wait(&sched->ready, &sched->lock);
+    }
+
+    /* take the request. */
+    scheduler_item* taken = picked->head;
+    picked->head = taken->next;
+    picked->busy = true;
+    ++sched->running[taken->priority];
+    ++sched->dispatched[taken->priority];
+
+    /* the flow leaves the round once it has nothing waiting; otherwise the
+     * round carries on after it. */
+    if (NULL == picked->head)
+    {
+        picked->tail = NULL;
+        if (picked->next == picked)
+        {
+            sched->flows = NULL;
+        }
+        else
+        {
+            picked->prev->next = picked->next;
+            picked->next->prev = picked->prev;
+            sched->flows = picked->next;
+        }
+
+        picked->next = picked->prev = NULL;
+    }
+    else
+    {
+        sched->flows = picked->next;
+    }
+
+    pthread_mutex_unlock(&sched->lock);
+
+    *flow = picked;
+    *item = taken;
+
+    return VCTOOL_STATUS_SUCCESS;
+}
+
+/**
+ * \brief Pick the next flow to serve in a priority class.
+ *
+ * \param sched         The scheduler, which is locked.
+ * \param priority      The priority class.
+ *
+ * \returns the flow, or NULL if no flow has a request of this class ready.
+ */
+static scheduler_flow* scheduler_pick(scheduler* sched, unsigned priority)
+{
+    int64_t rounds = 0;
+
+    scheduler_flow* picked = scheduler_find(sched, priority, &rounds);
+    if (NULL != picked || 0 == rounds)
+    {
+        return picked;
+    }
+
+    /* every ready flow has spent its credit, so run as many rounds as it
+     * takes for the least indebted one to have credit again. */
+    scheduler_flow* flow = sched->flows;
+    do
+    {
+        if (scheduler_eligible(flow, priority))
+        {
+            flow->deficit += rounds * sched->quantum;
+        }
+
+        flow = flow->next;
+    } while (flow != sched->flows);
+
+    return scheduler_find(sched, priority, &rounds);
+}
+
+/**
+ * \brief Find the first ready flow in the round with credit.
+ *
+ * \param sched         The scheduler, which is locked.
+ * \param priority      The priority class.
+ * \param rounds        Set to the number of rounds of credit the least
+ *                      indebted ready flow needs, or zero if no flow is
+ *                      ready.
+ *
+ * \returns the flow, or NULL if no ready flow has credit.
+ */
+static scheduler_flow* scheduler_find(
+    scheduler* sched, unsigned priority, int64_t* rounds)
+{
+    *rounds = 0;
+
+    scheduler_flow* flow = sched->flows;
+    if (NULL == flow)
+    {
+        return NULL;
+    }
+
+    do
+    {
+        if (scheduler_eligible(flow, priority))
+        {
+            if (flow->deficit > 0)
+            {
+                return flow;
+            }
+
+            int64_t needed =
+                (sched->quantum - flow->deficit) / sched->quantum;
+            if (0 == *rounds || needed < *rounds)
+            {
+                *rounds = needed;
+            }
+        }
+
+        flow = flow->next;
+    } while (flow != sched->flows);
+
+    return NULL;
+}
+
+/**
+ * \brief Check whether a flow has a request of a class ready to run.
+ *
+ * \param flow          The flow, which has a waiting request.
+ * \param priority      The priority class.
+ *
+ * \returns true if the flow's next request can run.
+ */
+static bool scheduler_eligible(scheduler_flow* flow, unsigned priority)
+{
+    return !flow->busy && flow->head->priority == priority;
+}
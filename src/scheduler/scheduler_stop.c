@@ -0,0 +1,31 @@
+/**
+ * \file scheduler/scheduler_stop.c
+ *
+ * \brief Stop a scheduler.
+ *
+ * \copyright 2020 Velo Payments.  See License.txt for license terms.
+ */
+
+#include <cbmc/model_assert.h>
+#include <vctool/scheduler.h>
+
+/**
+ * \brief Stop a scheduler, waking every waiting thread.
+ *
+ * Requests which are still waiting are no longer handed out.
+ *
+ * \param sched         The scheduler.
+ */
+void scheduler_stop(scheduler* sched)
+{
+    /* parameter sanity checks. */
+    MODEL_ASSERT(NULL != sched);
+
+    pthread_mutex_lock(&sched->lock);
+
+    sched->stopped = true;
+    pthread_cond_broadcast(&sched->ready);
+    pthread_cond_broadcast(&sched->done);
+
+    pthread_mutex_unlock(&sched->lock);
+}
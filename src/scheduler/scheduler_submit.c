@@ -0,0 +1,85 @@
+/**
+ * \file scheduler/scheduler_submit.c
+ *
+ * \brief Queue a request.
+ *
+ * \copyright 2020 Velo Payments.  See License.txt for license terms.
+ */
+
+#include <cbmc/model_assert.h>
+#include <vctool/scheduler.h>
+
+/**
+ * \brief Queue a request, waiting while the flow is at its maximum depth.
+ *
+ * \param sched         The scheduler.
+ * \param flow          The flow of the client.
+ * \param item          The request, with its priority set; an interactive
+ *                      request is demoted to bulk if the flow is deep.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - VCTOOL_ERROR_SCHEDULER_STOPPED if the scheduler was stopped, in
+ *        which case the request was not queued.
+ */
+int scheduler_submit(
+    scheduler* sched, scheduler_flow* flow, scheduler_item* item)
+{
+    /* parameter sanity checks. */
+    MODEL_ASSERT(NULL != sched);
+    MODEL_ASSERT(NULL != flow);
+    MODEL_ASSERT(NULL != item);
+    MODEL_ASSERT(item->priority < SCHEDULER_CLASSES);
+
+    pthread_mutex_lock(&sched->lock);
+
+    /* a client which pipelines too deeply waits for its own requests. */
+    while (!sched->stopped && flow->depth >= sched->max_depth)
+    {
+        pthread_cond_wait(&sched->done, &sched->lock);
+    }
+
+    if (sched->stopped)
+    {
+        pthread_mutex_unlock(&sched->lock);
+        return VCTOOL_ERROR_SCHEDULER_STOPPED;
+    }
+
+    /* a deep pipeline is a bulk job. */
+    if (flow->depth >= sched->interactive_depth)
+    {
+        item->priority = SCHEDULER_BULK;
+    }
+
+    item->next = NULL;
+    if (NULL == flow->head)
+    {
+        flow->head = item;
+
+        /* a flow with waiting requests joins the end of the round. */
+        if (NULL == sched->flows)
+        {
+            flow->next = flow->prev = flow;
+            sched->flows = flow;
+        }
+        else
+        {
+            flow->next = sched->flows;
+            flow->prev = sched->flows->prev;
+            flow->prev->next = flow;
+            flow->next->prev = flow;
+        }
+    }
+    else
+    {
+        flow->tail->next = item;
+    }
+
+    flow->tail = item;
+    ++flow->depth;
+
+    pthread_cond_signal(&sched->ready);
+    pthread_mutex_unlock(&sched->lock);
+
+    return VCTOOL_STATUS_SUCCESS;
+}
@@ -0,0 +1,226 @@
+/**
+ * \file singleflight/singleflight_do.c
+ *
+ * \brief Compute a result, or share the computation in flight.
+ *
+ * \copyright 2020 Velo Payments.  See License.txt for license terms.
+ */
+
+#include <cbmc/model_assert.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vctool/singleflight.h>
+
+/* forward decls. */
+static singleflight_call* singleflight_find(
+    singleflight* group, const void* key, size_t key_size);
+static bool singleflight_slot_free(const singleflight* group);
+static unsigned singleflight_slot_take(singleflight* group);
+static int singleflight_take(
+    singleflight* group, singleflight_call* call, void* result);
+
+/**
+ * \brief Compute the result for a key, or share the computation in flight.
+ *
+ * The leader of a new computation takes a locked result slot, waiting for
+ * one to be freed if every slot is in use.
+ *
+ * \param group         The group.
+ * \param key           The key, naming the operation and its arguments.
+ * \param key_size      The size of the key.
+ * \param fn            The computation, run only if none is in flight.
+ * \param context       The user context passed to fn.
+ * \param result        Buffer of the group's result size receiving the
+ *                      result, if the status is success; NULL if results
+ *                      are empty.
+ * \param shared        Set to true if another caller ran the computation.
+ *
+ * \returns a status code indicating success or failure.
+ *      - the status code returned by the computation.
+ *      - VCTOOL_ERROR_GENERAL_OUT_OF_MEMORY if an allocation failed.
+ */
+int singleflight_do(
+    singleflight* group, const void* key, size_t key_size, singleflight_fn fn,
+    void* context, void* result, bool* shared)
+{
+    int retval;
+
+    /* parameter sanity checks. */
+    MODEL_ASSERT(NULL != group);
+    MODEL_ASSERT(NULL != key);
+    MODEL_ASSERT(NULL != fn);
+    MODEL_ASSERT(0 == group->result_size || NULL != result);
+    MODEL_ASSERT(NULL != shared);
+
+    pthread_mutex_lock(&group->lock);
+
+    singleflight_call* call;
+    for (;;)
+    {
+        /* join the computation in flight. */
+        call = singleflight_find(group, key, key_size);
+        if (NULL != call)
+        {
+            ++call->callers;
+            ++group->shared;
+
+            while (!call->done)
+            {
+                pthread_cond_wait(&group->landed, &group->lock);
+            }
+
+            *shared = true;
+            retval = singleflight_take(group, call, result);
+            pthread_mutex_unlock(&group->lock);
+
+            return retval;
+        }
+
+        if (singleflight_slot_free(group))
+        {
+            break;
+        }
+
+        /* another caller may start this key while we wait for a slot. */
+        pthread_cond_wait(&group->landed, &group->lock);
+    }
+
+    /* otherwise, lead a new one; the key shares its allocation. */
+    call = (singleflight_call*)malloc(sizeof(singleflight_call) + key_size);
+    if (NULL == call)
+    {
+        pthread_mutex_unlock(&group->lock);
+        return VCTOOL_ERROR_GENERAL_OUT_OF_MEMORY;
+    }
+
+    memset(call, 0, sizeof(singleflight_call));
+    call->key = (uint8_t*)(call + 1);
+    call->key_size = key_size;
+    call->callers = 1;
+    memcpy(call->key, key, key_size);
+
+    /* the result lives in a locked slot; a freed slot is already wiped. */
+    if (NULL != group->slots)
+    {
+        call->slot = singleflight_slot_take(group);
+        call->result = group->slots + call->slot * group->result_size;
+    }
+
+    call->next = group->calls;
+    group->calls = call;
+    ++group->flights;
+
+    pthread_mutex_unlock(&group->lock);
+
+    /* compute without the lock, so other keys aren't held up. */
+    int status = fn(context, call->result);
+
+    pthread_mutex_lock(&group->lock);
+
+    /* land: later callers start a new flight. */
+    singleflight_call** link = &group->calls;
+    while (*link != call)
+    {
+        link = &(*link)->next;
+    }
+    *link = call->next;
+
+    call->status = status;
+    call->done = true;
+    pthread_cond_broadcast(&group->landed);
+
+    *shared = false;
+    retval = singleflight_take(group, call, result);
+    pthread_mutex_unlock(&group->lock);
+
+    return retval;
+}
+
+/**
+ * \brief Find the call in flight for a key.
+ *
+ * \param group         The group, which is locked.
+ * \param key           The key.
+ * \param key_size      The size of the key.
+ *
+ * \returns the call, or NULL if none is in flight.
+ */
+static singleflight_call* singleflight_find(
+    singleflight* group, const void* key, size_t key_size)
+{
+    for (singleflight_call* call = group->calls; NULL != call;
+         call = call->next)
+    {
+        if (call->key_size == key_size && !memcmp(call->key, key, key_size))
+        {
+            return call;
+        }
+    }
+
+    return NULL;
+}
+
+/**
+ * \brief Check whether a new computation can take a result slot.
+ *
+ * \param group         The group, which is locked.
+ *
+ * \returns true if a slot is free, or if results are empty.
+ */
+static bool singleflight_slot_free(const singleflight* group)
+{
+    return NULL == group->slots || UINT64_MAX != group->slots_used;
+}
+
+/**
+ * \brief Take a free result slot.
+ *
+ * \param group         The group, which is locked, and has a free slot.
+ *
+ * \returns the index of the slot.
+ */
+static unsigned singleflight_slot_take(singleflight* group)
+{
+    unsigned slot = (unsigned)__builtin_ctzll(~group->slots_used);
+    group->slots_used |= (uint64_t)1 << slot;
+
+    return slot;
+}
+
+/**
+ * \brief Take a copy of a landed call's result, freeing the call once every
+ * caller has taken one.
+ *
+ * \param group         The group, which is locked.
+ * \param call          The landed call.
+ * \param result        Buffer receiving the result, if the status is
+ *                      success.
+ *
+ * \returns the status of the call.
+ */
+static int singleflight_take(
+    singleflight* group, singleflight_call* call, void* result)
+{
+    int retval = call->status;
+
+    if (VCTOOL_STATUS_SUCCESS == retval && group->result_size > 0)
+    {
+        memcpy(result, call->result, group->result_size);
+    }
+
+    /* the result may hold secrets, such as a session key; a leader may be
+     * waiting for the slot. */
+    if (0 == --call->callers)
+    {
+        if (NULL != group->slots)
+        {
+            explicit_bzero(call->result, group->result_size);
+            group->slots_used &= ~((uint64_t)1 << call->slot);
+            pthread_cond_broadcast(&group->landed);
+        }
+
+        free(call);
+    }
+
+    return retval;
+}
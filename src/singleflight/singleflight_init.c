@@ -0,0 +1,135 @@
+/**
+ * \file singleflight/singleflight_init.c
+ *
+ * \brief Create a single-flight group.
+ *
+ * \copyright 2020 Velo Payments.  See License.txt for license terms.
+ */
+
+#include <cbmc/model_assert.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#include <vctool/singleflight.h>
+
+/* forward decls. */
+static void singleflight_dispose(void* disp);
+
+/**
+ * \brief Create a single-flight group.
+ *
+ * The result slots are mapped and locked up front, so a computation never
+ * waits on the allocator for its result.
+ *
+ * \param group         The group to initialize.
+ * \param result_size   The size of a result.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - VCTOOL_ERROR_GENERAL_SECURE_MEMORY if the result slots could not be
+ *        locked in memory.
+ *      - VCTOOL_ERROR_GENERAL_OUT_OF_MEMORY if an allocation failed.
+ */
+int singleflight_init(singleflight* group, size_t result_size)
+{
+    int retval;
+
+    /* parameter sanity checks. */
+    MODEL_ASSERT(NULL != group);
+
+    memset(group, 0, sizeof(singleflight));
+    group->result_size = result_size;
+
+    if (result_size > 0)
+    {
+        /* round the slots up to whole pages, which are locked as a unit. */
+        long page = sysconf(_SC_PAGESIZE);
+        size_t page_size = (page > 0) ? (size_t)page : 4096;
+        size_t size = SINGLEFLIGHT_MAX_FLIGHTS * result_size;
+        group->mapped_size = ((size + page_size - 1) / page_size) * page_size;
+
+        void* map =
+            mmap(
+                NULL, group->mapped_size, PROT_READ | PROT_WRITE,
+                MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (MAP_FAILED == map)
+        {
+            retval = VCTOOL_ERROR_GENERAL_OUT_OF_MEMORY;
+            goto clear_group;
+        }
+
+        group->slots = (uint8_t*)map;
+
+        /* keep results out of swap and out of core dumps. */
+        if (0 != mlock(map, group->mapped_size))
+        {
+            retval = VCTOOL_ERROR_GENERAL_SECURE_MEMORY;
+            goto cleanup_map;
+        }
+
+        if (0 != madvise(map, group->mapped_size, MADV_DONTDUMP))
+        {
+            retval = VCTOOL_ERROR_GENERAL_SECURE_MEMORY;
+            goto cleanup_lock;
+        }
+    }
+
+    if (0 != pthread_mutex_init(&group->lock, NULL))
+    {
+        retval = VCTOOL_ERROR_GENERAL_OUT_OF_MEMORY;
+        goto cleanup_lock;
+    }
+
+    if (0 != pthread_cond_init(&group->landed, NULL))
+    {
+        retval = VCTOOL_ERROR_GENERAL_OUT_OF_MEMORY;
+        goto cleanup_mutex;
+    }
+
+    group->hdr.dispose = &singleflight_dispose;
+
+    return VCTOOL_STATUS_SUCCESS;
+
+cleanup_mutex:
+    pthread_mutex_destroy(&group->lock);
+
+cleanup_lock:
+    if (NULL != group->slots)
+    {
+        munlock(group->slots, group->mapped_size);
+    }
+
+cleanup_map:
+    if (NULL != group->slots)
+    {
+        munmap(group->slots, group->mapped_size);
+    }
+
+clear_group:
+    memset(group, 0, sizeof(singleflight));
+
+    return retval;
+}
+
+/**
+ * \brief Dispose of a single-flight group, which must have no calls in
+ * flight.
+ *
+ * \param disp          The group to dispose.
+ */
+static void singleflight_dispose(void* disp)
+{
+    singleflight* group = (singleflight*)disp;
+
+    MODEL_ASSERT(NULL == group->calls);
+
+    if (NULL != group->slots)
+    {
+        explicit_bzero(group->slots, group->mapped_size);
+        munlock(group->slots, group->mapped_size);
+        munmap(group->slots, group->mapped_size);
+    }
+
+    pthread_cond_destroy(&group->landed);
+    pthread_mutex_destroy(&group->lock);
+}
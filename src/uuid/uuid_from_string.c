@@ -0,0 +1,108 @@
+/**
+ * \file uuid/uuid_from_string.c
+ *
+ * \brief Parse a uuid string.
+ *
+ * \copyright 2020 Velo Payments.  See License.txt for license terms.
+ */
+
+#include <cbmc/model_assert.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <vctool/uuid.h>
+
+/* forward decls. */
+static int uuid_hex_value(char ch);
+
+/**
+ * \brief Parse a uuid string.
+ *
+ * Both the canonical 8-4-4-4-12 form and 32 bare hex digits are accepted.
+ *
+ * \param uuid          Buffer of UUID_SIZE bytes to receive the uuid.
+ * \param str           The string to parse.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - VCTOOL_ERROR_UUID_INVALID_STRING if the string is not a uuid.
+ */
+int uuid_from_string(uint8_t* uuid, const char* str)
+{
+    size_t digits = 0;
+
+    /* parameter sanity checks. */
+    MODEL_ASSERT(NULL != uuid);
+    MODEL_ASSERT(NULL != str);
+
+    /* is this the canonical form, with dashes? */
+    bool dashed = ('-' == str[8]);
+
+    for (const char* p = str; 0 != *p; ++p)
+    {
+        /* dashes are only allowed at canonical positions. */
+        if ('-' == *p)
+        {
+            size_t pos = (size_t)(p - str);
+            if (!dashed || (8 != pos && 13 != pos && 18 != pos && 23 != pos))
+            {
+                return VCTOOL_ERROR_UUID_INVALID_STRING;
+            }
+
+            continue;
+        }
+
+        /* decode this nibble. */
+        int nibble = uuid_hex_value(*p);
+        if (nibble < 0 || digits >= 2 * UUID_SIZE)
+        {
+            return VCTOOL_ERROR_UUID_INVALID_STRING;
+        }
+
+        if (0 == digits % 2)
+        {
+            uuid[digits / 2] = (uint8_t)(nibble << 4);
+        }
+        else
+        {
+            uuid[digits / 2] |= (uint8_t)nibble;
+        }
+
+        ++digits;
+    }
+
+    /* we must have decoded exactly one uuid. */
+    if (2 * UUID_SIZE != digits)
+    {
+        return VCTOOL_ERROR_UUID_INVALID_STRING;
+    }
+
+    /* success. */
+    return VCTOOL_STATUS_SUCCESS;
+}
+
+/**
+ * \brief Decode a hex digit.
+ *
+ * \param ch            The character to decode.
+ *
+ * \returns the value of this digit, or -1 if it is not a hex digit.
+ */
+static int uuid_hex_value(char ch)
+{
+    if (ch >= '0' && ch <= '9')
+    {
+        return ch - '0';
+    }
+    else if (ch >= 'a' && ch <= 'f')
+    {
+        return ch - 'a' + 10;
+    }
+    else if (ch >= 'A' && ch <= 'F')
+    {
+        return ch - 'A' + 10;
+    }
+    else
+    {
+        return -1;
+    }
+}
@@ -0,0 +1,40 @@
+/**
+ * \file uuid/uuid_to_string.c
+ *
+ * \brief Format a uuid string.
+ *
+ * \copyright 2020 Velo Payments.  See License.txt for license terms.
+ */
+
+#include <cbmc/model_assert.h>
+#include <stddef.h>
+#include <vctool/uuid.h>
+
+/**
+ * \brief Format a uuid in canonical 8-4-4-4-12 form.
+ *
+ * \param str           Buffer of UUID_STRING_SIZE bytes to receive the string.
+ * \param uuid          The uuid to format.
+ */
+void uuid_to_string(char* str, const uint8_t* uuid)
+{
+    static const char hex[] = "0123456789abcdef";
+
+    /* parameter sanity checks. */
+    MODEL_ASSERT(NULL != str);
+    MODEL_ASSERT(NULL != uuid);
+
+    for (size_t i = 0; i < UUID_SIZE; ++i)
+    {
+        /* dashes precede bytes 4, 6, 8, and 10. */
+        if (4 == i || 6 == i || 8 == i || 10 == i)
+        {
+            *str++ = '-';
+        }
+
+        *str++ = hex[uuid[i] >> 4];
+        *str++ = hex[uuid[i] & 0x0f];
+    }
+
+    *str = 0;
+}
@@ -0,0 +1,50 @@
+/**
+ * \file uuid_dict/uuid_dict_find.c
+ *
+ * \brief Get the id of a uuid.
+ *
+ * \copyright 2020 Velo Payments.  See License.txt for license terms.
+ */
+
+#include <cbmc/model_assert.h>
+#include <string.h>
+#include <vctool/mph.h>
+#include <vctool/uuid_dict.h>
+
+/**
+ * \brief Get the id of a uuid.
+ *
+ * \param dict          The dictionary.
+ * \param uuid          The UUID_SIZE byte uuid.
+ * \param id            Pointer to receive the id.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - VCTOOL_ERROR_UUID_DICT_NOT_FOUND if this uuid is not interned.
+ */
+int uuid_dict_find(const uuid_dict* dict, const uint8_t* uuid, uint32_t* id)
+{
+    /* parameter sanity checks. */
+    MODEL_ASSERT(NULL != dict);
+    MODEL_ASSERT(NULL != uuid);
+    MODEL_ASSERT(NULL != id);
+
+    size_t mask = dict->slot_count - 1;
+
+    /* linear probe until we find this uuid or an empty slot. */
+    for (size_t slot = mph_key_hash(uuid) & mask; ; slot = (slot + 1) & mask)
+    {
+        uint32_t candidate = dict->slots[slot];
+        if (UINT32_MAX == candidate)
+        {
+            return VCTOOL_ERROR_UUID_DICT_NOT_FOUND;
+        }
+        else if (!memcmp(
+                    dict->uuids + (size_t)candidate * UUID_SIZE, uuid,
+                    UUID_SIZE))
+        {
+            *id = candidate;
+            return VCTOOL_STATUS_SUCCESS;
+        }
+    }
+}
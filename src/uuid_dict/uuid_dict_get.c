@@ -0,0 +1,31 @@
+/**
+ * \file uuid_dict/uuid_dict_get.c
+ *
+ * \brief Get the uuid for an id.
+ *
+ * \copyright 2020 Velo Payments.  See License.txt for license terms.
+ */
+
+#include <cbmc/model_assert.h>
+#include <vctool/uuid_dict.h>
+
+/**
+ * \brief Get the uuid for an id.
+ *
+ * \param dict          The dictionary.
+ * \param id            The id.
+ *
+ * \returns the UUID_SIZE byte uuid, or NULL if this id is not assigned.
+ */
+const uint8_t* uuid_dict_get(const uuid_dict* dict, uint32_t id)
+{
+    /* parameter sanity checks. */
+    MODEL_ASSERT(NULL != dict);
+
+    if (id >= dict->count)
+    {
+        return NULL;
+    }
+
+    return dict->uuids + (size_t)id * UUID_SIZE;
+}
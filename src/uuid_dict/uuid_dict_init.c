@@ -0,0 +1,64 @@
+/**
+ * \file uuid_dict/uuid_dict_init.c
+ *
+ * \brief Initialize an empty uuid dictionary.
+ *
+ * \copyright 2020 Velo Payments.  See License.txt for license terms.
+ */
+
+#include <cbmc/model_assert.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vctool/uuid_dict.h>
+
+/* forward decls. */
+static void uuid_dict_dispose(void* disp);
+
+/**
+ * \brief Initialize an empty uuid dictionary.
+ *
+ * \param dict          The dictionary to initialize.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - VCTOOL_ERROR_GENERAL_OUT_OF_MEMORY if an allocation failed.
+ */
+int uuid_dict_init(uuid_dict* dict)
+{
+    /* parameter sanity checks. */
+    MODEL_ASSERT(NULL != dict);
+
+    /* clear the dictionary. */
+    memset(dict, 0, sizeof(uuid_dict));
+
+    /* allocate the hash table; all ones marks an empty slot. */
+    dict->slots =
+        (uint32_t*)malloc(UUID_DICT_INITIAL_SLOTS * sizeof(uint32_t));
+    if (NULL == dict->slots)
+    {
+        return VCTOOL_ERROR_GENERAL_OUT_OF_MEMORY;
+    }
+
+    memset(dict->slots, 0xff, UUID_DICT_INITIAL_SLOTS * sizeof(uint32_t));
+    dict->slot_count = UUID_DICT_INITIAL_SLOTS;
+    dict->hdr.dispose = &uuid_dict_dispose;
+
+    /* success. */
+    return VCTOOL_STATUS_SUCCESS;
+}
+
+/**
+ * \brief Dispose of a uuid dictionary.
+ *
+ * \param disp          The uuid dictionary to dispose.
+ */
+static void uuid_dict_dispose(void* disp)
+{
+    uuid_dict* dict = (uuid_dict*)disp;
+
+    free(dict->uuids);
+    free(dict->slots);
+
+    /* clear the dictionary. */
+    memset(dict, 0, sizeof(uuid_dict));
+}
@@ -0,0 +1,137 @@
+/**
+ * \file uuid_dict/uuid_dict_intern.c
+ *
+ * \brief Get the id of a uuid, assigning the next id if it is new.
+ *
+ * \copyright 2020 Velo Payments.  See License.txt for license terms.
+ */
+
+#include <cbmc/model_assert.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vctool/mph.h>
+#include <vctool/uuid_dict.h>
+
+/* forward decls. */
+static void uuid_dict_place(uuid_dict* dict, uint32_t id);
+static int uuid_dict_grow_slots(uuid_dict* dict);
+
+/**
+ * \brief Get the id of a uuid, assigning the next id if it is new.
+ *
+ * \param dict          The dictionary.
+ * \param uuid          The UUID_SIZE byte uuid.
+ * \param id            Pointer to receive the id.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - VCTOOL_ERROR_UUID_DICT_FULL if there are no more ids.
+ *      - VCTOOL_ERROR_GENERAL_OUT_OF_MEMORY if an allocation failed.
+ */
+int uuid_dict_intern(uuid_dict* dict, const uint8_t* uuid, uint32_t* id)
+{
+    int retval;
+
+    /* parameter sanity checks. */
+    MODEL_ASSERT(NULL != dict);
+    MODEL_ASSERT(NULL != uuid);
+    MODEL_ASSERT(NULL != id);
+
+    /* is this uuid already interned? */
+    if (VCTOOL_STATUS_SUCCESS == uuid_dict_find(dict, uuid, id))
+    {
+        return VCTOOL_STATUS_SUCCESS;
+    }
+
+    if (dict->count > UUID_DICT_MAX_ID)
+    {
+        return VCTOOL_ERROR_UUID_DICT_FULL;
+    }
+
+    /* grow the uuid array if needed. */
+    if (dict->count == dict->reserved)
+    {
+        uint64_t reserved = (0 == dict->reserved) ? 1024 : 2 * dict->reserved;
+        if (reserved > (uint64_t)UUID_DICT_MAX_ID + 1)
+        {
+            reserved = (uint64_t)UUID_DICT_MAX_ID + 1;
+        }
+
+        uint8_t* tmp =
+            (uint8_t*)realloc(dict->uuids, (size_t)reserved * UUID_SIZE);
+        if (NULL == tmp)
+        {
+            return VCTOOL_ERROR_GENERAL_OUT_OF_MEMORY;
+        }
+
+        dict->uuids = tmp;
+        dict->reserved = (uint32_t)reserved;
+    }
+
+    /* keep the table at most half full. */
+    if (2 * ((size_t)dict->count + 1) > dict->slot_count)
+    {
+        retval = uuid_dict_grow_slots(dict);
+        if (VCTOOL_STATUS_SUCCESS != retval)
+        {
+            return retval;
+        }
+    }
+
+    /* assign the next id. */
+    *id = dict->count++;
+    memcpy(dict->uuids + (size_t)*id * UUID_SIZE, uuid, UUID_SIZE);
+    uuid_dict_place(dict, *id);
+
+    return VCTOOL_STATUS_SUCCESS;
+}
+
+/**
+ * \brief Place an id in the first empty slot for its uuid.
+ *
+ * \param dict          The dictionary.
+ * \param id            The id to place.
+ */
+static void uuid_dict_place(uuid_dict* dict, uint32_t id)
+{
+    size_t mask = dict->slot_count - 1;
+    size_t slot = mph_key_hash(dict->uuids + (size_t)id * UUID_SIZE) & mask;
+
+    while (UINT32_MAX != dict->slots[slot])
+    {
+        slot = (slot + 1) & mask;
+    }
+
+    dict->slots[slot] = id;
+}
+
+/**
+ * \brief Double the hash table and re-place every id.
+ *
+ * \param dict          The dictionary.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - VCTOOL_ERROR_GENERAL_OUT_OF_MEMORY if an allocation failed.
+ */
+static int uuid_dict_grow_slots(uuid_dict* dict)
+{
+    size_t slot_count = 2 * dict->slot_count;
+    uint32_t* slots = (uint32_t*)malloc(slot_count * sizeof(uint32_t));
+    if (NULL == slots)
+    {
+        return VCTOOL_ERROR_GENERAL_OUT_OF_MEMORY;
+    }
+
+    memset(slots, 0xff, slot_count * sizeof(uint32_t));
+    free(dict->slots);
+    dict->slots = slots;
+    dict->slot_count = slot_count;
+
+    for (uint32_t id = 0; id < dict->count; ++id)
+    {
+        uuid_dict_place(dict, id);
+    }
+
+    return VCTOOL_STATUS_SUCCESS;
+}
@@ -0,0 +1,120 @@
+/**
+ * \file uuid_dict/uuid_dict_load.c
+ *
+ * \brief Load a uuid dictionary from a file.
+ *
+ * \copyright 2020 Velo Payments.  See License.txt for license terms.
+ */
+
+#include <cbmc/model_assert.h>
+#include <fcntl.h>
+#include <string.h>
+#include <vctool/uuid_dict.h>
+
+/**
+ * \brief Load a uuid dictionary from a file.
+ *
+ * \param dict          The dictionary to initialize.
+ * \param f             The file abstraction layer to use.
+ * \param path          The path of the dictionary file.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - VCTOOL_ERROR_UUID_DICT_BAD_FORMAT if the file is malformed.
+ *      - a non-zero error code on failure.
+ */
+int uuid_dict_load(uuid_dict* dict, file* f, const char* path)
+{
+    int retval, fd;
+    file_stat_st fst;
+    void* map;
+
+    /* parameter sanity checks. */
+    MODEL_ASSERT(NULL != dict);
+    MODEL_ASSERT(PROP_FILE_VALID(f));
+    MODEL_ASSERT(NULL != path);
+
+    /* start with an empty dictionary. */
+    retval = uuid_dict_init(dict);
+    if (VCTOOL_STATUS_SUCCESS != retval)
+    {
+        goto done;
+    }
+
+    /* get the size of the file. */
+    retval = file_stat(f, path, &fst);
+    if (VCTOOL_STATUS_SUCCESS != retval)
+    {
+        goto cleanup_dict;
+    }
+
+    size_t size = (size_t)fst.fst_size;
+    if (size < UUID_DICT_HEADER_SIZE)
+    {
+        retval = VCTOOL_ERROR_UUID_DICT_BAD_FORMAT;
+        goto cleanup_dict;
+    }
+
+    /* map the file. */
+    retval = file_open(f, &fd, path, O_RDONLY, 0);
+    if (VCTOOL_STATUS_SUCCESS != retval)
+    {
+        goto cleanup_dict;
+    }
+
+    retval = file_mmap(f, &map, fd, size);
+    file_close(f, fd);
+    if (VCTOOL_STATUS_SUCCESS != retval)
+    {
+        goto cleanup_dict;
+    }
+
+    /* verify the header. */
+    const uint8_t* base = (const uint8_t*)map;
+    uint64_t count = 0;
+    for (int i = 0; i < 8; ++i)
+    {
+        count = (count << 8) | base[UUID_DICT_MAGIC_SIZE + i];
+    }
+
+    if (memcmp(base, UUID_DICT_MAGIC, UUID_DICT_MAGIC_SIZE)
+     || count > (uint64_t)UUID_DICT_MAX_ID + 1
+     || UUID_DICT_HEADER_SIZE + count * UUID_SIZE != size)
+    {
+        retval = VCTOOL_ERROR_UUID_DICT_BAD_FORMAT;
+        goto cleanup_map;
+    }
+
+    /* intern every uuid in id order, which reproduces the saved ids. */
+    for (uint64_t i = 0; i < count; ++i)
+    {
+        uint32_t id;
+        retval =
+            uuid_dict_intern(
+                dict, base + UUID_DICT_HEADER_SIZE + i * UUID_SIZE, &id);
+        if (VCTOOL_STATUS_SUCCESS != retval)
+        {
+            goto cleanup_map;
+        }
+        else if (id != i)
+        {
+            /* a duplicate uuid. */
+            retval = VCTOOL_ERROR_UUID_DICT_BAD_FORMAT;
+            goto cleanup_map;
+        }
+    }
+
+    /* success. */
+    retval = VCTOOL_STATUS_SUCCESS;
+    file_munmap(f, map, size);
+    goto done;
+
+cleanup_map:
+    file_munmap(f, map, size);
+
+cleanup_dict:
+    dispose((disposable_t*)dict);
+
+done:
+    return retval;
+}
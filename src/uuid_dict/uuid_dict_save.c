@@ -0,0 +1,112 @@
+/**
+ * \file uuid_dict/uuid_dict_save.c
+ *
+ * \brief Save a uuid dictionary to a file.
+ *
+ * \copyright 2020 Velo Payments.  See License.txt for license terms.
+ */
+
+#include <cbmc/model_assert.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vctool/uuid_dict.h>
+
+/**
+ * \brief Save a uuid dictionary to a file.
+ *
+ * The dictionary is written to a temporary file which is then renamed over
+ * path.
+ *
+ * \param dict          The dictionary to save.
+ * \param f             The file abstraction layer to use.
+ * \param path          The path of the dictionary file.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - a non-zero error code on failure.
+ */
+int uuid_dict_save(const uuid_dict* dict, file* f, const char* path)
+{
+    int retval, fd;
+    uint8_t header[UUID_DICT_HEADER_SIZE];
+
+    /* parameter sanity checks. */
+    MODEL_ASSERT(NULL != dict);
+    MODEL_ASSERT(PROP_FILE_VALID(f));
+    MODEL_ASSERT(NULL != path);
+
+    /* build the header. */
+    memcpy(header, UUID_DICT_MAGIC, UUID_DICT_MAGIC_SIZE);
+    uint64_t count = dict->count;
+    for (int i = 7; i >= 0; --i)
+    {
+        header[UUID_DICT_MAGIC_SIZE + i] = (uint8_t)(count & 0xff);
+        count >>= 8;
+    }
+
+    /* build the temporary filename. */
+    size_t tmp_size =
+        strlen(path)
+      + 4 /* .tmp */
+      + 1;/* asciiz */
+    char* tmp = (char*)malloc(tmp_size);
+    if (NULL == tmp)
+    {
+        retval = VCTOOL_ERROR_GENERAL_OUT_OF_MEMORY;
+        goto done;
+    }
+    snprintf(tmp, tmp_size, "%s.tmp", path);
+
+    /* write the header and uuids. */
+    retval =
+        file_open(
+            f, &fd, tmp, O_CREAT | O_TRUNC | O_WRONLY,
+            S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH);
+    if (VCTOOL_STATUS_SUCCESS != retval)
+    {
+        goto cleanup_tmp;
+    }
+
+    retval = file_write_all(f, fd, header, sizeof(header));
+    if (VCTOOL_STATUS_SUCCESS != retval)
+    {
+        goto cleanup_fd;
+    }
+
+    retval =
+        file_write_all(
+            f, fd, dict->uuids, (size_t)dict->count * UUID_SIZE);
+    if (VCTOOL_STATUS_SUCCESS != retval)
+    {
+        goto cleanup_fd;
+    }
+
+    /* the dictionary must be on disk before it replaces the old one. */
+    retval = file_fsync(f, fd);
+    if (VCTOOL_STATUS_SUCCESS != retval)
+    {
+        goto cleanup_fd;
+    }
+
+    /* close the file before replacing the dictionary. */
+    retval = file_close(f, fd);
+    if (VCTOOL_STATUS_SUCCESS != retval)
+    {
+        goto cleanup_tmp;
+    }
+
+    /* atomically replace the dictionary. */
+    retval = file_rename(f, tmp, path);
+    goto cleanup_tmp;
+
+cleanup_fd:
+    file_close(f, fd);
+
+cleanup_tmp:
+    free(tmp);
+
+done:
+    return retval;
+}
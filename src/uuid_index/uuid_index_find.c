@@ -0,0 +1,33 @@
+/**
+ * \file uuid_index/uuid_index_find.c
+ *
+ * \brief Find the sorted position of a uuid.
+ *
+ * \copyright 2020 Velo Payments.  See License.txt for license terms.
+ */
+
+#include <cbmc/model_assert.h>
+#include <vctool/uuid_index.h>
+
+/**
+ * \brief Find the sorted position of a uuid.
+ *
+ * \param index         The index to search.
+ * \param key           The UUID_SIZE byte uuid.
+ *
+ * \returns the position of this uuid in the sorted array, or
+ *          UUID_INDEX_NOT_FOUND.
+ */
+size_t uuid_index_find(const uuid_index* index, const uint8_t* key)
+{
+    size_t position;
+
+    /* parameter sanity checks. */
+    MODEL_ASSERT(NULL != index);
+    MODEL_ASSERT(NULL != key);
+
+    /* a single search is a batch of one. */
+    uuid_index_find_batch(index, key, 1, &position);
+
+    return position;
+}
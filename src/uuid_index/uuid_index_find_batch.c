@@ -0,0 +1,131 @@
+/**
+ * \file uuid_index/uuid_index_find_batch.c
+ *
+ * \brief Find the sorted positions of many uuids.
+ *
+ * \copyright 2020 Velo Payments.  See License.txt for license terms.
+ */
+
+#include <cbmc/model_assert.h>
+#include <endian.h>
+#include <stdbool.h>
+#include <string.h>
+#include <vctool/uuid_index.h>
+
+#ifdef __SSE2__
+# include <emmintrin.h>
+#endif
+
+/* forward decls. */
+static bool uuid_index_less(const uint8_t* lhs, const uint8_t* rhs);
+
+/**
+ * \brief Find the sorted positions of many uuids.
+ *
+ * \param index         The index to search.
+ * \param keys          Array of UUID_SIZE byte uuids.
+ * \param count         The number of uuids.
+ * \param positions     Array receiving the sorted position of each uuid, or
+ *                      UUID_INDEX_NOT_FOUND.
+ */
+void uuid_index_find_batch(
+    const uuid_index* index, const uint8_t* keys, size_t count,
+    size_t* positions)
+{
+    size_t slot[UUID_INDEX_BATCH_WIDTH];
+
+    /* parameter sanity checks. */
+    MODEL_ASSERT(NULL != index);
+    MODEL_ASSERT(0 == count || NULL != keys);
+    MODEL_ASSERT(0 == count || NULL != positions);
+
+    const size_t n = index->count;
+    const uint8_t* tree = index->keys;
+
+    for (size_t base = 0; base < count; base += UUID_INDEX_BATCH_WIDTH)
+    {
+        size_t width = count - base;
+        if (width > UUID_INDEX_BATCH_WIDTH)
+        {
+            width = UUID_INDEX_BATCH_WIDTH;
+        }
+
+        const uint8_t* batch = keys + base * UUID_SIZE;
+        for (size_t j = 0; j < width; ++j)
+        {
+            slot[j] = 1;
+        }
+
+        /* descend one level of every search at a time, so that the cache
+         * misses of the searches in this batch overlap. */
+        for (bool active = (n > 0); active; )
+        {
+            active = false;
+            for (size_t j = 0; j < width; ++j)
+            {
+                size_t k = slot[j];
+                if (k <= n)
+                {
+                    __builtin_prefetch(tree + 4 * k * UUID_SIZE);
+                    slot[j] =
+                        2 * k
+                      + uuid_index_less(
+                            tree + k * UUID_SIZE, batch + j * UUID_SIZE);
+                    active = true;
+                }
+            }
+        }
+
+        /* undo the right turns after the last left turn; that node is the
+         * smallest uuid not less than the key, if there is one. */
+        for (size_t j = 0; j < width; ++j)
+        {
+            size_t k = slot[j] >> __builtin_ffsll((long long)~slot[j]);
+
+            positions[base + j] =
+                (0 != k
+              && !memcmp(tree + k * UUID_SIZE, batch + j * UUID_SIZE,
+                         UUID_SIZE))
+                ? index->positions[k]
+                : UUID_INDEX_NOT_FOUND;
+        }
+    }
+}
+
+/**
+ * \brief Compare two uuids as unsigned byte strings.
+ *
+ * \param lhs           The left-hand uuid.
+ * \param rhs           The right-hand uuid.
+ *
+ * \returns true if lhs sorts before rhs.
+ */
+static bool uuid_index_less(const uint8_t* lhs, const uint8_t* rhs)
+{
+#ifdef __SSE2__
+    /* SSE2 only has signed byte compares; flip the sign bits. */
+    const __m128i bias = _mm_set1_epi8((char)0x80);
+    __m128i l = _mm_xor_si128(_mm_loadu_si128((const __m128i*)lhs), bias);
+    __m128i r = _mm_xor_si128(_mm_loadu_si128((const __m128i*)rhs), bias);
+
+    unsigned ne = ~(unsigned)_mm_movemask_epi8(_mm_cmpeq_epi8(l, r)) & 0xffff;
+    unsigned lt = (unsigned)_mm_movemask_epi8(_mm_cmplt_epi8(l, r));
+
+    /* the first differing byte decides. */
+    return 0 != (lt & ne & (0U - ne));
+#else
+    uint64_t lh, ll, rh, rl;
+
+    memcpy(&lh, lhs, sizeof(lh));
+    memcpy(&ll, lhs + sizeof(lh), sizeof(ll));
+    memcpy(&rh, rhs, sizeof(rh));
+    memcpy(&rl, rhs + sizeof(rh), sizeof(rl));
+
+    lh = be64toh(lh);
+    ll = be64toh(ll);
+    rh = be64toh(rh);
+    rl = be64toh(rl);
+
+    return lh < rh || (lh == rh && ll < rl);
+#endif
+}
@@ -0,0 +1,111 @@
+/**
+ * \file uuid_index/uuid_index_init.c
+ *
+ * \brief Build a search index over sorted uuids.
+ *
+ * \copyright 2020 Velo Payments.  See License.txt for license terms.
+ */
+
+#include <cbmc/model_assert.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vctool/uuid_index.h>
+
+/* forward decls. */
+static void uuid_index_dispose(void* disp);
+static size_t uuid_index_fill(
+    uuid_index* index, const uint8_t* sorted, size_t pos, size_t slot);
+
+/**
+ * \brief Build a search index over a sorted uuid array.
+ *
+ * \param index         The index to initialize.
+ * \param sorted        Array of sorted, distinct UUID_SIZE byte uuids.
+ * \param count         The number of uuids.
+ *
+ * \returns a status code indicating success or failure.
+ *      - VCTOOL_STATUS_SUCCESS on success.
+ *      - VCTOOL_ERROR_GENERAL_OUT_OF_MEMORY if an allocation failed.
+ */
+int uuid_index_init(uuid_index* index, const uint8_t* sorted, size_t count)
+{
+    void* keys;
+
+    /* parameter sanity checks. */
+    MODEL_ASSERT(NULL != index);
+    MODEL_ASSERT(0 == count || NULL != sorted);
+
+    /* clear the index. */
+    memset(index, 0, sizeof(uuid_index));
+
+    /* slot 0 is unused, so that slot k has children 2k and 2k+1.  Slots are
+     * cache line aligned, so the grandchildren of a node share a line. */
+    size_t keys_size = ((count + 1) * UUID_SIZE + 63) & ~(size_t)63;
+    if (0 != posix_memalign(&keys, 64, keys_size))
+    {
+        return VCTOOL_ERROR_GENERAL_OUT_OF_MEMORY;
+    }
+
+    index->positions = (size_t*)malloc((count + 1) * sizeof(size_t));
+    if (NULL == index->positions)
+    {
+        free(keys);
+        return VCTOOL_ERROR_GENERAL_OUT_OF_MEMORY;
+    }
+
+    index->hdr.dispose = &uuid_index_dispose;
+    index->count = count;
+    index->keys = (uint8_t*)keys;
+    memset(index->keys, 0, UUID_SIZE);
+    index->positions[0] = UUID_INDEX_NOT_FOUND;
+
+    /* an in-order walk of the implicit tree visits slots in sorted order. */
+    uuid_index_fill(index, sorted, 0, 1);
+
+    /* success. */
+    return VCTOOL_STATUS_SUCCESS;
+}
+
+/**
+ * \brief Fill the subtree rooted at slot with the next sorted uuids.
+ *
+ * \param index         The index being built.
+ * \param sorted        The sorted uuid array.
+ * \param pos           The next sorted position to place.
+ * \param slot          The root of this subtree.
+ *
+ * \returns the next sorted position to place after this subtree.
+ */
+static size_t uuid_index_fill(
+    uuid_index* index, const uint8_t* sorted, size_t pos, size_t slot)
+{
+    if (slot <= index->count)
+    {
+        pos = uuid_index_fill(index, sorted, pos, 2 * slot);
+
+        memcpy(
+            index->keys + slot * UUID_SIZE, sorted + pos * UUID_SIZE,
+            UUID_SIZE);
+        index->positions[slot] = pos++;
+
+        pos = uuid_index_fill(index, sorted, pos, 2 * slot + 1);
+    }
+
+    return pos;
+}
+
+/**
+ * \brief Dispose of a uuid index.
+ *
+ * \param disp          The uuid index to dispose.
+ */
+static void uuid_index_dispose(void* disp)
+{
+    uuid_index* index = (uuid_index*)disp;
+
+    free(index->keys);
+    free(index->positions);
+
+    /* clear the index. */
+    memset(index, 0, sizeof(uuid_index));
+}
@@ -0,0 +1,1487 @@
+/**
+ * \file test/agent/test_agent.cpp
+ *
+ * \brief Unit tests for the agent connection.
+ *
+ * \copyright 2020 Velo Payments.  See License.txt for license terms.
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <minunit/minunit.h>
+#include <signal.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <thread>
+#include <time.h>
+#include <unistd.h>
+#include <vctool/agent.h>
+#include <vctool/blockstore.h>
+#include <vector>
+#include <vpr/allocator/malloc_allocator.h>
+
+using namespace std;
+
+/* start of the agent test suite. */
+TEST_SUITE(agent);
+
+/**
+ * \brief Write a big endian 64-bit value.
+ */
+static void write_u64(uint8_t* buf, uint64_t val)
+{
+    for (int i = 7; i >= 0; --i)
+    {
+        buf[i] = (uint8_t)(val & 0xff);
+        val >>= 8;
+    }
+}
+
+/**
+ * \brief Read a big endian 64-bit value.
+ */
+static uint64_t read_u64(const uint8_t* buf)
+{
+    uint64_t val = 0;
+
+    for (int i = 0; i < 8; ++i)
+    {
+        val = (val << 8) | buf[i];
+    }
+
+    return val;
+}
+
+/* a frame is read back as written. */
+TEST(frame_round_trip)
+{
+    file f;
+    agent_frame frame;
+    int sv[2];
+    const char PAYLOAD[] = "payload";
+
+    TEST_ASSERT(VCTOOL_STATUS_SUCCESS == file_init(&f));
+    TEST_ASSERT(0 == socketpair(AF_UNIX, SOCK_STREAM, 0, sv));
+    TEST_ASSERT(VCTOOL_STATUS_SUCCESS == agent_frame_init(&frame));
+
+    TEST_ASSERT(
+        VCTOOL_STATUS_SUCCESS ==
+            agent_frame_write(&f, sv[0], 77, PAYLOAD, sizeof(PAYLOAD)));
+    TEST_ASSERT(
+        VCTOOL_STATUS_SUCCESS ==
+            agent_frame_write(&f, sv[0], 78, nullptr, 0));
+
+    TEST_ASSERT(VCTOOL_STATUS_SUCCESS == agent_frame_read(&f, sv[1], &frame));
+    TEST_EXPECT(77U == frame.type);
+    TEST_ASSERT(sizeof(PAYLOAD) == frame.size);
+    TEST_EXPECT(0 == memcmp(PAYLOAD, frame.payload, sizeof(PAYLOAD)));
+
+    TEST_ASSERT(VCTOOL_STATUS_SUCCESS == agent_frame_read(&f, sv[1], &frame));
+    TEST_EXPECT(78U == frame.type);
+    TEST_EXPECT(0U == frame.size);
+
+    /* closing between frames is a disconnect. */
+    close(sv[0]);
+    TEST_EXPECT(
+        VCTOOL_ERROR_AGENT_DISCONNECTED == agent_frame_read(&f, sv[1], &frame));
+
+    close(sv[1]);
+    dispose((disposable_t*)&frame);
+    dispose((disposable_t*)&f);
+}
+
+/* a frame cut short is malformed. */
+TEST(frame_truncated)
+{
+    file f;
+    agent_frame frame;
+    int sv[2];
+    const uint8_t HEADER[] = { 0, 0, 0, 2, 0, 0, 0, 10, 1, 2, 3 };
+
+    TEST_ASSERT(VCTOOL_STATUS_SUCCESS == file_init(&f));
+    TEST_ASSERT(0 == socketpair(AF_UNIX, SOCK_STREAM, 0, sv));
+    TEST_ASSERT(VCTOOL_STATUS_SUCCESS == agent_frame_init(&frame));
+
+    TEST_ASSERT(sizeof(HEADER) == write(sv[0], HEADER, sizeof(HEADER)));
+    close(sv[0]);
+
+    TEST_EXPECT(
+        VCTOOL_ERROR_AGENT_BAD_FRAME == agent_frame_read(&f, sv[1], &frame));
+
+    close(sv[1]);
+    dispose((disposable_t*)&frame);
+    dispose((disposable_t*)&f);
+}
+
+/* blocks from a stand-in agent are appended and passed on, until one
+ * arrives out of order. */
+TEST(follow)
+{
+    file f;
+    agent_frame frame;
+    int agent[2], consumer[2];
+    char path[] = "/tmp/agent-test.seg";
+    uint64_t height = 5;
+    uint64_t subscribed = 0;
+
+    TEST_ASSERT(VCTOOL_STATUS_SUCCESS == file_init(&f));
+    TEST_ASSERT(0 == socketpair(AF_UNIX, SOCK_STREAM, 0, agent));
+    TEST_ASSERT(0 == socketpair(AF_UNIX, SOCK_STREAM, 0, consumer));
+    TEST_ASSERT(VCTOOL_STATUS_SUCCESS == agent_frame_init(&frame));
+    unlink(path);
+
+    /* the stand-in sends heights 5 through 14, then repeats 14. */
+    thread stand_in([&]()
+    {
+        agent_frame req;
+        uint8_t block[AGENT_BLOCK_HEADER_SIZE + 32];
+
+        agent_frame_init(&req);
+        if (VCTOOL_STATUS_SUCCESS == agent_frame_read(&f, agent[1], &req)
+         && AGENT_MSG_SUBSCRIBE == req.type)
+        {
+            subscribed = read_u64(req.payload);
+        }
+
+        for (uint64_t h = 5; h < 16; ++h)
+        {
+            uint64_t sent = (15 == h) ? 14 : h;
+            memset(block, (int)sent, sizeof(block));
+            write_u64(block, sent);
+            agent_frame_write(
+                &f, agent[1], AGENT_MSG_BLOCK, block, sizeof(block));
+        }
+
+        close(agent[1]);
+        dispose((disposable_t*)&req);
+    });
+
+    TEST_EXPECT(
+        VCTOOL_ERROR_AGENT_BLOCK_OUT_OF_ORDER ==
+            agent_follow(
+                &f, agent[0], path, &height, consumer[0], nullptr));
+    stand_in.join();
+
+    TEST_EXPECT(5U == subscribed);
+    TEST_EXPECT(15U == height);
+
+    /* the segment ends at the last block. */
+    uint64_t tail;
+    TEST_ASSERT(
+        VCTOOL_STATUS_SUCCESS == blockstore_segment_tail(&f, path, &tail));
+    TEST_EXPECT(14U == tail);
+
+    /* the consumer received each new block, in order. */
+    close(consumer[0]);
+    for (uint64_t h = 5; h < 15; ++h)
+    {
+        TEST_ASSERT(
+            VCTOOL_STATUS_SUCCESS ==
+                agent_frame_read(&f, consumer[1], &frame));
+        TEST_EXPECT(AGENT_MSG_BLOCK == frame.type);
+        TEST_EXPECT(h == read_u64(frame.payload));
+    }
+    TEST_EXPECT(
+        VCTOOL_ERROR_AGENT_DISCONNECTED ==
+            agent_frame_read(&f, consumer[1], &frame));
+
+    close(agent[0]);
+    close(consumer[1]);
+    unlink(path);
+    dispose((disposable_t*)&frame);
+    dispose((disposable_t*)&f);
+}
+
+/**
+ * \brief A stand-in agent which echoes each request back with its type
+ * incremented.
+ *
+ * The first connection accepted answers slowly.  If close_after is not zero,
+ * each connection is closed after that many requests.
+ */
+struct echo_agent
+{
+    const char* path = "/tmp/agent-pool-test.sock";
+    int listener = -1;
+    int close_after = 0;
+    atomic<int> accepted{0};
+    atomic<int> answered[16];
+    thread acceptor;
+    vector<thread> handlers;
+
+    echo_agent(int close_after_ = 0)
+        : close_after(close_after_)
+    {
+        struct sockaddr_un addr;
+
+        for (auto& a : answered)
+        {
+            a = 0;
+        }
+
+        memset(&addr, 0, sizeof(addr));
+        addr.sun_family = AF_UNIX;
+        strcpy(addr.sun_path, path);
+        unlink(path);
+
+        listener = socket(AF_UNIX, SOCK_STREAM, 0);
+        bind(listener, (struct sockaddr*)&addr, sizeof(addr));
+        listen(listener, 16);
+
+        acceptor = thread([this]()
+        {
+            for (;;)
+            {
+                int sock = accept(listener, nullptr, nullptr);
+                if (sock < 0)
+                {
+                    break;
+                }
+
+                int n = accepted++;
+                handlers.emplace_back([this, sock, n]() { serve(sock, n); });
+            }
+        });
+    }
+
+    void serve(int sock, int n)
+    {
+        file f;
+        agent_frame frame;
+
+        file_init(&f);
+        agent_frame_init(&frame);
+        for (int count = 1;
+             VCTOOL_STATUS_SUCCESS == agent_frame_read(&f, sock, &frame);
+             ++count)
+        {
+            if (0 == n)
+            {
+                usleep(2000);
+            }
+
+            agent_frame_write(
+                &f, sock, frame.type + 1, frame.payload, frame.size);
+            ++answered[n & 15];
+
+            if (count == close_after)
+            {
+                break;
+            }
+        }
+
+        close(sock);
+        dispose((disposable_t*)&frame);
+        dispose((disposable_t*)&f);
+    }
+
+    ~echo_agent()
+    {
+        shutdown(listener, SHUT_RDWR);
+        acceptor.join();
+        for (auto& h : handlers)
+        {
+            h.join();
+        }
+        close(listener);
+        unlink(path);
+    }
+};
+
+/**
+ * \brief Count handshakes.
+ */
+static int count_handshake(void* context, file*, int)
+{
+    ++*(atomic<int>*)context;
+
+    return VCTOOL_STATUS_SUCCESS;
+}
+
+/**
+ * \brief Check that a response echoes the request in context.
+ */
+static int check_echo(void* context, const agent_frame* response)
+{
+    const uint32_t* request = (const uint32_t*)context;
+
+    if (101 != response->type
+     || sizeof(uint32_t) != response->size
+     || memcmp(request, response->payload, sizeof(uint32_t)))
+    {
+        return -1;
+    }
+
+    return VCTOOL_STATUS_SUCCESS;
+}
+
+/* requests are spread over the pool, away from a slow connection. */
+TEST(pool_stripe)
+{
+    file f;
+    agent_pool pool;
+    atomic<int> handshakes{0};
+    atomic<int> failures{0};
+    vector<thread> clients;
+    const int CLIENTS = 8, REQUESTS = 100;
+
+    signal(SIGPIPE, SIG_IGN);
+    TEST_ASSERT(VCTOOL_STATUS_SUCCESS == file_init(&f));
+
+    {
+        echo_agent agent;
+
+        TEST_ASSERT(
+            VCTOOL_STATUS_SUCCESS ==
+                agent_pool_init(
+                    &pool, &f, agent.path, 4, &count_handshake,
+                    &handshakes));
+        TEST_EXPECT(4 == handshakes);
+
+        for (int c = 0; c < CLIENTS; ++c)
+        {
+            clients.emplace_back([&, c]()
+            {
+                for (int i = 0; i < REQUESTS; ++i)
+                {
+                    uint32_t request = (uint32_t)(c * REQUESTS + i);
+                    if (VCTOOL_STATUS_SUCCESS !=
+                            agent_pool_request(
+                                &pool, 100, &request, sizeof(request),
+                                &check_echo, &request))
+                    {
+                        ++failures;
+                    }
+                }
+            });
+        }
+
+        for (auto& c : clients)
+        {
+            c.join();
+        }
+
+        TEST_EXPECT(0 == failures);
+
+        /* every request was answered once, mostly by fast connections. */
+        int total = 0;
+        for (int n = 0; n < agent.accepted; ++n)
+        {
+            total += agent.answered[n];
+        }
+        TEST_EXPECT(CLIENTS * REQUESTS == total);
+        TEST_EXPECT(agent.answered[0] < CLIENTS * REQUESTS / 4);
+
+        uint64_t completed = 0, reconnects = 0;
+        for (size_t i = 0; i < pool.count; ++i)
+        {
+            completed += pool.connections[i].requests;
+            reconnects += pool.connections[i].reconnects;
+        }
+        TEST_EXPECT(CLIENTS * REQUESTS == completed);
+        TEST_EXPECT(4 + reconnects == (uint64_t)handshakes);
+
+        dispose((disposable_t*)&pool);
+    }
+
+    dispose((disposable_t*)&f);
+}
+
+/* a dropped connection fails its request and is reopened by the next. */
+TEST(pool_reconnect)
+{
+    file f;
+    agent_pool pool;
+    atomic<int> handshakes{0};
+    uint32_t request = 7;
+
+    signal(SIGPIPE, SIG_IGN);
+    TEST_ASSERT(VCTOOL_STATUS_SUCCESS == file_init(&f));
+
+    {
+        /* each connection is closed after one request. */
+        echo_agent agent(1);
+
+        TEST_ASSERT(
+            VCTOOL_STATUS_SUCCESS ==
+                agent_pool_init(
+                    &pool, &f, agent.path, 1, &count_handshake,
+                    &handshakes));
+
+        TEST_EXPECT(
+            VCTOOL_STATUS_SUCCESS ==
+                agent_pool_request(
+                    &pool, 100, &request, sizeof(request), &check_echo,
+                    &request));
+        TEST_EXPECT(
+            VCTOOL_STATUS_SUCCESS !=
+                agent_pool_request(
+                    &pool, 100, &request, sizeof(request), &check_echo,
+                    &request));
+        TEST_EXPECT(
+            VCTOOL_STATUS_SUCCESS ==
+                agent_pool_request(
+                    &pool, 100, &request, sizeof(request), &check_echo,
+                    &request));
+
+        TEST_EXPECT(2 == handshakes);
+        TEST_EXPECT(1U == pool.connections[0].reconnects);
+        TEST_EXPECT(2U == pool.connections[0].requests);
+
+        dispose((disposable_t*)&pool);
+    }
+
+    dispose((disposable_t*)&f);
+}
+
+/**
+ * \brief Test fixture for session resumption.
+ *
+ * The key agreement stands in for the asymmetric handshake: it doesn't touch
+ * the connection, and issues a new ticket each time it runs.  The stand-in
+ * agent honors the last ticket issued.
+ */
+struct session_fixture
+{
+    allocator_options_t alloc_opts;
+    vccrypt_suite_options_t suite;
+    file f;
+    agent_session_cache cache;
+    agent_session_resumer resumer;
+    atomic<int> issued{0};
+    int agree_delay_ms = 0;
+    bool bad_proof = false;
+    const char* ADDRESS = "/tmp/agent-session-test.sock";
+
+    session_fixture()
+    {
+        vccrypt_suite_register_velo_v1();
+        malloc_allocator_options_init(&alloc_opts);
+        vccrypt_suite_options_init(&suite, &alloc_opts, VCCRYPT_SUITE_VELO_V1);
+        file_init(&f);
+        agent_session_cache_init(&cache, &f, &suite, nullptr);
+
+        memset(&resumer, 0, sizeof(resumer));
+        resumer.cache = &cache;
+        resumer.address = ADDRESS;
+        resumer.suite = &suite;
+        resumer.key_agreement = &agree;
+        resumer.key_agreement_context = this;
+    }
+
+    ~session_fixture()
+    {
+        dispose((disposable_t*)&cache);
+        dispose((disposable_t*)&f);
+        dispose((disposable_t*)&suite);
+        dispose((disposable_t*)&alloc_opts);
+    }
+
+    /**
+     * \brief Make the session issued with a ticket.
+     */
+    static void make_session(agent_session* session, int ticket)
+    {
+        memset(session, 0, sizeof(agent_session));
+        session->expires = (uint64_t)time(nullptr) + 60;
+        session->key_size = 32;
+        memset(session->key, 0x40 + ticket, session->key_size);
+        memset(session->client_nonce, 0x10 + ticket, AGENT_SESSION_NONCE_SIZE);
+        memset(session->agent_nonce, 0x20 + ticket, AGENT_SESSION_NONCE_SIZE);
+        session->ticket_size = sizeof(ticket);
+        memcpy(session->ticket, &ticket, sizeof(ticket));
+    }
+
+    /**
+     * \brief Stand-in key agreement.
+     */
+    static int agree(void* context, file*, int, agent_session* session)
+    {
+        session_fixture* fixture = (session_fixture*)context;
+
+        this_thread::sleep_for(chrono::milliseconds(fixture->agree_delay_ms));
+        make_session(session, ++fixture->issued);
+
+        return VCTOOL_STATUS_SUCCESS;
+    }
+
+    /**
+     * \brief Answer resumption requests until the client hangs up.
+     */
+    void serve(int sock)
+    {
+        agent_frame frame;
+        vccrypt_buffer_t key, proof;
+        vccrypt_mac_context_t mac;
+        uint8_t resumed[AGENT_SESSION_NONCE_SIZE + 64];
+        agent_session session;
+        int ticket;
+
+        agent_frame_init(&frame);
+        while (VCTOOL_STATUS_SUCCESS == agent_frame_read(&f, sock, &frame))
+        {
+            memcpy(
+                &ticket, frame.payload + AGENT_SESSION_NONCE_SIZE,
+                sizeof(ticket));
+            if (AGENT_MSG_RESUME != frame.type || ticket != issued)
+            {
+                agent_frame_write(
+                    &f, sock, AGENT_MSG_RESUME_REJECTED, nullptr, 0);
+                continue;
+            }
+
+            make_session(&session, ticket);
+            memset(resumed, 0x5a, AGENT_SESSION_NONCE_SIZE);
+
+            vccrypt_buffer_init(&key, &alloc_opts, session.key_size);
+            memcpy(key.data, session.key, session.key_size);
+            vccrypt_suite_buffer_init_for_mac_authentication_code(
+                &suite, &proof, false);
+            vccrypt_suite_mac_init(&suite, &mac, &key);
+            vccrypt_mac_digest(&mac, frame.payload, AGENT_SESSION_NONCE_SIZE);
+            vccrypt_mac_digest(&mac, resumed, AGENT_SESSION_NONCE_SIZE);
+            vccrypt_mac_finalize(&mac, &proof);
+            memcpy(resumed + AGENT_SESSION_NONCE_SIZE, proof.data, proof.size);
+            if (bad_proof)
+            {
+                resumed[AGENT_SESSION_NONCE_SIZE] ^= 1;
+            }
+
+            agent_frame_write(
+                &f, sock, AGENT_MSG_RESUMED, resumed,
+                AGENT_SESSION_NONCE_SIZE + proof.size);
+
+            dispose((disposable_t*)&mac);
+            dispose((disposable_t*)&proof);
+            dispose((disposable_t*)&key);
+        }
+
+        dispose((disposable_t*)&frame);
+    }
+
+    /**
+     * \brief Run the handshake against the stand-in agent.
+     */
+    int handshake()
+    {
+        int sv[2];
+
+        socketpair(AF_UNIX, SOCK_STREAM, 0, sv);
+        thread agent([this, &sv]() { serve(sv[1]); });
+
+        int retval = agent_session_handshake(&resumer, &f, sv[0]);
+
+        close(sv[0]);
+        agent.join();
+        close(sv[1]);
+
+        return retval;
+    }
+};
+
+/* the first handshake runs the key agreement, and later ones resume. */
+TEST(session_resume)
+{
+    session_fixture fixture;
+    agent_session session;
+
+    TEST_ASSERT(VCTOOL_STATUS_SUCCESS == fixture.handshake());
+    TEST_EXPECT(1U == fixture.resumer.full_handshakes);
+    TEST_EXPECT(0U == fixture.resumer.resumptions);
+    TEST_EXPECT(
+        agent_session_cache_find(&fixture.cache, fixture.ADDRESS, &session));
+
+    TEST_ASSERT(VCTOOL_STATUS_SUCCESS == fixture.handshake());
+    TEST_ASSERT(VCTOOL_STATUS_SUCCESS == fixture.handshake());
+    TEST_EXPECT(1U == fixture.resumer.full_handshakes);
+    TEST_EXPECT(2U == fixture.resumer.resumptions);
+}
+
+/* a rejected ticket falls back to the key agreement on the same connection. */
+TEST(session_rejected)
+{
+    session_fixture fixture;
+    agent_session session;
+
+    /* the agent only honors the ticket it issues next. */
+    session_fixture::make_session(&session, 99);
+    TEST_ASSERT(
+        VCTOOL_STATUS_SUCCESS ==
+            agent_session_cache_store(
+                &fixture.cache, fixture.ADDRESS, &session));
+
+    TEST_ASSERT(VCTOOL_STATUS_SUCCESS == fixture.handshake());
+    TEST_EXPECT(1U == fixture.resumer.full_handshakes);
+    TEST_EXPECT(0U == fixture.resumer.resumptions);
+
+    /* the new session replaced the rejected one. */
+    TEST_ASSERT(
+        agent_session_cache_find(&fixture.cache, fixture.ADDRESS, &session));
+    TEST_EXPECT(1 == *(int*)session.ticket);
+}
+
+/* an expired session is not resumed. */
+TEST(session_expired)
+{
+    session_fixture fixture;
+    agent_session session;
+
+    session_fixture::make_session(&session, 1);
+    session.expires = (uint64_t)time(nullptr) - 1;
+    fixture.issued = 1;
+    TEST_ASSERT(
+        VCTOOL_STATUS_SUCCESS ==
+            agent_session_cache_store(
+                &fixture.cache, fixture.ADDRESS, &session));
+    TEST_EXPECT(
+        !agent_session_cache_find(&fixture.cache, fixture.ADDRESS, &session));
+
+    TEST_ASSERT(VCTOOL_STATUS_SUCCESS == fixture.handshake());
+    TEST_EXPECT(1U == fixture.resumer.full_handshakes);
+    TEST_EXPECT(0U == fixture.resumer.resumptions);
+}
+
+/* an agent which can't prove it holds the key fails, and is forgotten. */
+TEST(session_bad_proof)
+{
+    session_fixture fixture;
+    agent_session session;
+
+    TEST_ASSERT(VCTOOL_STATUS_SUCCESS == fixture.handshake());
+
+    fixture.bad_proof = true;
+    TEST_EXPECT(VCTOOL_ERROR_AGENT_RESUME_FAILED == fixture.handshake());
+    TEST_EXPECT(
+        !agent_session_cache_find(&fixture.cache, fixture.ADDRESS, &session));
+    TEST_EXPECT(0U == fixture.resumer.resumptions);
+}
+
+/* concurrent handshakes with the same agent share one key agreement. */
+TEST(session_coalesced)
+{
+    const int CONNECTIONS = 8;
+    session_fixture fixture;
+    singleflight flights;
+    vector<thread> connections;
+    atomic<int> failures{0};
+
+    TEST_ASSERT(
+        VCTOOL_STATUS_SUCCESS ==
+            singleflight_init(&flights, sizeof(agent_session)));
+    fixture.resumer.flights = &flights;
+    fixture.agree_delay_ms = 100;
+
+    for (int i = 0; i < CONNECTIONS; ++i)
+    {
+        connections.emplace_back([&]() {
+            if (VCTOOL_STATUS_SUCCESS != fixture.handshake())
+            {
+                ++failures;
+            }
+        });
+    }
+
+    for (auto& connection : connections)
+    {
+        connection.join();
+    }
+
+    TEST_EXPECT(0 == failures);
+    TEST_EXPECT(1U == fixture.resumer.full_handshakes);
+    TEST_EXPECT(
+        (uint64_t)CONNECTIONS - 1 == fixture.resumer.resumptions);
+    TEST_EXPECT(1 == fixture.issued);
+
+    dispose((disposable_t*)&flights);
+}
+
+/* saved sessions are sealed: the file holds no session key in the clear,
+ * and a cache on the same path loads them back, keys included. */
+TEST(session_save)
+{
+    session_fixture fixture;
+    agent_session_cache saving, loaded;
+    agent_session session, found;
+    struct stat st;
+    const char* path = "/tmp/agent-session-test.cache";
+    const char* key_path = "/tmp/agent-session-test.cache.key";
+    vector<uint8_t> saved;
+
+    unlink(path);
+    unlink(key_path);
+
+    /* a cache without a path has nowhere to save to. */
+    TEST_EXPECT(
+        VCTOOL_ERROR_AGENT_NO_SEAL_KEY
+            == agent_session_cache_save(&fixture.cache));
+
+    TEST_ASSERT(
+        VCTOOL_STATUS_SUCCESS ==
+            agent_session_cache_init(
+                &saving, &fixture.f, &fixture.suite, path));
+    TEST_ASSERT(0 == stat(key_path, &st));
+    TEST_EXPECT(0600 == (st.st_mode & 0777));
+    TEST_EXPECT(AGENT_SESSION_SEAL_KEY_SIZE == st.st_size);
+
+    uint64_t expires = (uint64_t)time(nullptr) + 3600;
+
+    session_fixture::make_session(&session, 1);
+    session.expires = expires;
+    TEST_ASSERT(
+        VCTOOL_STATUS_SUCCESS ==
+            agent_session_cache_store(&saving, "agent-a", &session));
+    session_fixture::make_session(&session, 2);
+    session.expires = (uint64_t)time(nullptr) - 1;
+    TEST_ASSERT(
+        VCTOOL_STATUS_SUCCESS ==
+            agent_session_cache_store(&saving, "agent-b", &session));
+
+    TEST_ASSERT(VCTOOL_STATUS_SUCCESS == agent_session_cache_save(&saving));
+    dispose((disposable_t*)&saving);
+    TEST_ASSERT(0 == stat(path, &st));
+    TEST_EXPECT(0600 == (st.st_mode & 0777));
+
+    /* the key of the saved session is nowhere in the file. */
+    session_fixture::make_session(&session, 1);
+    FILE* in = fopen(path, "rb");
+    TEST_ASSERT(nullptr != in);
+    saved.resize(st.st_size);
+    TEST_ASSERT(saved.size() == fread(saved.data(), 1, saved.size(), in));
+    fclose(in);
+    TEST_EXPECT(
+        saved.end()
+            == search(
+                saved.begin(), saved.end(), session.key,
+                session.key + session.key_size));
+
+    TEST_ASSERT(
+        VCTOOL_STATUS_SUCCESS ==
+            agent_session_cache_init(
+                &loaded, &fixture.f, &fixture.suite, path));
+
+    TEST_EXPECT(agent_session_cache_find(&loaded, "agent-a", &found));
+    TEST_EXPECT(expires == found.expires);
+    TEST_EXPECT(session.key_size == found.key_size);
+    TEST_EXPECT(!memcmp(session.key, found.key, session.key_size));
+    TEST_EXPECT(session.ticket_size == found.ticket_size);
+    TEST_EXPECT(!memcmp(session.ticket, found.ticket, session.ticket_size));
+    TEST_EXPECT(!agent_session_cache_find(&loaded, "agent-b", &found));
+    dispose((disposable_t*)&loaded);
+
+    /* under a new seal key, the saved sessions are gone. */
+    unlink(key_path);
+    TEST_ASSERT(
+        VCTOOL_STATUS_SUCCESS ==
+            agent_session_cache_init(
+                &loaded, &fixture.f, &fixture.suite, path));
+    TEST_EXPECT(!agent_session_cache_find(&loaded, "agent-a", &found));
+    dispose((disposable_t*)&loaded);
+
+    /* so are sessions in a file which was tampered with. */
+    TEST_ASSERT(
+        VCTOOL_STATUS_SUCCESS ==
+            agent_session_cache_init(
+                &saving, &fixture.f, &fixture.suite, path));
+    session_fixture::make_session(&session, 1);
+    TEST_ASSERT(
+        VCTOOL_STATUS_SUCCESS ==
+            agent_session_cache_store(&saving, "agent-a", &session));
+    TEST_ASSERT(VCTOOL_STATUS_SUCCESS == agent_session_cache_save(&saving));
+    dispose((disposable_t*)&saving);
+
+    FILE* out = fopen(path, "r+b");
+    TEST_ASSERT(nullptr != out);
+    fseek(out, -1, SEEK_END);
+    int last = fgetc(out);
+    fseek(out, -1, SEEK_END);
+    fputc(last ^ 1, out);
+    fclose(out);
+
+    TEST_ASSERT(
+        VCTOOL_STATUS_SUCCESS ==
+            agent_session_cache_init(
+                &loaded, &fixture.f, &fixture.suite, path));
+    TEST_EXPECT(!agent_session_cache_find(&loaded, "agent-a", &found));
+    dispose((disposable_t*)&loaded);
+
+    unlink(path);
+    unlink(key_path);
+}
+
+/* a loaded session is resumed without a key agreement. */
+TEST(session_load_resume)
+{
+    session_fixture fixture;
+    agent_session_cache saving, loaded;
+    agent_session session;
+    const char* path = "/tmp/agent-session-test.cache";
+    const char* key_path = "/tmp/agent-session-test.cache.key";
+
+    unlink(path);
+    unlink(key_path);
+
+    TEST_ASSERT(
+        VCTOOL_STATUS_SUCCESS ==
+            agent_session_cache_init(
+                &saving, &fixture.f, &fixture.suite, path));
+    fixture.resumer.cache = &saving;
+    TEST_ASSERT(VCTOOL_STATUS_SUCCESS == fixture.handshake());
+    TEST_ASSERT(VCTOOL_STATUS_SUCCESS == agent_session_cache_save(&saving));
+    fixture.resumer.cache = &fixture.cache;
+    dispose((disposable_t*)&saving);
+
+    TEST_ASSERT(
+        VCTOOL_STATUS_SUCCESS ==
+            agent_session_cache_init(
+                &loaded, &fixture.f, &fixture.suite, path));
+    TEST_ASSERT(
+        agent_session_cache_find(&loaded, fixture.ADDRESS, &session));
+    TEST_EXPECT(32U == session.key_size);
+
+    fixture.resumer.cache = &loaded;
+    TEST_ASSERT(VCTOOL_STATUS_SUCCESS == fixture.handshake());
+    TEST_ASSERT(VCTOOL_STATUS_SUCCESS == fixture.handshake());
+    TEST_EXPECT(1U == fixture.resumer.full_handshakes);
+    TEST_EXPECT(2U == fixture.resumer.resumptions);
+
+    fixture.resumer.cache = &fixture.cache;
+    dispose((disposable_t*)&loaded);
+    unlink(path);
+    unlink(key_path);
+}
+
+/**
+ * \brief Create a key agreement keypair.
+ */
+static void make_keypair(
+    vccrypt_suite_options_t* suite, vccrypt_buffer_t* priv,
+    vccrypt_buffer_t* pub)
+{
+    vccrypt_key_agreement_context_t agreement;
+
+    vccrypt_suite_cipher_key_agreement_init(suite, &agreement);
+    vccrypt_suite_buffer_init_for_cipher_key_agreement_private_key(
+        suite, priv);
+    vccrypt_suite_buffer_init_for_cipher_key_agreement_public_key(suite, pub);
+    vccrypt_key_agreement_keypair_create(&agreement, priv, pub);
+    dispose((disposable_t*)&agreement);
+}
+
+/* the key agreement derives the key the agent derives. */
+TEST(key_agree)
+{
+    allocator_options_t alloc_opts;
+    vccrypt_suite_options_t suite;
+    vccrypt_buffer_t client_priv, client_pub, agent_priv, agent_pub;
+    agent_key_agreement client_keys, agent_keys;
+    agent_session session, agent_side;
+    file f;
+    int sv[2];
+
+    vccrypt_suite_register_velo_v1();
+    malloc_allocator_options_init(&alloc_opts);
+    vccrypt_suite_options_init(&suite, &alloc_opts, VCCRYPT_SUITE_VELO_V1);
+    file_init(&f);
+    make_keypair(&suite, &client_priv, &client_pub);
+    make_keypair(&suite, &agent_priv, &agent_pub);
+
+    client_keys.suite = &suite;
+    memset(client_keys.client_id, 0xC1, AGENT_ENTITY_ID_SIZE);
+    client_keys.client_private_key = &client_priv;
+    client_keys.agent_public_key = &agent_pub;
+
+    agent_keys = client_keys;
+    agent_keys.client_private_key = &agent_priv;
+    agent_keys.agent_public_key = &client_pub;
+
+    memset(&agent_side, 0, sizeof(agent_side));
+    TEST_ASSERT(0 == socketpair(AF_UNIX, SOCK_STREAM, 0, sv));
+
+    /* the stand-in agent issues a ticket for a minute. */
+    thread agent([&]()
+    {
+        agent_frame frame;
+        uint8_t agreed[AGENT_SESSION_NONCE_SIZE + 8 + 3] = { 0 };
+
+        agent_frame_init(&frame);
+        if (VCTOOL_STATUS_SUCCESS == agent_frame_read(&f, sv[1], &frame)
+         && AGENT_MSG_KEY_AGREE == frame.type
+         && AGENT_ENTITY_ID_SIZE + AGENT_SESSION_NONCE_SIZE == frame.size)
+        {
+            memcpy(
+                agent_side.client_nonce, frame.payload + AGENT_ENTITY_ID_SIZE,
+                AGENT_SESSION_NONCE_SIZE);
+            memset(agent_side.agent_nonce, 0x33, AGENT_SESSION_NONCE_SIZE);
+            agent_session_derive_key(&agent_keys, &agent_side);
+
+            memcpy(agreed, agent_side.agent_nonce, AGENT_SESSION_NONCE_SIZE);
+            write_u64(agreed + AGENT_SESSION_NONCE_SIZE, 60);
+            memcpy(agreed + AGENT_SESSION_NONCE_SIZE + 8, "tkt", 3);
+            agent_frame_write(
+                &f, sv[1], AGENT_MSG_KEY_AGREED, agreed, sizeof(agreed));
+        }
+
+        dispose((disposable_t*)&frame);
+    });
+
+    uint64_t now = (uint64_t)time(nullptr);
+    TEST_EXPECT(
+        VCTOOL_STATUS_SUCCESS
+            == agent_key_agree(&client_keys, &f, sv[0], &session));
+    agent.join();
+
+    TEST_ASSERT(0U < session.key_size);
+    TEST_EXPECT(session.key_size == agent_side.key_size);
+    TEST_EXPECT(!memcmp(session.key, agent_side.key, session.key_size));
+    TEST_EXPECT(session.expires >= now + 60);
+    TEST_EXPECT(3U == session.ticket_size);
+    TEST_EXPECT(!memcmp("tkt", session.ticket, 3));
+
+    close(sv[0]);
+    close(sv[1]);
+    dispose((disposable_t*)&client_priv);
+    dispose((disposable_t*)&client_pub);
+    dispose((disposable_t*)&agent_priv);
+    dispose((disposable_t*)&agent_pub);
+    dispose((disposable_t*)&f);
+    dispose((disposable_t*)&suite);
+    dispose((disposable_t*)&alloc_opts);
+}
+
+/**
+ * \brief Serve a replay on one end of a socket pair, from a thread.
+ */
+struct replay_server
+{
+    int sv[2];
+    int result = -1;
+    thread server;
+
+    replay_server(agent_replay* replay)
+    {
+        socketpair(AF_UNIX, SOCK_STREAM, 0, sv);
+        server = thread([this, replay]()
+        {
+            result = agent_replay_serve(replay, sv[1]);
+            close(sv[1]);
+        });
+    }
+
+    /**
+     * \brief Hang up, and return the server's status.
+     */
+    int finish()
+    {
+        shutdown(sv[0], SHUT_WR);
+        server.join();
+        close(sv[0]);
+
+        return result;
+    }
+};
+
+/* pool traffic is recorded, and replayed in answer to the same requests. */
+TEST(record_replay)
+{
+    file f;
+    agent_pool pool;
+    agent_recorder recorder;
+    agent_replay replay;
+    agent_frame frame;
+    const char* path = "/tmp/agent-record-test.rec";
+
+    signal(SIGPIPE, SIG_IGN);
+    TEST_ASSERT(VCTOOL_STATUS_SUCCESS == file_init(&f));
+    TEST_ASSERT(
+        VCTOOL_STATUS_SUCCESS == agent_recorder_init(&recorder, &f, path));
+
+    {
+        echo_agent agent;
+
+        TEST_ASSERT(
+            VCTOOL_STATUS_SUCCESS ==
+                agent_pool_init(&pool, &f, agent.path, 2, nullptr, nullptr));
+        pool.recorder = &recorder;
+
+        /* ten distinct requests, and one made twice. */
+        for (uint32_t i = 0; i < 11; ++i)
+        {
+            uint32_t request = (10 == i) ? 3 : i;
+            TEST_EXPECT(
+                VCTOOL_STATUS_SUCCESS ==
+                    agent_pool_request(
+                        &pool, 100, &request, sizeof(request), &check_echo,
+                        &request));
+        }
+
+        dispose((disposable_t*)&pool);
+    }
+
+    dispose((disposable_t*)&recorder);
+
+    TEST_ASSERT(
+        VCTOOL_STATUS_SUCCESS == agent_replay_init(&replay, &f, path, 0));
+    TEST_EXPECT(11U == replay.exchange_count);
+
+    uint32_t repeated = 3, unknown = 11;
+    const agent_replay_exchange* first =
+        agent_replay_find(&replay, 100, &repeated, sizeof(repeated));
+    TEST_ASSERT(nullptr != first);
+    TEST_EXPECT(2U == first->group_size);
+    TEST_EXPECT(1U == first->response_count);
+    TEST_EXPECT(101U == first->responses[0].type);
+
+    /* the same request is answered by each of its exchanges in turn. */
+    TEST_EXPECT(
+        first != agent_replay_find(&replay, 100, &repeated, sizeof(repeated)));
+    TEST_EXPECT(
+        first == agent_replay_find(&replay, 100, &repeated, sizeof(repeated)));
+    TEST_EXPECT(
+        nullptr == agent_replay_find(&replay, 100, &unknown, sizeof(unknown)));
+
+    /* the replay answers as the agent did. */
+    agent_frame_init(&frame);
+    {
+        replay_server server(&replay);
+
+        for (uint32_t i = 0; i < 10; ++i)
+        {
+            TEST_EXPECT(
+                VCTOOL_STATUS_SUCCESS ==
+                    agent_frame_write(&f, server.sv[0], 100, &i, sizeof(i)));
+            TEST_EXPECT(
+                VCTOOL_STATUS_SUCCESS ==
+                    agent_frame_read(&f, server.sv[0], &frame));
+            TEST_EXPECT(101U == frame.type);
+            TEST_EXPECT(sizeof(i) == frame.size);
+            TEST_EXPECT(0 == check_echo(&i, &frame));
+        }
+
+        TEST_EXPECT(VCTOOL_STATUS_SUCCESS == server.finish());
+    }
+
+    /* a request which was never recorded ends the connection. */
+    {
+        replay_server server(&replay);
+
+        TEST_EXPECT(
+            VCTOOL_STATUS_SUCCESS ==
+                agent_frame_write(
+                    &f, server.sv[0], 100, &unknown, sizeof(unknown)));
+        TEST_EXPECT(
+            VCTOOL_ERROR_AGENT_DISCONNECTED ==
+                agent_frame_read(&f, server.sv[0], &frame));
+        TEST_EXPECT(VCTOOL_ERROR_AGENT_NOT_RECORDED == server.finish());
+    }
+
+    dispose((disposable_t*)&frame);
+    dispose((disposable_t*)&replay);
+    dispose((disposable_t*)&f);
+    unlink(path);
+}
+
+/* recorded latency is replayed, scaled by the latency percentage. */
+TEST(replay_latency)
+{
+    file f;
+    agent_recorder recorder;
+    agent_frame frame;
+    const char* path = "/tmp/agent-latency-test.rec";
+    const uint8_t REQUEST[] = { 1, 2, 3 };
+
+    TEST_ASSERT(VCTOOL_STATUS_SUCCESS == file_init(&f));
+    TEST_ASSERT(
+        VCTOOL_STATUS_SUCCESS == agent_recorder_init(&recorder, &f, path));
+
+    /* a response which took 40 milliseconds. */
+    uint64_t exchange = agent_recorder_exchange(&recorder);
+    TEST_ASSERT(
+        VCTOOL_STATUS_SUCCESS ==
+            agent_recorder_write(
+                &recorder, exchange, AGENT_RECORD_REQUEST, 7, REQUEST,
+                sizeof(REQUEST)));
+    usleep(40000);
+    TEST_ASSERT(
+        VCTOOL_STATUS_SUCCESS ==
+            agent_recorder_write(
+                &recorder, exchange, AGENT_RECORD_RESPONSE, 8, nullptr, 0));
+    dispose((disposable_t*)&recorder);
+
+    agent_frame_init(&frame);
+    for (unsigned percent : { 100U, 50U })
+    {
+        agent_replay replay;
+        struct timespec start, end;
+
+        TEST_ASSERT(
+            VCTOOL_STATUS_SUCCESS ==
+                agent_replay_init(&replay, &f, path, percent));
+
+        {
+            replay_server server(&replay);
+
+            clock_gettime(CLOCK_MONOTONIC, &start);
+            TEST_EXPECT(
+                VCTOOL_STATUS_SUCCESS ==
+                    agent_frame_write(
+                        &f, server.sv[0], 7, REQUEST, sizeof(REQUEST)));
+            TEST_EXPECT(
+                VCTOOL_STATUS_SUCCESS ==
+                    agent_frame_read(&f, server.sv[0], &frame));
+            clock_gettime(CLOCK_MONOTONIC, &end);
+
+            TEST_EXPECT(8U == frame.type);
+            TEST_EXPECT(VCTOOL_STATUS_SUCCESS == server.finish());
+        }
+
+        long elapsed_ms =
+            (end.tv_sec - start.tv_sec) * 1000
+          + (end.tv_nsec - start.tv_nsec) / 1000000;
+        TEST_EXPECT(elapsed_ms >= 40 * (long)percent / 100);
+
+        dispose((disposable_t*)&replay);
+    }
+
+    dispose((disposable_t*)&frame);
+    dispose((disposable_t*)&f);
+    unlink(path);
+}
+
+/**
+ * \brief Admit a round of requests, and release them all with an outcome.
+ */
+static void limiter_round(
+    agent_limiter* limiter, size_t count, uint64_t latency, int status)
+{
+    vector<agent_limiter_ticket> tickets(count);
+
+    for (auto& ticket : tickets)
+    {
+        agent_limiter_acquire(limiter, &ticket);
+    }
+
+    for (auto& ticket : tickets)
+    {
+        agent_limiter_release(limiter, &ticket, latency, status);
+    }
+}
+
+/* the window grows while full and fast, and shrinks once per round. */
+TEST(limiter_window)
+{
+    agent_limiter limiter;
+    agent_limiter_metrics metrics;
+
+    TEST_ASSERT(
+        VCTOOL_STATUS_SUCCESS == agent_limiter_init(&limiter, 2, 1, 8));
+
+    /* full rounds of fast requests open the window up to its maximum. */
+    for (int i = 0; i < 40; ++i)
+    {
+        agent_limiter_metrics_get(&limiter, &metrics);
+        limiter_round(
+            &limiter, metrics.window, 1000, VCTOOL_STATUS_SUCCESS);
+    }
+    agent_limiter_metrics_get(&limiter, &metrics);
+    TEST_EXPECT(8U == metrics.window);
+    TEST_EXPECT(1000U == metrics.baseline);
+
+    /* a request which doesn't fill the window doesn't grow it. */
+    limiter.window = 4 * AGENT_LIMIT_SCALE;
+    limiter_round(&limiter, 1, 1000, VCTOOL_STATUS_SUCCESS);
+    TEST_EXPECT(4U * AGENT_LIMIT_SCALE == limiter.window);
+
+    /* a round of busy answers halves the window once. */
+    limiter_round(&limiter, 4, 1000, VCTOOL_ERROR_AGENT_BUSY);
+    TEST_EXPECT(2U * AGENT_LIMIT_SCALE == limiter.window);
+
+    /* slow answers shrink it by an eighth, once per round. */
+    limiter_round(&limiter, 2, 5000, VCTOOL_STATUS_SUCCESS);
+    TEST_EXPECT(7U * AGENT_LIMIT_SCALE / 4 == limiter.window);
+
+    /* other failures leave it be, and it never closes. */
+    limiter_round(&limiter, 1, 1000, VCTOOL_ERROR_AGENT_DISCONNECTED);
+    TEST_EXPECT(7U * AGENT_LIMIT_SCALE / 4 == limiter.window);
+    for (int i = 0; i < 8; ++i)
+    {
+        limiter_round(&limiter, 1, 1000, VCTOOL_ERROR_AGENT_BUSY);
+    }
+    TEST_EXPECT(1U * AGENT_LIMIT_SCALE == limiter.window);
+
+    agent_limiter_metrics_get(&limiter, &metrics);
+    TEST_EXPECT(12U == metrics.busy);
+    TEST_EXPECT(1U == metrics.failed);
+    TEST_EXPECT(0U == metrics.in_flight);
+
+    dispose((disposable_t*)&limiter);
+}
+
+/**
+ * \brief A stand-in agent which accepts submissions, but answers busy to any
+ * beyond the number it can work on at once.
+ */
+struct busy_agent
+{
+    const char* path = "/tmp/agent-submit-test.sock";
+    int listener = -1;
+    int capacity;
+    atomic<int> working{0};
+    atomic<int> accepted{0};
+    atomic<int> peak{0};
+    thread acceptor;
+    vector<thread> handlers;
+
+    busy_agent(int capacity_)
+        : capacity(capacity_)
+    {
+        struct sockaddr_un addr;
+
+        memset(&addr, 0, sizeof(addr));
+        addr.sun_family = AF_UNIX;
+        strcpy(addr.sun_path, path);
+        unlink(path);
+
+        listener = socket(AF_UNIX, SOCK_STREAM, 0);
+        bind(listener, (struct sockaddr*)&addr, sizeof(addr));
+        listen(listener, 64);
+
+        acceptor = thread([this]()
+        {
+            for (;;)
+            {
+                int sock = accept(listener, nullptr, nullptr);
+                if (sock < 0)
+                {
+                    break;
+                }
+
+                handlers.emplace_back([this, sock]() { serve(sock); });
+            }
+        });
+    }
+
+    void serve(int sock)
+    {
+        file f;
+        agent_frame frame;
+
+        file_init(&f);
+        agent_frame_init(&frame);
+        while (VCTOOL_STATUS_SUCCESS == agent_frame_read(&f, sock, &frame))
+        {
+            int now = ++working;
+            if (now > capacity)
+            {
+                --working;
+                agent_frame_write(
+                    &f, sock, AGENT_MSG_SUBMIT_BUSY, nullptr, 0);
+                continue;
+            }
+
+            int seen = peak;
+            while (now > seen && !peak.compare_exchange_weak(seen, now))
+            {
+            }
+
+            usleep(1000);
+            ++accepted;
+            --working;
+            agent_frame_write(
+                &f, sock, AGENT_MSG_SUBMIT_ACCEPTED, nullptr, 0);
+        }
+
+        close(sock);
+        dispose((disposable_t*)&frame);
+        dispose((disposable_t*)&f);
+    }
+
+    ~busy_agent()
+    {
+        shutdown(listener, SHUT_RDWR);
+        acceptor.join();
+        for (auto& h : handlers)
+        {
+            h.join();
+        }
+        close(listener);
+        unlink(path);
+    }
+};
+
+/* the submission window settles near what the agent can take. */
+TEST(submit_adaptive)
+{
+    file f;
+    agent_pool pool;
+    agent_limiter limiter;
+    agent_limiter_metrics metrics;
+    atomic<int> failures{0};
+    vector<thread> clients;
+    const int CLIENTS = 16, SUBMISSIONS = 25, CAPACITY = 4;
+
+    signal(SIGPIPE, SIG_IGN);
+    TEST_ASSERT(VCTOOL_STATUS_SUCCESS == file_init(&f));
+    TEST_ASSERT(
+        VCTOOL_STATUS_SUCCESS ==
+            agent_limiter_init(&limiter, 1, 1, CLIENTS));
+
+    {
+        busy_agent agent(CAPACITY);
+
+        TEST_ASSERT(
+            VCTOOL_STATUS_SUCCESS ==
+                agent_pool_init(
+                    &pool, &f, agent.path, CLIENTS, nullptr, nullptr));
+
+        for (int c = 0; c < CLIENTS; ++c)
+        {
+            clients.emplace_back([&, c]()
+            {
+                for (int i = 0; i < SUBMISSIONS; ++i)
+                {
+                    uint32_t txn = (uint32_t)(c * SUBMISSIONS + i);
+                    int retval;
+                    int attempts = 0;
+
+                    do
+                    {
+                        retval =
+                            agent_submit(&pool, &limiter, &txn, sizeof(txn));
+                    } while (VCTOOL_ERROR_AGENT_BUSY == retval
+                          && ++attempts < 1000);
+
+                    if (VCTOOL_STATUS_SUCCESS != retval)
+                    {
+                        ++failures;
+                    }
+                }
+            });
+        }
+
+        for (auto& c : clients)
+        {
+            c.join();
+        }
+
+        TEST_EXPECT(0 == failures);
+        TEST_EXPECT(CLIENTS * SUBMISSIONS == agent.accepted);
+        TEST_EXPECT(CAPACITY == agent.peak);
+
+        dispose((disposable_t*)&pool);
+    }
+
+    /* the window found the agent's limit, and stayed well below the
+     * number of clients. */
+    agent_limiter_metrics_get(&limiter, &metrics);
+    TEST_EXPECT((uint64_t)(CLIENTS * SUBMISSIONS) == metrics.completed);
+    TEST_EXPECT(metrics.busy > 0U);
+    TEST_EXPECT(metrics.window < (size_t)CLIENTS);
+    TEST_EXPECT(metrics.queue_time_max > 0U);
+
+    dispose((disposable_t*)&limiter);
+    dispose((disposable_t*)&f);
+}
+
+/**
+ * \brief Check that status results arrive in order, with the stand-in's
+ * state for each transaction.
+ */
+struct status_check
+{
+    const uint8_t* ids;
+    size_t next;
+    size_t mismatches;
+};
+
+static int check_status(
+    void* context, const uint8_t* txn_ids, const uint32_t* states,
+    size_t count)
+{
+    status_check* check = (status_check*)context;
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        const uint8_t* id = txn_ids + i * 16;
+        if (id != check->ids + (check->next + i) * 16 || states[i] != id[0] % 3)
+        {
+            ++check->mismatches;
+        }
+    }
+
+    check->next += count;
+
+    return VCTOOL_STATUS_SUCCESS;
+}
+
+/* transaction states are queried in pipelined batches, in order. */
+TEST(txn_status)
+{
+    file f;
+    int sv[2];
+    const size_t COUNT = 1000 * 1000;
+    size_t requests = 0, pipelined = 0;
+    vector<uint8_t> ids(COUNT * 16);
+    status_check check = { ids.data(), 0, 0 };
+
+    for (size_t i = 0; i < COUNT; ++i)
+    {
+        memcpy(&ids[i * 16], &i, sizeof(i));
+    }
+
+    TEST_ASSERT(VCTOOL_STATUS_SUCCESS == file_init(&f));
+    TEST_ASSERT(0 == socketpair(AF_UNIX, SOCK_STREAM, 0, sv));
+
+    /* the stand-in answers each id with its first byte mod 3, and notes
+     * whether the next batch was already waiting. */
+    thread stand_in([&]()
+    {
+        agent_frame req;
+        vector<uint8_t> result;
+        uint8_t peek;
+
+        agent_frame_init(&req);
+        while (VCTOOL_STATUS_SUCCESS == agent_frame_read(&f, sv[1], &req)
+            && AGENT_MSG_TXN_STATUS == req.type)
+        {
+            ++requests;
+            if (recv(sv[1], &peek, 1, MSG_PEEK | MSG_DONTWAIT) > 0)
+            {
+                ++pipelined;
+            }
+
+            result.assign(req.size / 16 * 4, 0);
+            for (size_t i = 0; i < req.size / 16; ++i)
+            {
+                result[i * 4 + 3] = req.payload[i * 16] % 3;
+            }
+
+            agent_frame_write(
+                &f, sv[1], AGENT_MSG_TXN_STATUS_RESULT, result.data(),
+                result.size());
+        }
+
+        dispose((disposable_t*)&req);
+    });
+
+    TEST_EXPECT(
+        VCTOOL_STATUS_SUCCESS ==
+            agent_txn_status(
+                &f, sv[0], ids.data(), COUNT, &check_status, &check,
+                nullptr));
+    close(sv[0]);
+    stand_in.join();
+    close(sv[1]);
+
+    TEST_EXPECT(COUNT == check.next);
+    TEST_EXPECT(0U == check.mismatches);
+    TEST_EXPECT(
+        (COUNT + AGENT_TXN_STATUS_BATCH - 1) / AGENT_TXN_STATUS_BATCH
+            == requests);
+    TEST_EXPECT(pipelined > 0U);
+
+    dispose((disposable_t*)&f);
+}
@@ -0,0 +1,475 @@
+/**
+ * \file test/blockstore/test_blockstore.cpp
+ *
+ * \brief Unit tests for block store segments.
+ *
+ * \copyright 2020 Velo Payments.  See License.txt for license terms.
+ */
+
+#include <fcntl.h>
+#include <minunit/minunit.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <vctool/blockstore.h>
+#include <string>
+#include <vector>
+#include <vpr/allocator/malloc_allocator.h>
+
+using namespace std;
+
+/* start of the blockstore test suite. */
+TEST_SUITE(blockstore);
+
+#define TEST_BLOCK_SIZE 100
+
+/**
+ * \brief Append count blocks, at heights 1 through count, to a new segment.
+ */
+static bool write_segment(file* f, const char* path, int count)
+{
+    uint8_t block_id[BLOCKSTORE_BLOCK_ID_SIZE];
+    uint8_t block[TEST_BLOCK_SIZE];
+
+    unlink(path);
+    for (int i = 1; i <= count; ++i)
+    {
+        memset(block_id, i, sizeof(block_id));
+        memset(block, i * 3, sizeof(block));
+        if (VCTOOL_STATUS_SUCCESS !=
+                blockstore_segment_append(
+                    f, path, (uint64_t)i, block_id, block, sizeof(block)))
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/**
+ * \brief Overwrite one byte of a file.
+ */
+static bool poke(const char* path, off_t offset, uint8_t val)
+{
+    int fd = open(path, O_WRONLY);
+    if (fd < 0)
+    {
+        return false;
+    }
+
+    bool ok = (1 == pwrite(fd, &val, 1, offset));
+    close(fd);
+
+    return ok;
+}
+
+/**
+ * \brief Collect damaged ranges into a vector.
+ */
+static void collect(
+    void* context, const char*, const blockstore_bad_range* range)
+{
+    ((vector<blockstore_bad_range>*)context)->push_back(*range);
+}
+
+/* the offset of the record at the given height in a test segment. */
+static off_t record_offset(int height)
+{
+    return
+        BLOCKSTORE_SEGMENT_MAGIC_SIZE
+      + (height - 1) * (BLOCKSTORE_RECORD_HEADER_SIZE + TEST_BLOCK_SIZE);
+}
+
+/* an intact segment scrubs clean. */
+TEST(clean)
+{
+    file f;
+    blockstore_scrub_result result;
+    vector<blockstore_bad_range> ranges;
+    char path[] = "/tmp/blockstore-test.seg";
+
+    TEST_ASSERT(VCTOOL_STATUS_SUCCESS == file_init(&f));
+    TEST_ASSERT(write_segment(&f, path, 10));
+
+    TEST_EXPECT(
+        VCTOOL_STATUS_SUCCESS ==
+            blockstore_segment_scrub(&f, path, &result, &collect, &ranges));
+    TEST_EXPECT(10U == result.records);
+    TEST_EXPECT(0U == result.bad_ranges);
+    TEST_EXPECT(0U == result.bad_bytes);
+    TEST_EXPECT(ranges.empty());
+
+    unlink(path);
+    dispose((disposable_t*)&f);
+}
+
+/* a damaged block is reported, and the records after it still verify. */
+TEST(bad_block)
+{
+    file f;
+    blockstore_scrub_result result;
+    vector<blockstore_bad_range> ranges;
+    char path[] = "/tmp/blockstore-test.seg";
+
+    TEST_ASSERT(VCTOOL_STATUS_SUCCESS == file_init(&f));
+    TEST_ASSERT(write_segment(&f, path, 10));
+    TEST_ASSERT(
+        poke(path, record_offset(4) + BLOCKSTORE_RECORD_HEADER_SIZE + 7, 0x55));
+
+    TEST_EXPECT(
+        VCTOOL_ERROR_BLOCKSTORE_CORRUPT ==
+            blockstore_segment_scrub(&f, path, &result, &collect, &ranges));
+    TEST_EXPECT(9U == result.records);
+    TEST_ASSERT(1U == result.bad_ranges);
+    TEST_ASSERT(1U == ranges.size());
+    TEST_EXPECT((uint64_t)record_offset(4) == ranges[0].begin);
+    TEST_EXPECT((uint64_t)record_offset(5) == ranges[0].end);
+    TEST_EXPECT(3U == ranges[0].height_before);
+    TEST_EXPECT(5U == ranges[0].height_after);
+    TEST_EXPECT(ranges[0].end - ranges[0].begin == result.bad_bytes);
+
+    unlink(path);
+    dispose((disposable_t*)&f);
+}
+
+/* a damaged size field is skipped by searching for the next record. */
+TEST(bad_size)
+{
+    file f;
+    blockstore_scrub_result result;
+    vector<blockstore_bad_range> ranges;
+    char path[] = "/tmp/blockstore-test.seg";
+
+    TEST_ASSERT(VCTOOL_STATUS_SUCCESS == file_init(&f));
+    TEST_ASSERT(write_segment(&f, path, 10));
+    TEST_ASSERT(poke(path, record_offset(1) + 4, 0x7f));
+
+    TEST_EXPECT(
+        VCTOOL_ERROR_BLOCKSTORE_CORRUPT ==
+            blockstore_segment_scrub(&f, path, &result, &collect, &ranges));
+    TEST_EXPECT(9U == result.records);
+    TEST_ASSERT(1U == ranges.size());
+    TEST_EXPECT((uint64_t)record_offset(1) == ranges[0].begin);
+    TEST_EXPECT((uint64_t)record_offset(2) == ranges[0].end);
+    TEST_EXPECT(BLOCKSTORE_NO_HEIGHT == ranges[0].height_before);
+    TEST_EXPECT(2U == ranges[0].height_after);
+
+    unlink(path);
+    dispose((disposable_t*)&f);
+}
+
+/* a damaged final record runs to the end of the segment. */
+TEST(bad_tail)
+{
+    file f;
+    blockstore_scrub_result result;
+    vector<blockstore_bad_range> ranges;
+    char path[] = "/tmp/blockstore-test.seg";
+
+    TEST_ASSERT(VCTOOL_STATUS_SUCCESS == file_init(&f));
+    TEST_ASSERT(write_segment(&f, path, 3));
+    TEST_ASSERT(truncate(path, record_offset(4) - 1) == 0);
+
+    TEST_EXPECT(
+        VCTOOL_ERROR_BLOCKSTORE_CORRUPT ==
+            blockstore_segment_scrub(&f, path, &result, &collect, &ranges));
+    TEST_EXPECT(2U == result.records);
+    TEST_ASSERT(1U == ranges.size());
+    TEST_EXPECT((uint64_t)record_offset(3) == ranges[0].begin);
+    TEST_EXPECT((uint64_t)record_offset(4) - 1 == ranges[0].end);
+    TEST_EXPECT(2U == ranges[0].height_before);
+    TEST_EXPECT(BLOCKSTORE_NO_HEIGHT == ranges[0].height_after);
+
+    unlink(path);
+    dispose((disposable_t*)&f);
+}
+
+/* a file without the segment magic is rejected. */
+TEST(bad_segment)
+{
+    file f;
+    blockstore_scrub_result result;
+    char path[] = "/tmp/blockstore-test.seg";
+
+    TEST_ASSERT(VCTOOL_STATUS_SUCCESS == file_init(&f));
+    TEST_ASSERT(write_segment(&f, path, 1));
+    TEST_ASSERT(poke(path, 0, 'X'));
+
+    TEST_EXPECT(
+        VCTOOL_ERROR_BLOCKSTORE_BAD_SEGMENT ==
+            blockstore_segment_scrub(&f, path, &result, nullptr, nullptr));
+
+    unlink(path);
+    dispose((disposable_t*)&f);
+}
+
+/* the tail of a segment is the height of its last intact record; a torn
+ * final record is truncated. */
+TEST(tail)
+{
+    file f;
+    uint64_t height;
+    char path[] = "/tmp/blockstore-test.seg";
+
+    TEST_ASSERT(VCTOOL_STATUS_SUCCESS == file_init(&f));
+
+    /* a missing segment has no tail. */
+    unlink(path);
+    TEST_ASSERT(
+        VCTOOL_STATUS_SUCCESS == blockstore_segment_tail(&f, path, &height));
+    TEST_EXPECT(BLOCKSTORE_NO_HEIGHT == height);
+
+    TEST_ASSERT(write_segment(&f, path, 7));
+    TEST_ASSERT(
+        VCTOOL_STATUS_SUCCESS == blockstore_segment_tail(&f, path, &height));
+    TEST_EXPECT(7U == height);
+
+    /* a final record cut short by a crash is dropped. */
+    TEST_ASSERT(0 == truncate(path, record_offset(7) + 50));
+    TEST_ASSERT(
+        VCTOOL_STATUS_SUCCESS == blockstore_segment_tail(&f, path, &height));
+    TEST_EXPECT(6U == height);
+    struct stat st;
+    TEST_ASSERT(0 == stat(path, &st));
+    TEST_EXPECT(record_offset(7) == st.st_size);
+
+    /* so is a final record with a partial header. */
+    TEST_ASSERT(0 == truncate(path, record_offset(6) + 20));
+    TEST_ASSERT(
+        VCTOOL_STATUS_SUCCESS == blockstore_segment_tail(&f, path, &height));
+    TEST_EXPECT(5U == height);
+
+    /* a damaged record before the final one leaves the tail unknown. */
+    TEST_ASSERT(poke(path, record_offset(4) + 40, 0xFF));
+    TEST_EXPECT(
+        VCTOOL_ERROR_BLOCKSTORE_CORRUPT ==
+            blockstore_segment_tail(&f, path, &height));
+
+    unlink(path);
+    dispose((disposable_t*)&f);
+}
+
+/**
+ * \brief Test fixture holding a crypto suite for segment summaries.
+ */
+struct summary_fixture
+{
+    allocator_options_t alloc_opts;
+    vccrypt_suite_options_t suite;
+    file f;
+
+    summary_fixture()
+    {
+        vccrypt_suite_register_velo_v1();
+        malloc_allocator_options_init(&alloc_opts);
+        vccrypt_suite_options_init(&suite, &alloc_opts, VCCRYPT_SUITE_VELO_V1);
+        file_init(&f);
+    }
+
+    ~summary_fixture()
+    {
+        dispose((disposable_t*)&f);
+        dispose((disposable_t*)&suite);
+        dispose((disposable_t*)&alloc_opts);
+    }
+};
+
+/**
+ * \brief Build the summary of a segment, and check that it can be reloaded.
+ */
+static bool build_summary(
+    summary_fixture* fixture, blockstore_summary* summary, const char* path)
+{
+    blockstore_summary loaded;
+    bool ok = true;
+
+    if (VCTOOL_STATUS_SUCCESS !=
+            blockstore_summary_init(summary, &fixture->f, &fixture->suite, path)
+     || VCTOOL_STATUS_SUCCESS != blockstore_summary_build(summary))
+    {
+        return false;
+    }
+
+    if (VCTOOL_STATUS_SUCCESS !=
+            blockstore_summary_init(&loaded, &fixture->f, &fixture->suite, path)
+     || VCTOOL_STATUS_SUCCESS != blockstore_summary_load(&loaded))
+    {
+        return false;
+    }
+
+    if (loaded.size != summary->size
+     || memcmp(loaded.data, summary->data, summary->size))
+    {
+        ok = false;
+    }
+
+    dispose((disposable_t*)&loaded);
+
+    return ok;
+}
+
+/* identical segments have no differing records. */
+TEST(summary_identical)
+{
+    summary_fixture fixture;
+    blockstore_summary a, b;
+    blockstore_divergence divergence;
+    char path_a[] = "/tmp/blockstore-test-a.seg";
+    char path_b[] = "/tmp/blockstore-test-b.seg";
+
+    TEST_ASSERT(write_segment(&fixture.f, path_a, 300));
+    TEST_ASSERT(write_segment(&fixture.f, path_b, 300));
+    TEST_ASSERT(build_summary(&fixture, &a, path_a));
+    TEST_ASSERT(build_summary(&fixture, &b, path_b));
+    TEST_EXPECT(300U == a.record_count);
+    TEST_EXPECT(4U == a.level_count);
+
+    TEST_EXPECT(
+        VCTOOL_STATUS_SUCCESS ==
+            blockstore_summary_diff(&a, &b, &divergence));
+
+    dispose((disposable_t*)&a);
+    dispose((disposable_t*)&b);
+    unlink((string(path_a) + BLOCKSTORE_SUMMARY_SUFFIX).c_str());
+    unlink((string(path_b) + BLOCKSTORE_SUMMARY_SUFFIX).c_str());
+    unlink(path_a);
+    unlink(path_b);
+}
+
+/* a fork is found, with the range of heights after it. */
+TEST(summary_diverged)
+{
+    summary_fixture fixture;
+    blockstore_summary a, b;
+    blockstore_divergence divergence;
+    uint8_t block_id[BLOCKSTORE_BLOCK_ID_SIZE] = { 0 };
+    uint8_t block[TEST_BLOCK_SIZE] = { 0 };
+    char path_a[] = "/tmp/blockstore-test-a.seg";
+    char path_b[] = "/tmp/blockstore-test-b.seg";
+
+    /* b forks at height 37 and is one record longer. */
+    TEST_ASSERT(write_segment(&fixture.f, path_a, 300));
+    TEST_ASSERT(write_segment(&fixture.f, path_b, 36));
+    for (int i = 37; i <= 301; ++i)
+    {
+        block[0] = (uint8_t)i;
+        TEST_ASSERT(
+            VCTOOL_STATUS_SUCCESS ==
+                blockstore_segment_append(
+                    &fixture.f, path_b, (uint64_t)i, block_id, block,
+                    (37 == i) ? sizeof(block) : 0));
+    }
+
+    TEST_ASSERT(build_summary(&fixture, &a, path_a));
+    TEST_ASSERT(build_summary(&fixture, &b, path_b));
+
+    TEST_EXPECT(
+        VCTOOL_ERROR_BLOCKSTORE_DIVERGED ==
+            blockstore_summary_diff(&a, &b, &divergence));
+    TEST_EXPECT(37U == divergence.first_height);
+    TEST_EXPECT(301U == divergence.last_height);
+    TEST_EXPECT(36U == divergence.index);
+    TEST_EXPECT(264U == divergence.count_a);
+    TEST_EXPECT(265U == divergence.count_b);
+    TEST_EXPECT(!divergence.converged);
+
+    dispose((disposable_t*)&a);
+    dispose((disposable_t*)&b);
+    unlink((string(path_a) + BLOCKSTORE_SUMMARY_SUFFIX).c_str());
+    unlink((string(path_b) + BLOCKSTORE_SUMMARY_SUFFIX).c_str());
+    unlink(path_a);
+    unlink(path_b);
+}
+
+/* a block missing from one segment does not shift the later records. */
+TEST(summary_missing_block)
+{
+    summary_fixture fixture;
+    blockstore_summary a, b;
+    blockstore_divergence divergence;
+    uint8_t block_id[BLOCKSTORE_BLOCK_ID_SIZE];
+    uint8_t block[TEST_BLOCK_SIZE];
+    char path_a[] = "/tmp/blockstore-test-a.seg";
+    char path_b[] = "/tmp/blockstore-test-b.seg";
+
+    /* a lacks height 150, which b holds. */
+    unlink(path_a);
+    for (int i = 1; i <= 300; ++i)
+    {
+        if (150 == i)
+        {
+            continue;
+        }
+
+        memset(block_id, i, sizeof(block_id));
+        memset(block, i * 3, sizeof(block));
+        TEST_ASSERT(
+            VCTOOL_STATUS_SUCCESS ==
+                blockstore_segment_append(
+                    &fixture.f, path_a, (uint64_t)i, block_id, block,
+                    sizeof(block)));
+    }
+
+    TEST_ASSERT(write_segment(&fixture.f, path_b, 300));
+    TEST_ASSERT(build_summary(&fixture, &a, path_a));
+    TEST_ASSERT(build_summary(&fixture, &b, path_b));
+
+    /* the range is the one missing height, in either order. */
+    TEST_EXPECT(
+        VCTOOL_ERROR_BLOCKSTORE_DIVERGED ==
+            blockstore_summary_diff(&a, &b, &divergence));
+    TEST_EXPECT(150U == divergence.first_height);
+    TEST_EXPECT(150U == divergence.last_height);
+    TEST_EXPECT(149U == divergence.index);
+    TEST_EXPECT(0U == divergence.count_a);
+    TEST_EXPECT(1U == divergence.count_b);
+    TEST_EXPECT(divergence.converged);
+
+    TEST_EXPECT(
+        VCTOOL_ERROR_BLOCKSTORE_DIVERGED ==
+            blockstore_summary_diff(&b, &a, &divergence));
+    TEST_EXPECT(150U == divergence.first_height);
+    TEST_EXPECT(150U == divergence.last_height);
+    TEST_EXPECT(1U == divergence.count_a);
+    TEST_EXPECT(0U == divergence.count_b);
+    TEST_EXPECT(divergence.converged);
+
+    dispose((disposable_t*)&a);
+    dispose((disposable_t*)&b);
+    unlink((string(path_a) + BLOCKSTORE_SUMMARY_SUFFIX).c_str());
+    unlink((string(path_b) + BLOCKSTORE_SUMMARY_SUFFIX).c_str());
+    unlink(path_a);
+    unlink(path_b);
+}
+
+/* a summary is stale once its segment is appended to. */
+TEST(summary_stale)
+{
+    summary_fixture fixture;
+    blockstore_summary summary;
+    uint8_t block_id[BLOCKSTORE_BLOCK_ID_SIZE] = { 0 };
+    char path[] = "/tmp/blockstore-test.seg";
+
+    TEST_ASSERT(write_segment(&fixture.f, path, 5));
+    TEST_ASSERT(build_summary(&fixture, &summary, path));
+    dispose((disposable_t*)&summary);
+
+    TEST_ASSERT(
+        VCTOOL_STATUS_SUCCESS ==
+            blockstore_segment_append(
+                &fixture.f, path, 6, block_id, nullptr, 0));
+
+    TEST_ASSERT(
+        VCTOOL_STATUS_SUCCESS ==
+            blockstore_summary_init(
+                &summary, &fixture.f, &fixture.suite, path));
+    TEST_EXPECT(
+        VCTOOL_ERROR_BLOCKSTORE_STALE_SUMMARY ==
+            blockstore_summary_load(&summary));
+    dispose((disposable_t*)&summary);
+
+    unlink((string(path) + BLOCKSTORE_SUMMARY_SUFFIX).c_str());
+    unlink(path);
+}
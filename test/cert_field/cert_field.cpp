@@ -0,0 +1,47 @@
+/**
+ * \file test/cert_field/cert_field.cpp
+ *
+ * \brief Build certificates field by field for tests.
+ *
+ * \copyright 2020 Velo Payments.  See License.txt for license terms.
+ */
+
+#include "cert_field.h"
+
+using namespace std;
+
+/**
+ * \brief Append a field to a certificate.
+ *
+ * \param cert      The certificate.
+ * \param type      The field type.
+ * \param value     The value, or nullptr for the bytes 0, 1, 2, ...
+ * \param size      The size of the value.
+ */
+void add_field(
+    vector<uint8_t>& cert, uint16_t type, const void* value, size_t size)
+{
+    const uint8_t* bytes = (const uint8_t*)value;
+
+    cert.push_back((uint8_t)(type >> 8));
+    cert.push_back((uint8_t)type);
+    cert.push_back((uint8_t)(size >> 8));
+    cert.push_back((uint8_t)size);
+    for (size_t i = 0; i < size; ++i)
+    {
+        cert.push_back(nullptr == bytes ? (uint8_t)i : bytes[i]);
+    }
+}
+
+/**
+ * \brief Append a field to a certificate.
+ *
+ * \param cert      The certificate.
+ * \param type      The field type.
+ * \param value     The value.
+ */
+void add_field(
+    vector<uint8_t>& cert, uint16_t type, const vector<uint8_t>& value)
+{
+    add_field(cert, type, value.data(), value.size());
+}
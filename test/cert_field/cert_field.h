@@ -0,0 +1,43 @@
+/**
+ * \file test/cert_field/cert_field.h
+ *
+ * \brief Build certificates field by field for tests.
+ *
+ * \copyright 2020 Velo Payments.  See License.txt for license terms.
+ */
+
+#ifndef  VCTOOL_TEST_CERT_FIELD_HEADER_GUARD
+# define VCTOOL_TEST_CERT_FIELD_HEADER_GUARD
+
+/* Require C++. */
+#ifndef __cplusplus
+#error C++ required for this header.
+#endif
+
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+/**
+ * \brief Append a field to a certificate.
+ *
+ * \param cert      The certificate.
+ * \param type      The field type.
+ * \param value     The value, or nullptr for the bytes 0, 1, 2, ...
+ * \param size      The size of the value.
+ */
+void add_field(
+    std::vector<uint8_t>& cert, uint16_t type, const void* value, size_t size);
+
+/**
+ * \brief Append a field to a certificate.
+ *
+ * \param cert      The certificate.
+ * \param type      The field type.
+ * \param value     The value.
+ */
+void add_field(
+    std::vector<uint8_t>& cert, uint16_t type,
+    const std::vector<uint8_t>& value);
+
+#endif /*VCTOOL_TEST_CERT_FIELD_HEADER_GUARD*/
@@ -0,0 +1,228 @@
+/**
+ * \file test/certcache/test_certcache.cpp
+ *
+ * \brief Unit tests for the certificate cache.
+ *
+ * \copyright 2020 Velo Payments.  See License.txt for license terms.
+ */
+
+#include <minunit/minunit.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <unistd.h>
+#include <vctool/certcache.h>
+#include <vpr/allocator/malloc_allocator.h>
+
+#include "../temp_dir/temp_dir.h"
+
+using namespace std;
+
+/* start of the certcache test suite. */
+TEST_SUITE(certcache);
+
+/**
+ * \brief Test fixture holding a crypto suite and a scratch cache path.
+ */
+struct certcache_fixture
+{
+    allocator_options_t alloc_opts;
+    vccrypt_suite_options_t suite;
+    temp_dir dir;
+    string path;
+
+    certcache_fixture()
+        : dir("certcache")
+    {
+        vccrypt_suite_register_velo_v1();
+        malloc_allocator_options_init(&alloc_opts);
+        vccrypt_suite_options_init(&suite, &alloc_opts, VCCRYPT_SUITE_VELO_V1);
+
+        path = dir.file("cache.mdb");
+    }
+
+    ~certcache_fixture()
+    {
+        dispose((disposable_t*)&suite);
+        dispose((disposable_t*)&alloc_opts);
+    }
+};
+
+/* A cache without a path is disabled. */
+TEST(disabled_cache)
+{
+    certcache_fixture fixture;
+    TEST_ASSERT(fixture.dir.created);
+    certcache cache;
+    bool found = true;
+    const char CERT[] = "certificate";
+
+    TEST_ASSERT(
+        VCTOOL_STATUS_SUCCESS ==
+            certcache_init(&cache, &fixture.suite, nullptr));
+
+    TEST_EXPECT(
+        VCTOOL_ERROR_CERTCACHE_DISABLED ==
+            certcache_lookup(&cache, CERT, sizeof(CERT), 1, &found));
+    TEST_EXPECT(!found);
+    TEST_EXPECT(
+        VCTOOL_ERROR_CERTCACHE_DISABLED ==
+            certcache_insert(&cache, CERT, sizeof(CERT), 1));
+
+    dispose((disposable_t*)&cache);
+}
+
+/* An inserted certificate is found under the same version only. */
+TEST(insert_lookup)
+{
+    certcache_fixture fixture;
+    TEST_ASSERT(fixture.dir.created);
+    certcache cache;
+    bool found = true;
+    const char CERT[] = "certificate";
+    const char OTHER_CERT[] = "certificatf";
+
+    TEST_ASSERT(
+        VCTOOL_STATUS_SUCCESS ==
+            certcache_init(&cache, &fixture.suite, fixture.path.c_str()));
+
+    /* nothing is cached yet. */
+    TEST_ASSERT(
+        VCTOOL_STATUS_SUCCESS ==
+            certcache_lookup(&cache, CERT, sizeof(CERT), 1, &found));
+    TEST_EXPECT(!found);
+
+    /* cache the certificate. */
+    TEST_ASSERT(
+        VCTOOL_STATUS_SUCCESS ==
+            certcache_insert(&cache, CERT, sizeof(CERT), 1));
+
+    /* it is found under the same version. */
+    TEST_ASSERT(
+        VCTOOL_STATUS_SUCCESS ==
+            certcache_lookup(&cache, CERT, sizeof(CERT), 1, &found));
+    TEST_EXPECT(found);
+
+    /* it is not found under a different version. */
+    TEST_ASSERT(
+        VCTOOL_STATUS_SUCCESS ==
+            certcache_lookup(&cache, CERT, sizeof(CERT), 2, &found));
+    TEST_EXPECT(!found);
+
+    /* different bytes are not found. */
+    TEST_ASSERT(
+        VCTOOL_STATUS_SUCCESS ==
+            certcache_lookup(
+                &cache, OTHER_CERT, sizeof(OTHER_CERT), 1, &found));
+    TEST_EXPECT(!found);
+
+    dispose((disposable_t*)&cache);
+}
+
+/* Cached results persist across cache instances. */
+TEST(persistence)
+{
+    certcache_fixture fixture;
+    TEST_ASSERT(fixture.dir.created);
+    certcache cache;
+    bool found = false;
+    const char CERT[] = "certificate";
+
+    TEST_ASSERT(
+        VCTOOL_STATUS_SUCCESS ==
+            certcache_init(&cache, &fixture.suite, fixture.path.c_str()));
+    TEST_ASSERT(
+        VCTOOL_STATUS_SUCCESS ==
+            certcache_insert(&cache, CERT, sizeof(CERT), 7));
+    dispose((disposable_t*)&cache);
+
+    TEST_ASSERT(
+        VCTOOL_STATUS_SUCCESS ==
+            certcache_init(&cache, &fixture.suite, fixture.path.c_str()));
+    TEST_ASSERT(
+        VCTOOL_STATUS_SUCCESS ==
+            certcache_lookup(&cache, CERT, sizeof(CERT), 7, &found));
+    TEST_EXPECT(found);
+    dispose((disposable_t*)&cache);
+}
+
+/* A bulk load writes every collected certificate, across several batches. */
+TEST(bulk_load)
+{
+    certcache_fixture fixture;
+    TEST_ASSERT(fixture.dir.created);
+    certcache cache;
+    certcache_loader loader;
+    file f;
+    bool found = false;
+    const int COUNT = 1000;
+    const char EXISTING[] = "existing";
+
+    TEST_ASSERT(VCTOOL_STATUS_SUCCESS == file_init(&f));
+    TEST_ASSERT(
+        VCTOOL_STATUS_SUCCESS ==
+            certcache_init(&cache, &fixture.suite, fixture.path.c_str()));
+
+    /* an entry already in the cache is kept. */
+    TEST_ASSERT(
+        VCTOOL_STATUS_SUCCESS ==
+            certcache_insert(&cache, EXISTING, sizeof(EXISTING), 1));
+
+    TEST_ASSERT(
+        VCTOOL_STATUS_SUCCESS ==
+            certcache_loader_init(&loader, &cache, &f, fixture.dir.path, 7));
+
+    /* inserts are collected by the loader, including repeats. */
+    for (int i = 0; i < COUNT; ++i)
+    {
+        string cert = "certificate " + to_string(i % (COUNT / 2));
+        TEST_EXPECT(
+            VCTOOL_STATUS_SUCCESS ==
+                certcache_insert(&cache, cert.data(), cert.size(), 1));
+    }
+
+    /* collected entries are not visible until the load is finished. */
+    string first = "certificate 0";
+    TEST_ASSERT(
+        VCTOOL_STATUS_SUCCESS ==
+            certcache_lookup(&cache, first.data(), first.size(), 1, &found));
+    TEST_EXPECT(!found);
+
+    TEST_ASSERT(VCTOOL_STATUS_SUCCESS == certcache_loader_finish(&loader));
+    TEST_EXPECT(nullptr == cache.loader);
+    dispose((disposable_t*)&loader);
+
+    for (int i = 0; i < COUNT / 2; ++i)
+    {
+        string cert = "certificate " + to_string(i);
+        found = false;
+        TEST_EXPECT(
+            VCTOOL_STATUS_SUCCESS ==
+                certcache_lookup(&cache, cert.data(), cert.size(), 1, &found));
+        TEST_EXPECT(found);
+    }
+
+    TEST_ASSERT(
+        VCTOOL_STATUS_SUCCESS ==
+            certcache_lookup(&cache, EXISTING, sizeof(EXISTING), 1, &found));
+    TEST_EXPECT(found);
+
+    dispose((disposable_t*)&cache);
+    dispose((disposable_t*)&f);
+}
+
+/* Mixing data into a version changes it deterministically. */
+TEST(version_mix)
+{
+    uint64_t a = CERTCACHE_RESOLVER_VERSION_BASE;
+    uint64_t b = CERTCACHE_RESOLVER_VERSION_BASE;
+    uint64_t c = CERTCACHE_RESOLVER_VERSION_BASE;
+
+    certcache_version_mix(&a, "plugin.so", 9);
+    certcache_version_mix(&b, "plugin.so", 9);
+    certcache_version_mix(&c, "plugin2.so", 10);
+
+    TEST_EXPECT(a == b);
+    TEST_EXPECT(a != c);
+    TEST_EXPECT(a != CERTCACHE_RESOLVER_VERSION_BASE);
+}
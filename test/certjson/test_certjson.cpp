@@ -0,0 +1,253 @@
+/**
+ * \file test/certjson/test_certjson.cpp
+ *
+ * \brief Unit tests for certificate JSON conversion.
+ *
+ * \copyright 2020 Velo Payments.  See License.txt for license terms.
+ */
+
+#include <fcntl.h>
+#include <minunit/minunit.h>
+#include <string.h>
+#include <unistd.h>
+#include <vccert/fields.h>
+#include <vctool/certjson.h>
+#include <fstream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "../cert_field/cert_field.h"
+
+using namespace std;
+
+/* start of the certjson test suite. */
+TEST_SUITE(certjson);
+
+/**
+ * \brief Write certificates as JSON lines, returning the text.
+ *
+ * With by_field, each certificate is written a field at a time.
+ */
+static string write_json(
+    const vector<vector<uint8_t>>& certs, bool by_field = false)
+{
+    const char* path = "/tmp/certjson-test.json";
+    file f;
+    int fd;
+    unique_ptr<certjson_writer> w(new certjson_writer);
+
+    file_init(&f);
+    file_open(&f, &fd, path, O_WRONLY | O_CREAT | O_TRUNC, 0600);
+    certjson_writer_init(w.get(), &f, fd);
+    for (const auto& cert : certs)
+    {
+        if (!by_field)
+        {
+            certjson_write(w.get(), cert.data(), cert.size());
+            continue;
+        }
+
+        certjson_write_begin(w.get());
+        for (size_t offset = 0; offset + 4 <= cert.size(); )
+        {
+            uint16_t type = (uint16_t)((cert[offset] << 8) | cert[offset + 1]);
+            size_t size = (size_t)((cert[offset + 2] << 8) | cert[offset + 3]);
+            certjson_write_field(
+                w.get(), 0 == offset, type, cert.data() + offset + 4, size);
+            offset += 4 + size;
+        }
+
+        certjson_write_end(w.get());
+    }
+
+    certjson_writer_flush(w.get());
+    file_close(&f, fd);
+    dispose((disposable_t*)&f);
+
+    ifstream in(path);
+    stringstream text;
+    text << in.rdbuf();
+    unlink(path);
+
+    return text.str();
+}
+
+/* Every name has a slot of its own, found from its name and its type. */
+TEST(field_table)
+{
+    size_t named = 0;
+
+    for (size_t i = 0; i < CERTJSON_FIELD_SLOTS; ++i)
+    {
+        const certjson_field* field = certjson_fields + i;
+        if (nullptr == field->name)
+        {
+            continue;
+        }
+
+        ++named;
+        TEST_EXPECT(strlen(field->name) == field->length);
+        TEST_EXPECT(
+            field == certjson_field_by_name(field->name, field->length));
+        TEST_EXPECT(field == certjson_field_by_type(field->type));
+    }
+
+    TEST_EXPECT(19U == named);
+    TEST_EXPECT(nullptr == certjson_field_by_name("artifact", 8));
+    TEST_EXPECT(nullptr == certjson_field_by_type(0x0400));
+}
+
+/* A certificate written as JSON reads back as the same certificate. */
+TEST(round_trip)
+{
+    vector<uint8_t> small, large, cert(256 * 1024);
+    size_t consumed, cert_size;
+
+    add_field(
+        small, VCCERT_FIELD_TYPE_CERTIFICATE_VERSION,
+        { 0x00, 0x01, 0x00, 0x00 });
+    add_field(
+        small, VCCERT_FIELD_TYPE_CERTIFICATE_ID,
+        { 0x00, 0x11, 0x22, 0x33, 0x44, 0x55, 0x66, 0x77,
+          0x88, 0x99, 0xAA, 0xBB, 0xCC, 0xDD, 0xEE, 0xFF });
+    add_field(small, 0x0400, { 'h', 'i' });
+
+    /* a value larger than the writer buffer is written in pieces. */
+    vector<uint8_t> signature(40000);
+    for (size_t i = 0; i < signature.size(); ++i)
+    {
+        signature[i] = (uint8_t)(i * 7);
+    }
+
+    add_field(large, VCCERT_FIELD_TYPE_SIGNATURE, signature);
+    add_field(large, VCCERT_FIELD_TYPE_SIGNATURE, {});
+
+    string text = write_json({ small, large });
+    size_t newline = text.find('\n');
+    TEST_ASSERT(string::npos != newline);
+    TEST_EXPECT(
+        "{\"certificate_version\":\"00010000\","
+        "\"certificate_id\":\"00112233-4455-6677-8899-aabbccddeeff\","
+        "\"0x0400\":\"6869\"}" == text.substr(0, newline));
+
+    TEST_ASSERT(
+        VCTOOL_STATUS_SUCCESS ==
+            certjson_read(
+                text.data(), text.size(), &consumed, cert.data(),
+                cert.size(), &cert_size));
+    TEST_EXPECT(newline == consumed);
+    TEST_ASSERT(small.size() == cert_size);
+    TEST_EXPECT(0 == memcmp(small.data(), cert.data(), cert_size));
+
+    TEST_ASSERT(
+        VCTOOL_STATUS_SUCCESS ==
+            certjson_read(
+                text.data() + consumed, text.size() - consumed, &consumed,
+                cert.data(), cert.size(), &cert_size));
+    TEST_ASSERT(large.size() == cert_size);
+    TEST_EXPECT(0 == memcmp(large.data(), cert.data(), cert_size));
+}
+
+/* A certificate written a field at a time matches one written whole. */
+TEST(write_by_field)
+{
+    vector<uint8_t> small, large;
+
+    add_field(
+        small, VCCERT_FIELD_TYPE_CERTIFICATE_VERSION,
+        { 0x00, 0x01, 0x00, 0x00 });
+    add_field(
+        small, VCCERT_FIELD_TYPE_CERTIFICATE_ID,
+        { 0x00, 0x11, 0x22, 0x33, 0x44, 0x55, 0x66, 0x77,
+          0x88, 0x99, 0xAA, 0xBB, 0xCC, 0xDD, 0xEE, 0xFF });
+    add_field(small, 0x0400, { 'h', 'i' });
+    add_field(large, VCCERT_FIELD_TYPE_SIGNATURE, nullptr, 40000);
+
+    TEST_EXPECT(
+        write_json({ small, large }) == write_json({ small, large }, true));
+}
+
+/* Whitespace between tokens, upper case hex and bare uuids are accepted. */
+TEST(lenient_input)
+{
+    uint8_t cert[64];
+    size_t consumed, cert_size;
+    string text =
+        " { \"artifact_id\" :\t\"00112233445566778899AABBCCDDEEFF\" ,\n"
+        "   \"0x0001\": \"0A\" } ";
+
+    TEST_ASSERT(
+        VCTOOL_STATUS_SUCCESS ==
+            certjson_read(
+                text.data(), text.size(), &consumed, cert, sizeof(cert),
+                &cert_size));
+    TEST_EXPECT(text.size() - 1 == consumed);
+    TEST_ASSERT(2U * CERTJSON_FIELD_HEADER_SIZE + 17U == cert_size);
+    TEST_EXPECT(0x20 == cert[1] && 16 == cert[3] && 0xFF == cert[19]);
+    TEST_EXPECT(0x01 == cert[21] && 1 == cert[23] && 0x0A == cert[24]);
+
+    /* an empty object is an empty certificate. */
+    text = "{}";
+    TEST_ASSERT(
+        VCTOOL_STATUS_SUCCESS ==
+            certjson_read(
+                text.data(), text.size(), &consumed, cert, sizeof(cert),
+                &cert_size));
+    TEST_EXPECT(0U == cert_size);
+}
+
+/* Malformed text, unknown names and bad values are rejected. */
+TEST(bad_input)
+{
+    uint8_t cert[64];
+    size_t consumed, cert_size;
+    const struct
+    {
+        const char* text;
+        int expected;
+    } cases[] = {
+        { "", VCTOOL_ERROR_CERTJSON_BAD_JSON },
+        { "[]", VCTOOL_ERROR_CERTJSON_BAD_JSON },
+        { "{\"block_height\" \"00\"}", VCTOOL_ERROR_CERTJSON_BAD_JSON },
+        { "{\"block_height\":\"00\"", VCTOOL_ERROR_CERTJSON_BAD_JSON },
+        { "{\"block_height\":\"00\",}", VCTOOL_ERROR_CERTJSON_BAD_JSON },
+        { "{\"block_height\":00}", VCTOOL_ERROR_CERTJSON_BAD_JSON },
+        { "{\"block_\\u0068eight\":\"00\"}",
+          VCTOOL_ERROR_CERTJSON_BAD_JSON },
+        { "{\"block_size\":\"00\"}", VCTOOL_ERROR_CERTJSON_UNKNOWN_FIELD },
+        { "{\"0x04\":\"00\"}", VCTOOL_ERROR_CERTJSON_UNKNOWN_FIELD },
+        { "{\"block_height\":\"0\"}", VCTOOL_ERROR_CERTJSON_BAD_VALUE },
+        { "{\"block_height\":\"0g\"}", VCTOOL_ERROR_CERTJSON_BAD_VALUE },
+    };
+
+    for (const auto& c : cases)
+    {
+        TEST_EXPECT(
+            c.expected ==
+                certjson_read(
+                    c.text, strlen(c.text), &consumed, cert, sizeof(cert),
+                    &cert_size));
+    }
+
+    /* a certificate which does not fit. */
+    string text = "{\"signature\":\"" + string(2 * 61, 'a') + "\"}";
+    TEST_EXPECT(
+        VCTOOL_ERROR_CERTJSON_BUFFER_TOO_SMALL ==
+            certjson_read(
+                text.data(), text.size(), &consumed, cert, sizeof(cert),
+                &cert_size));
+
+    /* a truncated certificate is not written. */
+    file f;
+    certjson_writer w;
+    uint8_t truncated[] = { 0x00, 0x01, 0x00, 0x04, 0x00 };
+    file_init(&f);
+    certjson_writer_init(&w, &f, -1);
+    TEST_EXPECT(
+        VCTOOL_ERROR_CERTJSON_BAD_CERTIFICATE ==
+            certjson_write(&w, truncated, sizeof(truncated)));
+    TEST_EXPECT(0U == w.used);
+    dispose((disposable_t*)&f);
+}
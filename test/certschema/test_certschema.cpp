@@ -0,0 +1,197 @@
+/**
+ * \file test/certschema/test_certschema.cpp
+ *
+ * \brief Unit tests for certificate schema validation.
+ *
+ * \copyright 2020 Velo Payments.  See License.txt for license terms.
+ */
+
+#include <minunit/minunit.h>
+#include <string.h>
+#include <vccert/certificate_types.h>
+#include <vccert/fields.h>
+#include <vctool/certschema.h>
+#include <memory>
+#include <vector>
+
+#include "../cert_field/cert_field.h"
+
+using namespace std;
+
+/* start of the certschema test suite. */
+TEST_SUITE(certschema);
+
+/**
+ * \brief Build the schemas with small, distinct key sizes.
+ */
+static unique_ptr<certschema> make_schema()
+{
+    certschema_sizes sizes;
+    sizes.encryption_public_key = 32;
+    sizes.encryption_private_key = 33;
+    sizes.signing_public_key = 34;
+    sizes.signing_private_key = 64;
+    sizes.signature = 65;
+
+    unique_ptr<certschema> schema(new certschema);
+    certschema_init(schema.get(), &sizes);
+
+    return schema;
+}
+
+/**
+ * \brief Build a public entity certificate.
+ */
+static vector<uint8_t> public_entity()
+{
+    vector<uint8_t> cert;
+    add_field(cert, VCCERT_FIELD_TYPE_CERTIFICATE_VERSION, nullptr, 4);
+    add_field(
+        cert, VCCERT_FIELD_TYPE_CERTIFICATE_TYPE,
+        vccert_certificate_type_uuid_public_entity, 16);
+    add_field(cert, VCCERT_FIELD_TYPE_CERTIFICATE_CRYPTO_SUITE, nullptr, 2);
+    add_field(cert, VCCERT_FIELD_TYPE_ARTIFACT_ID, nullptr, 16);
+    add_field(cert, VCCERT_FIELD_TYPE_PUBLIC_ENCRYPTION_KEY, nullptr, 32);
+    add_field(cert, VCCERT_FIELD_TYPE_PUBLIC_SIGNING_KEY, nullptr, 34);
+
+    return cert;
+}
+
+/**
+ * \brief Validate a certificate, returning the status.
+ */
+static int validate(
+    const certschema* schema, const vector<uint8_t>& cert,
+    const certschema_type** type, uint16_t* field)
+{
+    return certschema_validate(schema, cert.data(), cert.size(), type, field);
+}
+
+/* Well-formed certificates of each known type are valid. */
+TEST(valid)
+{
+    auto schema = make_schema();
+    const certschema_type* type;
+    uint16_t field;
+
+    /* an unsigned public entity certificate. */
+    vector<uint8_t> cert = public_entity();
+    TEST_ASSERT(
+        VCTOOL_STATUS_SUCCESS
+            == validate(schema.get(), cert, &type, &field));
+    TEST_ASSERT(nullptr != type);
+    TEST_EXPECT(!strcmp("public entity", type->name));
+
+    /* the optional signer and signature. */
+    add_field(cert, VCCERT_FIELD_TYPE_SIGNER_ID, nullptr, 16);
+    add_field(cert, VCCERT_FIELD_TYPE_SIGNATURE, nullptr, 65);
+    TEST_EXPECT(
+        VCTOOL_STATUS_SUCCESS
+            == validate(schema.get(), cert, &type, &field));
+
+    /* a private entity keypair, with the fields in any order. */
+    vector<uint8_t> keypair;
+    add_field(keypair, VCCERT_FIELD_TYPE_PRIVATE_SIGNING_KEY, nullptr, 64);
+    add_field(keypair, VCCERT_FIELD_TYPE_CERTIFICATE_VERSION, nullptr, 4);
+    add_field(keypair, VCCERT_FIELD_TYPE_CERTIFICATE_CRYPTO_SUITE, nullptr, 2);
+    add_field(
+        keypair, VCCERT_FIELD_TYPE_CERTIFICATE_TYPE,
+        vccert_certificate_type_uuid_private_entity, 16);
+    add_field(keypair, VCCERT_FIELD_TYPE_ARTIFACT_ID, nullptr, 16);
+    add_field(keypair, VCCERT_FIELD_TYPE_PUBLIC_ENCRYPTION_KEY, nullptr, 32);
+    add_field(keypair, VCCERT_FIELD_TYPE_PRIVATE_ENCRYPTION_KEY, nullptr, 33);
+    add_field(keypair, VCCERT_FIELD_TYPE_PUBLIC_SIGNING_KEY, nullptr, 34);
+    TEST_ASSERT(
+        VCTOOL_STATUS_SUCCESS
+            == validate(schema.get(), keypair, &type, &field));
+    TEST_EXPECT(!strcmp("private entity", type->name));
+}
+
+/* Certificates without a known type are rejected. */
+TEST(type)
+{
+    auto schema = make_schema();
+    const certschema_type* type;
+    uint16_t field;
+
+    /* an empty certificate has no type. */
+    vector<uint8_t> cert;
+    TEST_EXPECT(
+        VCTOOL_ERROR_CERTSCHEMA_MISSING_TYPE
+            == validate(schema.get(), cert, &type, &field));
+    TEST_EXPECT(nullptr == type);
+
+    /* nor does a certificate without the field. */
+    add_field(cert, VCCERT_FIELD_TYPE_CERTIFICATE_VERSION, nullptr, 4);
+    TEST_EXPECT(
+        VCTOOL_ERROR_CERTSCHEMA_MISSING_TYPE
+            == validate(schema.get(), cert, &type, &field));
+
+    /* a type of the wrong size is no type. */
+    add_field(cert, VCCERT_FIELD_TYPE_CERTIFICATE_TYPE, nullptr, 15);
+    TEST_EXPECT(
+        VCTOOL_ERROR_CERTSCHEMA_MISSING_TYPE
+            == validate(schema.get(), cert, &type, &field));
+
+    /* a type without a schema. */
+    cert.clear();
+    add_field(cert, VCCERT_FIELD_TYPE_CERTIFICATE_TYPE, nullptr, 16);
+    TEST_EXPECT(
+        VCTOOL_ERROR_CERTSCHEMA_UNKNOWN_TYPE
+            == validate(schema.get(), cert, &type, &field));
+    TEST_EXPECT(nullptr == type);
+    TEST_EXPECT(VCCERT_FIELD_TYPE_CERTIFICATE_TYPE == field);
+}
+
+/* Each way a typed certificate can break its schema is reported. */
+TEST(invalid)
+{
+    auto schema = make_schema();
+    const certschema_type* type;
+    uint16_t field;
+
+    /* a required field is missing. */
+    vector<uint8_t> cert = public_entity();
+    cert.resize(cert.size() - 4 - 34);
+    TEST_EXPECT(
+        VCTOOL_ERROR_CERTSCHEMA_MISSING_FIELD
+            == validate(schema.get(), cert, &type, &field));
+    TEST_EXPECT(VCCERT_FIELD_TYPE_PUBLIC_SIGNING_KEY == field);
+
+    /* a field has the wrong size. */
+    add_field(cert, VCCERT_FIELD_TYPE_PUBLIC_SIGNING_KEY, nullptr, 33);
+    TEST_EXPECT(
+        VCTOOL_ERROR_CERTSCHEMA_BAD_FIELD_SIZE
+            == validate(schema.get(), cert, &type, &field));
+    TEST_EXPECT(VCCERT_FIELD_TYPE_PUBLIC_SIGNING_KEY == field);
+
+    /* a field appears twice. */
+    cert = public_entity();
+    add_field(cert, VCCERT_FIELD_TYPE_ARTIFACT_ID, nullptr, 16);
+    TEST_EXPECT(
+        VCTOOL_ERROR_CERTSCHEMA_DUPLICATE_FIELD
+            == validate(schema.get(), cert, &type, &field));
+    TEST_EXPECT(VCCERT_FIELD_TYPE_ARTIFACT_ID == field);
+
+    /* a public entity holds no private key. */
+    cert = public_entity();
+    add_field(cert, VCCERT_FIELD_TYPE_PRIVATE_SIGNING_KEY, nullptr, 64);
+    TEST_EXPECT(
+        VCTOOL_ERROR_CERTSCHEMA_UNEXPECTED_FIELD
+            == validate(schema.get(), cert, &type, &field));
+    TEST_EXPECT(VCCERT_FIELD_TYPE_PRIVATE_SIGNING_KEY == field);
+
+    /* the last field runs past the end. */
+    cert = public_entity();
+    cert.pop_back();
+    TEST_EXPECT(
+        VCTOOL_ERROR_CERTSCHEMA_BAD_CERTIFICATE
+            == validate(schema.get(), cert, &type, &field));
+
+    /* a partial header trails the last field. */
+    cert = public_entity();
+    cert.push_back(0);
+    TEST_EXPECT(
+        VCTOOL_ERROR_CERTSCHEMA_BAD_CERTIFICATE
+            == validate(schema.get(), cert, &type, &field));
+}
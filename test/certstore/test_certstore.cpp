@@ -0,0 +1,261 @@
+/**
+ * \file test/certstore/test_certstore.cpp
+ *
+ * \brief Unit tests for the content-addressed certificate store.
+ *
+ * \copyright 2020 Velo Payments.  See License.txt for license terms.
+ */
+
+#include <minunit/minunit.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <vctool/certstore.h>
+#include <vpr/allocator/malloc_allocator.h>
+
+#include "../temp_dir/temp_dir.h"
+
+using namespace std;
+
+/* start of the certstore test suite. */
+TEST_SUITE(certstore);
+
+/* shared certificates are readable by everyone. */
+static const mode_t CERT_MODE = S_IRUSR | S_IRGRP | S_IROTH;
+
+/**
+ * \brief Test fixture holding a crypto suite and a scratch store directory.
+ */
+struct certstore_fixture
+{
+    allocator_options_t alloc_opts;
+    vccrypt_suite_options_t suite;
+    file f;
+    temp_dir dir;
+
+    certstore_fixture()
+        : dir("certstore")
+    {
+        vccrypt_suite_register_velo_v1();
+        malloc_allocator_options_init(&alloc_opts);
+        vccrypt_suite_options_init(&suite, &alloc_opts, VCCRYPT_SUITE_VELO_V1);
+        file_init(&f);
+    }
+
+    ~certstore_fixture()
+    {
+        dispose((disposable_t*)&f);
+        dispose((disposable_t*)&suite);
+        dispose((disposable_t*)&alloc_opts);
+    }
+};
+
+/* a stored certificate is read back under its hash. */
+TEST(put_get)
+{
+    certstore_fixture fixture;
+    TEST_ASSERT(fixture.dir.created);
+    certstore store;
+    vccrypt_buffer_t cert;
+    const char CERT[] = "certificate";
+    uint8_t hash[64];
+    struct stat st;
+
+    TEST_ASSERT(
+        VCTOOL_STATUS_SUCCESS ==
+            certstore_init(
+                &store, &fixture.f, &fixture.suite, fixture.dir.path));
+    TEST_ASSERT(sizeof(hash) == store.hash_size);
+
+    TEST_ASSERT(
+        VCTOOL_STATUS_SUCCESS ==
+            certstore_put(&store, hash, CERT, sizeof(CERT), CERT_MODE));
+
+    /* the object is named by its hash. */
+    char* path;
+    TEST_ASSERT(
+        VCTOOL_STATUS_SUCCESS == certstore_object_path(&store, &path, hash));
+    TEST_EXPECT(0 == stat(path, &st));
+    TEST_EXPECT(sizeof(CERT) == (size_t)st.st_size);
+    TEST_EXPECT(CERT_MODE == (st.st_mode & 0777));
+    free(path);
+
+    TEST_ASSERT(
+        VCTOOL_STATUS_SUCCESS == certstore_get(&store, &cert, hash));
+    TEST_EXPECT(sizeof(CERT) == cert.size);
+    TEST_EXPECT(0 == memcmp(CERT, cert.data, sizeof(CERT)));
+    dispose((disposable_t*)&cert);
+
+    dispose((disposable_t*)&store);
+}
+
+/* storing the same certificate twice writes it once. */
+TEST(dedup)
+{
+    certstore_fixture fixture;
+    TEST_ASSERT(fixture.dir.created);
+    certstore store;
+    const char CERT[] = "certificate";
+    uint8_t hash1[64], hash2[64];
+    struct stat st1, st2;
+
+    TEST_ASSERT(
+        VCTOOL_STATUS_SUCCESS ==
+            certstore_init(
+                &store, &fixture.f, &fixture.suite, fixture.dir.path));
+
+    TEST_ASSERT(
+        VCTOOL_STATUS_SUCCESS ==
+            certstore_put(&store, hash1, CERT, sizeof(CERT), CERT_MODE));
+
+    char* path;
+    TEST_ASSERT(
+        VCTOOL_STATUS_SUCCESS == certstore_object_path(&store, &path, hash1));
+    TEST_ASSERT(0 == stat(path, &st1));
+
+    TEST_ASSERT(
+        VCTOOL_STATUS_SUCCESS ==
+            certstore_put(&store, hash2, CERT, sizeof(CERT), CERT_MODE));
+    TEST_EXPECT(0 == memcmp(hash1, hash2, sizeof(hash1)));
+
+    /* the object was not replaced. */
+    TEST_ASSERT(0 == stat(path, &st2));
+    TEST_EXPECT(st1.st_ino == st2.st_ino);
+    free(path);
+
+    dispose((disposable_t*)&store);
+}
+
+/* a private certificate is readable by its owner alone, and never writable. */
+TEST(private_mode)
+{
+    certstore_fixture fixture;
+    TEST_ASSERT(fixture.dir.created);
+    certstore store;
+    const char CERT[] = "keypair";
+    uint8_t hash[64];
+    struct stat st;
+
+    TEST_ASSERT(
+        VCTOOL_STATUS_SUCCESS ==
+            certstore_init(
+                &store, &fixture.f, &fixture.suite, fixture.dir.path));
+
+    TEST_ASSERT(
+        VCTOOL_STATUS_SUCCESS ==
+            certstore_put(
+                &store, hash, CERT, sizeof(CERT), S_IRUSR | S_IWUSR));
+
+    char* path;
+    TEST_ASSERT(
+        VCTOOL_STATUS_SUCCESS == certstore_object_path(&store, &path, hash));
+    TEST_ASSERT(0 == stat(path, &st));
+    TEST_EXPECT(S_IRUSR == (st.st_mode & 0777));
+    free(path);
+
+    dispose((disposable_t*)&store);
+}
+
+/* a missing certificate is reported as such. */
+TEST(get_missing)
+{
+    certstore_fixture fixture;
+    TEST_ASSERT(fixture.dir.created);
+    certstore store;
+    vccrypt_buffer_t cert;
+    uint8_t hash[64];
+
+    TEST_ASSERT(
+        VCTOOL_STATUS_SUCCESS ==
+            certstore_init(
+                &store, &fixture.f, &fixture.suite, fixture.dir.path));
+
+    memset(hash, 0x5a, sizeof(hash));
+    TEST_EXPECT(
+        VCTOOL_ERROR_FILE_NO_ENTRY == certstore_get(&store, &cert, hash));
+
+    dispose((disposable_t*)&store);
+}
+
+/* a reference list is replaced and read back whole. */
+TEST(refs)
+{
+    certstore_fixture fixture;
+    TEST_ASSERT(fixture.dir.created);
+    certstore store;
+    vccrypt_buffer_t hashes;
+    const char CERT1[] = "certificate one";
+    const char CERT2[] = "certificate two";
+    uint8_t list[128];
+
+    TEST_ASSERT(
+        VCTOOL_STATUS_SUCCESS ==
+            certstore_init(
+                &store, &fixture.f, &fixture.suite, fixture.dir.path));
+
+    TEST_ASSERT(
+        VCTOOL_STATUS_SUCCESS ==
+            certstore_put(&store, list, CERT1, sizeof(CERT1), CERT_MODE));
+    TEST_ASSERT(
+        VCTOOL_STATUS_SUCCESS ==
+            certstore_put(&store, list + 64, CERT2, sizeof(CERT2), CERT_MODE));
+
+    TEST_ASSERT(
+        VCTOOL_STATUS_SUCCESS ==
+            certstore_ref_write(&store, "bundle", list, 2));
+    TEST_ASSERT(
+        VCTOOL_STATUS_SUCCESS ==
+            certstore_ref_read(&store, &hashes, "bundle"));
+    TEST_EXPECT(sizeof(list) == hashes.size);
+    TEST_EXPECT(0 == memcmp(list, hashes.data, sizeof(list)));
+    dispose((disposable_t*)&hashes);
+
+    /* replacing the list drops the old entries. */
+    TEST_ASSERT(
+        VCTOOL_STATUS_SUCCESS ==
+            certstore_ref_write(&store, "bundle", list + 64, 1));
+    TEST_ASSERT(
+        VCTOOL_STATUS_SUCCESS ==
+            certstore_ref_read(&store, &hashes, "bundle"));
+    TEST_EXPECT(64U == hashes.size);
+    TEST_EXPECT(0 == memcmp(list + 64, hashes.data, 64));
+    dispose((disposable_t*)&hashes);
+
+    TEST_EXPECT(
+        VCTOOL_ERROR_FILE_NO_ENTRY ==
+            certstore_ref_read(&store, &hashes, "missing"));
+
+    dispose((disposable_t*)&store);
+}
+
+/* names which would leave the refs directory are rejected. */
+TEST(bad_names)
+{
+    certstore_fixture fixture;
+    TEST_ASSERT(fixture.dir.created);
+    certstore store;
+    vccrypt_buffer_t hashes;
+    uint8_t hash[64] = { 0 };
+
+    TEST_ASSERT(
+        VCTOOL_STATUS_SUCCESS ==
+            certstore_init(
+                &store, &fixture.f, &fixture.suite, fixture.dir.path));
+
+    TEST_EXPECT(
+        VCTOOL_ERROR_CERTSTORE_BAD_NAME ==
+            certstore_ref_write(&store, "", hash, 1));
+    TEST_EXPECT(
+        VCTOOL_ERROR_CERTSTORE_BAD_NAME ==
+            certstore_ref_write(&store, "..", hash, 1));
+    TEST_EXPECT(
+        VCTOOL_ERROR_CERTSTORE_BAD_NAME ==
+            certstore_ref_write(&store, "a/b", hash, 1));
+    TEST_EXPECT(
+        VCTOOL_ERROR_CERTSTORE_BAD_NAME ==
+            certstore_ref_read(&store, &hashes, "../objects"));
+
+    dispose((disposable_t*)&store);
+}
@@ -0,0 +1,251 @@
+/**
+ * \file test/certstream/test_certstream.cpp
+ *
+ * \brief Unit tests for incremental certificate parsing.
+ *
+ * \copyright 2020 Velo Payments.  See License.txt for license terms.
+ */
+
+#include <fcntl.h>
+#include <minunit/minunit.h>
+#include <string.h>
+#include <unistd.h>
+#include <vccert/fields.h>
+#include <vctool/certstream.h>
+#include <memory>
+#include <vector>
+
+#include "../cert_field/cert_field.h"
+
+using namespace std;
+
+/* start of the certstream test suite. */
+TEST_SUITE(certstream);
+
+/**
+ * \brief A field as received by the callback.
+ */
+struct seen_field
+{
+    unsigned depth;
+    uint16_t type;
+    vector<uint8_t> value;
+    uint64_t offset;
+
+    bool operator==(const seen_field& other) const
+    {
+        return depth == other.depth && type == other.type
+            && value == other.value && offset == other.offset;
+    }
+};
+
+/**
+ * \brief Build a value of the given size.
+ */
+static vector<uint8_t> make_value(size_t size, uint8_t seed)
+{
+    vector<uint8_t> value(size);
+    for (size_t i = 0; i < size; ++i)
+    {
+        value[i] = (uint8_t)(seed + i);
+    }
+
+    return value;
+}
+
+/**
+ * \brief Build a block holding a large field and two transactions.
+ */
+static vector<uint8_t> make_block()
+{
+    vector<uint8_t> txn1, txn2, block;
+
+    add_field(txn1, VCCERT_FIELD_TYPE_CERTIFICATE_ID, make_value(16, 1));
+    add_field(txn1, VCCERT_FIELD_TYPE_ARTIFACT_ID, make_value(16, 2));
+    add_field(txn2, VCCERT_FIELD_TYPE_CERTIFICATE_ID, make_value(16, 3));
+    add_field(txn2, 0x0400, make_value(0, 0));
+    add_field(txn2, VCCERT_FIELD_TYPE_ARTIFACT_ID, make_value(16, 4));
+
+    add_field(block, VCCERT_FIELD_TYPE_CERTIFICATE_VERSION, make_value(4, 5));
+    add_field(block, VCCERT_FIELD_TYPE_WRAPPED_TRANSACTION_TUPLE, txn1);
+    add_field(block, 0x0401, make_value(0xFFFF, 6));
+    add_field(block, VCCERT_FIELD_TYPE_WRAPPED_TRANSACTION_TUPLE, txn2);
+    add_field(block, VCCERT_FIELD_TYPE_BLOCK_HEIGHT, make_value(8, 7));
+
+    return block;
+}
+
+/**
+ * \brief Record each field.
+ */
+static int record_field(void* context, const certstream_field* field)
+{
+    vector<seen_field>* seen = (vector<seen_field>*)context;
+    seen_field s;
+
+    s.depth = field->depth;
+    s.type = field->type;
+    s.value.assign(field->value, field->value + field->size);
+    s.offset = field->offset;
+    seen->push_back(s);
+
+    return VCTOOL_STATUS_SUCCESS;
+}
+
+/**
+ * \brief Stop at the first transaction field.
+ */
+static int stop_in_transaction(void* context, const certstream_field* field)
+{
+    size_t* count = (size_t*)context;
+    ++*count;
+
+    return (1 == field->depth) ? -1 : VCTOOL_STATUS_SUCCESS;
+}
+
+/**
+ * \brief Parse a certificate fed in chunks of the given size.
+ */
+static int parse(
+    const vector<uint8_t>& cert, size_t chunk, vector<seen_field>& seen)
+{
+    unique_ptr<certstream> stream(new certstream);
+
+    certstream_init(stream.get(), &record_field, &seen);
+    for (size_t offset = 0; offset < cert.size(); offset += chunk)
+    {
+        size_t size = min(chunk, cert.size() - offset);
+        int retval = certstream_feed(stream.get(), cert.data() + offset, size);
+        if (VCTOOL_STATUS_SUCCESS != retval)
+        {
+            return retval;
+        }
+    }
+
+    return certstream_finish(stream.get());
+}
+
+/* Fields and transaction fields arrive in order, with their offsets. */
+TEST(fields)
+{
+    vector<uint8_t> block = make_block();
+    vector<seen_field> seen;
+
+    TEST_ASSERT(VCTOOL_STATUS_SUCCESS == parse(block, block.size(), seen));
+    TEST_ASSERT(10U == seen.size());
+
+    /* the first transaction follows its wrapping field. */
+    TEST_EXPECT(0U == seen[1].depth);
+    TEST_EXPECT(VCCERT_FIELD_TYPE_WRAPPED_TRANSACTION_TUPLE == seen[1].type);
+    TEST_EXPECT(1U == seen[2].depth);
+    TEST_EXPECT(VCCERT_FIELD_TYPE_CERTIFICATE_ID == seen[2].type);
+    TEST_EXPECT(1U == seen[3].depth);
+    TEST_EXPECT(VCCERT_FIELD_TYPE_ARTIFACT_ID == seen[3].type);
+
+    /* the largest field is passed whole. */
+    TEST_EXPECT(0U == seen[4].depth);
+    TEST_EXPECT(0xFFFFU == seen[4].value.size());
+
+    /* the empty field of the second transaction is passed. */
+    TEST_EXPECT(1U == seen[7].depth);
+    TEST_EXPECT(0x0400 == seen[7].type);
+    TEST_EXPECT(seen[7].value.empty());
+    TEST_EXPECT(VCCERT_FIELD_TYPE_BLOCK_HEIGHT == seen[9].type);
+
+    /* each offset locates its value in the block. */
+    for (const auto& s : seen)
+    {
+        TEST_ASSERT(s.offset + s.value.size() <= block.size());
+        TEST_EXPECT(
+            !memcmp(block.data() + s.offset, s.value.data(), s.value.size()));
+    }
+}
+
+/* The fields are the same however the certificate is split. */
+TEST(chunks)
+{
+    vector<uint8_t> block = make_block();
+    vector<seen_field> whole;
+
+    TEST_ASSERT(VCTOOL_STATUS_SUCCESS == parse(block, block.size(), whole));
+
+    for (size_t chunk : { 1, 2, 3, 5, 7, 64, 4096, 65539, 65540 })
+    {
+        vector<seen_field> seen;
+        TEST_ASSERT(VCTOOL_STATUS_SUCCESS == parse(block, chunk, seen));
+        TEST_EXPECT(whole == seen);
+    }
+}
+
+/* A certificate is read from a descriptor a chunk at a time. */
+TEST(read)
+{
+    const char* path = "/tmp/certstream-test.cert";
+    vector<uint8_t> block = make_block();
+    vector<seen_field> whole, seen;
+    unique_ptr<certstream> stream(new certstream);
+    file f;
+    int fd;
+
+    /* write a block several chunks long. */
+    vector<uint8_t> big;
+    while (big.size() < 3 * CERTSTREAM_CHUNK_SIZE)
+    {
+        big.insert(big.end(), block.begin(), block.end());
+    }
+
+    TEST_ASSERT(VCTOOL_STATUS_SUCCESS == parse(big, big.size(), whole));
+
+    TEST_ASSERT(VCTOOL_STATUS_SUCCESS == file_init(&f));
+    TEST_ASSERT(
+        VCTOOL_STATUS_SUCCESS
+            == file_open(&f, &fd, path, O_WRONLY | O_CREAT | O_TRUNC, 0600));
+    TEST_ASSERT(
+        VCTOOL_STATUS_SUCCESS
+            == file_write_all(&f, fd, big.data(), big.size()));
+    file_close(&f, fd);
+
+    TEST_ASSERT(VCTOOL_STATUS_SUCCESS == file_open(&f, &fd, path, O_RDONLY, 0));
+    certstream_init(stream.get(), &record_field, &seen);
+    TEST_EXPECT(VCTOOL_STATUS_SUCCESS == certstream_read(stream.get(), &f, fd));
+    file_close(&f, fd);
+    TEST_EXPECT(whole == seen);
+
+    unlink(path);
+    dispose((disposable_t*)&f);
+}
+
+/* Malformed certificates and callback errors stop the stream. */
+TEST(errors)
+{
+    vector<uint8_t> block = make_block();
+    vector<seen_field> seen;
+
+    /* a certificate which ends inside a field. */
+    block.pop_back();
+    TEST_EXPECT(
+        VCTOOL_ERROR_CERTSTREAM_TRUNCATED == parse(block, 100, seen));
+
+    /* and one which ends inside a header. */
+    block = make_block();
+    block.push_back(0);
+    TEST_EXPECT(
+        VCTOOL_ERROR_CERTSTREAM_TRUNCATED == parse(block, 100, seen));
+
+    /* a transaction whose last field runs past its end. */
+    vector<uint8_t> txn, bad;
+    add_field(txn, VCCERT_FIELD_TYPE_CERTIFICATE_ID, make_value(16, 1));
+    txn.pop_back();
+    add_field(bad, VCCERT_FIELD_TYPE_WRAPPED_TRANSACTION_TUPLE, txn);
+    TEST_EXPECT(
+        VCTOOL_ERROR_CERTSTREAM_BAD_TRANSACTION == parse(bad, 3, seen));
+
+    /* the status of a callback which stops the stream is returned. */
+    unique_ptr<certstream> stream(new certstream);
+    size_t count = 0;
+    block = make_block();
+    certstream_init(stream.get(), &stop_in_transaction, &count);
+    TEST_EXPECT(
+        -1 == certstream_feed(stream.get(), block.data(), block.size()));
+    TEST_EXPECT(3U == count);
+}
@@ -0,0 +1,140 @@
+/**
+ * \file test/certtemplate/test_certtemplate.cpp
+ *
+ * \brief Unit tests for certificate templates.
+ *
+ * \copyright 2020 Velo Payments.  See License.txt for license terms.
+ */
+
+#include <minunit/minunit.h>
+#include <string.h>
+#include <vccert/fields.h>
+#include <vctool/certtemplate.h>
+#include <string>
+#include <vector>
+
+#include "../cert_field/cert_field.h"
+
+using namespace std;
+
+/* start of the certtemplate test suite. */
+TEST_SUITE(certtemplate);
+
+static const char* TEMPLATE =
+    "# a test template.\n"
+    "certificate_version     uint32  0x00010000\n"
+    "certificate_type        uuid    00112233-4455-6677-8899-aabbccddeeff\n"
+    "artifact_id             uuid    $1\n"
+    "\n"
+    "0x0400                  string  $2\n"
+    "block_height            uint64  $3\n";
+
+/* A filled template matches the certificate built by hand. */
+TEST(fill)
+{
+    certtemplate tmpl;
+    size_t line = 0, cert_size = 0;
+
+    TEST_ASSERT(
+        VCTOOL_STATUS_SUCCESS ==
+            certtemplate_compile(
+                &tmpl, TEMPLATE, strlen(TEMPLATE), &line));
+    TEST_EXPECT(3U == tmpl.column_count);
+    TEST_EXPECT(1U == tmpl.variable_count);
+
+    /* the artifact id is at a fixed offset; the block height is not. */
+    TEST_EXPECT(2U * 4U + 4U + 16U + 4U == tmpl.steps[0].offset);
+    TEST_EXPECT(CERTTEMPLATE_VARIABLE == tmpl.steps[2].offset);
+
+    const char* values[] = {
+        "ffeeddccbbaa99887766554433221100", "hello", "258" };
+    size_t sizes[] = { 32, 5, 3 };
+    vector<uint8_t> cert(tmpl.max_size);
+    TEST_ASSERT(
+        VCTOOL_STATUS_SUCCESS ==
+            certtemplate_fill(
+                &tmpl, values, sizes, 3, cert.data(), cert.size(),
+                &cert_size));
+
+    vector<uint8_t> expected;
+    add_field(
+        expected, VCCERT_FIELD_TYPE_CERTIFICATE_VERSION,
+        { 0x00, 0x01, 0x00, 0x00 });
+    add_field(
+        expected, VCCERT_FIELD_TYPE_CERTIFICATE_TYPE,
+        { 0x00, 0x11, 0x22, 0x33, 0x44, 0x55, 0x66, 0x77,
+          0x88, 0x99, 0xAA, 0xBB, 0xCC, 0xDD, 0xEE, 0xFF });
+    add_field(
+        expected, VCCERT_FIELD_TYPE_ARTIFACT_ID,
+        { 0xFF, 0xEE, 0xDD, 0xCC, 0xBB, 0xAA, 0x99, 0x88,
+          0x77, 0x66, 0x55, 0x44, 0x33, 0x22, 0x11, 0x00 });
+    add_field(expected, 0x0400, { 'h', 'e', 'l', 'l', 'o' });
+    add_field(
+        expected, VCCERT_FIELD_TYPE_BLOCK_HEIGHT,
+        { 0, 0, 0, 0, 0, 0, 0x01, 0x02 });
+
+    TEST_ASSERT(expected.size() == cert_size);
+    TEST_EXPECT(0 == memcmp(expected.data(), cert.data(), cert_size));
+
+    /* a short buffer reports the size needed. */
+    TEST_EXPECT(
+        VCTOOL_ERROR_CERTTEMPLATE_BUFFER_TOO_SMALL ==
+            certtemplate_fill(
+                &tmpl, values, sizes, 3, cert.data(), expected.size() - 1,
+                &cert_size));
+    TEST_EXPECT(expected.size() == cert_size);
+
+    dispose((disposable_t*)&tmpl);
+}
+
+/* Rows with missing columns or bad values are rejected. */
+TEST(bad_row)
+{
+    certtemplate tmpl;
+    size_t line = 0, cert_size = 0;
+
+    TEST_ASSERT(
+        VCTOOL_STATUS_SUCCESS ==
+            certtemplate_compile(
+                &tmpl, TEMPLATE, strlen(TEMPLATE), &line));
+
+    vector<uint8_t> cert(tmpl.max_size);
+    const char* values[] = {
+        "ffeeddccbbaa99887766554433221100", "hello", "12x" };
+    size_t sizes[] = { 32, 5, 3 };
+
+    TEST_EXPECT(
+        VCTOOL_ERROR_CERTTEMPLATE_MISSING_COLUMN ==
+            certtemplate_fill(
+                &tmpl, values, sizes, 2, cert.data(), cert.size(),
+                &cert_size));
+    TEST_EXPECT(
+        VCTOOL_ERROR_CERTTEMPLATE_BAD_VALUE ==
+            certtemplate_fill(
+                &tmpl, values, sizes, 3, cert.data(), cert.size(),
+                &cert_size));
+
+    dispose((disposable_t*)&tmpl);
+}
+
+/* A malformed template reports the line of the error. */
+TEST(bad_template)
+{
+    certtemplate tmpl;
+    size_t line = 0;
+    string text =
+        "certificate_version uint32 1\n"
+        "\n"
+        "no_such_field uint32 2\n";
+
+    TEST_EXPECT(
+        VCTOOL_ERROR_CERTTEMPLATE_BAD_TEMPLATE ==
+            certtemplate_compile(&tmpl, text.data(), text.size(), &line));
+    TEST_EXPECT(3U == line);
+
+    text = "certificate_version uint32 0x100000000\n";
+    TEST_EXPECT(
+        VCTOOL_ERROR_CERTTEMPLATE_BAD_TEMPLATE ==
+            certtemplate_compile(&tmpl, text.data(), text.size(), &line));
+    TEST_EXPECT(1U == line);
+}
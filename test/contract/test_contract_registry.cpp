@@ -0,0 +1,233 @@
+/**
+ * \file test/contract/test_contract_registry.cpp
+ *
+ * \brief Unit tests for the contract registry.
+ *
+ * \copyright 2020 Velo Payments.  See License.txt for license terms.
+ */
+
+#include <minunit/minunit.h>
+#include <string.h>
+#include <vccert/certificate_types.h>
+#include <vccert/fields.h>
+#include <vctool/contract.h>
+#include <vector>
+
+#include "../cert_field/cert_field.h"
+
+using namespace std;
+
+/* start of the contract registry test suite. */
+TEST_SUITE(contract_registry);
+
+static const uint8_t TXN_TYPE_A[16] = {
+    0x6e, 0x42, 0x1f, 0x7d, 0x8a, 0x21, 0x4c, 0x11,
+    0x9e, 0x2b, 0x77, 0x01, 0x3a, 0x55, 0xc4, 0x10 };
+static const uint8_t TXN_TYPE_B[16] = {
+    0x12, 0x90, 0xa3, 0x3c, 0x5d, 0x6e, 0x4f, 0x00,
+    0x81, 0x92, 0xa3, 0xb4, 0xc5, 0xd6, 0xe7, 0xf8 };
+static const uint8_t ARTIFACT_TYPE_A[16] = {
+    0xc1, 0x07, 0x88, 0x24, 0x51, 0x7a, 0x4b, 0x62,
+    0x93, 0x0d, 0x1e, 0x2f, 0x40, 0x51, 0x62, 0x73 };
+static const uint8_t ARTIFACT_TYPE_B[16] = {
+    0x0f, 0x1e, 0x2d, 0x3c, 0x4b, 0x5a, 0x69, 0x78,
+    0x87, 0x96, 0xa5, 0xb4, 0xc3, 0xd2, 0xe1, 0xf0 };
+
+static bool contract_a(vccert_parser_context_t*, void*)
+{
+    return true;
+}
+
+static bool contract_b(vccert_parser_context_t*, void*)
+{
+    return false;
+}
+
+/* An empty registry finds nothing. */
+TEST(empty_registry)
+{
+    contract_registry registry;
+    const contract_registry_entry* entry = nullptr;
+
+    TEST_ASSERT(VCTOOL_STATUS_SUCCESS == contract_registry_init(&registry));
+
+    TEST_EXPECT(
+        VCTOOL_ERROR_CONTRACT_NOT_FOUND ==
+            contract_registry_find(
+                &registry, &entry, TXN_TYPE_A, ARTIFACT_TYPE_A));
+    TEST_EXPECT(nullptr == entry);
+
+    dispose((disposable_t*)&registry);
+}
+
+/* An exact match is found, and takes precedence over the wildcard. */
+TEST(exact_match)
+{
+    contract_registry registry;
+    const contract_registry_entry* entry = nullptr;
+    int context_a, context_b;
+
+    TEST_ASSERT(VCTOOL_STATUS_SUCCESS == contract_registry_init(&registry));
+
+    TEST_ASSERT(
+        VCTOOL_STATUS_SUCCESS ==
+            contract_registry_register(
+                &registry, TXN_TYPE_A, nullptr, &contract_b, &context_b));
+    TEST_ASSERT(
+        VCTOOL_STATUS_SUCCESS ==
+            contract_registry_register(
+                &registry, TXN_TYPE_A, ARTIFACT_TYPE_A, &contract_a,
+                &context_a));
+
+    TEST_ASSERT(
+        VCTOOL_STATUS_SUCCESS ==
+            contract_registry_find(
+                &registry, &entry, TXN_TYPE_A, ARTIFACT_TYPE_A));
+    TEST_EXPECT(&contract_a == entry->contract_fn);
+    TEST_EXPECT(&context_a == entry->context);
+
+    dispose((disposable_t*)&registry);
+}
+
+/* The wildcard matches any artifact type for its transaction type only. */
+TEST(wildcard_match)
+{
+    contract_registry registry;
+    const contract_registry_entry* entry = nullptr;
+
+    TEST_ASSERT(VCTOOL_STATUS_SUCCESS == contract_registry_init(&registry));
+
+    TEST_ASSERT(
+        VCTOOL_STATUS_SUCCESS ==
+            contract_registry_register(
+                &registry, TXN_TYPE_A, nullptr, &contract_b, nullptr));
+
+    TEST_ASSERT(
+        VCTOOL_STATUS_SUCCESS ==
+            contract_registry_find(
+                &registry, &entry, TXN_TYPE_A, ARTIFACT_TYPE_B));
+    TEST_EXPECT(&contract_b == entry->contract_fn);
+
+    TEST_ASSERT(
+        VCTOOL_STATUS_SUCCESS ==
+            contract_registry_find(&registry, &entry, TXN_TYPE_A, nullptr));
+    TEST_EXPECT(&contract_b == entry->contract_fn);
+
+    TEST_EXPECT(
+        VCTOOL_ERROR_CONTRACT_NOT_FOUND ==
+            contract_registry_find(
+                &registry, &entry, TXN_TYPE_B, ARTIFACT_TYPE_B));
+
+    dispose((disposable_t*)&registry);
+}
+
+/* Registering the same pair twice fails. */
+TEST(duplicate_registration)
+{
+    contract_registry registry;
+
+    TEST_ASSERT(VCTOOL_STATUS_SUCCESS == contract_registry_init(&registry));
+
+    TEST_ASSERT(
+        VCTOOL_STATUS_SUCCESS ==
+            contract_registry_register(
+                &registry, TXN_TYPE_B, ARTIFACT_TYPE_A, &contract_a, nullptr));
+    TEST_EXPECT(
+        VCTOOL_ERROR_CONTRACT_DUPLICATE ==
+            contract_registry_register(
+                &registry, TXN_TYPE_B, ARTIFACT_TYPE_A, &contract_b, nullptr));
+
+    dispose((disposable_t*)&registry);
+}
+
+/* A cached negative result is invalidated by a later registration. */
+TEST(cache_invalidated_by_register)
+{
+    contract_registry registry;
+    const contract_registry_entry* entry = nullptr;
+
+    TEST_ASSERT(VCTOOL_STATUS_SUCCESS == contract_registry_init(&registry));
+
+    TEST_EXPECT(
+        VCTOOL_ERROR_CONTRACT_NOT_FOUND ==
+            contract_registry_find(
+                &registry, &entry, TXN_TYPE_B, ARTIFACT_TYPE_B));
+
+    TEST_ASSERT(
+        VCTOOL_STATUS_SUCCESS ==
+            contract_registry_register(
+                &registry, TXN_TYPE_B, ARTIFACT_TYPE_B, &contract_a, nullptr));
+
+    TEST_ASSERT(
+        VCTOOL_STATUS_SUCCESS ==
+            contract_registry_find(
+                &registry, &entry, TXN_TYPE_B, ARTIFACT_TYPE_B));
+    TEST_EXPECT(&contract_a == entry->contract_fn);
+
+    dispose((disposable_t*)&registry);
+}
+
+/* The certificate types created by this tool have built-in contracts. */
+TEST(builtins)
+{
+    contract_registry registry;
+    const contract_registry_entry* entry = nullptr;
+    vccrypt_suite_options_t suite;
+    vccert_parser_context_t parser;
+    vector<uint8_t> cert;
+    const uint8_t version[4] = { 0x00, 0x01, 0x00, 0x00 };
+    const uint8_t crypto_suite[2] = { 0x00, 0x01 };
+    uint8_t key[64];
+
+    /* the schemas only need the key sizes of the suite. */
+    memset(&suite, 0, sizeof(suite));
+    suite.key_cipher_opts.public_key_size = 32;
+    suite.key_cipher_opts.private_key_size = 32;
+    suite.sign_opts.public_key_size = 32;
+    suite.sign_opts.private_key_size = 64;
+    suite.sign_opts.signature_size = 64;
+    memset(key, 0x5a, sizeof(key));
+
+    TEST_ASSERT(VCTOOL_STATUS_SUCCESS == contract_registry_init(&registry));
+    TEST_ASSERT(
+        VCTOOL_STATUS_SUCCESS ==
+            contract_registry_register_builtins(&registry, &suite));
+
+    /* the public entity contract holds for any artifact type. */
+    TEST_ASSERT(
+        VCTOOL_STATUS_SUCCESS ==
+            contract_registry_find(
+                &registry, &entry, vccert_certificate_type_uuid_public_entity,
+                ARTIFACT_TYPE_A));
+
+    /* a public entity certificate. */
+    add_field(cert, VCCERT_FIELD_TYPE_CERTIFICATE_VERSION, version, 4);
+    add_field(
+        cert, VCCERT_FIELD_TYPE_CERTIFICATE_TYPE,
+        vccert_certificate_type_uuid_public_entity, 16);
+    add_field(
+        cert, VCCERT_FIELD_TYPE_CERTIFICATE_CRYPTO_SUITE, crypto_suite, 2);
+    add_field(cert, VCCERT_FIELD_TYPE_PUBLIC_ENCRYPTION_KEY, key, 32);
+    add_field(cert, VCCERT_FIELD_TYPE_PUBLIC_SIGNING_KEY, key, 32);
+    add_field(cert, VCCERT_FIELD_TYPE_ARTIFACT_ID, TXN_TYPE_A, 16);
+
+    memset(&parser, 0, sizeof(parser));
+    parser.cert = cert.data();
+    parser.size = cert.size();
+    TEST_EXPECT(entry->contract_fn(&parser, entry->context));
+
+    /* a truncated certificate breaks the contract. */
+    parser.size = cert.size() - 1;
+    TEST_EXPECT(!entry->contract_fn(&parser, entry->context));
+
+    /* so does a certificate with no entity id. */
+    parser.size = cert.size() - 20;
+    TEST_EXPECT(!entry->contract_fn(&parser, entry->context));
+
+    /* a certificate of a type with no schema does not meet the contract. */
+    parser.size = cert.size();
+    memcpy(cert.data() + 12, TXN_TYPE_B, 16);
+    TEST_EXPECT(!entry->contract_fn(&parser, entry->context));
+
+    dispose((disposable_t*)&registry);
+}
@@ -0,0 +1,65 @@
+/**
+ * \file test/crc32c/test_crc32c.cpp
+ *
+ * \brief Unit tests for CRC-32C.
+ *
+ * \copyright 2020 Velo Payments.  See License.txt for license terms.
+ */
+
+#include <minunit/minunit.h>
+#include <string.h>
+#include <vctool/crc32c.h>
+
+/* start of the crc32c test suite. */
+TEST_SUITE(crc32c);
+
+/* the standard check value is computed. */
+TEST(check_value)
+{
+    const char* data = "123456789";
+
+    TEST_EXPECT(0xE3069283U == crc32c(0, data, strlen(data)));
+}
+
+/* the iSCSI test vectors from RFC 3720 are computed. */
+TEST(rfc3720_vectors)
+{
+    uint8_t buf[32];
+
+    memset(buf, 0, sizeof(buf));
+    TEST_EXPECT(0x8A9136AAU == crc32c(0, buf, sizeof(buf)));
+
+    memset(buf, 0xff, sizeof(buf));
+    TEST_EXPECT(0x62A8AB43U == crc32c(0, buf, sizeof(buf)));
+
+    for (int i = 0; i < 32; ++i)
+    {
+        buf[i] = (uint8_t)i;
+    }
+    TEST_EXPECT(0x46DD794EU == crc32c(0, buf, sizeof(buf)));
+
+    for (int i = 0; i < 32; ++i)
+    {
+        buf[i] = (uint8_t)(31 - i);
+    }
+    TEST_EXPECT(0x113FDB5CU == crc32c(0, buf, sizeof(buf)));
+}
+
+/* a checksum may be computed in pieces of any alignment. */
+TEST(incremental)
+{
+    uint8_t buf[1000];
+
+    for (size_t i = 0; i < sizeof(buf); ++i)
+    {
+        buf[i] = (uint8_t)(i * 7 + 3);
+    }
+
+    uint32_t whole = crc32c(0, buf, sizeof(buf));
+    for (size_t split = 0; split <= 17; ++split)
+    {
+        uint32_t crc = crc32c(0, buf, split);
+        crc = crc32c(crc, buf + split, sizeof(buf) - split);
+        TEST_EXPECT(whole == crc);
+    }
+}
@@ -0,0 +1,272 @@
+/**
+ * \file test/extsort/test_extsort.cpp
+ *
+ * \brief Unit tests for the external merge sort.
+ *
+ * \copyright 2020 Velo Payments.  See License.txt for license terms.
+ */
+
+#include <dirent.h>
+#include <minunit/minunit.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <vctool/extsort.h>
+#include <vector>
+
+using namespace std;
+
+/* start of the extsort test suite. */
+TEST_SUITE(extsort);
+
+/**
+ * \brief A test record: an 8 byte big-endian key followed by its insertion
+ * order.
+ */
+struct test_record
+{
+    uint8_t key[8];
+    uint32_t order;
+};
+
+/**
+ * \brief Collect sorted records into a vector.
+ */
+static int collect(void* context, const void* record)
+{
+    vector<test_record>* out = (vector<test_record>*)context;
+
+    out->push_back(*(const test_record*)record);
+
+    return VCTOOL_STATUS_SUCCESS;
+}
+
+/**
+ * \brief Sort count pseudo-random records and check the output order.
+ */
+static bool sort_and_check(
+    size_t count, size_t budget, unsigned threads, const char* dir)
+{
+    file f;
+    extsort sorter;
+    vector<test_record> out;
+    bool ok = true;
+
+    if (VCTOOL_STATUS_SUCCESS != file_init(&f))
+    {
+        return false;
+    }
+
+    if (VCTOOL_STATUS_SUCCESS !=
+            extsort_init(
+                &sorter, &f, dir, sizeof(test_record), 8, budget, threads))
+    {
+        dispose((disposable_t*)&f);
+        return false;
+    }
+
+    srand(1234);
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        test_record rec;
+        uint64_t key = (uint64_t)(rand() % 50000);
+        for (int b = 0; b < 8; ++b)
+        {
+            rec.key[b] = (uint8_t)(key >> (56 - 8 * b));
+        }
+        rec.order = i;
+
+        if (VCTOOL_STATUS_SUCCESS != extsort_add(&sorter, &rec))
+        {
+            ok = false;
+        }
+    }
+
+    if (VCTOOL_STATUS_SUCCESS != extsort_finish(&sorter, &collect, &out))
+    {
+        ok = false;
+    }
+
+    /* every record comes out, in key order. */
+    if (out.size() != count)
+    {
+        ok = false;
+    }
+
+    vector<bool> seen(count, false);
+    for (size_t i = 0; ok && i < out.size(); ++i)
+    {
+        if (i > 0 && memcmp(out[i - 1].key, out[i].key, 8) > 0)
+        {
+            ok = false;
+        }
+        if (out[i].order >= count || seen[out[i].order])
+        {
+            ok = false;
+        }
+        else
+        {
+            seen[out[i].order] = true;
+        }
+    }
+
+    /* every run was removed. */
+    if (0 != sorter.run_count)
+    {
+        ok = false;
+    }
+
+    dispose((disposable_t*)&sorter);
+    dispose((disposable_t*)&f);
+
+    return ok;
+}
+
+/**
+ * \brief Count the entries of a directory, other than . and ..
+ */
+static size_t dir_entries(const char* dir)
+{
+    size_t count = 0;
+    DIR* d = opendir(dir);
+    struct dirent* ent;
+
+    while (NULL != (ent = readdir(d)))
+    {
+        if (strcmp(ent->d_name, ".") && strcmp(ent->d_name, ".."))
+        {
+            ++count;
+        }
+    }
+
+    closedir(d);
+
+    return count;
+}
+
+/* an empty sort produces no records. */
+TEST(empty)
+{
+    char dir[] = "/tmp/extsort-test-XXXXXX";
+    TEST_ASSERT(nullptr != mkdtemp(dir));
+
+    TEST_EXPECT(sort_and_check(0, 4096, 1, dir));
+
+    rmdir(dir);
+}
+
+/* records which fit in the budget are sorted in memory. */
+TEST(in_memory)
+{
+    char dir[] = "/tmp/extsort-test-XXXXXX";
+    TEST_ASSERT(nullptr != mkdtemp(dir));
+
+    TEST_EXPECT(sort_and_check(100000, 16 * 1024 * 1024, 4, dir));
+    TEST_EXPECT(0 == dir_entries(dir));
+
+    rmdir(dir);
+}
+
+/* records beyond the budget are spilled to runs and merged. */
+TEST(spill_single_pass)
+{
+    char dir[] = "/tmp/extsort-test-XXXXXX";
+    TEST_ASSERT(nullptr != mkdtemp(dir));
+
+    TEST_EXPECT(sort_and_check(200000, 1024 * 1024, 4, dir));
+    TEST_EXPECT(0 == dir_entries(dir));
+
+    rmdir(dir);
+}
+
+/* each spill merges the sorted chunks of every thread into a single run. */
+TEST(one_run_per_spill)
+{
+    file f;
+    extsort sorter;
+    vector<test_record> out;
+    char dir[] = "/tmp/extsort-test-XXXXXX";
+    TEST_ASSERT(nullptr != mkdtemp(dir));
+
+    TEST_ASSERT(VCTOOL_STATUS_SUCCESS == file_init(&f));
+    TEST_ASSERT(
+        VCTOOL_STATUS_SUCCESS ==
+            extsort_init(
+                &sorter, &f, dir, sizeof(test_record), 8, 1024 * 1024, 4));
+
+    /* descending keys, so that every chunk must be merged. */
+    uint32_t count = (uint32_t)(2 * sorter.capacity + 1);
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        test_record rec;
+        uint64_t key = count - i;
+        for (int b = 0; b < 8; ++b)
+        {
+            rec.key[b] = (uint8_t)(key >> (56 - 8 * b));
+        }
+        rec.order = i;
+
+        TEST_EXPECT(VCTOOL_STATUS_SUCCESS == extsort_add(&sorter, &rec));
+    }
+
+    /* two full buffers were spilled, one run each. */
+    TEST_EXPECT(2 == sorter.run_count);
+    TEST_EXPECT(2 == dir_entries(dir));
+
+    TEST_EXPECT(
+        VCTOOL_STATUS_SUCCESS == extsort_finish(&sorter, &collect, &out));
+    TEST_ASSERT(count == out.size());
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        TEST_EXPECT(count - 1 - i == out[i].order);
+    }
+
+    dispose((disposable_t*)&sorter);
+    dispose((disposable_t*)&f);
+    TEST_EXPECT(0 == dir_entries(dir));
+
+    rmdir(dir);
+}
+
+/* more runs than the fan-in allows are merged in several passes. */
+TEST(spill_multi_pass)
+{
+    char dir[] = "/tmp/extsort-test-XXXXXX";
+    TEST_ASSERT(nullptr != mkdtemp(dir));
+
+    TEST_EXPECT(sort_and_check(50000, 4096, 1, dir));
+    TEST_EXPECT(0 == dir_entries(dir));
+
+    rmdir(dir);
+}
+
+/* an error from the output function stops the sort. */
+TEST(output_error)
+{
+    file f;
+    extsort sorter;
+    uint8_t rec[8] = { 0 };
+    char dir[] = "/tmp/extsort-test-XXXXXX";
+    TEST_ASSERT(nullptr != mkdtemp(dir));
+
+    TEST_ASSERT(VCTOOL_STATUS_SUCCESS == file_init(&f));
+    TEST_ASSERT(
+        VCTOOL_STATUS_SUCCESS ==
+            extsort_init(&sorter, &f, dir, sizeof(rec), sizeof(rec), 64, 1));
+
+    for (int i = 0; i < 100; ++i)
+    {
+        rec[7] = (uint8_t)i;
+        TEST_EXPECT(VCTOOL_STATUS_SUCCESS == extsort_add(&sorter, rec));
+    }
+
+    auto fail = [](void*, const void*) { return 77; };
+    TEST_EXPECT(77 == extsort_finish(&sorter, fail, nullptr));
+
+    /* dispose removes the runs left over. */
+    dispose((disposable_t*)&sorter);
+    TEST_EXPECT(0 == dir_entries(dir));
+
+    dispose((disposable_t*)&f);
+    rmdir(dir);
+}
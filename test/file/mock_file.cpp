@@ -19,6 +19,14 @@ static int mock_file_open(file*, int*, const char*, int, mode_t);
 static int mock_file_close(file*, int);
 static int mock_file_read(file*, int, void*, size_t, size_t*);
 static int mock_file_write(file*, int, const void*, size_t, size_t*);
+static int mock_file_mmap(file*, void**, int, size_t);
+static int mock_file_munmap(file*, void*, size_t);
+static int mock_file_rename(file*, const char*, const char*);
+static int mock_file_unlink(file*, const char*);
+static int mock_file_mkdir(file*, const char*, mode_t);
+static int mock_file_sendfile(file*, int, int, off_t, size_t, size_t*);
+static int mock_file_fsync(file*, int);
+static int mock_file_ftruncate(file*, int, off_t);
 
 /**
  * \brief Stub for stat.
@@ -65,6 +73,78 @@ const function<int (file*, int, const void*, size_t, size_t*)> stubwrite =
         return VCTOOL_ERROR_FILE_UNKNOWN;
     };
 
+/**
+ * \brief Stub for mmap.
+ */
+const function<int (file*, void**, int, size_t)> stubmmap =
+    [](file*, void**, int, size_t)
+    {
+        return VCTOOL_ERROR_FILE_UNKNOWN;
+    };
+
+/**
+ * \brief Stub for munmap.
+ */
+const function<int (file*, void*, size_t)> stubmunmap =
+    [](file*, void*, size_t)
+    {
+        return VCTOOL_ERROR_FILE_UNKNOWN;
+    };
+
+/**
+ * \brief Stub for rename.
+ */
+const function<int (file*, const char*, const char*)> stubrename =
+    [](file*, const char*, const char*)
+    {
+        return VCTOOL_ERROR_FILE_UNKNOWN;
+    };
+
+/**
+ * \brief Stub for unlink.
+ */
+const function<int (file*, const char*)> stubunlink =
+    [](file*, const char*)
+    {
+        return VCTOOL_ERROR_FILE_UNKNOWN;
+    };
+
+/**
+ * \brief Stub for mkdir.
+ */
+const function<int (file*, const char*, mode_t)> stubmkdir =
+    [](file*, const char*, mode_t)
+    {
+        return VCTOOL_ERROR_FILE_UNKNOWN;
+    };
+
+/**
+ * \brief Stub for sendfile.
+ */
+const function<int (file*, int, int, off_t, size_t, size_t*)> stubsendfile =
+    [](file*, int, int, off_t, size_t, size_t*)
+    {
+        return VCTOOL_ERROR_FILE_UNKNOWN;
+    };
+
+/**
+ * \brief Stub for fsync.
+ */
+const function<int (file*, int)> stubfsync =
+    [](file*, int)
+    {
+        return VCTOOL_ERROR_FILE_UNKNOWN;
+    };
+
+/**
+ * \brief Stub for ftruncate.
+ */
+const function<int (file*, int, off_t)> stubftruncate =
+    [](file*, int, off_t)
+    {
+        return VCTOOL_ERROR_FILE_UNKNOWN;
+    };
+
 /**
  * \brief Initialize a mock file interface.
  *
@@ -74,6 +154,14 @@ const function<int (file*, int, const void*, size_t, size_t*)> stubwrite =
  * \param mockclose     The mock close function.
  * \param mockread      The mock read function.
  * \param mockwrite     The mock write function.
+ * \param mockmmap      The mock mmap function.
+ * \param mockmunmap    The mock munmap function.
+ * \param mockrename    The mock rename function.
+ * \param mockunlink    The mock unlink function.
+ * \param mockmkdir     The mock mkdir function.
+ * \param mocksendfile  The mock sendfile function.
+ * \param mockfsync     The mock fsync function.
+ * \param mockftruncate The mock ftruncate function.
  *
  * \returns a status code indicating success or failure.
  *      - VCTOOL_STATUS_SUCCESS on success.
@@ -85,7 +173,16 @@ int file_mock_init(
     std::function<int (file*, int*, const char*, int, mode_t)> mockopen,
     std::function<int (file*, int)> mockclose,
     std::function<int (file*, int, void*, size_t, size_t*)> mockread,
-    std::function<int (file*, int, const void*, size_t, size_t*)> mockwrite)
+    std::function<int (file*, int, const void*, size_t, size_t*)> mockwrite,
+    std::function<int (file*, void**, int, size_t)> mockmmap,
+    std::function<int (file*, void*, size_t)> mockmunmap,
+    std::function<int (file*, const char*, const char*)> mockrename,
+    std::function<int (file*, const char*)> mockunlink,
+    std::function<int (file*, const char*, mode_t)> mockmkdir,
+    std::function<int (file*, int, int, off_t, size_t, size_t*)>
+        mocksendfile,
+    std::function<int (file*, int)> mockfsync,
+    std::function<int (file*, int, off_t)> mockftruncate)
 {
     mock_file* ctx = new mock_file;
 
@@ -94,6 +191,14 @@ int file_mock_init(
     ctx->mockclose = mockclose;
     ctx->mockread = mockread;
     ctx->mockwrite = mockwrite;
+    ctx->mockmmap = mockmmap;
+    ctx->mockmunmap = mockmunmap;
+    ctx->mockrename = mockrename;
+    ctx->mockunlink = mockunlink;
+    ctx->mockmkdir = mockmkdir;
+    ctx->mocksendfile = mocksendfile;
+    ctx->mockfsync = mockfsync;
+    ctx->mockftruncate = mockftruncate;
 
     memset(f, 0, sizeof(file));
 
@@ -103,6 +208,14 @@ int file_mock_init(
     f->file_close_method = &mock_file_close;
     f->file_read_method = &mock_file_read;
     f->file_write_method = &mock_file_write;
+    f->file_mmap_method = &mock_file_mmap;
+    f->file_munmap_method = &mock_file_munmap;
+    f->file_rename_method = &mock_file_rename;
+    f->file_unlink_method = &mock_file_unlink;
+    f->file_mkdir_method = &mock_file_mkdir;
+    f->file_sendfile_method = &mock_file_sendfile;
+    f->file_fsync_method = &mock_file_fsync;
+    f->file_ftruncate_method = &mock_file_ftruncate;
     f->context = (void*)ctx;
 
     return VCTOOL_STATUS_SUCCESS;
@@ -170,3 +283,84 @@ static int mock_file_write(
 
     return ctx->mockwrite(f, d, buf, sz, psz);
 }
+
+/**
+ * \brief Run the mock for this file mmap.
+ */
+static int mock_file_mmap(file* f, void** addr, int d, size_t size)
+{
+    mock_file* ctx = (mock_file*)f->context;
+
+    return ctx->mockmmap(f, addr, d, size);
+}
+
+/**
+ * \brief Run the mock for this file munmap.
+ */
+static int mock_file_munmap(file* f, void* addr, size_t size)
+{
+    mock_file* ctx = (mock_file*)f->context;
+
+    return ctx->mockmunmap(f, addr, size);
+}
+
+/**
+ * \brief Run the mock for this file rename.
+ */
+static int mock_file_rename(file* f, const char* oldpath, const char* newpath)
+{
+    mock_file* ctx = (mock_file*)f->context;
+
+    return ctx->mockrename(f, oldpath, newpath);
+}
+
+/**
+ * \brief Run the mock for this file unlink.
+ */
+static int mock_file_unlink(file* f, const char* path)
+{
+    mock_file* ctx = (mock_file*)f->context;
+
+    return ctx->mockunlink(f, path);
+}
+
+/**
+ * \brief Run the mock for this file mkdir.
+ */
+static int mock_file_mkdir(file* f, const char* path, mode_t mode)
+{
+    mock_file* ctx = (mock_file*)f->context;
+
+    return ctx->mockmkdir(f, path, mode);
+}
+
+/**
+ * \brief Run the mock for this file sendfile.
+ */
+static int mock_file_sendfile(
+    file* f, int out, int in, off_t offset, size_t max, size_t* sbytes)
+{
+    mock_file* ctx = (mock_file*)f->context;
+
+    return ctx->mocksendfile(f, out, in, offset, max, sbytes);
+}
+
+/**
+ * \brief Run the mock for this file fsync.
+ */
+static int mock_file_fsync(file* f, int d)
+{
+    mock_file* ctx = (mock_file*)f->context;
+
+    return ctx->mockfsync(f, d);
+}
+
+/**
+ * \brief Run the mock for this file ftruncate.
+ */
+static int mock_file_ftruncate(file* f, int d, off_t length)
+{
+    mock_file* ctx = (mock_file*)f->context;
+
+    return ctx->mockftruncate(f, d, length);
+}
@@ -25,6 +25,14 @@ struct mock_file
     std::function<int (file*, int)> mockclose;
     std::function<int (file*, int, void*, size_t, size_t*)> mockread;
     std::function<int (file*, int, const void*, size_t, size_t*)> mockwrite;
+    std::function<int (file*, void**, int, size_t)> mockmmap;
+    std::function<int (file*, void*, size_t)> mockmunmap;
+    std::function<int (file*, const char*, const char*)> mockrename;
+    std::function<int (file*, const char*)> mockunlink;
+    std::function<int (file*, const char*, mode_t)> mockmkdir;
+    std::function<int (file*, int, int, off_t, size_t, size_t*)> mocksendfile;
+    std::function<int (file*, int)> mockfsync;
+    std::function<int (file*, int, off_t)> mockftruncate;
 };
 
 extern const
@@ -37,6 +45,22 @@ extern const
 std::function<int (file*, int, void*, size_t, size_t*)> stubread;
 extern const
 std::function<int (file*, int, const void*, size_t, size_t*)> stubwrite;
+extern const
+std::function<int (file*, void**, int, size_t)> stubmmap;
+extern const
+std::function<int (file*, void*, size_t)> stubmunmap;
+extern const
+std::function<int (file*, const char*, const char*)> stubrename;
+extern const
+std::function<int (file*, const char*)> stubunlink;
+extern const
+std::function<int (file*, const char*, mode_t)> stubmkdir;
+extern const
+std::function<int (file*, int, int, off_t, size_t, size_t*)> stubsendfile;
+extern const
+std::function<int (file*, int)> stubfsync;
+extern const
+std::function<int (file*, int, off_t)> stubftruncate;
 
 /**
  * \brief Initialize a mock file interface.
@@ -47,6 +71,14 @@ std::function<int (file*, int, const void*, size_t, size_t*)> stubwrite;
  * \param mockclose     The mock close function.
  * \param mockread      The mock read function.
  * \param mockwrite     The mock write function.
+ * \param mockmmap      The mock mmap function.
+ * \param mockmunmap    The mock munmap function.
+ * \param mockrename    The mock rename function.
+ * \param mockunlink    The mock unlink function.
+ * \param mockmkdir     The mock mkdir function.
+ * \param mocksendfile  The mock sendfile function.
+ * \param mockfsync     The mock fsync function.
+ * \param mockftruncate The mock ftruncate function.
  *
  * \returns a status code indicating success or failure.
  *      - VCTOOL_STATUS_SUCCESS on success.
@@ -58,6 +90,16 @@ int file_mock_init(
     std::function<int (file*, int*, const char*, int, mode_t)> mockopen,
     std::function<int (file*, int)> mockclose,
     std::function<int (file*, int, void*, size_t, size_t*)> mockread,
-    std::function<int (file*, int, const void*, size_t, size_t*)> mockwrite);
+    std::function<int (file*, int, const void*, size_t, size_t*)> mockwrite,
+    std::function<int (file*, void**, int, size_t)> mockmmap = stubmmap,
+    std::function<int (file*, void*, size_t)> mockmunmap = stubmunmap,
+    std::function<int (file*, const char*, const char*)> mockrename =
+        stubrename,
+    std::function<int (file*, const char*)> mockunlink = stubunlink,
+    std::function<int (file*, const char*, mode_t)> mockmkdir = stubmkdir,
+    std::function<int (file*, int, int, off_t, size_t, size_t*)>
+        mocksendfile = stubsendfile,
+    std::function<int (file*, int)> mockfsync = stubfsync,
+    std::function<int (file*, int, off_t)> mockftruncate = stubftruncate);
 
 #endif /*VCTOOL_TEST_FILE_MOCK_HEADER_GUARD*/
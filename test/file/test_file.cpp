@@ -30,6 +30,14 @@ TEST(file_init_basics)
     TEST_EXPECT(nullptr == f.file_close_method);
     TEST_EXPECT(nullptr == f.file_read_method);
     TEST_EXPECT(nullptr == f.file_write_method);
+    TEST_EXPECT(nullptr == f.file_mmap_method);
+    TEST_EXPECT(nullptr == f.file_munmap_method);
+    TEST_EXPECT(nullptr == f.file_rename_method);
+    TEST_EXPECT(nullptr == f.file_unlink_method);
+    TEST_EXPECT(nullptr == f.file_mkdir_method);
+    TEST_EXPECT(nullptr == f.file_sendfile_method);
+    TEST_EXPECT(nullptr == f.file_fsync_method);
+    TEST_EXPECT(nullptr == f.file_ftruncate_method);
     TEST_EXPECT(nullptr == f.context);
 
     /* initialize should succeed. */
@@ -42,6 +50,14 @@ TEST(file_init_basics)
     TEST_EXPECT(nullptr != f.file_close_method);
     TEST_EXPECT(nullptr != f.file_read_method);
     TEST_EXPECT(nullptr != f.file_write_method);
+    TEST_EXPECT(nullptr != f.file_mmap_method);
+    TEST_EXPECT(nullptr != f.file_munmap_method);
+    TEST_EXPECT(nullptr != f.file_rename_method);
+    TEST_EXPECT(nullptr != f.file_unlink_method);
+    TEST_EXPECT(nullptr != f.file_mkdir_method);
+    TEST_EXPECT(nullptr != f.file_sendfile_method);
+    TEST_EXPECT(nullptr != f.file_fsync_method);
+    TEST_EXPECT(nullptr != f.file_ftruncate_method);
     TEST_EXPECT(nullptr == f.context);
 
     /* dispose the file interface. */
@@ -67,6 +83,14 @@ TEST(file_mock_init)
     TEST_EXPECT(nullptr == f.file_close_method);
     TEST_EXPECT(nullptr == f.file_read_method);
     TEST_EXPECT(nullptr == f.file_write_method);
+    TEST_EXPECT(nullptr == f.file_mmap_method);
+    TEST_EXPECT(nullptr == f.file_munmap_method);
+    TEST_EXPECT(nullptr == f.file_rename_method);
+    TEST_EXPECT(nullptr == f.file_unlink_method);
+    TEST_EXPECT(nullptr == f.file_mkdir_method);
+    TEST_EXPECT(nullptr == f.file_sendfile_method);
+    TEST_EXPECT(nullptr == f.file_fsync_method);
+    TEST_EXPECT(nullptr == f.file_ftruncate_method);
     TEST_EXPECT(nullptr == f.context);
 
     /* initialize should succeed. */
@@ -82,6 +106,14 @@ TEST(file_mock_init)
     TEST_EXPECT(nullptr != f.file_close_method);
     TEST_EXPECT(nullptr != f.file_read_method);
     TEST_EXPECT(nullptr != f.file_write_method);
+    TEST_EXPECT(nullptr != f.file_mmap_method);
+    TEST_EXPECT(nullptr != f.file_munmap_method);
+    TEST_EXPECT(nullptr != f.file_rename_method);
+    TEST_EXPECT(nullptr != f.file_unlink_method);
+    TEST_EXPECT(nullptr != f.file_mkdir_method);
+    TEST_EXPECT(nullptr != f.file_sendfile_method);
+    TEST_EXPECT(nullptr != f.file_fsync_method);
+    TEST_EXPECT(nullptr != f.file_ftruncate_method);
     TEST_EXPECT(nullptr != f.context);
 
     /* calling file_stat returns VCTOOL_ERROR_FILE_UNKNOWN. */
@@ -104,6 +136,36 @@ TEST(file_mock_init)
         VCTOOL_ERROR_FILE_UNKNOWN ==
             file_write(&f, d, buf, sizeof(buf), &size));
 
+    /* calling file_mmap returns VCTOOL_ERROR_FILE_UNKNOWN. */
+    void* addr;
+    TEST_EXPECT(
+        VCTOOL_ERROR_FILE_UNKNOWN == file_mmap(&f, &addr, d, sizeof(buf)));
+
+    /* calling file_munmap returns VCTOOL_ERROR_FILE_UNKNOWN. */
+    TEST_EXPECT(
+        VCTOOL_ERROR_FILE_UNKNOWN == file_munmap(&f, buf, sizeof(buf)));
+
+    /* calling file_rename returns VCTOOL_ERROR_FILE_UNKNOWN. */
+    TEST_EXPECT(
+        VCTOOL_ERROR_FILE_UNKNOWN == file_rename(&f, "test", "test2"));
+
+    /* calling file_unlink returns VCTOOL_ERROR_FILE_UNKNOWN. */
+    TEST_EXPECT(VCTOOL_ERROR_FILE_UNKNOWN == file_unlink(&f, "test"));
+
+    /* calling file_mkdir returns VCTOOL_ERROR_FILE_UNKNOWN. */
+    TEST_EXPECT(VCTOOL_ERROR_FILE_UNKNOWN == file_mkdir(&f, "test", 0700));
+
+    /* calling file_sendfile returns VCTOOL_ERROR_FILE_UNKNOWN. */
+    TEST_EXPECT(
+        VCTOOL_ERROR_FILE_UNKNOWN ==
+            file_sendfile(&f, d, d, 0, sizeof(buf), &size));
+
+    /* calling file_fsync returns VCTOOL_ERROR_FILE_UNKNOWN. */
+    TEST_EXPECT(VCTOOL_ERROR_FILE_UNKNOWN == file_fsync(&f, d));
+
+    /* calling file_ftruncate returns VCTOOL_ERROR_FILE_UNKNOWN. */
+    TEST_EXPECT(VCTOOL_ERROR_FILE_UNKNOWN == file_ftruncate(&f, d, 0));
+
     /* dispose the file interface. */
     dispose((disposable_t*)&f);
 }
@@ -330,3 +392,385 @@ TEST(file_write)
     /* dispose the file interface. */
     dispose((disposable_t*)&f);
 }
+
+/* file_write_all retries short writes until the whole buffer is written. */
+TEST(file_write_all)
+{
+    file f;
+    int EXPECTED_DESCRIPTOR = 993;
+    char EXPECTED_BUFFER[43];
+    size_t total = 0;
+    int calls = 0;
+
+    /* mock write, writing at most 10 bytes per call. */
+    auto writemock = [&](
+        file*, int d, const void* buf, size_t max, size_t* wbytes)
+    {
+        if (d != EXPECTED_DESCRIPTOR
+         || (const char*)buf != EXPECTED_BUFFER + total)
+        {
+            return -1;
+        }
+
+        *wbytes = (max > 10) ? 10 : max;
+        total += *wbytes;
+        ++calls;
+
+        return VCTOOL_STATUS_SUCCESS;
+    };
+
+    /* initialize should succeed. */
+    TEST_ASSERT(
+        VCTOOL_STATUS_SUCCESS ==
+            file_mock_init(
+                &f, stubstat, stubopen, stubclose, stubread, writemock));
+
+    /* the whole buffer is written in five calls. */
+    TEST_EXPECT(
+        VCTOOL_STATUS_SUCCESS ==
+            file_write_all(
+                &f, EXPECTED_DESCRIPTOR, EXPECTED_BUFFER,
+                sizeof(EXPECTED_BUFFER)));
+    TEST_EXPECT(sizeof(EXPECTED_BUFFER) == total);
+    TEST_EXPECT(5 == calls);
+
+    /* dispose the file interface. */
+    dispose((disposable_t*)&f);
+}
+
+/* file_mmap passes all parameters and returns the value of its impl. */
+TEST(file_mmap)
+{
+    file f;
+    int EXPECTED_DESCRIPTOR = 993;
+    size_t EXPECTED_SIZE = 4096;
+    int EXPECTED_RETURN_CODE = 27;
+    void* addr;
+
+    file* got_f = nullptr;
+    void** got_addr = nullptr;
+    int got_d = 0;
+    size_t got_size = 0;
+
+    /* mock mmap. */
+    auto mmapmock = [&](file* f, void** addr, int d, size_t size)
+    {
+        got_f = f;
+        got_addr = addr;
+        got_d = d;
+        got_size = size;
+
+        return EXPECTED_RETURN_CODE;
+    };
+
+    /* initialize should succeed. */
+    TEST_ASSERT(
+        VCTOOL_STATUS_SUCCESS ==
+            file_mock_init(
+                &f, stubstat, stubopen, stubclose, stubread, stubwrite,
+                mmapmock));
+
+    /* calling file_mmap returns our code. */
+    TEST_EXPECT(
+        EXPECTED_RETURN_CODE ==
+            file_mmap(&f, &addr, EXPECTED_DESCRIPTOR, EXPECTED_SIZE));
+    TEST_EXPECT(got_f == &f);
+    TEST_EXPECT(got_addr == &addr);
+    TEST_EXPECT(got_d == EXPECTED_DESCRIPTOR);
+    TEST_EXPECT(got_size == EXPECTED_SIZE);
+
+    /* dispose the file interface. */
+    dispose((disposable_t*)&f);
+}
+
+/* file_munmap passes all parameters and returns the value of its impl. */
+TEST(file_munmap)
+{
+    file f;
+    char EXPECTED_BUFFER[43];
+    int EXPECTED_RETURN_CODE = 27;
+
+    file* got_f = nullptr;
+    void* got_addr = nullptr;
+    size_t got_size = 0;
+
+    /* mock munmap. */
+    auto munmapmock = [&](file* f, void* addr, size_t size)
+    {
+        got_f = f;
+        got_addr = addr;
+        got_size = size;
+
+        return EXPECTED_RETURN_CODE;
+    };
+
+    /* initialize should succeed. */
+    TEST_ASSERT(
+        VCTOOL_STATUS_SUCCESS ==
+            file_mock_init(
+                &f, stubstat, stubopen, stubclose, stubread, stubwrite,
+                stubmmap, munmapmock));
+
+    /* calling file_munmap returns our code. */
+    TEST_EXPECT(
+        EXPECTED_RETURN_CODE ==
+            file_munmap(&f, EXPECTED_BUFFER, sizeof(EXPECTED_BUFFER)));
+    TEST_EXPECT(got_f == &f);
+    TEST_EXPECT(got_addr == EXPECTED_BUFFER);
+    TEST_EXPECT(got_size == sizeof(EXPECTED_BUFFER));
+
+    /* dispose the file interface. */
+    dispose((disposable_t*)&f);
+}
+
+/* file_rename passes all parameters and returns the value of its impl. */
+TEST(file_rename)
+{
+    file f;
+    const char* EXPECTED_OLDPATH = "./test.txt";
+    const char* EXPECTED_NEWPATH = "./test2.txt";
+    int EXPECTED_RETURN_CODE = 27;
+
+    file* got_f = nullptr;
+    const char* got_oldpath = nullptr;
+    const char* got_newpath = nullptr;
+
+    /* mock rename. */
+    auto renamemock = [&](file* f, const char* oldpath, const char* newpath)
+    {
+        got_f = f;
+        got_oldpath = oldpath;
+        got_newpath = newpath;
+
+        return EXPECTED_RETURN_CODE;
+    };
+
+    /* initialize should succeed. */
+    TEST_ASSERT(
+        VCTOOL_STATUS_SUCCESS ==
+            file_mock_init(
+                &f, stubstat, stubopen, stubclose, stubread, stubwrite,
+                stubmmap, stubmunmap, renamemock));
+
+    /* calling file_rename returns our code. */
+    TEST_EXPECT(
+        EXPECTED_RETURN_CODE ==
+            file_rename(&f, EXPECTED_OLDPATH, EXPECTED_NEWPATH));
+    TEST_EXPECT(got_f == &f);
+    TEST_EXPECT(got_oldpath == EXPECTED_OLDPATH);
+    TEST_EXPECT(got_newpath == EXPECTED_NEWPATH);
+
+    /* dispose the file interface. */
+    dispose((disposable_t*)&f);
+}
+
+/* file_unlink passes all parameters and returns the value of its impl. */
+TEST(file_unlink)
+{
+    file f;
+    const char* EXPECTED_PATH = "./test.txt";
+    int EXPECTED_RETURN_CODE = 27;
+
+    file* got_f = nullptr;
+    const char* got_path = nullptr;
+
+    /* mock unlink. */
+    auto unlinkmock = [&](file* f, const char* path)
+    {
+        got_f = f;
+        got_path = path;
+
+        return EXPECTED_RETURN_CODE;
+    };
+
+    /* initialize should succeed. */
+    TEST_ASSERT(
+        VCTOOL_STATUS_SUCCESS ==
+            file_mock_init(
+                &f, stubstat, stubopen, stubclose, stubread, stubwrite,
+                stubmmap, stubmunmap, stubrename, unlinkmock));
+
+    /* calling file_unlink returns our code. */
+    TEST_EXPECT(EXPECTED_RETURN_CODE == file_unlink(&f, EXPECTED_PATH));
+    TEST_EXPECT(got_f == &f);
+    TEST_EXPECT(got_path == EXPECTED_PATH);
+
+    /* dispose the file interface. */
+    dispose((disposable_t*)&f);
+}
+
+/* file_mkdir passes all parameters and returns the value of its impl. */
+TEST(file_mkdir)
+{
+    file f;
+    const char* EXPECTED_PATH = "./testdir";
+    mode_t EXPECTED_MODE = 0750;
+    int EXPECTED_RETURN_CODE = 27;
+
+    file* got_f = nullptr;
+    const char* got_path = nullptr;
+    mode_t got_mode = 0;
+
+    /* mock mkdir. */
+    auto mkdirmock = [&](file* f, const char* path, mode_t mode)
+    {
+        got_f = f;
+        got_path = path;
+        got_mode = mode;
+
+        return EXPECTED_RETURN_CODE;
+    };
+
+    /* initialize should succeed. */
+    TEST_ASSERT(
+        VCTOOL_STATUS_SUCCESS ==
+            file_mock_init(
+                &f, stubstat, stubopen, stubclose, stubread, stubwrite,
+                stubmmap, stubmunmap, stubrename, stubunlink, mkdirmock));
+
+    /* calling file_mkdir returns our code. */
+    TEST_EXPECT(
+        EXPECTED_RETURN_CODE == file_mkdir(&f, EXPECTED_PATH, EXPECTED_MODE));
+    TEST_EXPECT(got_f == &f);
+    TEST_EXPECT(got_path == EXPECTED_PATH);
+    TEST_EXPECT(got_mode == EXPECTED_MODE);
+
+    /* dispose the file interface. */
+    dispose((disposable_t*)&f);
+}
+
+/* file_sendfile passes all parameters and returns the value of its impl. */
+TEST(file_sendfile)
+{
+    file f;
+    int EXPECTED_OUT = 17;
+    int EXPECTED_IN = 993;
+    off_t EXPECTED_OFFSET = 4096;
+    size_t EXPECTED_MAX = 1000;
+    size_t sbytes;
+    int EXPECTED_RETURN_CODE = 27;
+
+    file* got_f = nullptr;
+    int got_out = 0;
+    int got_in = 0;
+    off_t got_offset = 0;
+    size_t got_max = 0;
+    size_t* got_sbytes = nullptr;
+
+    /* mock sendfile. */
+    auto sendfilemock = [&](
+        file* f, int out, int in, off_t offset, size_t max, size_t* sbytes)
+    {
+        got_f = f;
+        got_out = out;
+        got_in = in;
+        got_offset = offset;
+        got_max = max;
+        got_sbytes = sbytes;
+
+        return EXPECTED_RETURN_CODE;
+    };
+
+    /* initialize should succeed. */
+    TEST_ASSERT(
+        VCTOOL_STATUS_SUCCESS ==
+            file_mock_init(
+                &f, stubstat, stubopen, stubclose, stubread, stubwrite,
+                stubmmap, stubmunmap, stubrename, stubunlink, stubmkdir,
+                sendfilemock));
+
+    /* calling file_sendfile returns our code. */
+    TEST_EXPECT(
+        EXPECTED_RETURN_CODE ==
+            file_sendfile(
+                &f, EXPECTED_OUT, EXPECTED_IN, EXPECTED_OFFSET, EXPECTED_MAX,
+                &sbytes));
+    TEST_EXPECT(got_f == &f);
+    TEST_EXPECT(got_out == EXPECTED_OUT);
+    TEST_EXPECT(got_in == EXPECTED_IN);
+    TEST_EXPECT(got_offset == EXPECTED_OFFSET);
+    TEST_EXPECT(got_max == EXPECTED_MAX);
+    TEST_EXPECT(got_sbytes == &sbytes);
+
+    /* dispose the file interface. */
+    dispose((disposable_t*)&f);
+}
+
+/* file_fsync passes all parameters and returns the value of its impl. */
+TEST(file_fsync)
+{
+    file f;
+    int EXPECTED_DESCRIPTOR = 17;
+    int EXPECTED_RETURN_CODE = 27;
+
+    file* got_f = nullptr;
+    int got_d = 0;
+
+    /* mock fsync. */
+    auto fsyncmock = [&](file* f, int d)
+    {
+        got_f = f;
+        got_d = d;
+
+        return EXPECTED_RETURN_CODE;
+    };
+
+    /* initialize should succeed. */
+    TEST_ASSERT(
+        VCTOOL_STATUS_SUCCESS ==
+            file_mock_init(
+                &f, stubstat, stubopen, stubclose, stubread, stubwrite,
+                stubmmap, stubmunmap, stubrename, stubunlink, stubmkdir,
+                stubsendfile, fsyncmock));
+
+    /* calling file_fsync returns our code. */
+    TEST_EXPECT(
+        EXPECTED_RETURN_CODE == file_fsync(&f, EXPECTED_DESCRIPTOR));
+    TEST_EXPECT(got_f == &f);
+    TEST_EXPECT(got_d == EXPECTED_DESCRIPTOR);
+
+    /* dispose the file interface. */
+    dispose((disposable_t*)&f);
+}
+
+/* file_ftruncate passes all parameters and returns the value of its impl. */
+TEST(file_ftruncate)
+{
+    file f;
+    int EXPECTED_DESCRIPTOR = 17;
+    off_t EXPECTED_LENGTH = 4096;
+    int EXPECTED_RETURN_CODE = 27;
+
+    file* got_f = nullptr;
+    int got_d = 0;
+    off_t got_length = 0;
+
+    /* mock ftruncate. */
+    auto ftruncatemock = [&](file* f, int d, off_t length)
+    {
+        got_f = f;
+        got_d = d;
+        got_length = length;
+
+        return EXPECTED_RETURN_CODE;
+    };
+
+    /* initialize should succeed. */
+    TEST_ASSERT(
+        VCTOOL_STATUS_SUCCESS ==
+            file_mock_init(
+                &f, stubstat, stubopen, stubclose, stubread, stubwrite,
+                stubmmap, stubmunmap, stubrename, stubunlink, stubmkdir,
+                stubsendfile, stubfsync, ftruncatemock));
+
+    /* calling file_ftruncate returns our code. */
+    TEST_EXPECT(
+        EXPECTED_RETURN_CODE
+            == file_ftruncate(&f, EXPECTED_DESCRIPTOR, EXPECTED_LENGTH));
+    TEST_EXPECT(got_f == &f);
+    TEST_EXPECT(got_d == EXPECTED_DESCRIPTOR);
+    TEST_EXPECT(got_length == EXPECTED_LENGTH);
+
+    /* dispose the file interface. */
+    dispose((disposable_t*)&f);
+}
@@ -0,0 +1,398 @@
+/**
+ * \file test/journal/test_journal.cpp
+ *
+ * \brief Unit tests for the submission journal.
+ *
+ * \copyright 2020 Velo Payments.  See License.txt for license terms.
+ */
+
+#include <minunit/minunit.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <vccert/fields.h>
+#include <vctool/journal.h>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+/* start of the journal test suite. */
+TEST_SUITE(journal);
+
+/**
+ * \brief Make a transaction id from a number.
+ */
+static void make_id(uint8_t* id, uint32_t n)
+{
+    memset(id, 0xA5, UUID_SIZE);
+    memcpy(id, &n, sizeof(n));
+}
+
+/* A reopened journal knows which transactions were acknowledged, and which
+ * were only submitted. */
+TEST(reopen)
+{
+    const char* path = "/tmp/journal-test.jrnl";
+    file f;
+    journal j;
+    uint8_t acked[UUID_SIZE], sent[UUID_SIZE], other[UUID_SIZE];
+    uint64_t sequence;
+
+    make_id(acked, 1);
+    make_id(sent, 2);
+    make_id(other, 3);
+
+    unlink(path);
+    TEST_ASSERT(VCTOOL_STATUS_SUCCESS == file_init(&f));
+
+    /* a new journal is empty. */
+    TEST_ASSERT(VCTOOL_STATUS_SUCCESS == journal_open(&j, &f, path));
+    TEST_EXPECT(JOURNAL_UNKNOWN == journal_state(&j, acked));
+
+    TEST_ASSERT(
+        VCTOOL_STATUS_SUCCESS ==
+            journal_append(&j, JOURNAL_SUBMITTED, acked, &sequence));
+    TEST_ASSERT(
+        VCTOOL_STATUS_SUCCESS ==
+            journal_append(&j, JOURNAL_SUBMITTED, sent, &sequence));
+    TEST_ASSERT(
+        VCTOOL_STATUS_SUCCESS ==
+            journal_append(&j, JOURNAL_ACKNOWLEDGED, acked, &sequence));
+    TEST_EXPECT(3U == sequence);
+    TEST_ASSERT(VCTOOL_STATUS_SUCCESS == journal_commit(&j, sequence));
+    TEST_EXPECT(1U == j.flushes);
+
+    /* a commit of a durable record doesn't flush again. */
+    TEST_ASSERT(VCTOOL_STATUS_SUCCESS == journal_commit(&j, 1));
+    TEST_EXPECT(1U == j.flushes);
+    dispose((disposable_t*)&j);
+
+    TEST_ASSERT(VCTOOL_STATUS_SUCCESS == journal_open(&j, &f, path));
+    TEST_EXPECT(JOURNAL_ACKNOWLEDGED == journal_state(&j, acked));
+    TEST_EXPECT(JOURNAL_SUBMITTED == journal_state(&j, sent));
+    TEST_EXPECT(JOURNAL_UNKNOWN == journal_state(&j, other));
+    TEST_EXPECT(0U == j.damaged);
+    dispose((disposable_t*)&j);
+
+    dispose((disposable_t*)&f);
+    unlink(path);
+}
+
+/* Transactions submitted many times are indexed once each, whatever order
+ * their records are in. */
+TEST(many_records)
+{
+    const char* path = "/tmp/journal-test-many.jrnl";
+    const uint32_t COUNT = 1000;
+    file f;
+    journal j;
+    uint8_t id[UUID_SIZE];
+    uint64_t sequence;
+
+    unlink(path);
+    TEST_ASSERT(VCTOOL_STATUS_SUCCESS == file_init(&f));
+
+    /* submit every transaction three times, in descending order, and
+     * acknowledge the even ones after their second submission. */
+    TEST_ASSERT(VCTOOL_STATUS_SUCCESS == journal_open(&j, &f, path));
+    for (int pass = 0; pass < 3; ++pass)
+    {
+        for (uint32_t n = COUNT; n > 0; --n)
+        {
+            make_id(id, n);
+            journal_append(&j, JOURNAL_SUBMITTED, id, &sequence);
+            if (1 == pass && 0 == n % 2)
+            {
+                journal_append(&j, JOURNAL_ACKNOWLEDGED, id, &sequence);
+            }
+        }
+    }
+
+    TEST_ASSERT(VCTOOL_STATUS_SUCCESS == journal_commit(&j, sequence));
+    dispose((disposable_t*)&j);
+
+    TEST_ASSERT(VCTOOL_STATUS_SUCCESS == journal_open(&j, &f, path));
+    TEST_EXPECT(0U == j.damaged);
+    TEST_EXPECT(COUNT / 2 == j.acknowledged);
+    TEST_EXPECT(COUNT / 2 == j.uncertain);
+    for (uint32_t n = 1; n <= COUNT; ++n)
+    {
+        make_id(id, n);
+        TEST_EXPECT(
+            (0 == n % 2 ? JOURNAL_ACKNOWLEDGED : JOURNAL_SUBMITTED)
+                == journal_state(&j, id));
+    }
+
+    make_id(id, COUNT + 1);
+    TEST_EXPECT(JOURNAL_UNKNOWN == journal_state(&j, id));
+    dispose((disposable_t*)&j);
+
+    dispose((disposable_t*)&f);
+    unlink(path);
+}
+
+/* A record torn by a crash is skipped, and records appended after it are
+ * read back. */
+TEST(torn_tail)
+{
+    const char* path = "/tmp/journal-test-torn.jrnl";
+    file f;
+    journal j;
+    uint8_t first[UUID_SIZE], torn[UUID_SIZE], later[UUID_SIZE];
+    uint64_t sequence;
+
+    make_id(first, 1);
+    make_id(torn, 2);
+    make_id(later, 3);
+
+    unlink(path);
+    TEST_ASSERT(VCTOOL_STATUS_SUCCESS == file_init(&f));
+
+    TEST_ASSERT(VCTOOL_STATUS_SUCCESS == journal_open(&j, &f, path));
+    journal_append(&j, JOURNAL_ACKNOWLEDGED, first, &sequence);
+    journal_append(&j, JOURNAL_ACKNOWLEDGED, torn, &sequence);
+    TEST_ASSERT(VCTOOL_STATUS_SUCCESS == journal_commit(&j, sequence));
+    dispose((disposable_t*)&j);
+
+    /* tear the second record. */
+    TEST_ASSERT(
+        0 ==
+            truncate(
+                path, JOURNAL_MAGIC_SIZE + JOURNAL_RECORD_SIZE + 10));
+
+    TEST_ASSERT(VCTOOL_STATUS_SUCCESS == journal_open(&j, &f, path));
+    TEST_EXPECT(1U == j.damaged);
+    TEST_EXPECT(JOURNAL_ACKNOWLEDGED == journal_state(&j, first));
+    TEST_EXPECT(JOURNAL_UNKNOWN == journal_state(&j, torn));
+    journal_append(&j, JOURNAL_ACKNOWLEDGED, later, &sequence);
+    TEST_ASSERT(VCTOOL_STATUS_SUCCESS == journal_commit(&j, sequence));
+    dispose((disposable_t*)&j);
+
+    TEST_ASSERT(VCTOOL_STATUS_SUCCESS == journal_open(&j, &f, path));
+    TEST_EXPECT(1U == j.damaged);
+    TEST_EXPECT(JOURNAL_ACKNOWLEDGED == journal_state(&j, first));
+    TEST_EXPECT(JOURNAL_ACKNOWLEDGED == journal_state(&j, later));
+    dispose((disposable_t*)&j);
+
+    dispose((disposable_t*)&f);
+    unlink(path);
+}
+
+/**
+ * \brief Check the state of the transactions written by the checkpoint test,
+ * and that there are the given number of other uncertain transactions.
+ */
+static bool checkpoint_states(
+    const journal* j, uint32_t count, size_t uncertain)
+{
+    uint8_t id[UUID_SIZE];
+
+    for (uint32_t n = 1; n <= count; ++n)
+    {
+        make_id(id, n);
+        if ((0 == n % 2 ? JOURNAL_ACKNOWLEDGED : JOURNAL_SUBMITTED)
+                != journal_state(j, id))
+        {
+            return false;
+        }
+    }
+
+    return
+        count / 2 == j->acknowledged
+     && count - count / 2 + uncertain == j->uncertain;
+}
+
+/* A long journal is checkpointed when it is opened, so that the next open
+ * replays only the records after the checkpoint; a checkpoint which doesn't
+ * match the journal is ignored. */
+TEST(checkpoint)
+{
+    const char* path = "/tmp/journal-test-ckpt.jrnl";
+    const char* ckpt = "/tmp/journal-test-ckpt.jrnl" JOURNAL_CHECKPOINT_SUFFIX;
+    const uint32_t COUNT = JOURNAL_CHECKPOINT_RECORDS + 100;
+    file f;
+    journal j;
+    uint8_t id[UUID_SIZE];
+    uint64_t sequence;
+
+    unlink(path);
+    unlink(ckpt);
+    TEST_ASSERT(VCTOOL_STATUS_SUCCESS == file_init(&f));
+
+    /* submit every transaction, and acknowledge the even ones. */
+    TEST_ASSERT(VCTOOL_STATUS_SUCCESS == journal_open(&j, &f, path));
+    for (uint32_t n = 1; n <= COUNT; ++n)
+    {
+        make_id(id, n);
+        journal_append(&j, JOURNAL_SUBMITTED, id, &sequence);
+        if (0 == n % 2)
+        {
+            journal_append(&j, JOURNAL_ACKNOWLEDGED, id, &sequence);
+        }
+    }
+
+    TEST_ASSERT(VCTOOL_STATUS_SUCCESS == journal_commit(&j, sequence));
+    dispose((disposable_t*)&j);
+    TEST_EXPECT(0 != access(ckpt, F_OK));
+
+    /* the first open replays everything and saves a checkpoint. */
+    TEST_ASSERT(VCTOOL_STATUS_SUCCESS == journal_open(&j, &f, path));
+    TEST_EXPECT(0 == access(ckpt, F_OK));
+    TEST_EXPECT(checkpoint_states(&j, COUNT, 0));
+
+    /* a new transaction is appended after the checkpoint. */
+    make_id(id, COUNT + 2);
+    journal_append(&j, JOURNAL_SUBMITTED, id, &sequence);
+    TEST_ASSERT(VCTOOL_STATUS_SUCCESS == journal_commit(&j, sequence));
+    dispose((disposable_t*)&j);
+
+    /* the checkpoint and the records after it are both read; damage to a
+     * record before the checkpoint isn't seen, since it isn't replayed. */
+    FILE* out = fopen(path, "r+");
+    TEST_ASSERT(nullptr != out);
+    fseek(out, JOURNAL_MAGIC_SIZE + JOURNAL_RECORD_CHECKED_SIZE, SEEK_SET);
+    int saved = fgetc(out);
+    fseek(out, JOURNAL_MAGIC_SIZE + JOURNAL_RECORD_CHECKED_SIZE, SEEK_SET);
+    fputc(saved ^ 0xFF, out);
+    fclose(out);
+
+    TEST_ASSERT(VCTOOL_STATUS_SUCCESS == journal_open(&j, &f, path));
+    TEST_EXPECT(0U == j.damaged);
+    TEST_EXPECT(checkpoint_states(&j, COUNT, 1));
+    TEST_EXPECT(JOURNAL_SUBMITTED == journal_state(&j, id));
+    dispose((disposable_t*)&j);
+
+    out = fopen(path, "r+");
+    TEST_ASSERT(nullptr != out);
+    fseek(out, JOURNAL_MAGIC_SIZE + JOURNAL_RECORD_CHECKED_SIZE, SEEK_SET);
+    fputc(saved, out);
+    fclose(out);
+
+    /* a damaged checkpoint is ignored. */
+    out = fopen(ckpt, "r+");
+    TEST_ASSERT(nullptr != out);
+    fseek(out, JOURNAL_CHECKPOINT_HEADER_SIZE + 5, SEEK_SET);
+    fputc(0xFF, out);
+    fclose(out);
+
+    TEST_ASSERT(VCTOOL_STATUS_SUCCESS == journal_open(&j, &f, path));
+    TEST_EXPECT(checkpoint_states(&j, COUNT, 1));
+    TEST_EXPECT(JOURNAL_SUBMITTED == journal_state(&j, id));
+    dispose((disposable_t*)&j);
+
+    /* a checkpoint which covers more than the journal is ignored. */
+    TEST_ASSERT(0 == truncate(path, JOURNAL_MAGIC_SIZE));
+    TEST_ASSERT(VCTOOL_STATUS_SUCCESS == journal_open(&j, &f, path));
+    TEST_EXPECT(0U == j.acknowledged);
+    TEST_EXPECT(0U == j.uncertain);
+    TEST_EXPECT(JOURNAL_UNKNOWN == journal_state(&j, id));
+    dispose((disposable_t*)&j);
+
+    dispose((disposable_t*)&f);
+    unlink(path);
+    unlink(ckpt);
+}
+
+/* A file which is not a journal is rejected. */
+TEST(bad_magic)
+{
+    const char* path = "/tmp/journal-test-bad.jrnl";
+    file f;
+    journal j;
+
+    FILE* out = fopen(path, "w");
+    TEST_ASSERT(nullptr != out);
+    fputs("not a journal at all", out);
+    fclose(out);
+
+    TEST_ASSERT(VCTOOL_STATUS_SUCCESS == file_init(&f));
+    TEST_EXPECT(
+        VCTOOL_ERROR_JOURNAL_BAD_JOURNAL == journal_open(&j, &f, path));
+
+    dispose((disposable_t*)&f);
+    unlink(path);
+}
+
+/* Concurrent commits are grouped into fewer flushes. */
+TEST(group_commit)
+{
+    const char* path = "/tmp/journal-test-group.jrnl";
+    const uint32_t THREADS = 16;
+    const uint32_t PER_THREAD = 50;
+    file f;
+    journal j;
+    vector<thread> threads;
+    int failures = 0;
+
+    unlink(path);
+    TEST_ASSERT(VCTOOL_STATUS_SUCCESS == file_init(&f));
+    TEST_ASSERT(VCTOOL_STATUS_SUCCESS == journal_open(&j, &f, path));
+
+    for (uint32_t t = 0; t < THREADS; ++t)
+    {
+        threads.emplace_back([&, t]() {
+            uint8_t id[UUID_SIZE];
+            uint64_t sequence;
+
+            for (uint32_t i = 0; i < PER_THREAD; ++i)
+            {
+                make_id(id, t * PER_THREAD + i);
+                if (VCTOOL_STATUS_SUCCESS !=
+                        journal_append(
+                            &j, JOURNAL_ACKNOWLEDGED, id, &sequence)
+                 || VCTOOL_STATUS_SUCCESS != journal_commit(&j, sequence))
+                {
+                    __atomic_fetch_add(&failures, 1, __ATOMIC_RELAXED);
+                }
+            }
+        });
+    }
+
+    for (auto& t : threads)
+    {
+        t.join();
+    }
+
+    TEST_EXPECT(0 == failures);
+    TEST_EXPECT(j.flushes < THREADS * PER_THREAD);
+    TEST_EXPECT(j.durable == THREADS * PER_THREAD);
+    dispose((disposable_t*)&j);
+
+    /* every acknowledgement was made durable. */
+    TEST_ASSERT(VCTOOL_STATUS_SUCCESS == journal_open(&j, &f, path));
+    TEST_EXPECT(THREADS * PER_THREAD == j.acknowledged);
+    dispose((disposable_t*)&j);
+
+    dispose((disposable_t*)&f);
+    unlink(path);
+}
+
+/* The transaction id is read from the certificate id field. */
+TEST(transaction_id)
+{
+    uint8_t id[UUID_SIZE];
+    uint8_t expected[UUID_SIZE];
+    vector<uint8_t> cert;
+
+    make_id(expected, 42);
+
+    /* an unrelated field, then the certificate id. */
+    uint8_t other[] = { 0x00, 0x01, 0x00, 0x02, 0xDE, 0xAD };
+    cert.insert(cert.end(), other, other + sizeof(other));
+    cert.push_back((uint8_t)(VCCERT_FIELD_TYPE_CERTIFICATE_ID >> 8));
+    cert.push_back((uint8_t)VCCERT_FIELD_TYPE_CERTIFICATE_ID);
+    cert.push_back(0);
+    cert.push_back(UUID_SIZE);
+    cert.insert(cert.end(), expected, expected + UUID_SIZE);
+
+    TEST_ASSERT(
+        VCTOOL_STATUS_SUCCESS ==
+            journal_transaction_id(id, cert.data(), cert.size()));
+    TEST_EXPECT(0 == memcmp(id, expected, UUID_SIZE));
+
+    /* a truncated certificate id is not found. */
+    TEST_EXPECT(
+        VCTOOL_ERROR_JOURNAL_NO_TRANSACTION_ID ==
+            journal_transaction_id(id, cert.data(), cert.size() - 1));
+}
@@ -0,0 +1,124 @@
+/**
+ * \file test/mph/test_mph.cpp
+ *
+ * \brief Unit tests for the minimal perfect hash.
+ *
+ * \copyright 2020 Velo Payments.  See License.txt for license terms.
+ */
+
+#include <minunit/minunit.h>
+#include <string.h>
+#include <vector>
+#include <vctool/mph.h>
+
+using namespace std;
+
+/* start of the mph test suite. */
+TEST_SUITE(mph);
+
+/**
+ * \brief Create a set of distinct keys.
+ */
+static vector<uint8_t> make_keys(uint32_t count)
+{
+    vector<uint8_t> keys(count * MPH_KEY_SIZE);
+
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        uint8_t* key = &keys[i * MPH_KEY_SIZE];
+        uint32_t n = i;
+        for (int j = 0; j < MPH_KEY_SIZE - 4; ++j)
+        {
+            n = n * 1103515245U + 12345U;
+            key[j] = (uint8_t)(n >> 16);
+        }
+
+        /* the counter guarantees distinct keys. */
+        memcpy(key + MPH_KEY_SIZE - 4, &i, 4);
+    }
+
+    return keys;
+}
+
+/**
+ * \brief Check that every key maps to a distinct index in range.
+ */
+static bool is_minimal_perfect(
+    const mph* m, const vector<uint8_t>& keys, uint32_t count)
+{
+    vector<bool> seen(count, false);
+
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        uint64_t index = mph_lookup(m, &keys[i * MPH_KEY_SIZE]);
+        if (index >= count || seen[index])
+        {
+            return false;
+        }
+
+        seen[index] = true;
+    }
+
+    return true;
+}
+
+/* single and multi-threaded builds are minimal and perfect. */
+TEST(build_lookup)
+{
+    const uint32_t COUNT = 100000;
+    vector<uint8_t> keys = make_keys(COUNT);
+    mph m;
+
+    for (unsigned threads = 1; threads <= 4; threads *= 4)
+    {
+        TEST_ASSERT(
+            VCTOOL_STATUS_SUCCESS ==
+                mph_build(&m, keys.data(), COUNT, threads));
+        TEST_EXPECT(COUNT == m.key_count);
+        TEST_EXPECT(is_minimal_perfect(&m, keys, COUNT));
+
+        dispose((disposable_t*)&m);
+    }
+}
+
+/* a view of the serialized form gives the same answers. */
+TEST(view)
+{
+    const uint32_t COUNT = 5000;
+    vector<uint8_t> keys = make_keys(COUNT);
+    mph m, v;
+
+    TEST_ASSERT(VCTOOL_STATUS_SUCCESS == mph_build(&m, keys.data(), COUNT, 1));
+
+    vector<uint64_t> copy(m.size / sizeof(uint64_t));
+    memcpy(copy.data(), m.data, m.size);
+    TEST_ASSERT(
+        VCTOOL_STATUS_SUCCESS == mph_view(&v, copy.data(), m.size));
+
+    for (uint32_t i = 0; i < COUNT; ++i)
+    {
+        TEST_EXPECT(
+            mph_lookup(&m, &keys[i * MPH_KEY_SIZE])
+                == mph_lookup(&v, &keys[i * MPH_KEY_SIZE]));
+    }
+
+    /* a truncated form is rejected. */
+    TEST_EXPECT(
+        VCTOOL_ERROR_MPH_BAD_FORMAT ==
+            mph_view(&v, copy.data(), m.size - sizeof(uint64_t)));
+
+    dispose((disposable_t*)&m);
+}
+
+/* duplicate keys are reported as a collision. */
+TEST(duplicate_keys)
+{
+    vector<uint8_t> keys = make_keys(2);
+    mph m;
+
+    memcpy(&keys[MPH_KEY_SIZE], &keys[0], MPH_KEY_SIZE);
+
+    TEST_EXPECT(
+        VCTOOL_ERROR_MPH_HASH_COLLISION ==
+            mph_build(&m, keys.data(), 2, 1));
+}
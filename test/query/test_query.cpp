@@ -0,0 +1,311 @@
+/**
+ * \file test/query/test_query.cpp
+ *
+ * \brief Unit tests for the query index and server.
+ *
+ * \copyright 2020 Velo Payments.  See License.txt for license terms.
+ */
+
+#include <minunit/minunit.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <thread>
+#include <unistd.h>
+#include <vccert/fields.h>
+#include <vctool/agent.h>
+#include <vctool/blockstore.h>
+#include <vctool/query.h>
+#include <vector>
+
+#include "../cert_field/cert_field.h"
+
+using namespace std;
+
+/* start of the query test suite. */
+TEST_SUITE(query);
+
+/* the number of blocks in the test segment. */
+#define TEST_BLOCKS 20
+
+/**
+ * \brief Make a uuid from a tag and a number.
+ */
+static vector<uint8_t> make_id(uint8_t tag, int n)
+{
+    vector<uint8_t> id(UUID_SIZE, tag);
+    id[UUID_SIZE - 1] = (uint8_t)n;
+
+    return id;
+}
+
+/**
+ * \brief Make the transaction with the given number.
+ *
+ * Transaction n is on artifact n % 3.
+ */
+static vector<uint8_t> make_transaction(int n)
+{
+    vector<uint8_t> txn;
+    vector<uint8_t> txn_id = make_id(0x77, n);
+    vector<uint8_t> artifact_id = make_id(0xAA, n % 3);
+    uint8_t state[5] = { 1, 2, 3, 4, (uint8_t)n };
+
+    add_field(txn, VCCERT_FIELD_TYPE_CERTIFICATE_ID, txn_id.data(), UUID_SIZE);
+    add_field(
+        txn, VCCERT_FIELD_TYPE_ARTIFACT_ID, artifact_id.data(), UUID_SIZE);
+    add_field(txn, VCCERT_FIELD_TYPE_NEW_ARTIFACT_STATE, state, sizeof(state));
+
+    return txn;
+}
+
+/**
+ * \brief Make block h, holding transactions 2h and 2h + 1.
+ */
+static vector<uint8_t> make_block(int h)
+{
+    vector<uint8_t> block;
+    uint8_t height[8] = { 0, 0, 0, 0, 0, 0, 0, (uint8_t)h };
+
+    add_field(block, VCCERT_FIELD_TYPE_BLOCK_HEIGHT, height, sizeof(height));
+    for (int n = 2 * h; n < 2 * h + 2; ++n)
+    {
+        vector<uint8_t> txn = make_transaction(n);
+        add_field(
+            block, VCCERT_FIELD_TYPE_WRAPPED_TRANSACTION_TUPLE, txn.data(),
+            txn.size());
+    }
+
+    return block;
+}
+
+/**
+ * \brief Write the test segment, with blocks at heights 1 through TEST_BLOCKS.
+ */
+static bool write_segment(file* f, const char* path)
+{
+    unlink(path);
+    for (int h = 1; h <= TEST_BLOCKS; ++h)
+    {
+        vector<uint8_t> block = make_block(h);
+        vector<uint8_t> block_id = make_id(0xBB, h);
+        if (VCTOOL_STATUS_SUCCESS !=
+                blockstore_segment_append(
+                    f, path, (uint64_t)h, block_id.data(), block.data(),
+                    block.size()))
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/**
+ * \brief Read the bytes of an entry back from the segment.
+ */
+static vector<uint8_t> entry_bytes(const char* path, const query_entry* entry)
+{
+    vector<uint8_t> bytes(entry->size);
+    FILE* fp = fopen(path, "rb");
+
+    fseek(fp, (long)entry->offset, SEEK_SET);
+    size_t got = fread(bytes.data(), 1, bytes.size(), fp);
+    fclose(fp);
+    bytes.resize(got);
+
+    return bytes;
+}
+
+/* blocks and transactions can be found by each key. */
+TEST(lookups)
+{
+    file f;
+    query_index index;
+    size_t count;
+    char path[] = "/tmp/query-test.seg";
+
+    TEST_ASSERT(VCTOOL_STATUS_SUCCESS == file_init(&f));
+    TEST_ASSERT(write_segment(&f, path));
+    TEST_ASSERT(VCTOOL_STATUS_SUCCESS == query_index_init(&index, &f, path));
+
+    TEST_EXPECT(TEST_BLOCKS == index.block_count);
+    TEST_EXPECT(2 * TEST_BLOCKS == index.transaction_ids.count);
+    TEST_EXPECT(3U == index.artifact_ids.count);
+
+    /* by height. */
+    const query_entry* block = query_index_find_height(&index, 7);
+    TEST_ASSERT(nullptr != block);
+    TEST_EXPECT(make_block(7) == entry_bytes(path, block));
+    TEST_EXPECT(nullptr == query_index_find_height(&index, 0));
+    TEST_EXPECT(nullptr == query_index_find_height(&index, TEST_BLOCKS + 1));
+
+    /* by block id. */
+    const query_entry* by_id =
+        query_index_find_block(&index, make_id(0xBB, 7).data());
+    TEST_ASSERT(nullptr != by_id);
+    TEST_EXPECT(block->offset == by_id->offset);
+    TEST_EXPECT(block->size == by_id->size);
+    TEST_EXPECT(
+        nullptr == query_index_find_block(&index, make_id(0xBB, 99).data()));
+
+    /* by transaction id. */
+    const query_entry* txn =
+        query_index_find_transaction(&index, make_id(0x77, 15).data());
+    TEST_ASSERT(nullptr != txn);
+    TEST_EXPECT(make_transaction(15) == entry_bytes(path, txn));
+    TEST_EXPECT(
+        nullptr ==
+            query_index_find_transaction(&index, make_id(0x77, 99).data()));
+
+    /* by artifact, in chain order. */
+    const query_entry* txns =
+        query_index_find_artifact(&index, make_id(0xAA, 1).data(), &count);
+    TEST_ASSERT(nullptr != txns);
+    /* transactions 4, 7, ... 40. */
+    TEST_ASSERT(13U == count);
+    for (size_t i = 0; i < count; ++i)
+    {
+        TEST_EXPECT(
+            make_transaction(3 * (int)i + 4) == entry_bytes(path, txns + i));
+    }
+    TEST_EXPECT(
+        nullptr ==
+            query_index_find_artifact(
+                &index, make_id(0xAA, 5).data(), &count));
+    TEST_EXPECT(0U == count);
+
+    dispose((disposable_t*)&index);
+    unlink(path);
+    dispose((disposable_t*)&f);
+}
+
+/* a block whose fields overrun it is rejected. */
+TEST(bad_block)
+{
+    file f;
+    query_index index;
+    char path[] = "/tmp/query-test.seg";
+    uint8_t block_id[BLOCKSTORE_BLOCK_ID_SIZE] = { 0 };
+
+    TEST_ASSERT(VCTOOL_STATUS_SUCCESS == file_init(&f));
+    TEST_ASSERT(write_segment(&f, path));
+
+    vector<uint8_t> block = make_block(TEST_BLOCKS + 1);
+    block.pop_back();
+    TEST_ASSERT(
+        VCTOOL_STATUS_SUCCESS ==
+            blockstore_segment_append(
+                &f, path, TEST_BLOCKS + 1, block_id, block.data(),
+                block.size()));
+
+    TEST_EXPECT(
+        VCTOOL_ERROR_QUERY_BAD_BLOCK == query_index_init(&index, &f, path));
+
+    unlink(path);
+    dispose((disposable_t*)&f);
+}
+
+/**
+ * \brief Write a request frame.
+ */
+static bool request(file* f, int sock, uint32_t type, vector<uint8_t> payload)
+{
+    return
+        VCTOOL_STATUS_SUCCESS ==
+            agent_frame_write(f, sock, type, payload.data(), payload.size());
+}
+
+/**
+ * \brief Read a response, returning its certificates and end status.
+ */
+static int response(file* f, int sock, vector<vector<uint8_t>>& certs)
+{
+    agent_frame frame;
+    int status = -1;
+
+    certs.clear();
+    agent_frame_init(&frame);
+    while (VCTOOL_STATUS_SUCCESS == agent_frame_read(f, sock, &frame))
+    {
+        if (QUERY_RESP_END == frame.type && QUERY_END_SIZE == frame.size)
+        {
+            status =
+                (frame.payload[0] << 24) | (frame.payload[1] << 16)
+              | (frame.payload[2] << 8) | frame.payload[3];
+            break;
+        }
+
+        certs.emplace_back(frame.payload, frame.payload + frame.size);
+    }
+
+    dispose((disposable_t*)&frame);
+
+    return status;
+}
+
+/* pipelined requests are answered in order over a connection. */
+TEST(serve)
+{
+    file f;
+    query_index index;
+    int sv[2];
+    int served = -1;
+    vector<vector<uint8_t>> certs;
+    char path[] = "/tmp/query-test.seg";
+    vector<uint8_t> height(8, 0);
+
+    TEST_ASSERT(VCTOOL_STATUS_SUCCESS == file_init(&f));
+    TEST_ASSERT(write_segment(&f, path));
+    TEST_ASSERT(VCTOOL_STATUS_SUCCESS == query_index_init(&index, &f, path));
+    TEST_ASSERT(0 == socketpair(AF_UNIX, SOCK_STREAM, 0, sv));
+
+    thread server([&]()
+    {
+        served = query_serve(&index, sv[1]);
+    });
+
+    /* send every request before reading any response. */
+    height[7] = 3;
+    TEST_EXPECT(request(&f, sv[0], QUERY_REQ_HEIGHT, height));
+    TEST_EXPECT(request(&f, sv[0], QUERY_REQ_BLOCK, make_id(0xBB, 9)));
+    TEST_EXPECT(request(&f, sv[0], QUERY_REQ_TRANSACTION, make_id(0x77, 6)));
+    TEST_EXPECT(request(&f, sv[0], QUERY_REQ_ARTIFACT, make_id(0xAA, 2)));
+    TEST_EXPECT(request(&f, sv[0], QUERY_REQ_TRANSACTION, make_id(0x77, 99)));
+    TEST_EXPECT(request(&f, sv[0], QUERY_REQ_HEIGHT, make_id(0, 0)));
+
+    TEST_EXPECT(VCTOOL_STATUS_SUCCESS == response(&f, sv[0], certs));
+    TEST_EXPECT(vector<vector<uint8_t>>{ make_block(3) } == certs);
+
+    TEST_EXPECT(VCTOOL_STATUS_SUCCESS == response(&f, sv[0], certs));
+    TEST_EXPECT(vector<vector<uint8_t>>{ make_block(9) } == certs);
+
+    TEST_EXPECT(VCTOOL_STATUS_SUCCESS == response(&f, sv[0], certs));
+    TEST_EXPECT(vector<vector<uint8_t>>{ make_transaction(6) } == certs);
+
+    /* transactions 2, 5, ... 41. */
+    TEST_EXPECT(VCTOOL_STATUS_SUCCESS == response(&f, sv[0], certs));
+    TEST_EXPECT(14U == certs.size());
+    for (size_t i = 0; i < certs.size(); ++i)
+    {
+        TEST_EXPECT(make_transaction(3 * (int)i + 2) == certs[i]);
+    }
+
+    /* nothing matches. */
+    TEST_EXPECT(VCTOOL_STATUS_SUCCESS == response(&f, sv[0], certs));
+    TEST_EXPECT(certs.empty());
+
+    /* a height must be 8 bytes. */
+    TEST_EXPECT(VCTOOL_ERROR_QUERY_BAD_REQUEST == response(&f, sv[0], certs));
+    TEST_EXPECT(certs.empty());
+
+    /* the server finishes when the client hangs up. */
+    close(sv[0]);
+    server.join();
+    TEST_EXPECT(VCTOOL_STATUS_SUCCESS == served);
+
+    close(sv[1]);
+    dispose((disposable_t*)&index);
+    unlink(path);
+    dispose((disposable_t*)&f);
+}
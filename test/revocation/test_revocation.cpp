@@ -0,0 +1,227 @@
+/**
+ * \file test/revocation/test_revocation.cpp
+ *
+ * \brief Unit tests for revocation lists.
+ *
+ * \copyright 2020 Velo Payments.  See License.txt for license terms.
+ */
+
+#include <minunit/minunit.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <unistd.h>
+#include <vector>
+#include <vctool/revocation.h>
+
+#include "../temp_dir/temp_dir.h"
+
+using namespace std;
+
+/* start of the revocation test suite. */
+TEST_SUITE(revocation);
+
+/**
+ * \brief Test fixture holding an OS file layer and a scratch list path.
+ */
+struct revocation_fixture
+{
+    file f;
+    temp_dir dir;
+    string path;
+
+    revocation_fixture()
+        : dir("revocation")
+    {
+        file_init(&f);
+        path = dir.file("list.rev");
+    }
+
+    ~revocation_fixture()
+    {
+        dispose((disposable_t*)&f);
+    }
+};
+
+/**
+ * \brief Create a deterministic id from a counter.
+ */
+static void make_id(uint8_t* id, uint32_t n)
+{
+    for (int i = 0; i < REVOCATION_ENTRY_SIZE; ++i)
+    {
+        n = n * 1103515245U + 12345U;
+        id[i] = (uint8_t)(n >> 16);
+    }
+}
+
+/* uuids survive a round trip through their string form. */
+TEST(uuid_round_trip)
+{
+    uint8_t uuid[UUID_SIZE], uuid2[UUID_SIZE];
+    char str[UUID_STRING_SIZE];
+
+    TEST_ASSERT(
+        VCTOOL_STATUS_SUCCESS ==
+            uuid_from_string(uuid, "0123abcd-4567-89ef-0123-456789ABCDEF"));
+    uuid_to_string(str, uuid);
+    TEST_EXPECT(!strcmp(str, "0123abcd-4567-89ef-0123-456789abcdef"));
+
+    /* bare hex is also accepted. */
+    TEST_ASSERT(
+        VCTOOL_STATUS_SUCCESS ==
+            uuid_from_string(uuid2, "0123abcd456789ef0123456789abcdef"));
+    TEST_EXPECT(!memcmp(uuid, uuid2, UUID_SIZE));
+
+    /* malformed strings are rejected. */
+    TEST_EXPECT(
+        VCTOOL_ERROR_UUID_INVALID_STRING ==
+            uuid_from_string(uuid, "0123abcd-4567-89ef-0123-456789abcde"));
+    TEST_EXPECT(
+        VCTOOL_ERROR_UUID_INVALID_STRING ==
+            uuid_from_string(uuid, "0123abcd4-567-89ef-0123-456789abcdef"));
+    TEST_EXPECT(
+        VCTOOL_ERROR_UUID_INVALID_STRING ==
+            uuid_from_string(uuid, "0123abcd-4567-89ef-0123-456789abcdeg"));
+}
+
+/* every written id is found, and ids which were not written are not. */
+TEST(write_open_contains)
+{
+    revocation_fixture fixture;
+    TEST_ASSERT(fixture.dir.created);
+    revocation_set set;
+    const uint32_t COUNT = 1000;
+    vector<uint8_t> ids(COUNT * REVOCATION_ENTRY_SIZE);
+    uint8_t id[REVOCATION_ENTRY_SIZE];
+
+    /* write even ids, with a duplicate. */
+    for (uint32_t i = 0; i < COUNT; ++i)
+    {
+        make_id(&ids[i * REVOCATION_ENTRY_SIZE], 2 * (i % (COUNT - 1)));
+    }
+
+    TEST_ASSERT(
+        VCTOOL_STATUS_SUCCESS ==
+            revocation_set_write(
+                &fixture.f, fixture.path.c_str(), ids.data(), COUNT));
+
+    TEST_ASSERT(
+        VCTOOL_STATUS_SUCCESS ==
+            revocation_set_open(&set, &fixture.f, fixture.path.c_str()));
+
+    /* the duplicate was removed. */
+    TEST_EXPECT(COUNT - 1 == set.count);
+    TEST_EXPECT(set.bloom_blocks > 0);
+    TEST_EXPECT(nullptr != set.slots);
+
+    /* even ids are revoked; odd ids are not. */
+    for (uint32_t i = 0; i < COUNT - 1; ++i)
+    {
+        make_id(id, 2 * i);
+        TEST_EXPECT(revocation_set_contains(&set, id));
+
+        make_id(id, 2 * i + 1);
+        TEST_EXPECT(!revocation_set_contains(&set, id));
+    }
+
+    dispose((disposable_t*)&set);
+}
+
+/* an empty list revokes nothing. */
+TEST(empty_list)
+{
+    revocation_fixture fixture;
+    TEST_ASSERT(fixture.dir.created);
+    revocation_set set;
+    uint8_t id[REVOCATION_ENTRY_SIZE];
+
+    TEST_ASSERT(
+        VCTOOL_STATUS_SUCCESS ==
+            revocation_set_write(
+                &fixture.f, fixture.path.c_str(), nullptr, 0));
+
+    TEST_ASSERT(
+        VCTOOL_STATUS_SUCCESS ==
+            revocation_set_open(&set, &fixture.f, fixture.path.c_str()));
+
+    make_id(id, 7);
+    TEST_EXPECT(0U == set.count);
+    TEST_EXPECT(!revocation_set_contains(&set, id));
+
+    dispose((disposable_t*)&set);
+}
+
+/* a truncated list is rejected. */
+TEST(truncated_list)
+{
+    revocation_fixture fixture;
+    TEST_ASSERT(fixture.dir.created);
+    revocation_set set;
+    uint8_t ids[2 * REVOCATION_ENTRY_SIZE];
+
+    make_id(ids, 1);
+    make_id(ids + REVOCATION_ENTRY_SIZE, 2);
+
+    TEST_ASSERT(
+        VCTOOL_STATUS_SUCCESS ==
+            revocation_set_write(&fixture.f, fixture.path.c_str(), ids, 2));
+    TEST_ASSERT(0 == truncate(fixture.path.c_str(), 40));
+
+    TEST_EXPECT(
+        VCTOOL_ERROR_REVOCATION_BAD_SIZE ==
+            revocation_set_open(&set, &fixture.f, fixture.path.c_str()));
+}
+
+/* ids streamed into a builder are written once each, in sorted order. */
+TEST(builder)
+{
+    revocation_fixture fixture;
+    TEST_ASSERT(fixture.dir.created);
+    revocation_builder builder;
+    revocation_set set;
+    const uint32_t COUNT = 500;
+    uint8_t id[REVOCATION_ENTRY_SIZE];
+
+    TEST_ASSERT(
+        VCTOOL_STATUS_SUCCESS ==
+            revocation_builder_init(
+                &builder, &fixture.f, fixture.path.c_str()));
+
+    /* add every id twice, in two passes. */
+    for (int pass = 0; pass < 2; ++pass)
+    {
+        for (uint32_t i = 0; i < COUNT; ++i)
+        {
+            make_id(id, i);
+            TEST_ASSERT(
+                VCTOOL_STATUS_SUCCESS == revocation_builder_add(&builder, id));
+        }
+    }
+
+    TEST_ASSERT(VCTOOL_STATUS_SUCCESS == revocation_builder_finish(&builder));
+    dispose((disposable_t*)&builder);
+
+    TEST_ASSERT(
+        VCTOOL_STATUS_SUCCESS ==
+            revocation_set_open(&set, &fixture.f, fixture.path.c_str()));
+    TEST_EXPECT(COUNT == set.count);
+
+    /* the entries are sorted and distinct. */
+    for (uint64_t i = 1; i < set.count; ++i)
+    {
+        TEST_EXPECT(
+            memcmp(
+                set.entries + (i - 1) * REVOCATION_ENTRY_SIZE,
+                set.entries + i * REVOCATION_ENTRY_SIZE,
+                REVOCATION_ENTRY_SIZE) < 0);
+    }
+
+    for (uint32_t i = 0; i < COUNT; ++i)
+    {
+        make_id(id, i);
+        TEST_EXPECT(revocation_set_contains(&set, id));
+    }
+
+    dispose((disposable_t*)&set);
+}
@@ -0,0 +1,220 @@
+/**
+ * \file test/scheduler/test_scheduler.cpp
+ *
+ * \brief Unit tests for the scheduler.
+ *
+ * \copyright 2020 Velo Payments.  See License.txt for license terms.
+ */
+
+#include <atomic>
+#include <chrono>
+#include <minunit/minunit.h>
+#include <thread>
+#include <vctool/scheduler.h>
+#include <vector>
+
+using namespace std;
+
+/* start of the scheduler test suite. */
+TEST_SUITE(scheduler);
+
+/**
+ * \brief Take the next request, which must be ready.
+ */
+static scheduler_flow* take(
+    scheduler* sched, scheduler_item** item, int64_t cost = -1)
+{
+    scheduler_flow* flow = nullptr;
+
+    if (VCTOOL_STATUS_SUCCESS != scheduler_next(sched, &flow, item))
+    {
+        return nullptr;
+    }
+
+    /* optionally finish it straight away. */
+    if (cost >= 0)
+    {
+        scheduler_done(sched, flow, *item, cost);
+    }
+
+    return flow;
+}
+
+/* Interactive requests run before bulk requests queued earlier. */
+TEST(interactive_first)
+{
+    scheduler sched;
+    scheduler_flow bulk, interactive;
+    scheduler_item bulk_item = { nullptr, SCHEDULER_BULK };
+    scheduler_item interactive_item = { nullptr, SCHEDULER_INTERACTIVE };
+    scheduler_item* item;
+
+    TEST_ASSERT(
+        VCTOOL_STATUS_SUCCESS == scheduler_init(&sched, 1, 4, 100, 16));
+    scheduler_flow_init(&bulk);
+    scheduler_flow_init(&interactive);
+
+    TEST_ASSERT(
+        VCTOOL_STATUS_SUCCESS ==
+            scheduler_submit(&sched, &bulk, &bulk_item));
+    TEST_ASSERT(
+        VCTOOL_STATUS_SUCCESS ==
+            scheduler_submit(&sched, &interactive, &interactive_item));
+
+    TEST_EXPECT(&interactive == take(&sched, &item, 1));
+    TEST_EXPECT(&interactive_item == item);
+    TEST_EXPECT(&bulk == take(&sched, &item, 1));
+    TEST_EXPECT(&bulk_item == item);
+    TEST_EXPECT(1U == sched.dispatched[SCHEDULER_INTERACTIVE]);
+    TEST_EXPECT(1U == sched.dispatched[SCHEDULER_BULK]);
+
+    dispose((disposable_t*)&sched);
+}
+
+/* Clients in a class share the workers in proportion to their costs. */
+TEST(fair_share)
+{
+    const int REQUESTS = 12;
+    scheduler sched;
+    scheduler_flow heavy, light;
+    scheduler_item heavy_items[REQUESTS], light_items[REQUESTS];
+    scheduler_item* item;
+    int heavy_served = 0, light_served = 0;
+
+    TEST_ASSERT(
+        VCTOOL_STATUS_SUCCESS ==
+            scheduler_init(&sched, 1, REQUESTS, 100, REQUESTS));
+    scheduler_flow_init(&heavy);
+    scheduler_flow_init(&light);
+
+    for (int i = 0; i < REQUESTS; ++i)
+    {
+        heavy_items[i].priority = SCHEDULER_INTERACTIVE;
+        light_items[i].priority = SCHEDULER_INTERACTIVE;
+        scheduler_submit(&sched, &heavy, &heavy_items[i]);
+        scheduler_submit(&sched, &light, &light_items[i]);
+    }
+
+    /* the heavy client's requests cost three rounds of credit each. */
+    for (int i = 0; i < REQUESTS; ++i)
+    {
+        scheduler_flow* flow = take(&sched, &item);
+        TEST_ASSERT(nullptr != flow);
+        if (&heavy == flow)
+        {
+            ++heavy_served;
+            scheduler_done(&sched, flow, item, 300);
+        }
+        else
+        {
+            ++light_served;
+            scheduler_done(&sched, flow, item, 100);
+        }
+    }
+
+    TEST_EXPECT(3 * heavy_served == light_served);
+
+    dispose((disposable_t*)&sched);
+}
+
+/* Bulk work is held to its limit, and a client has one request running. */
+TEST(bulk_limit)
+{
+    scheduler sched;
+    scheduler_flow first, second;
+    scheduler_item first_items[2], second_item;
+    scheduler_item* item;
+    atomic<bool> taken{false};
+
+    TEST_ASSERT(
+        VCTOOL_STATUS_SUCCESS == scheduler_init(&sched, 1, 4, 100, 16));
+    scheduler_flow_init(&first);
+    scheduler_flow_init(&second);
+
+    first_items[0].priority = first_items[1].priority = SCHEDULER_BULK;
+    second_item.priority = SCHEDULER_BULK;
+    scheduler_submit(&sched, &first, &first_items[0]);
+    scheduler_submit(&sched, &first, &first_items[1]);
+    scheduler_submit(&sched, &second, &second_item);
+
+    scheduler_flow* running = take(&sched, &item);
+    TEST_ASSERT(&first == running);
+
+    /* nothing else may run until the bulk request is done. */
+    thread worker([&]() {
+        scheduler_flow* flow;
+        scheduler_item* next;
+
+        if (VCTOOL_STATUS_SUCCESS == scheduler_next(&sched, &flow, &next))
+        {
+            taken = true;
+            scheduler_done(&sched, flow, next, 1);
+        }
+    });
+
+    this_thread::sleep_for(chrono::milliseconds(50));
+    TEST_EXPECT(!taken);
+
+    scheduler_done(&sched, running, item, 1);
+    worker.join();
+    TEST_EXPECT(taken);
+
+    dispose((disposable_t*)&sched);
+}
+
+/* A client which pipelines deeply is demoted to bulk. */
+TEST(deep_pipeline)
+{
+    scheduler sched;
+    scheduler_flow flow;
+    scheduler_item items[4];
+
+    TEST_ASSERT(
+        VCTOOL_STATUS_SUCCESS == scheduler_init(&sched, 1, 2, 100, 16));
+    scheduler_flow_init(&flow);
+
+    for (auto& item : items)
+    {
+        item.priority = SCHEDULER_INTERACTIVE;
+        scheduler_submit(&sched, &flow, &item);
+    }
+
+    TEST_EXPECT(SCHEDULER_INTERACTIVE == items[0].priority);
+    TEST_EXPECT(SCHEDULER_INTERACTIVE == items[1].priority);
+    TEST_EXPECT(SCHEDULER_BULK == items[2].priority);
+    TEST_EXPECT(SCHEDULER_BULK == items[3].priority);
+
+    dispose((disposable_t*)&sched);
+}
+
+/* Stopping wakes waiting workers, and drains leave waiting requests. */
+TEST(stop)
+{
+    scheduler sched;
+    scheduler_flow flow;
+    scheduler_item waiting = { nullptr, SCHEDULER_BULK };
+    scheduler_item* item;
+    int status = VCTOOL_STATUS_SUCCESS;
+
+    TEST_ASSERT(
+        VCTOOL_STATUS_SUCCESS == scheduler_init(&sched, 1, 4, 100, 16));
+    scheduler_flow_init(&flow);
+
+    thread worker([&]() {
+        scheduler_flow* next;
+
+        status = scheduler_next(&sched, &next, &item);
+    });
+
+    this_thread::sleep_for(chrono::milliseconds(20));
+    scheduler_stop(&sched);
+    worker.join();
+    TEST_EXPECT(VCTOOL_ERROR_SCHEDULER_STOPPED == status);
+
+    TEST_EXPECT(
+        VCTOOL_ERROR_SCHEDULER_STOPPED ==
+            scheduler_submit(&sched, &flow, &waiting));
+    scheduler_drain(&sched, &flow);
+
+    dispose((disposable_t*)&sched);
+}
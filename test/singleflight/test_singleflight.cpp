@@ -0,0 +1,250 @@
+/**
+ * \file test/singleflight/test_singleflight.cpp
+ *
+ * \brief Unit tests for single-flight groups.
+ *
+ * \copyright 2020 Velo Payments.  See License.txt for license terms.
+ */
+
+#include <atomic>
+#include <chrono>
+#include <minunit/minunit.h>
+#include <string.h>
+#include <thread>
+#include <vctool/singleflight.h>
+#include <vector>
+
+using namespace std;
+
+/* start of the singleflight test suite. */
+TEST_SUITE(singleflight);
+
+/**
+ * \brief A slow computation which counts its runs.
+ */
+struct slow_computation
+{
+    atomic<int> runs{0};
+    int status = VCTOOL_STATUS_SUCCESS;
+
+    static int run(void* context, void* result)
+    {
+        slow_computation* computation = (slow_computation*)context;
+
+        int run = ++computation->runs;
+        this_thread::sleep_for(chrono::milliseconds(100));
+        memcpy(result, &run, sizeof(run));
+
+        return computation->status;
+    }
+};
+
+/* Concurrent calls with the same key share one computation. */
+TEST(coalesced)
+{
+    const int THREADS = 8;
+    singleflight group;
+    slow_computation computation;
+    vector<thread> threads;
+    atomic<int> shared_count{0}, wrong{0};
+
+    TEST_ASSERT(
+        VCTOOL_STATUS_SUCCESS == singleflight_init(&group, sizeof(int)));
+
+    for (int t = 0; t < THREADS; ++t)
+    {
+        threads.emplace_back([&]() {
+            int result = 0;
+            bool shared;
+
+            if (VCTOOL_STATUS_SUCCESS !=
+                    singleflight_do(
+                        &group, "unlock:a", 8, &slow_computation::run,
+                        &computation, &result, &shared)
+             || 1 != result)
+            {
+                ++wrong;
+            }
+
+            if (shared)
+            {
+                ++shared_count;
+            }
+        });
+    }
+
+    for (auto& t : threads)
+    {
+        t.join();
+    }
+
+    TEST_EXPECT(0 == wrong);
+    TEST_EXPECT(1 == computation.runs);
+    TEST_EXPECT(THREADS - 1 == shared_count);
+    TEST_EXPECT(1U == group.flights);
+    TEST_EXPECT((uint64_t)THREADS - 1 == group.shared);
+    TEST_EXPECT(nullptr == group.calls);
+
+    dispose((disposable_t*)&group);
+}
+
+/* Calls with different keys run separately. */
+TEST(different_keys)
+{
+    singleflight group;
+    slow_computation computation;
+    int first = 0, second = 0;
+    bool first_shared, second_shared;
+
+    TEST_ASSERT(
+        VCTOOL_STATUS_SUCCESS == singleflight_init(&group, sizeof(int)));
+
+    thread other([&]() {
+        singleflight_do(
+            &group, "unlock:a", 8, &slow_computation::run, &computation,
+            &first, &first_shared);
+    });
+    singleflight_do(
+        &group, "unlock:b", 8, &slow_computation::run, &computation, &second,
+        &second_shared);
+    other.join();
+
+    TEST_EXPECT(2 == computation.runs);
+    TEST_EXPECT(!first_shared);
+    TEST_EXPECT(!second_shared);
+    TEST_EXPECT(first != second);
+
+    dispose((disposable_t*)&group);
+}
+
+/* Results are not cached, and failures are shared. */
+TEST(not_cached)
+{
+    singleflight group;
+    slow_computation computation;
+    int result = 0;
+    bool shared;
+
+    TEST_ASSERT(
+        VCTOOL_STATUS_SUCCESS == singleflight_init(&group, sizeof(int)));
+
+    TEST_ASSERT(
+        VCTOOL_STATUS_SUCCESS ==
+            singleflight_do(
+                &group, "fetch:1", 7, &slow_computation::run, &computation,
+                &result, &shared));
+    TEST_EXPECT(1 == result);
+
+    computation.status = VCTOOL_ERROR_GENERAL_OUT_OF_MEMORY;
+    TEST_EXPECT(
+        VCTOOL_ERROR_GENERAL_OUT_OF_MEMORY ==
+            singleflight_do(
+                &group, "fetch:1", 7, &slow_computation::run, &computation,
+                &result, &shared));
+    TEST_EXPECT(2 == computation.runs);
+    TEST_EXPECT(!shared);
+
+    dispose((disposable_t*)&group);
+}
+
+/**
+ * \brief A computation which returns its context.
+ */
+static int echo(void* context, void* result)
+{
+    this_thread::sleep_for(chrono::milliseconds(10));
+    memcpy(result, context, sizeof(int));
+
+    return VCTOOL_STATUS_SUCCESS;
+}
+
+/* Results live in locked slots, and computations past the last slot wait
+ * for one to be freed. */
+TEST(slots)
+{
+    const int THREADS = 2 * SINGLEFLIGHT_MAX_FLIGHTS;
+    singleflight group;
+    vector<thread> threads;
+    atomic<int> wrong{0};
+
+    TEST_ASSERT(
+        VCTOOL_STATUS_SUCCESS == singleflight_init(&group, sizeof(int)));
+    TEST_ASSERT(nullptr != group.slots);
+
+    for (int t = 0; t < THREADS; ++t)
+    {
+        threads.emplace_back([&, t]() {
+            int key = t, result = -1;
+            bool shared;
+
+            if (VCTOOL_STATUS_SUCCESS !=
+                    singleflight_do(
+                        &group, &key, sizeof(key), &echo, &key, &result,
+                        &shared)
+             || t != result)
+            {
+                ++wrong;
+            }
+        });
+    }
+
+    for (auto& t : threads)
+    {
+        t.join();
+    }
+
+    TEST_EXPECT(0 == wrong);
+    TEST_EXPECT((uint64_t)THREADS == group.flights);
+    TEST_EXPECT(0U == group.slots_used);
+
+    /* every slot was wiped when its result was taken. */
+    for (size_t i = 0; i < group.mapped_size; ++i)
+    {
+        TEST_EXPECT(0 == group.slots[i]);
+    }
+
+    dispose((disposable_t*)&group);
+}
+
+/**
+ * \brief A computation without a result which counts its runs.
+ */
+static int count_run(void* context, void* result)
+{
+    this_thread::sleep_for(chrono::milliseconds(100));
+    ++*(atomic<int>*)context;
+
+    return (nullptr == result) ? VCTOOL_STATUS_SUCCESS : -1;
+}
+
+/* A group without results holds no slots, and still coalesces. */
+TEST(empty_results)
+{
+    singleflight group;
+    atomic<int> runs{0};
+    bool first_shared, second_shared;
+    int first, second;
+
+    TEST_ASSERT(VCTOOL_STATUS_SUCCESS == singleflight_init(&group, 0));
+    TEST_EXPECT(nullptr == group.slots);
+
+    thread other([&]() {
+        first =
+            singleflight_do(
+                &group, "warm:1", 6, &count_run, &runs, nullptr,
+                &first_shared);
+    });
+    this_thread::sleep_for(chrono::milliseconds(20));
+    second =
+        singleflight_do(
+            &group, "warm:1", 6, &count_run, &runs, nullptr, &second_shared);
+    other.join();
+
+    TEST_EXPECT(VCTOOL_STATUS_SUCCESS == first);
+    TEST_EXPECT(VCTOOL_STATUS_SUCCESS == second);
+    TEST_EXPECT(1 == runs);
+    TEST_EXPECT(!first_shared);
+    TEST_EXPECT(second_shared);
+
+    dispose((disposable_t*)&group);
+}
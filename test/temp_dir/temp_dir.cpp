@@ -0,0 +1,74 @@
+/**
+ * \file test/temp_dir/temp_dir.cpp
+ *
+ * \brief Scratch directories for tests which touch the file system.
+ *
+ * \copyright 2020 Velo Payments.  See License.txt for license terms.
+ */
+
+#include <ftw.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "temp_dir.h"
+
+using namespace std;
+
+/* the most descriptors nftw may hold open while removing a tree. */
+#define TEMP_DIR_MAX_OPEN_FDS                           16
+
+/* forward decls. */
+static int temp_dir_remove_entry(
+    const char* path, const struct stat*, int, struct FTW*);
+
+/**
+ * \brief Create a scratch directory named after a test suite.
+ *
+ * \param suite     The test suite name.
+ */
+temp_dir::temp_dir(const char* suite)
+{
+    snprintf(path, sizeof(path), "/tmp/vctool_%s_XXXXXX", suite);
+    created = (nullptr != mkdtemp(path));
+}
+
+/**
+ * \brief Remove the directory and everything in it.
+ */
+temp_dir::~temp_dir()
+{
+    if (created)
+    {
+        /* children are visited before their directory. */
+        nftw(
+            path, &temp_dir_remove_entry, TEMP_DIR_MAX_OPEN_FDS,
+            FTW_DEPTH | FTW_PHYS);
+    }
+}
+
+/**
+ * \brief Build the path of a file in the directory.
+ *
+ * \param name      The file name.
+ *
+ * \returns the path of the file.
+ */
+string temp_dir::file(const char* name) const
+{
+    return string(path) + "/" + name;
+}
+
+/**
+ * \brief Remove one entry of the tree.
+ *
+ * \param path      The path of the entry.
+ *
+ * \returns 0, so that the walk removes as much as it can.
+ */
+static int temp_dir_remove_entry(
+    const char* path, const struct stat*, int, struct FTW*)
+{
+    remove(path);
+
+    return 0;
+}
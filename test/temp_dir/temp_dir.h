@@ -0,0 +1,58 @@
+/**
+ * \file test/temp_dir/temp_dir.h
+ *
+ * \brief Scratch directories for tests which touch the file system.
+ *
+ * \copyright 2020 Velo Payments.  See License.txt for license terms.
+ */
+
+#ifndef  VCTOOL_TEST_TEMP_DIR_HEADER_GUARD
+# define VCTOOL_TEST_TEMP_DIR_HEADER_GUARD
+
+/* Require C++. */
+#ifndef __cplusplus
+#error C++ required for this header.
+#endif
+
+#include <string>
+
+/**
+ * \brief A scratch directory under /tmp, removed with everything in it when
+ * the temp_dir goes out of scope.
+ *
+ * Tests must check created before using the directory.
+ */
+struct temp_dir
+{
+    /** \brief the path of the directory. */
+    char path[64];
+
+    /** \brief true if the directory was created. */
+    bool created;
+
+    /**
+     * \brief Create a scratch directory named after a test suite.
+     *
+     * \param suite     The test suite name.
+     */
+    explicit temp_dir(const char* suite);
+
+    /**
+     * \brief Remove the directory and everything in it.
+     */
+    ~temp_dir();
+
+    /**
+     * \brief Build the path of a file in the directory.
+     *
+     * \param name      The file name.
+     *
+     * \returns the path of the file.
+     */
+    std::string file(const char* name) const;
+
+    temp_dir(const temp_dir&) = delete;
+    temp_dir& operator=(const temp_dir&) = delete;
+};
+
+#endif /*VCTOOL_TEST_TEMP_DIR_HEADER_GUARD*/
@@ -0,0 +1,118 @@
+/**
+ * \file test/uuid_dict/test_uuid_dict.cpp
+ *
+ * \brief Unit tests for the uuid dictionary.
+ *
+ * \copyright 2020 Velo Payments.  See License.txt for license terms.
+ */
+
+#include <minunit/minunit.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <unistd.h>
+#include <vctool/uuid_dict.h>
+
+using namespace std;
+
+/* start of the uuid_dict test suite. */
+TEST_SUITE(uuid_dict);
+
+/**
+ * \brief Create a deterministic uuid from a counter.
+ */
+static void make_uuid(uint8_t* uuid, uint32_t n)
+{
+    memset(uuid, 0, UUID_SIZE);
+    memcpy(uuid, &n, sizeof(n));
+    uuid[15] = 0x42;
+}
+
+/* uuids get dense ids in first-seen order, and repeats get the same id. */
+TEST(intern_find_get)
+{
+    const uint32_t COUNT = 5000;
+    uuid_dict dict;
+    uint8_t uuid[UUID_SIZE];
+    uint32_t id;
+
+    TEST_ASSERT(VCTOOL_STATUS_SUCCESS == uuid_dict_init(&dict));
+
+    for (uint32_t i = 0; i < COUNT; ++i)
+    {
+        make_uuid(uuid, i);
+        TEST_EXPECT(
+            VCTOOL_STATUS_SUCCESS == uuid_dict_intern(&dict, uuid, &id));
+        TEST_EXPECT(i == id);
+    }
+
+    for (uint32_t i = 0; i < COUNT; ++i)
+    {
+        make_uuid(uuid, i);
+        TEST_EXPECT(
+            VCTOOL_STATUS_SUCCESS == uuid_dict_intern(&dict, uuid, &id));
+        TEST_EXPECT(i == id);
+        TEST_EXPECT(VCTOOL_STATUS_SUCCESS == uuid_dict_find(&dict, uuid, &id));
+        TEST_EXPECT(i == id);
+        TEST_EXPECT(!memcmp(uuid, uuid_dict_get(&dict, i), UUID_SIZE));
+    }
+
+    make_uuid(uuid, COUNT);
+    TEST_EXPECT(
+        VCTOOL_ERROR_UUID_DICT_NOT_FOUND == uuid_dict_find(&dict, uuid, &id));
+    TEST_EXPECT(nullptr == uuid_dict_get(&dict, COUNT));
+    TEST_EXPECT(COUNT == dict.count);
+
+    dispose((disposable_t*)&dict);
+}
+
+/* ids survive a save and load. */
+TEST(save_load)
+{
+    file f;
+    uuid_dict dict, loaded;
+    uint8_t uuid[UUID_SIZE];
+    uint32_t id;
+    char dirname[64];
+
+    strcpy(dirname, "/tmp/vctool_uuid_dict_XXXXXX");
+    TEST_ASSERT(nullptr != mkdtemp(dirname));
+    string path = string(dirname) + "/uuids.dict";
+
+    file_init(&f);
+    TEST_ASSERT(VCTOOL_STATUS_SUCCESS == uuid_dict_init(&dict));
+
+    for (uint32_t i = 0; i < 100; ++i)
+    {
+        make_uuid(uuid, 1000 - i);
+        TEST_EXPECT(
+            VCTOOL_STATUS_SUCCESS == uuid_dict_intern(&dict, uuid, &id));
+    }
+
+    TEST_EXPECT(
+        VCTOOL_STATUS_SUCCESS == uuid_dict_save(&dict, &f, path.c_str()));
+    dispose((disposable_t*)&dict);
+    TEST_ASSERT(
+        VCTOOL_STATUS_SUCCESS == uuid_dict_load(&loaded, &f, path.c_str()));
+
+    TEST_EXPECT(100U == loaded.count);
+    for (uint32_t i = 0; i < 100; ++i)
+    {
+        make_uuid(uuid, 1000 - i);
+        TEST_EXPECT(
+            VCTOOL_STATUS_SUCCESS == uuid_dict_find(&loaded, uuid, &id));
+        TEST_EXPECT(i == id);
+    }
+
+    /* a truncated file is rejected. */
+    TEST_EXPECT(0 == truncate(path.c_str(), UUID_DICT_HEADER_SIZE + 8));
+    TEST_EXPECT(
+        VCTOOL_ERROR_UUID_DICT_BAD_FORMAT ==
+            uuid_dict_load(&dict, &f, path.c_str()));
+
+    dispose((disposable_t*)&loaded);
+    unlink(path.c_str());
+    rmdir(dirname);
+    dispose((disposable_t*)&f);
+}
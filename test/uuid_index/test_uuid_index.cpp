@@ -0,0 +1,111 @@
+/**
+ * \file test/uuid_index/test_uuid_index.cpp
+ *
+ * \brief Unit tests for the uuid search index.
+ *
+ * \copyright 2020 Velo Payments.  See License.txt for license terms.
+ */
+
+#include <minunit/minunit.h>
+#include <string.h>
+#include <vector>
+#include <vctool/uuid_index.h>
+
+using namespace std;
+
+/* start of the uuid_index test suite. */
+TEST_SUITE(uuid_index);
+
+/**
+ * \brief Create count sorted uuids whose bytes are all even, so that uuids
+ * with odd bytes are never in the set.
+ */
+static vector<uint8_t> make_sorted(size_t count)
+{
+    vector<uint8_t> keys(count * UUID_SIZE);
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        uint8_t* key = &keys[i * UUID_SIZE];
+        memset(key, 0, UUID_SIZE);
+        key[0] = (uint8_t)((i >> 15) << 1);
+        key[1] = (uint8_t)(((i >> 8) & 0x7f) << 1);
+        key[2] = (uint8_t)(i & 0xff) & 0xfe;
+        key[3] = (uint8_t)((i & 1) << 1);
+        key[15] = 0x80;
+    }
+
+    return keys;
+}
+
+/* every uuid is found at its sorted position, for every tree shape. */
+TEST(find_every_size)
+{
+    for (size_t count = 0; count < 70; ++count)
+    {
+        vector<uint8_t> keys = make_sorted(count);
+        uuid_index index;
+
+        TEST_ASSERT(
+            VCTOOL_STATUS_SUCCESS ==
+                uuid_index_init(&index, keys.data(), count));
+
+        for (size_t i = 0; i < count; ++i)
+        {
+            TEST_EXPECT(i == uuid_index_find(&index, &keys[i * UUID_SIZE]));
+        }
+
+        /* uuids before, between, and after the set are not found. */
+        uint8_t missing[UUID_SIZE];
+        memset(missing, 0x00, UUID_SIZE);
+        TEST_EXPECT(UUID_INDEX_NOT_FOUND == uuid_index_find(&index, missing));
+        memset(missing, 0xff, UUID_SIZE);
+        TEST_EXPECT(UUID_INDEX_NOT_FOUND == uuid_index_find(&index, missing));
+        if (count > 0)
+        {
+            memcpy(missing, &keys[0], UUID_SIZE);
+            missing[15] = 0x81;
+            TEST_EXPECT(
+                UUID_INDEX_NOT_FOUND == uuid_index_find(&index, missing));
+        }
+
+        dispose((disposable_t*)&index);
+    }
+}
+
+/* batch lookups agree with single lookups, across batch boundaries. */
+TEST(find_batch)
+{
+    const size_t COUNT = 10000;
+    const size_t QUERIES = 3 * UUID_INDEX_BATCH_WIDTH + 5;
+    vector<uint8_t> keys = make_sorted(COUNT);
+    vector<uint8_t> queries(QUERIES * UUID_SIZE);
+    vector<size_t> positions(QUERIES);
+    uuid_index index;
+
+    TEST_ASSERT(
+        VCTOOL_STATUS_SUCCESS == uuid_index_init(&index, keys.data(), COUNT));
+
+    /* alternate present and absent uuids. */
+    for (size_t i = 0; i < QUERIES; ++i)
+    {
+        uint8_t* query = &queries[i * UUID_SIZE];
+        memcpy(query, &keys[((i * 7919) % COUNT) * UUID_SIZE], UUID_SIZE);
+        if (i & 1)
+        {
+            query[15] = 0x81;
+        }
+    }
+
+    uuid_index_find_batch(&index, queries.data(), QUERIES, positions.data());
+
+    for (size_t i = 0; i < QUERIES; ++i)
+    {
+        size_t expected = (i & 1) ? UUID_INDEX_NOT_FOUND : (i * 7919) % COUNT;
+        TEST_EXPECT(expected == positions[i]);
+        TEST_EXPECT(
+            positions[i] == uuid_index_find(&index, &queries[i * UUID_SIZE]));
+    }
+
+    dispose((disposable_t*)&index);
+}